@@ -375,6 +375,18 @@ ay_init(Tcl_Interp *interp)
   if((ay_status = ay_comp_init()))
     { ay_error(ay_status, fname, NULL); return AY_ERROR; }
 
+  /* initialize provide module */
+  if((ay_status = ay_provide_init()))
+    { ay_error(ay_status, fname, NULL); return AY_ERROR; }
+
+  /* initialize bounding box module */
+  if((ay_status = ay_bbc_init()))
+    { ay_error(ay_status, fname, NULL); return AY_ERROR; }
+
+  /* initialize binary scene file module */
+  if((ay_status = ay_bio_init(interp)))
+    { ay_error(ay_status, fname, NULL); return AY_ERROR; }
+
   /* initialize automatic instancing module */
   if((ay_status = ay_ai_init(interp)))
     { ay_error(ay_status, fname, NULL); return AY_ERROR; }
@@ -382,6 +394,10 @@ ay_init(Tcl_Interp *interp)
   /* initialize notification module */
   ay_notify_init(interp);
 
+  /* initialize vertex buffer cache module */
+  if((ay_status = ay_vbo_init()))
+    { ay_error(ay_status, fname, NULL); return AY_ERROR; }
+
   /* initialize pact module */
   if((ay_status = ay_pact_init(interp)))
     { ay_error(ay_status, fname, NULL); return AY_ERROR; }
@@ -551,6 +567,9 @@ ay_init(Tcl_Interp *interp)
   /* initialize the patch mesh tools module */
   ay_pmt_init();
 
+  /* initialize the bevel tools module */
+  ay_bevelt_init();
+
   /* register SaveMainGeom tag type */
   (void)ay_tags_register(ay_savegeom_tagname, &ay_savegeom_tagtype);
 
@@ -701,6 +720,7 @@ ay_init(Tcl_Interp *interp)
   if(!(ay_prefs.pprender = calloc(3+1, sizeof(char))))
     return AY_EOMEM;
   strcpy(ay_prefs.pprender, "rgl");
+  ay_prefs.pprev_retained = AY_TRUE;
 
 
   /* PV tag names */
@@ -790,6 +810,10 @@ Tcl_AppInit(Tcl_Interp *interp)
   Tcl_CreateCommand(interp, "notifyOb", ay_notify_objecttcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
 
+  /* provide.c */
+  Tcl_CreateCommand(interp, "provCache", ay_provide_cachetcmd,
+		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
+
   /* prefs.c */
   Tcl_CreateCommand(interp, "setPrefs", ay_prefs_settcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
@@ -1155,6 +1179,10 @@ ay_safeinit(Tcl_Interp *interp)
   Tcl_CreateCommand(interp, "downOb", ay_clipb_hmovtcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
 
+  /* comp.c */
+  Tcl_CreateCommand(interp, "compOb", ay_comp_objectstcmd,
+		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
+
   /* conv.c */
   Tcl_CreateCommand(interp, "convOb", ay_convert_objecttcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
@@ -1365,6 +1393,12 @@ ay_safeinit(Tcl_Interp *interp)
   Tcl_CreateCommand(interp, "setPnt", ay_tcmd_setpointtcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
 
+  Tcl_CreateObjCommand(interp, "getGeom", ay_bulk_getgeomtcmd,
+		       (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
+
+  Tcl_CreateObjCommand(interp, "setGeom", ay_bulk_setgeomtcmd,
+		       (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
+
   Tcl_CreateCommand(interp, "getNormal", ay_tcmd_getnormaltcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
 
@@ -1534,6 +1568,9 @@ ay_safeinit(Tcl_Interp *interp)
   Tcl_CreateCommand(interp, "estlenNC", ay_nct_estlentcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
 
+  Tcl_CreateCommand(interp, "intersectNC", ay_nct_intersecttcmd,
+		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
+
   Tcl_CreateCommand(interp, "reparamNC", ay_nct_reparamtcmd,
 		    (ClientData) NULL, (Tcl_CmdDeleteProc *) NULL);
 
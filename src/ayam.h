@@ -133,6 +133,17 @@ typedef struct ay_point_s
 } ay_point;
 
 
+/** set of selected point indices (bitset and compact index array) */
+typedef struct ay_selpset_s
+{
+  unsigned int len; /**< number of points covered by the bitset */
+  unsigned char *bits; /**< membership bits, one per point */
+  unsigned int num; /**< number of points in the set */
+  unsigned int size; /**< allocated size of the index array */
+  unsigned int *indices; /**< indices of the points in the set */
+} ay_selpset;
+
+
 /** multiple points */
 typedef struct ay_mpoint_s
 {
@@ -244,6 +255,10 @@ typedef struct ay_object_s {
   /** is this object modified by an editing action? */
   int modified;
 
+  /** version of this object, changes with every notification,
+      0 if the object has never been notified */
+  unsigned int version;
+
   /** does this object allow children? */
   int parent;
 
@@ -523,8 +538,37 @@ typedef struct ay_stess_patch_s {
 
   struct ay_pomesh_object_s *pomesh; /**< tesselated planar trimmed patch */
   double normal[3]; /**< normal of tesselated planar mesh */
+
+  unsigned int gen; /**< generation of tesselation (for caches, 0 - none) */
 } ay_stess_patch;
 
+/** number of level of detail tesselations per NURBS patch */
+#define AY_STESSLODS 8
+
+
+/** node of a bounding volume hierarchy for ray casting */
+typedef struct ay_rcast_node_s {
+  double bb[6]; /**< bounds (xmin, ymin, zmin, xmax, ymax, zmax) */
+  double uv[4]; /**< parametric range (umin, umax, vmin, vmax) */
+  int left; /**< index of left child node (-1 for leaf nodes) */
+  int right; /**< index of right child node (-1 for leaf nodes) */
+  double guess[12]; /**< corner points of leaf nodes (for starting values) */
+} ay_rcast_node;
+
+
+/** bounding volume hierarchy of a NURBS patch for ray casting */
+typedef struct ay_rcast_bvh_s {
+  struct ay_nurbpatch_object_s *np; /**< the patch (not owned) */
+  int nnodes; /**< number of nodes */
+  ay_rcast_node *nodes; /**< nodes [nnodes], the root is the first node */
+  double tol; /**< convergence tolerance of the Newton iteration */
+
+  int tcslen; /**< number of tesselated trim loops */
+  int *tcslens; /**< lengths of trim loops [tcslen] */
+  double **tcs; /**< tesselated trim loops in parametric space [tcslen][2] */
+  int outer; /**< add an implicit outer boundary to the trim loops? */
+} ay_rcast_bvh;
+
 
 /** NURBS patch object */
 typedef struct ay_nurbpatch_object_s
@@ -558,6 +602,10 @@ typedef struct ay_nurbpatch_object_s
 
   ay_stess_patch stess[2]; /**< cached tesselations */
 
+  /** cached level of detail tesselations [AY_STESSLODS],
+      level i has quality factor 2^i */
+  ay_stess_patch *lods;
+
   /** cached caps and bevel objects */
   ay_object *caps_and_bevels;
 
@@ -1314,6 +1362,14 @@ typedef struct ay_script_object_s
   int pntsrat; /**< are the read only points rational? (0 - no, 1 - yes) */
 
   ay_sevalcb *cb; /**< script evaluation callback (for JavaScript, Lua ...) */
+
+  char *cachekey; /**< inputs of the last evaluation (see "cache:") */
+  int cachekeylen; /**< length of cachekey */
+  ay_object *cacheinputs; /**< copies of children at the last evaluation */
+
+  unsigned int evaluations; /**< number of evaluations */
+  unsigned int cachehits; /**< number of evaluations saved by the cache */
+  double evaltime; /**< total evaluation time (in seconds) */
 } ay_script_object;
 
 
@@ -1417,6 +1473,10 @@ typedef struct ay_view_object_s
   int action_state; /**< is an action active in this view? (0 no, 1 yes) */
 
   int full_notify; /**< controls scope of next notification */
+
+  int culled; /**< number of objects culled in the last redraw */
+
+  int lodpending; /**< redraw to refine level of detail tesselations? */
 } ay_view_object;
 
 
@@ -1455,7 +1515,9 @@ typedef struct ay_preferences_s
   double pick_epsilon; /**< control point picking accuracy */
   int lazynotify; /**< control notification */
   int completenotify; /**< control complete notification */
+  int notifythreads; /**< number of threads for notification, 0 - auto */
   int undo_levels; /**< number of undo levels, -1 turns undo off */
+  int undo_memory; /**< memory budget of undo buffer in MB, 0 - unlimited */
   int globalmark; /**< maintain a global mark? */
   int createat; /**< create objects at 0 - world origin, 1 - the mark, 2 - camera aim point */
   int createin; /**< create objects in world CS, 1 - view CS, 2 - camera CS */
@@ -1550,6 +1612,9 @@ typedef struct ay_preferences_s
   int glu_cache_float; /**< unused */
   int glu_avoid_pwlcurve; /**< use gluNurbsCurve() for polygonal trims? */
   int stess_qf; /**< quality factor derived from GLU sampling tolerance */
+  /** screen space edge length of level of detail tesselations
+      of NURBS patches (pixels, 0 - off) */
+  double lod_tolerance;
 
   /** default sampling mode/quality for NURBS -> PolyMesh conversion */
   int smethod;
@@ -1571,6 +1636,8 @@ typedef struct ay_preferences_s
   /** is a permanent preview window open? */
   int pprev_open;
   char *pprender; /**< permanent preview render command template */
+  /** retain unchanged geometry in the permanent preview renderer? */
+  int pprev_retained;
 
   /** should conversion reset the display_mode/sampling_tolerance? */
   int conv_reset_display;
@@ -1654,6 +1721,9 @@ typedef int (ay_treedropcb) (ay_object *o);
 /** Compare callback */
 typedef int (ay_comparecb) (ay_object *o1, ay_object *o2);
 
+/** Hash callback (adds the parameters of an object to hash value h) */
+typedef unsigned int (ay_comphashcb) (ay_object *o, unsigned int h);
+
 /** Convert callback */
 typedef int (ay_convertcb) (ay_object *o, int in_place);
 
@@ -2199,6 +2269,10 @@ extern char *ay_error_igntype;
 /** Apply 4x4 transformation matrix \a m to 3D point/vector in \a v2 */
 #define AY_APTRAN3(v1,v2,m) {v1[0]=v2[0]*m[0]+v2[1]*m[4]+v2[2]*m[8]+1.0*m[12];v1[1]=v2[0]*m[1]+v2[1]*m[5]+v2[2]*m[9]+1.0*m[13];v1[2]=v2[0]*m[2]+v2[1]*m[6]+v2[2]*m[10]+1.0*m[14];}
 
+/** is point index \a i in ay_selpset \a s? */
+#define AY_SELPSETHAS(s,i) (((i) < (s)->len) &&\
+			    ((s)->bits[(i)>>3] & (1 << ((i)&7))))
+
 /** 4x4 matrix element access */
 #define AY_M44(m,r,c) ((m)[(c)*4+(r)])
 
@@ -34,6 +34,99 @@ int ay_bbc_fromlist(ay_object *o, int update, double *bbox);
 int ay_bbc_gettcmd(ClientData clientData, Tcl_Interp *interp,
 		   int argc, char *argv[]);
 
+/** get cached bounding box of object o in its own coordinate system
+ */
+int ay_bbc_getcached(ay_object *o, double *bbox);
+
+/** remove cached bounding box(es)
+ */
+void ay_bbc_uncache(ay_object *o);
+
+/** initialize bounding box module
+ */
+int ay_bbc_init(void);
+
+/* bio.c */
+
+/** register binary scene file read and write callbacks
+ */
+int ay_bio_register(ay_readcb *readcb, ay_writecb *writecb,
+		    unsigned int type_id);
+
+/** initialize binary scene file module
+ */
+int ay_bio_init(Tcl_Interp *interp);
+
+/** write an integer to a binary scene file
+ */
+int ay_bio_writeint(FILE *fileptr, int i);
+
+/** write an unsigned integer to a binary scene file
+ */
+int ay_bio_writeuint(FILE *fileptr, unsigned int u);
+
+/** write an array of unsigned integers to a binary scene file
+ */
+int ay_bio_writeuints(FILE *fileptr, unsigned int n, unsigned int *u);
+
+/** write an array of doubles to a binary scene file
+ */
+int ay_bio_writedoubles(FILE *fileptr, unsigned int n, double *d);
+
+/** write a string to a binary scene file
+ */
+int ay_bio_writestring(FILE *fileptr, char *str);
+
+/** read an integer from a binary scene file
+ */
+int ay_bio_readint(FILE *fileptr, int *i);
+
+/** read an unsigned integer from a binary scene file
+ */
+int ay_bio_readuint(FILE *fileptr, unsigned int *u);
+
+/** read an array of unsigned integers from a binary scene file
+ */
+int ay_bio_readuints(FILE *fileptr, unsigned int n, unsigned int *u);
+
+/** read an array of doubles from a binary scene file
+ */
+int ay_bio_readdoubles(FILE *fileptr, unsigned int n, double *d);
+
+/** read a string from a binary scene file
+ */
+int ay_bio_readstring(FILE *fileptr, char **result);
+
+/** write the binary scene file header
+ */
+int ay_bio_writeheader(FILE *fileptr);
+
+/** read the binary scene file header
+ */
+int ay_bio_readheader(FILE *fileptr);
+
+/** save an object to a binary scene file
+ */
+int ay_bio_writeobject(FILE *fileptr, ay_object *o);
+
+/** read an object from a binary scene file
+ */
+int ay_bio_readobject(FILE *fileptr);
+
+
+/* bulk.c */
+
+/** Tcl command to get geometric data of selected objects in one go
+ */
+int ay_bulk_getgeomtcmd(ClientData clientData, Tcl_Interp *interp,
+			int objc, Tcl_Obj *CONST objv[]);
+
+/** Tcl command to set geometric data of selected objects in one go
+ */
+int ay_bulk_setgeomtcmd(ClientData clientData, Tcl_Interp *interp,
+			int objc, Tcl_Obj *CONST objv[]);
+
+
 /* clear.c */
 
 /** remove all objects from the scene
@@ -171,6 +264,32 @@ int ay_comp_trafos(ay_object *o1, ay_object *o2);
  */
 int ay_comp_tags(ay_object *o1, ay_object *o2);
 
+/** Tcl command to compare the selected objects
+ */
+int ay_comp_objectstcmd(ClientData clientData, Tcl_Interp *interp,
+			int argc, char *argv[]);
+
+/** register a hash callback
+ */
+int ay_comp_registerhash(ay_comphashcb *hashcb, unsigned int type_id);
+
+/** compute hash value of an object
+ */
+unsigned int ay_comp_hashobject(ay_object *o);
+
+/** add arbitrary data to a hash value
+ */
+unsigned int ay_comp_hashdata(unsigned int h, const void *data, size_t len);
+
+/** add doubles to a hash value
+ */
+unsigned int ay_comp_hashdoubles(unsigned int h, const double *dv,
+				 unsigned int n);
+
+/** add the tags of an object to a hash value
+ */
+unsigned int ay_comp_hashtags(ay_object *o, unsigned int h);
+
 
 /* convert.c */
 
@@ -258,6 +377,26 @@ void ay_draw_rhombus(double *pnt);
  */
 void ay_draw_linestrip(struct Togl *togl, int n, int stride, double *cv);
 
+/** enable view frustum culling for view togl
+ */
+void ay_draw_beginculling(struct Togl *togl);
+
+/** disable view frustum culling
+ */
+void ay_draw_endculling(void);
+
+/** check whether object o is outside of the view frustum
+ */
+int ay_draw_isculled(ay_object *o);
+
+/** get projected size of object o in pixels
+ */
+int ay_draw_getpixelsize(ay_object *o, double *size);
+
+/** check whether a level of detail tesselation may be created now
+ */
+int ay_draw_lodgenerate(void);
+
 
 /* error.c */
 
@@ -476,15 +615,42 @@ int ay_notify_parentof(ay_object *o, int silent);
 int ay_notify_objecttcmd(ClientData clientData, Tcl_Interp *interp,
 			 int argc, char *argv[]);
 
-/** find parents
+/** inform notification module about a change of the scene structure
+ */
+void ay_notify_invalidate(ay_object *o);
+
+/** allow parallel notification of objects of a type
+ */
+int ay_notify_registerparallel(unsigned int type_id);
+
+/** serialize access to shared data during parallel notification
+ */
+void ay_notify_lock(void);
+
+/** release lock obtained by ay_notify_lock()
+ */
+void ay_notify_unlock(void);
+
+/** queue error message during parallel notification
+ */
+int ay_notify_defererror(int code, const char *where, const char *what);
+
+/** mark begin/end of parallel work (defer error messages)
+ */
+void ay_notify_parallel(int on);
+
+/** do complete notification for a number of objects
  */
-int ay_notify_findparents(ay_object *o, ay_object *r,
-			  ay_list_object **parents);
+int ay_notify_completelist(ay_object **r, int nr);
 
 /** do complete notification for object r
  */
 int ay_notify_complete(ay_object *r);
 
+/** get number of threads to use for parallel work
+ */
+int ay_notify_getnthreads(void);
+
 /** manage blocking of automatic notifications
  */
 void ay_notify_block(int scope, int block);
@@ -1118,6 +1284,24 @@ int ay_provide_nptoolobj(ay_object *o, unsigned int type,
 			 ay_object *npatch, ay_object *cb,
 			 ay_object **result);
 
+/** remove cached provide results of an object
+ */
+void ay_provide_uncache(ay_object *o);
+
+/** allow caching of provided objects for an object type
+ */
+int ay_provide_registercache(unsigned int type_id,
+			     unsigned int target);
+
+/** Tcl command to manage the provide cache
+ */
+int ay_provide_cachetcmd(ClientData clientData, Tcl_Interp *interp,
+			 int argc, char *argv[]);
+
+/** initialize provide module
+ */
+int ay_provide_init();
+
 
 /* pv.c */
 
@@ -1174,6 +1358,22 @@ int ay_pv_getvc(ay_object *o, char *myc, int stride,
  */
 int ay_pv_count(ay_object *o);
 
+/** convert a PV tag to binary form
+ */
+int ay_pv_tobinary(ay_tag *tag);
+
+/** get string form of a PV tag
+ */
+int ay_pv_tostring(ay_tag *tag, char **result);
+
+/** convert a PV tag to string form
+ */
+int ay_pv_totext(ay_tag *tag);
+
+/** select data elements of a PV tag
+ */
+int ay_pv_selectelems(ay_tag *tag, unsigned int *ind, unsigned int indlen);
+
 /** fix/correct number of elements in a PV tag
  */
 void ay_pv_fixnumelems(char *buf, unsigned int numelems);
@@ -1232,6 +1432,10 @@ int ay_read_unistring(FILE *fileptr, Tcl_UniChar **result);
  */
 int ay_read_skip(FILE *fileptr);
 
+/** set ay_read_version from version string of Ayam scene file
+ */
+int ay_read_setversion(char *version);
+
 /** read header info from Ayam scene file
  */
 int ay_read_header(FILE *fileptr);
@@ -1240,6 +1444,10 @@ int ay_read_header(FILE *fileptr);
  */
 int ay_read_attributes(FILE *fileptr, ay_object *o);
 
+/** complete a tag read from Ayam scene file
+ */
+int ay_read_checktag(ay_tag *tag);
+
 /** read object tags from Ayam scene file
  */
 int ay_read_tags(FILE *fileptr, ay_object *o);
@@ -1248,6 +1456,15 @@ int ay_read_tags(FILE *fileptr, ay_object *o);
  */
 int ay_read_shader(FILE *fileptr, ay_shader **result);
 
+/** get type id for type name read from Ayam scene file
+ */
+int ay_read_typename(char *typename, unsigned int *type);
+
+/** call read callback and link object read from Ayam scene file
+ */
+int ay_read_linkobject(FILE *fileptr, ay_object *o, int has_child,
+		       ay_readcb *cb);
+
 /** read object from Ayam scene file
  */
 int ay_read_object(FILE *fileptr);
@@ -1439,6 +1656,27 @@ void ay_selp_updatempselection(unsigned int n, ay_point *selp, ay_mpoint *mp);
  */
 int ay_selp_find(ay_point *selp, double *point);
 
+/** initialize a set of selected point indices
+ */
+int ay_selp_setinit(ay_selpset *set, unsigned int len);
+
+/** free a set of selected point indices
+ */
+void ay_selp_setfree(ay_selpset *set);
+
+/** add a point index to a set of selected point indices
+ */
+int ay_selp_setadd(ay_selpset *set, unsigned int index);
+
+/** create a set from the indices of a list of selected points
+ */
+int ay_selp_setfromlist(ay_point *selp, unsigned int len, ay_selpset *set);
+
+/** create a set from a list of selected points and a coordinate array
+ */
+int ay_selp_setfromarr(ay_point *selp, double *arr, unsigned int arrlen,
+		       int stride, ay_selpset *set);
+
 
 /* shade.c */
 
@@ -1966,6 +2204,39 @@ int ay_vact_zoomtcb(struct Togl *togl, int argc, char *argv[]);
 int ay_vact_moveztcb(struct Togl *togl, int argc, char *argv[]);
 
 
+/* vbo.c */
+
+/** shade tesselation from the vertex buffer cache of the current view
+ */
+int ay_vbo_shadestess(ay_stess_patch *stess);
+
+/** draw/shade multiple instances of a tesselation from the vertex buffer
+ *  cache of the current view
+ */
+int ay_vbo_drawinstances(ay_stess_patch *stess, int shade, unsigned int n,
+			 double *m);
+
+/** shade PolyMesh from the vertex buffer cache of the current view
+ */
+int ay_vbo_shadepomesh(ay_pomesh_object *po, unsigned int version);
+
+/** make vertex buffer cache of view current
+ */
+void ay_vbo_begin(struct Togl *togl);
+
+/** release vertex buffer cache of current view, drop unused entries
+ */
+void ay_vbo_end(void);
+
+/** free vertex buffer cache of view
+ */
+void ay_vbo_freeview(struct Togl *togl);
+
+/** initialize vbo module
+ */
+int ay_vbo_init(void);
+
+
 /* viewt.c */
 
 /** set up the camera projection of a view
@@ -1983,6 +2254,11 @@ void ay_viewt_wintoobj(struct Togl *togl, ay_object *o,
 		       double winX, double winY,
 		       double *objX, double *objY, double *objZ);
 
+/** convert window coordinates to a ray in object space
+ */
+void ay_viewt_wintoray(struct Togl *togl, ay_object *o,
+		       double winX, double winY, double *ro, double *rd);
+
 /** convert rectangle in window coordinates to object space
  */
 void ay_viewt_winrecttoobj(struct Togl *togl, ay_object *o,
@@ -2235,6 +2511,21 @@ void ay_wrib_pprevclose();
 void ay_wrib_init(Tcl_Interp *interp);
 
 
+/* wriba.c */
+
+/** write objects to content hashed RIB archives
+ */
+int ay_wriba_write(char *base, ay_object *o);
+
+/** get name of content hashed RIB archive of an object
+ */
+char *ay_wriba_get(ay_object *o);
+
+/** forget about all content hashed RIB archives
+ */
+void ay_wriba_clear(void);
+
+
 /* write.c */
 
 /** write the Ayam scene file format header to a scene file
@@ -2257,9 +2548,9 @@ void ay_write_shader(FILE *fileptr, ay_shader *shader);
  */
 int ay_write_object(FILE *fileptr, ay_object *o);
 
-/** save the scene to a scene file
+/** save the scene to a (binary) scene file
  */
-int ay_write_scene(char *fname, int selected);
+int ay_write_scene(char *fname, int selected, int binary);
 
 /** Tcl command to save the scene to a scene file
  */
@@ -14,6 +14,27 @@
 
 /* bbc.c - bounding box calculation */
 
+/* local types: */
+
+/** cached bounding box of an object (see ay_bbc_getcached()) */
+typedef struct ay_bbc_centry_s {
+  unsigned int version; /**< version of the object */
+  int valid; /**< AY_FALSE if the object has no usable bounding box */
+  double bbox[6]; /**< xmin, ymin, zmin, xmax, ymax, zmax */
+} ay_bbc_centry;
+
+
+/* global variables for this module: */
+
+/** cached bounding boxes, keyed by object */
+static Tcl_HashTable ay_bbc_cacheht;
+
+
+/* prototypes of functions local to this module: */
+
+void ay_bbc_merge(double *bbt, double *bbox);
+
+
 /* ay_bbc_get:
  *  changes to this function also need to be applied to:
  *  objects/instance.c/ay_instance_bbccb()
@@ -345,6 +366,201 @@ ay_bbc_fromlist(ay_object *o, int update, double *bbox)
 } /* ay_bbc_fromlist */
 
 
+/* ay_bbc_merge:
+ *  merge the 8 corner points in \a bbt into the
+ *  minimum/maximum bounding box \a bbox [6]
+ */
+void
+ay_bbc_merge(double *bbt, double *bbox)
+{
+ int i, j;
+
+  for(i = 0; i < 8; i++)
+    {
+      for(j = 0; j < 3; j++)
+	{
+	  if(bbt[i*3+j] < bbox[j])
+	    bbox[j] = bbt[i*3+j];
+	  if(bbt[i*3+j] > bbox[j+3])
+	    bbox[j+3] = bbt[i*3+j];
+	}
+    }
+
+ return;
+} /* ay_bbc_merge */
+
+
+/** ay_bbc_getcached:
+ *  Get the bounding box of object \a o and its children in the
+ *  coordinate system of \a o (i.e. without the transformation
+ *  attributes of \a o), as needed for view frustum culling.
+ *  The result is cached as long as the version of \a o does not
+ *  change; since the notification of an object also notifies its
+ *  parents, a change of any child also invalidates the cached
+ *  bounding boxes of all parents.
+ *  In contrast to ay_bbc_get(), objects that have no own bounding box
+ *  (and no children with one), that discard their transformations
+ *  (Instance), that do not pass their transformations to their
+ *  children, or that have children without bounding box are reported
+ *  as failure, because they can not safely be culled.
+ *
+ * \param[in] o  object to process
+ * \param[in,out] bbox  where to store the bounding box
+ *  (xmin, ymin, zmin, xmax, ymax, zmax) [6]
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_bbc_getcached(ay_object *o, double *bbox)
+{
+ int ay_status = AY_OK, new_item = 0, flags = 0, valid = AY_TRUE;
+ int have_bb = AY_FALSE;
+ Tcl_HashEntry *entry = NULL;
+ ay_bbc_centry *e = NULL;
+ ay_voidfp *arr = NULL;
+ ay_bbccb *cb = NULL;
+ ay_object *d;
+ double own[24] = {0}, bbt[24], cbb[6], m[16];
+
+  if(!o || !bbox)
+    return AY_ENULL;
+
+  /* objects that were never notified have no version, so
+     that we can not decide on the validity of a cached box */
+  if(o->version)
+    {
+      entry = Tcl_CreateHashEntry(&ay_bbc_cacheht, (char*)o, &new_item);
+      if(new_item)
+	{
+	  if(!(e = malloc(sizeof(ay_bbc_centry))))
+	    {
+	      Tcl_DeleteHashEntry(entry);
+	      return AY_EOMEM;
+	    }
+	  e->version = 0;
+	  Tcl_SetHashValue(entry, (char*)e);
+	}
+      else
+	{
+	  e = (ay_bbc_centry *)Tcl_GetHashValue(entry);
+	}
+
+      if(e->version == o->version)
+	{
+	  if(!e->valid)
+	    return AY_ERROR;
+	  memcpy(bbox, e->bbox, 6*sizeof(double));
+	  return AY_OK;
+	}
+    } /* if */
+
+  bbox[0] = DBL_MAX; bbox[1] = DBL_MAX; bbox[2] = DBL_MAX;
+  bbox[3] = -DBL_MAX; bbox[4] = -DBL_MAX; bbox[5] = -DBL_MAX;
+
+  arr = ay_bbccbt.arr;
+  cb = (ay_bbccb *)(arr[o->type]);
+  if(cb)
+    ay_status = cb(o, own, &flags);
+
+  if(!cb || ay_status || flags == 3)
+    valid = AY_FALSE;
+
+  /* merge the bounding boxes of the children */
+  if(valid && flags != 1 && o->down && o->down->next)
+    {
+      if(!o->inherit_trafos)
+	valid = AY_FALSE;
+
+      d = o->down;
+      while(valid && d->next)
+	{
+	  if(ay_bbc_getcached(d, cbb))
+	    {
+	      valid = AY_FALSE;
+	      break;
+	    }
+
+	  /* convert to corner points and apply the child's trafos */
+	  bbt[0] = cbb[0]; bbt[1] = cbb[1]; bbt[2] = cbb[2];
+	  bbt[3] = cbb[3]; bbt[4] = cbb[1]; bbt[5] = cbb[2];
+	  bbt[6] = cbb[0]; bbt[7] = cbb[4]; bbt[8] = cbb[2];
+	  bbt[9] = cbb[3]; bbt[10] = cbb[4]; bbt[11] = cbb[2];
+	  bbt[12] = cbb[0]; bbt[13] = cbb[1]; bbt[14] = cbb[5];
+	  bbt[15] = cbb[3]; bbt[16] = cbb[1]; bbt[17] = cbb[5];
+	  bbt[18] = cbb[0]; bbt[19] = cbb[4]; bbt[20] = cbb[5];
+	  bbt[21] = cbb[3]; bbt[22] = cbb[4]; bbt[23] = cbb[5];
+
+	  if(AY_ISTRAFO(d))
+	    {
+	      ay_trafo_creatematrix(d, m);
+	      ay_trafo_apply3v(bbt, 8, 3, m);
+	    }
+
+	  ay_bbc_merge(bbt, bbox);
+	  have_bb = AY_TRUE;
+
+	  d = d->next;
+	} /* while */
+    } /* if */
+
+  if(valid && flags != 2)
+    {
+      ay_bbc_merge(own, bbox);
+      have_bb = AY_TRUE;
+    }
+
+  if(!have_bb)
+    valid = AY_FALSE;
+
+  if(e)
+    {
+      e->version = o->version;
+      e->valid = valid;
+      memcpy(e->bbox, bbox, 6*sizeof(double));
+    }
+
+  if(!valid)
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_bbc_getcached */
+
+
+/** ay_bbc_uncache:
+ *  Remove the cached bounding box of an object, e.g.\ because
+ *  it is going to be deleted.
+ *
+ * \param[in] o  object to process, if NULL, all cached
+ *  bounding boxes are removed
+ */
+void
+ay_bbc_uncache(ay_object *o)
+{
+ Tcl_HashEntry *entry;
+ Tcl_HashSearch search;
+
+  if(o)
+    {
+      if((entry = Tcl_FindHashEntry(&ay_bbc_cacheht, (char*)o)))
+	{
+	  free(Tcl_GetHashValue(entry));
+	  Tcl_DeleteHashEntry(entry);
+	}
+      return;
+    }
+
+  entry = Tcl_FirstHashEntry(&ay_bbc_cacheht, &search);
+  while(entry)
+    {
+      free(Tcl_GetHashValue(entry));
+      Tcl_DeleteHashEntry(entry);
+      entry = Tcl_NextHashEntry(&search);
+    }
+
+ return;
+} /* ay_bbc_uncache */
+
+
 /** ay_bbc_gettcmd:
  *  Get the bounding box of the selected objects;
  *  Implements the \a getBB scripting interface command.
@@ -433,3 +649,17 @@ ay_bbc_gettcmd(ClientData clientData, Tcl_Interp *interp,
  return TCL_OK;
 } /* ay_bbc_gettcmd */
 
+
+/** ay_bbc_init:
+ *  initialize the bounding box module
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_bbc_init(void)
+{
+
+  Tcl_InitHashTable(&ay_bbc_cacheht, TCL_ONE_WORD_KEYS);
+
+ return AY_OK;
+} /* ay_bbc_init */
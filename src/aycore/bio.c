@@ -0,0 +1,885 @@
+/*
+ * Ayam, a free 3D modeler for the RenderMan interface.
+ *
+ * Ayam is copyrighted 1998-2021 by Randolf Schultz
+ * (randolf.schultz@gmail.com) and others.
+ *
+ * All rights reserved.
+ *
+ * See the file License for details.
+ *
+ */
+
+#include "ayam.h"
+
+/* bio.c - binary scene file format */
+
+/*
+ * The binary scene file format consists of a header (the magic
+ * "AyamB\n", the format version, and the Ayam version string)
+ * followed by a sequence of chunks.
+ * Each chunk starts with a chunk id and the length of the chunk data
+ * (both unsigned 32 bit integers), so that readers may skip over
+ * unknown chunks.
+ * Object chunks contain the object type, attributes, tags, and
+ * the object data. The object data is written by a binary write
+ * callback (if the object type registered one using ay_bio_register())
+ * or by the normal (text) write callback of the object type.
+ * All numbers are stored in little endian byte order; arrays of
+ * doubles are stored as raw IEEE 754 values, so that they may be
+ * copied in bulk from/to the file on little endian machines.
+ */
+
+
+/* global variables: */
+
+ay_ftable ay_breadcbt;
+
+ay_ftable ay_bwritecbt;
+
+/* the byte order of doubles on this machine differs from the file */
+static int ay_bio_swapdoubles = AY_FALSE;
+
+
+/* local preprocessor definitions: */
+
+/* magic string at the start of a binary scene file */
+#define AY_BIOMAGIC "AyamB\n"
+
+/* version of the binary scene file format */
+#define AY_BIOVERSION 1
+
+/* chunk ids */
+#define AY_BIOCOBJECT 1
+
+/* object data formats */
+#define AY_BIODNONE   0
+#define AY_BIODTEXT   1
+#define AY_BIODBINARY 2
+
+/* number of doubles swapped at once when writing on big endian machines */
+#define AY_BIOSWAPBUFSIZE 512
+
+
+/* prototypes of functions local to this module: */
+
+void ay_bio_swapdouble(double *d);
+
+int ay_bio_writeattributes(FILE *fileptr, ay_object *o);
+
+int ay_bio_writetags(FILE *fileptr, ay_object *o);
+
+int ay_bio_readattributes(FILE *fileptr, ay_object *o);
+
+int ay_bio_readtags(FILE *fileptr, ay_object *o);
+
+
+/* functions: */
+
+/* ay_bio_register:
+ *  register the binary read and write callbacks for
+ *  objects of type type_id
+ */
+int
+ay_bio_register(ay_readcb *readcb, ay_writecb *writecb, unsigned int type_id)
+{
+ int ay_status = AY_OK;
+
+  if((ay_status = ay_table_addcallback(&ay_breadcbt, (ay_voidfp)readcb,
+				       type_id)))
+    return ay_status;
+
+  ay_status = ay_table_addcallback(&ay_bwritecbt, (ay_voidfp)writecb,
+				   type_id);
+
+ return ay_status;
+} /* ay_bio_register */
+
+
+/* ay_bio_swapdouble:
+ *  reverse the byte order of a double
+ */
+void
+ay_bio_swapdouble(double *d)
+{
+ unsigned char *c = (unsigned char *)d, t;
+ int i;
+
+  for(i = 0; i < (int)(sizeof(double)/2); i++)
+    {
+      t = c[i];
+      c[i] = c[sizeof(double)-1-i];
+      c[sizeof(double)-1-i] = t;
+    }
+
+ return;
+} /* ay_bio_swapdouble */
+
+
+/* ay_bio_writeuint:
+ *  write an unsigned integer (as 32 bit little endian number)
+ */
+int
+ay_bio_writeuint(FILE *fileptr, unsigned int u)
+{
+ unsigned char b[4];
+
+  b[0] = (unsigned char)(u & 0xff);
+  b[1] = (unsigned char)((u >> 8) & 0xff);
+  b[2] = (unsigned char)((u >> 16) & 0xff);
+  b[3] = (unsigned char)((u >> 24) & 0xff);
+
+  if(fwrite(b, 1, 4, fileptr) != 4)
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_bio_writeuint */
+
+
+/* ay_bio_writeint:
+ *  write an integer (as 32 bit little endian number)
+ */
+int
+ay_bio_writeint(FILE *fileptr, int i)
+{
+
+ return ay_bio_writeuint(fileptr, (unsigned int)i);
+} /* ay_bio_writeint */
+
+
+/* ay_bio_writeuints:
+ *  write an array of <n> unsigned integers
+ */
+int
+ay_bio_writeuints(FILE *fileptr, unsigned int n, unsigned int *u)
+{
+ int ay_status = AY_OK;
+ unsigned int i;
+
+  if(n && !u)
+    return AY_ENULL;
+
+  for(i = 0; i < n; i++)
+    {
+      if((ay_status = ay_bio_writeuint(fileptr, u[i])))
+	break;
+    }
+
+ return ay_status;
+} /* ay_bio_writeuints */
+
+
+/* ay_bio_writedoubles:
+ *  write an array of <n> doubles;
+ *  on little endian machines, the array is written in one go
+ */
+int
+ay_bio_writedoubles(FILE *fileptr, unsigned int n, double *d)
+{
+ double buf[AY_BIOSWAPBUFSIZE];
+ unsigned int i, j, m;
+
+  if(n && !d)
+    return AY_ENULL;
+
+  if(!ay_bio_swapdoubles)
+    {
+      if(fwrite(d, sizeof(double), n, fileptr) != n)
+	return AY_ERROR;
+      return AY_OK;
+    }
+
+  for(i = 0; i < n; i += AY_BIOSWAPBUFSIZE)
+    {
+      m = n - i;
+      if(m > AY_BIOSWAPBUFSIZE)
+	m = AY_BIOSWAPBUFSIZE;
+      memcpy(buf, &(d[i]), m*sizeof(double));
+      for(j = 0; j < m; j++)
+	ay_bio_swapdouble(&(buf[j]));
+      if(fwrite(buf, sizeof(double), m, fileptr) != m)
+	return AY_ERROR;
+    } /* for */
+
+ return AY_OK;
+} /* ay_bio_writedoubles */
+
+
+/* ay_bio_writestring:
+ *  write a (length prefixed) string, NULL strings are written
+ *  as empty strings
+ */
+int
+ay_bio_writestring(FILE *fileptr, char *str)
+{
+ int ay_status = AY_OK;
+ size_t len = 0;
+
+  if(str)
+    len = strlen(str);
+
+  if((ay_status = ay_bio_writeuint(fileptr, (unsigned int)len)))
+    return ay_status;
+
+  if(len && fwrite(str, 1, len, fileptr) != len)
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_bio_writestring */
+
+
+/* ay_bio_readuint:
+ *  read an unsigned integer (32 bit little endian number)
+ */
+int
+ay_bio_readuint(FILE *fileptr, unsigned int *u)
+{
+ unsigned char b[4];
+
+  if(fread(b, 1, 4, fileptr) != 4)
+    return AY_EUEOF;
+
+  *u = (unsigned int)b[0] | ((unsigned int)b[1] << 8) |
+    ((unsigned int)b[2] << 16) | ((unsigned int)b[3] << 24);
+
+ return AY_OK;
+} /* ay_bio_readuint */
+
+
+/* ay_bio_readint:
+ *  read an integer (32 bit little endian number)
+ */
+int
+ay_bio_readint(FILE *fileptr, int *i)
+{
+ int ay_status = AY_OK;
+ unsigned int u = 0;
+
+  if((ay_status = ay_bio_readuint(fileptr, &u)))
+    return ay_status;
+
+  *i = (int)u;
+
+ return AY_OK;
+} /* ay_bio_readint */
+
+
+/* ay_bio_readuints:
+ *  read an array of <n> unsigned integers
+ */
+int
+ay_bio_readuints(FILE *fileptr, unsigned int n, unsigned int *u)
+{
+ int ay_status = AY_OK;
+ unsigned int i;
+
+  if(n && !u)
+    return AY_ENULL;
+
+  for(i = 0; i < n; i++)
+    {
+      if((ay_status = ay_bio_readuint(fileptr, &(u[i]))))
+	break;
+    }
+
+ return ay_status;
+} /* ay_bio_readuints */
+
+
+/* ay_bio_readdoubles:
+ *  read an array of <n> doubles (in one go)
+ */
+int
+ay_bio_readdoubles(FILE *fileptr, unsigned int n, double *d)
+{
+ unsigned int i;
+
+  if(n && !d)
+    return AY_ENULL;
+
+  if(fread(d, sizeof(double), n, fileptr) != n)
+    return AY_EUEOF;
+
+  if(ay_bio_swapdoubles)
+    {
+      for(i = 0; i < n; i++)
+	ay_bio_swapdouble(&(d[i]));
+    }
+
+ return AY_OK;
+} /* ay_bio_readdoubles */
+
+
+/* ay_bio_readstring:
+ *  read a (length prefixed) string;
+ *  empty strings are returned as NULL
+ */
+int
+ay_bio_readstring(FILE *fileptr, char **result)
+{
+ int ay_status = AY_OK;
+ unsigned int len = 0;
+ char *str = NULL;
+
+  if((ay_status = ay_bio_readuint(fileptr, &len)))
+    return ay_status;
+
+  if(!len)
+    return AY_OK;
+
+  if(!(str = malloc(((size_t)len+1)*sizeof(char))))
+    return AY_EOMEM;
+
+  if(fread(str, 1, len, fileptr) != len)
+    {
+      free(str);
+      return AY_EUEOF;
+    }
+
+  str[len] = '\0';
+
+  *result = str;
+
+ return AY_OK;
+} /* ay_bio_readstring */
+
+
+/* ay_bio_writeheader:
+ *  write the binary scene file header
+ */
+int
+ay_bio_writeheader(FILE *fileptr)
+{
+ int ay_status = AY_OK;
+
+  if(fwrite(AY_BIOMAGIC, 1, strlen(AY_BIOMAGIC), fileptr) !=
+     strlen(AY_BIOMAGIC))
+    return AY_ERROR;
+
+  if((ay_status = ay_bio_writeuint(fileptr, AY_BIOVERSION)))
+    return ay_status;
+
+  ay_status = ay_bio_writestring(fileptr, AY_VERSIONSTR);
+
+ return ay_status;
+} /* ay_bio_writeheader */
+
+
+/* ay_bio_readheader:
+ *  read the binary scene file header
+ *  returns AY_EFORMAT if the file is not a binary scene file
+ *  (the file position is undefined then)
+ */
+int
+ay_bio_readheader(FILE *fileptr)
+{
+ int ay_status = AY_OK;
+ char buf[8], fname[] = "bio_readheader";
+ char *version = NULL;
+ unsigned int fversion = 0;
+ size_t len = strlen(AY_BIOMAGIC);
+
+  if(fread(buf, 1, len, fileptr) != len)
+    return AY_EFORMAT;
+
+  if(strncmp(buf, AY_BIOMAGIC, len))
+    return AY_EFORMAT;
+
+  if((ay_status = ay_bio_readuint(fileptr, &fversion)))
+    return ay_status;
+
+  if(fversion > AY_BIOVERSION)
+    {
+      ay_error(AY_ERROR, fname, "Unsupported binary format version.");
+      return AY_ERROR;
+    }
+
+  if((ay_status = ay_bio_readstring(fileptr, &version)))
+    return ay_status;
+
+  if(!version)
+    return AY_ERROR;
+
+  /* the text read callbacks need the version of the writer */
+  if(ay_read_setversion(version))
+    {
+      ay_error(AY_EWARN, fname, "Unknown file version, reading as V1.0!");
+    }
+
+  free(version);
+
+ return AY_OK;
+} /* ay_bio_readheader */
+
+
+/* ay_bio_writeattributes:
+ *  write standard object attributes
+ */
+int
+ay_bio_writeattributes(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ double trafos[13];
+
+  if((o->movx != 0.0) || (o->movy != 0.0) || (o->movz != 0.0) ||
+     (o->rotx != 0.0) || (o->roty != 0.0) || (o->rotz != 0.0) ||
+     (o->scalx != 1.0) || (o->scaly != 1.0) || (o->scalz != 1.0) ||
+     (o->quat[0] != 0.0) || (o->quat[1] != 0.0) || (o->quat[2] != 0.0) ||
+     (o->quat[3] != 1.0))
+    {
+      trafos[0] = o->movx;
+      trafos[1] = o->movy;
+      trafos[2] = o->movz;
+      trafos[3] = o->rotx;
+      trafos[4] = o->roty;
+      trafos[5] = o->rotz;
+      memcpy(&(trafos[6]), o->quat, 4*sizeof(double));
+      trafos[10] = o->scalx;
+      trafos[11] = o->scaly;
+      trafos[12] = o->scalz;
+
+      ay_status = ay_bio_writeint(fileptr, 1);
+      ay_status += ay_bio_writedoubles(fileptr, 13, trafos);
+    }
+  else
+    {
+      ay_status = ay_bio_writeint(fileptr, 0);
+    }
+
+  ay_status += ay_bio_writeint(fileptr, o->parent);
+  ay_status += ay_bio_writeint(fileptr, o->inherit_trafos);
+  ay_status += ay_bio_writeint(fileptr, o->hide);
+  ay_status += ay_bio_writeint(fileptr, o->hide_children);
+
+  ay_status += ay_bio_writestring(fileptr, o->name);
+
+  if(ay_status)
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_bio_writeattributes */
+
+
+/* ay_bio_writetags:
+ *  write all (non internal, non binary) tags
+ */
+int
+ay_bio_writetags(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_tag *tag = NULL;
+ unsigned int tcount = 0;
+ char *val;
+
+  /* binary PV tags are written in their string form */
+  tag = o->tags;
+  while(tag)
+    {
+      if(tag->name && tag->val && !tag->is_intern &&
+	 (!tag->is_binary || tag->type == ay_pv_tagtype))
+	tcount++;
+      tag = tag->next;
+    }
+
+  if((ay_status = ay_bio_writeuint(fileptr, tcount)))
+    return ay_status;
+
+  tag = o->tags;
+  while(tag)
+    {
+      if(tag->name && tag->val && !tag->is_intern && !tag->is_binary)
+	{
+	  ay_status = ay_bio_writestring(fileptr, tag->name);
+	  ay_status += ay_bio_writestring(fileptr, (char*)tag->val);
+	  if(ay_status)
+	    return AY_ERROR;
+	}
+      else
+      if(tag->name && tag->val && !tag->is_intern &&
+	 tag->type == ay_pv_tagtype)
+	{
+	  if((ay_status = ay_pv_tostring(tag, &val)))
+	    return ay_status;
+	  ay_status = ay_bio_writestring(fileptr, tag->name);
+	  ay_status += ay_bio_writestring(fileptr, val);
+	  free(val);
+	  if(ay_status)
+	    return AY_ERROR;
+	}
+      tag = tag->next;
+    }
+
+ return AY_OK;
+} /* ay_bio_writetags */
+
+
+/* ay_bio_writeobject:
+ *  write object <o> (and its children) as object chunk(s)
+ */
+int
+ay_bio_writeobject(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ char fname[] = "bio_writeobject";
+ ay_voidfp *arr = NULL;
+ ay_writecb *cb = NULL;
+ ay_object *down = NULL;
+ long start, end;
+ int dformat = AY_BIODNONE;
+
+  if(!o)
+    return AY_OK;
+
+  /* write chunk header, the length is filled in later */
+  ay_status = ay_bio_writeuint(fileptr, AY_BIOCOBJECT);
+  ay_status += ay_bio_writeuint(fileptr, 0);
+  if(ay_status)
+    return AY_ERROR;
+
+  start = ftell(fileptr);
+
+  if(o->type < AY_IDLAST)
+    {
+      ay_status = ay_bio_writeint(fileptr, 0);
+      ay_status += ay_bio_writeuint(fileptr, o->type);
+    }
+  else
+    {
+      ay_status = ay_bio_writeint(fileptr, 1);
+      ay_status += ay_bio_writestring(fileptr,
+				      ay_object_gettypename(o->type));
+    }
+
+  if(o->down && o->down->next)
+    ay_status += ay_bio_writeint(fileptr, 1);
+  else
+    ay_status += ay_bio_writeint(fileptr, 0);
+
+  if(ay_status)
+    return AY_ERROR;
+
+  if((ay_status = ay_bio_writeattributes(fileptr, o)))
+    {
+      ay_error(ay_status, fname, "error saving attributes");
+      return AY_ERROR;
+    }
+
+  if((ay_status = ay_bio_writetags(fileptr, o)))
+    {
+      ay_error(ay_status, fname, "error saving tags");
+      return AY_ERROR;
+    }
+
+  /* prefer the binary write callback, fall back to the text version */
+  arr = ay_bwritecbt.arr;
+  if(o->type < ay_bwritecbt.size)
+    cb = (ay_writecb *)(arr[o->type]);
+  if(cb)
+    {
+      dformat = AY_BIODBINARY;
+    }
+  else
+    {
+      arr = ay_writecbt.arr;
+      cb = (ay_writecb *)(arr[o->type]);
+      if(cb)
+	dformat = AY_BIODTEXT;
+    }
+
+  if((ay_status = ay_bio_writeint(fileptr, dformat)))
+    return AY_ERROR;
+
+  if(cb)
+    ay_status = cb(fileptr, o);
+
+  if(ay_status)
+    {
+      ay_error(ay_status, fname, "write callback failed");
+      return AY_ERROR;
+    }
+
+  /* fill in the chunk length */
+  end = ftell(fileptr);
+  if(start < 0 || end < start || (unsigned long)(end - start) > 0xffffffffUL)
+    {
+      ay_error(AY_ERROR, fname, "object too large");
+      return AY_ERROR;
+    }
+
+  if(fseek(fileptr, start - 4, SEEK_SET))
+    return AY_ERROR;
+  ay_status = ay_bio_writeuint(fileptr, (unsigned int)(end - start));
+  if(fseek(fileptr, end, SEEK_SET) || ay_status)
+    return AY_ERROR;
+
+  /* write children */
+  if(o->down && o->down->next)
+    {
+      down = o->down;
+      while(down)
+	{
+	  ay_status = ay_bio_writeobject(fileptr, down);
+	  if(ay_status)
+	    {
+	      return ay_status;
+	    }
+	  down = down->next;
+	}
+    }
+
+ return ay_status;
+} /* ay_bio_writeobject */
+
+
+/* ay_bio_readattributes:
+ *  read standard object attributes
+ */
+int
+ay_bio_readattributes(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ int has_trafos = 0;
+ double trafos[13];
+
+  if((ay_status = ay_bio_readint(fileptr, &has_trafos)))
+    return ay_status;
+
+  if(has_trafos)
+    {
+      if((ay_status = ay_bio_readdoubles(fileptr, 13, trafos)))
+	return ay_status;
+
+      o->movx = trafos[0];
+      o->movy = trafos[1];
+      o->movz = trafos[2];
+      o->rotx = trafos[3];
+      o->roty = trafos[4];
+      o->rotz = trafos[5];
+      memcpy(o->quat, &(trafos[6]), 4*sizeof(double));
+      o->scalx = trafos[10];
+      o->scaly = trafos[11];
+      o->scalz = trafos[12];
+
+      ay_quat_norm(o->quat);
+    }
+
+  ay_status = ay_bio_readint(fileptr, &(o->parent));
+  ay_status += ay_bio_readint(fileptr, &(o->inherit_trafos));
+  ay_status += ay_bio_readint(fileptr, &(o->hide));
+  ay_status += ay_bio_readint(fileptr, &(o->hide_children));
+
+  if(ay_status)
+    return AY_EUEOF;
+
+  ay_status = ay_bio_readstring(fileptr, &(o->name));
+
+ return ay_status;
+} /* ay_bio_readattributes */
+
+
+/* ay_bio_readtags:
+ *  read tags
+ */
+int
+ay_bio_readtags(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_tag *tag = NULL, **next = NULL;
+ unsigned int tcount = 0, i;
+
+  if((ay_status = ay_bio_readuint(fileptr, &tcount)))
+    return ay_status;
+
+  next = &(o->tags);
+
+  for(i = 0; i < tcount; i++)
+    {
+      if(!(tag = calloc(1, sizeof(ay_tag))))
+	return AY_EOMEM;
+
+      ay_status = ay_bio_readstring(fileptr, &(tag->name));
+
+      if(!ay_status && !tag->name)
+	ay_status = AY_ERROR;
+
+      if(!ay_status)
+	ay_status = ay_bio_readstring(fileptr, (char**)(void*)&(tag->val));
+
+      /* avoid null value */
+      if(!ay_status && !tag->val)
+	{
+	  if(!(tag->val = calloc(1, sizeof(char))))
+	    ay_status = AY_EOMEM;
+	}
+
+      if(!ay_status)
+	ay_status = ay_read_checktag(tag);
+
+      if(ay_status)
+	{
+	  ay_tags_free(tag);
+	  return ay_status;
+	}
+
+      *next = tag;
+      next = &(tag->next);
+    } /* for */
+
+ return AY_OK;
+} /* ay_bio_readtags */
+
+
+/* ay_bio_readobject:
+ *  read the next chunk; if it is an object chunk, create the object
+ *  and link it to the scene
+ *  returns AY_EEOF if there are no more chunks
+ */
+int
+ay_bio_readobject(FILE *fileptr)
+{
+ int ay_status = AY_OK;
+ char fname[] = "bio_readobject";
+ unsigned int id = 0, len = 0, type = 0;
+ int has_typename = 0, has_child = 0, dformat = AY_BIODNONE;
+ long start;
+ ay_object *o = NULL;
+ ay_voidfp *arr = NULL;
+ ay_readcb *cb = NULL;
+ char *typename = NULL;
+
+  if(ay_bio_readuint(fileptr, &id))
+    return AY_EEOF;
+
+  if((ay_status = ay_bio_readuint(fileptr, &len)))
+    return ay_status;
+
+  start = ftell(fileptr);
+
+  if(id != AY_BIOCOBJECT)
+    {
+      /* skip unknown chunk */
+      if(fseek(fileptr, start + (long)len, SEEK_SET))
+	return AY_EUEOF;
+      return AY_OK;
+    }
+
+  if((ay_status = ay_bio_readint(fileptr, &has_typename)))
+    return ay_status;
+
+  if(has_typename)
+    {
+      if((ay_status = ay_bio_readstring(fileptr, &typename)))
+	return ay_status;
+
+      if(!typename)
+	return AY_ERROR;
+
+      if(ay_read_typename(typename, &type))
+	{
+	  ay_error(AY_ENTYPE, fname, typename);
+	  free(typename);
+	  /* skip object */
+	  if(fseek(fileptr, start + (long)len, SEEK_SET))
+	    return AY_EUEOF;
+	  return AY_OK;
+	}
+      free(typename);
+    }
+  else
+    {
+      if((ay_status = ay_bio_readuint(fileptr, &type)))
+	return ay_status;
+    } /* if */
+
+  if(type >= ay_readcbt.size)
+    {
+      ay_error(AY_ENTYPE, fname, NULL);
+      if(fseek(fileptr, start + (long)len, SEEK_SET))
+	return AY_EUEOF;
+      return AY_OK;
+    }
+
+  if((ay_status = ay_bio_readint(fileptr, &has_child)))
+    return ay_status;
+
+  if(!(o = calloc(1, sizeof(ay_object))))
+    return AY_EOMEM;
+
+  ay_object_defaults(o);
+
+  o->type = type;
+
+  ay_status = ay_bio_readattributes(fileptr, o);
+  if(ay_status)
+    { ay_object_delete(o); return ay_status; }
+
+  ay_status = ay_bio_readtags(fileptr, o);
+  if(ay_status)
+    { ay_object_delete(o); return ay_status; }
+
+  ay_status = ay_bio_readint(fileptr, &dformat);
+  if(ay_status)
+    { ay_object_delete(o); return ay_status; }
+
+  switch(dformat)
+    {
+    case AY_BIODBINARY:
+      if(type < ay_breadcbt.size)
+	{
+	  arr = ay_breadcbt.arr;
+	  cb = (ay_readcb *)(arr[type]);
+	}
+      if(!cb)
+	{
+	  ay_error(AY_ERROR, fname, "no binary read callback registered");
+	  ay_object_delete(o);
+	  if(fseek(fileptr, start + (long)len, SEEK_SET))
+	    return AY_EUEOF;
+	  return AY_OK;
+	}
+      break;
+    case AY_BIODTEXT:
+      arr = ay_readcbt.arr;
+      cb = (ay_readcb *)(arr[type]);
+      break;
+    default:
+      break;
+    } /* switch */
+
+  ay_status = ay_read_linkobject(fileptr, o, has_child, cb);
+
+  /* the read callbacks (esp. the text versions) may not consume
+     exactly all data of the object (fscanf() skips white space),
+     thus, we always reposition to the end of the chunk */
+  if(fseek(fileptr, start + (long)len, SEEK_SET))
+    return AY_EUEOF;
+
+ return ay_status;
+} /* ay_bio_readobject */
+
+
+/* ay_bio_init:
+ *  initialize the binary scene file module
+ */
+int
+ay_bio_init(Tcl_Interp *interp)
+{
+ int ay_status = AY_OK;
+ double d = 1.0;
+ unsigned char *c = (unsigned char *)&d;
+
+  if((ay_status = ay_table_initftable(&ay_breadcbt)))
+    return ay_status;
+
+  if((ay_status = ay_table_initftable(&ay_bwritecbt)))
+    return ay_status;
+
+  /* on little endian machines, the last byte of 1.0 is the
+     sign/exponent byte */
+  if(c[sizeof(double)-1] == 0x3f)
+    ay_bio_swapdoubles = AY_FALSE;
+  else
+    ay_bio_swapdoubles = AY_TRUE;
+
+ return ay_status;
+} /* ay_bio_init */
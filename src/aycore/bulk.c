@@ -0,0 +1,1192 @@
+/*
+ * Ayam, a free 3D modeler for the RenderMan interface.
+ *
+ * Ayam is copyrighted 1998-2024 by Randolf Schultz
+ * (randolf.schultz@gmail.com) and others.
+ *
+ * All rights reserved.
+ *
+ * See the file License for details.
+ *
+ */
+
+#include "ayam.h"
+
+/* bulk.c - Tcl_Obj based bulk access to geometric data of objects */
+
+/* the kinds of data that may be transferred */
+#define AY_BULKPOINTS 0
+#define AY_BULKKNOTS  1
+#define AY_BULKUKNOTS 2
+#define AY_BULKVKNOTS 3
+#define AY_BULKFACES  4
+#define AY_BULKTESS   5
+
+/* prototypes of functions local to this module: */
+
+int ay_bulk_getwhat(char *arg, int *what);
+
+Tcl_Obj *ay_bulk_newdlist(unsigned int n, double *dv, int binary);
+
+Tcl_Obj *ay_bulk_newulist(unsigned int n, unsigned int *uv, int binary);
+
+int ay_bulk_getdlist(Tcl_Interp *interp, Tcl_Obj *to, int binary,
+		     unsigned int *n, double **dv);
+
+int ay_bulk_getulist(Tcl_Interp *interp, Tcl_Obj *to, int binary,
+		     unsigned int *n, unsigned int **uv);
+
+void ay_bulk_applynormal(double *n, double *mi);
+
+Tcl_Obj *ay_bulk_getpoints(char *fname, ay_object *o, double *m,
+			   int binary);
+
+Tcl_Obj *ay_bulk_getknots(char *fname, ay_object *o, int what, int binary);
+
+Tcl_Obj *ay_bulk_getfaces(char *fname, ay_object *o, int binary);
+
+Tcl_Obj *ay_bulk_gettess(char *fname, ay_object *o, double *pm, int mode,
+			 int binary);
+
+int ay_bulk_setpoints(Tcl_Interp *interp, char *fname, ay_object *o,
+		      double *m, Tcl_Obj *to, int binary);
+
+int ay_bulk_setknots(Tcl_Interp *interp, char *fname, ay_object *o,
+		     int what, Tcl_Obj *to, int binary);
+
+int ay_bulk_setfaces(Tcl_Interp *interp, char *fname, ay_object *o,
+		     Tcl_Obj *to, int binary);
+
+
+/* functions: */
+
+/** ay_bulk_getwhat:
+ *  parse the kind of data argument of getGeom/setGeom
+ *
+ * \param[in] arg argument to parse
+ * \param[in,out] what where to store the kind of data (AY_BULK*)
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_bulk_getwhat(char *arg, int *what)
+{
+
+  if(!strcmp(arg, "points"))
+    *what = AY_BULKPOINTS;
+  else if(!strcmp(arg, "knots"))
+    *what = AY_BULKKNOTS;
+  else if(!strcmp(arg, "uknots"))
+    *what = AY_BULKUKNOTS;
+  else if(!strcmp(arg, "vknots"))
+    *what = AY_BULKVKNOTS;
+  else if(!strcmp(arg, "faces"))
+    *what = AY_BULKFACES;
+  else if(!strcmp(arg, "tess"))
+    *what = AY_BULKTESS;
+  else
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_bulk_getwhat */
+
+
+/** ay_bulk_newdlist:
+ *  create a new Tcl_Obj from an array of doubles in one go
+ *
+ * \param[in] n number of elements in \a dv
+ * \param[in] dv array of doubles
+ * \param[in] binary if AY_TRUE, create a byte array of native doubles,
+ *  otherwise a list
+ *
+ * \returns new Tcl_Obj or NULL on error
+ */
+Tcl_Obj *
+ay_bulk_newdlist(unsigned int n, double *dv, int binary)
+{
+ Tcl_Obj **objv, *res;
+ unsigned int i;
+
+  if(binary)
+    return Tcl_NewByteArrayObj((unsigned char*)dv, (int)(n*sizeof(double)));
+
+  if(!n)
+    return Tcl_NewListObj(0, NULL);
+
+  if(!(objv = malloc(n*sizeof(Tcl_Obj*))))
+    return NULL;
+
+  for(i = 0; i < n; i++)
+    objv[i] = Tcl_NewDoubleObj(dv[i]);
+
+  res = Tcl_NewListObj((int)n, objv);
+
+  free(objv);
+
+ return res;
+} /* ay_bulk_newdlist */
+
+
+/** ay_bulk_newulist:
+ *  create a new Tcl_Obj from an array of unsigned integers in one go
+ *
+ * \param[in] n number of elements in \a uv
+ * \param[in] uv array of unsigned integers
+ * \param[in] binary if AY_TRUE, create a byte array of native unsigned
+ *  integers, otherwise a list
+ *
+ * \returns new Tcl_Obj or NULL on error
+ */
+Tcl_Obj *
+ay_bulk_newulist(unsigned int n, unsigned int *uv, int binary)
+{
+ Tcl_Obj **objv, *res;
+ unsigned int i;
+
+  if(binary)
+    return Tcl_NewByteArrayObj((unsigned char*)uv,
+			       (int)(n*sizeof(unsigned int)));
+
+  if(!n)
+    return Tcl_NewListObj(0, NULL);
+
+  if(!(objv = malloc(n*sizeof(Tcl_Obj*))))
+    return NULL;
+
+  for(i = 0; i < n; i++)
+    objv[i] = Tcl_NewLongObj((long)uv[i]);
+
+  res = Tcl_NewListObj((int)n, objv);
+
+  free(objv);
+
+ return res;
+} /* ay_bulk_newulist */
+
+
+/** ay_bulk_getdlist:
+ *  convert a Tcl_Obj (list or byte array) to a new array of doubles
+ *
+ * \param[in] interp Tcl interpreter to use
+ * \param[in] to Tcl_Obj to convert
+ * \param[in] binary if AY_TRUE, \a to is a byte array of native doubles
+ * \param[in,out] n where to store the number of elements
+ * \param[in,out] dv where to store the new array
+ *
+ * \returns TCL_OK on success, TCL_ERROR otherwise.
+ */
+int
+ay_bulk_getdlist(Tcl_Interp *interp, Tcl_Obj *to, int binary,
+		 unsigned int *n, double **dv)
+{
+ int tcl_status = TCL_OK, i, len = 0;
+ unsigned char *b;
+ Tcl_Obj **objv;
+ double *v;
+
+  if(binary)
+    {
+      b = Tcl_GetByteArrayFromObj(to, &len);
+      if(len % sizeof(double))
+	{
+	  Tcl_SetResult(interp, "byte array length is not a multiple of 8",
+			TCL_STATIC);
+	  return TCL_ERROR;
+	}
+      len /= sizeof(double);
+      if(!(v = malloc((len?len:1)*sizeof(double))))
+	{
+	  Tcl_SetResult(interp, "out of memory", TCL_STATIC);
+	  return TCL_ERROR;
+	}
+      memcpy(v, b, len*sizeof(double));
+    }
+  else
+    {
+      tcl_status = Tcl_ListObjGetElements(interp, to, &len, &objv);
+      if(tcl_status != TCL_OK)
+	return tcl_status;
+      if(!(v = malloc((len?len:1)*sizeof(double))))
+	{
+	  Tcl_SetResult(interp, "out of memory", TCL_STATIC);
+	  return TCL_ERROR;
+	}
+      for(i = 0; i < len; i++)
+	{
+	  tcl_status = Tcl_GetDoubleFromObj(interp, objv[i], &(v[i]));
+	  if(tcl_status != TCL_OK)
+	    {
+	      free(v);
+	      return tcl_status;
+	    }
+	}
+    } /* if */
+
+  *n = (unsigned int)len;
+  *dv = v;
+
+ return TCL_OK;
+} /* ay_bulk_getdlist */
+
+
+/** ay_bulk_getulist:
+ *  convert a Tcl_Obj (list or byte array) to a new array of
+ *  unsigned integers
+ *
+ * \param[in] interp Tcl interpreter to use
+ * \param[in] to Tcl_Obj to convert
+ * \param[in] binary if AY_TRUE, \a to is a byte array of native
+ *  unsigned integers
+ * \param[in,out] n where to store the number of elements
+ * \param[in,out] uv where to store the new array
+ *
+ * \returns TCL_OK on success, TCL_ERROR otherwise.
+ */
+int
+ay_bulk_getulist(Tcl_Interp *interp, Tcl_Obj *to, int binary,
+		 unsigned int *n, unsigned int **uv)
+{
+ int tcl_status = TCL_OK, i, len = 0;
+ unsigned char *b;
+ Tcl_Obj **objv;
+ unsigned int *v;
+ long l;
+
+  if(binary)
+    {
+      b = Tcl_GetByteArrayFromObj(to, &len);
+      if(len % sizeof(unsigned int))
+	{
+	  Tcl_SetResult(interp, "byte array length is not a multiple of 4",
+			TCL_STATIC);
+	  return TCL_ERROR;
+	}
+      len /= sizeof(unsigned int);
+      if(!(v = malloc((len?len:1)*sizeof(unsigned int))))
+	{
+	  Tcl_SetResult(interp, "out of memory", TCL_STATIC);
+	  return TCL_ERROR;
+	}
+      memcpy(v, b, len*sizeof(unsigned int));
+    }
+  else
+    {
+      tcl_status = Tcl_ListObjGetElements(interp, to, &len, &objv);
+      if(tcl_status != TCL_OK)
+	return tcl_status;
+      if(!(v = malloc((len?len:1)*sizeof(unsigned int))))
+	{
+	  Tcl_SetResult(interp, "out of memory", TCL_STATIC);
+	  return TCL_ERROR;
+	}
+      for(i = 0; i < len; i++)
+	{
+	  tcl_status = Tcl_GetLongFromObj(interp, objv[i], &l);
+	  if(tcl_status == TCL_OK && l < 0)
+	    {
+	      Tcl_SetResult(interp, "negative index", TCL_STATIC);
+	      tcl_status = TCL_ERROR;
+	    }
+	  if(tcl_status != TCL_OK)
+	    {
+	      free(v);
+	      return tcl_status;
+	    }
+	  v[i] = (unsigned int)l;
+	}
+    } /* if */
+
+  *n = (unsigned int)len;
+  *uv = v;
+
+ return TCL_OK;
+} /* ay_bulk_getulist */
+
+
+/** ay_bulk_applynormal:
+ *  transform a normal by the transposed inverse of a transformation
+ *  matrix and normalize it again
+ *
+ * \param[in,out] n normal to transform
+ * \param[in] mi inverse transformation matrix
+ */
+void
+ay_bulk_applynormal(double *n, double *mi)
+{
+ double t[3], len;
+
+  t[0] = mi[0]*n[0] + mi[1]*n[1] + mi[2]*n[2];
+  t[1] = mi[4]*n[0] + mi[5]*n[1] + mi[6]*n[2];
+  t[2] = mi[8]*n[0] + mi[9]*n[1] + mi[10]*n[2];
+
+  len = AY_V3LEN(t);
+  if(len > AY_EPSILON)
+    {
+      AY_V3SCAL(t, 1.0/len);
+    }
+
+  memcpy(n, t, 3*sizeof(double));
+
+ return;
+} /* ay_bulk_applynormal */
+
+
+/** ay_bulk_getpoints:
+ *  get all (editable) points of an object
+ *
+ * \param[in] fname name of calling command (for error reporting)
+ * \param[in] o object to process
+ * \param[in] m transformation to apply to the points (may be NULL)
+ * \param[in] binary create a byte array instead of a list
+ *
+ * \returns new Tcl_Obj or NULL on error
+ */
+Tcl_Obj *
+ay_bulk_getpoints(char *fname, ay_object *o, double *m, int binary)
+{
+ ay_pointedit pe = {0};
+ double p[4] = {0}, *dv = NULL, *q;
+ unsigned int i, stride;
+ Tcl_Obj *res = NULL;
+
+  (void)ay_pact_getpoint(0, o, p, &pe);
+
+  stride = (pe.type == AY_PTRAT)?4:3;
+
+  if(pe.num)
+    {
+      if(!(dv = malloc(pe.num*stride*sizeof(double))))
+	{
+	  ay_pact_clearpointedit(&pe);
+	  ay_error(AY_EOMEM, fname, NULL);
+	  return NULL;
+	}
+
+      q = dv;
+      for(i = 0; i < pe.num; i++)
+	{
+	  memcpy(q, pe.coords[i], stride*sizeof(double));
+	  if(m)
+	    ay_trafo_apply3(q, m);
+	  q += stride;
+	}
+    }
+
+  if(!(res = ay_bulk_newdlist(pe.num*stride, dv, binary)))
+    ay_error(AY_EOMEM, fname, NULL);
+
+  ay_pact_clearpointedit(&pe);
+
+  if(dv)
+    free(dv);
+
+ return res;
+} /* ay_bulk_getpoints */
+
+
+/** ay_bulk_getknots:
+ *  get the knot vector of a NURBS curve or a knot vector of
+ *  a NURBS patch
+ *
+ * \param[in] fname name of calling command (for error reporting)
+ * \param[in] o object to process
+ * \param[in] what which knots (AY_BULKKNOTS, AY_BULKUKNOTS, AY_BULKVKNOTS)
+ * \param[in] binary create a byte array instead of a list
+ *
+ * \returns new Tcl_Obj or NULL on error
+ */
+Tcl_Obj *
+ay_bulk_getknots(char *fname, ay_object *o, int what, int binary)
+{
+ ay_nurbcurve_object *nc;
+ ay_nurbpatch_object *np;
+ Tcl_Obj *res;
+
+  if(what == AY_BULKKNOTS)
+    {
+      if(o->type != AY_IDNCURVE)
+	{
+	  ay_error(AY_ERROR, fname, "Object is not a NCurve.");
+	  return NULL;
+	}
+      nc = (ay_nurbcurve_object*)o->refine;
+      res = ay_bulk_newdlist(nc->length+nc->order, nc->knotv, binary);
+    }
+  else
+    {
+      if(o->type != AY_IDNPATCH)
+	{
+	  ay_error(AY_ERROR, fname, "Object is not a NPatch.");
+	  return NULL;
+	}
+
+      np = (ay_nurbpatch_object*)o->refine;
+
+      if(what == AY_BULKUKNOTS)
+	res = ay_bulk_newdlist(np->width+np->uorder, np->uknotv, binary);
+      else
+	res = ay_bulk_newdlist(np->height+np->vorder, np->vknotv, binary);
+    } /* if */
+
+  if(!res)
+    ay_error(AY_EOMEM, fname, NULL);
+
+ return res;
+} /* ay_bulk_getknots */
+
+
+/** ay_bulk_getfaces:
+ *  get the index arrays of a PolyMesh as list {nloops nverts verts}
+ *
+ * \param[in] fname name of calling command (for error reporting)
+ * \param[in] o object to process
+ * \param[in] binary create byte arrays instead of lists
+ *
+ * \returns new Tcl_Obj or NULL on error
+ */
+Tcl_Obj *
+ay_bulk_getfaces(char *fname, ay_object *o, int binary)
+{
+ ay_pomesh_object *po;
+ unsigned int i, totalloops = 0, totalverts = 0;
+ Tcl_Obj *objv[3];
+
+  if(o->type != AY_IDPOMESH)
+    {
+      ay_error(AY_ERROR, fname, "Object is not a PolyMesh.");
+      return NULL;
+    }
+
+  po = (ay_pomesh_object*)o->refine;
+
+  for(i = 0; i < po->npolys; i++)
+    totalloops += po->nloops[i];
+  for(i = 0; i < totalloops; i++)
+    totalverts += po->nverts[i];
+
+  objv[0] = ay_bulk_newulist(po->npolys, po->nloops, binary);
+  objv[1] = ay_bulk_newulist(totalloops, po->nverts, binary);
+  objv[2] = ay_bulk_newulist(totalverts, po->verts, binary);
+
+  if(!objv[0] || !objv[1] || !objv[2])
+    {
+      for(i = 0; i < 3; i++)
+	if(objv[i])
+	  Tcl_DecrRefCount(objv[i]);
+      ay_error(AY_EOMEM, fname, NULL);
+      return NULL;
+    }
+
+ return Tcl_NewListObj(3, objv);
+} /* ay_bulk_getfaces */
+
+
+/** ay_bulk_gettess:
+ *  get the tesselation of an object (a PolyMesh, the PolyMesh
+ *  objects it provides, or the tesselations of the NURBS patches
+ *  it provides) as list {points normals nloops nverts verts};
+ *  multiple provided PolyMesh objects are merged, normals are only
+ *  delivered if all of them have vertex normals
+ *
+ * \param[in] fname name of calling command (for error reporting)
+ * \param[in] o object to process
+ * \param[in] pm parent transformation (only used if \a mode is 2)
+ * \param[in] mode 0 - object space, 1 - apply the transformations
+ *  of the object, 2 - world space
+ * \param[in] binary create byte arrays instead of lists
+ *
+ * \returns new Tcl_Obj or NULL on error
+ */
+Tcl_Obj *
+ay_bulk_gettess(char *fname, ay_object *o, double *pm, int mode, int binary)
+{
+ ay_object *po = NULL, *np = NULL, *t, **next;
+ ay_pomesh_object *pomesh;
+ unsigned int i, j, k, stride, totalloops, totalverts;
+ unsigned int npolys = 0, nloops = 0, nverts = 0, ncontrols = 0, vbase = 0;
+ unsigned int *nloopsv = NULL, *nvertsv = NULL, *vertsv = NULL;
+ double *pv = NULL, *nv = NULL, m[16], mi[16], oi[16];
+ int has_normals = AY_TRUE, identity;
+ Tcl_Obj *objv[5], *res = NULL;
+
+  if(o->type == AY_IDPOMESH)
+    {
+      t = o;
+    }
+  else
+    {
+      (void)ay_provide_object(o, AY_IDPOMESH, &po);
+      if(!po)
+	{
+	  /* tesselate the NURBS patches the object provides */
+	  (void)ay_provide_object(o, AY_IDNPATCH, &np);
+	  next = &po;
+	  t = np;
+	  while(t)
+	    {
+	      (void)ay_provide_object(t, AY_IDPOMESH, next);
+	      while(*next)
+		next = &((*next)->next);
+	      t = t->next;
+	    }
+	  if(np)
+	    (void)ay_object_deletemulti(np, AY_FALSE);
+	}
+      if(!po)
+	{
+	  ay_error(AY_ERROR, fname, "Could not tesselate object.");
+	  return NULL;
+	}
+      t = po;
+    }
+
+  /* count */
+  while(t)
+    {
+      if(t->type == AY_IDPOMESH)
+	{
+	  pomesh = (ay_pomesh_object*)t->refine;
+	  totalloops = 0;
+	  for(i = 0; i < pomesh->npolys; i++)
+	    totalloops += pomesh->nloops[i];
+	  for(i = 0; i < totalloops; i++)
+	    nverts += pomesh->nverts[i];
+	  npolys += pomesh->npolys;
+	  nloops += totalloops;
+	  ncontrols += pomesh->ncontrols;
+	  if(!pomesh->has_normals)
+	    has_normals = AY_FALSE;
+	}
+      if(t == o)
+	break;
+      t = t->next;
+    }
+
+  if(!(pv = malloc((ncontrols?ncontrols:1)*3*sizeof(double))) ||
+     !(nv = malloc((ncontrols?ncontrols:1)*3*sizeof(double))) ||
+     !(nloopsv = malloc((npolys?npolys:1)*sizeof(unsigned int))) ||
+     !(nvertsv = malloc((nloops?nloops:1)*sizeof(unsigned int))) ||
+     !(vertsv = malloc((nverts?nverts:1)*sizeof(unsigned int))))
+    {
+      ay_error(AY_EOMEM, fname, NULL);
+      goto cleanup;
+    }
+
+  /* the vertices of the tesselation must end up in the space
+     of the original object, even if a provided PolyMesh carries
+     transformations of its own */
+  if(mode == 0)
+    {
+      ay_trafo_identitymatrix(m);
+      ay_trafo_getall(NULL, o, m);
+      ay_trafo_invmatrix(m, oi);
+    }
+
+  /* merge */
+  npolys = 0;
+  nloops = 0;
+  nverts = 0;
+  t = po?po:o;
+  while(t)
+    {
+      if(t->type == AY_IDPOMESH)
+	{
+	  pomesh = (ay_pomesh_object*)t->refine;
+	  stride = pomesh->has_normals?6:3;
+
+	  identity = AY_FALSE;
+	  if(mode == 0)
+	    {
+	      if(t == o || ay_comp_trafos(o, t))
+		{
+		  identity = AY_TRUE;
+		}
+	      else
+		{
+		  memcpy(m, oi, 16*sizeof(double));
+		  ay_trafo_getall(NULL, t, m);
+		}
+	    }
+	  else
+	    {
+	      if(mode == 2)
+		memcpy(m, pm, 16*sizeof(double));
+	      else
+		ay_trafo_identitymatrix(m);
+	      ay_trafo_getall(NULL, t, m);
+	    }
+	  if(!identity && has_normals)
+	    ay_trafo_invmatrix(m, mi);
+
+	  for(i = 0; i < pomesh->ncontrols; i++)
+	    {
+	      j = (vbase+i)*3;
+	      memcpy(&(pv[j]), &(pomesh->controlv[i*stride]),
+		     3*sizeof(double));
+	      if(!identity)
+		ay_trafo_apply3(&(pv[j]), m);
+	      if(has_normals)
+		{
+		  memcpy(&(nv[j]), &(pomesh->controlv[i*stride+3]),
+			 3*sizeof(double));
+		  if(!identity)
+		    ay_bulk_applynormal(&(nv[j]), mi);
+		}
+	    }
+
+	  totalloops = 0;
+	  for(i = 0; i < pomesh->npolys; i++)
+	    {
+	      nloopsv[npolys+i] = pomesh->nloops[i];
+	      totalloops += pomesh->nloops[i];
+	    }
+	  totalverts = 0;
+	  for(i = 0; i < totalloops; i++)
+	    {
+	      nvertsv[nloops+i] = pomesh->nverts[i];
+	      totalverts += pomesh->nverts[i];
+	    }
+	  for(k = 0; k < totalverts; k++)
+	    vertsv[nverts+k] = pomesh->verts[k]+vbase;
+
+	  npolys += pomesh->npolys;
+	  nloops += totalloops;
+	  nverts += totalverts;
+	  vbase += pomesh->ncontrols;
+	} /* if */
+      if(t == o)
+	break;
+      t = t->next;
+    } /* while */
+
+  objv[0] = ay_bulk_newdlist(ncontrols*3, pv, binary);
+  objv[1] = ay_bulk_newdlist(has_normals?ncontrols*3:0, nv, binary);
+  objv[2] = ay_bulk_newulist(npolys, nloopsv, binary);
+  objv[3] = ay_bulk_newulist(nloops, nvertsv, binary);
+  objv[4] = ay_bulk_newulist(nverts, vertsv, binary);
+
+  for(i = 0; i < 5; i++)
+    if(!objv[i])
+      break;
+
+  if(i < 5)
+    {
+      for(i = 0; i < 5; i++)
+	if(objv[i])
+	  Tcl_DecrRefCount(objv[i]);
+      ay_error(AY_EOMEM, fname, NULL);
+      goto cleanup;
+    }
+
+  res = Tcl_NewListObj(5, objv);
+
+cleanup:
+
+  if(pv)
+    free(pv);
+  if(nv)
+    free(nv);
+  if(nloopsv)
+    free(nloopsv);
+  if(nvertsv)
+    free(nvertsv);
+  if(vertsv)
+    free(vertsv);
+
+  if(po)
+    (void)ay_object_deletemulti(po, AY_FALSE);
+
+ return res;
+} /* ay_bulk_gettess */
+
+
+/** ay_bulk_setpoints:
+ *  set all (editable) points of an object
+ *
+ * \param[in] interp Tcl interpreter to use
+ * \param[in] fname name of calling command (for error reporting)
+ * \param[in,out] o object to process
+ * \param[in] m inverse transformation to apply to the points (may be NULL)
+ * \param[in] to new coordinates
+ * \param[in] binary \a to is a byte array instead of a list
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_bulk_setpoints(Tcl_Interp *interp, char *fname, ay_object *o, double *m,
+		  Tcl_Obj *to, int binary)
+{
+ int tcl_status = TCL_OK, ay_status = AY_ERROR;
+ ay_pointedit pe = {0};
+ double p[4] = {0}, *dv = NULL, *q;
+ unsigned int i, n = 0, stride;
+
+  tcl_status = ay_bulk_getdlist(interp, to, binary, &n, &dv);
+  AY_CHTCLERRGOT(tcl_status, fname, interp);
+
+  (void)ay_pact_getpoint(0, o, p, &pe);
+
+  if(!pe.num || pe.readonly)
+    {
+      ay_error(AY_ERROR, fname, "Object has no editable points.");
+      ay_status = AY_ERROR;
+      goto cleanup;
+    }
+
+  stride = (pe.type == AY_PTRAT)?4:3;
+
+  if(n != pe.num*stride)
+    {
+      ay_error(AY_ERROR, fname, "Wrong number of coordinates provided.");
+      ay_status = AY_ERROR;
+      goto cleanup;
+    }
+
+  q = dv;
+  for(i = 0; i < pe.num; i++)
+    {
+      if(m)
+	ay_trafo_apply3(q, m);
+      memcpy(pe.coords[i], q, stride*sizeof(double));
+      q += stride;
+    }
+
+  ay_status = AY_OK;
+
+cleanup:
+
+  ay_pact_clearpointedit(&pe);
+
+  if(dv)
+    free(dv);
+
+ return ay_status;
+} /* ay_bulk_setpoints */
+
+
+/** ay_bulk_setknots:
+ *  set the knot vector of a NURBS curve or a knot vector of
+ *  a NURBS patch; the knot type is switched to custom
+ *
+ * \param[in] interp Tcl interpreter to use
+ * \param[in] fname name of calling command (for error reporting)
+ * \param[in,out] o object to process
+ * \param[in] what which knots (AY_BULKKNOTS, AY_BULKUKNOTS, AY_BULKVKNOTS)
+ * \param[in] to new knots
+ * \param[in] binary \a to is a byte array instead of a list
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_bulk_setknots(Tcl_Interp *interp, char *fname, ay_object *o, int what,
+		 Tcl_Obj *to, int binary)
+{
+ int tcl_status = TCL_OK, ay_status = AY_ERROR;
+ ay_nurbcurve_object *nc = NULL;
+ ay_nurbpatch_object *np = NULL;
+ double *dv = NULL, *kv;
+ unsigned int n = 0;
+ int len, order;
+
+  if(what == AY_BULKKNOTS)
+    {
+      if(o->type != AY_IDNCURVE)
+	{
+	  ay_error(AY_ERROR, fname, "Object is not a NCurve.");
+	  return AY_ERROR;
+	}
+      nc = (ay_nurbcurve_object*)o->refine;
+      len = nc->length;
+      order = nc->order;
+      kv = nc->knotv;
+    }
+  else
+    {
+      if(o->type != AY_IDNPATCH)
+	{
+	  ay_error(AY_ERROR, fname, "Object is not a NPatch.");
+	  return AY_ERROR;
+	}
+      np = (ay_nurbpatch_object*)o->refine;
+      if(what == AY_BULKUKNOTS)
+	{
+	  len = np->width;
+	  order = np->uorder;
+	  kv = np->uknotv;
+	}
+      else
+	{
+	  len = np->height;
+	  order = np->vorder;
+	  kv = np->vknotv;
+	}
+    } /* if */
+
+  tcl_status = ay_bulk_getdlist(interp, to, binary, &n, &dv);
+  AY_CHTCLERRGOT(tcl_status, fname, interp);
+
+  if((ay_status = ay_knots_check(len, order, (int)n, dv)))
+    {
+      ay_knots_printerr(fname, ay_status);
+      ay_status = AY_ERROR;
+      goto cleanup;
+    }
+
+  memcpy(kv, dv, n*sizeof(double));
+
+  if(nc)
+    nc->knot_type = AY_KTCUSTOM;
+  else
+    if(what == AY_BULKUKNOTS)
+      np->uknot_type = AY_KTCUSTOM;
+    else
+      np->vknot_type = AY_KTCUSTOM;
+
+cleanup:
+
+  if(dv)
+    free(dv);
+
+ return ay_status;
+} /* ay_bulk_setknots */
+
+
+/** ay_bulk_setfaces:
+ *  set the index arrays of a PolyMesh from a list {nloops nverts verts};
+ *  the number of control points of the PolyMesh is not changed
+ *
+ * \param[in] interp Tcl interpreter to use
+ * \param[in] fname name of calling command (for error reporting)
+ * \param[in,out] o object to process
+ * \param[in] to new index arrays
+ * \param[in] binary the elements of \a to are byte arrays instead of lists
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_bulk_setfaces(Tcl_Interp *interp, char *fname, ay_object *o,
+		 Tcl_Obj *to, int binary)
+{
+ int tcl_status = TCL_OK, ay_status = AY_ERROR, objc = 0;
+ ay_pomesh_object *po;
+ Tcl_Obj **objv;
+ unsigned int i, sum, npolys = 0, nloops = 0, nverts = 0;
+ unsigned int *nloopsv = NULL, *nvertsv = NULL, *vertsv = NULL;
+
+  if(o->type != AY_IDPOMESH)
+    {
+      ay_error(AY_ERROR, fname, "Object is not a PolyMesh.");
+      return AY_ERROR;
+    }
+
+  po = (ay_pomesh_object*)o->refine;
+
+  tcl_status = Tcl_ListObjGetElements(interp, to, &objc, &objv);
+  AY_CHTCLERRGOT(tcl_status, fname, interp);
+
+  if(objc != 3)
+    {
+      ay_error(AY_ERROR, fname, "Expected a list of three index arrays.");
+      return AY_ERROR;
+    }
+
+  tcl_status = ay_bulk_getulist(interp, objv[0], binary, &npolys, &nloopsv);
+  AY_CHTCLERRGOT(tcl_status, fname, interp);
+  tcl_status = ay_bulk_getulist(interp, objv[1], binary, &nloops, &nvertsv);
+  AY_CHTCLERRGOT(tcl_status, fname, interp);
+  tcl_status = ay_bulk_getulist(interp, objv[2], binary, &nverts, &vertsv);
+  AY_CHTCLERRGOT(tcl_status, fname, interp);
+
+  /* check consistency */
+  sum = 0;
+  for(i = 0; i < npolys; i++)
+    sum += nloopsv[i];
+  if(sum != nloops)
+    {
+      ay_error(AY_ERROR, fname, "Number of loops does not match nloops.");
+      goto cleanup;
+    }
+  sum = 0;
+  for(i = 0; i < nloops; i++)
+    sum += nvertsv[i];
+  if(sum != nverts)
+    {
+      ay_error(AY_ERROR, fname, "Number of indices does not match nverts.");
+      goto cleanup;
+    }
+  for(i = 0; i < nverts; i++)
+    {
+      if(vertsv[i] >= po->ncontrols)
+	{
+	  ay_error(AY_ERROR, fname, "Index out of range.");
+	  goto cleanup;
+	}
+    }
+
+  /* all is well, replace the old arrays */
+  if(po->nloops)
+    free(po->nloops);
+  po->nloops = nloopsv;
+  nloopsv = NULL;
+  if(po->nverts)
+    free(po->nverts);
+  po->nverts = nvertsv;
+  nvertsv = NULL;
+  if(po->verts)
+    free(po->verts);
+  po->verts = vertsv;
+  vertsv = NULL;
+  po->npolys = npolys;
+
+  if(po->face_normals)
+    free(po->face_normals);
+  po->face_normals = NULL;
+
+  ay_status = AY_OK;
+
+cleanup:
+
+  if(nloopsv)
+    free(nloopsv);
+  if(nvertsv)
+    free(nvertsv);
+  if(vertsv)
+    free(vertsv);
+
+ return ay_status;
+} /* ay_bulk_setfaces */
+
+
+/** ay_bulk_getgeomtcmd:
+ *  get geometric data of the selected objects in one go
+ *  Implements the \a getGeom scripting interface command.
+ *  See also the corresponding section in the \ayd{scgetgeom}.
+ *
+ *  \returns TCL_OK in any case.
+ */
+int
+ay_bulk_getgeomtcmd(ClientData clientData, Tcl_Interp *interp,
+		    int objc, Tcl_Obj *CONST objv[])
+{
+ ay_list_object *sel = ay_selection;
+ ay_object *o;
+ char *fname, *arg;
+ int i = 1, mode = 0, binary = AY_FALSE, what = 0;
+ double pm[16], m[16];
+ Tcl_Obj *to = NULL, *res = NULL;
+ char fargs[] = "[-trafo|-world] [-binary] "
+   "(points|knots|uknots|vknots|faces|tess)";
+
+  fname = Tcl_GetString(objv[0]);
+
+  while(i < objc-1)
+    {
+      arg = Tcl_GetString(objv[i]);
+      if(!strcmp(arg, "-trafo"))
+	mode = 1;
+      else if(!strcmp(arg, "-world"))
+	mode = 2;
+      else if(!strcmp(arg, "-binary"))
+	binary = AY_TRUE;
+      else
+	break;
+      i++;
+    }
+
+  if((i != objc-1) || ay_bulk_getwhat(Tcl_GetString(objv[i]), &what))
+    {
+      ay_error(AY_EARGS, fname, fargs);
+      return TCL_OK;
+    }
+
+  if(!sel)
+    {
+      ay_error(AY_ENOSEL, fname, NULL);
+      return TCL_OK;
+    }
+
+  ay_trafo_identitymatrix(pm);
+  if(mode == 2 && ay_currentlevel->object != ay_root)
+    {
+      ay_trafo_getparent(ay_currentlevel->next, pm);
+    }
+
+  if(sel->next)
+    res = Tcl_NewListObj(0, NULL);
+
+  while(sel)
+    {
+      o = sel->object;
+
+      if(mode)
+	{
+	  memcpy(m, pm, 16*sizeof(double));
+	  ay_trafo_getall(NULL, o, m);
+	}
+
+      switch(what)
+	{
+	case AY_BULKPOINTS:
+	  to = ay_bulk_getpoints(fname, o, mode?m:NULL, binary);
+	  break;
+	case AY_BULKKNOTS:
+	case AY_BULKUKNOTS:
+	case AY_BULKVKNOTS:
+	  to = ay_bulk_getknots(fname, o, what, binary);
+	  break;
+	case AY_BULKFACES:
+	  to = ay_bulk_getfaces(fname, o, binary);
+	  break;
+	case AY_BULKTESS:
+	  to = ay_bulk_gettess(fname, o, pm, mode, binary);
+	  break;
+	default:
+	  break;
+	} /* switch */
+
+      if(!to)
+	{
+	  if(res)
+	    Tcl_DecrRefCount(res);
+	  return TCL_OK;
+	}
+
+      if(res)
+	Tcl_ListObjAppendElement(interp, res, to);
+      else
+	res = to;
+
+      sel = sel->next;
+    } /* while */
+
+  Tcl_SetObjResult(interp, res);
+
+ return TCL_OK;
+} /* ay_bulk_getgeomtcmd */
+
+
+/** ay_bulk_setgeomtcmd:
+ *  set geometric data of the selected objects in one go
+ *  Implements the \a setGeom scripting interface command.
+ *  See also the corresponding section in the \ayd{scsetgeom}.
+ *
+ *  \returns TCL_OK in any case.
+ */
+int
+ay_bulk_setgeomtcmd(ClientData clientData, Tcl_Interp *interp,
+		    int objc, Tcl_Obj *CONST objv[])
+{
+ int tcl_status = TCL_OK, ay_status = AY_OK;
+ ay_list_object *sel = ay_selection;
+ ay_object *o;
+ char *fname, *arg;
+ int i = 1, mode = 0, binary = AY_FALSE, what = 0, datac = 0, j = 0;
+ int notify_parent = AY_FALSE;
+ double pm[16], m[16], mi[16];
+ Tcl_Obj **datav = NULL, *data;
+ char fargs[] = "[-trafo|-world] [-binary] "
+   "(points|knots|uknots|vknots|faces) data";
+
+  fname = Tcl_GetString(objv[0]);
+
+  while(i < objc-2)
+    {
+      arg = Tcl_GetString(objv[i]);
+      if(!strcmp(arg, "-trafo"))
+	mode = 1;
+      else if(!strcmp(arg, "-world"))
+	mode = 2;
+      else if(!strcmp(arg, "-binary"))
+	binary = AY_TRUE;
+      else
+	break;
+      i++;
+    }
+
+  if((i != objc-2) || ay_bulk_getwhat(Tcl_GetString(objv[i]), &what))
+    {
+      ay_error(AY_EARGS, fname, fargs);
+      return TCL_OK;
+    }
+
+  if(what == AY_BULKTESS)
+    {
+      ay_error(AY_ERROR, fname, "Tesselations can not be set.");
+      return TCL_OK;
+    }
+
+  if(!sel)
+    {
+      ay_error(AY_ENOSEL, fname, NULL);
+      return TCL_OK;
+    }
+
+  data = objv[objc-1];
+
+  /* multiple selected objects expect one data element per object */
+  if(sel->next)
+    {
+      tcl_status = Tcl_ListObjGetElements(interp, data, &datac, &datav);
+      AY_CHTCLERRRET(tcl_status, fname, interp);
+    }
+
+  ay_trafo_identitymatrix(pm);
+  if(mode == 2 && ay_currentlevel->object != ay_root)
+    {
+      ay_trafo_getparent(ay_currentlevel->next, pm);
+    }
+
+  while(sel)
+    {
+      o = sel->object;
+
+      if(datav)
+	{
+	  if(j >= datac)
+	    {
+	      ay_error(AY_ERROR, fname, "Not enough data elements provided.");
+	      break;
+	    }
+	  data = datav[j];
+	  j++;
+	}
+
+      switch(what)
+	{
+	case AY_BULKPOINTS:
+	  if(mode)
+	    {
+	      memcpy(m, pm, 16*sizeof(double));
+	      ay_trafo_getall(NULL, o, m);
+	      ay_trafo_invmatrix(m, mi);
+	    }
+	  ay_status = ay_bulk_setpoints(interp, fname, o, mode?mi:NULL,
+					data, binary);
+	  break;
+	case AY_BULKKNOTS:
+	case AY_BULKUKNOTS:
+	case AY_BULKVKNOTS:
+	  ay_status = ay_bulk_setknots(interp, fname, o, what, data, binary);
+	  break;
+	case AY_BULKFACES:
+	  ay_status = ay_bulk_setfaces(interp, fname, o, data, binary);
+	  break;
+	default:
+	  break;
+	} /* switch */
+
+      if(ay_status)
+	break;
+
+      (void)ay_notify_object(o);
+      o->modified = AY_TRUE;
+      notify_parent = AY_TRUE;
+
+      sel = sel->next;
+    } /* while */
+
+  if(notify_parent)
+    (void)ay_notify_parent();
+
+ return TCL_OK;
+} /* ay_bulk_setgeomtcmd */
@@ -113,6 +113,9 @@ ay_clear_scene(void)
       root->imager = NULL;
     }
 
+  /* release cached glyphs and fonts of text objects */
+  ay_text_clearcache();
+
   ay_prefs.save_rootviews = AY_TRUE;
 
  return AY_OK;
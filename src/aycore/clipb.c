@@ -437,6 +437,8 @@ ay_clipb_replacetcmd(ClientData clientData, Tcl_Interp *interp,
   clipend->next = selend->next;
   selend->next = NULL;
 
+  ay_notify_invalidate(NULL);
+
   /* notify new objects */
   clip = *presel;
   while(clip && clip != clipend)
@@ -15,11 +15,17 @@
 
 /* comp.c - compare objects */
 
+/* hash parameters (FNV-1a) */
+#define AY_COMPHASHINIT 2166136261U
+#define AY_COMPHASHPRIME 16777619U
+
 
 /* global variables: */
 
 ay_ftable ay_comparecbt;
 
+ay_ftable ay_comphashcbt;
+
 
 /* prototypes of functions local to this module: */
 
@@ -119,6 +125,48 @@ int ay_comp_offnc(ay_object *o1, ay_object *o2);
 
 int ay_comp_trim(ay_object *o1, ay_object *o2);
 
+int ay_comp_deep(ay_object *o1, ay_object *o2);
+
+unsigned int ay_comp_hashint(unsigned int h, int i);
+
+unsigned int ay_comp_hashlevel(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashdisk(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashcone(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashcylinder(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashsphere(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashtorus(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashparab(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashhyperb(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashbox(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashbpatch(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashncurve(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashicurve(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashacurve(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashnpatch(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashipatch(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashapatch(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashpomesh(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashsdmesh(ay_object *o, unsigned int h);
+
+unsigned int ay_comp_hashncircle(ay_object *o, unsigned int h);
+
 /* functions */
 
 /* ay_comp_strcase:
@@ -191,6 +239,13 @@ ay_comp_tag(ay_tag *t1, ay_tag *t2)
 	return AY_FALSE;
     }
 
+  /* compare PV tags in their binary form */
+  if(t1->type == ay_pv_tagtype)
+    {
+      (void)ay_pv_tobinary(t1);
+      (void)ay_pv_tobinary(t2);
+    }
+
   if(t1->is_binary != t2->is_binary)
     return AY_FALSE;
 
@@ -225,7 +280,7 @@ ay_comp_tag(ay_tag *t1, ay_tag *t2)
 	}
       else
 	{
-	  if(memcmp(bv1, bv2, bv1->size))
+	  if(memcmp(bv1->payload, bv2->payload, bv1->size))
 	    return AY_FALSE;
 	}
     } /* if string or binary */
@@ -1240,18 +1295,18 @@ ay_comp_pomesh(ay_object *o1, ay_object *o2)
 
   if(p1->has_normals)
     {
-      if(!memcmp(p1->controlv, p2->controlv,
+      if(memcmp(p1->controlv, p2->controlv,
 		 p1->ncontrols*6*sizeof(double)))
 	return AY_FALSE;
     }
   else
     {
-      if(!memcmp(p1->controlv, p2->controlv,
+      if(memcmp(p1->controlv, p2->controlv,
 		 p1->ncontrols*3*sizeof(double)))
 	return AY_FALSE;
     }
 
-  if(!memcmp(p1->nloops, p2->nloops, p1->npolys*sizeof(unsigned int)))
+  if(memcmp(p1->nloops, p2->nloops, p1->npolys*sizeof(unsigned int)))
     return AY_FALSE;
 
   for(i = 0; i < p1->npolys; i++)
@@ -1259,7 +1314,7 @@ ay_comp_pomesh(ay_object *o1, ay_object *o2)
       total_loops += p1->nloops[i];
     } /* for */
 
-  if(!memcmp(p1->nverts, p2->nverts, total_loops*sizeof(unsigned int)))
+  if(memcmp(p1->nverts, p2->nverts, total_loops*sizeof(unsigned int)))
     return AY_FALSE;
 
   for(i = 0; i < total_loops; i++)
@@ -1267,13 +1322,13 @@ ay_comp_pomesh(ay_object *o1, ay_object *o2)
       total_verts += p1->nverts[i];
     } /* for */
 
-  if(!memcmp(p1->verts, p2->verts, total_verts*sizeof(unsigned int)))
+  if(memcmp(p1->verts, p2->verts, total_verts*sizeof(unsigned int)))
     return AY_FALSE;
 
   if(p1->face_normals && p2->face_normals)
     {
-      if(!memcmp(p1->face_normals, p2->face_normals,
-		 p1->ncontrols*3*sizeof(double)))
+      if(memcmp(p1->face_normals, p2->face_normals,
+		 p1->npolys*3*sizeof(double)))
 	return AY_FALSE;
     }
   else
@@ -1305,10 +1360,10 @@ ay_comp_sdmesh(ay_object *o1, ay_object *o2)
   if(p1->ncontrols != p2->ncontrols)
     return AY_FALSE;
 
-  if(!memcmp(p1->controlv, p2->controlv, p1->ncontrols * 3 * sizeof(double)))
+  if(memcmp(p1->controlv, p2->controlv, p1->ncontrols * 3 * sizeof(double)))
     return AY_FALSE;
 
-  if(!memcmp(p1->nverts, p2->nverts, p1->nfaces * sizeof(unsigned int)))
+  if(memcmp(p1->nverts, p2->nverts, p1->nfaces * sizeof(unsigned int)))
     return AY_FALSE;
 
   for(i = 0; i < p1->nfaces; i++)
@@ -1316,7 +1371,7 @@ ay_comp_sdmesh(ay_object *o1, ay_object *o2)
       total_verts += p1->nverts[i];
     } /* for */
 
-  if(!memcmp(p1->verts, p2->verts, total_verts * sizeof(unsigned int)))
+  if(memcmp(p1->verts, p2->verts, total_verts * sizeof(unsigned int)))
     return AY_FALSE;
 
   /* XXXX compare the tags */
@@ -1616,6 +1671,474 @@ ay_comp_trim(ay_object *o1, ay_object *o2)
 } /* ay_comp_trim */
 
 
+/* ay_comp_hashdata:
+ *  add arbitrary data to hash value h (FNV-1a like, but word-wise
+ *  with an additional shift to mix the upper bits down)
+ */
+unsigned int
+ay_comp_hashdata(unsigned int h, const void *data, size_t len)
+{
+ const unsigned char *p = (const unsigned char *)data;
+ unsigned int w;
+
+  while(len >= sizeof(unsigned int))
+    {
+      memcpy(&w, p, sizeof(unsigned int));
+      h ^= w;
+      h *= AY_COMPHASHPRIME;
+      h ^= h >> 15;
+      p += sizeof(unsigned int);
+      len -= sizeof(unsigned int);
+    }
+
+  while(len)
+    {
+      h ^= *p;
+      h *= AY_COMPHASHPRIME;
+      p++;
+      len--;
+    }
+
+ return h;
+} /* ay_comp_hashdata */
+
+
+/* ay_comp_hashint:
+ *  add an integer to hash value h
+ */
+unsigned int
+ay_comp_hashint(unsigned int h, int i)
+{
+ return ay_comp_hashdata(h, &i, sizeof(int));
+} /* ay_comp_hashint */
+
+
+/* ay_comp_hashdoubles:
+ *  add n doubles to hash value h; as the comparison callbacks
+ *  compare some parameters using "==", negative zero is hashed
+ *  like positive zero
+ */
+unsigned int
+ay_comp_hashdoubles(unsigned int h, const double *dv, unsigned int n)
+{
+ unsigned int i;
+ double d;
+
+  if(!dv)
+    return ay_comp_hashint(h, 0);
+
+  for(i = 0; i < n; i++)
+    {
+      d = dv[i];
+      if(d == 0.0)
+	d = 0.0;
+      h = ay_comp_hashdata(h, &d, sizeof(double));
+    }
+
+ return h;
+} /* ay_comp_hashdoubles */
+
+
+/* ay_comp_hashtags:
+ *  add all tags of object o to hash value h,
+ *  objects with equal tags (see ay_comp_tags()) get equal hashes
+ */
+unsigned int
+ay_comp_hashtags(ay_object *o, unsigned int h)
+{
+ ay_tag *t;
+ ay_btval *bv;
+
+  t = o->tags;
+  while(t)
+    {
+      /* tag types are registered strings, compared by address */
+      h = ay_comp_hashdata(h, &(t->type), sizeof(char*));
+      if(t->name)
+	h = ay_comp_hashdata(h, t->name, strlen(t->name));
+
+      if(t->type == ay_pv_tagtype)
+	(void)ay_pv_tobinary(t);
+
+      if(!t->is_binary)
+	{
+	  if(t->val)
+	    h = ay_comp_hashdata(h, t->val, strlen(t->val));
+	}
+      else
+	{
+	  bv = (ay_btval *)t->val;
+	  if(bv->size)
+	    h = ay_comp_hashdata(h, bv->payload, bv->size);
+	  else
+	    h = ay_comp_hashdata(h, &(bv->payload), sizeof(void*));
+	}
+      h = ay_comp_hashint(h, t->is_binary);
+      t = t->next;
+    } /* while */
+
+ return h;
+} /* ay_comp_hashtags */
+
+
+/* ay_comp_hashlevel:
+ *
+ */
+unsigned int
+ay_comp_hashlevel(ay_object *o, unsigned int h)
+{
+ return ay_comp_hashint(h, ((ay_level_object *)o->refine)->type);
+} /* ay_comp_hashlevel */
+
+
+/* ay_comp_hashdisk:
+ *
+ */
+unsigned int
+ay_comp_hashdisk(ay_object *o, unsigned int h)
+{
+ ay_disk_object *d = (ay_disk_object *)o->refine;
+
+  h = ay_comp_hashdoubles(h, &(d->radius), 1);
+  h = ay_comp_hashdoubles(h, &(d->height), 1);
+  h = ay_comp_hashdoubles(h, &(d->thetamax), 1);
+
+ return h;
+} /* ay_comp_hashdisk */
+
+
+/* ay_comp_hashcone:
+ *
+ */
+unsigned int
+ay_comp_hashcone(ay_object *o, unsigned int h)
+{
+ ay_cone_object *d = (ay_cone_object *)o->refine;
+
+  h = ay_comp_hashint(h, d->closed);
+  h = ay_comp_hashdoubles(h, &(d->radius), 1);
+  h = ay_comp_hashdoubles(h, &(d->height), 1);
+  h = ay_comp_hashdoubles(h, &(d->thetamax), 1);
+
+ return h;
+} /* ay_comp_hashcone */
+
+
+/* ay_comp_hashcylinder:
+ *
+ */
+unsigned int
+ay_comp_hashcylinder(ay_object *o, unsigned int h)
+{
+ ay_cylinder_object *d = (ay_cylinder_object *)o->refine;
+
+  h = ay_comp_hashint(h, d->closed);
+  h = ay_comp_hashdoubles(h, &(d->radius), 1);
+  h = ay_comp_hashdoubles(h, &(d->zmin), 1);
+  h = ay_comp_hashdoubles(h, &(d->zmax), 1);
+  h = ay_comp_hashdoubles(h, &(d->thetamax), 1);
+
+ return h;
+} /* ay_comp_hashcylinder */
+
+
+/* ay_comp_hashsphere:
+ *
+ */
+unsigned int
+ay_comp_hashsphere(ay_object *o, unsigned int h)
+{
+ ay_sphere_object *d = (ay_sphere_object *)o->refine;
+
+  h = ay_comp_hashint(h, d->closed);
+  h = ay_comp_hashdoubles(h, &(d->radius), 1);
+  h = ay_comp_hashdoubles(h, &(d->zmin), 1);
+  h = ay_comp_hashdoubles(h, &(d->zmax), 1);
+  h = ay_comp_hashdoubles(h, &(d->thetamax), 1);
+
+ return h;
+} /* ay_comp_hashsphere */
+
+
+/* ay_comp_hashtorus:
+ *
+ */
+unsigned int
+ay_comp_hashtorus(ay_object *o, unsigned int h)
+{
+ ay_torus_object *d = (ay_torus_object *)o->refine;
+
+  h = ay_comp_hashint(h, d->closed);
+  h = ay_comp_hashdoubles(h, &(d->majorrad), 1);
+  h = ay_comp_hashdoubles(h, &(d->minorrad), 1);
+  h = ay_comp_hashdoubles(h, &(d->phimin), 1);
+  h = ay_comp_hashdoubles(h, &(d->phimax), 1);
+  h = ay_comp_hashdoubles(h, &(d->thetamax), 1);
+
+ return h;
+} /* ay_comp_hashtorus */
+
+
+/* ay_comp_hashparab:
+ *
+ */
+unsigned int
+ay_comp_hashparab(ay_object *o, unsigned int h)
+{
+ ay_paraboloid_object *d = (ay_paraboloid_object *)o->refine;
+
+  h = ay_comp_hashint(h, d->closed);
+  h = ay_comp_hashdoubles(h, &(d->rmax), 1);
+  h = ay_comp_hashdoubles(h, &(d->zmin), 1);
+  h = ay_comp_hashdoubles(h, &(d->zmax), 1);
+  h = ay_comp_hashdoubles(h, &(d->thetamax), 1);
+
+ return h;
+} /* ay_comp_hashparab */
+
+
+/* ay_comp_hashhyperb:
+ *
+ */
+unsigned int
+ay_comp_hashhyperb(ay_object *o, unsigned int h)
+{
+ ay_hyperboloid_object *d = (ay_hyperboloid_object *)o->refine;
+
+  h = ay_comp_hashint(h, d->closed);
+  h = ay_comp_hashdoubles(h, d->p1, 3);
+  h = ay_comp_hashdoubles(h, d->p2, 3);
+  h = ay_comp_hashdoubles(h, &(d->thetamax), 1);
+
+ return h;
+} /* ay_comp_hashhyperb */
+
+
+/* ay_comp_hashbox:
+ *
+ */
+unsigned int
+ay_comp_hashbox(ay_object *o, unsigned int h)
+{
+ ay_box_object *d = (ay_box_object *)o->refine;
+
+  h = ay_comp_hashdoubles(h, &(d->width), 1);
+  h = ay_comp_hashdoubles(h, &(d->length), 1);
+  h = ay_comp_hashdoubles(h, &(d->height), 1);
+
+ return h;
+} /* ay_comp_hashbox */
+
+
+/* ay_comp_hashbpatch:
+ *
+ */
+unsigned int
+ay_comp_hashbpatch(ay_object *o, unsigned int h)
+{
+ ay_bpatch_object *d = (ay_bpatch_object *)o->refine;
+
+  h = ay_comp_hashdoubles(h, d->p1, 3);
+  h = ay_comp_hashdoubles(h, d->p2, 3);
+  h = ay_comp_hashdoubles(h, d->p3, 3);
+  h = ay_comp_hashdoubles(h, d->p4, 3);
+
+ return h;
+} /* ay_comp_hashbpatch */
+
+
+/* ay_comp_hashncurve:
+ *
+ */
+unsigned int
+ay_comp_hashncurve(ay_object *o, unsigned int h)
+{
+ ay_nurbcurve_object *n = (ay_nurbcurve_object *)o->refine;
+
+  h = ay_comp_hashint(h, n->length);
+  h = ay_comp_hashint(h, n->order);
+  h = ay_comp_hashint(h, n->knot_type);
+  h = ay_comp_hashint(h, n->type);
+  h = ay_comp_hashdoubles(h, n->knotv, n->length+n->order);
+  h = ay_comp_hashdoubles(h, n->controlv, 4*n->length);
+
+ return h;
+} /* ay_comp_hashncurve */
+
+
+/* ay_comp_hashicurve:
+ *
+ */
+unsigned int
+ay_comp_hashicurve(ay_object *o, unsigned int h)
+{
+ ay_icurve_object *i = (ay_icurve_object *)o->refine;
+
+  h = ay_comp_hashint(h, i->length);
+  h = ay_comp_hashint(h, i->type);
+  h = ay_comp_hashint(h, i->param_type);
+  h = ay_comp_hashint(h, i->order);
+  h = ay_comp_hashdoubles(h, i->controlv, 3*i->length);
+
+ return h;
+} /* ay_comp_hashicurve */
+
+
+/* ay_comp_hashacurve:
+ *
+ */
+unsigned int
+ay_comp_hashacurve(ay_object *o, unsigned int h)
+{
+ ay_acurve_object *a = (ay_acurve_object *)o->refine;
+
+  h = ay_comp_hashint(h, a->length);
+  h = ay_comp_hashint(h, a->alength);
+  h = ay_comp_hashint(h, a->closed);
+  h = ay_comp_hashint(h, a->order);
+  h = ay_comp_hashint(h, a->symmetric);
+  h = ay_comp_hashdoubles(h, a->controlv, 3*a->length);
+
+ return h;
+} /* ay_comp_hashacurve */
+
+
+/* ay_comp_hashnpatch:
+ *
+ */
+unsigned int
+ay_comp_hashnpatch(ay_object *o, unsigned int h)
+{
+ ay_nurbpatch_object *n = (ay_nurbpatch_object *)o->refine;
+
+  h = ay_comp_hashint(h, n->width);
+  h = ay_comp_hashint(h, n->height);
+  h = ay_comp_hashint(h, n->uorder);
+  h = ay_comp_hashint(h, n->vorder);
+  h = ay_comp_hashint(h, n->uknot_type);
+  h = ay_comp_hashint(h, n->vknot_type);
+  h = ay_comp_hashdoubles(h, n->uknotv, n->width+n->uorder);
+  h = ay_comp_hashdoubles(h, n->vknotv, n->height+n->vorder);
+  h = ay_comp_hashdoubles(h, n->controlv, 4*n->width*n->height);
+
+ return h;
+} /* ay_comp_hashnpatch */
+
+
+/* ay_comp_hashipatch:
+ *
+ */
+unsigned int
+ay_comp_hashipatch(ay_object *o, unsigned int h)
+{
+ ay_ipatch_object *i = (ay_ipatch_object *)o->refine;
+
+  h = ay_comp_hashint(h, i->width);
+  h = ay_comp_hashint(h, i->height);
+  h = ay_comp_hashint(h, i->close_u);
+  h = ay_comp_hashint(h, i->close_v);
+  h = ay_comp_hashint(h, i->order_u);
+  h = ay_comp_hashint(h, i->order_v);
+  h = ay_comp_hashint(h, i->ktype_u);
+  h = ay_comp_hashint(h, i->ktype_v);
+  h = ay_comp_hashdoubles(h, i->controlv, 3*i->width*i->height);
+
+ return h;
+} /* ay_comp_hashipatch */
+
+
+/* ay_comp_hashapatch:
+ *
+ */
+unsigned int
+ay_comp_hashapatch(ay_object *o, unsigned int h)
+{
+ ay_apatch_object *a = (ay_apatch_object *)o->refine;
+
+  h = ay_comp_hashint(h, a->mode);
+  h = ay_comp_hashint(h, a->width);
+  h = ay_comp_hashint(h, a->height);
+  h = ay_comp_hashint(h, a->awidth);
+  h = ay_comp_hashint(h, a->aheight);
+  h = ay_comp_hashint(h, a->close_u);
+  h = ay_comp_hashint(h, a->close_v);
+  h = ay_comp_hashint(h, a->order_u);
+  h = ay_comp_hashint(h, a->order_v);
+  h = ay_comp_hashint(h, a->ktype_u);
+  h = ay_comp_hashint(h, a->ktype_v);
+  h = ay_comp_hashdoubles(h, a->controlv, 3*a->width*a->height);
+
+ return h;
+} /* ay_comp_hashapatch */
+
+
+/* ay_comp_hashpomesh:
+ *
+ */
+unsigned int
+ay_comp_hashpomesh(ay_object *o, unsigned int h)
+{
+ ay_pomesh_object *p = (ay_pomesh_object *)o->refine;
+ unsigned int i, total_loops = 0, total_verts = 0;
+
+  h = ay_comp_hashdata(h, &(p->npolys), sizeof(unsigned int));
+  h = ay_comp_hashint(h, p->has_normals);
+  h = ay_comp_hashdata(h, &(p->ncontrols), sizeof(unsigned int));
+
+  for(i = 0; i < p->npolys; i++)
+    total_loops += p->nloops[i];
+  for(i = 0; i < total_loops; i++)
+    total_verts += p->nverts[i];
+
+  h = ay_comp_hashdata(h, p->nloops, p->npolys*sizeof(unsigned int));
+  h = ay_comp_hashdata(h, p->nverts, total_loops*sizeof(unsigned int));
+  h = ay_comp_hashdata(h, p->verts, total_verts*sizeof(unsigned int));
+  h = ay_comp_hashdoubles(h, p->controlv,
+			  p->ncontrols*(p->has_normals?6:3));
+
+ return h;
+} /* ay_comp_hashpomesh */
+
+
+/* ay_comp_hashsdmesh:
+ *
+ */
+unsigned int
+ay_comp_hashsdmesh(ay_object *o, unsigned int h)
+{
+ ay_sdmesh_object *p = (ay_sdmesh_object *)o->refine;
+ unsigned int i, total_verts = 0;
+
+  h = ay_comp_hashdata(h, &(p->nfaces), sizeof(unsigned int));
+  h = ay_comp_hashdata(h, &(p->ncontrols), sizeof(unsigned int));
+
+  for(i = 0; i < p->nfaces; i++)
+    total_verts += p->nverts[i];
+
+  h = ay_comp_hashdata(h, p->nverts, p->nfaces*sizeof(unsigned int));
+  h = ay_comp_hashdata(h, p->verts, total_verts*sizeof(unsigned int));
+  h = ay_comp_hashdoubles(h, p->controlv, p->ncontrols*3);
+
+ return h;
+} /* ay_comp_hashsdmesh */
+
+
+/* ay_comp_hashncircle:
+ *
+ */
+unsigned int
+ay_comp_hashncircle(ay_object *o, unsigned int h)
+{
+ ay_ncircle_object *c = (ay_ncircle_object *)o->refine;
+
+  h = ay_comp_hashdoubles(h, &(c->radius), 1);
+  h = ay_comp_hashdoubles(h, &(c->tmin), 1);
+  h = ay_comp_hashdoubles(h, &(c->tmax), 1);
+
+ return h;
+} /* ay_comp_hashncircle */
+
+
 /* ay_comp_register:
  *  register the compare callback compcb for
  *  objects of type type_id
@@ -1632,6 +2155,23 @@ ay_comp_register(ay_comparecb *compcb, unsigned int type_id)
 } /* ay_comp_register */
 
 
+/* ay_comp_registerhash:
+ *  register the hash callback hashcb for
+ *  objects of type type_id
+ */
+int
+ay_comp_registerhash(ay_comphashcb *hashcb, unsigned int type_id)
+{
+ int ay_status = AY_OK;
+
+  /* register hash callback */
+  ay_status = ay_table_addcallback(&ay_comphashcbt, (ay_voidfp)hashcb,
+				   type_id);
+
+ return ay_status;
+} /* ay_comp_registerhash */
+
+
 /* ay_comp_objects:
  *  compare object o1 with o2,
  *  return AY_TRUE if they are equal, else AY_FALSE
@@ -1671,6 +2211,168 @@ ay_comp_objects(ay_object *o1, ay_object *o2)
 } /* ay_comp_objects */
 
 
+/* ay_comp_deep:
+ *  compare object o1 with o2 including their names, transformation
+ *  attributes, (non internal) tags, and children (recursively),
+ *  return AY_TRUE if they are equal, else AY_FALSE
+ */
+int
+ay_comp_deep(ay_object *o1, ay_object *o2)
+{
+ ay_object *d1, *d2;
+ ay_tag *t1, *t2;
+
+  if(o1->type != o2->type)
+    return AY_FALSE;
+
+  if(o1->name && o2->name)
+    {
+      if(strcmp(o1->name, o2->name))
+	return AY_FALSE;
+    }
+  else
+    {
+      if(o1->name != o2->name)
+	return AY_FALSE;
+    }
+
+  if((o1->hide != o2->hide) || (o1->hide_children != o2->hide_children) ||
+     (o1->parent != o2->parent) || (o1->inherit_trafos != o2->inherit_trafos))
+    return AY_FALSE;
+
+  if(!ay_comp_trafos(o1, o2))
+    return AY_FALSE;
+
+  /* internal tags are not saved, thus, we also ignore them here */
+  t1 = o1->tags;
+  t2 = o2->tags;
+  while(t1 || t2)
+    {
+      while(t1 && t1->is_intern)
+	t1 = t1->next;
+      while(t2 && t2->is_intern)
+	t2 = t2->next;
+      if(!t1 || !t2)
+	break;
+      if(!ay_comp_tag(t1, t2))
+	return AY_FALSE;
+      t1 = t1->next;
+      t2 = t2->next;
+    }
+
+  if(t1 || t2)
+    return AY_FALSE;
+
+  if(!ay_comp_objects(o1, o2))
+    return AY_FALSE;
+
+  /* compare the children (but not the terminating EndLevel objects) */
+  d1 = o1->down;
+  d2 = o2->down;
+  while(d1 && d1->next && d2 && d2->next)
+    {
+      if(!ay_comp_deep(d1, d2))
+	return AY_FALSE;
+      d1 = d1->next;
+      d2 = d2->next;
+    }
+
+  if((d1 && d1->next) || (d2 && d2->next))
+    return AY_FALSE;
+
+ return AY_TRUE;
+} /* ay_comp_deep */
+
+
+/** ay_comp_objectstcmd:
+ *  Compare the selected objects.
+ *  Implements the \a compOb scripting interface command.
+ *  See also the corresponding section in the \ayd{sccompob}.
+ *
+ *  \returns 1 if all selected objects are equal to the first.
+ */
+int
+ay_comp_objectstcmd(ClientData clientData, Tcl_Interp *interp,
+		    int argc, char *argv[])
+{
+ ay_list_object *sel = ay_selection;
+ ay_object *o1 = NULL, *o2 = NULL;
+ int deep = AY_FALSE, equal = AY_TRUE;
+
+  if(!sel)
+    {
+      ay_error(AY_ENOSEL, argv[0], NULL);
+      return TCL_OK;
+    }
+
+  if(argc > 1)
+    {
+      if((argv[1][0] == '-') && (argv[1][1] == 'd'))
+	deep = AY_TRUE;
+    }
+
+  o1 = sel->object;
+  sel = sel->next;
+  while(sel && equal)
+    {
+      o2 = sel->object;
+      if(deep)
+	{
+	  equal = ay_comp_deep(o1, o2);
+	}
+      else
+	{
+	  if(o1->type != o2->type)
+	    equal = AY_FALSE;
+	  else
+	    equal = ay_comp_objects(o1, o2);
+	}
+      sel = sel->next;
+    }
+
+  if(equal)
+    Tcl_SetResult(interp, "1", TCL_VOLATILE);
+  else
+    Tcl_SetResult(interp, "0", TCL_VOLATILE);
+
+ return TCL_OK;
+} /* ay_comp_objectstcmd */
+
+
+/* ay_comp_hashobject:
+ *  compute a hash value of object o, objects that are equal according
+ *  to ay_comp_objects() are guaranteed to get equal hash values;
+ *  objects without a registered hash callback just hash their type
+ *  Note: like ay_comp_objects(), this is not a deep hash (children,
+ *  transformation attributes, tags, and material are not considered)!
+ */
+unsigned int
+ay_comp_hashobject(ay_object *o)
+{
+ unsigned int h = AY_COMPHASHINIT;
+ ay_voidfp *arr = NULL;
+ ay_comphashcb *cb = NULL;
+
+  if(!o)
+    return h;
+
+  h = ay_comp_hashdata(h, &(o->type), sizeof(unsigned int));
+
+  if(o->refine && o->type < ay_comphashcbt.size)
+    {
+      /* call the hash callback */
+      arr = ay_comphashcbt.arr;
+      cb = (ay_comphashcb *)(arr[o->type]);
+      if(cb)
+	{
+	  h = cb(o, h);
+	}
+    }
+
+ return h;
+} /* ay_comp_hashobject */
+
+
 /* ay_comp_init:
  *
  */
@@ -1736,6 +2438,32 @@ ay_comp_init()
   ay_status += ay_comp_register(ay_comp_ipatch, AY_IDIPATCH);
   ay_status += ay_comp_register(ay_comp_apatch, AY_IDAPATCH);
 
+  if((ay_status = ay_table_initftable(&ay_comphashcbt)))
+    { ay_error(ay_status, fname, NULL); return AY_ERROR; }
+
+  ay_status += ay_comp_registerhash(ay_comp_hashbox, AY_IDBOX);
+  ay_status += ay_comp_registerhash(ay_comp_hashbpatch, AY_IDBPATCH);
+
+  ay_status += ay_comp_registerhash(ay_comp_hashsphere, AY_IDSPHERE);
+  ay_status += ay_comp_registerhash(ay_comp_hashdisk, AY_IDDISK);
+  ay_status += ay_comp_registerhash(ay_comp_hashcylinder, AY_IDCYLINDER);
+  ay_status += ay_comp_registerhash(ay_comp_hashcone, AY_IDCONE);
+  ay_status += ay_comp_registerhash(ay_comp_hashtorus, AY_IDTORUS);
+  ay_status += ay_comp_registerhash(ay_comp_hashhyperb, AY_IDHYPERBOLOID);
+  ay_status += ay_comp_registerhash(ay_comp_hashparab, AY_IDPARABOLOID);
+
+  ay_status += ay_comp_registerhash(ay_comp_hashncurve, AY_IDNCURVE);
+  ay_status += ay_comp_registerhash(ay_comp_hashicurve, AY_IDICURVE);
+  ay_status += ay_comp_registerhash(ay_comp_hashacurve, AY_IDACURVE);
+  ay_status += ay_comp_registerhash(ay_comp_hashnpatch, AY_IDNPATCH);
+  ay_status += ay_comp_registerhash(ay_comp_hashncircle, AY_IDNCIRCLE);
+  ay_status += ay_comp_registerhash(ay_comp_hashipatch, AY_IDIPATCH);
+  ay_status += ay_comp_registerhash(ay_comp_hashapatch, AY_IDAPATCH);
+
+  ay_status += ay_comp_registerhash(ay_comp_hashlevel, AY_IDLEVEL);
+  ay_status += ay_comp_registerhash(ay_comp_hashpomesh, AY_IDPOMESH);
+  ay_status += ay_comp_registerhash(ay_comp_hashsdmesh, AY_IDSDMESH);
+
  return ay_status;
 } /* ay_comp_init */
 
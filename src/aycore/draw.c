@@ -14,8 +14,36 @@
 
 /* draw.c - functions for drawing a scene using OpenGL */
 
+/* global variables for this module: */
+
+/** view that is currently drawn with view frustum culling */
+static ay_view_object *ay_draw_cullview = NULL;
+
+/** projection matrix of ay_draw_cullview */
+static double ay_draw_cullpm[16];
+
+/** viewport of ay_draw_cullview */
+static GLint ay_draw_cullvp[4];
+
+/** number of level of detail tesselations that may still be created
+    in the current drawing pass */
+static int ay_draw_lodgens = 0;
+
+/** is an idle redraw of views with pending level of detail refinements
+    scheduled? */
+static int ay_draw_lodidle = AY_FALSE;
+
+/* local preprocessor definitions: */
+
+/** number of level of detail tesselations created per drawing pass */
+#define AY_DRAWLODGENS 4
+
+/* prototypes of functions local to this module: */
+
 void ay_draw_annos(struct Togl *togl, int draw_offset);
 
+void ay_draw_lodidlecb(ClientData clientData);
+
 
 /* ay_draw_object:
  *  draw a single object o (and children) in view togl
@@ -52,6 +80,12 @@ ay_draw_object(struct Togl *togl, ay_object *o, int selected)
    glMultMatrixd((GLdouble*)m);
    glScaled((GLdouble)o->scalx, (GLdouble)o->scaly, (GLdouble)o->scalz);
 
+   if(selected == AY_FALSE && ay_draw_isculled(o))
+     {
+       glPopMatrix();
+       return;
+     }
+
    if(selected == AY_TRUE)
      {
        if(view->drawobjectcs)
@@ -131,6 +165,13 @@ ay_draw_view(struct Togl *togl, int draw_offset)
 	  view->dirty = AY_FALSE;
 	}
 
+      /* this is a complete redraw of the view, open the vertex
+	 buffer cache here; drawing with an offset happens inside
+	 ay_shade_view(), which opens and closes the cache itself */
+      ay_vbo_begin(togl);
+
+      view->culled = 0;
+
       if(view->drawbgimage)
 	{
 	  ay_draw_bgimage(togl);
@@ -197,11 +238,13 @@ ay_draw_view(struct Togl *togl, int draw_offset)
   /* draw unselected objects */
   if(!view->drawsel)
     {
+      ay_draw_beginculling(togl);
       while(o && o->next)
 	{
 	  ay_draw_object(togl, o, AY_FALSE);
 	  o = o->next;
 	}
+      ay_draw_endculling();
     }
 
   /* draw selected objects */
@@ -456,10 +499,243 @@ ay_draw_view(struct Togl *togl, int draw_offset)
   else
     glLineWidth((GLfloat)1.0f);
 
+  if(!draw_offset)
+    ay_vbo_end();
+
  return AY_OK;
 } /* ay_draw_view */
 
 
+/** ay_draw_beginculling:
+ *  enable view frustum culling of unselected objects
+ *  for the current drawing pass of view \a togl
+ *  (see ay_draw_isculled())
+ *
+ * \param[in] togl  view to draw
+ */
+void
+ay_draw_beginculling(struct Togl *togl)
+{
+
+  glGetDoublev(GL_PROJECTION_MATRIX, ay_draw_cullpm);
+  glGetIntegerv(GL_VIEWPORT, ay_draw_cullvp);
+
+  ay_draw_cullview = (ay_view_object *)Togl_GetClientData(togl);
+
+  ay_draw_lodgens = AY_DRAWLODGENS;
+
+ return;
+} /* ay_draw_beginculling */
+
+
+/** ay_draw_endculling:
+ *  disable view frustum culling
+ */
+void
+ay_draw_endculling(void)
+{
+
+  ay_draw_cullview = NULL;
+
+ return;
+} /* ay_draw_endculling */
+
+
+/** ay_draw_isculled:
+ *  check whether object \a o (and all of its children) can be
+ *  skipped in the current drawing pass, because its cached bounding
+ *  box is completely outside of the view frustum;
+ *  must be called after the transformation attributes of \a o
+ *  have been applied to the current modelview matrix;
+ *  selected objects are never culled, as their bounding boxes
+ *  may be outdated during modelling actions
+ *
+ * \param[in] o  object to check
+ *
+ * \returns AY_TRUE if the object is culled
+ */
+int
+ay_draw_isculled(ay_object *o)
+{
+ double bb[6], m[16], pm[16], c[4];
+ int i, code, allcodes = 63;
+
+  /* temporary objects (e.g. provided by tool objects) are never
+     notified and thus have no cached bounding box */
+  if(!ay_draw_cullview || o->selected || !o->version)
+    return AY_FALSE;
+
+  if(ay_bbc_getcached(o, bb))
+    return AY_FALSE;
+
+  glGetDoublev(GL_MODELVIEW_MATRIX, m);
+  memcpy(pm, ay_draw_cullpm, 16*sizeof(double));
+  ay_trafo_multmatrix(pm, m);
+
+  /* transform the corners of the bounding box to clip space
+     and check, whether they are all outside of one clip plane */
+  for(i = 0; i < 8; i++)
+    {
+      c[0] = (i & 1) ? bb[3] : bb[0];
+      c[1] = (i & 2) ? bb[4] : bb[1];
+      c[2] = (i & 4) ? bb[5] : bb[2];
+      c[3] = 1.0;
+      ay_trafo_apply4(c, pm);
+
+      code = 0;
+      if(c[0] < -c[3])
+	code |= 1;
+      if(c[0] > c[3])
+	code |= 2;
+      if(c[1] < -c[3])
+	code |= 4;
+      if(c[1] > c[3])
+	code |= 8;
+      if(c[2] < -c[3])
+	code |= 16;
+      if(c[2] > c[3])
+	code |= 32;
+
+      allcodes &= code;
+      if(!allcodes)
+	return AY_FALSE;
+    } /* for */
+
+  ay_draw_cullview->culled++;
+
+ return AY_TRUE;
+} /* ay_draw_isculled */
+
+
+/** ay_draw_getpixelsize:
+ *  get the size of the projected cached bounding box of object \a o
+ *  in pixels of the view that is currently drawn with view frustum
+ *  culling (see ay_draw_beginculling());
+ *  must be called after the transformation attributes of \a o
+ *  have been applied to the current modelview matrix
+ *
+ * \param[in] o  object to check
+ * \param[in,out] size  where to store the size (maximum of width and
+ *  height of the projected bounding box)
+ *
+ * \returns AY_OK on success, AY_ERROR if the size is unknown (no
+ *  culling pass, selected objects, bounding box not completely in
+ *  front of the viewer)
+ */
+int
+ay_draw_getpixelsize(ay_object *o, double *size)
+{
+ double bb[6], m[16], pm[16], c[4], x, y;
+ double xmin = DBL_MAX, xmax = -DBL_MAX, ymin = DBL_MAX, ymax = -DBL_MAX;
+ int i;
+
+  if(!ay_draw_cullview || !o || !size || o->selected || !o->version)
+    return AY_ERROR;
+
+  if(ay_bbc_getcached(o, bb))
+    return AY_ERROR;
+
+  glGetDoublev(GL_MODELVIEW_MATRIX, m);
+  memcpy(pm, ay_draw_cullpm, 16*sizeof(double));
+  ay_trafo_multmatrix(pm, m);
+
+  for(i = 0; i < 8; i++)
+    {
+      c[0] = (i & 1) ? bb[3] : bb[0];
+      c[1] = (i & 2) ? bb[4] : bb[1];
+      c[2] = (i & 4) ? bb[5] : bb[2];
+      c[3] = 1.0;
+      ay_trafo_apply4(c, pm);
+
+      if(c[3] < AY_EPSILON)
+	return AY_ERROR;
+
+      x = (c[0]/c[3] + 1.0) * 0.5 * ay_draw_cullvp[2];
+      y = (c[1]/c[3] + 1.0) * 0.5 * ay_draw_cullvp[3];
+
+      if(x < xmin)
+	xmin = x;
+      if(x > xmax)
+	xmax = x;
+      if(y < ymin)
+	ymin = y;
+      if(y > ymax)
+	ymax = y;
+    } /* for */
+
+  *size = AY_MAX(xmax-xmin, ymax-ymin);
+
+ return AY_OK;
+} /* ay_draw_getpixelsize */
+
+
+/** ay_draw_lodgenerate:
+ *  check whether a missing level of detail tesselation may be
+ *  created in the current drawing pass; only a few are created
+ *  per pass to keep the views interactive, if the budget is
+ *  exhausted, the view is marked and redrawn again when Tcl is idle,
+ *  so that all tesselations get refined over some redraws
+ *
+ * \returns AY_TRUE if the tesselation may be created now
+ */
+int
+ay_draw_lodgenerate(void)
+{
+
+  if(!ay_draw_cullview)
+    return AY_TRUE;
+
+  if(ay_draw_lodgens > 0)
+    {
+      ay_draw_lodgens--;
+      return AY_TRUE;
+    }
+
+  ay_draw_cullview->lodpending = AY_TRUE;
+
+  if(!ay_draw_lodidle)
+    {
+      Tcl_DoWhenIdle(ay_draw_lodidlecb, NULL);
+      ay_draw_lodidle = AY_TRUE;
+    }
+
+ return AY_FALSE;
+} /* ay_draw_lodgenerate */
+
+
+/** ay_draw_lodidlecb:
+ *  Tcl idle callback, redraw all views with pending
+ *  level of detail refinements (see ay_draw_lodgenerate())
+ *
+ * \param[in] clientData  unused
+ */
+void
+ay_draw_lodidlecb(ClientData clientData)
+{
+ ay_object *o = ay_root->down;
+ ay_view_object *view;
+
+  ay_draw_lodidle = AY_FALSE;
+
+  while(o && o->next)
+    {
+      if(o->type == AY_IDVIEW)
+	{
+	  view = (ay_view_object *)o->refine;
+	  if(view->lodpending)
+	    {
+	      view->lodpending = AY_FALSE;
+	      Togl_MakeCurrent(view->togl);
+	      ay_toglcb_display(view->togl);
+	    }
+	}
+      o = o->next;
+    } /* while */
+
+ return;
+} /* ay_draw_lodidlecb */
+
+
 /* ay_draw_annos:
  *  draw the annotations (coordinate systems, handles, and the mark)
  */
@@ -99,6 +99,10 @@ ay_error(int code, const char *where, const char *what)
  static int count = 0;
  int len;
 
+  /* notification callbacks running in parallel may not use Tcl */
+  if(ay_notify_defererror(code, where, what))
+    return;
+
   ay_errno = code;
 
   if(code == AY_OK)
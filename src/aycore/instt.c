@@ -125,6 +125,7 @@ ay_instt_connect(ay_object *o, ay_object **last)
 		    {
 		      target = (ay_object *)Tcl_GetHashValue(entry);
 		      o->refine = target;
+		      ay_notify_invalidate(NULL);
 		      if(target)
 			target->refcount++;
 		    } /* if */
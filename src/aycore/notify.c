@@ -12,27 +12,123 @@
 
 #include "ayam.h"
 
-/* notify.c - functions for object notification */
+#ifndef WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif /* !WIN32 */
 
+/* notify.c - functions for object notification */
 
-/* global variables for this module: */
+/** maximum number of threads for parallel notification */
+#define AY_NOTIFYMAXTHREADS 64
 
-/*
-  NC tags are used to store a counter value per candidate
-  parent object that has to be notified. The counter is
-  used to update parents only when all children are updated.
-  The tag object is used in quite unusual way:
-  <tag->name> is always NULL (we solely use the tag->type for identification)
-  <tag->val> is used as counter value and not as pointer to a string
-*/
-static unsigned int ay_nc_tagtype;
 
-static char *ay_nc_tagname = "NC";
+/* global variables for this module: */
 
 static int ay_notify_blockparent = 0;
 
 static int ay_notify_blockobject = 0;
 
+/* source of object versions (see ay_object->version) */
+static unsigned int ay_notify_version = 0;
+
+
+/* local types: */
+
+/** node of the dependency graph used by the complete notification */
+typedef struct ay_notify_node_s {
+  ay_object *o; /**< object (NULL if deleted meanwhile) */
+  int parent; /**< index of parent node, -1 for top level objects */
+  int firstinst; /**< index of first instance node (if o is a master) */
+  int nextinst; /**< index of next instance node of the same master */
+  unsigned int stamp; /**< visited in current complete notification? */
+  int indeg; /**< number of unprocessed dependencies */
+  int done; /**< already processed? */
+} ay_notify_node;
+
+/** error message of a parallel notification, reported afterwards */
+typedef struct ay_notify_msg_s {
+  struct ay_notify_msg_s *next; /**< next message */
+  int code; /**< error code */
+  char *where; /**< function or command name */
+  char *what; /**< error message */
+} ay_notify_msg;
+
+
+/* local variables: */
+
+/** maps objects to node indices */
+static Tcl_HashTable ay_notify_graphht;
+
+/** the nodes of the dependency graph */
+static ay_notify_node *ay_notify_nodes = NULL;
+static int ay_notify_nnodes = 0;
+static int ay_notify_anodes = 0;
+
+/** is the dependency graph up to date? */
+static int ay_notify_graphvalid = AY_FALSE;
+
+/** stamp of the current complete notification */
+static unsigned int ay_notify_stamp = 0;
+
+/** object types whose notification callbacks may run in parallel */
+static char *ay_notify_partypes = NULL;
+static unsigned int ay_notify_partypeslen = 0;
+
+/** objects waiting for (parallel) execution of their notification
+    callbacks; every ay_notify_children() owns the tail of this stack
+    that starts at the number of tasks upon its entry */
+static ay_object **ay_notify_tasks = NULL;
+static int ay_notify_ntasks = 0;
+static int ay_notify_atasks = 0;
+
+/** is a parallel notification in progress? */
+static int ay_notify_inparallel = AY_FALSE;
+
+/** error messages of the parallel notification */
+static ay_notify_msg *ay_notify_msgs = NULL;
+static ay_notify_msg **ay_notify_lastmsg = &ay_notify_msgs;
+
+#ifndef WIN32
+/** protects shared state (e.g. the provide cache) while
+    notification callbacks run in parallel (recursive) */
+static pthread_mutex_t ay_notify_mutex;
+
+/** next task to be processed by the worker threads */
+static int ay_notify_nexttask = 0;
+
+/** end of the tasks to be processed by the worker threads */
+static int ay_notify_endtask = 0;
+
+/** status of the parallel notification */
+static int ay_notify_taskstatus = AY_OK;
+#endif /* !WIN32 */
+
+
+/* prototypes of functions local to this module: */
+
+int ay_notify_addnodes(ay_object *o, int parent);
+
+int ay_notify_buildgraph(void);
+
+int ay_notify_getnode(ay_object *o);
+
+void ay_notify_visit(int i, int *stack, int *nstack);
+
+int ay_notify_getdeps(int i, int *deps);
+
+void ay_notify_newversion(ay_object *o);
+
+int ay_notify_isparallel(ay_object *o, int check_tags);
+
+int ay_notify_children(ay_object *o);
+
+int ay_notify_runtasks(int first);
+
+#ifndef WIN32
+void *ay_notify_worker(void *data);
+#endif /* !WIN32 */
+
 
 /* functions: */
 
@@ -79,7 +175,8 @@ ay_notify_parent(void)
  ay_voidfp *arr = NULL;
  ay_notifycb *cb = NULL;
  ay_tag *tag = NULL;
- int did_notify = AY_FALSE;
+ ay_object **mod = NULL;
+ int did_notify = AY_FALSE, nmod = 0;
 
   if(ay_notify_blockparent)
     return AY_OK;
@@ -90,18 +187,34 @@ ay_notify_parent(void)
       /* Yes.*/
 
       /* loop through selected objects and check for changed ones;
-         do complete notify for all of them */
+         do one complete notify for all of them */
       while(sel)
 	{
-	  o = sel->object;
-	  if(o->modified)
-	    {
-	      ay_status = ay_notify_complete(o);
-	      o->modified = AY_FALSE;
-	      did_notify = AY_TRUE;
-	    }
+	  if(sel->object->modified)
+	    nmod++;
 	  sel = sel->next;
-	} /* while */
+	}
+
+      if(nmod)
+	{
+	  if(!(mod = malloc(nmod*sizeof(ay_object*))))
+	    return AY_EOMEM;
+	  nmod = 0;
+	  sel = ay_selection;
+	  while(sel)
+	    {
+	      o = sel->object;
+	      if(o->modified)
+		{
+		  mod[nmod++] = o;
+		  o->modified = AY_FALSE;
+		}
+	      sel = sel->next;
+	    } /* while */
+	  ay_status = ay_notify_completelist(mod, nmod);
+	  free(mod);
+	  did_notify = AY_TRUE;
+	} /* if */
 
       /* in case we did not call any notification callbacks up to now,
          maybe the structure of the current level changed using e.g.
@@ -205,7 +318,6 @@ ay_notify_object(ay_object *o)
 {
  int ay_status = AY_OK;
  char fname[] = "notify_object";
- ay_object *od = NULL;
  ay_voidfp *arr = NULL;
  ay_notifycb *cb = NULL;
  ay_tag *tag = NULL;
@@ -213,17 +325,14 @@ ay_notify_object(ay_object *o)
   if(ay_notify_blockobject)
     return AY_OK;
 
+  ay_notify_newversion(o);
+
   /* call notification callbacks of children first */
   if(o->down && o->down->next)
     {
-      od = o->down;
-      while(od->next)
-	{
-	  ay_status = ay_notify_object(od);
-	  if(ay_status)
-	    return ay_status;
-	  od = od->next;
-	}
+      ay_status = ay_notify_children(o);
+      if(ay_status)
+	return ay_status;
     }
 
   /* search for and execute all BNS (before notify) tag */
@@ -275,6 +384,420 @@ ay_notify_object(ay_object *o)
 } /* ay_notify_object */
 
 
+/* ay_notify_newversion:
+ *  assign a new version to object \a o (see ay_object->version)
+ */
+void
+ay_notify_newversion(ay_object *o)
+{
+
+  /* 0 is reserved for unversioned objects */
+  if(!++ay_notify_version)
+    ay_notify_version++;
+  o->version = ay_notify_version;
+
+ return;
+} /* ay_notify_newversion */
+
+
+/* ay_notify_getnthreads:
+ *  get the number of threads to use for parallel notification
+ *  (and other parallel work) according to the NotifyThreads
+ *  preference setting (0 - one per processor, 1 - no parallelism)
+ */
+int
+ay_notify_getnthreads(void)
+{
+#ifdef WIN32
+ return 1;
+#else
+ static int ncpus = 0;
+ int n = ay_prefs.notifythreads;
+
+  if(n <= 0)
+    {
+      if(!ncpus)
+	{
+	  ncpus = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+	  ncpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	  if(ncpus < 1)
+	    ncpus = 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+	}
+      n = ncpus;
+    }
+
+  if(n > AY_NOTIFYMAXTHREADS)
+    n = AY_NOTIFYMAXTHREADS;
+
+ return n;
+#endif /* WIN32 */
+} /* ay_notify_getnthreads */
+
+
+/* ay_notify_isparallel:
+ *  check, whether the notification callback of object \a o may run
+ *  in a worker thread: the type of \a o must be registered using
+ *  ay_notify_registerparallel(), and neither \a o nor its children
+ *  may carry BNS/ANS/NO/NM tags; furthermore, the children (which are
+ *  read by the callback) may not be instances or Script objects, or
+ *  have materials (whose reference counts would change when copied)
+ */
+int
+ay_notify_isparallel(ay_object *o, int top)
+{
+ ay_object *d;
+ ay_tag *tag;
+
+  if(top)
+    {
+      if(o->type >= ay_notify_partypeslen || !ay_notify_partypes[o->type])
+	return AY_FALSE;
+    }
+  else
+    {
+      if(o->type == AY_IDINSTANCE || o->type == AY_IDSCRIPT || o->mat)
+	return AY_FALSE;
+    }
+
+  tag = o->tags;
+  while(tag)
+    {
+      if(tag->type == ay_bns_tagtype || tag->type == ay_ans_tagtype ||
+	 tag->type == ay_no_tagtype || tag->type == ay_nm_tagtype)
+	return AY_FALSE;
+      tag = tag->next;
+    }
+
+  d = o->down;
+  while(d && d->next)
+    {
+      if(!ay_notify_isparallel(d, AY_FALSE))
+	return AY_FALSE;
+      d = d->next;
+    }
+
+ return AY_TRUE;
+} /* ay_notify_isparallel */
+
+
+/* ay_notify_children:
+ *  notify all children of object \a o; the notification callbacks
+ *  of children that qualify (see ay_notify_isparallel()) are collected
+ *  and run in parallel, all other children are notified in order on
+ *  the main thread (after the tasks collected so far)
+ */
+int
+ay_notify_children(ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_object *od, **t;
+ int first = ay_notify_ntasks, parallel;
+
+  parallel = (ay_notify_partypes && !ay_notify_inparallel &&
+	      (ay_notify_getnthreads() > 1));
+
+  od = o->down;
+  while(od->next)
+    {
+      if(parallel && ay_notify_isparallel(od, AY_TRUE))
+	{
+	  /* prepare the object and defer its notification callback */
+	  ay_notify_newversion(od);
+
+	  if(od->down && od->down->next)
+	    {
+	      ay_status = ay_notify_children(od);
+	      if(ay_status)
+		break;
+	    }
+
+	  if(ay_notify_ntasks >= ay_notify_atasks)
+	    {
+	      if(!(t = realloc(ay_notify_tasks, (ay_notify_atasks+16)*2*
+			       sizeof(ay_object *))))
+		{
+		  ay_status = AY_EOMEM;
+		  break;
+		}
+	      ay_notify_tasks = t;
+	      ay_notify_atasks = (ay_notify_atasks+16)*2;
+	    }
+	  ay_notify_tasks[ay_notify_ntasks] = od;
+	  ay_notify_ntasks++;
+	}
+      else
+	{
+	  /* keep the order relative to objects that may have
+	     side effects on their siblings */
+	  ay_status = ay_notify_runtasks(first);
+	  if(!ay_status)
+	    ay_status = ay_notify_object(od);
+	  if(ay_status)
+	    break;
+	}
+      od = od->next;
+    } /* while */
+
+  if(ay_status)
+    {
+      ay_notify_ntasks = first;
+      return ay_status;
+    }
+
+ return ay_notify_runtasks(first);
+} /* ay_notify_children */
+
+
+#ifndef WIN32
+/* ay_notify_worker:
+ *  worker thread of the parallel notification,
+ *  runs notification callbacks until all tasks are done
+ */
+void *
+ay_notify_worker(void *data)
+{
+ char fname[] = "notify_object";
+ ay_voidfp *arr = ay_notifycbt.arr;
+ ay_notifycb *cb = NULL;
+ ay_object *o;
+ int i;
+
+  while(1)
+    {
+      pthread_mutex_lock(&ay_notify_mutex);
+      i = ay_notify_nexttask;
+      ay_notify_nexttask++;
+      pthread_mutex_unlock(&ay_notify_mutex);
+
+      if(i >= ay_notify_endtask)
+	break;
+
+      o = ay_notify_tasks[i];
+      cb = (ay_notifycb *)(arr[o->type]);
+      if(cb && cb(o))
+	{
+	  ay_error(AY_ERROR, fname, "notify callback failed");
+	  pthread_mutex_lock(&ay_notify_mutex);
+	  ay_notify_taskstatus = AY_ERROR;
+	  pthread_mutex_unlock(&ay_notify_mutex);
+	}
+    } /* while */
+
+ return NULL;
+} /* ay_notify_worker */
+#endif /* !WIN32 */
+
+
+/* ay_notify_runtasks:
+ *  run the notification callbacks of all tasks from index \a first
+ *  on, using worker threads if there is more than one task;
+ *  Tcl and OpenGL are only used by the main thread, error messages
+ *  of the callbacks are reported afterwards
+ */
+int
+ay_notify_runtasks(int first)
+{
+ int ay_status = AY_OK;
+ char fname[] = "notify_object";
+ ay_voidfp *arr = ay_notifycbt.arr;
+ ay_notifycb *cb = NULL;
+ int i;
+#ifndef WIN32
+ pthread_t threads[AY_NOTIFYMAXTHREADS];
+ int nthreads;
+#endif /* !WIN32 */
+
+  if(ay_notify_ntasks <= first)
+    return AY_OK;
+
+#ifndef WIN32
+  if(ay_notify_ntasks - first > 1)
+    {
+      ay_notify_nexttask = first;
+      ay_notify_endtask = ay_notify_ntasks;
+      ay_notify_taskstatus = AY_OK;
+      ay_notify_parallel(AY_TRUE);
+
+      nthreads = ay_notify_getnthreads();
+      if(nthreads > ay_notify_ntasks - first)
+	nthreads = ay_notify_ntasks - first;
+
+      /* the main thread is one of the workers */
+      for(i = 0; i < nthreads-1; i++)
+	{
+	  if(pthread_create(&(threads[i]), NULL, ay_notify_worker, NULL))
+	    break;
+	}
+      nthreads = i;
+
+      (void)ay_notify_worker(NULL);
+
+      for(i = 0; i < nthreads; i++)
+	{
+	  (void)pthread_join(threads[i], NULL);
+	}
+
+      ay_status = ay_notify_taskstatus;
+    }
+  else
+#endif /* !WIN32 */
+    {
+      for(i = first; i < ay_notify_ntasks; i++)
+	{
+	  cb = (ay_notifycb *)(arr[ay_notify_tasks[i]->type]);
+	  if(cb && cb(ay_notify_tasks[i]))
+	    {
+	      ay_error(AY_ERROR, fname, "notify callback failed");
+	      ay_status = AY_ERROR;
+	    }
+	}
+    } /* if */
+
+  ay_notify_ntasks = first;
+
+  /* report deferred error messages */
+  ay_notify_parallel(AY_FALSE);
+
+ return ay_status;
+} /* ay_notify_runtasks */
+
+
+/** ay_notify_parallel:
+ * Mark the begin or end of work that runs in multiple threads
+ * (parallel notification or other parallel work); while marked,
+ * error messages are deferred, at the end they are reported.
+ *
+ * \param[in] on  AY_TRUE at the begin, AY_FALSE at the end
+ */
+void
+ay_notify_parallel(int on)
+{
+ ay_notify_msg *msg;
+
+  ay_notify_inparallel = on;
+
+  if(on)
+    return;
+
+  while(ay_notify_msgs)
+    {
+      msg = ay_notify_msgs;
+      ay_notify_msgs = msg->next;
+      ay_error(msg->code, msg->where, msg->what);
+      if(msg->where)
+	free(msg->where);
+      if(msg->what)
+	free(msg->what);
+      free(msg);
+    }
+  ay_notify_lastmsg = &ay_notify_msgs;
+
+ return;
+} /* ay_notify_parallel */
+
+
+/** ay_notify_registerparallel:
+ * allow parallel execution of the notification callbacks of objects
+ * of type \a type_id (see ay_notify_isparallel() for further
+ * conditions); this is only safe for callbacks that solely read their
+ * children, modify nothing but the object itself, and do not use
+ * Tcl or OpenGL
+ *
+ * \param[in] type_id  object type (AY_ID...)
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_notify_registerparallel(unsigned int type_id)
+{
+ char *t;
+
+  if(type_id >= ay_notify_partypeslen)
+    {
+      if(!(t = realloc(ay_notify_partypes, (type_id+1)*sizeof(char))))
+	return AY_EOMEM;
+      memset(&(t[ay_notify_partypeslen]), 0,
+	     (type_id+1-ay_notify_partypeslen)*sizeof(char));
+      ay_notify_partypes = t;
+      ay_notify_partypeslen = type_id+1;
+    }
+
+  ay_notify_partypes[type_id] = 1;
+
+ return AY_OK;
+} /* ay_notify_registerparallel */
+
+
+/** ay_notify_lock:
+ * serialize access to data shared by notification callbacks
+ * (e.g. the provide cache); does nothing, unless notification
+ * callbacks are running in parallel
+ */
+void
+ay_notify_lock(void)
+{
+#ifndef WIN32
+  if(ay_notify_inparallel)
+    pthread_mutex_lock(&ay_notify_mutex);
+#endif /* !WIN32 */
+ return;
+} /* ay_notify_lock */
+
+
+/** ay_notify_unlock:
+ * release the lock obtained by ay_notify_lock()
+ */
+void
+ay_notify_unlock(void)
+{
+#ifndef WIN32
+  if(ay_notify_inparallel)
+    pthread_mutex_unlock(&ay_notify_mutex);
+#endif /* !WIN32 */
+ return;
+} /* ay_notify_unlock */
+
+
+/** ay_notify_defererror:
+ * While notification callbacks run in parallel, error messages
+ * can not be delivered to the Tcl interpreter; instead they are
+ * queued and reported when all callbacks finished.
+ *
+ * \param[in] code  error code
+ * \param[in] where  function or command name (may be NULL)
+ * \param[in] what  error message (may be NULL)
+ *
+ * \returns AY_TRUE if the message was queued (or lost),
+ *  AY_FALSE if it is to be reported immediately
+ */
+int
+ay_notify_defererror(int code, const char *where, const char *what)
+{
+ ay_notify_msg *msg;
+
+  if(!ay_notify_inparallel)
+    return AY_FALSE;
+
+  if(!(msg = calloc(1, sizeof(ay_notify_msg))))
+    return AY_TRUE;
+
+  msg->code = code;
+  if(where && (msg->where = malloc((strlen(where)+1)*sizeof(char))))
+    strcpy(msg->where, where);
+  if(what && (msg->what = malloc((strlen(what)+1)*sizeof(char))))
+    strcpy(msg->what, what);
+
+  ay_notify_lock();
+  *ay_notify_lastmsg = msg;
+  ay_notify_lastmsg = &(msg->next);
+  ay_notify_unlock();
+
+ return AY_TRUE;
+} /* ay_notify_defererror */
+
+
 /** ay_notify_parentof
  * Search for the object \a o in the scene while simultaneously creating
  * a list of parent objects and if the object is found, call
@@ -364,7 +887,8 @@ ay_notify_objecttcmd(ClientData clientData, Tcl_Interp *interp,
  char notify_all = AY_FALSE;
  char notify_parent = AY_FALSE;
  ay_list_object *sel = ay_selection;
- ay_object *o = NULL;
+ ay_object *o = NULL, **mod = NULL;
+ int nmod = 0;
 
   if(!strcmp(argv[0], "forceNot"))
     {
@@ -465,6 +989,22 @@ ay_notify_objecttcmd(ClientData clientData, Tcl_Interp *interp,
 	}
       else
 	{
+	  if(ay_prefs.completenotify)
+	    {
+	      while(sel)
+		{
+		  nmod++;
+		  sel = sel->next;
+		}
+	      if(!(mod = malloc(nmod*sizeof(ay_object*))))
+		{
+		  ay_error(AY_EOMEM, argv[0], NULL);
+		  return TCL_OK;
+		}
+	      nmod = 0;
+	      sel = ay_selection;
+	    }
+
 	  while(sel)
 	    {
 	      if(notify_modified)
@@ -479,11 +1019,8 @@ ay_notify_objecttcmd(ClientData clientData, Tcl_Interp *interp,
 
 		      if(ay_prefs.completenotify)
 			{
-			  ay_status = ay_notify_complete(sel->object);
-			  if(ay_status)
-			    {
-			      ay_error(AY_ERROR, argv[0], NULL);
-			    }
+			  if(mod)
+			    mod[nmod++] = sel->object;
 			}
 		      else
 			{
@@ -503,11 +1040,8 @@ ay_notify_objecttcmd(ClientData clientData, Tcl_Interp *interp,
 
 		  if(ay_prefs.completenotify)
 		    {
-		      ay_status = ay_notify_complete(sel->object);
-		      if(ay_status)
-			{
-			  ay_error(AY_ERROR, argv[0], NULL);
-			}
+		      if(mod)
+			mod[nmod++] = sel->object;
 		    }
 		  else
 		    {
@@ -518,6 +1052,17 @@ ay_notify_objecttcmd(ClientData clientData, Tcl_Interp *interp,
 	      sel = sel->next;
 	    } /* while */
 
+	  if(mod)
+	    {
+	      /* do one complete notification for all objects */
+	      ay_status = ay_notify_completelist(mod, nmod);
+	      if(ay_status)
+		{
+		  ay_error(AY_ERROR, argv[0], NULL);
+		}
+	      free(mod);
+	    }
+
 	  if(!ay_prefs.completenotify && notify_parent)
 	    {
 	      ay_notify_parent();
@@ -529,105 +1074,240 @@ ay_notify_objecttcmd(ClientData clientData, Tcl_Interp *interp,
 } /* ay_notify_objecttcmd */
 
 
-/** ay_notify_findparents:
- * _Recursively_ collect all parents of object \a r _and its instances_
- * in \a parents.
- * The return value is only used for controlling the recursion, it
- * can be safely disregarded by the caller.
- *
- * \param[in] o  current level to process
- * \param[in] r  target object
- * \param[in,out] parents  where the list of parents is constructed
- *
- * \returns AY_TRUE if \a r was found, AY_FALSE else and in error case
+/* ay_notify_addnodes:
+ *  add the objects in list \a o (and their children) to the
+ *  dependency graph
  */
 int
-ay_notify_findparents(ay_object *o, ay_object *r, ay_list_object **parents)
+ay_notify_addnodes(ay_object *o, int parent)
 {
- ay_object *down;
- ay_tag *newt = NULL;
- ay_list_object *newl = NULL;
- int dfound = AY_FALSE, found = AY_FALSE;
-
-  if(!o || !r || !parents)
-    return 0;
+ int ay_status = AY_OK;
+ ay_notify_node *t;
+ Tcl_HashEntry *entry;
+ int new_item = 0, i;
 
-  if(o->down)
+  while(o && o != ay_endlevel)
     {
-      down = o->down;
+      if(ay_notify_nnodes >= ay_notify_anodes)
+	{
+	  if(!(t = realloc(ay_notify_nodes, (ay_notify_anodes+256)*2*
+			   sizeof(ay_notify_node))))
+	    return AY_EOMEM;
+	  ay_notify_nodes = t;
+	  ay_notify_anodes = (ay_notify_anodes+256)*2;
+	}
+
+      i = ay_notify_nnodes;
+      ay_notify_nodes[i].o = o;
+      ay_notify_nodes[i].parent = parent;
+      ay_notify_nodes[i].firstinst = -1;
+      ay_notify_nodes[i].nextinst = -1;
+      ay_notify_nodes[i].stamp = 0;
+      ay_notify_nodes[i].indeg = 0;
+      ay_notify_nnodes++;
 
-      while(down && down->next)
+      entry = Tcl_CreateHashEntry(&ay_notify_graphht, (char*)o, &new_item);
+      Tcl_SetHashValue(entry, (char*)(size_t)i);
+
+      if(o->down && o->down->next)
 	{
-	  dfound = AY_FALSE;
-	  if(down->down && down->down->next)
-	    {
-	      dfound = ay_notify_findparents(down, r, parents);
-	    }
-	  if(dfound)
-	    {
-	      found = AY_TRUE;
-	    }
-	  if((down == r) || (down->refine == r))
-	    {
-	      found = AY_TRUE;
-	    }
-	  down = down->next;
-	} /* while */
+	  ay_status = ay_notify_addnodes(o->down, i);
+	  if(ay_status)
+	    return ay_status;
+	}
+
+      o = o->next;
+    } /* while */
+
+ return ay_status;
+} /* ay_notify_addnodes */
+
+
+/* ay_notify_buildgraph:
+ *  (re)build the dependency graph of the scene;
+ *  the graph contains all objects with their parents, and for
+ *  every master object the list of its instances
+ */
+int
+ay_notify_buildgraph(void)
+{
+ int ay_status = AY_OK;
+ Tcl_HashEntry *entry;
+ int i, m;
 
-      if(found)
+  Tcl_DeleteHashTable(&ay_notify_graphht);
+  Tcl_InitHashTable(&ay_notify_graphht, TCL_ONE_WORD_KEYS);
+  ay_notify_nnodes = 0;
+  ay_notify_graphvalid = AY_FALSE;
+
+  if(!ay_root)
+    return AY_OK;
+
+  ay_status = ay_notify_addnodes(ay_root, -1);
+  if(ay_status)
+    return ay_status;
+
+  /* link instances to their masters */
+  for(i = 0; i < ay_notify_nnodes; i++)
+    {
+      if(ay_notify_nodes[i].o->type == AY_IDINSTANCE &&
+	 ay_notify_nodes[i].o->refine)
 	{
-	  if(!(newl = calloc(1, sizeof(ay_list_object))))
+	  entry = Tcl_FindHashEntry(&ay_notify_graphht,
+				    (char*)ay_notify_nodes[i].o->refine);
+	  if(entry)
 	    {
-	      return 0;
+	      m = (int)(size_t)Tcl_GetHashValue(entry);
+	      ay_notify_nodes[i].nextinst = ay_notify_nodes[m].firstinst;
+	      ay_notify_nodes[m].firstinst = i;
 	    }
+	}
+    } /* for */
 
-	  newl->object = o;
-	  o->modified = AY_FALSE;
-	  newl->next = *parents;
-	  *parents = newl;
-	  if(o->tags && o->tags->type == ay_nc_tagtype)
-	    {
-	      o->tags->val = 0;
-	    }
-	  else
-	    {
-	      if(!(newt = calloc(1, sizeof(ay_tag))))
-		{
-		  free(newl);
-		  *parents = NULL;
-		  return 0;
-		}
-	      newt->next = o->tags;
-	      newt->type = ay_nc_tagtype;
-	      newt->is_intern = AY_TRUE;
-	      o->tags = newt;
-	    } /* if */
-	} /* if found */
-    } /* if have children */
+  ay_notify_stamp = 0;
+  ay_notify_graphvalid = AY_TRUE;
 
- return found;
-} /* ay_notify_findparents */
+ return ay_status;
+} /* ay_notify_buildgraph */
 
 
-/** ay_notify_complete:
- * Start a complete notification for object \a r.
+/** ay_notify_invalidate:
+ * Inform the notification module about a change of the scene
+ * structure (linking, unlinking, or deletion of objects; creation
+ * of instances), so that the dependency graph used by the complete
+ * notification gets rebuilt and cached bounding boxes
+ * (see ay_bbc_getcached()) get discarded.
+ *
+ * \param[in] o  object that is going to be deleted, if NULL the
+ *  structure of the scene changed in an unspecified way
+ */
+void
+ay_notify_invalidate(ay_object *o)
+{
+ Tcl_HashEntry *entry;
+
+  if(!o)
+    {
+      ay_bbc_uncache(NULL);
+      ay_notify_graphvalid = AY_FALSE;
+      return;
+    }
+
+  ay_notify_lock();
+
+  ay_bbc_uncache(o);
+
+  if(!ay_notify_graphvalid)
+    {
+      ay_notify_unlock();
+      return;
+    }
+
+  /* deletion of objects that are not part of the scene (e.g. temporary
+     objects created by tool objects) does not change the graph */
+  if((entry = Tcl_FindHashEntry(&ay_notify_graphht, (char*)o)))
+    {
+      ay_notify_nodes[(int)(size_t)Tcl_GetHashValue(entry)].o = NULL;
+      Tcl_DeleteHashEntry(entry);
+      ay_notify_graphvalid = AY_FALSE;
+    }
+
+  ay_notify_unlock();
+
+ return;
+} /* ay_notify_invalidate */
+
+
+/* ay_notify_getnode:
+ *  get index of the graph node of object \a o, -1 if not in the scene
+ */
+int
+ay_notify_getnode(ay_object *o)
+{
+ Tcl_HashEntry *entry;
+
+  if((entry = Tcl_FindHashEntry(&ay_notify_graphht, (char*)o)))
+    return (int)(size_t)Tcl_GetHashValue(entry);
+
+ return -1;
+} /* ay_notify_getnode */
+
+
+/* ay_notify_visit:
+ *  mark node \a i as part of the current complete notification
+ *  and push it onto \a stack if it was not visited before
+ */
+void
+ay_notify_visit(int i, int *stack, int *nstack)
+{
+ ay_notify_node *n = &(ay_notify_nodes[i]);
+
+  if(n->stamp != ay_notify_stamp)
+    {
+      n->stamp = ay_notify_stamp;
+      n->indeg = 0;
+      n->done = AY_FALSE;
+      stack[(*nstack)++] = i;
+    }
+
+ return;
+} /* ay_notify_visit */
+
+
+/* ay_notify_getdeps:
+ *  get the nodes that directly depend on node \a i:
+ *  its parent and the parents of its instances;
+ *  returns the number of dependents stored in \a deps
+ *  (which must be large enough to hold all nodes)
+ */
+int
+ay_notify_getdeps(int i, int *deps)
+{
+ ay_notify_node *n = &(ay_notify_nodes[i]), *in;
+ int ndeps = 0, j;
+
+  if(n->parent != -1)
+    deps[ndeps++] = n->parent;
+
+  j = n->firstinst;
+  while(j != -1)
+    {
+      in = &(ay_notify_nodes[j]);
+      if(in->o && in->o->type == AY_IDINSTANCE && in->o->refine == n->o &&
+	 in->parent != -1)
+	deps[ndeps++] = in->parent;
+      j = in->nextinst;
+    }
+
+ return ndeps;
+} /* ay_notify_getdeps */
+
+
+/** ay_notify_completelist:
+ * Start a complete notification for the objects \a r.
  * The complete notification updates all objects in the scene that depend
- * on object \a r regardless of whether they are parents of \a r or not.
+ * on the objects \a r regardless of whether they are parents of \a r or not.
  * Such dependencies are created by instances.
- * The complete notification is efficient, i.e. no object is updated twice.
  *
- * \param[in] r  object for which to start the notification
+ * The dependencies are taken from a graph of the scene that is only
+ * rebuilt when the scene structure changes (see ay_notify_invalidate()).
+ * Only the objects depending on \a r are visited, and they are notified
+ * exactly once, in topological order (i.e. after all objects they
+ * depend on).
+ *
+ * \param[in] r  objects for which to start the notification
+ * \param[in] nr  number of objects in \a r
  *
  * \returns AY_OK on success, error code otherwise.
  */
 int
-ay_notify_complete(ay_object *r)
+ay_notify_completelist(ay_object **r, int nr)
 {
  static int lock = 0;
- int propagate = AY_TRUE;
- ay_object *o;
- ay_tag *tag;
- ay_list_object *l = NULL, *s, *t, *u;
+ int ay_status = AY_OK;
+ int *stack = NULL, *deps = NULL, *order = NULL;
+ int nstack = 0, nvisited = 0, ndeps, i, j, k, rebuilt = AY_FALSE;
+ ay_notify_node *n;
 
   /* avoid recursive calls that may happen with Script objects */
   if(lock)
@@ -635,93 +1315,142 @@ ay_notify_complete(ay_object *r)
       return AY_OK;
     }
 
-  lock = 1;
-
   if(!r)
     {
-      lock = 0;
       return AY_ENULL;
     }
 
-  o = ay_root;
+  lock = 1;
 
-  while(o)
+  if(!ay_notify_graphvalid)
     {
-      (void)ay_notify_findparents(o, r, &l);
-      o = o->next;
-    } /* while */
+      ay_status = ay_notify_buildgraph();
+      if(ay_status)
+	goto cleanup;
+      rebuilt = AY_TRUE;
+    }
 
-  u = NULL;
-  while(propagate)
+  /* a new object, not yet known to the graph? */
+  for(i = 0; i < nr; i++)
     {
-      propagate = AY_FALSE;
-      t = l;
-      s = l;
-      while(s && (s != u))
+      if(r[i] && ay_notify_getnode(r[i]) == -1 && !rebuilt)
 	{
-	  if(s->object && (s->object->refcount > 0))
-	    {
-	      o = ay_root->next;
-	      while(o)
-		{
-		  (void)ay_notify_findparents(o, s->object, &l);
-		  o = o->next;
-		} /* while */
-	    } /* if */
-	  s = s->next;
-	} /* while */
-
-      if(l != t)
-	{
-	  /* added some objects, need to continue propagating... */
-	  propagate = AY_TRUE;
+	  ay_status = ay_notify_buildgraph();
+	  if(ay_status)
+	    goto cleanup;
+	  rebuilt = AY_TRUE;
 	}
+    }
 
-      /* for consecutive iterations, arrange to stop at old list, because
-	 we processed that already */
-      u = t;
-    } /* while */
+  if(!(stack = malloc(3*(ay_notify_nnodes+1)*sizeof(int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  deps = stack+ay_notify_nnodes+1;
+  order = deps+ay_notify_nnodes+1;
+
+  if(!++ay_notify_stamp)
+    {
+      for(i = 0; i < ay_notify_nnodes; i++)
+	ay_notify_nodes[i].stamp = 0;
+      ay_notify_stamp = 1;
+    }
 
-  /* revert list */
-  s = NULL;
-  while(l)
+  /* collect the affected subgraph and count the incoming edges */
+  for(i = 0; i < nr; i++)
     {
-      t = l;
-      l = l->next;
-      o = t->object;
-      if(o && o->tags && (o->tags->type == ay_nc_tagtype))
+      if(r[i] && (j = ay_notify_getnode(r[i])) != -1)
+	ay_notify_visit(j, stack, &nstack);
+    }
+
+  while(nstack)
+    {
+      i = stack[--nstack];
+      order[nvisited++] = i;
+      ndeps = ay_notify_getdeps(i, deps);
+      for(k = 0; k < ndeps; k++)
 	{
-	  o->tags->val = (char*)o->tags->val + 1;
+	  ay_notify_visit(deps[k], stack, &nstack);
+	  ay_notify_nodes[deps[k]].indeg++;
 	}
-      t->next = s;
-      s = t;
     } /* while */
 
-  while(s)
+  /* start with the objects that do not depend on other affected objects */
+  for(i = 0; i < nvisited; i++)
+    {
+      n = &(ay_notify_nodes[order[i]]);
+      if(n->indeg == 0)
+	{
+	  n->done = AY_TRUE;
+	  stack[nstack++] = order[i];
+	}
+    }
+
+  /* the objects in r were already notified by the caller,
+     all other objects are notified when all their dependencies are */
+  while(nstack)
     {
-      o = s->object;
-      if(o && o->tags && (o->tags->type == ay_nc_tagtype))
+      i = stack[--nstack];
+      ndeps = ay_notify_getdeps(i, deps);
+      for(k = 0; k < ndeps; k++)
 	{
-	  o->tags->val = (char*)o->tags->val - 1;
-	  if(o->tags->val == 0)
+	  n = &(ay_notify_nodes[deps[k]]);
+	  n->indeg--;
+	  if(n->indeg == 0 && !n->done)
 	    {
-	      (void)ay_notify_object(o);
-	      if(o->tags && (o->tags->type == ay_nc_tagtype))
+	      n->done = AY_TRUE;
+	      if(n->o)
 		{
-		  tag = o->tags;
-		  o->tags = tag->next;
-		  free(tag);
+		  (void)ay_notify_object(n->o);
+		  if(n->o)
+		    n->o->modified = AY_FALSE;
 		}
-	    } /* if */
-	} /* if */
-      t = s->next;
-      free(s);
-      s = t;
+	      stack[nstack++] = deps[k];
+	    }
+	} /* for */
     } /* while */
 
+  /* cyclic dependencies (should not happen), notify the rest once */
+  for(i = 0; i < nvisited; i++)
+    {
+      n = &(ay_notify_nodes[order[i]]);
+      if(!n->done)
+	{
+	  n->done = AY_TRUE;
+	  if(n->o)
+	    {
+	      (void)ay_notify_object(n->o);
+	      if(n->o)
+		n->o->modified = AY_FALSE;
+	    }
+	}
+    }
+
+cleanup:
+
+  if(stack)
+    free(stack);
+
   lock = 0;
 
- return AY_OK;
+ return ay_status;
+} /* ay_notify_completelist */
+
+
+/** ay_notify_complete:
+ * Start a complete notification for object \a r.
+ * See ay_notify_completelist().
+ *
+ * \param[in] r  object for which to start the notification
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_notify_complete(ay_object *r)
+{
+
+  if(!r)
+    return AY_ENULL;
+
+ return ay_notify_completelist(&r, 1);
 } /* ay_notify_complete */
 
 
@@ -790,7 +1519,7 @@ ay_notify_objectsafetcmd(ClientData clientData, Tcl_Interp *interp,
 
 
 /** ay_notify_init:
- * Initialize the notification module by registering the NC tag type.
+ * Initialize the notification module.
  *
  * \param[in] interp  Tcl interpreter, currently unused
  *
@@ -799,8 +1528,36 @@ void
 ay_notify_init(Tcl_Interp *interp)
 {
 
-  /* register NC tag type */
-  (void)ay_tags_register(ay_nc_tagname, &ay_nc_tagtype);
+#ifndef WIN32
+ pthread_mutexattr_t attr;
+#endif /* !WIN32 */
+
+  Tcl_InitHashTable(&ay_notify_graphht, TCL_ONE_WORD_KEYS);
+
+#ifndef WIN32
+  /* the mutex must be recursive, as e.g. deleting objects
+     from the provide cache will also lock it */
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&ay_notify_mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+#endif /* !WIN32 */
+
+  /* register object types whose notification callbacks
+     may run in parallel; those callbacks may only modify the
+     objects they notify (shared data, like the standard bevel
+     curves, is created beforehand, see ay_bevelt_init()) */
+  (void)ay_notify_registerparallel(AY_IDBEVEL);
+  (void)ay_notify_registerparallel(AY_IDBIRAIL1);
+  (void)ay_notify_registerparallel(AY_IDBIRAIL2);
+  (void)ay_notify_registerparallel(AY_IDDSKIN);
+  (void)ay_notify_registerparallel(AY_IDEXTRUDE);
+  (void)ay_notify_registerparallel(AY_IDGORDON);
+  (void)ay_notify_registerparallel(AY_IDOFFNP);
+  (void)ay_notify_registerparallel(AY_IDREVOLVE);
+  (void)ay_notify_registerparallel(AY_IDSKIN);
+  (void)ay_notify_registerparallel(AY_IDSWEEP);
+  (void)ay_notify_registerparallel(AY_IDSWING);
 
  return;
 } /* ay_notify_init */
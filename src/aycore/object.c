@@ -351,6 +351,12 @@ ay_object_delete(ay_object *o)
       o->name = NULL;
     }
 
+  /* remove cached provide results */
+  ay_provide_uncache(o);
+
+  /* update dependency graph */
+  ay_notify_invalidate(o);
+
   /* finally, delete the object */
   free(o);
 
@@ -609,6 +615,8 @@ void
 ay_object_link(ay_object *o)
 {
 
+  ay_notify_invalidate(NULL);
+
   if(ay_next)
     {
       o->next = *ay_next;
@@ -652,6 +660,8 @@ ay_object_unlink(ay_object *o)
  ay_list_object *clevel = ay_currentlevel;
  ay_object *clevelobj = NULL, *p1, *p2;
 
+  ay_notify_invalidate(NULL);
+
   clevelobj = clevel->object;
 
   /* unlink first object of current level? */
@@ -2010,6 +2020,8 @@ ay_object_replace(ay_object *src, ay_object *dst)
 	return ay_status;
     }
 
+  ay_notify_invalidate(NULL);
+
   memcpy(dst, src, sizeof(ay_object));
 
   if(oldmat)
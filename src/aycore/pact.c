@@ -288,6 +288,7 @@ ay_pact_seltcb(struct Togl *togl, int argc, char *argv[])
  Tcl_Interp *interp = Togl_Interp(togl);
  ay_point *newp = NULL, *point = NULL, *last = NULL;
  ay_pointedit pe = {0};
+ ay_selpset have = {0}, rem = {0};
  ay_list_object *sel = ay_selection;
  ay_view_object *view = Togl_GetClientData(togl);
  ay_object *o = NULL;
@@ -361,6 +362,96 @@ ay_pact_seltcb(struct Togl *togl, int argc, char *argv[])
 	  ay_status = ay_pact_getpoint(2, o, pl, &pe);
 	} /* if */
 
+      if(!ay_status && pe.coords && pe.indices)
+	{
+	  /* with point indices available, test membership and
+	     collect removals via bitsets, so that selecting many
+	     points stays linear */
+	  ay_status = ay_selp_setfromlist(o->selp, 0, &have);
+	  if(!ay_status)
+	    ay_status = ay_selp_setinit(&rem, 0);
+	  if(ay_status)
+	    {
+	      ay_selp_setfree(&have);
+	      ay_pact_clearpointedit(&pe);
+	      ay_error(AY_EOMEM, fname, NULL);
+	      return TCL_OK;
+	    }
+
+	  for(i = 0; i < pe.num; i++)
+	    {
+	      if(AY_SELPSETHAS(&have, pe.indices[i]))
+		{
+		  /* we have that point already, so we remove
+		     it from the selection if we are not in
+		     multiple selection mode; we also remove
+		     it if we are in multiple deletion mode */
+		  if(!multiple || multipledel)
+		    {
+		      if(ay_selp_setadd(&rem, pe.indices[i]))
+			break;
+		    }
+		}
+	      else
+		{
+		  /* add point to selection (but not if we are in
+		     multiple deletion mode, where we only remove
+		     points from the selection) */
+		  if(!multipledel)
+		    {
+		      if(!(newp = malloc(sizeof(ay_point))))
+			break;
+
+		      if(ay_selp_setadd(&have, pe.indices[i]))
+			{
+			  free(newp);
+			  break;
+			}
+
+		      newp->next = o->selp;
+		      o->selp = newp;
+		      newp->point = pe.coords[i];
+		      newp->index = pe.indices[i];
+		      newp->type = pe.type;
+		      newp->readonly = pe.readonly;
+		      o->modified = 2;
+		    } /* if */
+		} /* if */
+	    } /* for */
+
+	  if(i < pe.num)
+	    ay_error(AY_EOMEM, fname, NULL);
+
+	  /* remove points in one pass */
+	  if(rem.num)
+	    {
+	      last = NULL;
+	      point = o->selp;
+	      while(point)
+		{
+		  if(AY_SELPSETHAS(&rem, point->index))
+		    {
+		      if(last)
+			last->next = point->next;
+		      else
+			o->selp = point->next;
+		      newp = point->next;
+		      free(point);
+		      point = newp;
+		      o->modified = 2;
+		    }
+		  else
+		    {
+		      last = point;
+		      point = point->next;
+		    }
+		} /* while */
+	    } /* if */
+
+	  ay_selp_setfree(&have);
+	  ay_selp_setfree(&rem);
+	}
+      else
       if(!ay_status && pe.coords)
 	{
 	  for(i = 0; i < pe.num; i++)
@@ -14,8 +14,6 @@
 
 /* peek.c - functions for peek mechanism */
 
-static double peek_trafos[32];
-
 /** ay_peek_register:
  * register a peek callback
  *
@@ -52,6 +50,8 @@ ay_peek_singleobject(ay_object *o, unsigned int type)
  ay_peekcb *cb = NULL;
  ay_providecb *provcb = NULL;
  ay_object *pobjects[2] = { NULL, ay_endlevel }, **singlepeek;
+ double trafos[32], *t = trafos;
+ int peekcount;
 
   singlepeek = pobjects;
 
@@ -63,7 +63,17 @@ ay_peek_singleobject(ay_object *o, unsigned int type)
 
   if(cb)
     {
-      ay_status = cb(o, type, singlepeek, &(peek_trafos[0]));
+      /* the callback delivers transformations for all objects
+	 it may peek at, provide room for them (on the stack, not in
+	 a static buffer, so that this function is reentrant) */
+      peekcount = cb(o, type, NULL, NULL);
+      if(peekcount > 2 && !(t = malloc(peekcount*16*sizeof(double))))
+	return NULL;
+
+      ay_status = cb(o, type, singlepeek, t);
+
+      if(t != trafos)
+	free(t);
 
       if(pobjects[0])
 	return pobjects[0];
@@ -142,7 +152,7 @@ ay_peek_object(ay_object *o, unsigned int type, ay_object ***objrefs,
  ay_providecb *provcb = NULL;
  int peekcount, freeobjrefs = AY_FALSE, freetrafos = AY_FALSE;
  int i = 0, j = 0, have_trafo = AY_FALSE;
- double tmo[16];
+ double tmo[16], trafos[32], *t = trafos;
 
   if(!o)
     return AY_ENULL;
@@ -213,7 +223,17 @@ ay_peek_object(ay_object *o, unsigned int type, ay_object ***objrefs,
       if(transforms)
 	ay_status = cb(o, type, *objrefs, *transforms);
       else
-	ay_status = cb(o, type, *objrefs, &(peek_trafos[0]));
+	{
+	  /* provide room for the transformations (see above) */
+	  if(!freeobjrefs)
+	    peekcount = cb(o, type, NULL, NULL);
+	  if(peekcount > 2 && !(t = malloc(peekcount*16*sizeof(double))))
+	    ay_status = AY_EOMEM;
+	  else
+	    ay_status = cb(o, type, *objrefs, t);
+	  if(t != trafos)
+	    free(t);
+	}
 
       if(ay_status)
 	{
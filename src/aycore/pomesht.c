@@ -624,8 +624,9 @@ ay_pomesht_merge(int merge_pv_tags, ay_list_object *list, ay_object **result)
 			} /* while */
 		      (void)ay_tags_copyall(o, no);
 
-		      /* extend all PV tags to merge, so that we
-			 can use ay_pv_mergeinto() later */
+		      /* extend all string PV tags to merge, so that we
+			 can use ay_pv_mergeinto() later (binary PV tags
+			 are extended by ay_pv_mergeinto() itself) */
 		      if(have_pv_tags)
 			{
 
@@ -633,7 +634,8 @@ ay_pomesht_merge(int merge_pv_tags, ay_list_object *list, ay_object **result)
 			  while(tag1)
 			    {
 			      if(tag1->type == ay_pv_tagtype &&
-				 ay_pv_getdetail(tag1, NULL) >= 2)
+				 ay_pv_getdetail(tag1, NULL) >= 2 &&
+				 ay_pv_tobinary(tag1))
 				{
 				  totallen = strlen(tag1->val);
 				  lot = lo->next;
@@ -643,6 +645,7 @@ ay_pomesht_merge(int merge_pv_tags, ay_list_object *list, ay_object **result)
 				      while(tag2)
 					{
 					  if((tag2->type == ay_pv_tagtype) &&
+					     !tag2->is_binary &&
 					     ay_pv_cmpndt(tag1, tag2))
 					    {
 					      totallen += strlen(tag2->val);
@@ -652,16 +655,16 @@ ay_pomesht_merge(int merge_pv_tags, ay_list_object *list, ay_object **result)
 					} /* while */
 				      lot = lot->next;
 				    } /* while */
-				} /* if */
 
-			      if(!(ct =
-				   realloc(tag1->val, totallen*sizeof(char))))
-				{
-				  ay_object_delete(no);
-				  return AY_EOMEM;
-				}
+				  if(!(ct = realloc(tag1->val,
+						    totallen*sizeof(char))))
+				    {
+				      ay_object_delete(no);
+				      return AY_EOMEM;
+				    }
 
-			      tag1->val = ct;
+				  tag1->val = ct;
+				} /* if */
 
 			      tag1 = tag1->next;
 			    } /* while */
@@ -775,6 +778,14 @@ ay_pomesht_optimizepv(ay_object *o, unsigned int *ois, unsigned int oislen)
   while(tag)
     {
       /* only work on varying tags */
+      if(tag->type == ay_pv_tagtype && ay_pv_getdetail(tag, NULL) >= 2 &&
+	 !ay_pv_tobinary(tag))
+	{
+	  ay_status = ay_pv_selectelems(tag, ois, oislen);
+	  if(ay_status)
+	    goto cleanup;
+	}
+      else
       if(tag->type == ay_pv_tagtype && ay_pv_getdetail(tag, NULL) >= 2)
 	{
 	  nv = NULL;
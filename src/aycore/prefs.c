@@ -44,6 +44,10 @@ ay_prefs_gettcmd(ClientData clientData, Tcl_Interp *interp,
 		Tcl_NewIntObj(ay_prefs.completenotify),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 
+  Tcl_SetVar2Ex(interp, arr, "NotifyThreads",
+		Tcl_NewIntObj(ay_prefs.notifythreads),
+		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+
   Tcl_SetVar2Ex(interp, arr, "EditSnaps",
 		Tcl_NewIntObj(ay_prefs.edit_snaps_to_grid),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
@@ -80,6 +84,10 @@ ay_prefs_gettcmd(ClientData clientData, Tcl_Interp *interp,
 		Tcl_NewIntObj(ay_prefs.undo_levels),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 
+  Tcl_SetVar2Ex(interp, arr, "UndoMemory",
+		Tcl_NewIntObj(ay_prefs.undo_memory),
+		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+
   Tcl_SetVar2Ex(interp, arr, "Snap3D",
 		Tcl_NewIntObj(ay_prefs.snap3d),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
@@ -100,6 +108,10 @@ ay_prefs_gettcmd(ClientData clientData, Tcl_Interp *interp,
 		Tcl_NewDoubleObj(ay_prefs.glu_sampling_tolerance_a),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 
+  Tcl_SetVar2Ex(interp, arr, "LODTolerance",
+		Tcl_NewDoubleObj(ay_prefs.lod_tolerance),
+		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+
   Tcl_SetVar2Ex(interp, arr, "NPDisplayMode",
 		Tcl_NewIntObj(ay_prefs.np_display_mode),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
@@ -280,6 +292,10 @@ ay_prefs_gettcmd(ClientData clientData, Tcl_Interp *interp,
 		Tcl_NewStringObj(ay_prefs.pprender, -1),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 
+  Tcl_SetVar2Ex(interp, arr, "PPRetained",
+		Tcl_NewIntObj(ay_prefs.pprev_retained),
+		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+
   Tcl_SetVar2Ex(interp, arr, "SMethod",
 		Tcl_NewIntObj(ay_prefs.smethod),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
@@ -581,6 +597,10 @@ ay_prefs_settcmd(ClientData clientData, Tcl_Interp *interp,
 			   TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 	Tcl_GetIntFromObj(interp, to, &(ay_prefs.list_types));
 
+	to = Tcl_GetVar2Ex(interp, arr, "LODTolerance",
+			   TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+	Tcl_GetDoubleFromObj(interp, to, &(ay_prefs.lod_tolerance));
+
 	if(setall || arglen == 5)
 	  ay_prefs_setcolor(interp, arr, colli, &(ay_prefs.lir),
 			    &(ay_prefs.lig), &(ay_prefs.lib));
@@ -622,6 +642,10 @@ ay_prefs_settcmd(ClientData clientData, Tcl_Interp *interp,
 	to = Tcl_GetVar2Ex(interp, arr, "NCDisplayModeA",
 			   TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 	Tcl_GetIntFromObj(interp, to, &(ay_prefs.nc_display_mode_a));
+
+	to = Tcl_GetVar2Ex(interp, arr, "NotifyThreads",
+			   TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+	Tcl_GetIntFromObj(interp, to, &(ay_prefs.notifythreads));
       } /* N... */
 
     if(setall || (argv[i][0] == 'O'))
@@ -701,6 +725,10 @@ ay_prefs_settcmd(ClientData clientData, Tcl_Interp *interp,
 	if((ay_status = ay_tcmd_getstring(interp, arr, "PPRender",
 					  &(ay_prefs.pprender))))
 	  goto cleanup;
+
+	to = Tcl_GetVar2Ex(interp, arr, "PPRetained",
+			   TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+	Tcl_GetIntFromObj(interp, to, &(ay_prefs.pprev_retained));
       } /* P... */
 
     if(setall || (argv[i][0] == 'Q'))
@@ -836,6 +864,10 @@ ay_prefs_settcmd(ClientData clientData, Tcl_Interp *interp,
 	    ay_prefs.undo_levels = itemp;
 	  } /* if */
 
+	to = Tcl_GetVar2Ex(interp, arr, "UndoMemory",
+			   TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+	Tcl_GetIntFromObj(interp, to, &(ay_prefs.undo_memory));
+
 	to = Tcl_GetVar2Ex(interp, arr, "UseMatColor",
 			   TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 	Tcl_GetIntFromObj(interp, to, &(ay_prefs.use_materialcolor));
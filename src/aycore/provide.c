@@ -14,6 +14,70 @@
 
 /* provide.c - functions for provide mechanism */
 
+/* local types: */
+
+/** provide cache entry */
+typedef struct ay_provide_centry_s {
+  struct ay_provide_centry_s *next; /**< next entry of same object */
+  struct ay_provide_centry_s *lrunext; /**< next (older) entry in LRU list */
+  struct ay_provide_centry_s *lruprev; /**< previous entry in LRU list */
+  ay_object *o; /**< providing object */
+  unsigned int type; /**< provided type */
+  unsigned int version; /**< version of providing object */
+  double key[16]; /**< transformation attributes of providing object
+		     and tesselation preferences */
+  unsigned long tagsum; /**< checksum of tags of providing object */
+  ay_object *result; /**< cached result */
+  size_t bytes; /**< estimated size of cached result */
+} ay_provide_centry;
+
+
+/* local variables: */
+
+/** cache entries, keyed by object pointer */
+static Tcl_HashTable ay_provide_cacheht;
+
+/** most recently used cache entry */
+static ay_provide_centry *ay_provide_lruhead = NULL;
+
+/** least recently used cache entry */
+static ay_provide_centry *ay_provide_lrutail = NULL;
+
+/** which provided type may be cached (indexed by type id,
+    AY_IDROOT designates no caching) */
+static unsigned int *ay_provide_cachetypes = NULL;
+static unsigned int ay_provide_cachetypeslen = 0;
+
+/** statistics */
+static unsigned long ay_provide_cachehits = 0;
+static unsigned long ay_provide_cachemisses = 0;
+static unsigned int ay_provide_cacheentries = 0;
+static size_t ay_provide_cachebytes = 0;
+
+/** maximum size of the cache in bytes */
+static size_t ay_provide_cachelimit = 64*1024*1024;
+
+
+/* prototypes of functions local to this module: */
+
+size_t ay_provide_estsize(ay_object *o);
+
+void ay_provide_getkey(ay_object *o, double *key, unsigned long *tagsum);
+
+void ay_provide_unlinkentry(ay_provide_centry *e);
+
+void ay_provide_freeentry(ay_provide_centry *e);
+
+ay_provide_centry *ay_provide_findentry(ay_object *o, unsigned int type);
+
+int ay_provide_cacheresult(ay_object *o, unsigned int type,
+			   ay_object *result);
+
+int ay_provide_copyresult(ay_object *src, ay_object **result);
+
+
+/* functions: */
+
 /** ay_provide_register:
  * register a provide callback
  *
@@ -42,6 +106,14 @@ ay_provide_register(ay_providecb *provcb, unsigned int type_id)
  * \param[in,out] result where to store the resulting objects,
  *   may be NULL to designate a check
  *
+ * Results of the object/type combinations registered via
+ * ay_provide_registercache() are cached, keyed by object, object
+ * version (see ay_notify_object()), transformation attributes, tags,
+ * and tesselation preferences; repeated requests for unchanged objects
+ * are answered by copying the cached result, which is only worthwhile
+ * if the provide callback has to compute considerably more than a copy
+ * (e.g. tesselation).
+ *
  * \returns AY_OK on success, error code otherwise.
  */
 int
@@ -51,10 +123,40 @@ ay_provide_object(ay_object *o, unsigned int type, ay_object **result)
  char fname[] = "provide";
  ay_voidfp *arr = NULL;
  ay_providecb *cb = NULL;
+ ay_provide_centry *e;
+ int cache = AY_FALSE;
 
   if(!o)
     return AY_ENULL;
 
+  /* try the cache first */
+  if(result && o->version && ay_provide_cachelimit &&
+     type < ay_providecbt.size &&
+     o->type < ay_provide_cachetypeslen &&
+     ay_provide_cachetypes[o->type] == type)
+    {
+      /* the cache is shared by parallel notification callbacks */
+      ay_notify_lock();
+      if((e = ay_provide_findentry(o, type)))
+	{
+	  ay_provide_cachehits++;
+	  if(e->result)
+	    ay_status = ay_provide_copyresult(e->result, result);
+	  else
+	    *result = NULL;
+	  ay_notify_unlock();
+	  if(ay_status)
+	    {
+	      ay_error(ay_status, fname, NULL);
+	      return AY_ERROR;
+	    }
+	  return AY_OK;
+	}
+      ay_provide_cachemisses++;
+      ay_notify_unlock();
+      cache = AY_TRUE;
+    }
+
   /* call the provide callback */
   arr = ay_providecbt.arr;
   cb = (ay_providecb *)(arr[o->type]);
@@ -74,6 +176,13 @@ ay_provide_object(ay_object *o, unsigned int type, ay_object **result)
 	  ay_error(AY_ERROR, fname, "provide callback failed");
 	  return AY_ERROR;
 	}
+
+      if(cache)
+	{
+	  ay_notify_lock();
+	  (void)ay_provide_cacheresult(o, type, *result);
+	  ay_notify_unlock();
+	}
     }
   else
     {
@@ -198,3 +307,490 @@ ay_provide_nptoolobj(ay_object *o, unsigned int type,
 
  return ay_status;
 } /* ay_provide_nptoolobj */
+
+
+/* ay_provide_estsize:
+ *  estimate the memory consumption of the objects in list \a o
+ */
+size_t
+ay_provide_estsize(ay_object *o)
+{
+ size_t bytes = 0;
+ ay_nurbpatch_object *np;
+ ay_nurbcurve_object *nc;
+ ay_pomesh_object *pm;
+ unsigned int i, loops, verts;
+
+  while(o && o != ay_endlevel)
+    {
+      bytes += sizeof(ay_object);
+
+      switch(o->type)
+	{
+	case AY_IDNPATCH:
+	  np = (ay_nurbpatch_object *)o->refine;
+	  bytes += sizeof(ay_nurbpatch_object);
+	  bytes += (np->width*np->height*4 + np->width+np->uorder +
+		    np->height+np->vorder)*sizeof(double);
+	  break;
+	case AY_IDNCURVE:
+	  nc = (ay_nurbcurve_object *)o->refine;
+	  bytes += sizeof(ay_nurbcurve_object);
+	  bytes += (nc->length*4 + nc->length+nc->order)*sizeof(double);
+	  break;
+	case AY_IDPOMESH:
+	  pm = (ay_pomesh_object *)o->refine;
+	  loops = 0;
+	  verts = 0;
+	  bytes += sizeof(ay_pomesh_object);
+	  bytes += pm->ncontrols*(pm->has_normals?6:3)*sizeof(double);
+	  for(i = 0; i < pm->npolys; i++)
+	    loops += pm->nloops[i];
+	  for(i = 0; i < loops; i++)
+	    verts += pm->nverts[i];
+	  bytes += (pm->npolys+loops+verts)*sizeof(unsigned int);
+	  if(pm->face_normals)
+	    bytes += pm->npolys*3*sizeof(double);
+	  break;
+	default:
+	  break;
+	} /* switch */
+
+      if(o->down)
+	bytes += ay_provide_estsize(o->down);
+
+      o = o->next;
+    } /* while */
+
+ return bytes;
+} /* ay_provide_estsize */
+
+
+/* ay_provide_getkey:
+ *  get the parts of the cache key of object \a o that may change
+ *  without a notification (transformations, tags, and the tesselation
+ *  preferences used when providing PolyMeshes); the tags are hashed
+ *  by content, as a changed tag may be allocated at the address of
+ *  the tag it replaces
+ */
+void
+ay_provide_getkey(ay_object *o, double *key, unsigned long *tagsum)
+{
+ ay_tag *tag;
+ ay_btval *bv;
+ unsigned int h = 0;
+
+  key[0] = o->movx;
+  key[1] = o->movy;
+  key[2] = o->movz;
+  key[3] = o->rotx;
+  key[4] = o->roty;
+  key[5] = o->rotz;
+  key[6] = o->scalx;
+  key[7] = o->scaly;
+  key[8] = o->scalz;
+  memcpy(&(key[9]), o->quat, 4*sizeof(double));
+  key[13] = ay_prefs.smethod;
+  key[14] = ay_prefs.sparamu;
+  key[15] = ay_prefs.sparamv;
+
+  tag = o->tags;
+  while(tag)
+    {
+      if(tag->name)
+	h = ay_comp_hashdata(h, tag->name, strlen(tag->name));
+      h = ay_comp_hashdata(h, &(tag->type), sizeof(unsigned int));
+      h = ay_comp_hashdata(h, &(tag->is_binary), sizeof(char));
+      if(tag->val)
+	{
+	  if(!tag->is_binary)
+	    {
+	      h = ay_comp_hashdata(h, tag->val, strlen(tag->val));
+	    }
+	  else
+	    {
+	      bv = (ay_btval *)tag->val;
+	      if(bv->size)
+		h = ay_comp_hashdata(h, bv->payload, bv->size);
+	      else
+		h = ay_comp_hashdata(h, &(bv->payload), sizeof(void*));
+	    }
+	}
+      tag = tag->next;
+    } /* while */
+
+  *tagsum = h;
+
+ return;
+} /* ay_provide_getkey */
+
+
+/* ay_provide_unlinkentry:
+ *  remove cache entry \a e from the LRU list
+ */
+void
+ay_provide_unlinkentry(ay_provide_centry *e)
+{
+
+  if(e->lruprev)
+    e->lruprev->lrunext = e->lrunext;
+  else
+    ay_provide_lruhead = e->lrunext;
+
+  if(e->lrunext)
+    e->lrunext->lruprev = e->lruprev;
+  else
+    ay_provide_lrutail = e->lruprev;
+
+  e->lrunext = NULL;
+  e->lruprev = NULL;
+
+ return;
+} /* ay_provide_unlinkentry */
+
+
+/* ay_provide_freeentry:
+ *  remove cache entry \a e from the cache and free it
+ */
+void
+ay_provide_freeentry(ay_provide_centry *e)
+{
+ Tcl_HashEntry *entry;
+ ay_provide_centry **p;
+
+  ay_provide_unlinkentry(e);
+
+  entry = Tcl_FindHashEntry(&ay_provide_cacheht, (char*)e->o);
+  if(entry)
+    {
+      p = (ay_provide_centry **)&(Tcl_GetHashValue(entry));
+      while(*p)
+	{
+	  if(*p == e)
+	    {
+	      *p = e->next;
+	      break;
+	    }
+	  p = &((*p)->next);
+	}
+      if(!Tcl_GetHashValue(entry))
+	Tcl_DeleteHashEntry(entry);
+    }
+
+  if(e->result)
+    (void)ay_object_deletemulti(e->result, AY_FALSE);
+
+  ay_provide_cachebytes -= e->bytes;
+  ay_provide_cacheentries--;
+
+  free(e);
+
+ return;
+} /* ay_provide_freeentry */
+
+
+/* ay_provide_findentry:
+ *  find a valid cache entry for object \a o and type \a type,
+ *  removes outdated entries of \a o on the fly
+ */
+ay_provide_centry *
+ay_provide_findentry(ay_object *o, unsigned int type)
+{
+ Tcl_HashEntry *entry;
+ ay_provide_centry *e, *next;
+ double key[16];
+ unsigned long tagsum;
+
+  if(!(entry = Tcl_FindHashEntry(&ay_provide_cacheht, (char*)o)))
+    return NULL;
+
+  ay_provide_getkey(o, key, &tagsum);
+
+  e = (ay_provide_centry *)Tcl_GetHashValue(entry);
+  while(e)
+    {
+      next = e->next;
+      if(e->version != o->version)
+	{
+	  /* outdated */
+	  ay_provide_freeentry(e);
+	}
+      else
+	{
+	  if(e->type == type && e->tagsum == tagsum &&
+	     !memcmp(e->key, key, 16*sizeof(double)))
+	    {
+	      /* move to front of LRU list */
+	      if(e != ay_provide_lruhead)
+		{
+		  ay_provide_unlinkentry(e);
+		  e->lrunext = ay_provide_lruhead;
+		  if(ay_provide_lruhead)
+		    ay_provide_lruhead->lruprev = e;
+		  ay_provide_lruhead = e;
+		  if(!ay_provide_lrutail)
+		    ay_provide_lrutail = e;
+		}
+	      return e;
+	    }
+	}
+      e = next;
+    } /* while */
+
+ return NULL;
+} /* ay_provide_findentry */
+
+
+/* ay_provide_cacheresult:
+ *  store a copy of \a result (provided by \a o for \a type) in the cache
+ */
+int
+ay_provide_cacheresult(ay_object *o, unsigned int type, ay_object *result)
+{
+ int ay_status = AY_OK;
+ Tcl_HashEntry *entry;
+ ay_provide_centry *e = NULL;
+ int new_item = 0;
+
+  if(!(e = calloc(1, sizeof(ay_provide_centry))))
+    return AY_EOMEM;
+
+  if(result)
+    {
+      ay_status = ay_provide_copyresult(result, &(e->result));
+      if(ay_status)
+	{
+	  free(e);
+	  return ay_status;
+	}
+    }
+
+  e->o = o;
+  e->type = type;
+  e->version = o->version;
+  ay_provide_getkey(o, e->key, &(e->tagsum));
+  e->bytes = sizeof(ay_provide_centry) + ay_provide_estsize(e->result);
+
+  entry = Tcl_CreateHashEntry(&ay_provide_cacheht, (char*)o, &new_item);
+  if(!new_item)
+    e->next = (ay_provide_centry *)Tcl_GetHashValue(entry);
+  Tcl_SetHashValue(entry, (char*)e);
+
+  e->lrunext = ay_provide_lruhead;
+  if(ay_provide_lruhead)
+    ay_provide_lruhead->lruprev = e;
+  ay_provide_lruhead = e;
+  if(!ay_provide_lrutail)
+    ay_provide_lrutail = e;
+
+  ay_provide_cachebytes += e->bytes;
+  ay_provide_cacheentries++;
+
+  /* evict least recently used entries */
+  while(ay_provide_cachebytes > ay_provide_cachelimit &&
+	ay_provide_lrutail && ay_provide_lrutail != e)
+    {
+      ay_provide_freeentry(ay_provide_lrutail);
+    }
+
+ return AY_OK;
+} /* ay_provide_cacheresult */
+
+
+/* ay_provide_copyresult:
+ *  copy the list of objects \a src to \a result
+ */
+int
+ay_provide_copyresult(ay_object *src, ay_object **result)
+{
+ int ay_status = AY_OK;
+ ay_object *new = NULL, **t = &new;
+
+  while(src)
+    {
+      ay_status = ay_object_copy(src, t);
+      if(ay_status)
+	{
+	  (void)ay_object_deletemulti(new, AY_FALSE);
+	  return ay_status;
+	}
+      t = &((*t)->next);
+      src = src->next;
+    }
+
+  *result = new;
+
+ return AY_OK;
+} /* ay_provide_copyresult */
+
+
+/** ay_provide_uncache:
+ * remove all cached provide results of an object
+ *
+ * \param[in] o object to process (if NULL, the cache is cleared)
+ */
+void
+ay_provide_uncache(ay_object *o)
+{
+ Tcl_HashEntry *entry;
+ ay_provide_centry *e, *next;
+
+  if(!ay_provide_cachetypes)
+    return;
+
+  if(!o)
+    {
+      while(ay_provide_lrutail)
+	ay_provide_freeentry(ay_provide_lrutail);
+      return;
+    }
+
+  ay_notify_lock();
+
+  if((entry = Tcl_FindHashEntry(&ay_provide_cacheht, (char*)o)))
+    {
+      e = (ay_provide_centry *)Tcl_GetHashValue(entry);
+      while(e)
+	{
+	  next = e->next;
+	  ay_provide_freeentry(e);
+	  e = next;
+	}
+    }
+
+  ay_notify_unlock();
+
+ return;
+} /* ay_provide_uncache */
+
+
+/** ay_provide_registercache:
+ * allow caching of objects of type \a target provided by objects of
+ * type \a type_id; this is only safe if the provided objects depend
+ * solely on data that is updated in the notification callback, the
+ * transformation attributes, the tags of the object, and the
+ * tesselation preferences; since a cache hit still delivers a copy,
+ * this only pays off if providing computes more than a copy
+ * (only one target type per object type may be cached)
+ *
+ * \param[in] type_id object type (AY_ID...)
+ * \param[in] target provided object type (AY_ID...)
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_provide_registercache(unsigned int type_id, unsigned int target)
+{
+ unsigned int *t;
+
+  if(type_id >= ay_provide_cachetypeslen)
+    {
+      if(!(t = realloc(ay_provide_cachetypes,
+		       (type_id+1)*sizeof(unsigned int))))
+	return AY_EOMEM;
+      memset(&(t[ay_provide_cachetypeslen]), 0,
+	     (type_id+1-ay_provide_cachetypeslen)*sizeof(unsigned int));
+      ay_provide_cachetypes = t;
+      ay_provide_cachetypeslen = type_id+1;
+    }
+
+  ay_provide_cachetypes[type_id] = target;
+
+ return AY_OK;
+} /* ay_provide_registercache */
+
+
+/** ay_provide_cachetcmd:
+ *  Manage the provide cache.
+ *  Implements the \a provCache scripting interface command.
+ *  \returns TCL_OK in any case.
+ */
+int
+ay_provide_cachetcmd(ClientData clientData, Tcl_Interp *interp,
+		     int argc, char *argv[])
+{
+ int tcl_status = TCL_OK;
+ double limit = 0.0;
+ Tcl_Obj *res;
+
+  if(argc > 1 && argv[1][0] == '-')
+    {
+      switch(argv[1][1])
+	{
+	case 'c':
+	  /* -clear */
+	  ay_provide_uncache(NULL);
+	  ay_provide_cachehits = 0;
+	  ay_provide_cachemisses = 0;
+	  return TCL_OK;
+	case 'l':
+	  /* -limit */
+	  if(argc < 3)
+	    break;
+	  tcl_status = Tcl_GetDouble(interp, argv[2], &limit);
+	  AY_CHTCLERRRET(tcl_status, argv[0], interp);
+	  if(limit < 0.0)
+	    limit = 0.0;
+	  ay_provide_cachelimit = (size_t)(limit*1024*1024);
+	  while(ay_provide_cachebytes > ay_provide_cachelimit &&
+		ay_provide_lrutail)
+	    ay_provide_freeentry(ay_provide_lrutail);
+	  return TCL_OK;
+	case 's':
+	  /* -stats */
+	  res = Tcl_NewListObj(0, NULL);
+	  Tcl_ListObjAppendElement(interp, res, Tcl_NewStringObj("hits", -1));
+	  Tcl_ListObjAppendElement(interp, res,
+			 Tcl_NewWideIntObj((Tcl_WideInt)ay_provide_cachehits));
+	  Tcl_ListObjAppendElement(interp, res,
+				   Tcl_NewStringObj("misses", -1));
+	  Tcl_ListObjAppendElement(interp, res,
+		       Tcl_NewWideIntObj((Tcl_WideInt)ay_provide_cachemisses));
+	  Tcl_ListObjAppendElement(interp, res,
+				   Tcl_NewStringObj("entries", -1));
+	  Tcl_ListObjAppendElement(interp, res,
+		       Tcl_NewWideIntObj((Tcl_WideInt)ay_provide_cacheentries));
+	  Tcl_ListObjAppendElement(interp, res, Tcl_NewStringObj("bytes", -1));
+	  Tcl_ListObjAppendElement(interp, res,
+			Tcl_NewWideIntObj((Tcl_WideInt)ay_provide_cachebytes));
+	  Tcl_ListObjAppendElement(interp, res, Tcl_NewStringObj("limit", -1));
+	  Tcl_ListObjAppendElement(interp, res,
+			Tcl_NewWideIntObj((Tcl_WideInt)ay_provide_cachelimit));
+	  Tcl_SetObjResult(interp, res);
+	  return TCL_OK;
+	default:
+	  break;
+	} /* switch */
+    } /* if */
+
+  ay_error(AY_EARGS, argv[0], "-stats|-clear|-limit megabytes");
+
+ return TCL_OK;
+} /* ay_provide_cachetcmd */
+
+
+/** ay_provide_init:
+ *  initialize provide module by registering the object types
+ *  whose provided objects may be cached
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_provide_init()
+{
+ int ay_status = AY_OK;
+
+  Tcl_InitHashTable(&ay_provide_cacheht, TCL_ONE_WORD_KEYS);
+
+  /* tesselation of NURBS patches (e.g. for getGeom tess, export,
+     or Instances of NURBS patches) */
+  ay_status = ay_provide_registercache(AY_IDNPATCH, AY_IDPOMESH);
+
+  /* tool objects (Sweep, Revolve, Skin, Gordon, Clone etc.) are not
+     registered, as they already keep their NURBS patches from the last
+     notification and provide (or convert to) mere copies of them; since
+     callers own the provided objects, a cache hit also delivers a copy
+     and a miss additionally pays for the copy stored in the cache */
+
+ return ay_status;
+} /* ay_provide_init */
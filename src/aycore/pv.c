@@ -14,6 +14,481 @@
 
 /* pv.c - PV (PrimitiveVariable) tag helpers */
 
+/*
+ * PV tags may be stored in two forms: as string (e.g.
+ * "mycolor,varying,c,2,1,0,0,0,1,0"), which is what the Tcl UI and
+ * the scene files see, or as binary tag, where the payload of the
+ * ay_btval is an ay_pv_bin header followed by the name, the detail,
+ * and the data as array of doubles.
+ * PV tags created by ay_pv_add() are binary; string PV tags (e.g.
+ * from scene files or from the Tcl UI) are converted to the binary
+ * form once, on first access of their data (see ay_pv_tobinary()).
+ * Only PV tags of numeric data types have a binary form.
+ */
+
+/* local types: */
+
+/** header of the payload of a binary PV tag */
+typedef struct ay_pv_bin_s
+{
+  unsigned int num; /**< number of data elements */
+  unsigned int dim; /**< number of doubles per data element */
+  size_t detailofs; /**< offset of the detail string from the header */
+  size_t dataofs; /**< offset of the data from the header */
+  char type; /**< data type (f, g, c, p, n, v, d) */
+} ay_pv_bin;
+
+/* local preprocessor definitions: */
+
+/* access the name, detail, and data of a binary PV tag payload */
+#define AY_PVNAME(pv) ((char*)((pv)+1))
+#define AY_PVDETAIL(pv) (((char*)(pv))+(pv)->detailofs)
+#define AY_PVDATA(pv) ((double*)(void*)(((char*)(pv))+(pv)->dataofs))
+
+/* prototypes of functions local to this module: */
+
+unsigned int ay_pv_getdim(char type);
+
+int ay_pv_newbin(const char *name, size_t namelen,
+		 const char *detail, size_t detaillen,
+		 char type, unsigned int num, ay_btval **result);
+
+int ay_pv_getndt(ay_tag *t, const char **name, size_t *namelen,
+		 const char **detail, size_t *detaillen, char *type);
+
+int ay_pv_filltokparbin(ay_tag *tag, int declare, int *start,
+			int *added, RtToken tokens[], RtPointer parms[]);
+
+
+/* functions: */
+
+/* ay_pv_getdim:
+ *  return the number of values per data element of PV data type <type>,
+ *  0 for non-numeric or unknown data types
+ */
+unsigned int
+ay_pv_getdim(char type)
+{
+
+  switch(type)
+    {
+    case 'f':
+      return 1;
+    case 'g':
+      return 2;
+    case 'c':
+    case 'p':
+    case 'n':
+    case 'v':
+      return 3;
+    case 'd':
+      return 4;
+    default:
+      break;
+    } /* switch */
+
+ return 0;
+} /* ay_pv_getdim */
+
+
+/* ay_pv_newbin:
+ *  allocate a binary PV tag value for <num> data elements of
+ *  type <type> and copy the name and detail (of given lengths) into it;
+ *  the data is left uninitialized
+ */
+int
+ay_pv_newbin(const char *name, size_t namelen,
+	     const char *detail, size_t detaillen,
+	     char type, unsigned int num, ay_btval **result)
+{
+ ay_btval *btval;
+ ay_pv_bin *pv;
+ size_t ofs;
+ unsigned int dim;
+
+  if(!name || !detail || !result)
+    return AY_ENULL;
+
+  if(!(dim = ay_pv_getdim(type)))
+    return AY_ERROR;
+
+  /* the data is aligned to doubles */
+  ofs = sizeof(ay_pv_bin)+namelen+detaillen+2;
+  ofs = ((ofs+sizeof(double)-1)/sizeof(double))*sizeof(double);
+
+  if(!(btval = malloc(sizeof(ay_btval))))
+    return AY_EOMEM;
+
+  btval->size = ofs+((size_t)num)*dim*sizeof(double);
+
+  if(!(btval->payload = malloc(btval->size)))
+    {
+      free(btval);
+      return AY_EOMEM;
+    }
+
+  /* clear the header (and padding), so that memcmp() may be used
+     to compare binary PV tags */
+  memset(btval->payload, 0, ofs);
+
+  pv = (ay_pv_bin*)btval->payload;
+  pv->num = num;
+  pv->dim = dim;
+  pv->type = type;
+  pv->detailofs = sizeof(ay_pv_bin)+namelen+1;
+  pv->dataofs = ofs;
+  memcpy(AY_PVNAME(pv), name, namelen);
+  memcpy(AY_PVDETAIL(pv), detail, detaillen);
+
+  *result = btval;
+
+ return AY_OK;
+} /* ay_pv_newbin */
+
+
+/* ay_pv_getndt:
+ *  get name, detail, and data type of PV tag <t>, regardless of its form;
+ *  <name> and <detail> are not necessarily zero terminated, their
+ *  lengths are returned in <namelen> and <detaillen>
+ */
+int
+ay_pv_getndt(ay_tag *t, const char **name, size_t *namelen,
+	     const char **detail, size_t *detaillen, char *type)
+{
+ ay_pv_bin *pv;
+ const char *c1, *c2;
+
+  if(!t || !t->val || (t->type != ay_pv_tagtype))
+    return AY_ERROR;
+
+  if(t->is_binary)
+    {
+      pv = (ay_pv_bin*)((ay_btval*)t->val)->payload;
+      *name = AY_PVNAME(pv);
+      *namelen = strlen(*name);
+      *detail = AY_PVDETAIL(pv);
+      *detaillen = strlen(*detail);
+      *type = pv->type;
+      return AY_OK;
+    }
+
+  c1 = strchr(t->val, ',');
+  if(!c1)
+    return AY_ERROR;
+  c2 = strchr(c1+1, ',');
+  if(!c2)
+    return AY_ERROR;
+
+  *name = t->val;
+  *namelen = c1-((char*)t->val);
+  *detail = c1+1;
+  *detaillen = c2-(c1+1);
+  *type = c2[1];
+
+ return AY_OK;
+} /* ay_pv_getndt */
+
+
+/** ay_pv_tobinary:
+ *  convert a string PV tag to the binary form (in place);
+ *  tags that are already binary are left alone
+ *
+ * \param[in,out] tag  PV tag to convert
+ *
+ * \returns AY_OK if the tag is binary now, error code otherwise
+ *  (e.g. for PV tags with string data, which stay strings)
+ */
+int
+ay_pv_tobinary(ay_tag *tag)
+{
+ int ay_status = AY_OK;
+ const char *name, *detail;
+ char type, *c, *end;
+ size_t namelen, detaillen;
+ unsigned int count = 0, dim, i = 0, n;
+ ay_btval *btval = NULL;
+ ay_pv_bin *pv;
+ double *data;
+
+  if(!tag)
+    return AY_ENULL;
+
+  if(tag->is_binary && tag->type == ay_pv_tagtype)
+    return AY_OK;
+
+  if(ay_pv_getndt(tag, &name, &namelen, &detail, &detaillen, &type))
+    return AY_ERROR;
+
+  if(!(dim = ay_pv_getdim(type)))
+    return AY_ERROR;
+
+  /* find the number of elements */
+  c = strchr(detail+detaillen+1, ',');
+  if(!c)
+    return AY_ERROR;
+  c++;
+  if(sscanf(c, "%u", &count) != 1)
+    return AY_ERROR;
+
+  /* find the data */
+  c = strchr(c, ',');
+
+  /* do not trust the number of elements more than the data actually
+     present (each value needs at least two characters) */
+  n = c?(unsigned int)(strlen(c)/2):0;
+  if(count*dim > n)
+    count = n/dim;
+
+  ay_status = ay_pv_newbin(name, namelen, detail, detaillen, type, count,
+			   &btval);
+  if(ay_status)
+    return ay_status;
+
+  pv = (ay_pv_bin*)btval->payload;
+  data = AY_PVDATA(pv);
+
+  /* parse the data */
+  n = count*dim;
+  while(c && (i < n))
+    {
+      c++;
+      data[i] = strtod(c, &end);
+      if(end == c)
+	break;
+      i++;
+      c = strchr(end, ',');
+    }
+
+  /* only complete data elements count */
+  pv->num = i/dim;
+
+  free(tag->val);
+  tag->val = btval;
+  tag->is_binary = AY_TRUE;
+
+ return AY_OK;
+} /* ay_pv_tobinary */
+
+
+/** ay_pv_tostring:
+ *  get the string form of a PV tag
+ *
+ * \param[in] tag  PV tag to process (binary or string)
+ * \param[in,out] result  where to store the string (allocated here)
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_pv_tostring(ay_tag *tag, char **result)
+{
+ ay_pv_bin *pv;
+ double *data;
+ unsigned int i, n;
+ int len;
+ char tmp[64];
+ Tcl_DString ds;
+
+  if(!tag || !tag->val || !result)
+    return AY_ENULL;
+
+  if(!tag->is_binary)
+    {
+      if(!(*result = malloc((strlen(tag->val)+1)*sizeof(char))))
+	return AY_EOMEM;
+      strcpy(*result, tag->val);
+      return AY_OK;
+    }
+
+  if(tag->type != ay_pv_tagtype)
+    return AY_ERROR;
+
+  pv = (ay_pv_bin*)((ay_btval*)tag->val)->payload;
+  data = AY_PVDATA(pv);
+
+  Tcl_DStringInit(&ds);
+  Tcl_DStringAppend(&ds, AY_PVNAME(pv), -1);
+  Tcl_DStringAppend(&ds, ",", 1);
+  Tcl_DStringAppend(&ds, AY_PVDETAIL(pv), -1);
+  len = sprintf(tmp, ",%c,%u", pv->type, pv->num);
+  Tcl_DStringAppend(&ds, tmp, len);
+
+  n = pv->num*pv->dim;
+  for(i = 0; i < n; i++)
+    {
+      len = sprintf(tmp, ",%g", data[i]);
+      Tcl_DStringAppend(&ds, tmp, len);
+    }
+
+  if(!(*result = malloc((Tcl_DStringLength(&ds)+1)*sizeof(char))))
+    {
+      Tcl_DStringFree(&ds);
+      return AY_EOMEM;
+    }
+  strcpy(*result, Tcl_DStringValue(&ds));
+
+  Tcl_DStringFree(&ds);
+
+ return AY_OK;
+} /* ay_pv_tostring */
+
+
+/** ay_pv_totext:
+ *  convert a binary PV tag to the string form (in place)
+ *
+ * \param[in,out] tag  PV tag to convert
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_pv_totext(ay_tag *tag)
+{
+ int ay_status = AY_OK;
+ char *val = NULL;
+
+  if(!tag)
+    return AY_ENULL;
+
+  if(!tag->is_binary)
+    return AY_OK;
+
+  ay_status = ay_pv_tostring(tag, &val);
+  if(ay_status)
+    return ay_status;
+
+  free(((ay_btval*)tag->val)->payload);
+  free(tag->val);
+  tag->val = val;
+  tag->is_binary = AY_FALSE;
+
+ return AY_OK;
+} /* ay_pv_totext */
+
+
+/* ay_pv_filltokparbin:
+ *  fill the tokens/parms arrays from the binary PV tag <tag>,
+ *  helper for ay_pv_filltokpar() below
+ */
+int
+ay_pv_filltokparbin(ay_tag *tag, int declare, int *start,
+		    int *added, RtToken tokens[], RtPointer parms[])
+{
+ ay_pv_bin *pv;
+ double *data;
+ RtFloat *ftemp = NULL, *otemp = NULL;
+ unsigned int i, n;
+ char *pvname;
+ Tcl_DString ds;
+
+  pv = (ay_pv_bin*)((ay_btval*)tag->val)->payload;
+
+  if(!pv->num)
+    return AY_OK;
+
+  pvname = AY_PVNAME(pv);
+  data = AY_PVDATA(pv);
+
+  if(!(tokens[*start] = malloc((strlen(pvname)+1)*sizeof(char))))
+    return AY_EOMEM;
+  strcpy(tokens[*start], pvname);
+
+  if(pv->type == 'd')
+    {
+      /* color+opacity, expand to RenderMan color and opacity */
+      if(!(ftemp = malloc(pv->num*3*sizeof(RtFloat))))
+	goto failed;
+      if(!(otemp = malloc(pv->num*3*sizeof(RtFloat))))
+	goto failed;
+      for(i = 0; i < pv->num; i++)
+	{
+	  ftemp[i*3]   = (RtFloat)data[i*4];
+	  ftemp[i*3+1] = (RtFloat)data[i*4+1];
+	  ftemp[i*3+2] = (RtFloat)data[i*4+2];
+	  otemp[i*3]   = (RtFloat)data[i*4+3];
+	  otemp[i*3+1] = otemp[i*3];
+	  otemp[i*3+2] = otemp[i*3];
+	}
+    }
+  else
+    {
+      n = pv->num*pv->dim;
+      if(!(ftemp = malloc(n*sizeof(RtFloat))))
+	goto failed;
+      for(i = 0; i < n; i++)
+	ftemp[i] = (RtFloat)data[i];
+    }
+
+  if(declare)
+    {
+      Tcl_DStringInit(&ds);
+      Tcl_DStringAppend(&ds, AY_PVDETAIL(pv), -1);
+      switch(pv->type)
+	{
+	case 'f':
+	  Tcl_DStringAppend(&ds, " float", -1);
+	  break;
+	case 'g':
+	  Tcl_DStringAppend(&ds, " float[2]", -1);
+	  break;
+	case 'n':
+	  Tcl_DStringAppend(&ds, " normal", -1);
+	  break;
+	case 'p':
+	  Tcl_DStringAppend(&ds, " point", -1);
+	  break;
+	case 'v':
+	  Tcl_DStringAppend(&ds, " vector", -1);
+	  break;
+	default:
+	  Tcl_DStringAppend(&ds, " color", -1);
+	  break;
+	} /* switch */
+      RiDeclare(pvname, Tcl_DStringValue(&ds));
+      Tcl_DStringFree(&ds);
+    }
+
+  parms[*start] = (RtPointer)ftemp;
+  (*start)++;
+  (*added)++;
+
+  if(otemp)
+    {
+      /* sneak in the opacity */
+      if(!(tokens[*start] = malloc((strlen(ay_prefs.opacityname)+1)*
+				   sizeof(char))))
+	{
+	  free(otemp);
+	  return AY_EOMEM;
+	}
+      strcpy(tokens[*start], ay_prefs.opacityname);
+
+      if(declare)
+	{
+	  Tcl_DStringInit(&ds);
+	  Tcl_DStringAppend(&ds, AY_PVDETAIL(pv), -1);
+	  Tcl_DStringAppend(&ds, " color", -1);
+	  RiDeclare(ay_prefs.opacityname, Tcl_DStringValue(&ds));
+	  Tcl_DStringFree(&ds);
+	}
+
+      parms[*start] = (RtPointer)otemp;
+      (*start)++;
+      (*added)++;
+    }
+
+ return AY_OK;
+
+failed:
+
+  free(tokens[*start]);
+  tokens[*start] = NULL;
+
+  if(ftemp)
+    free(ftemp);
+
+ return AY_EOMEM;
+} /* ay_pv_filltokparbin */
+
+
 /* ay_pv_filltokpar:
  *  parse all PV tags of object <o> into tokens/parms arrays
  *  ready for a call into the RenderMan Interface
@@ -48,6 +523,18 @@ ay_pv_filltokpar(ay_object *o, int declare, int start,
     {
       if(tag->type == ay_pv_tagtype)
 	{
+	  (void)ay_pv_tobinary(tag);
+	  if(tag->is_binary)
+	    {
+	      ay_status = ay_pv_filltokparbin(tag, declare, &start, added,
+					      tokens, parms);
+	      if(ay_status)
+		goto cleanup;
+	      tag = tag->next;
+	      continue;
+	    }
+
+	  /* PV tags with string data */
 	  if(tagvaltmp)
 	    {
 	      free(tagvaltmp);
@@ -302,7 +789,7 @@ ay_pv_filltokpar(ay_object *o, int declare, int start,
 				      ay_prefs.opacityname)+1, sizeof(char))))
 				{ ay_status = AY_EOMEM; goto cleanup; }
 
-			      strcpy(tokens[start], pvname);
+			      strcpy(tokens[start], ay_prefs.opacityname);
 			      parms[start] = (RtPointer)otemp;
 			      otemp = NULL;
 			      break;
@@ -353,7 +840,7 @@ cleanup:
 
 
 /**ay_pv_add:
- *  add a new PV tag to object \a o
+ *  add a new (binary) PV tag to object \a o
  *
  * \param[in,out] o  object to tadd the new PV tag to
  * \param[in] name  name of PV data (e.g. "myst")
@@ -370,14 +857,18 @@ ay_pv_add(ay_object *o,
 	  const char *name, const char *detail, const char *type,
 	  int datalen, int stride, void *data)
 {
+ int ay_status = AY_OK;
  ay_tag *tag = NULL, **nexttag;
- Tcl_DString ds;
- int i, len;
- char tmp[255];
+ ay_btval *btval = NULL;
+ double *pvdata;
+ int i, j, dim;
 
   if(!o || !name || !detail || !type || !data)
     return AY_ENULL;
 
+  if(datalen < 0)
+    return AY_ERROR;
+
   nexttag = &(o->tags);
   tag = o->tags;
   while(tag)
@@ -386,80 +877,64 @@ ay_pv_add(ay_object *o,
       tag = tag->next;
     }
 
+  ay_status = ay_pv_newbin(name, strlen(name), detail, strlen(detail),
+			   type[0], (unsigned int)datalen, &btval);
+  if(ay_status)
+    return ay_status;
+
   if(!(tag = calloc(1, sizeof(ay_tag))))
-    return AY_EOMEM;
+    { ay_status = AY_EOMEM; goto cleanup; }
 
   tag->type = ay_pv_tagtype;
+  tag->is_binary = AY_TRUE;
 
   if(!(tag->name = calloc(3, sizeof(char))))
-    { free(tag); return AY_EOMEM; }
+    { ay_status = AY_EOMEM; goto cleanup; }
   strcpy(tag->name, "PV");
 
-  Tcl_DStringInit(&ds);
-  Tcl_DStringAppend(&ds, name, -1);
-  Tcl_DStringAppend(&ds, ",", 1);
-  Tcl_DStringAppend(&ds, detail, -1);
-  Tcl_DStringAppend(&ds, ",", 1);
-  Tcl_DStringAppend(&ds, type, 1);
-
-  sprintf(tmp, ",%d", datalen);
-  Tcl_DStringAppend(&ds, tmp, -1);
+  pvdata = AY_PVDATA((ay_pv_bin*)btval->payload);
+  dim = (int)ay_pv_getdim(type[0]);
 
   switch(type[0])
     {
     case 'f':
-      /* float */
-      for(i = 0; i < datalen*stride; i += stride)
-	{
-	  len = sprintf(tmp, ",%f", ((float*)data)[i]);
-	  Tcl_DStringAppend(&ds, tmp, len);
-	}
-      break;
     case 'g':
-      /* float[2] */
-      for(i = 0; i < datalen*stride; i += stride)
-	{
-	  len = sprintf(tmp, ",%f,%f", ((float*)data)[i], ((float*)data)[i+1]);
-	  Tcl_DStringAppend(&ds, tmp, len);
-	}
-      break;
-    case 'p':
-    case 'v':
-    case 'n':
-    case 'c':
-      /* point/vector/normal/color */
-      for(i = 0; i < datalen*stride; i += stride)
-	{
-	  len = sprintf(tmp, ",%f,%f,%f", (float)(((double*)data)[i]),
-		  (float)(((double*)data)[i+1]),
-		  (float)(((double*)data)[i+2]));
-	  Tcl_DStringAppend(&ds, tmp, len);
-	}
-      break;
     case 'd':
-      /* color+opacity */
-      for(i = 0; i < datalen*stride; i += stride)
-	{
-	  len = sprintf(tmp, ",%f,%f,%f,%f", ((float*)data)[i],
-		  ((float*)data)[i+1],
-		  ((float*)data)[i+2],
-		  ((float*)data)[i+3]);
-	  Tcl_DStringAppend(&ds, tmp, len);
-	}
+      /* float/float[2]/color+opacity */
+      for(i = 0; i < datalen; i++)
+	for(j = 0; j < dim; j++)
+	  *pvdata++ = (double)(((float*)data)[i*stride+j]);
       break;
     default:
+      /* point/vector/normal/color */
+      for(i = 0; i < datalen; i++)
+	for(j = 0; j < dim; j++)
+	  *pvdata++ = ((double*)data)[i*stride+j];
       break;
     } /* switch */
 
-  if(!(tag->val = malloc((Tcl_DStringLength(&ds)+1)*sizeof(char))))
-    { free(tag->name); free(tag); return AY_EOMEM; }
-  strcpy(tag->val, Tcl_DStringValue(&ds));
-
-  Tcl_DStringFree(&ds);
+  tag->val = btval;
+  btval = NULL;
 
   *nexttag = tag;
+  tag = NULL;
 
- return AY_OK;
+cleanup:
+
+  if(tag)
+    {
+      if(tag->name)
+	free(tag->name);
+      free(tag);
+    }
+
+  if(btval)
+    {
+      free(btval->payload);
+      free(btval);
+    }
+
+ return ay_status;
 } /* ay_pv_add */
 
 
@@ -475,11 +950,16 @@ ay_pv_merge(ay_tag *t1, ay_tag *t2, ay_tag **mt)
  int i = 0;
  unsigned int n1, n2;
  ay_tag *nt = NULL;
+ ay_btval *btval;
+ ay_pv_bin *pv1, *pv2;
+ double *data;
  Tcl_DString ds;
 
   if(!t1 || !t2)
     return AY_ENULL;
 
+  Tcl_DStringInit(&ds);
+
   if(!(nt = calloc(1, sizeof(ay_tag))))
     { ay_status = AY_EOMEM; goto cleanup; }
 
@@ -490,7 +970,39 @@ ay_pv_merge(ay_tag *t1, ay_tag *t2, ay_tag **mt)
 
   nt->type = ay_pv_tagtype;
 
-  Tcl_DStringInit(&ds);
+  if(!ay_pv_tobinary(t1) && !ay_pv_tobinary(t2))
+    {
+      /* merge binary tags */
+      pv1 = (ay_pv_bin*)((ay_btval*)t1->val)->payload;
+      pv2 = (ay_pv_bin*)((ay_btval*)t2->val)->payload;
+
+      if(pv1->dim != pv2->dim)
+	{ ay_status = AY_ERROR; goto cleanup; }
+
+      ay_status = ay_pv_newbin(AY_PVNAME(pv1), strlen(AY_PVNAME(pv1)),
+			       AY_PVDETAIL(pv1), strlen(AY_PVDETAIL(pv1)),
+			       pv1->type, pv1->num+pv2->num, &btval);
+      if(ay_status)
+	goto cleanup;
+
+      data = AY_PVDATA((ay_pv_bin*)btval->payload);
+      memcpy(data, AY_PVDATA(pv1), pv1->num*pv1->dim*sizeof(double));
+      memcpy(&(data[pv1->num*pv1->dim]), AY_PVDATA(pv2),
+	     pv2->num*pv2->dim*sizeof(double));
+
+      nt->val = btval;
+      nt->is_binary = AY_TRUE;
+
+      /* return result */
+      *mt = nt;
+      nt = NULL;
+      goto cleanup;
+    }
+
+  /* merge string tags */
+  if((t1->is_binary && ay_pv_totext(t1)) ||
+     (t2->is_binary && ay_pv_totext(t2)))
+    { ay_status = AY_ERROR; goto cleanup; }
 
   /* find the third comma in t1->val */
   comma1 = t1->val;
@@ -558,7 +1070,8 @@ cleanup:
  *  merge two PV tags (<t1>, <t2>) into one
  *  the elements in <t2> will be appended to the elements in <t1>
  *
- *  The value array of t1 must be large enough to hold all data already!
+ *  If t1 is a string PV tag, its value array must be large enough
+ *  to hold all data already!
  *
  */
 int
@@ -569,10 +1082,38 @@ ay_pv_mergeinto(ay_tag *t1, ay_tag *t2)
  char *dst;
  int i = 0, buflen;
  unsigned int n1, n2;
+ ay_btval *bt1;
+ ay_pv_bin *pv1, *pv2;
 
   if(!t1 || !t2)
     return AY_ENULL;
 
+  if(t1->is_binary && !ay_pv_tobinary(t2))
+    {
+      /* append binary t2 data to binary t1 data */
+      bt1 = (ay_btval*)t1->val;
+      pv1 = (ay_pv_bin*)bt1->payload;
+      pv2 = (ay_pv_bin*)((ay_btval*)t2->val)->payload;
+
+      if(pv1->dim != pv2->dim)
+	return AY_ERROR;
+
+      if(!(pv1 = realloc(bt1->payload, bt1->size+
+			 pv2->num*pv2->dim*sizeof(double))))
+	return AY_EOMEM;
+      bt1->payload = pv1;
+
+      memcpy(&(AY_PVDATA(pv1)[pv1->num*pv1->dim]), AY_PVDATA(pv2),
+	     pv2->num*pv2->dim*sizeof(double));
+      bt1->size += pv2->num*pv2->dim*sizeof(double);
+      pv1->num += pv2->num;
+
+      return AY_OK;
+    }
+
+  if(t1->is_binary || t2->is_binary)
+    return AY_ERROR;
+
   /* find the third comma in t1->val */
   comma1 = t1->val;
   while((i < 3) && (comma1 = strchr(comma1, ',')))
@@ -645,35 +1186,20 @@ cleanup:
 int
 ay_pv_cmpndt(ay_tag *t1, ay_tag *t2)
 {
- char *c1 = NULL, *c2 = NULL;
- int i;
+ const char *n1, *n2, *d1, *d2;
+ size_t nl1, nl2, dl1, dl2;
+ char ty1, ty2;
 
   if(!t1 || !t2)
     return AY_FALSE;
 
-  if((t1->type != ay_pv_tagtype) || (t2->type != ay_pv_tagtype))
+  if(ay_pv_getndt(t1, &n1, &nl1, &d1, &dl1, &ty1) ||
+     ay_pv_getndt(t2, &n2, &nl2, &d2, &dl2, &ty2))
     return AY_FALSE;
 
-  c1 = t1->val;
-  c2 = t2->val;
-
-  if(!c1 || !c2)
-    return AY_FALSE;
-
-  /* get the third comma in t1->val */
-  for(i = 0; i < 3; i++)
-    {
-      c1 = strchr(c1, ',');
-
-      if(!c1)
-	return AY_FALSE;
-
-      c1++;
-    }
-
-  /* now compare the strings up to the third comma in t1->val,
-     i.e. compare their names, details, and types */
-  if(!strncmp((char*)t1->val, (char*)t2->val, (c1 - (char*)t1->val)))
+  /* compare their names, details, and types */
+  if((nl1 == nl2) && (dl1 == dl2) && (ty1 == ty2) &&
+     !memcmp(n1, n2, nl1) && !memcmp(d1, d2, dl1))
     {
       return AY_TRUE;
     }
@@ -691,36 +1217,21 @@ int
 ay_pv_checkndt(ay_tag *t, const char *name, const char *detail,
 	       const char *type)
 {
- char *c = NULL;
+ const char *n, *d;
+ size_t nl, dl;
+ char ty;
 
   if(!t)
     return AY_FALSE;
 
-  if((t->type != ay_pv_tagtype))
-    return AY_FALSE;
-
-  c = t->val;
-
-  if(!c)
+  if(ay_pv_getndt(t, &n, &nl, &d, &dl, &ty))
     return AY_FALSE;
 
-  if(!strncmp(c, name, strlen(name)))
+  if((nl >= strlen(name)) && !strncmp(n, name, strlen(name)))
     {
-      c = strchr(c, ',');
-      if(!c)
-	return AY_FALSE;
-
-      c++;
-
-      if(!strncmp(c, detail, strlen(detail)))
+      if((dl >= strlen(detail)) && !strncmp(d, detail, strlen(detail)))
 	{
-	  c = strchr(c, ',');
-	  if(!c)
-	    return AY_FALSE;
-
-	  c++;
-
-	  if(!strncmp(c, type, strlen(type)))
+	  if((type[0] == '\0') || ((type[0] == ty) && (type[1] == '\0')))
 	    return AY_TRUE;
 	} /* if */
     } /* if */
@@ -740,19 +1251,17 @@ ay_pv_checkndt(ay_tag *t, const char *name, const char *detail,
 int
 ay_pv_getdetail(ay_tag *t, char **detail)
 {
- char *c;
+ const char *n, *c;
+ size_t nl, dl;
+ char ty;
  int result = -1;
 
   if(!t || !t->type || !t->val || (t->type != ay_pv_tagtype))
     return result;
 
-  c = strchr(t->val, ',');
-
-  if(!c)
+  if(ay_pv_getndt(t, &n, &nl, &c, &dl, &ty))
     return result;
 
-  c++;
-
   if(!strncmp(c, "constant", 8))
     result = 0;
   else
@@ -766,7 +1275,7 @@ ay_pv_getdetail(ay_tag *t, char **detail)
     result = 3;
 
   if(detail)
-    *detail = c;
+    *detail = (char*)c;
 
  return result;
 } /* ay_pv_getdetail */
@@ -782,27 +1291,18 @@ ay_pv_getdetail(ay_tag *t, char **detail)
 int
 ay_pv_gettype(ay_tag *t)
 {
- char *c;
+ const char *n, *d;
+ size_t nl, dl;
+ char c;
  int result = -1;
 
   if(!t || !t->type || !t->val || (t->type != ay_pv_tagtype))
     return result;
 
-  c = strchr(t->val, ',');
-
-  if(!c)
-    return result;
-
-  c++;
-
-  c = strchr(c, ',');
-
-  if(!c)
+  if(ay_pv_getndt(t, &n, &nl, &d, &dl, &c))
     return result;
 
-  c++;
-
-  switch(*c)
+  switch(c)
     {
     case 'f':
       result = 0;
@@ -835,7 +1335,8 @@ ay_pv_gettype(ay_tag *t)
 
 /* ay_pv_convert:
  *  convert data from PV tag <tag> into an array of doubles (<type> 0)
- *  or floats (<type> 1)
+ *  or floats (<type> 1); string PV tags are converted to the binary
+ *  form first, so that their data is parsed only once
  *  Warning: <datalen> does not contain the array size, but the number
  *  of data elements, e.g. for one color value it is 1 and not 3!
  */
@@ -848,6 +1349,7 @@ ay_pv_convert(ay_tag *tag, int type, unsigned int *datalen, void **data)
  char *c1, *c2, *c3;
  double *da = NULL;
  float *fa = NULL;
+ ay_pv_bin *pv;
 
   if(!tag)
     return AY_ENULL;
@@ -855,6 +1357,33 @@ ay_pv_convert(ay_tag *tag, int type, unsigned int *datalen, void **data)
   if(tag->type != ay_pv_tagtype)
     return AY_ERROR;
 
+  if(!ay_pv_tobinary(tag))
+    {
+      /* binary tag, just copy/convert the data */
+      pv = (ay_pv_bin*)((ay_btval*)tag->val)->payload;
+      if(!pv->num)
+	return AY_ERROR;
+      count = pv->num*pv->dim;
+      if(type == 0)
+	{
+	  if(!(da = malloc(count*sizeof(double))))
+	    return AY_EOMEM;
+	  memcpy(da, AY_PVDATA(pv), count*sizeof(double));
+	  *data = da;
+	}
+      if(type == 1)
+	{
+	  if(!(fa = malloc(count*sizeof(float))))
+	    return AY_EOMEM;
+	  for(i = 0; i < count; i++)
+	    fa[i] = (float)(AY_PVDATA(pv)[i]);
+	  *data = fa;
+	}
+      if(datalen)
+	*datalen = pv->num;
+      return AY_OK;
+    }
+
   c1 = tag->val;
 
   /* find the type */
@@ -1137,13 +1666,13 @@ ay_pv_getst(ay_object *o, char *mys, char *myt, void **data)
     {
       if(tag->type == ay_pv_tagtype)
 	{
-	  if(!strncmp(tag->val, mys, strlen(mys)))
+	  if(ay_pv_checkndt(tag, mys, "", ""))
 	    {
 	      stag = tag;
 	      if(ttag)
 		break;
 	    }
-	  if(!strncmp(tag->val, myt, strlen(myt)))
+	  if(ay_pv_checkndt(tag, myt, "", ""))
 	    {
 	      ttag = tag;
 	      if(stag)
@@ -1226,7 +1755,7 @@ ay_pv_getvc(ay_object *o, char *myc, int stride, unsigned int *datalen,
     {
       if(tag->type == ay_pv_tagtype)
 	{
-	  if(!strncmp(tag->val, myc, strlen(myc)))
+	  if(ay_pv_checkndt(tag, myc, "", ""))
 	    {
 	      ctag = tag;
 		break;
@@ -1334,6 +1863,62 @@ ay_pv_count(ay_object *o)
 } /* ay_pv_count */
 
 
+/** ay_pv_selectelems:
+ *  replace the data elements of a PV tag by a selection
+ *  (or permutation) of them
+ *
+ * \param[in,out] tag  PV tag to process (must be binary, see
+ *  ay_pv_tobinary())
+ * \param[in] ind  indices of the data elements to keep
+ * \param[in] indlen  number of indices in \a ind
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_pv_selectelems(ay_tag *tag, unsigned int *ind, unsigned int indlen)
+{
+ int ay_status = AY_OK;
+ ay_btval *btval = NULL;
+ ay_pv_bin *pv;
+ double *src, *dst;
+ unsigned int i;
+
+  if(!tag || !ind)
+    return AY_ENULL;
+
+  if(!tag->is_binary || (tag->type != ay_pv_tagtype))
+    return AY_ERROR;
+
+  pv = (ay_pv_bin*)((ay_btval*)tag->val)->payload;
+
+  for(i = 0; i < indlen; i++)
+    {
+      if(ind[i] >= pv->num)
+	return AY_ERROR;
+    }
+
+  ay_status = ay_pv_newbin(AY_PVNAME(pv), strlen(AY_PVNAME(pv)),
+			   AY_PVDETAIL(pv), strlen(AY_PVDETAIL(pv)),
+			   pv->type, indlen, &btval);
+  if(ay_status)
+    return ay_status;
+
+  src = AY_PVDATA(pv);
+  dst = AY_PVDATA((ay_pv_bin*)btval->payload);
+  for(i = 0; i < indlen; i++)
+    {
+      memcpy(dst, &(src[ind[i]*pv->dim]), pv->dim*sizeof(double));
+      dst += pv->dim;
+    }
+
+  free(pv);
+  free(tag->val);
+  tag->val = btval;
+
+ return AY_OK;
+} /* ay_pv_selectelems */
+
+
 /** ay_pv_fixnumelems:
  * Fix/correct the number of elements of a PV tag.
  * Only works correctly if the new number of elements is smaller
@@ -15,29 +15,29 @@
 /* read.c - read scenes */
 
 /* ay_read_string:
- *
+ *  read a string (terminated by a newline) from a scene file;
+ *  reads blocks of characters using fgets() instead of single
+ *  characters, as the strings (e.g. tag values) may be long
  */
 int
 ay_read_string(FILE *fileptr, char **result)
 {
- char readchar, *str;
- int read;
+ char buf[256], *str;
+ size_t len;
  Tcl_DString ds;
 
   Tcl_DStringInit(&ds);
 
   do
     {
-      read = getc(fileptr);
-
-      if(read == EOF)
+      if(!fgets(buf, sizeof(buf), fileptr))
 	{Tcl_DStringFree(&ds); return AY_EUEOF;}
 
-      readchar = (char)read;
+      len = strlen(buf);
 
-      Tcl_DStringAppend(&ds, &readchar, 1);
+      Tcl_DStringAppend(&ds, buf, (int)len);
     }
-  while((char)read != '\n');
+  while(len == 0 || buf[len-1] != '\n');
 
   if(Tcl_DStringLength(&ds) <= 1)
     {Tcl_DStringFree(&ds); return AY_OK;}
@@ -143,48 +143,14 @@ ay_read_skip(FILE *fileptr)
 } /* ay_read_skip */
 
 
-/* ay_read_header:
- *
+/* ay_read_setversion:
+ *  set ay_read_version according to the version string of a scene file
+ *  returns AY_TRUE if the version is unknown
  */
 int
-ay_read_header(FILE *fileptr)
+ay_read_setversion(char *version)
 {
- int ay_status = AY_OK;
- char *version = NULL;
-#ifdef AYACCEPTPRE
-char *pre;
-#endif
- int i, read, version_unknown = AY_TRUE;
- char buf[5], fname[] = "read_header";
-
-  for(i = 0; i < 5; i++)
-    {
-      read = getc(fileptr);
-      if(read == EOF)
-	return AY_EFORMAT;
-      buf[i] = (char)read;
-    }
-
-  if(strncmp(buf, "Ayam", 4))
-    return AY_EFORMAT;
-
-  ay_status = ay_read_string(fileptr, &version);
-
-  if(ay_status)
-    return ay_status;
-
-  if(!version)
-    return AY_EFORMAT;
-
-#ifdef AYACCEPTPRE
-  if(strstr(AY_VERSIONSTR, "pre"))
-    {
-      if((pre = strstr(version, "pre")))
-	{
-	  *pre = '\0';
-	}
-    }
-#endif
+ int version_unknown = AY_TRUE;
 
   ay_read_version = 1;
 
@@ -380,7 +346,54 @@ char *pre;
       version_unknown = AY_FALSE;
     }
 
-  if(version_unknown)
+ return version_unknown;
+} /* ay_read_setversion */
+
+
+/* ay_read_header:
+ *
+ */
+int
+ay_read_header(FILE *fileptr)
+{
+ int ay_status = AY_OK;
+ char *version = NULL;
+#ifdef AYACCEPTPRE
+char *pre;
+#endif
+ int i, read;
+ char buf[5], fname[] = "read_header";
+
+  for(i = 0; i < 5; i++)
+    {
+      read = getc(fileptr);
+      if(read == EOF)
+	return AY_EFORMAT;
+      buf[i] = (char)read;
+    }
+
+  if(strncmp(buf, "Ayam", 4))
+    return AY_EFORMAT;
+
+  ay_status = ay_read_string(fileptr, &version);
+
+  if(ay_status)
+    return ay_status;
+
+  if(!version)
+    return AY_EFORMAT;
+
+#ifdef AYACCEPTPRE
+  if(strstr(AY_VERSIONSTR, "pre"))
+    {
+      if((pre = strstr(version, "pre")))
+	{
+	  *pre = '\0';
+	}
+    }
+#endif
+
+  if(ay_read_setversion(version))
     {
       ay_error(AY_EWARN, fname, "Unknown file version, reading as V1.0!");
     }
@@ -441,24 +454,68 @@ ay_read_attributes(FILE *fileptr, ay_object *o)
 } /* ay_read_attributes */
 
 
-/* ay_read_tags:
- *
+/* ay_read_checktag:
+ *  complete a tag that was just read from a scene file:
+ *  set the tag type and disable scripts (if there is no safe
+ *  interpreter)
  */
 int
-ay_read_tags(FILE *fileptr, ay_object *o)
+ay_read_checktag(ay_tag *tag)
 {
  int ay_status = AY_OK;
- ay_tag *tag = NULL, **next = NULL;
  Tcl_HashEntry *entry = NULL;
- int tcount = 0, i = 0;
  char fname[] = "read_tags";
 #ifdef AYNOSAFEINTERP
  int deactivate = 0;
- char a1[] = "ay", n1[] = "scriptdisable";
  char script_disable_cmd[] = "script_disable";
  Tcl_Obj *to = NULL;
 #endif
 
+  if(!tag || !tag->name)
+    return AY_ENULL;
+
+  if(!(entry = Tcl_FindHashEntry(&ay_tagtypesht, tag->name)))
+    {
+      if(ay_prefs.wutag)
+	ay_error(AY_EWARN, fname, "Tag type is not registered!");
+    }
+  else
+    {
+      tag->type = *((unsigned int *)Tcl_GetHashValue(entry));
+    }
+
+#ifdef AYNOSAFEINTERP
+  /* if there is no safe interpreter, disable all ANS/BNS tags
+     by manipulating their type */
+  if(tag->type == ay_bns_tagtype || tag->type == ay_ans_tagtype)
+    {
+      Tcl_Eval(ay_interp, script_disable_cmd);
+      to = Tcl_GetVar2Ex(ay_interp, "ay", "scriptdisable",
+			 TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+      if(to)
+	Tcl_GetIntFromObj(ay_interp, to, &(deactivate));
+
+      if(deactivate)
+	{
+	  ay_status = ay_ns_disable(tag);
+	}
+    } /* if is bns or ans */
+#endif /* AYNOSAFEINTERP */
+
+ return ay_status;
+} /* ay_read_checktag */
+
+
+/* ay_read_tags:
+ *
+ */
+int
+ay_read_tags(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_tag *tag = NULL, **next = NULL;
+ int tcount = 0, i = 0;
+
   if(!o)
     return AY_ENULL;
 
@@ -479,17 +536,7 @@ ay_read_tags(FILE *fileptr, ay_object *o)
       if(!tag->name)
 	{ free(tag); return AY_ERROR; }
 
-      if(!(entry = Tcl_FindHashEntry(&ay_tagtypesht, tag->name)))
-	{
-	  if(ay_prefs.wutag)
-	    ay_error(AY_EWARN, fname, "Tag type is not registered!");
-	}
-      else
-	{
-	  tag->type = *((unsigned int *)Tcl_GetHashValue(entry));
-	}
-
-     ay_status = ay_read_string(fileptr, (char**)(void*)&(tag->val));
+      ay_status = ay_read_string(fileptr, (char**)(void*)&(tag->val));
 
       if(ay_status)
 	{ free(tag->name); free(tag); return ay_status; }
@@ -503,46 +550,12 @@ ay_read_tags(FILE *fileptr, ay_object *o)
 
       ay_tags_vttonl((char*)tag->val);
 
-#ifdef AYNOSAFEINTERP
-     /* if there is no safe interpreter, disable all ANS/BNS tags
-	by manipulating their type */
-     if(tag->type == ay_bns_tagtype)
-       {
-	 Tcl_Eval(ay_interp, script_disable_cmd);
-	 to = Tcl_GetVar2Ex(ay_interp, "ay", "scriptdisable",
-			     TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
-	 if(to)
-	   Tcl_GetIntFromObj(ay_interp, to, &(deactivate));
-
-	 if(deactivate)
-	   {
-	     ay_status = ay_ns_disable(tag);
-	     if(ay_status)
-	       {
-		 ay_tags_free(tag);
-		 break;
-	       }
-	   }
-       } /* if is bns */
-     if(tag->type == ay_ans_tagtype)
-       {
-	 Tcl_Eval(ay_interp, script_disable_cmd);
-	 to = Tcl_GetVar2Ex(ay_interp, "ay", "scriptdisable",
-			     TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
-	 if(to)
-	   Tcl_GetIntFromObj(ay_interp, to, &(deactivate));
-
-	 if(deactivate)
-	   {
-	     ay_status = ay_ns_disable(tag);
-	     if(ay_status)
-	       {
-		 ay_tags_free(tag);
-		 break;
-	       }
-	   }
-       } /* if is ans */
-#endif /* AYNOSAFEINTERP */
+      ay_status = ay_read_checktag(tag);
+      if(ay_status)
+	{
+	  ay_tags_free(tag);
+	  break;
+	}
 
       *next = tag;
       next = &(tag->next);
@@ -642,6 +655,118 @@ cleanup:
 } /* ay_read_shader */
 
 
+/* ay_read_typename:
+ *  get the type id for the type name <typename> of an object read
+ *  from a scene file; tries to autoload the custom object/plugin
+ *  if the type name is not registered
+ *  returns AY_ENTYPE if the type name can not be resolved
+ */
+int
+ay_read_typename(char *typename, unsigned int *type)
+{
+ Tcl_HashEntry *entry = NULL;
+ Tcl_DString ds;
+
+  if(!typename || !type)
+    return AY_ENULL;
+
+  /* is the type name registered? */
+  if(!(entry = Tcl_FindHashEntry(&ay_otypesht, typename)))
+    {
+      /* no */
+      /* try to autoload the custom object/plugin */
+      Tcl_DStringInit(&ds);
+      Tcl_DStringAppend(&ds, "loadPlugin ", -1);
+      Tcl_DStringAppend(&ds, typename, -1);
+      Tcl_Eval(ay_interp, Tcl_DStringValue(&ds));
+      Tcl_DStringFree(&ds);
+
+      /* check again whether type name is registered */
+      if(!(entry = Tcl_FindHashEntry(&ay_otypesht, typename)))
+	{
+	  return AY_ENTYPE;
+	}
+    } /* if */
+
+  /* get type id of name */
+  *type = *((unsigned int*)Tcl_GetHashValue(entry));
+
+ return AY_OK;
+} /* ay_read_typename */
+
+
+/* ay_read_linkobject:
+ *  call the read callback <cb> for the freshly read object <o>
+ *  and link the object to the scene (going down if it has children);
+ *  the object is freed if it is not to be linked
+ */
+int
+ay_read_linkobject(FILE *fileptr, ay_object *o, int has_child,
+		   ay_readcb *cb)
+{
+ int ay_status = AY_OK;
+ char fname[] = "read_object";
+ ay_tag tag = {0};
+
+  /* inform object to read that there follow children;
+     this, currently, is only interesting for views */
+  if(has_child)
+    {
+      tag.type = ay_hc_tagtype;
+      tag.next = o->tags;
+      o->tags = &tag;
+    }
+
+  /* execute read callback */
+  if(cb)
+    ay_status = cb(fileptr, o);
+
+  /* restore tags */
+  if(has_child)
+    {
+      o->tags = tag.next;
+    }
+
+  if(ay_status)
+    {
+      if(ay_status == AY_EDONOTLINK)
+	{
+	  ay_object_delete(o);
+	  return AY_OK;
+	}
+      else
+	{
+	  ay_error(ay_status, fname, NULL);
+	  ay_error(AY_ERROR, fname, "read callback failed");
+	  ay_object_delete(o);
+	  return ay_status;
+	} /* if */
+    } /* if */
+
+  if(o->parent && (!o->down))
+    {
+      o->down = ay_endlevel;
+    }
+
+  ay_object_link(o);
+
+  if(ay_read_version == 0)
+    {
+      fscanf(fileptr, "%d\n", &has_child);
+    }
+
+  if(has_child)
+    {
+      /* go down */
+      ay_clevel_add(o);
+      ay_clevel_add(o->down);
+      ay_next = &(o->down);
+    }
+
+ return ay_status;
+} /* ay_read_linkobject */
+
+
 /* ay_read_object:
  *
  */
@@ -653,12 +778,8 @@ ay_read_object(FILE *fileptr)
  int has_typename = 0, has_child = 0, read = 0;
  unsigned int type = 0;
  ay_object *o = NULL;
- ay_tag tag = {0};
  ay_voidfp *arr = NULL;
- ay_readcb *cb = NULL;
  char *typename = NULL;
- Tcl_HashEntry *entry = NULL;
- Tcl_DString ds;
 
   if(feof(fileptr))
     return AY_EEOF;
@@ -690,38 +811,13 @@ ay_read_object(FILE *fileptr)
       if(!typename)
 	{ ay_object_delete(o); return AY_ERROR; }
 
-      /* is the type name registered? */
-      if((entry = Tcl_FindHashEntry(&ay_otypesht, typename)))
+      if(ay_read_typename(typename, &type))
 	{
-	  /* yes */
-	  /* get type id of name */
-	  type = *((unsigned int*)Tcl_GetHashValue(entry));
+	  ay_error(AY_ENTYPE, fname, typename);
+	  free(typename);
+	  ay_object_delete(o);
+	  return AY_OK;
 	}
-      else
-	{
-	  /* no */
-	  /* try to autoload the custom object/plugin */
-	  Tcl_DStringInit(&ds);
-	  Tcl_DStringAppend(&ds, "loadPlugin ", -1);
-	  Tcl_DStringAppend(&ds, typename, -1);
-	  Tcl_Eval(ay_interp, Tcl_DStringValue(&ds));
-	  Tcl_DStringFree(&ds);
-
-	  /* check again whether type name is registered */
-	  if((entry = Tcl_FindHashEntry(&ay_otypesht, typename)))
-	    {
-	      /* yes */
-	      /* get type id of name */
-	      type = *((unsigned int *)Tcl_GetHashValue(entry));
-	    }
-	  else
-	    {
-	      ay_error(AY_ENTYPE, fname, typename);
-	      free(typename);
-	      ay_object_delete(o);
-	      return AY_OK;
-	    } /* if */
-	} /* if */
       free(typename);
     }
   else
@@ -744,62 +840,11 @@ ay_read_object(FILE *fileptr)
   if(ay_status)
     { ay_object_delete(o); return ay_status; }
 
-  /* inform object to read that there follow children;
-     this, currently, is only interesting for views */
-  if(has_child)
-    {
-      tag.type = ay_hc_tagtype;
-      tag.next = o->tags;
-      o->tags = &tag;
-    }
-
-  /* get and execute read callback */
+  /* get read callback, execute it, and link the object */
   arr = ay_readcbt.arr;
-  cb = (ay_readcb *)(arr[type]);
-  if(cb)
-    ay_status = cb(fileptr, o);
-
-  /* restore tags */
-  if(has_child)
-    {
-      o->tags = tag.next;
-    }
-
-  if(ay_status)
-    {
-      if(ay_status == AY_EDONOTLINK)
-	{
-	  ay_object_delete(o);
-	  return AY_OK;
-	}
-      else
-	{
-	  ay_error(ay_status, fname, NULL);
-	  ay_error(AY_ERROR, fname, "read callback failed");
-	  ay_object_delete(o);
-	  return ay_status;
-	} /* if */
-    } /* if */
-
-  if(o->parent && (!o->down))
-    {
-      o->down = ay_endlevel;
-    }
-
-  ay_object_link(o);
-
-  if(ay_read_version == 0)
-    {
-      fscanf(fileptr, "%d\n", &has_child);
-    }
 
-  if(has_child)
-    {
-      /* go down */
-      ay_clevel_add(o);
-      ay_clevel_add(o->down);
-      ay_next = &(o->down);
-    }
+  ay_status = ay_read_linkobject(fileptr, o, has_child,
+				 (ay_readcb *)(arr[type]));
 
  return ay_status;
 } /* ay_read_object */
@@ -814,7 +859,7 @@ ay_read_scene(Tcl_Interp *interp, char *filename, int insert)
  int ay_status = AY_OK;
  FILE *fileptr = NULL;
  char *fname = "read_scene";
- int old_save_rv = ay_prefs.save_rootviews;
+ int old_save_rv = ay_prefs.save_rootviews, binary = AY_FALSE;
  ay_object *o = NULL;
  Tcl_Obj *to = NULL;
 
@@ -842,7 +887,21 @@ ay_read_scene(Tcl_Interp *interp, char *filename, int insert)
       return AY_ERROR;
     }
 
-  ay_status = ay_read_header(fileptr);
+  /* binary or text format? */
+  ay_status = ay_bio_readheader(fileptr);
+
+  if(!ay_status)
+    {
+      binary = AY_TRUE;
+    }
+  else
+    {
+      if(ay_status == AY_EFORMAT)
+	{
+	  rewind(fileptr);
+	  ay_status = ay_read_header(fileptr);
+	}
+    }
 
   if(ay_status)
     {
@@ -854,7 +913,10 @@ ay_read_scene(Tcl_Interp *interp, char *filename, int insert)
 
   while(!ay_status)
     {
-      ay_status = ay_read_object(fileptr);
+      if(binary)
+	ay_status = ay_bio_readobject(fileptr);
+      else
+	ay_status = ay_read_object(fileptr);
       if(ay_status)
 	{
 	  if(ay_status != AY_EEOF)
@@ -210,7 +210,13 @@ int
 ay_selp_invert(ay_object *o)
 {
  int ay_status = AY_OK;
- ay_point *t = NULL, *p = NULL, **last2 = NULL, *p2 = NULL;
+ char fname[] = "selp_invert";
+ double p[3] = {DBL_MIN, DBL_MIN, DBL_MIN};
+ unsigned int i = 0;
+ int have_it = AY_FALSE;
+ ay_point *newp = NULL, *nselp = NULL;
+ ay_pointedit pe = {0};
+ ay_selpset set = {0};
 
   if(!o)
     return AY_ENULL;
@@ -221,45 +227,69 @@ ay_selp_invert(ay_object *o)
       return ay_status;
     }
 
-  /* save old selection of points to p */
-  p = o->selp;
-
-  /* select all points */
-  o->selp = NULL;
-  ay_status = ay_selp_selall(o);
+  ay_status = ay_pact_getpoint(0, o, p, &pe);
   if(ay_status)
+    goto cleanup;
+
+  /* with point indices available, membership in the old selection
+     is tested via a bitset, making the inversion linear */
+  if(pe.indices)
     {
-      ay_selp_clear(o);
-      o->selp = p;
-      return ay_status;
+      ay_status = ay_selp_setfromlist(o->selp, pe.num, &set);
+      if(ay_status)
+	goto cleanup;
     }
 
-  /* remove all points, that are in p (old selection), from p2 (new
-     selection); additionally, clear p */
-  while(p)
+  for(i = 0; i < pe.num; i++)
     {
-      last2 = &(o->selp);
-      p2 = o->selp;
-      while(p2)
+      if(pe.indices)
+	have_it = AY_SELPSETHAS(&set, pe.indices[i]);
+      else
+	have_it = ay_selp_find(o->selp, pe.coords[i]);
+
+      if(have_it)
+	continue;
+
+      if(!(newp = malloc(sizeof(ay_point))))
 	{
-	  if(p->point == p2->point)
-	    {
-	      *last2 = p2->next;
-	      free(p2);
-	      break;
-	    }
-	  else
-	    {
-	      last2 = &(p2->next);
-	      p2 = p2->next;
-	    } /* if */
-	} /* while */
-      t = p;
-      p = p->next;
-      free(t);
-    } /* while */
+	  ay_error(AY_EOMEM, fname, NULL);
+	  ay_status = AY_ERROR;
+	  goto cleanup;
+	}
 
- return AY_OK;
+      newp->next = nselp;
+      nselp = newp;
+      newp->point = pe.coords[i];
+      if(pe.indices)
+	{
+	  newp->index = pe.indices[i];
+	}
+      else
+	{
+	  newp->index = 0;
+	}
+      newp->type = pe.type;
+      newp->readonly = pe.readonly;
+    } /* for */
+
+  ay_selp_clear(o);
+  o->selp = nselp;
+  nselp = NULL;
+
+cleanup:
+
+  while(nselp)
+    {
+      newp = nselp->next;
+      free(nselp);
+      nselp = newp;
+    }
+
+  ay_selp_setfree(&set);
+
+  ay_pact_clearpointedit(&pe);
+
+ return ay_status;
 } /* ay_selp_invert */
 
 
@@ -634,48 +664,49 @@ int
 ay_selp_sel(ay_object *o, unsigned int indiceslen, unsigned int *indices)
 {
  int ay_status = AY_OK;
- ay_point *po = NULL, *p = NULL;
+ ay_point *po = NULL;
+ ay_selpset set = {0};
  unsigned int i = 0;
- char have_it = AY_FALSE;
 
   if(!o || !indices)
     return AY_ENULL;
 
+  ay_status = ay_selp_setfromlist(o->selp, 0, &set);
+  if(ay_status)
+    return ay_status;
+
   for(i = 0; i < indiceslen; i++)
     {
-      if(!po)
-	{
-	  if(!(po = calloc(1, sizeof(ay_point))))
-	    {
-	      return AY_EOMEM;
-	    }
-	}
-      have_it = AY_FALSE;
-      p = o->selp;
-      while(p)
+      if(AY_SELPSETHAS(&set, indices[i]))
+	continue;
+
+      if(!(po = calloc(1, sizeof(ay_point))))
 	{
-	  if(indices[i] == p->index)
-	    {
-	      have_it = AY_TRUE;
-	      break;
-	    }
-	  p = p->next;
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
 	}
-      if(!have_it)
+
+      ay_status = ay_selp_setadd(&set, indices[i]);
+      if(ay_status)
 	{
-	  po->index = indices[i];
-	  po->next = o->selp;
-	  o->selp = po;
-	  po = NULL;
+	  free(po);
+	  goto cleanup;
 	}
+
+      po->index = indices[i];
+      po->next = o->selp;
+      o->selp = po;
     } /* for */
 
-  /* update pointers */
-  ay_status = ay_pact_getpoint(3, o, NULL, NULL);
+cleanup:
 
-  /* cleanup */
-  if(po)
-    free(po);
+  ay_selp_setfree(&set);
+
+  /* update pointers */
+  if(!ay_status)
+    ay_status = ay_pact_getpoint(3, o, NULL, NULL);
+  else
+    (void)ay_pact_getpoint(3, o, NULL, NULL);
 
  return ay_status;
 } /* ay_selp_sel */
@@ -1020,7 +1051,7 @@ ay_selp_getpnts(int mode, ay_object *o, double *p, ay_pointedit *pe,
  double **pecoords = NULL, **pecoordstmp, *pecoord = NULL, *c;
  double h[3];
  int i = 0, j = 0, a = 0;
- unsigned int *peindices = NULL, *peindicestmp, peindex = 0;
+ unsigned int *peindices = NULL, *peindicestmp, peindex = 0, pesize = 0;
 
   if(!o || !arr)
     return AY_ENULL;
@@ -1121,25 +1152,32 @@ ay_selp_getpnts(int mode, ay_object *o, double *p, ay_pointedit *pe,
 	     ((p[8]*c[0] + p[9]*c[1] + p[10]*c[2] + p[11]) < 0.0) &&
 	     ((p[12]*c[0] + p[13]*c[1] + p[14]*c[2] + p[15]) < 0.0))
 	    {
-	      if(!(pecoordstmp = realloc(pecoords, (a+1)*sizeof(double *))))
+	      /* grow the arrays geometrically, so that selecting
+		 many points stays linear */
+	      if((unsigned int)a == pesize)
 		{
-		  if(pecoords)
-		    free(pecoords);
-		  if(peindices)
-		    free(peindices);
-		  return AY_EOMEM;
-		}
-	      pecoords = pecoordstmp;
-	      if(!(peindicestmp = realloc(peindices,
-				       (a+1)*sizeof(unsigned int))))
-		{
-		  if(pecoords)
-		    free(pecoords);
-		  if(peindices)
-		    free(peindices);
-		  return AY_EOMEM;
+		  pesize = pesize?pesize*2:64;
+		  if(!(pecoordstmp = realloc(pecoords,
+					     pesize*sizeof(double *))))
+		    {
+		      if(pecoords)
+			free(pecoords);
+		      if(peindices)
+			free(peindices);
+		      return AY_EOMEM;
+		    }
+		  pecoords = pecoordstmp;
+		  if(!(peindicestmp = realloc(peindices,
+					      pesize*sizeof(unsigned int))))
+		    {
+		      if(pecoords)
+			free(pecoords);
+		      if(peindices)
+			free(peindices);
+		      return AY_EOMEM;
+		    }
+		  peindices = peindicestmp;
 		}
-	      peindices = peindicestmp;
 
 	      pecoords[a] = &(arr[j]);
 	      peindices[a] = i;
@@ -1200,7 +1238,7 @@ ay_selp_getpnts(int mode, ay_object *o, double *p, ay_pointedit *pe,
 void
 ay_selp_selectmpnc(ay_object *o, int select_all)
 {
- ay_point *p = NULL, **nextp = NULL, *newp = NULL;
+ ay_point *p = NULL, **nextp = NULL, *newp = NULL, **pnts = NULL;
  ay_mpoint *mp = NULL;
  ay_nurbcurve_object *nc;
  int i, found = AY_FALSE;
@@ -1210,8 +1248,21 @@ ay_selp_selectmpnc(ay_object *o, int select_all)
 
   nc = (ay_nurbcurve_object *)o->refine;
 
-  if(nc->createmp)
+  if(nc->createmp && nc->mpoints)
     {
+      /* map point indices to selected points, so that the
+	 membership tests below are O(1) */
+      if(!(pnts = calloc(nc->length, sizeof(ay_point*))))
+	return;
+
+      p = o->selp;
+      while(p)
+	{
+	  if(p->index < (unsigned int)nc->length && !pnts[p->index])
+	    pnts[p->index] = p;
+	  p = p->next;
+	}
+
       mp = nc->mpoints;
       while(mp)
 	{
@@ -1223,19 +1274,10 @@ ay_selp_selectmpnc(ay_object *o, int select_all)
 
 	      for(i = 0; i < mp->multiplicity; i++)
 		{
-		  p = o->selp;
-
-		  while(p)
-		    {
-		      if(p->index == mp->indices[i])
-			{
-			  found = AY_TRUE;
-			  break;
-			}
-		      p = p->next;
-		    } /* while */
-		  if(found)
+		  if(mp->indices[i] < (unsigned int)nc->length &&
+		     pnts[mp->indices[i]])
 		    {
+		      found = AY_TRUE;
 		      break;
 		    } /* if */
 		} /* for */
@@ -1245,37 +1287,36 @@ ay_selp_selectmpnc(ay_object *o, int select_all)
 	    {
 	      for(i = 0; i < mp->multiplicity; i++)
 		{
-		  p = o->selp;
-		  found = AY_FALSE;
-		  while(p)
+		  if(mp->indices[i] >= (unsigned int)nc->length)
+		    continue;
+
+		  if(pnts[mp->indices[i]])
 		    {
-		      if(p->index == mp->indices[i])
-			{
-			  /* advancing "nextp" ensures that we append
-			     new selected points right after the
-			     other already selected points of this
-			     multiple points */
-			  nextp = &(p->next);
-			  found = AY_TRUE;
-			  break;
-			}
-		      p = p->next;
-		    } /* while */
-		  if(!found)
+		      /* advancing "nextp" ensures that we append
+			 new selected points right after the
+			 other already selected points of this
+			 multiple points */
+		      nextp = &(pnts[mp->indices[i]]->next);
+		    }
+		  else
 		    {
 		      if(!(newp = calloc(1, sizeof(ay_point))))
 			{
+			  free(pnts);
 			  return;
 			}
 		      newp->next = *nextp;
 		      *nextp = newp;
 		      newp->point = mp->points[i];
 		      newp->index = mp->indices[i];
+		      pnts[mp->indices[i]] = newp;
 		    } /* if */
 		} /* for */
 	    } /* if */
 	  mp = mp->next;
 	} /* while */
+
+      free(pnts);
     } /* if */
 
  return;
@@ -1759,26 +1800,19 @@ ay_selp_reducetominmax(ay_object *o)
 void
 ay_selp_updatempselection(unsigned int n, ay_point *selp, ay_mpoint *mp)
 {
- char *sel = NULL;
+ ay_selpset set = {0};
  int i, j;
 
-  if(!(sel = calloc(n, sizeof(char))))
+  if(ay_selp_setfromlist(selp, n, &set))
     return;
 
-  while(selp)
-    {
-      if(selp->index < n)
-	sel[selp->index] = 1;
-      selp = selp->next;
-    }
-
   while(mp)
     {
       j = 0;
       for(i = 0; i < mp->multiplicity; i++)
 	{
 	  if(mp->indices[i] < n)
-	    if(sel[mp->indices[i]])
+	    if(AY_SELPSETHAS(&set, mp->indices[i]))
 	      j++;
 	}
       if(j == mp->multiplicity)
@@ -1792,7 +1826,7 @@ ay_selp_updatempselection(unsigned int n, ay_point *selp, ay_mpoint *mp)
       mp = mp->next;
     }
 
-  free(sel);
+  ay_selp_setfree(&set);
 
  return;
 } /* ay_selp_updatempselection */
@@ -1821,3 +1855,178 @@ ay_selp_find(ay_point *selp, double *point)
 
  return AY_FALSE;
 } /* ay_selp_find */
+
+
+/** ay_selp_setinit:
+ * Initialize a set of selected point indices.
+ *
+ * \param[in,out] set  set to initialize
+ * \param[in] len  number of points the set should initially cover
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_selp_setinit(ay_selpset *set, unsigned int len)
+{
+
+  if(!set)
+    return AY_ENULL;
+
+  memset(set, 0, sizeof(ay_selpset));
+
+  if(len)
+    {
+      if(!(set->bits = calloc((len+7)/8, sizeof(unsigned char))))
+	return AY_EOMEM;
+      set->len = len;
+    }
+
+ return AY_OK;
+} /* ay_selp_setinit */
+
+
+/** ay_selp_setfree:
+ * Free the memory of a set of selected point indices.
+ *
+ * \param[in,out] set  set to clear
+ */
+void
+ay_selp_setfree(ay_selpset *set)
+{
+
+  if(!set)
+    return;
+
+  if(set->bits)
+    free(set->bits);
+
+  if(set->indices)
+    free(set->indices);
+
+  memset(set, 0, sizeof(ay_selpset));
+
+ return;
+} /* ay_selp_setfree */
+
+
+/** ay_selp_setadd:
+ * Add a point index to a set of selected point indices.
+ * The bitset and the index array grow as needed.
+ *
+ * \param[in,out] set  set to extend
+ * \param[in] index  point index to add
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_selp_setadd(ay_selpset *set, unsigned int index)
+{
+ unsigned char *bits;
+ unsigned int len, size, *indices;
+
+  if(!set)
+    return AY_ENULL;
+
+  if(AY_SELPSETHAS(set, index))
+    return AY_OK;
+
+  if(index >= set->len)
+    {
+      len = set->len*2;
+      if(len <= index)
+	len = index+1;
+      if(!(bits = realloc(set->bits, (len+7)/8)))
+	return AY_EOMEM;
+      memset(&(bits[(set->len+7)/8]), 0, (len+7)/8-(set->len+7)/8);
+      set->bits = bits;
+      set->len = len;
+    }
+
+  if(set->num == set->size)
+    {
+      size = set->size?set->size*2:64;
+      if(!(indices = realloc(set->indices, size*sizeof(unsigned int))))
+	return AY_EOMEM;
+      set->indices = indices;
+      set->size = size;
+    }
+
+  set->bits[index>>3] |= (1 << (index&7));
+  set->indices[set->num] = index;
+  set->num++;
+
+ return AY_OK;
+} /* ay_selp_setadd */
+
+
+/** ay_selp_setfromlist:
+ * Create a set from the indices of a list of selected points.
+ *
+ * \param[in] selp  list of selected points (may be NULL)
+ * \param[in] len  number of points of the object (may be 0, if unknown)
+ * \param[in,out] set  where to store the new set
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_selp_setfromlist(ay_point *selp, unsigned int len, ay_selpset *set)
+{
+ int ay_status = AY_OK;
+
+  ay_status = ay_selp_setinit(set, len);
+
+  while(selp && !ay_status)
+    {
+      ay_status = ay_selp_setadd(set, selp->index);
+      selp = selp->next;
+    }
+
+  if(ay_status)
+    ay_selp_setfree(set);
+
+ return ay_status;
+} /* ay_selp_setfromlist */
+
+
+/** ay_selp_setfromarr:
+ * Create a set from a list of selected points that point into
+ * the coordinate array \a arr. The set contains the position of
+ * each selected point in \a arr (not the index of the selected point).
+ * Selected points that do not point into \a arr are ignored.
+ *
+ * \param[in] selp  list of selected points (may be NULL)
+ * \param[in] arr  coordinate array
+ * \param[in] arrlen  number of points in \a arr
+ * \param[in] stride  size of a point in \a arr
+ * \param[in,out] set  where to store the new set
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_selp_setfromarr(ay_point *selp, double *arr, unsigned int arrlen,
+		   int stride, ay_selpset *set)
+{
+ int ay_status = AY_OK;
+ size_t d;
+
+  if(!arr || stride < 1)
+    return AY_ENULL;
+
+  ay_status = ay_selp_setinit(set, arrlen);
+
+  while(selp && !ay_status)
+    {
+      if(selp->point >= arr && selp->point < arr+(size_t)arrlen*stride)
+	{
+	  d = (size_t)(selp->point - arr);
+	  if(d % stride == 0)
+	    ay_status = ay_selp_setadd(set, (unsigned int)(d / stride));
+	}
+      selp = selp->next;
+    }
+
+  if(ay_status)
+    ay_selp_setfree(set);
+
+ return ay_status;
+} /* ay_selp_setfromarr */
@@ -710,6 +710,9 @@ ay_shade_object(struct Togl *togl, ay_object *o, int push_name)
    glMultMatrixd((GLdouble *)m);
    glScaled((GLdouble)o->scalx, (GLdouble)o->scaly, (GLdouble)o->scalz);
 
+   if(!push_name && ay_draw_isculled(o))
+     goto cleanup;
+
    if(push_name)
      {
        o->glname = ++ay_glname;
@@ -829,6 +832,10 @@ ay_shade_view(struct Togl *togl)
       view->dirty = AY_FALSE;
     }
 
+  ay_vbo_begin(togl);
+
+  view->culled = 0;
+
   if(view->drawmode == AY_DMWIREHIDDEN && !view->action_state &&
      ay_prefs.sdmode != 0)
     {
@@ -904,11 +911,13 @@ ay_shade_view(struct Togl *togl)
 
   if(!view->drawsel)
     {
+      ay_draw_beginculling(togl);
       while(o)
 	{
 	  ay_shade_object(togl, o, AY_FALSE);
 	  o = o->next;
 	} /* while */
+      ay_draw_endculling();
     } /* if */
 
   if(view->drawmode == AY_DMWIREHIDDEN)
@@ -1144,6 +1153,8 @@ ay_shade_view(struct Togl *togl)
 	glLineWidth((GLfloat)1.0f);
     }
 
+  ay_vbo_end();
+
   if(sil)
     free(sil);
   if(silsel)
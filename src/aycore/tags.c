@@ -296,7 +296,9 @@ ay_tags_settcmd(ClientData clientData, Tcl_Interp *interp,
       new = o->tags;
       while(new)
 	{
-	  if(new->is_intern || new->is_binary)
+	  /* binary PV tags are visible (in their string form) */
+	  if(new->is_intern ||
+	     (new->is_binary && new->type != ay_pv_tagtype))
 	    {
 	      new = new->next;
 	    }
@@ -327,9 +329,12 @@ ay_tags_settcmd(ClientData clientData, Tcl_Interp *interp,
 	    }
 	  if(new->val)
 	    {
+	      if(new->is_binary)
+		free(((ay_btval*)new->val)->payload);
 	      free(new->val);
 	      new->val = NULL;
 	    }
+	  new->is_binary = AY_FALSE;
 	  /* we first try to resolve the tag type */
 	  if(!(entry = Tcl_FindHashEntry(&ay_tagtypesht, argv[3])))
 	    {
@@ -376,7 +381,8 @@ ay_tags_settcmd(ClientData clientData, Tcl_Interp *interp,
       next = &(o->tags);
       while(new)
 	{
-	  if(new->is_intern || new->is_binary)
+	  if(new->is_intern ||
+	     (new->is_binary && new->type != ay_pv_tagtype))
 	    {
 	      next = &(new->next);
 	      new = new->next;
@@ -428,7 +434,9 @@ ay_tags_settcmd(ClientData clientData, Tcl_Interp *interp,
 	  next = &(o->tags);
 	  while(t)
 	    {
-	      if(t->is_intern || t->is_binary)
+	      /* binary PV tags are replaced (by their string forms) */
+	      if(t->is_intern ||
+		 (t->is_binary && t->type != ay_pv_tagtype))
 		{
 		  /* link tag t to end of list in oldibtags */
 		  *otnext = t;
@@ -604,8 +612,11 @@ ay_tags_addtcmd(ClientData clientData, Tcl_Interp *interp,
 
 	  if(t)
 	    {
+	      if(t->is_binary)
+		free(((ay_btval*)t->val)->payload);
 	      free(t->val);
 	      t->val = new->val;
+	      t->is_binary = AY_FALSE;
 	      free(new->name);
 	      free(new);
 	      sel = sel->next;
@@ -647,6 +658,7 @@ ay_tags_gettcmd(ClientData clientData, Tcl_Interp *interp,
  ay_list_object *sel = ay_selection;
  ay_object *o = NULL;
  ay_tag *tag = NULL;
+ char *val;
  int get_single = AY_FALSE, have_vname = AY_FALSE;
 
   if(argv[0][6] != 's')
@@ -689,17 +701,31 @@ ay_tags_gettcmd(ClientData clientData, Tcl_Interp *interp,
   tag = o->tags;
   while(tag)
     {
-      if(tag->name && tag->val && !tag->is_intern && !tag->is_binary)
+      if(tag->name && tag->val && !tag->is_intern &&
+	 (!tag->is_binary || tag->type == ay_pv_tagtype))
 	{
+	  /* binary PV tags are delivered in their string form */
+	  val = tag->val;
+	  if(tag->is_binary)
+	    {
+	      if(ay_pv_tostring(tag, &val))
+		{
+		  tag = tag->next;
+		  continue;
+		}
+	    }
+
 	  if(get_single)
 	    {
 	      if(!strcmp(argv[1], tag->name))
 		{
 		  if(have_vname)
-		    Tcl_SetVar(interp, argv[2], tag->val, TCL_APPEND_VALUE |
+		    Tcl_SetVar(interp, argv[2], val, TCL_APPEND_VALUE |
 			       TCL_LEAVE_ERR_MSG);
 		  else
-		    Tcl_SetResult(interp, tag->val, TCL_VOLATILE);
+		    Tcl_SetResult(interp, val, TCL_VOLATILE);
+		  if(val != tag->val)
+		    free(val);
 		  break;
 		}
 	    }
@@ -707,9 +733,12 @@ ay_tags_gettcmd(ClientData clientData, Tcl_Interp *interp,
 	    {
 	      Tcl_SetVar(interp, argv[1], tag->name, TCL_APPEND_VALUE |
 			 TCL_LIST_ELEMENT | TCL_LEAVE_ERR_MSG);
-	      Tcl_SetVar(interp, argv[2], tag->val, TCL_APPEND_VALUE |
+	      Tcl_SetVar(interp, argv[2], val, TCL_APPEND_VALUE |
 			 TCL_LIST_ELEMENT | TCL_LEAVE_ERR_MSG);
 	    }
+
+	  if(val != tag->val)
+	    free(val);
 	} /* if */
       tag = tag->next;
     } /* while */
@@ -761,6 +790,7 @@ ay_tags_hastcmd(ClientData clientData, Tcl_Interp *interp,
  ay_object *o = NULL;
  ay_tag *tag = NULL;
  Tcl_Obj *to = NULL, *res = NULL;
+ char *val;
  int havetag, early = AY_FALSE;
 
   if(argc < 2)
@@ -790,6 +820,27 @@ ay_tags_hastcmd(ClientData clientData, Tcl_Interp *interp,
 	{
 	  if(tag->name && !strcmp(tag->name, argv[1]))
 	    {
+	      if(argc > 2 && tag->is_binary && tag->type == ay_pv_tagtype)
+		{
+		  /* match binary PV tags in their string form */
+		  val = NULL;
+		  (void)ay_pv_tostring(tag, &val);
+		  if(val && Tcl_StringMatch(val, argv[2]))
+		    {
+		      free(val);
+		      to = Tcl_NewIntObj(1);
+		      Tcl_ListObjAppendElement(interp, res, to);
+		      if(early)
+			goto cleanup;
+		      havetag = AY_TRUE;
+		    }
+		  else
+		    {
+		      if(val)
+			free(val);
+		    }
+		}
+	      else
 	      if(argc > 2 && !tag->is_binary)
 		{
 		  if(tag->val && Tcl_StringMatch(tag->val, argv[2]))
@@ -939,7 +990,7 @@ ay_tags_deletetcmd(ClientData clientData, Tcl_Interp *interp,
       tag = o->tags;
       while(tag)
 	{
-	  if((!tag->is_binary) && tag->name)
+	  if((!tag->is_binary || tag->type == ay_pv_tagtype) && tag->name)
 	    {
 	      if(mode || (!strcmp(argv[1], tag->name)))
 		{
@@ -157,6 +157,8 @@ ay_toglcb_destroy(struct Togl *togl)
     }
 #endif
 
+  ay_vbo_freeview(togl);
+
   if(ay_currentlevel->object == root->down)
     recreate_clevel = AY_TRUE;
 
@@ -1554,14 +1554,14 @@ ay_trafo_decomposematrix(double *m, ay_object *o)
     else
       ry = asin(-v1[2]);
 
-  if(cos(ry) != 0)
+  if(fabs(cos(ry)) > AY_EPSILON)
     {
       rx = atan2(v2[2], v3[2]);
       rz = atan2(v1[1], v1[0]);
     }
   else
     {
-      rx = atan2(v2[0], v2[1]);
+      rx = atan2(sin(ry)*v2[0], v2[1]);
       rz = 0;
     }
 
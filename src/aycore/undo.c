@@ -18,13 +18,55 @@
 #define UNDO_DBG 1
 */
 
+/* every AY_UNDOCHECKPOINT states of an object, its control points
+   are saved completely, not as difference to the previous state */
+#define AY_UNDOCHECKPOINT 8
+
+/* changed coordinate ranges separated by less than AY_UNDOGAP
+   unchanged values are merged */
+#define AY_UNDOGAP 8
+
 /* types local to this module */
+
+/* control points of an undo copy; instead of storing all control
+   points for every state, only the ranges that changed with regard
+   to the previous state of the same object (the base) are stored;
+   furthermore, if the other properties of the object did not change,
+   the undo copy shares the type specific part (refine) with the undo
+   copy of the base */
+typedef struct ay_undo_cv_s
+{
+  struct ay_undo_cv_s *next;
+  ay_object *copy; /* undo copy whose control points are stored here */
+  ay_object *orig; /* the original object */
+  struct ay_undo_cv_s *base; /* previous state, NULL for checkpoints */
+  int depth; /* number of states since the last checkpoint */
+  int len; /* total number of coordinate values */
+  int nranges; /* number of changed ranges */
+  int *ranges; /* start and length of changed ranges [nranges*2] */
+  int ndata; /* number of stored coordinate values */
+  double *data; /* all [len] or just the changed coordinate values */
+  int *refs; /* number of undo copies sharing copy->refine, NULL if
+		copy->refine is not shared */
+} ay_undo_cv;
+
+/* sequential walk through the coordinate values of a saved state
+   without reconstructing them (see ay_undo_getcvrun()) */
+typedef struct ay_undo_cvwalk_s
+{
+  int n; /* number of states from the saved state to its checkpoint */
+  ay_undo_cv *cvs[AY_UNDOCHECKPOINT]; /* the states, newest first */
+  int range[AY_UNDOCHECKPOINT]; /* current range of each state */
+  int offset[AY_UNDOCHECKPOINT]; /* data offset of the current range */
+} ay_undo_cvwalk;
+
 typedef struct ay_undo_object_s
 {
   char *operation;
   ay_object *objects;
   ay_list_object *references;
   int saved_children;
+  ay_undo_cv *cvs; /* control points of the objects, in the same order */
 } ay_undo_object;
 
 /* prototypes of functions local to this module */
@@ -58,6 +100,34 @@ int ay_undo_save(int save_children);
 
 int ay_undo_copysave(ay_object *src, ay_object **dst);
 
+double **ay_undo_getcvptr(ay_object *o, int *len);
+
+size_t ay_undo_cvsize(ay_undo_cv *cv);
+
+void ay_undo_freecv(ay_undo_cv *cv);
+
+void ay_undo_applycv(ay_undo_cv *cv, double *cv_out);
+
+void ay_undo_getcv(ay_undo_cv *cv, double *cv_out);
+
+int ay_undo_makecheckpoint(ay_undo_cv *cv);
+
+int ay_undo_detach(int slot);
+
+int ay_undo_sameprops(ay_object *o, ay_object *c);
+
+void ay_undo_initcvwalk(ay_undo_cv *cv, ay_undo_cvwalk *w);
+
+int ay_undo_getcvrun(ay_undo_cvwalk *w, int i, double **values);
+
+int ay_undo_savecv(ay_object *o, ay_object *copy, ay_undo_cv **result);
+
+void ay_undo_dropoldest(void);
+
+void ay_undo_checkmemory(void);
+
+int ay_undo_savestate(int save_children);
+
 /* global variables */
 static ay_undo_object *undo_buffer;
 
@@ -70,6 +140,14 @@ static int undo_last_op; /* last undo operation: -1: no op,
 
 static char *undo_saved_op; /* name of saved modelling operation */
 
+static size_t undo_memory; /* memory used by saved control points */
+
+/* while saving: maps original objects to their control points in the
+   previous undo state, and where to link the next control points */
+static Tcl_HashTable undo_basecvstable, *undo_basecvs;
+
+static ay_undo_cv **undo_nextcv;
+
 /* functions */
 
 /* ay_undo_init:
@@ -100,6 +178,7 @@ ay_undo_init(int buffer_size)
 
   undo_current = -1;
   undo_buffer_size = buffer_size;
+  undo_memory = 0;
 
   undo_last_op = -1; /* no op */
 
@@ -151,7 +230,9 @@ ay_undo_deletemulti(ay_object *o)
 	default:
 	  arr = ay_deletecbt.arr;
 	  dcb = (ay_deletecb*)(arr[d->type]);
-	  if(dcb)
+	  /* refine is NULL if it is still in use by another undo copy
+	     (see ay_undo_freecv()) */
+	  if(dcb && d->refine)
 	    (void)dcb(d->refine);
 	  break;
 	} /* switch */
@@ -185,6 +266,14 @@ void
 ay_undo_clearuo(ay_undo_object *uo)
 {
  ay_list_object *lo = NULL;
+ ay_undo_cv *cv = NULL;
+
+  while(uo->cvs)
+    {
+      cv = uo->cvs->next;
+      ay_undo_freecv(uo->cvs);
+      uo->cvs = cv;
+    }
 
   while(uo->references)
     {
@@ -209,6 +298,809 @@ ay_undo_clearuo(ay_undo_object *uo)
 } /* ay_undo_clearuo */
 
 
+/* ay_undo_getcvptr:
+ *  get the address of the control point array of object <o>
+ *  and the number of coordinate values in it;
+ *  returns NULL for objects without (supported) control points
+ */
+double **
+ay_undo_getcvptr(ay_object *o, int *len)
+{
+ ay_nurbpatch_object *np;
+ ay_nurbcurve_object *nc;
+ ay_pamesh_object *pm;
+ ay_pomesh_object *po;
+ ay_sdmesh_object *sd;
+ ay_icurve_object *ic;
+ ay_acurve_object *ac;
+ ay_ipatch_object *ip;
+ ay_apatch_object *ap;
+
+  if(!o->refine)
+    return NULL;
+
+  switch(o->type)
+    {
+    case AY_IDNPATCH:
+      np = (ay_nurbpatch_object *)o->refine;
+      *len = np->width*np->height*4;
+      return &(np->controlv);
+    case AY_IDNCURVE:
+      nc = (ay_nurbcurve_object *)o->refine;
+      *len = nc->length*4;
+      return &(nc->controlv);
+    case AY_IDPAMESH:
+      pm = (ay_pamesh_object *)o->refine;
+      *len = pm->width*pm->height*4;
+      return &(pm->controlv);
+    case AY_IDPOMESH:
+      po = (ay_pomesh_object *)o->refine;
+      *len = po->ncontrols*(po->has_normals?6:3);
+      return &(po->controlv);
+    case AY_IDSDMESH:
+      sd = (ay_sdmesh_object *)o->refine;
+      *len = sd->ncontrols*3;
+      return &(sd->controlv);
+    case AY_IDICURVE:
+      ic = (ay_icurve_object *)o->refine;
+      *len = ic->length*3;
+      return &(ic->controlv);
+    case AY_IDACURVE:
+      ac = (ay_acurve_object *)o->refine;
+      *len = ac->length*3;
+      return &(ac->controlv);
+    case AY_IDIPATCH:
+      ip = (ay_ipatch_object *)o->refine;
+      *len = ip->width*ip->height*3;
+      return &(ip->controlv);
+    case AY_IDAPATCH:
+      ap = (ay_apatch_object *)o->refine;
+      *len = ap->width*ap->height*3;
+      return &(ap->controlv);
+    default:
+      break;
+    } /* switch */
+
+ return NULL;
+} /* ay_undo_getcvptr */
+
+
+/* ay_undo_cvsize:
+ *  calculate the memory used by the saved control points <cv>
+ */
+size_t
+ay_undo_cvsize(ay_undo_cv *cv)
+{
+ return sizeof(ay_undo_cv) + cv->ndata*sizeof(double) +
+   cv->nranges*2*sizeof(int);
+} /* ay_undo_cvsize */
+
+
+/* ay_undo_freecv:
+ *  free the saved control points <cv>
+ */
+void
+ay_undo_freecv(ay_undo_cv *cv)
+{
+
+  undo_memory -= ay_undo_cvsize(cv);
+
+  /* the last undo copy that shares the type specific part frees it
+     (in ay_undo_deletemulti()), all others just let go of it */
+  if(cv->refs)
+    {
+      (*(cv->refs))--;
+      if(*(cv->refs) > 0)
+	cv->copy->refine = NULL;
+      else
+	free(cv->refs);
+    }
+
+  if(cv->ranges)
+    free(cv->ranges);
+
+  if(cv->data)
+    free(cv->data);
+
+  free(cv);
+
+ return;
+} /* ay_undo_freecv */
+
+
+/* ay_undo_applycv:
+ *  copy the changed ranges of <cv> to <cv_out>
+ */
+void
+ay_undo_applycv(ay_undo_cv *cv, double *cv_out)
+{
+ int i;
+ double *d = cv->data;
+
+  for(i = 0; i < cv->nranges; i++)
+    {
+      memcpy(&(cv_out[cv->ranges[i*2]]), d,
+	     cv->ranges[i*2+1]*sizeof(double));
+      d += cv->ranges[i*2+1];
+    }
+
+ return;
+} /* ay_undo_applycv */
+
+
+/* ay_undo_getcv:
+ *  reconstruct all control points of <cv> in <cv_out>
+ *  (which must have room for cv->len values)
+ */
+void
+ay_undo_getcv(ay_undo_cv *cv, double *cv_out)
+{
+
+  if(!cv->base)
+    {
+      memcpy(cv_out, cv->data, cv->len*sizeof(double));
+      return;
+    }
+
+  ay_undo_getcv(cv->base, cv_out);
+  ay_undo_applycv(cv, cv_out);
+
+ return;
+} /* ay_undo_getcv */
+
+
+/* ay_undo_makecheckpoint:
+ *  store all control points of <cv>, because its base is about
+ *  to be freed; if the base is a checkpoint, its coordinate values
+ *  are taken over, so that this does not need additional memory
+ */
+int
+ay_undo_makecheckpoint(ay_undo_cv *cv)
+{
+ ay_undo_cv *base = cv->base;
+ double *full;
+
+  if(!base)
+    return AY_OK;
+
+  undo_memory -= ay_undo_cvsize(cv) + ay_undo_cvsize(base);
+
+  if(!base->base && base->data)
+    {
+      full = base->data;
+      base->data = NULL;
+      base->ndata = 0;
+      ay_undo_applycv(cv, full);
+    }
+  else
+    {
+      if(!(full = malloc(cv->len*sizeof(double))))
+	{
+	  undo_memory += ay_undo_cvsize(cv) + ay_undo_cvsize(base);
+	  return AY_EOMEM;
+	}
+      ay_undo_getcv(cv, full);
+    }
+
+  if(cv->ranges)
+    free(cv->ranges);
+  if(cv->data)
+    free(cv->data);
+
+  cv->ranges = NULL;
+  cv->nranges = 0;
+  cv->data = full;
+  cv->ndata = cv->len;
+  cv->base = NULL;
+  cv->depth = 0;
+
+  undo_memory += ay_undo_cvsize(cv) + ay_undo_cvsize(base);
+
+ return AY_OK;
+} /* ay_undo_makecheckpoint */
+
+
+/* ay_undo_detach:
+ *  make the control points of undo state <slot>+1 independent
+ *  from undo state <slot> (that is going to be cleared)
+ */
+int
+ay_undo_detach(int slot)
+{
+ int ay_status = AY_OK;
+ ay_undo_cv *cv;
+
+  if(slot < 0 || slot+1 >= undo_buffer_size)
+    return AY_OK;
+
+  cv = undo_buffer[slot+1].cvs;
+  while(cv)
+    {
+      if(cv->base)
+	{
+	  ay_status = ay_undo_makecheckpoint(cv);
+	  if(ay_status)
+	    return ay_status;
+	}
+      cv = cv->next;
+    }
+
+ return AY_OK;
+} /* ay_undo_detach */
+
+
+/* ay_undo_sameprops:
+ *  check whether all properties of object <o> but the control points
+ *  and cached data equal those of the undo copy <c> of a previous
+ *  state of <o>; this compares the type specific structures with all
+ *  pointers and caches masked out, and then the arrays pointed to
+ *  (differences in unused padding bytes may lead to false negatives,
+ *  which is harmless)
+ */
+int
+ay_undo_sameprops(ay_object *o, ay_object *c)
+{
+ union {
+   ay_nurbpatch_object np;
+   ay_nurbcurve_object nc;
+   ay_pamesh_object pm;
+   ay_pomesh_object po;
+   ay_sdmesh_object sd;
+   ay_icurve_object ic;
+   ay_acurve_object ac;
+   ay_ipatch_object ip;
+   ay_apatch_object ap;
+ } a, b;
+ ay_nurbpatch_object *np1, *np2;
+ ay_nurbcurve_object *nc1, *nc2;
+ ay_pamesh_object *pm1, *pm2;
+ ay_pomesh_object *po1, *po2;
+ ay_sdmesh_object *sd1, *sd2;
+ ay_ipatch_object *ip1, *ip2;
+ unsigned int i, n, m, k;
+ size_t size;
+
+  if(!o->refine || !c->refine || (o->type != c->type))
+    return AY_FALSE;
+
+  switch(o->type)
+    {
+    case AY_IDNPATCH:
+      size = sizeof(ay_nurbpatch_object);
+      break;
+    case AY_IDNCURVE:
+      size = sizeof(ay_nurbcurve_object);
+      break;
+    case AY_IDPAMESH:
+      size = sizeof(ay_pamesh_object);
+      break;
+    case AY_IDPOMESH:
+      size = sizeof(ay_pomesh_object);
+      break;
+    case AY_IDSDMESH:
+      size = sizeof(ay_sdmesh_object);
+      break;
+    case AY_IDICURVE:
+      size = sizeof(ay_icurve_object);
+      break;
+    case AY_IDACURVE:
+      size = sizeof(ay_acurve_object);
+      break;
+    case AY_IDIPATCH:
+      size = sizeof(ay_ipatch_object);
+      break;
+    case AY_IDAPATCH:
+      size = sizeof(ay_apatch_object);
+      break;
+    default:
+      return AY_FALSE;
+    } /* switch */
+
+  memcpy(&a, o->refine, size);
+  memcpy(&b, c->refine, size);
+
+  /* mask out pointers and caches */
+  switch(o->type)
+    {
+    case AY_IDNPATCH:
+      np1 = &(a.np);
+      np2 = &(b.np);
+      np1->controlv = NULL; np1->uknotv = NULL; np1->vknotv = NULL;
+      np1->breakv = NULL; np1->no = NULL; np1->fltcv = NULL;
+      np1->lods = NULL; np1->caps_and_bevels = NULL; np1->mpoints = NULL;
+      memset(np1->stess, 0, 2*sizeof(ay_stess_patch));
+      np2->controlv = NULL; np2->uknotv = NULL; np2->vknotv = NULL;
+      np2->breakv = NULL; np2->no = NULL; np2->fltcv = NULL;
+      np2->lods = NULL; np2->caps_and_bevels = NULL; np2->mpoints = NULL;
+      memset(np2->stess, 0, 2*sizeof(ay_stess_patch));
+      break;
+    case AY_IDNCURVE:
+      nc1 = &(a.nc);
+      nc2 = &(b.nc);
+      nc1->controlv = NULL; nc1->knotv = NULL; nc1->breakv = NULL;
+      nc1->no = NULL; nc1->fltcv = NULL; nc1->mpoints = NULL;
+      memset(nc1->stess, 0, 2*sizeof(ay_stess_curve));
+      nc2->controlv = NULL; nc2->knotv = NULL; nc2->breakv = NULL;
+      nc2->no = NULL; nc2->fltcv = NULL; nc2->mpoints = NULL;
+      memset(nc2->stess, 0, 2*sizeof(ay_stess_curve));
+      break;
+    case AY_IDPAMESH:
+      pm1 = &(a.pm);
+      pm2 = &(b.pm);
+      pm1->controlv = NULL; pm1->ubasis = NULL; pm1->vbasis = NULL;
+      pm1->npatch = NULL; pm1->caps_and_bevels = NULL;
+      pm2->controlv = NULL; pm2->ubasis = NULL; pm2->vbasis = NULL;
+      pm2->npatch = NULL; pm2->caps_and_bevels = NULL;
+      break;
+    case AY_IDPOMESH:
+      po1 = &(a.po);
+      po2 = &(b.po);
+      po1->nloops = NULL; po1->nverts = NULL; po1->verts = NULL;
+      po1->controlv = NULL; po1->face_normals = NULL;
+      po2->nloops = NULL; po2->nverts = NULL; po2->verts = NULL;
+      po2->controlv = NULL; po2->face_normals = NULL;
+      break;
+    case AY_IDSDMESH:
+      sd1 = &(a.sd);
+      sd2 = &(b.sd);
+      sd1->nverts = NULL; sd1->verts = NULL; sd1->tags = NULL;
+      sd1->nargs = NULL; sd1->intargs = NULL; sd1->floatargs = NULL;
+      sd1->controlv = NULL; sd1->pomesh = NULL; sd1->face_normals = NULL;
+      sd2->nverts = NULL; sd2->verts = NULL; sd2->tags = NULL;
+      sd2->nargs = NULL; sd2->intargs = NULL; sd2->floatargs = NULL;
+      sd2->controlv = NULL; sd2->pomesh = NULL; sd2->face_normals = NULL;
+      break;
+    case AY_IDICURVE:
+      a.ic.controlv = NULL; a.ic.ncurve = NULL;
+      b.ic.controlv = NULL; b.ic.ncurve = NULL;
+      break;
+    case AY_IDACURVE:
+      a.ac.controlv = NULL; a.ac.ncurve = NULL;
+      b.ac.controlv = NULL; b.ac.ncurve = NULL;
+      break;
+    case AY_IDIPATCH:
+      ip1 = &(a.ip);
+      ip2 = &(b.ip);
+      ip1->controlv = NULL; ip1->sderiv_u = NULL; ip1->ederiv_u = NULL;
+      ip1->sderiv_v = NULL; ip1->ederiv_v = NULL;
+      ip1->npatch = NULL; ip1->caps_and_bevels = NULL;
+      ip2->controlv = NULL; ip2->sderiv_u = NULL; ip2->ederiv_u = NULL;
+      ip2->sderiv_v = NULL; ip2->ederiv_v = NULL;
+      ip2->npatch = NULL; ip2->caps_and_bevels = NULL;
+      break;
+    case AY_IDAPATCH:
+      a.ap.controlv = NULL; a.ap.npatch = NULL; a.ap.caps_and_bevels = NULL;
+      b.ap.controlv = NULL; b.ap.npatch = NULL; b.ap.caps_and_bevels = NULL;
+      break;
+    default:
+      break;
+    } /* switch */
+
+  if(memcmp(&a, &b, size))
+    return AY_FALSE;
+
+  /* compare the arrays */
+#define AY_UNDOCMPARR(p1, p2, n) \
+  if(((p1) != (p2)) && (!(p1) || !(p2) || memcmp((p1), (p2), (n)))) \
+    return AY_FALSE;
+
+  switch(o->type)
+    {
+    case AY_IDNPATCH:
+      np1 = (ay_nurbpatch_object *)o->refine;
+      np2 = (ay_nurbpatch_object *)c->refine;
+      AY_UNDOCMPARR(np1->uknotv, np2->uknotv,
+		    (np1->width+np1->uorder)*sizeof(double));
+      AY_UNDOCMPARR(np1->vknotv, np2->vknotv,
+		    (np1->height+np1->vorder)*sizeof(double));
+      break;
+    case AY_IDNCURVE:
+      nc1 = (ay_nurbcurve_object *)o->refine;
+      nc2 = (ay_nurbcurve_object *)c->refine;
+      AY_UNDOCMPARR(nc1->knotv, nc2->knotv,
+		    (nc1->length+nc1->order)*sizeof(double));
+      break;
+    case AY_IDPAMESH:
+      pm1 = (ay_pamesh_object *)o->refine;
+      pm2 = (ay_pamesh_object *)c->refine;
+      AY_UNDOCMPARR(pm1->ubasis, pm2->ubasis, 16*sizeof(double));
+      AY_UNDOCMPARR(pm1->vbasis, pm2->vbasis, 16*sizeof(double));
+      break;
+    case AY_IDPOMESH:
+      po1 = (ay_pomesh_object *)o->refine;
+      po2 = (ay_pomesh_object *)c->refine;
+      AY_UNDOCMPARR(po1->nloops, po2->nloops,
+		    po1->npolys*sizeof(unsigned int));
+      n = 0;
+      if(po1->nloops)
+	for(i = 0; i < po1->npolys; i++)
+	  n += po1->nloops[i];
+      AY_UNDOCMPARR(po1->nverts, po2->nverts, n*sizeof(unsigned int));
+      m = 0;
+      if(po1->nverts)
+	for(i = 0; i < n; i++)
+	  m += po1->nverts[i];
+      AY_UNDOCMPARR(po1->verts, po2->verts, m*sizeof(unsigned int));
+      break;
+    case AY_IDSDMESH:
+      sd1 = (ay_sdmesh_object *)o->refine;
+      sd2 = (ay_sdmesh_object *)c->refine;
+      AY_UNDOCMPARR(sd1->nverts, sd2->nverts,
+		    sd1->nfaces*sizeof(unsigned int));
+      n = 0;
+      if(sd1->nverts)
+	for(i = 0; i < sd1->nfaces; i++)
+	  n += sd1->nverts[i];
+      AY_UNDOCMPARR(sd1->verts, sd2->verts, n*sizeof(unsigned int));
+      AY_UNDOCMPARR(sd1->tags, sd2->tags, sd1->ntags*sizeof(int));
+      AY_UNDOCMPARR(sd1->nargs, sd2->nargs,
+		    sd1->ntags*2*sizeof(unsigned int));
+      m = 0;
+      k = 0;
+      if(sd1->nargs)
+	for(i = 0; i < sd1->ntags; i++)
+	  {
+	    m += sd1->nargs[i*2];
+	    k += sd1->nargs[i*2+1];
+	  }
+      AY_UNDOCMPARR(sd1->intargs, sd2->intargs, m*sizeof(int));
+      AY_UNDOCMPARR(sd1->floatargs, sd2->floatargs, k*sizeof(double));
+      break;
+    case AY_IDIPATCH:
+      ip1 = (ay_ipatch_object *)o->refine;
+      ip2 = (ay_ipatch_object *)c->refine;
+      AY_UNDOCMPARR(ip1->sderiv_u, ip2->sderiv_u,
+		    ip1->height*3*sizeof(double));
+      AY_UNDOCMPARR(ip1->ederiv_u, ip2->ederiv_u,
+		    ip1->height*3*sizeof(double));
+      AY_UNDOCMPARR(ip1->sderiv_v, ip2->sderiv_v,
+		    ip1->width*3*sizeof(double));
+      AY_UNDOCMPARR(ip1->ederiv_v, ip2->ederiv_v,
+		    ip1->width*3*sizeof(double));
+      break;
+    default:
+      break;
+    } /* switch */
+
+#undef AY_UNDOCMPARR
+
+ return AY_TRUE;
+} /* ay_undo_sameprops */
+
+
+/* ay_undo_initcvwalk:
+ *  prepare a sequential walk <w> through the coordinate values
+ *  of the saved state <cv>
+ */
+void
+ay_undo_initcvwalk(ay_undo_cv *cv, ay_undo_cvwalk *w)
+{
+
+  w->n = 0;
+  while(cv && (w->n < AY_UNDOCHECKPOINT))
+    {
+      w->cvs[w->n] = cv;
+      w->range[w->n] = 0;
+      w->offset[w->n] = 0;
+      w->n++;
+      cv = cv->base;
+    }
+
+ return;
+} /* ay_undo_initcvwalk */
+
+
+/* ay_undo_getcvrun:
+ *  get the coordinate values starting at index <i> of a saved state
+ *  from the newest state that changed them (or the checkpoint);
+ *  returns the number of consecutive values that may be read
+ *  from <values>; <i> must not decrease between calls
+ */
+int
+ay_undo_getcvrun(ay_undo_cvwalk *w, int i, double **values)
+{
+ ay_undo_cv *cv;
+ int j, end, *r;
+
+  cv = w->cvs[w->n-1];
+  end = cv->len;
+  *values = &(cv->data[i]);
+
+  for(j = 0; j < w->n-1; j++)
+    {
+      cv = w->cvs[j];
+
+      /* skip the ranges before <i> */
+      while((w->range[j] < cv->nranges) &&
+	    (cv->ranges[w->range[j]*2] + cv->ranges[w->range[j]*2+1] <= i))
+	{
+	  w->offset[j] += cv->ranges[w->range[j]*2+1];
+	  w->range[j]++;
+	}
+
+      if(w->range[j] == cv->nranges)
+	continue;
+
+      r = &(cv->ranges[w->range[j]*2]);
+      if(r[0] <= i)
+	{
+	  /* this is the newest state that changed <i> */
+	  if(r[0] + r[1] < end)
+	    end = r[0] + r[1];
+	  *values = &(cv->data[w->offset[j] + i - r[0]]);
+	  break;
+	}
+
+      /* values from older states are valid up to the next range */
+      if(r[0] < end)
+	end = r[0];
+    } /* for */
+
+ return end - i;
+} /* ay_undo_getcvrun */
+
+
+/* ay_undo_savecv:
+ *  save the control points of object <o> for its undo copy <copy>
+ *  and copy the other type specific properties to <copy>;
+ *  if the previous undo state contains the same object with the same
+ *  number of control points, the live control points are compared to
+ *  the saved ones and just the changed ranges are saved, also, if
+ *  the other properties did not change, the type specific part of
+ *  the previous undo copy is shared; all control points and
+ *  properties are only copied for checkpoints;
+ *  the new control points are returned in <result>, to be linked to
+ *  the undo state currently being saved by the caller
+ */
+int
+ay_undo_savecv(ay_object *o, ay_object *copy, ay_undo_cv **result)
+{
+ int ay_status = AY_OK;
+ char fname[] = "undo_savecv";
+ Tcl_HashEntry *entry;
+ ay_undo_cv *cv, *base = NULL;
+ ay_undo_cvwalk w;
+ ay_voidfp *arr = NULL;
+ ay_copycb *cb = NULL;
+ double **cvptr, *cvn, *cvb, *d;
+ int len = 0, i, j, k, run, last, pass, nranges = 0, ndata = 0;
+ int *ranges = NULL;
+
+  if(!(cvptr = ay_undo_getcvptr(o, &len)) || !*cvptr || len <= 0)
+    return AY_ERROR;
+
+  cvn = *cvptr;
+
+  if(!(cv = calloc(1, sizeof(ay_undo_cv))))
+    return AY_EOMEM;
+
+  cv->copy = copy;
+  cv->orig = o;
+  cv->len = len;
+
+  /* find the control points of the previous state of the object;
+     each saved state may serve as base for just one other state */
+  if(undo_basecvs &&
+     (entry = Tcl_FindHashEntry(undo_basecvs, (char*)o)))
+    {
+      base = (ay_undo_cv *)Tcl_GetHashValue(entry);
+      Tcl_DeleteHashEntry(entry);
+      if((base->len != len) || (base->depth+1 >= AY_UNDOCHECKPOINT) ||
+	 (base->copy->type != o->type))
+	base = NULL;
+    }
+
+  if(base)
+    {
+      /* find the changed ranges (first count, then fill) */
+      for(pass = 0; pass < 2; pass++)
+	{
+	  ay_undo_initcvwalk(base, &w);
+	  k = 0;
+	  ndata = 0;
+	  last = -1;
+	  i = 0;
+	  while(i < len)
+	    {
+	      run = ay_undo_getcvrun(&w, i, &cvb);
+
+	      /* skip unchanged runs quickly */
+	      if(!memcmp(cvb, &(cvn[i]), run*sizeof(double)))
+		{
+		  i += run;
+		  continue;
+		}
+
+	      for(j = 0; j < run; j++, i++)
+		{
+		  if(cvb[j] == cvn[i])
+		    continue;
+
+		  if((last < 0) || (i - last > AY_UNDOGAP))
+		    {
+		      /* start a new range */
+		      if(ranges)
+			{
+			  ranges[k*2] = i;
+			  ranges[k*2+1] = 1;
+			}
+		      k++;
+		      ndata++;
+		    }
+		  else
+		    {
+		      /* extend the current range */
+		      if(ranges)
+			ranges[(k-1)*2+1] += i - last;
+		      ndata += i - last;
+		    }
+		  last = i;
+		} /* for */
+	    } /* while */
+
+	  nranges = k;
+
+	  if(pass == 0)
+	    {
+	      /* a difference would not save enough memory? */
+	      if((ndata*sizeof(double) + nranges*2*sizeof(int)) >
+		 (len*sizeof(double))/2)
+		break;
+
+	      if(nranges &&
+		 !(ranges = malloc(nranges*2*sizeof(int))))
+		break;
+
+	      if(ndata &&
+		 !(cv->data = malloc(ndata*sizeof(double))))
+		{
+		  free(ranges);
+		  ranges = NULL;
+		  break;
+		}
+	    } /* if */
+	} /* for */
+
+      if(pass == 2)
+	{
+	  cv->base = base;
+	  cv->depth = base->depth+1;
+	  cv->nranges = nranges;
+	  cv->ranges = ranges;
+	  cv->ndata = ndata;
+
+	  d = cv->data;
+	  for(i = 0; i < nranges; i++)
+	    {
+	      memcpy(d, &(cvn[ranges[i*2]]), ranges[i*2+1]*sizeof(double));
+	      d += ranges[i*2+1];
+	    }
+	} /* if */
+    } /* if */
+
+  if(!cv->base)
+    {
+      /* save a checkpoint */
+      if(!(cv->data = malloc(len*sizeof(double))))
+	{
+	  free(cv);
+	  return AY_EOMEM;
+	}
+      memcpy(cv->data, cvn, len*sizeof(double));
+      cv->ndata = len;
+    }
+
+  /* save the other type specific properties */
+  if(cv->base && ay_undo_sameprops(o, base->copy))
+    {
+      /* unchanged, share them with the previous undo copy */
+      if(!base->refs)
+	{
+	  if(!(base->refs = malloc(sizeof(int))))
+	    {
+	      ay_status = AY_EOMEM;
+	      goto cleanup;
+	    }
+	  *(base->refs) = 1;
+	}
+      cv->refs = base->refs;
+      (*(cv->refs))++;
+      copy->refine = base->copy->refine;
+    }
+  else
+    {
+      /* copy them (without the control points) */
+      arr = ay_copycbt.arr;
+      cb = (ay_copycb*)(arr[o->type]);
+      if(!cb)
+	{
+	  ay_status = AY_ERROR;
+	  goto cleanup;
+	}
+      *cvptr = NULL;
+      ay_status = cb(o->refine, &(copy->refine));
+      *cvptr = cvn;
+      if(ay_status)
+	{
+	  ay_error(AY_ERROR, fname, "copy callback failed");
+	  goto cleanup;
+	}
+    } /* if */
+
+  undo_memory += ay_undo_cvsize(cv);
+
+  *result = cv;
+
+  /* prevent cleanup code from doing something harmful */
+  cv = NULL;
+
+cleanup:
+
+  if(cv)
+    {
+      if(cv->ranges)
+	free(cv->ranges);
+      if(cv->data)
+	free(cv->data);
+      free(cv);
+    }
+
+ return ay_status;
+} /* ay_undo_savecv */
+
+
+/* ay_undo_dropoldest:
+ *  clear the oldest undo state and shift all states down,
+ *  so that the top of the undo buffer is empty again
+ */
+void
+ay_undo_dropoldest(void)
+{
+ int i;
+
+  /* this can not fail, as the oldest state only contains checkpoints
+     whose coordinate values are simply taken over */
+  (void)ay_undo_detach(0);
+
+  ay_undo_clearuo(&(undo_buffer[0]));
+
+  for(i = 0; i < undo_buffer_size-1; i++)
+    {
+      undo_buffer[i] = undo_buffer[i+1];
+    }
+
+  memset(&(undo_buffer[undo_buffer_size-1]), 0, sizeof(ay_undo_object));
+
+ return;
+} /* ay_undo_dropoldest */
+
+
+/* ay_undo_checkmemory:
+ *  drop the oldest undo states until the memory used by the
+ *  saved control points fits into the budget set by the
+ *  UndoMemory preference setting (in MB, 0 means unlimited);
+ *  at least the most recently saved state is always kept
+ */
+void
+ay_undo_checkmemory(void)
+{
+ size_t limit;
+
+  if(ay_prefs.undo_memory <= 0)
+    return;
+
+  limit = (size_t)ay_prefs.undo_memory*1024*1024;
+
+  while((undo_memory > limit) && (undo_current > 0))
+    {
+      ay_undo_dropoldest();
+      undo_current--;
+    }
+
+ return;
+} /* ay_undo_checkmemory */
+
+
 /* ay_undo_copymat:
  */
 int
@@ -494,12 +1386,16 @@ ay_undo_copy(ay_undo_object *uo)
  ay_object *parent = NULL;
  Tk_Window win;
  char *winpath = NULL;
+ ay_undo_cv *cv = NULL;
+ double **cvptr = NULL;
+ int len;
 
   if(!uo)
     return AY_OK;
 
   r = uo->references;
   c = uo->objects;
+  cv = uo->cvs;
   while(r)
     {
       o = r->object;
@@ -627,6 +1523,19 @@ ay_undo_copy(ay_undo_object *uo)
 	    }
 	  break;
 	default:
+	  /* temporarily restore the control points of the undo copy */
+	  cvptr = NULL;
+	  if(cv && (cv->copy == c))
+	    {
+	      cvptr = ay_undo_getcvptr(c, &len);
+	      if(cvptr)
+		{
+		  if(!(*cvptr = malloc(cv->len*sizeof(double))))
+		    return AY_EOMEM;
+		  ay_undo_getcv(cv, *cvptr);
+		}
+	    }
+
 	  arr = ay_deletecbt.arr;
 	  dcb = (ay_deletecb*)(arr[o->type]);
 	  if(dcb)
@@ -637,17 +1546,40 @@ ay_undo_copy(ay_undo_object *uo)
 	  if(ccb)
 	    {
 	      ay_status = ccb(c->refine, &(o->refine));
-	      if(ay_status)
+	    }
+
+	  if(cvptr)
+	    {
+	      free(*cvptr);
+	      *cvptr = NULL;
+
+	      /* undo copies are made without multiple points */
+	      if(!ay_status && o->refine)
 		{
-		  return ay_status;
+		  if(o->type == AY_IDNPATCH)
+		    ay_npt_recreatemp((ay_nurbpatch_object *)o->refine);
+		  if(o->type == AY_IDNCURVE)
+		    ay_nct_recreatemp((ay_nurbcurve_object *)o->refine);
 		}
 	    }
+
+	  if(ay_status)
+	    {
+	      return ay_status;
+	    }
 	  break;
 	} /* switch */
 
       /* copy trafos */
       ay_trafo_copy(c, o);
 
+      /* cached provide results are outdated now */
+      ay_provide_uncache(o);
+
+      /* instances may have been retargeted */
+      if(o->type == AY_IDINSTANCE)
+	ay_notify_invalidate(NULL);
+
       if(o->type != AY_IDMATERIAL)
 	{
 	  /* copy material */
@@ -699,6 +1631,9 @@ ay_undo_copy(ay_undo_object *uo)
 	    }
 	} /* if */
 
+      if(cv && (cv->copy == c))
+	cv = cv->next;
+
       c = c->next;
       r = r->next;
     } /* while */
@@ -812,6 +1747,14 @@ ay_undo_rewind(int silent)
       return AY_ERROR;
     }
 
+  /* the next state should be empty, but make sure it
+     does not depend on the state to be cleared */
+  if(ay_undo_detach(undo_current))
+    {
+      ay_undo_clear();
+      return AY_ERROR;
+    }
+
   uo = &(undo_buffer[undo_current]);
   ay_undo_clearuo(uo);
 
@@ -844,6 +1787,9 @@ ay_undo_copysave(ay_object *src, ay_object **dst)
  ay_voidfp *arr = NULL;
  ay_copycb *cb = NULL;
  ay_view_object *srcview = NULL, *dstview = NULL;
+ ay_undo_cv *cv = NULL;
+ double **cvptr = NULL;
+ int len = 0;
 
   if(!src || !dst)
     return AY_ENULL;
@@ -912,6 +1858,17 @@ ay_undo_copysave(ay_object *src, ay_object **dst)
       new->refine = src->refine;
       break;
     default:
+      new->refine = NULL;
+      if(undo_nextcv && (cvptr = ay_undo_getcvptr(src, &len)) &&
+	 *cvptr && (len > 0))
+	{
+	  /* save the control points (as difference to the previous
+	     state) and the other properties separately */
+	  ay_status = ay_undo_savecv(src, new, &cv);
+	  if(ay_status)
+	    goto cleanup;
+	  break;
+	}
       arr = ay_copycbt.arr;
       cb = (ay_copycb*)(arr[src->type]);
       if(cb)
@@ -961,13 +1918,24 @@ ay_undo_copysave(ay_object *src, ay_object **dst)
 
   new->modified = AY_TRUE;
 
+  /* link the saved control points to the current undo state */
+  if(cv)
+    {
+      *undo_nextcv = cv;
+      undo_nextcv = &(cv->next);
+    }
+
   *dst = new;
 
   /* prevent cleanup code from doing something harmful */
   new = NULL;
+  cv = NULL;
 
 cleanup:
 
+  if(cv)
+    ay_undo_freecv(cv);
+
   if(new)
     {
       new->mat = NULL;
@@ -1039,10 +2007,32 @@ ay_undo_savechildren(ay_object *o, ay_undo_object *uo,
 
 
 /* ay_undo_save:
- *
+ *  save the current state of the selected objects (and views)
+ *  to the undo buffer
  */
 int
 ay_undo_save(int save_children)
+{
+ int ay_status = AY_OK;
+
+  ay_status = ay_undo_savestate(save_children);
+
+  if(undo_basecvs)
+    {
+      Tcl_DeleteHashTable(undo_basecvs);
+      undo_basecvs = NULL;
+    }
+  undo_nextcv = NULL;
+
+ return ay_status;
+} /* ay_undo_save */
+
+
+/* ay_undo_savestate:
+ *  helper for ay_undo_save() above, does the actual work
+ */
+int
+ay_undo_savestate(int save_children)
 {
  int ay_status = AY_OK;
  ay_undo_object *uo = NULL, *uo2 = NULL;
@@ -1050,6 +2040,9 @@ ay_undo_save(int save_children)
  ay_object **nexto = NULL, *view = NULL, *lso = NULL;
  ay_object *markprevsel = NULL, *saved = NULL;
  int i, prevselmarked = AY_FALSE, alreadysaved = AY_FALSE;
+ ay_undo_cv *cv = NULL;
+ Tcl_HashEntry *entry = NULL;
+ int new_item = 0;
 
   if((!sel) && (!ay_root->down->next))
     return AY_OK;
@@ -1062,22 +2055,7 @@ ay_undo_save(int save_children)
        * of the undo buffer is empty again
        */
 
-      /* clear oldest state */
-      uo = &(undo_buffer[0]);
-      ay_undo_clearuo(uo);
-      /* shift all states down */
-      for(i = 0; i < undo_buffer_size-1; i++)
-	{
-	  uo = &(undo_buffer[i]);
-	  uo2 = &(undo_buffer[i+1]);
-
-	  uo->objects = uo2->objects;
-	  uo->references = uo2->references;
-	  uo->operation = uo2->operation;
-	}
-      uo = &(undo_buffer[undo_buffer_size-1]);
-      uo->objects = NULL;
-      uo->references = NULL;
+      ay_undo_dropoldest();
     }
   else
     {
@@ -1116,9 +2094,28 @@ ay_undo_save(int save_children)
   /* check, whether the current undo slot contains saved objects */
   if(uo->objects)
     { /* yes, free them */
+      if(ay_undo_detach(undo_current))
+	return AY_EOMEM;
       ay_undo_clearuo(uo);
     }
 
+  /* the control points of the previous state serve as base
+     for the control points of this state */
+  undo_nextcv = &(uo->cvs);
+  if(undo_current > 0 && undo_buffer[undo_current-1].cvs)
+    {
+      Tcl_InitHashTable(&undo_basecvstable, TCL_ONE_WORD_KEYS);
+      undo_basecvs = &undo_basecvstable;
+      cv = undo_buffer[undo_current-1].cvs;
+      while(cv)
+	{
+	  entry = Tcl_CreateHashEntry(undo_basecvs, (char*)cv->orig,
+				      &new_item);
+	  Tcl_SetHashValue(entry, (ClientData)cv);
+	  cv = cv->next;
+	}
+    }
+
   /* finally, we may copy objects (and save references to the original
    * objects) to the undo buffer */
 
@@ -1320,7 +2317,7 @@ ay_undo_save(int save_children)
   undo_last_op = 2;
 
  return AY_OK;
-} /* ay_undo_save */
+} /* ay_undo_savestate */
 
 
 /* ay_undo_clear:
@@ -1366,6 +2363,7 @@ ay_undo_clearobj(ay_object *o)
  ay_object *no_master = NULL;
  ay_list_object **lr = NULL, *r = NULL;
  ay_tag *tag = NULL, **lasttag;
+ ay_undo_cv **lcv = NULL, *cv = NULL, *dcv = NULL;
 
   tag = o->tags;
   while(tag)
@@ -1407,6 +2405,30 @@ ay_undo_clearobj(ay_object *o)
 	    }
 	  if(r->object == o)
 	    {
+	      /* remove the saved control points */
+	      lcv = &(uo->cvs);
+	      while(*lcv && ((*lcv)->copy != u))
+		lcv = &((*lcv)->next);
+	      if((cv = *lcv))
+		{
+		  /* a state in the next slot may be based on them */
+		  if(i+1 < undo_buffer_size)
+		    {
+		      dcv = undo_buffer[i+1].cvs;
+		      while(dcv)
+			{
+			  if((dcv->base == cv) && ay_undo_makecheckpoint(dcv))
+			    {
+			      ay_undo_clear();
+			      return;
+			    }
+			  dcv = dcv->next;
+			}
+		    }
+		  *lcv = cv->next;
+		  ay_undo_freecv(cv);
+		}
+
 	      *lu = u->next;
 	      *lr = r->next;
 	      u->next = NULL;
@@ -1639,7 +2661,11 @@ ay_undo_undotcmd(ClientData clientData, Tcl_Interp *interp,
 	}
       else
 	{
+	  /* keep the undo buffer within its memory budget */
+	  ay_undo_checkmemory();
 	  uc++;
+	  if(uc > undo_current+1)
+	    uc = undo_current+1;
 	  /* set undo prompt */
 	  if((undo_buffer[undo_current]).operation)
 	    Tcl_SetVar2(interp, a, n3, (undo_buffer[undo_current]).operation,
@@ -0,0 +1,775 @@
+/*
+ * Ayam, a free 3D modeler for the RenderMan interface.
+ *
+ * Ayam is copyrighted 1998-2024 by Randolf Schultz
+ * (randolf.schultz@gmail.com) and others.
+ *
+ * All rights reserved.
+ *
+ * See the file License for details.
+ *
+ */
+
+#define GL_GLEXT_PROTOTYPES 1
+#include "ayam.h"
+
+/* vbo.c - per view cache of tesselations in OpenGL vertex buffer objects */
+
+/** maximum number of frames a cached tesselation survives unused */
+#define AY_VBOMAXAGE 16
+
+/** kinds of cached tesselations */
+#define AY_VBOSTESS  0 /**< ay_stess_patch */
+#define AY_VBOPOMESH 1 /**< ay_pomesh_object */
+
+/* local types: */
+
+/** a tesselation cached in vertex buffer objects */
+typedef struct ay_vbo_entry_s {
+  unsigned int buffers[3]; /**< vertices+normals, triangle and line indices */
+  int count; /**< number of triangle indices */
+  int lcount; /**< number of line indices (0 - no lines) */
+  int kind; /**< kind of the cached tesselation (AY_VBOSTESS...) */
+  unsigned int gen; /**< generation of the cached tesselation */
+  unsigned int lastused; /**< frame in which this entry was last drawn */
+} ay_vbo_entry;
+
+/** the cache of a single view (OpenGL context) */
+typedef struct ay_vbo_cache_s {
+  Tcl_HashTable entries; /**< ay_vbo_entry, keyed by ay_stess_patch or
+			    ay_pomesh_object */
+  unsigned int frame; /**< current frame */
+  int available; /**< does the context support vertex buffer objects? */
+} ay_vbo_cache;
+
+/* global variables for this module: */
+
+/** all view caches, keyed by Togl */
+static Tcl_HashTable ay_vbo_viewsht;
+
+/** cache of the view that is currently shaded */
+static ay_vbo_cache *ay_vbo_current = NULL;
+
+/* prototypes of functions local to this module: */
+
+int ay_vbo_checkversion(void);
+
+int ay_vbo_upload(ay_stess_patch *stess, ay_vbo_entry *e);
+
+int ay_vbo_uploadpomesh(ay_pomesh_object *po, ay_vbo_entry *e);
+
+int ay_vbo_getentry(void *key, int kind, unsigned int gen,
+		    ay_vbo_entry **result);
+
+int ay_vbo_drawentry(ay_vbo_entry *e, int shade, unsigned int n, double *m);
+
+
+/* functions: */
+
+/** ay_vbo_checkversion:
+ *  check whether the current OpenGL context supports
+ *  vertex buffer objects (OpenGL 1.5)
+ *
+ * \returns AY_TRUE if vertex buffer objects may be used
+ */
+int
+ay_vbo_checkversion(void)
+{
+ const char *version;
+ int major = 0, minor = 0;
+
+  version = (const char *)glGetString(GL_VERSION);
+
+  if(!version)
+    return AY_FALSE;
+
+  if(sscanf(version, "%d.%d", &major, &minor) != 2)
+    return AY_FALSE;
+
+  if(major > 1 || (major == 1 && minor >= 5))
+    return AY_TRUE;
+
+ return AY_FALSE;
+} /* ay_vbo_checkversion */
+
+
+/** ay_vbo_upload:
+ *  convert a tesselation to triangles and load them into the
+ *  vertex buffer objects of a cache entry
+ *
+ * \param[in] stess tesselation to upload
+ * \param[in,out] e cache entry
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_vbo_upload(ay_stess_patch *stess, ay_vbo_entry *e)
+{
+#ifdef GL_VERSION_1_5
+ ay_pomesh_object *po;
+ GLfloat *vn = NULL, *pv;
+ GLuint *ind = NULL, *pi, k;
+ double *p;
+ int i, j, nv, ni, nl = 0;
+
+  if(stess->tessv)
+    {
+      nv = stess->tessw*stess->tessh;
+      ni = (stess->tessw-1)*(stess->tessh-1)*6;
+      /* the lines along both parametric directions
+	 (as drawn by ay_npatch_drawstess()) */
+      nl = (stess->tessw*(stess->tessh-1) + stess->tessh*(stess->tessw-1))*2;
+    }
+  else
+    {
+      if(!stess->pomesh)
+	return AY_ERROR;
+      po = stess->pomesh;
+      nv = (int)po->npolys*3;
+      ni = nv;
+    }
+
+  if(nv <= 0 || ni <= 0)
+    return AY_ERROR;
+
+  if(!(vn = malloc(nv*6*sizeof(GLfloat))))
+    return AY_EOMEM;
+  if(!(ind = malloc((ni+nl)*sizeof(GLuint))))
+    { free(vn); return AY_EOMEM; }
+
+  pv = vn;
+  pi = ind;
+  if(stess->tessv)
+    {
+      p = stess->tessv;
+      for(i = 0; i < nv*6; i++)
+	pv[i] = (GLfloat)p[i];
+
+      /* split the quads of the strips (as drawn by ay_npatch_shadestess())
+	 into two triangles, maintaining their orientation */
+      for(i = 0; i < stess->tessw-1; i++)
+	{
+	  for(j = 0; j < stess->tessh-1; j++)
+	    {
+	      k = (GLuint)(i*stess->tessh+j);
+	      pi[0] = k;
+	      pi[1] = k+stess->tessh;
+	      pi[2] = k+stess->tessh+1;
+	      pi[3] = k+stess->tessh+1;
+	      pi[4] = k+1;
+	      pi[5] = k;
+	      pi += 6;
+	    }
+	}
+
+      for(i = 0; i < stess->tessw; i++)
+	{
+	  for(j = 0; j < stess->tessh-1; j++)
+	    {
+	      k = (GLuint)(i*stess->tessh+j);
+	      pi[0] = k;
+	      pi[1] = k+1;
+	      pi += 2;
+	    }
+	}
+
+      for(j = 0; j < stess->tessh; j++)
+	{
+	  for(i = 0; i < stess->tessw-1; i++)
+	    {
+	      k = (GLuint)(i*stess->tessh+j);
+	      pi[0] = k;
+	      pi[1] = k+stess->tessh;
+	      pi += 2;
+	    }
+	}
+    }
+  else
+    {
+      p = stess->pomesh->controlv;
+      for(i = 0; i < nv; i++)
+	{
+	  pv[0] = (GLfloat)p[0];
+	  pv[1] = (GLfloat)p[1];
+	  pv[2] = (GLfloat)p[2];
+	  pv[3] = (GLfloat)stess->normal[0];
+	  pv[4] = (GLfloat)stess->normal[1];
+	  pv[5] = (GLfloat)stess->normal[2];
+	  pv += 6;
+	  p += 3;
+	  pi[i] = (GLuint)i;
+	}
+    }
+
+  if(!e->buffers[0])
+    glGenBuffers(3, e->buffers);
+
+  glBindBuffer(GL_ARRAY_BUFFER, e->buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, nv*6*sizeof(GLfloat), vn, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e->buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, ni*sizeof(GLuint), ind,
+	       GL_STATIC_DRAW);
+  if(nl)
+    {
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e->buffers[2]);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, nl*sizeof(GLuint), &(ind[ni]),
+		   GL_STATIC_DRAW);
+    }
+
+  e->count = ni;
+  e->lcount = nl;
+
+  free(vn);
+  free(ind);
+
+ return AY_OK;
+#else
+ return AY_ERROR;
+#endif
+} /* ay_vbo_upload */
+
+
+/** ay_vbo_uploadpomesh:
+ *  convert a PolyMesh to triangles and load them into the
+ *  vertex buffer objects of a cache entry;
+ *  triangles and quads are split directly, all other faces
+ *  (including faces with holes) are tesselated using the GLU
+ *
+ * \param[in,out] po PolyMesh to upload (face normals will be generated
+ *  and cached in the PolyMesh, if it has no vertex normals)
+ * \param[in,out] e cache entry
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_vbo_uploadpomesh(ay_pomesh_object *po, ay_vbo_entry *e)
+{
+#ifdef GL_VERSION_1_5
+ int ay_status = AY_OK;
+ ay_pomesh_object *tr = NULL, *src;
+ GLfloat *vn = NULL, *pv, *t;
+ GLuint *ind = NULL;
+ double *fn = NULL, *p, *nv;
+ unsigned int i, j, k, l, a, m = 0, n = 0, nt = 0, maxt;
+ unsigned int *tv, quad[6], si;
+ int stride;
+
+  if(!po->npolys || !po->controlv)
+    return AY_ERROR;
+
+  if(po->has_normals)
+    {
+      stride = 6;
+    }
+  else
+    {
+      stride = 3;
+      if(!po->face_normals)
+	{
+	  /* generate and cache face normals (like ay_pomesht_tesselate()) */
+	  if((ay_status = ay_pomesht_genfacenormals(po, &fn)))
+	    return ay_status;
+	  po->face_normals = fn;
+	}
+      fn = po->face_normals;
+    }
+
+  /* start with room for two triangles per face, grow as needed */
+  maxt = po->npolys*2;
+  if(!(vn = malloc(maxt*18*sizeof(GLfloat))))
+    return AY_EOMEM;
+
+  for(i = 0; i < po->npolys; i++)
+    {
+      tr = NULL;
+      src = po;
+      tv = NULL;
+      k = 0;
+      if(po->nloops[i] == 1 && po->nverts[m] < 5)
+	{
+	  if(po->nverts[m] == 3)
+	    {
+	      tv = &(po->verts[n]);
+	      k = 1;
+	    }
+	  else
+	    if(po->nverts[m] == 4)
+	      {
+		/* split the quad into two triangles */
+		quad[0] = po->verts[n];
+		quad[1] = po->verts[n+1];
+		quad[2] = po->verts[n+2];
+		quad[3] = po->verts[n];
+		quad[4] = po->verts[n+2];
+		quad[5] = po->verts[n+3];
+		tv = quad;
+		k = 2;
+	      }
+	  n += po->nverts[m];
+	  m++;
+	}
+      else
+	{
+	  ay_status = ay_tess_pomeshf(po, i, m, n, AY_FALSE, &tr);
+	  if(ay_status == AY_EOMEM)
+	    goto cleanup;
+	  /* degenerate faces are not drawn by ay_pomesht_tesselate()
+	     either */
+	  ay_status = AY_OK;
+	  if(tr)
+	    {
+	      src = tr;
+	      tv = tr->verts;
+	      k = tr->npolys;
+	    }
+	  for(j = 0; j < po->nloops[i]; j++)
+	    {
+	      n += po->nverts[m];
+	      m++;
+	    }
+	} /* if */
+
+      if(k)
+	{
+	  if(nt+k > maxt)
+	    {
+	      while(nt+k > maxt)
+		maxt *= 2;
+	      if(!(t = realloc(vn, maxt*18*sizeof(GLfloat))))
+		{ ay_status = AY_EOMEM; goto cleanup; }
+	      vn = t;
+	    }
+
+	  pv = &(vn[nt*18]);
+	  for(l = 0; l < k*3; l++)
+	    {
+	      a = tv[l];
+	      p = &(src->controlv[a*stride]);
+	      if(po->has_normals)
+		nv = p+3;
+	      else
+		nv = &(fn[i*3]);
+	      pv[0] = (GLfloat)p[0];
+	      pv[1] = (GLfloat)p[1];
+	      pv[2] = (GLfloat)p[2];
+	      pv[3] = (GLfloat)nv[0];
+	      pv[4] = (GLfloat)nv[1];
+	      pv[5] = (GLfloat)nv[2];
+	      pv += 6;
+	    }
+	  nt += k;
+	} /* if */
+
+      if(tr)
+	{
+	  (void)ay_pomesht_destroy(tr);
+	  tr = NULL;
+	}
+    } /* for */
+
+  if(!nt)
+    { ay_status = AY_ERROR; goto cleanup; }
+
+  if(!(ind = malloc(nt*3*sizeof(GLuint))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  for(si = 0; si < nt*3; si++)
+    ind[si] = (GLuint)si;
+
+  if(!e->buffers[0])
+    glGenBuffers(3, e->buffers);
+
+  glBindBuffer(GL_ARRAY_BUFFER, e->buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, nt*18*sizeof(GLfloat), vn, GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e->buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, nt*3*sizeof(GLuint), ind,
+	       GL_STATIC_DRAW);
+
+  e->count = (int)(nt*3);
+  e->lcount = 0;
+
+cleanup:
+
+  if(tr)
+    (void)ay_pomesht_destroy(tr);
+
+  if(vn)
+    free(vn);
+
+  if(ind)
+    free(ind);
+
+ return ay_status;
+#else
+ return AY_ERROR;
+#endif
+} /* ay_vbo_uploadpomesh */
+
+
+/** ay_vbo_getentry:
+ *  get the cache entry of a tesselation in the cache of the current
+ *  view, uploading the tesselation first if it is not cached yet or
+ *  outdated
+ *
+ * \param[in] key tesselation (ay_stess_patch or ay_pomesh_object)
+ * \param[in] kind kind of \a key (AY_VBOSTESS or AY_VBOPOMESH)
+ * \param[in] gen generation of the tesselation (0 - not cacheable)
+ * \param[in,out] result where to store the cache entry
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_vbo_getentry(void *key, int kind, unsigned int gen, ay_vbo_entry **result)
+{
+#ifdef GL_VERSION_1_5
+ int ay_status = AY_OK, new_item = 0;
+ Tcl_HashEntry *entry;
+ ay_vbo_entry *e;
+
+  if(!ay_vbo_current || !ay_vbo_current->available)
+    return AY_ERROR;
+
+  if(!key || !gen)
+    return AY_ERROR;
+
+  entry = Tcl_CreateHashEntry(&ay_vbo_current->entries, (char*)key,
+			      &new_item);
+  if(new_item)
+    {
+      if(!(e = calloc(1, sizeof(ay_vbo_entry))))
+	{
+	  Tcl_DeleteHashEntry(entry);
+	  return AY_EOMEM;
+	}
+      Tcl_SetHashValue(entry, (char*)e);
+    }
+  else
+    {
+      e = (ay_vbo_entry *)Tcl_GetHashValue(entry);
+    }
+
+  if(e->gen != gen || e->kind != kind)
+    {
+      if(kind == AY_VBOSTESS)
+	ay_status = ay_vbo_upload((ay_stess_patch *)key, e);
+      else
+	ay_status = ay_vbo_uploadpomesh((ay_pomesh_object *)key, e);
+      if(ay_status)
+	{
+	  if(e->buffers[0])
+	    glDeleteBuffers(3, e->buffers);
+	  glBindBuffer(GL_ARRAY_BUFFER, 0);
+	  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	  free(e);
+	  Tcl_DeleteHashEntry(entry);
+	  return ay_status;
+	}
+      e->kind = kind;
+      e->gen = gen;
+    }
+
+  e->lastused = ay_vbo_current->frame;
+
+  *result = e;
+
+ return AY_OK;
+#else
+ return AY_ERROR;
+#endif
+} /* ay_vbo_getentry */
+
+
+/** ay_vbo_drawentry:
+ *  draw (lines) or shade (triangles) a cache entry of the current
+ *  view multiple times; the buffers are bound only once
+ *  and only the transformation changes between the drawing calls
+ *
+ * \param[in] e cache entry to draw
+ * \param[in] shade if AY_TRUE, shade the entry, else draw lines
+ * \param[in] n number of instances to draw
+ * \param[in] m transformation matrices of the instances [n*16], which
+ *  are multiplied to the current modelview matrix;
+ *  may be NULL to draw a single instance with the current modelview matrix
+ *
+ * \returns AY_OK if the entry was drawn, error code otherwise
+ */
+int
+ay_vbo_drawentry(ay_vbo_entry *e, int shade, unsigned int n, double *m)
+{
+#ifdef GL_VERSION_1_5
+ int swapped = AY_FALSE;
+ GLint ff = GL_CCW;
+ double *mi, det;
+ unsigned int i;
+
+  if(!shade && !e->lcount)
+    return AY_ERROR;
+
+  if(!m)
+    n = 1;
+
+  glBindBuffer(GL_ARRAY_BUFFER, e->buffers[0]);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, e->buffers[shade?1:2]);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 6*sizeof(GLfloat), (GLvoid*)0);
+  if(shade)
+    {
+      glEnableClientState(GL_NORMAL_ARRAY);
+      glNormalPointer(GL_FLOAT, 6*sizeof(GLfloat),
+		      (GLvoid*)(3*sizeof(GLfloat)));
+      glGetIntegerv(GL_FRONT_FACE, &ff);
+    }
+
+  for(i = 0; i < n; i++)
+    {
+      if(m)
+	{
+	  mi = &(m[i*16]);
+	  glPushMatrix();
+	  glMultMatrixd((GLdouble*)mi);
+
+	  /* mirroring transformations swap front and back faces */
+	  if(shade)
+	    {
+	      det = mi[0]*(mi[5]*mi[10] - mi[6]*mi[9]) -
+		mi[4]*(mi[1]*mi[10] - mi[2]*mi[9]) +
+		mi[8]*(mi[1]*mi[6] - mi[2]*mi[5]);
+	      if((det < 0.0) != swapped)
+		{
+		  swapped = !swapped;
+		  if(swapped)
+		    glFrontFace((ff == GL_CCW)?GL_CW:GL_CCW);
+		  else
+		    glFrontFace(ff);
+		}
+	    }
+	}
+
+      if(shade)
+	glDrawElements(GL_TRIANGLES, e->count, GL_UNSIGNED_INT, (GLvoid*)0);
+      else
+	glDrawElements(GL_LINES, e->lcount, GL_UNSIGNED_INT, (GLvoid*)0);
+
+      if(m)
+	glPopMatrix();
+    } /* for */
+
+  if(swapped)
+    glFrontFace(ff);
+
+  if(shade)
+    glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+ return AY_OK;
+#else
+ return AY_ERROR;
+#endif
+} /* ay_vbo_drawentry */
+
+
+/** ay_vbo_drawinstances:
+ *  draw (lines) or shade (triangles) a tesselation from the cache of
+ *  the current view multiple times; the buffers are bound only once
+ *  and only the transformation changes between the drawing calls
+ *
+ * \param[in] stess tesselation to draw
+ * \param[in] shade if AY_TRUE, shade the tesselation, else draw lines
+ * \param[in] n number of instances to draw
+ * \param[in] m transformation matrices of the instances [n*16], which
+ *  are multiplied to the current modelview matrix;
+ *  may be NULL to draw a single instance with the current modelview matrix
+ *
+ * \returns AY_OK if the tesselation was drawn, error code otherwise
+ *  (in this case nothing was drawn and the caller has to draw the
+ *  tesselation itself)
+ */
+int
+ay_vbo_drawinstances(ay_stess_patch *stess, int shade, unsigned int n,
+		     double *m)
+{
+ int ay_status = AY_OK;
+ ay_vbo_entry *e = NULL;
+
+  if(!stess)
+    return AY_ENULL;
+
+  ay_status = ay_vbo_getentry((void*)stess, AY_VBOSTESS, stess->gen, &e);
+  if(ay_status)
+    return ay_status;
+
+ return ay_vbo_drawentry(e, shade, n, m);
+} /* ay_vbo_drawinstances */
+
+
+/** ay_vbo_shadestess:
+ *  shade an untrimmed or planar trimmed tesselation from the
+ *  cache of the current view, uploading it first if it is not
+ *  cached yet or outdated
+ *
+ * \param[in] stess tesselation to shade
+ *
+ * \returns AY_OK if the tesselation was shaded, error code otherwise
+ *  (in this case the caller has to shade the tesselation itself)
+ */
+int
+ay_vbo_shadestess(ay_stess_patch *stess)
+{
+
+ return ay_vbo_drawinstances(stess, AY_TRUE, 1, NULL);
+} /* ay_vbo_shadestess */
+
+
+/** ay_vbo_shadepomesh:
+ *  shade a PolyMesh from the cache of the current view,
+ *  uploading it first if it is not cached yet or outdated
+ *
+ * \param[in,out] po PolyMesh to shade
+ * \param[in] version version of the object that carries or
+ *  created the PolyMesh (see ay_object->version); 0 disables the cache
+ *
+ * \returns AY_OK if the PolyMesh was shaded, error code otherwise
+ *  (in this case the caller has to shade the PolyMesh itself)
+ */
+int
+ay_vbo_shadepomesh(ay_pomesh_object *po, unsigned int version)
+{
+ int ay_status = AY_OK;
+ ay_vbo_entry *e = NULL;
+
+  ay_status = ay_vbo_getentry((void*)po, AY_VBOPOMESH, version, &e);
+  if(ay_status)
+    return ay_status;
+
+ return ay_vbo_drawentry(e, AY_TRUE, 1, NULL);
+} /* ay_vbo_shadepomesh */
+
+
+/** ay_vbo_begin:
+ *  make the cache of a view current, must be called
+ *  with the OpenGL context of the view current
+ *
+ * \param[in] togl view to shade
+ */
+void
+ay_vbo_begin(struct Togl *togl)
+{
+ int new_item = 0;
+ Tcl_HashEntry *entry;
+ ay_vbo_cache *cache;
+
+  ay_vbo_current = NULL;
+
+  entry = Tcl_CreateHashEntry(&ay_vbo_viewsht, (char*)togl, &new_item);
+  if(new_item)
+    {
+      if(!(cache = calloc(1, sizeof(ay_vbo_cache))))
+	{
+	  Tcl_DeleteHashEntry(entry);
+	  return;
+	}
+      Tcl_InitHashTable(&cache->entries, TCL_ONE_WORD_KEYS);
+#ifdef GL_VERSION_1_5
+      cache->available = ay_vbo_checkversion();
+#endif
+      Tcl_SetHashValue(entry, (char*)cache);
+    }
+  else
+    {
+      cache = (ay_vbo_cache *)Tcl_GetHashValue(entry);
+    }
+
+  cache->frame++;
+  ay_vbo_current = cache;
+
+ return;
+} /* ay_vbo_begin */
+
+
+/** ay_vbo_end:
+ *  finish shading of the current view and release cached
+ *  tesselations that have not been drawn for a while
+ */
+void
+ay_vbo_end(void)
+{
+ Tcl_HashEntry *entry;
+ Tcl_HashSearch search;
+ ay_vbo_entry *e;
+
+  if(!ay_vbo_current)
+    return;
+
+  entry = Tcl_FirstHashEntry(&ay_vbo_current->entries, &search);
+  while(entry)
+    {
+      e = (ay_vbo_entry *)Tcl_GetHashValue(entry);
+      if(ay_vbo_current->frame - e->lastused > AY_VBOMAXAGE)
+	{
+#ifdef GL_VERSION_1_5
+	  glDeleteBuffers(3, e->buffers);
+#endif
+	  free(e);
+	  Tcl_DeleteHashEntry(entry);
+	}
+      entry = Tcl_NextHashEntry(&search);
+    }
+
+  ay_vbo_current = NULL;
+
+ return;
+} /* ay_vbo_end */
+
+
+/** ay_vbo_freeview:
+ *  free the cache of a view that is about to be destroyed;
+ *  the buffer objects go away with the OpenGL context of the view
+ *
+ * \param[in] togl view
+ */
+void
+ay_vbo_freeview(struct Togl *togl)
+{
+ Tcl_HashEntry *entry, *ventry;
+ Tcl_HashSearch search;
+ ay_vbo_cache *cache;
+
+  if(!(ventry = Tcl_FindHashEntry(&ay_vbo_viewsht, (char*)togl)))
+    return;
+
+  cache = (ay_vbo_cache *)Tcl_GetHashValue(ventry);
+
+  if(ay_vbo_current == cache)
+    ay_vbo_current = NULL;
+
+  entry = Tcl_FirstHashEntry(&cache->entries, &search);
+  while(entry)
+    {
+      free(Tcl_GetHashValue(entry));
+      entry = Tcl_NextHashEntry(&search);
+    }
+  Tcl_DeleteHashTable(&cache->entries);
+  free(cache);
+  Tcl_DeleteHashEntry(ventry);
+
+ return;
+} /* ay_vbo_freeview */
+
+
+/** ay_vbo_init:
+ *  initialize the vbo module
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_vbo_init(void)
+{
+
+  Tcl_InitHashTable(&ay_vbo_viewsht, TCL_ONE_WORD_KEYS);
+
+ return AY_OK;
+} /* ay_vbo_init */
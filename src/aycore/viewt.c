@@ -237,6 +237,55 @@ ay_viewt_wintoobj(struct Togl *togl, ay_object *o,
 } /* ay_viewt_wintoobj */
 
 
+/** ay_viewt_wintoray:
+ * transforms the window coordinates winX, winY
+ * to a ray in the object space of the given object <o>
+ * without reading back the depth buffer;
+ * Assumes the standard transformations are in use!
+ *
+ * \param[in] togl  view
+ * \param[in] o  object (may be NULL for world space)
+ * \param[in] winX  window coordinate
+ * \param[in] winY  window coordinate (Tk convention, origin upper left)
+ * \param[in,out] ro  where to store the ray origin [3]
+ * \param[in,out] rd  where to store the ray direction [3]
+ */
+void
+ay_viewt_wintoray(struct Togl *togl, ay_object *o,
+		  double winX, double winY, double *ro, double *rd)
+{
+ int height = Togl_Height(togl);
+ GLint viewport[4];
+ GLdouble modelMatrix[16], projMatrix[16], winx, winy;
+ double p1[3];
+
+  if(!togl || !ro || !rd)
+    return;
+
+  winx = winX;
+  winy = height - winY;
+
+  glGetIntegerv(GL_VIEWPORT, viewport);
+
+  ay_viewt_setupprojection(togl);
+
+  glGetDoublev(GL_PROJECTION_MATRIX, projMatrix);
+
+  ay_trafo_identitymatrix(modelMatrix);
+  if(o)
+    ay_trafo_getall(ay_currentlevel, o, modelMatrix);
+
+  gluUnProject(winx, winy, 0.0, modelMatrix, projMatrix, viewport,
+	       &(ro[0]), &(ro[1]), &(ro[2]));
+  gluUnProject(winx, winy, 1.0, modelMatrix, projMatrix, viewport,
+	       &(p1[0]), &(p1[1]), &(p1[2]));
+
+  AY_V3SUB(rd, p1, ro);
+
+ return;
+} /* ay_viewt_wintoray */
+
+
 /* ay_viewt_winrecttoobj:
  * transforms the rectangle formed by the window coordinates
  * winX, winY, winX2, winY2,
@@ -910,6 +959,10 @@ ay_viewt_makecurtcb(struct Togl *togl, int argc, char *argv[])
 		Tcl_NewIntObj(view->enable_undo),
 		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
 
+  Tcl_SetVar2Ex(interp, arr, "cVCulled",
+		Tcl_NewIntObj(view->culled),
+		TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+
  return TCL_OK;
 } /* ay_viewt_makecurtcb */
 
@@ -20,6 +20,24 @@ int ay_wrib_framenum = 0;
 
 unsigned int ay_wrib_primlevel = 0;
 
+#ifdef AYENABLEPPREV
+/* local types: */
+
+/* an object definition retained in the permanent preview renderer */
+typedef struct ay_wrib_ppentry_s {
+  unsigned int version; /* version of the object when it was defined */
+  RtObjectHandle handle; /* handle of the object definition */
+} ay_wrib_ppentry;
+
+/* retained object definitions, keyed by object */
+static Tcl_HashTable ay_wrib_ppht;
+
+static int ay_wrib_pphtinit = AY_FALSE;
+
+/* use retained object definitions in ay_wrib_object()? */
+static int ay_wrib_ppretain = AY_FALSE;
+#endif /* AYENABLEPPREV */
+
 
 /* prototypes of functions local to this module: */
 
@@ -32,6 +50,16 @@ void ay_wrib_displaydriver(char *driver);
 
 int ay_wrib_lights(char *file, ay_object *o);
 
+#ifdef AYENABLEPPREV
+int ay_wrib_pprevisretained(ay_object *o);
+
+int ay_wrib_pprevdefine(char *file, ay_object *o);
+
+int ay_wrib_pprevinstance(ay_object *o);
+
+void ay_wrib_pprevclear(void);
+#endif /* AYENABLEPPREV */
+
 
 /* functions: */
 
@@ -587,7 +615,7 @@ ay_wrib_object(char *file, ay_object *o)
  ay_level_object *l = NULL;
  ay_light_object *light = NULL;
  int down_is_prim = AY_FALSE;
- char *parname = "name";
+ char *parname = "name", *archive = NULL;
 
   if(!o)
     return AY_ENULL;
@@ -598,6 +626,13 @@ ay_wrib_object(char *file, ay_object *o)
   if(ay_tags_hastag(o, ay_noexport_tagtype))
     return AY_OK;
 
+  /* already written to a content hashed archive? */
+  if((archive = ay_wriba_get(o)))
+    {
+      RiReadArchive(archive, (RtVoid*)RI_NULL, RI_NULL);
+      return AY_OK;
+    }
+
   arr = ay_wribcbt.arr;
   cb = (ay_wribcb *)(arr[o->type]);
 
@@ -811,7 +846,10 @@ ay_wrib_object(char *file, ay_object *o)
 
   if(cb)
     {
-      ay_status = cb(file, o);
+#ifdef AYENABLEPPREV
+      if(!ay_wrib_ppretain || !ay_wrib_pprevinstance(o))
+#endif
+	ay_status = cb(file, o);
 
       RiTransformEnd();
       RiAttributeEnd();
@@ -867,7 +905,11 @@ ay_wrib_toolobject(char *file, ay_object *o, ay_object *t)
 	    {
 	      if(tag->type == ay_pv_tagtype)
 		{
+		  /* convert before sharing the value, as the conversion
+		     replaces it */
+		  (void)ay_pv_tobinary(tag);
 		  (new_tags[i]).type = ay_pv_tagtype;
+		  (new_tags[i]).is_binary = tag->is_binary;
 		  /* no need to copy the name... */
 		  (new_tags[i]).val = tag->val;
 		  (new_tags[i]).next = &(new_tags[i+1]);
@@ -2271,7 +2313,8 @@ ay_wrib_viewtcb(struct Togl *togl, int argc, char *argv[])
  int width = Togl_Width (togl);
  int height = Togl_Height (togl);
  int i, temp = AY_FALSE, target = 0;
- char *file = NULL, *image = NULL, *driver = NULL;
+ int old_resinstances = ay_prefs.resolveinstances;
+ char *file = NULL, *image = NULL, *driver = NULL, *archives = NULL;
  double addroll = 0.0, dir[3];
 
 #ifdef AYENABLEPPREV
@@ -2305,6 +2348,12 @@ ay_wrib_viewtcb(struct Togl *togl, int argc, char *argv[])
 	  i++;
 	}
 
+      if(!strcmp(argv[i], "-archives"))
+	{
+	  archives = argv[i+1];
+	  i++;
+	}
+
       if(!strcmp(argv[i], "-temp"))
 	{
 	  temp = AY_TRUE;
@@ -2348,11 +2397,25 @@ ay_wrib_viewtcb(struct Togl *togl, int argc, char *argv[])
 
   ay_wrib_getup(dir, view->up, &addroll);
 
-  ay_status = ay_wrib_scene(file, image, driver, temp, target,
-			    view->from, view->to,
-			    view->roll+addroll, view->zoom, view->nearp,
-			    view->farp,
-			    width, height, view->type);
+  /* write the objects to content hashed archives first */
+  if(archives)
+    {
+      ay_prefs.resolveinstances = AY_TRUE;
+      ay_status = ay_wriba_write(archives, ay_root->next);
+    }
+
+  if(!ay_status)
+    ay_status = ay_wrib_scene(file, image, driver, temp, target,
+			      view->from, view->to,
+			      view->roll+addroll, view->zoom, view->nearp,
+			      view->farp,
+			      width, height, view->type);
+
+  if(archives)
+    {
+      ay_wriba_clear();
+      ay_prefs.resolveinstances = old_resinstances;
+    }
 
   if(ay_status)
     {
@@ -2383,7 +2446,7 @@ ay_wrib_tcmd(ClientData clientData, Tcl_Interp *interp,
  int width = 400;
  int height = 300;
  int i, selonly = AY_FALSE, smonly = AY_FALSE, objonly = AY_FALSE;
- char *filename = NULL, *imagename = NULL, *driver = NULL;
+ char *filename = NULL, *imagename = NULL, *driver = NULL, *archives = NULL;
  char fname[] = "wrib";
  double addroll = 0.0, dir[3];
 
@@ -2414,6 +2477,12 @@ ay_wrib_tcmd(ClientData clientData, Tcl_Interp *interp,
 	  i++;
 	}
       else
+      if(!strcmp(argv[i], "-archives"))
+	{
+	  archives = argv[i+1];
+	  i++;
+	}
+      else
       if(!strcmp(argv[i], "-smonly"))
 	smonly = AY_TRUE;
       else
@@ -2478,6 +2547,20 @@ ay_wrib_tcmd(ClientData clientData, Tcl_Interp *interp,
       imagename = "unnamed.tif";
     }
 
+  /* write the objects to content hashed archives first;
+     the archives contain resolved instances */
+  if(archives && !(smonly || selonly))
+    {
+      ay_prefs.resolveinstances = AY_TRUE;
+      ay_status = ay_wriba_write(archives, ay_root->next);
+      if(ay_status)
+	{
+	  ay_prefs.resolveinstances = old_resinstances;
+	  ay_error(ay_status, fname, "failed to write archives");
+	  return TCL_OK;
+	}
+    }
+
   if(!(smonly || selonly || objonly))
     {
       /* normal RIB export (no shadow maps, complete scene, all objects) */
@@ -2542,6 +2625,12 @@ ay_wrib_tcmd(ClientData clientData, Tcl_Interp *interp,
 	} /* if */
     } /* if */
 
+  if(archives)
+    {
+      ay_wriba_clear();
+      ay_prefs.resolveinstances = old_resinstances;
+    }
+
   if(ay_status)
     {
       ay_error(ay_status, fname, NULL);
@@ -2597,6 +2686,178 @@ cleanup:
 
 
 #ifdef AYENABLEPPREV
+/* ay_wrib_pprevisretained:
+ *  check, whether the geometry of object <o> may be retained in the
+ *  permanent preview renderer; this is not the case for objects that
+ *  were never notified (no version) and for objects whose RIB does
+ *  not (only) depend on their own version
+ *  returns AY_TRUE if yes, else returns AY_FALSE
+ */
+int
+ay_wrib_pprevisretained(ay_object *o)
+{
+
+  if(!o->version)
+    return AY_FALSE;
+
+  switch(o->type)
+    {
+    case AY_IDROOT:
+    case AY_IDLEVEL:
+    case AY_IDLIGHT:
+    case AY_IDCAMERA:
+    case AY_IDVIEW:
+    case AY_IDINSTANCE:
+    case AY_IDMATERIAL:
+    case AY_IDRIINC:
+    case AY_IDRIPROC:
+      return AY_FALSE;
+    default:
+      break;
+    } /* switch */
+
+ return AY_TRUE;
+} /* ay_wrib_pprevisretained */
+
+
+/* ay_wrib_pprevdefine:
+ *  (re-)define the geometry of all objects in the list <o>
+ *  (and their children) whose version changed since they were
+ *  last defined, as retained objects (RiObjectBegin()/RiObjectEnd());
+ *  must be called outside of a frame block
+ */
+int
+ay_wrib_pprevdefine(char *file, ay_object *o)
+{
+ int ay_status = AY_OK, new_item = 0;
+ ay_voidfp *arr = NULL;
+ ay_wribcb *cb = NULL;
+ Tcl_HashEntry *entry;
+ ay_wrib_ppentry *e;
+
+  if(!ay_wrib_pphtinit)
+    {
+      Tcl_InitHashTable(&ay_wrib_ppht, TCL_ONE_WORD_KEYS);
+      ay_wrib_pphtinit = AY_TRUE;
+    }
+
+  arr = ay_wribcbt.arr;
+
+  while(o && o->next)
+    {
+      if((ay_prefs.excludehidden && o->hide) ||
+	 ay_tags_hastag(o, ay_noexport_tagtype))
+	{
+	  o = o->next;
+	  continue;
+	}
+
+      cb = (ay_wribcb *)(arr[o->type]);
+
+      if(cb && ay_wrib_pprevisretained(o))
+	{
+	  entry = Tcl_CreateHashEntry(&ay_wrib_ppht, (char*)o, &new_item);
+	  if(new_item)
+	    {
+	      if(!(e = calloc(1, sizeof(ay_wrib_ppentry))))
+		{
+		  Tcl_DeleteHashEntry(entry);
+		  return AY_EOMEM;
+		}
+	      Tcl_SetHashValue(entry, (char*)e);
+	    }
+	  else
+	    {
+	      e = (ay_wrib_ppentry *)Tcl_GetHashValue(entry);
+	    }
+
+	  if(e->version != o->version)
+	    {
+	      /* the renderer offers no way to delete the outdated
+		 definition, it just will not be instantiated anymore */
+	      e->handle = RiObjectBegin();
+	       ay_status = cb(file, o);
+	      RiObjectEnd();
+
+	      if(ay_status)
+		{
+		  e->version = 0;
+		  return ay_status;
+		}
+
+	      e->version = o->version;
+	    } /* if */
+	} /* if */
+
+      /* do not descend into light sources (see ay_wrib_object()) */
+      if(o->down && o->down->next && (o->type != AY_IDLIGHT) &&
+	 !o->hide_children)
+	{
+	  ay_status = ay_wrib_pprevdefine(file, o->down);
+	  if(ay_status)
+	    return ay_status;
+	}
+
+      o = o->next;
+    } /* while */
+
+ return AY_OK;
+} /* ay_wrib_pprevdefine */
+
+
+/* ay_wrib_pprevinstance:
+ *  instantiate the retained geometry of object <o>, if it is up to date
+ *  returns AY_TRUE if the geometry was instantiated, else returns AY_FALSE
+ *  (in this case the caller has to write the geometry itself)
+ */
+int
+ay_wrib_pprevinstance(ay_object *o)
+{
+ Tcl_HashEntry *entry;
+ ay_wrib_ppentry *e;
+
+  if(!ay_wrib_pphtinit || !o->version)
+    return AY_FALSE;
+
+  if(!(entry = Tcl_FindHashEntry(&ay_wrib_ppht, (char*)o)))
+    return AY_FALSE;
+
+  e = (ay_wrib_ppentry *)Tcl_GetHashValue(entry);
+
+  if(e->version != o->version)
+    return AY_FALSE;
+
+  RiObjectInstance(e->handle);
+
+ return AY_TRUE;
+} /* ay_wrib_pprevinstance */
+
+
+/* ay_wrib_pprevclear:
+ *  forget all retained object definitions
+ */
+void
+ay_wrib_pprevclear(void)
+{
+ Tcl_HashEntry *entry;
+ Tcl_HashSearch search;
+
+  if(!ay_wrib_pphtinit)
+    return;
+
+  entry = Tcl_FirstHashEntry(&ay_wrib_ppht, &search);
+  while(entry)
+    {
+      free(Tcl_GetHashValue(entry));
+      entry = Tcl_NextHashEntry(&search);
+    }
+  Tcl_DeleteHashTable(&ay_wrib_ppht);
+  Tcl_InitHashTable(&ay_wrib_ppht, TCL_ONE_WORD_KEYS);
+
+ return;
+} /* ay_wrib_pprevclear */
+
+
 /* ay_wrib_pprevdraw:
  *
  */
@@ -2655,6 +2916,16 @@ ay_wrib_pprevdraw(ay_view_object *view)
      for instances but rather resolve them */
   ay_prefs.resolveinstances = AY_TRUE;
 
+  /* in retained mode, (re-)define the geometry of all objects that
+     changed since the last frame outside of the frame, so that the
+     definitions persist and unchanged objects need not be sent again */
+  if(ay_prefs.pprev_retained)
+    {
+      ay_status = ay_wrib_pprevdefine(pprender, ay_root->next);
+      if(ay_status)
+	goto cleanup;
+    }
+
   /* XXXX does this constant framenumber hurt? */
   RiFrameBegin((RtInt)1);
 
@@ -2726,9 +2997,7 @@ ay_wrib_pprevdraw(ay_view_object *view)
   ay_wrib_placecamera(f, d, roll+addroll);
 
   /* write RiOptions */
-  ay_status = ay_wrib_rioptions();
-  if(ay_status)
-    goto cleanup;
+  ay_wrib_rioptions(AY_FALSE);
 
   /* write root RiOption tags */
   ay_status = ay_riopt_wrib(ay_root);
@@ -2758,6 +3027,8 @@ ay_wrib_pprevdraw(ay_view_object *view)
   if(ay_status)
     goto cleanup;
 
+   ay_wrib_ppretain = ay_prefs.pprev_retained;
+
    o = ay_root->next;
    while(o->next)
      {
@@ -2768,6 +3039,8 @@ ay_wrib_pprevdraw(ay_view_object *view)
        o = o->next;
      }
 
+   ay_wrib_ppretain = AY_FALSE;
+
   RiWorldEnd();
   RiFrameEnd();
 
@@ -2779,6 +3052,8 @@ ay_wrib_pprevdraw(ay_view_object *view)
 
 cleanup:
 
+  ay_wrib_ppretain = AY_FALSE;
+
   ay_prefs.resolveinstances = old_resinstances;
 
  return ay_status;
@@ -2802,6 +3077,9 @@ ay_wrib_pprevopen(ay_view_object *view)
   /* first, close eventually already open permanent preview window */
   ay_wrib_pprevclose();
 
+  /* object definitions of a former stream are gone */
+  ay_wrib_pprevclear();
+
   view->ppreview = AY_TRUE;
 
   /* now, open the new permanent preview window */
@@ -2842,6 +3120,8 @@ ay_wrib_pprevclose()
 	      /* corresponding RiBegin(); was issued in pprevopen() above */
 	      RiEnd();
 
+	      ay_wrib_pprevclear();
+
 	      v->ppreview = AY_FALSE;
 	      ay_prefs.pprev_open = AY_FALSE;
 	    } /* if */
@@ -0,0 +1,590 @@
+/*
+ * Ayam, a free 3D modeler for the RenderMan interface.
+ *
+ * Ayam is copyrighted 1998-2024 by Randolf Schultz
+ * (randolf.schultz@gmail.com) and others.
+ *
+ * All rights reserved.
+ *
+ * See the file License for details.
+ *
+ */
+
+#include "ayam.h"
+
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+/* wriba.c - content hashed RIB archives */
+
+/** size of the buffer used to hash the serialized objects */
+#define AY_WRIBABUFSIZE 65536
+
+/* local types: */
+
+/** an object that is exported to its own archive */
+typedef struct ay_wriba_unit_s {
+  ay_object *o; /**< object to export */
+  char hash[33]; /**< content hash (32 hex digits) */
+  int status; /**< result of hashing */
+} ay_wriba_unit;
+
+/* global variables for this module: */
+
+/** all objects that go to archives */
+static ay_wriba_unit *ay_wriba_units = NULL;
+
+/** number of used/allocated elements in ay_wriba_units */
+static int ay_wriba_nunits = 0, ay_wriba_aunits = 0;
+
+/** next unit to be hashed by a worker */
+static int ay_wriba_nextunit = 0;
+
+/** archive file names, keyed by object */
+static Tcl_HashTable ay_wriba_ht;
+
+/** is ay_wriba_ht initialized? */
+static int ay_wriba_htinit = AY_FALSE;
+
+/** may ay_wrib_object() reference the archives? */
+static int ay_wriba_active = AY_FALSE;
+
+#ifndef WIN32
+/** protects ay_wriba_nextunit */
+static pthread_mutex_t ay_wriba_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+/* prototypes of functions local to this module: */
+
+int ay_wriba_isinline(ay_object *o);
+
+int ay_wriba_collect(ay_object *o);
+
+int ay_wriba_serialize(FILE *fileptr, ay_object *o, int depsonly);
+
+int ay_wriba_hashfile(FILE *fileptr, char *hash);
+
+int ay_wriba_hashunit(ay_wriba_unit *u);
+
+void *ay_wriba_worker(void *data);
+
+
+/* functions: */
+
+/** ay_wriba_isinline:
+ *  check whether an object must be written directly to the
+ *  top-level RIB; this is the case for objects that are not
+ *  geometry, and for objects (or instances of objects) with
+ *  children that depend on things outside the scene (RiInc, RiProc)
+ *  or that must be known to the renderer before (light sources)
+ *
+ * \param[in] o object to check
+ *
+ * \returns AY_TRUE if the object may not go to an archive
+ */
+int
+ay_wriba_isinline(ay_object *o)
+{
+ ay_object *down;
+
+  switch(o->type)
+    {
+    case AY_IDROOT:
+    case AY_IDVIEW:
+    case AY_IDCAMERA:
+    case AY_IDLIGHT:
+    case AY_IDMATERIAL:
+    case AY_IDRIINC:
+    case AY_IDRIPROC:
+      return AY_TRUE;
+    case AY_IDINSTANCE:
+      if(o->refine && ay_wriba_isinline((ay_object*)o->refine))
+	return AY_TRUE;
+      break;
+    default:
+      break;
+    }
+
+  down = o->down;
+  while(down && down->next)
+    {
+      if(ay_wriba_isinline(down))
+	return AY_TRUE;
+      down = down->next;
+    }
+
+ return AY_FALSE;
+} /* ay_wriba_isinline */
+
+
+/** ay_wriba_collect:
+ *  collect the objects to be written to archives, descending into
+ *  plain levels (the same way as ay_wrib_object() does)
+ *
+ * \param[in] o first object of a level
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_wriba_collect(ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_wriba_unit *t;
+ ay_level_object *l;
+
+  while(o && o->next)
+    {
+      if(!((ay_prefs.excludehidden && o->hide) ||
+	   ay_tags_hastag(o, ay_noexport_tagtype)))
+	{
+	  l = NULL;
+	  if(o->type == AY_IDLEVEL)
+	    l = (ay_level_object *)o->refine;
+
+	  if(l && l->type == AY_LTLEVEL)
+	    {
+	      if(!o->hide_children)
+		{
+		  ay_status = ay_wriba_collect(o->down);
+		  if(ay_status)
+		    return ay_status;
+		}
+	    }
+	  else
+	    if(!ay_wriba_isinline(o))
+	      {
+		if(ay_wriba_nunits == ay_wriba_aunits)
+		  {
+		    if(!(t = realloc(ay_wriba_units,
+				     (ay_wriba_aunits+64)*
+				     sizeof(ay_wriba_unit))))
+		      return AY_EOMEM;
+		    ay_wriba_units = t;
+		    ay_wriba_aunits += 64;
+		  }
+		memset(&(ay_wriba_units[ay_wriba_nunits]), 0,
+		       sizeof(ay_wriba_unit));
+		ay_wriba_units[ay_wriba_nunits].o = o;
+		ay_wriba_nunits++;
+	      }
+	} /* if */
+      o = o->next;
+    } /* while */
+
+ return ay_status;
+} /* ay_wriba_collect */
+
+
+/** ay_wriba_serialize:
+ *  serialize an object with all of its children, plus everything
+ *  the exported RIB depends on (materials, masters of instances)
+ *
+ * \param[in,out] fileptr file to write to
+ * \param[in] o object to serialize
+ * \param[in] depsonly if AY_TRUE, the object itself has already been
+ *  written (as child of its parent) and only the dependencies are missing
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_wriba_serialize(FILE *fileptr, ay_object *o, int depsonly)
+{
+ int ay_status = AY_OK;
+ ay_object *down;
+
+  if(!depsonly)
+    ay_status = ay_bio_writeobject(fileptr, o);
+
+  if(!ay_status && o->mat && o->mat->objptr)
+    ay_status = ay_bio_writeobject(fileptr, o->mat->objptr);
+
+  if(!ay_status && o->type == AY_IDINSTANCE && o->refine)
+    ay_status = ay_wriba_serialize(fileptr, (ay_object*)o->refine, AY_FALSE);
+
+  down = o->down;
+  while(!ay_status && down && down->next)
+    {
+      ay_status = ay_wriba_serialize(fileptr, down, AY_TRUE);
+      down = down->next;
+    }
+
+ return ay_status;
+} /* ay_wriba_serialize */
+
+
+#define AY_WRIBAROTL(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+#define AY_WRIBAFMIX(h) h ^= h >> 16; h *= 0x85ebca6bU; h ^= h >> 13;\
+ h *= 0xc2b2ae35U; h ^= h >> 16;
+
+/** ay_wriba_hashfile:
+ *  compute a 128 bit hash (MurmurHash3, x86 variant) of the
+ *  contents of a file
+ *
+ * \param[in] fileptr file to hash, read from the current position
+ * \param[in,out] hash where to store the hash as 32 hex digits
+ *  (must have room for 33 characters)
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_wriba_hashfile(FILE *fileptr, char *hash)
+{
+ const unsigned int c1 = 0x239b961bU, c2 = 0xab0e9789U;
+ const unsigned int c3 = 0x38b34ae5U, c4 = 0xa1e38b93U;
+ unsigned int h1 = 0, h2 = 0, h3 = 0, h4 = 0;
+ unsigned int k1, k2, k3, k4, k[4];
+ unsigned char *buf, *b;
+ unsigned long len = 0;
+ size_t n, i, j;
+
+  if(!(buf = malloc(AY_WRIBABUFSIZE)))
+    return AY_EOMEM;
+
+  while((n = fread(buf, 1, AY_WRIBABUFSIZE, fileptr)) > 0)
+    {
+      len += (unsigned long)n;
+      b = buf;
+      for(i = 0; i+16 <= n; i += 16)
+	{
+	  for(j = 0; j < 4; j++)
+	    k[j] = (unsigned int)b[j*4] | ((unsigned int)b[j*4+1] << 8) |
+	      ((unsigned int)b[j*4+2] << 16) | ((unsigned int)b[j*4+3] << 24);
+	  b += 16;
+
+	  k1 = k[0]*c1; k1 = AY_WRIBAROTL(k1, 15); k1 *= c2; h1 ^= k1;
+	  h1 = AY_WRIBAROTL(h1, 19); h1 += h2; h1 = h1*5+0x561ccd1bU;
+
+	  k2 = k[1]*c2; k2 = AY_WRIBAROTL(k2, 16); k2 *= c3; h2 ^= k2;
+	  h2 = AY_WRIBAROTL(h2, 17); h2 += h3; h2 = h2*5+0x0bcaa747U;
+
+	  k3 = k[2]*c3; k3 = AY_WRIBAROTL(k3, 17); k3 *= c4; h3 ^= k3;
+	  h3 = AY_WRIBAROTL(h3, 15); h3 += h4; h3 = h3*5+0x96cd1c35U;
+
+	  k4 = k[3]*c4; k4 = AY_WRIBAROTL(k4, 18); k4 *= c1; h4 ^= k4;
+	  h4 = AY_WRIBAROTL(h4, 13); h4 += h1; h4 = h4*5+0x32ac3b17U;
+	} /* for */
+
+      if(i < n)
+	{
+	  /* tail, only possible at the end of the file */
+	  k[0] = k[1] = k[2] = k[3] = 0;
+	  for(j = 0; i+j < n; j++)
+	    k[j/4] |= (unsigned int)b[j] << ((j%4)*8);
+
+	  k4 = k[3]*c4; k4 = AY_WRIBAROTL(k4, 18); k4 *= c1; h4 ^= k4;
+	  k3 = k[2]*c3; k3 = AY_WRIBAROTL(k3, 17); k3 *= c4; h3 ^= k3;
+	  k2 = k[1]*c2; k2 = AY_WRIBAROTL(k2, 16); k2 *= c3; h2 ^= k2;
+	  k1 = k[0]*c1; k1 = AY_WRIBAROTL(k1, 15); k1 *= c2; h1 ^= k1;
+	  break;
+	}
+    } /* while */
+
+  /* finalization */
+  h1 ^= (unsigned int)len; h2 ^= (unsigned int)len;
+  h3 ^= (unsigned int)len; h4 ^= (unsigned int)len;
+
+  h1 += h2; h1 += h3; h1 += h4;
+  h2 += h1; h3 += h1; h4 += h1;
+
+  AY_WRIBAFMIX(h1);
+  AY_WRIBAFMIX(h2);
+  AY_WRIBAFMIX(h3);
+  AY_WRIBAFMIX(h4);
+
+  h1 += h2; h1 += h3; h1 += h4;
+  h2 += h1; h3 += h1; h4 += h1;
+
+  sprintf(hash, "%08x%08x%08x%08x", h1, h2, h3, h4);
+
+  free(buf);
+
+ return AY_OK;
+} /* ay_wriba_hashfile */
+
+
+/** ay_wriba_hashunit:
+ *  compute the content hash of an archive; the hash covers
+ *  all data of the objects and the preferences that affect the
+ *  exported RIB
+ *
+ * \param[in,out] u archive to hash
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_wriba_hashunit(ay_wriba_unit *u)
+{
+ int ay_status = AY_OK;
+ char fname[] = "wriba_hashunit";
+ FILE *fileptr;
+
+  if(!(fileptr = tmpfile()))
+    {
+      ay_error(AY_EOPENFILE, fname, "could not create temporary file");
+      return AY_ERROR;
+    }
+
+  fprintf(fileptr, "Ayam %s %d %d %d\n", AY_VERSIONSTR,
+	  ay_prefs.writeident, ay_prefs.ristandard, ay_prefs.excludehidden);
+
+  ay_status = ay_wriba_serialize(fileptr, u->o, AY_FALSE);
+
+  if(!ay_status)
+    {
+      rewind(fileptr);
+      ay_status = ay_wriba_hashfile(fileptr, u->hash);
+      if(!ay_status && ferror(fileptr))
+	ay_status = AY_ERROR;
+    }
+
+  fclose(fileptr);
+
+ return ay_status;
+} /* ay_wriba_hashunit */
+
+
+/** ay_wriba_worker:
+ *  compute content hashes until all archives are done;
+ *  used by the threads of ay_wriba_write()
+ *
+ * \param[in] data unused
+ *
+ * \returns NULL
+ */
+void *
+ay_wriba_worker(void *data)
+{
+ int i;
+
+  while(1)
+    {
+#ifndef WIN32
+      pthread_mutex_lock(&ay_wriba_mutex);
+#endif
+      i = ay_wriba_nextunit;
+      ay_wriba_nextunit++;
+#ifndef WIN32
+      pthread_mutex_unlock(&ay_wriba_mutex);
+#endif
+
+      if(i >= ay_wriba_nunits)
+	break;
+
+      ay_wriba_units[i].status = ay_wriba_hashunit(&(ay_wriba_units[i]));
+    } /* while */
+
+ return NULL;
+} /* ay_wriba_worker */
+
+
+/** ay_wriba_write:
+ *  write the objects of the scene to archives named by the hash of
+ *  their contents; archives that already exist are not written again;
+ *  the content hashes are computed in parallel, but the archives are
+ *  written one after another, as there is only one RenderMan
+ *  interface context; must be called before RiBegin() of the
+ *  top-level RIB, which then references the archives
+ *
+ * \param[in] base base name of the archive files
+ *  (the archive names are "<base>-<hash>.rib")
+ * \param[in] o first object of the scene
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_wriba_write(char *base, ay_object *o)
+{
+ int ay_status = AY_OK;
+ char fname[] = "wriba_write";
+ Tcl_HashEntry *entry;
+ FILE *fileptr;
+ char *name = NULL, *tmpname = NULL;
+ int i, new_item = 0;
+#ifndef WIN32
+ pthread_t *threads = NULL;
+ int nthreads;
+#endif /* !WIN32 */
+
+  ay_wriba_clear();
+
+  if(!base || !o)
+    return AY_ENULL;
+
+  if(!ay_wriba_htinit)
+    {
+      Tcl_InitHashTable(&ay_wriba_ht, TCL_ONE_WORD_KEYS);
+      ay_wriba_htinit = AY_TRUE;
+    }
+
+  ay_status = ay_wriba_collect(o);
+  if(ay_status || !ay_wriba_nunits)
+    goto cleanup;
+
+  /* compute the content hashes */
+  ay_wriba_nextunit = 0;
+#ifndef WIN32
+  nthreads = ay_notify_getnthreads();
+  if(nthreads > ay_wriba_nunits)
+    nthreads = ay_wriba_nunits;
+
+  if(nthreads > 1)
+    {
+      if(!(threads = malloc((nthreads-1)*sizeof(pthread_t))))
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
+
+      ay_notify_parallel(AY_TRUE);
+
+      /* the main thread is one of the workers */
+      for(i = 0; i < nthreads-1; i++)
+	{
+	  if(pthread_create(&(threads[i]), NULL, ay_wriba_worker, NULL))
+	    break;
+	}
+      nthreads = i;
+
+      (void)ay_wriba_worker(NULL);
+
+      for(i = 0; i < nthreads; i++)
+	{
+	  (void)pthread_join(threads[i], NULL);
+	}
+      free(threads);
+
+      ay_notify_parallel(AY_FALSE);
+    }
+  else
+#endif /* !WIN32 */
+    {
+      (void)ay_wriba_worker(NULL);
+    }
+
+  /* write the missing archives */
+  for(i = 0; i < ay_wriba_nunits; i++)
+    {
+      if(ay_wriba_units[i].status)
+	{
+	  ay_status = ay_wriba_units[i].status;
+	  goto cleanup;
+	}
+
+      if(!(name = malloc((strlen(base)+40)*sizeof(char))))
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
+      sprintf(name, "%s-%s.rib", base, ay_wriba_units[i].hash);
+
+      entry = Tcl_CreateHashEntry(&ay_wriba_ht,
+				  (char*)ay_wriba_units[i].o, &new_item);
+      Tcl_SetHashValue(entry, (char*)name);
+
+      /* already there? (from an earlier export or a duplicate object) */
+      if((fileptr = fopen(name, "rb")))
+	{
+	  fclose(fileptr);
+	  continue;
+	}
+
+      /* write to a temporary file first, so that a partially written
+	 archive never shows up under its final name */
+      if(!(tmpname = malloc((strlen(name)+5)*sizeof(char))))
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
+      sprintf(tmpname, "%s.tmp", name);
+
+      ay_wrib_primlevel = 0;
+      RiBegin(tmpname);
+       ay_status = ay_wrib_object(tmpname, ay_wriba_units[i].o);
+      RiEnd();
+
+      if(!ay_status && rename(tmpname, name))
+	{
+	  ay_error(AY_ERROR, fname, "could not rename archive file:");
+	  ay_error(AY_ERROR, fname, tmpname);
+	  ay_status = AY_ERROR;
+	}
+
+      if(ay_status)
+	(void)remove(tmpname);
+
+      free(tmpname);
+      tmpname = NULL;
+
+      if(ay_status)
+	goto cleanup;
+    } /* for */
+
+  ay_wriba_active = AY_TRUE;
+
+cleanup:
+
+  if(ay_status)
+    ay_wriba_clear();
+
+ return ay_status;
+} /* ay_wriba_write */
+
+
+/** ay_wriba_get:
+ *  get the name of the archive an object was written to
+ *  by ay_wriba_write()
+ *
+ * \param[in] o object
+ *
+ * \returns archive file name or NULL if the object is to be written
+ *  directly
+ */
+char *
+ay_wriba_get(ay_object *o)
+{
+ Tcl_HashEntry *entry;
+
+  if(!ay_wriba_active)
+    return NULL;
+
+  if(!(entry = Tcl_FindHashEntry(&ay_wriba_ht, (char*)o)))
+    return NULL;
+
+ return (char *)Tcl_GetHashValue(entry);
+} /* ay_wriba_get */
+
+
+/** ay_wriba_clear:
+ *  forget about all archives written by ay_wriba_write()
+ */
+void
+ay_wriba_clear(void)
+{
+ Tcl_HashEntry *entry;
+ Tcl_HashSearch search;
+
+  ay_wriba_active = AY_FALSE;
+
+  if(ay_wriba_htinit)
+    {
+      entry = Tcl_FirstHashEntry(&ay_wriba_ht, &search);
+      while(entry)
+	{
+	  free(Tcl_GetHashValue(entry));
+	  entry = Tcl_NextHashEntry(&search);
+	}
+      Tcl_DeleteHashTable(&ay_wriba_ht);
+      Tcl_InitHashTable(&ay_wriba_ht, TCL_ONE_WORD_KEYS);
+    }
+
+  if(ay_wriba_units)
+    free(ay_wriba_units);
+  ay_wriba_units = NULL;
+  ay_wriba_nunits = 0;
+  ay_wriba_aunits = 0;
+
+ return;
+} /* ay_wriba_clear */
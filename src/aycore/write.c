@@ -96,15 +96,17 @@ ay_write_tags(FILE *fileptr, ay_object *o)
  int ay_status = AY_OK;
  ay_tag *tag = NULL;
  int tcount = 0;
+ char *val;
 
   if(!o)
     return AY_ENULL;
 
-  /* count tags */
+  /* count tags (binary PV tags are written in their string form) */
   tag = o->tags;
   while(tag)
     {
-      if(tag->name && tag->val && !tag->is_intern && !tag->is_binary)
+      if(tag->name && tag->val && !tag->is_intern &&
+	 (!tag->is_binary || tag->type == ay_pv_tagtype))
 	{
 	  tcount++;
 	}
@@ -124,6 +126,15 @@ ay_write_tags(FILE *fileptr, ay_object *o)
 	  fprintf(fileptr, "%s\n", (char*)tag->val);
 	  ay_tags_vttonl((char*)tag->val);
 	}
+      else
+      if(tag->name && tag->val && !tag->is_intern &&
+	 tag->type == ay_pv_tagtype)
+	{
+	  if((ay_status = ay_pv_tostring(tag, &val)))
+	    return ay_status;
+	  fprintf(fileptr, "%s\n%s\n", tag->name, val);
+	  free(val);
+	}
       tag = tag->next;
     }
 
@@ -284,10 +295,11 @@ ay_write_object(FILE *fileptr, ay_object *o)
 
 
 /* ay_write_scene:
- *
+ *  save the scene (or just the selected objects) to file <fname>,
+ *  using the binary format if <binary> is AY_TRUE
  */
 int
-ay_write_scene(char *fname, int selected)
+ay_write_scene(char *fname, int selected, int binary)
 {
  int ay_status = AY_OK;
  ay_object *o = ay_root;
@@ -350,7 +362,10 @@ ay_write_scene(char *fname, int selected)
     }
 
   /* write header information */
-  ay_write_header(fileptr);
+  if(binary)
+    ay_bio_writeheader(fileptr);
+  else
+    ay_write_header(fileptr);
 
   /* omit EndLevel-object in top level! */
   while(o->next)
@@ -359,12 +374,18 @@ ay_write_scene(char *fname, int selected)
 	{
 	  if(o->selected)
 	    {
-	      ay_status = ay_write_object(fileptr, o);
+	      if(binary)
+		ay_status = ay_bio_writeobject(fileptr, o);
+	      else
+		ay_status = ay_write_object(fileptr, o);
 	    }
 	}
       else
 	{
-	  ay_status = ay_write_object(fileptr, o);
+	  if(binary)
+	    ay_status = ay_bio_writeobject(fileptr, o);
+	  else
+	    ay_status = ay_write_object(fileptr, o);
 	}
 
       if(ay_status)
@@ -396,19 +417,22 @@ ay_write_scenetcmd(ClientData clientData, Tcl_Interp *interp,
 		   int argc, char *argv[])
 {
  /*int ay_status = AY_OK;*/
- int selected = AY_FALSE;
+ int selected = AY_FALSE, binary = AY_FALSE;
 
   /* check args */
   if(argc < 2)
     {
-      ay_error(AY_EARGS, argv[0], "filename [1|0]");
+      ay_error(AY_EARGS, argv[0], "filename [1|0] [1|0]");
       return TCL_OK;
     }
 
   if(argc > 2)
     selected = atoi(argv[2]);
 
-  ay_write_scene(argv[1], selected);
+  if(argc > 3)
+    binary = atoi(argv[3]);
+
+  ay_write_scene(argv[1], selected, binary);
 
  return TCL_OK;
 } /* ay_write_scenetcmd */
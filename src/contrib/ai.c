@@ -26,6 +26,7 @@ int comp_true, comp_false;
 int ay_ai_ignoretags;
 int ay_ai_ignoremat;
 int ay_ai_scope;
+double ay_ai_tolerance;
 
 /* prototypes of functions local to this module */
 
@@ -35,9 +36,28 @@ int ay_ai_compchildren(ay_object *o1, ay_object *o2);
 
 int ay_ai_instanceobject(ay_object *inst, ay_object *ref);
 
-int ay_ai_createinstances(ay_object *ref, ay_object *o);
+unsigned int ay_ai_childrenhash(ay_object *o, unsigned int h);
 
-int ay_ai_makeinstances(ay_object *o, ay_object *level, ay_list_object *sel);
+unsigned int ay_ai_hash(ay_object *o);
+
+int ay_ai_compobjects(ay_object *ref, ay_object *o);
+
+int ay_ai_getpoints(ay_object *o, double **cv, unsigned int *n, int *stride);
+
+unsigned int ay_ai_hashtol(ay_object *o, double *q);
+
+void ay_ai_getframe(double *cv, unsigned int n, int stride,
+		    double *c, double *f);
+
+int ay_ai_comptol(ay_object *ref, ay_object *o, double *m);
+
+int ay_ai_settrafos(ay_object *ref, ay_object *o, double *m);
+
+int ay_ai_findref(Tcl_HashTable *refs, ay_object *o, int canref);
+
+int ay_ai_makeinstances(Tcl_HashTable *refs, ay_object *o, int canref);
+
+void ay_ai_clearrefs(Tcl_HashTable *refs);
 
 int ay_ai_resolveinstances(ay_object *o, ay_convertcb *cb);
 
@@ -178,67 +198,632 @@ ay_ai_instanceobject(ay_object *inst, ay_object *ref)
       inst->refine = ref;
       inst->type = AY_IDINSTANCE;
       ref->refcount++;
+
+      ay_notify_invalidate(NULL);
   }
 
  return ay_status;
 } /* ay_ai_instanceobject */
 
 
-/* ay_ai_createinstances:
- *  find matching objects and create instances
- *  for now check all objects in tree each time
+/* ay_ai_childrenhash:
+ *  add the children of o to hash value h; as ay_ai_compchildren()
+ *  requires the children of two matching objects to be (instances of)
+ *  the same masters with equal transformation attributes, the masters
+ *  and the transformation attributes are hashed
+ */
+unsigned int
+ay_ai_childrenhash(ay_object *o, unsigned int h)
+{
+ ay_object *d, *m;
+
+  if(!o->down)
+    return h;
+
+  d = o->down;
+  while(d->next)
+    {
+      if(d->type == AY_IDINSTANCE)
+	m = (ay_object *)d->refine;
+      else
+	m = d;
+      h = ay_comp_hashdata(h, &m, sizeof(ay_object*));
+      h = ay_comp_hashdoubles(h, &(d->movx), 1);
+      h = ay_comp_hashdoubles(h, &(d->movy), 1);
+      h = ay_comp_hashdoubles(h, &(d->movz), 1);
+      h = ay_comp_hashdoubles(h, &(d->scalx), 1);
+      h = ay_comp_hashdoubles(h, &(d->scaly), 1);
+      h = ay_comp_hashdoubles(h, &(d->scalz), 1);
+      h = ay_comp_hashdoubles(h, d->quat, 4);
+      d = d->next;
+    }
+
+ return h;
+} /* ay_ai_childrenhash */
+
+
+/* ay_ai_hash:
+ *  compute the hash value of object o that is used to find
+ *  matching objects, objects that are considered equal by
+ *  ay_ai_compobjects() get equal hash values
+ */
+unsigned int
+ay_ai_hash(ay_object *o)
+{
+ unsigned int h;
+
+  h = ay_comp_hashobject(o);
+
+  if(!ay_ai_ignoretags)
+    h = ay_comp_hashtags(o, h);
+
+  if(!ay_ai_ignoremat)
+    h = ay_comp_hashdata(h, &(o->mat), sizeof(void*));
+
+ return ay_ai_childrenhash(o, h);
+} /* ay_ai_hash */
+
+
+/* ay_ai_compobjects:
+ *  check whether o may become an instance of ref
  */
 int
-ay_ai_createinstances(ay_object *ref, ay_object *o)
+ay_ai_compobjects(ay_object *ref, ay_object *o)
 {
- int ay_status, ret = 0;
- ay_object *d = NULL;
 
-  /* do not create instance of reference object itself */
-  if(o != ref)
+  if((ref->type == o->type) && (o->refcount == 0))
+    {
+      /* could become an instance, check it out */
+      if((ay_comp_objects(ref, o)) &&
+	 ((ay_ai_ignoretags) || (ay_comp_tags(ref, o))) &&
+	 ((ay_ai_ignoremat) || (ref->mat == o->mat)) &&
+	 (((ref->down == NULL) && (o->down == NULL)) ||
+	  (ay_ai_compchildren(ref, o))))
+	{
+	  return AY_TRUE;
+	}
+    }
+
+ return AY_FALSE;
+} /* ay_ai_compobjects */
+
+
+/* ay_ai_getpoints:
+ *  get the control points of o for the tolerance based comparison,
+ *  return AY_FALSE if o is not supported
+ */
+int
+ay_ai_getpoints(ay_object *o, double **cv, unsigned int *n, int *stride)
+{
+ ay_nurbcurve_object *nc;
+ ay_nurbpatch_object *np;
+ ay_pomesh_object *po;
+
+  if(!o->refine)
+    return AY_FALSE;
+
+  switch(o->type)
+    {
+    case AY_IDNCURVE:
+      nc = (ay_nurbcurve_object *)o->refine;
+      *cv = nc->controlv;
+      *n = (unsigned int)nc->length;
+      *stride = 4;
+      break;
+    case AY_IDNPATCH:
+      np = (ay_nurbpatch_object *)o->refine;
+      *cv = np->controlv;
+      *n = (unsigned int)(np->width*np->height);
+      *stride = 4;
+      break;
+    case AY_IDPOMESH:
+      po = (ay_pomesh_object *)o->refine;
+      *cv = po->controlv;
+      *n = po->ncontrols;
+      *stride = po->has_normals?6:3;
+      break;
+    default:
+      return AY_FALSE;
+    } /* switch */
+
+ return (*n > 0);
+} /* ay_ai_getpoints */
+
+
+/* ay_ai_hashtol:
+ *  compute the hash value of all parameters of o that do not change
+ *  when the control points are moved or rotated (but not the points
+ *  themselves) plus a coarse, quantized, radius of gyration of the
+ *  control points (in q), that is also invariant
+ */
+unsigned int
+ay_ai_hashtol(ay_object *o, double *q)
+{
+ ay_nurbcurve_object *nc;
+ ay_nurbpatch_object *np;
+ ay_pomesh_object *po;
+ unsigned int h = 0, i, n = 0, total_loops = 0, total_verts = 0;
+ int stride = 3;
+ double *cv = NULL, c[3] = {0}, r = 0.0, *p;
+
+  h = ay_comp_hashdata(h, &(o->type), sizeof(unsigned int));
+
+  switch(o->type)
+    {
+    case AY_IDNCURVE:
+      nc = (ay_nurbcurve_object *)o->refine;
+      h = ay_comp_hashdata(h, &(nc->length), sizeof(int));
+      h = ay_comp_hashdata(h, &(nc->order), sizeof(int));
+      h = ay_comp_hashdata(h, &(nc->type), sizeof(int));
+      h = ay_comp_hashdoubles(h, nc->knotv, nc->length+nc->order);
+      break;
+    case AY_IDNPATCH:
+      np = (ay_nurbpatch_object *)o->refine;
+      h = ay_comp_hashdata(h, &(np->width), sizeof(int));
+      h = ay_comp_hashdata(h, &(np->height), sizeof(int));
+      h = ay_comp_hashdata(h, &(np->uorder), sizeof(int));
+      h = ay_comp_hashdata(h, &(np->vorder), sizeof(int));
+      h = ay_comp_hashdoubles(h, np->uknotv, np->width+np->uorder);
+      h = ay_comp_hashdoubles(h, np->vknotv, np->height+np->vorder);
+      break;
+    case AY_IDPOMESH:
+      po = (ay_pomesh_object *)o->refine;
+      h = ay_comp_hashdata(h, &(po->npolys), sizeof(unsigned int));
+      h = ay_comp_hashdata(h, &(po->ncontrols), sizeof(unsigned int));
+      h = ay_comp_hashdata(h, &(po->has_normals), sizeof(int));
+      for(i = 0; i < po->npolys; i++)
+	total_loops += po->nloops[i];
+      for(i = 0; i < total_loops; i++)
+	total_verts += po->nverts[i];
+      h = ay_comp_hashdata(h, po->nloops, po->npolys*sizeof(unsigned int));
+      h = ay_comp_hashdata(h, po->nverts, total_loops*sizeof(unsigned int));
+      h = ay_comp_hashdata(h, po->verts, total_verts*sizeof(unsigned int));
+      break;
+    default:
+      break;
+    } /* switch */
+
+  if(!ay_ai_ignoretags)
+    h = ay_comp_hashtags(o, h);
+
+  if(!ay_ai_ignoremat)
+    h = ay_comp_hashdata(h, &(o->mat), sizeof(void*));
+
+  h = ay_ai_childrenhash(o, h);
+
+  (void)ay_ai_getpoints(o, &cv, &n, &stride);
+
+  p = cv;
+  for(i = 0; i < n; i++)
+    {
+      c[0] += p[0];
+      c[1] += p[1];
+      c[2] += p[2];
+      p += stride;
+    }
+  if(n)
+    {
+      AY_V3SCAL(c, 1.0/n);
+    }
+  p = cv;
+  for(i = 0; i < n; i++)
+    {
+      r += (p[0]-c[0])*(p[0]-c[0]) + (p[1]-c[1])*(p[1]-c[1]) +
+	(p[2]-c[2])*(p[2]-c[2]);
+      p += stride;
+    }
+  if(n)
+    r = sqrt(r/n);
+
+  /* the radius of two matching point sets differs by at most the
+     tolerance, so that they end up in the same or adjacent cells */
+  *q = floor(r/(2.0*ay_ai_tolerance));
+
+ return h;
+} /* ay_ai_hashtol */
+
+
+/* ay_ai_getframe:
+ *  compute a coordinate frame (c, f) from the control points cv
+ *  that moves and rotates with the points; the points defining the
+ *  frame are picked by index using only distances (which are
+ *  invariant), so that the same points are picked in a moved or
+ *  rotated copy
+ */
+void
+ay_ai_getframe(double *cv, unsigned int n, int stride, double *c, double *f)
+{
+ unsigned int i;
+ double *p, d[3], t[3], len, max = 0.0;
+ double *u = f, *v = &(f[3]), *w = &(f[6]);
+
+  memset(c, 0, 3*sizeof(double));
+  p = cv;
+  for(i = 0; i < n; i++)
+    {
+      c[0] += p[0];
+      c[1] += p[1];
+      c[2] += p[2];
+      p += stride;
+    }
+  AY_V3SCAL(c, 1.0/n);
+
+  /* default frame */
+  memset(f, 0, 9*sizeof(double));
+  u[0] = 1.0;
+  v[1] = 1.0;
+  w[2] = 1.0;
+
+  /* u: first point that is at least half as far away
+     from the center as the farthest point */
+  p = cv;
+  for(i = 0; i < n; i++)
     {
+      AY_V3SUB(d, p, c);
+      len = AY_V3LEN(d);
+      if(len > max)
+	max = len;
+      p += stride;
+    }
+  if(max <= AY_EPSILON)
+    return;
+  p = cv;
+  for(i = 0; i < n; i++)
+    {
+      AY_V3SUB(d, p, c);
+      len = AY_V3LEN(d);
+      if(len >= 0.5*max)
+	{
+	  memcpy(u, d, 3*sizeof(double));
+	  AY_V3SCAL(u, 1.0/len);
+	  break;
+	}
+      p += stride;
+    }
 
-      /* process children first */
-      if(o->down && o->down->next)
+  /* v: likewise, but using the distance from the axis u */
+  max = 0.0;
+  p = cv;
+  for(i = 0; i < n; i++)
+    {
+      AY_V3SUB(d, p, c);
+      AY_V3CROSS(t, d, u);
+      len = AY_V3LEN(t);
+      if(len > max)
+	max = len;
+      p += stride;
+    }
+  if(max <= AY_EPSILON)
+    {
+      /* all points are on a line, any perpendicular will do */
+      if(fabs(u[0]) < 0.9)
+	{
+	  d[0] = 1.0; d[1] = 0.0; d[2] = 0.0;
+	}
+      else
 	{
-	  d = o->down;
-	  while(d->next)
+	  d[0] = 0.0; d[1] = 1.0; d[2] = 0.0;
+	}
+      AY_V3CROSS(t, u, d);
+      len = AY_V3LEN(t);
+      AY_V3SCAL(t, 1.0/len);
+      AY_V3CROSS(v, t, u);
+    }
+  else
+    {
+      p = cv;
+      for(i = 0; i < n; i++)
+	{
+	  AY_V3SUB(d, p, c);
+	  AY_V3CROSS(t, d, u);
+	  len = AY_V3LEN(t);
+	  if(len >= 0.5*max)
 	    {
-	      ret += ay_ai_createinstances(ref, d);
-	      d = d->next;
+	      /* v = u x (d x u), normalized */
+	      AY_V3CROSS(v, u, t);
+	      len = AY_V3LEN(v);
+	      AY_V3SCAL(v, 1.0/len);
+	      break;
 	    }
+	  p += stride;
+	}
+    }
+
+  AY_V3CROSS(w, u, v);
+
+ return;
+} /* ay_ai_getframe */
+
+
+/* ay_ai_comptol:
+ *  check whether the control points of o are a moved and rotated
+ *  copy of the control points of ref (within the tolerance) and
+ *  compute the matrix m that transforms the latter to the former;
+ *  all other parameters must match exactly
+ */
+int
+ay_ai_comptol(ay_object *ref, ay_object *o, double *m)
+{
+ ay_nurbcurve_object *nc1, *nc2;
+ ay_nurbpatch_object *np1, *np2;
+ ay_pomesh_object *po1, *po2;
+ double *cv1, *cv2, *p1, *p2, *n, c1[3], c2[3], f1[9], f2[9], t[3], d[3];
+ unsigned int i, n1, n2, total_loops = 0, total_verts = 0;
+ int r, k, stride1, stride2;
+
+  if((ref->type != o->type) || (o->refcount != 0))
+    return AY_FALSE;
+
+  if(!ay_ai_getpoints(ref, &cv1, &n1, &stride1) ||
+     !ay_ai_getpoints(o, &cv2, &n2, &stride2) ||
+     (n1 != n2) || (stride1 != stride2))
+    return AY_FALSE;
+
+  /* compare all parameters but the control points */
+  switch(o->type)
+    {
+    case AY_IDNCURVE:
+      nc1 = (ay_nurbcurve_object *)ref->refine;
+      nc2 = (ay_nurbcurve_object *)o->refine;
+      if((nc1->order != nc2->order) || (nc1->type != nc2->type) ||
+	 memcmp(nc1->knotv, nc2->knotv,
+		(nc1->length+nc1->order)*sizeof(double)))
+	return AY_FALSE;
+      break;
+    case AY_IDNPATCH:
+      np1 = (ay_nurbpatch_object *)ref->refine;
+      np2 = (ay_nurbpatch_object *)o->refine;
+      if((np1->width != np2->width) || (np1->uorder != np2->uorder) ||
+	 (np1->vorder != np2->vorder) ||
+	 memcmp(np1->uknotv, np2->uknotv,
+		(np1->width+np1->uorder)*sizeof(double)) ||
+	 memcmp(np1->vknotv, np2->vknotv,
+		(np1->height+np1->vorder)*sizeof(double)))
+	return AY_FALSE;
+      break;
+    case AY_IDPOMESH:
+      po1 = (ay_pomesh_object *)ref->refine;
+      po2 = (ay_pomesh_object *)o->refine;
+      if((po1->npolys != po2->npolys) ||
+	 memcmp(po1->nloops, po2->nloops, po1->npolys*sizeof(unsigned int)))
+	return AY_FALSE;
+      for(i = 0; i < po1->npolys; i++)
+	total_loops += po1->nloops[i];
+      if(memcmp(po1->nverts, po2->nverts, total_loops*sizeof(unsigned int)))
+	return AY_FALSE;
+      for(i = 0; i < total_loops; i++)
+	total_verts += po1->nverts[i];
+      if(memcmp(po1->verts, po2->verts, total_verts*sizeof(unsigned int)))
+	return AY_FALSE;
+      break;
+    default:
+      return AY_FALSE;
+    } /* switch */
+
+  if((!ay_ai_ignoretags && !ay_comp_tags(ref, o)) ||
+     (!ay_ai_ignoremat && (ref->mat != o->mat)) ||
+     !(((ref->down == NULL) && (o->down == NULL)) ||
+       (ay_ai_compchildren(ref, o))))
+    return AY_FALSE;
+
+  /* m = F2 * F1^T (rotation) plus translation c2 - m * c1 */
+  ay_ai_getframe(cv1, n1, stride1, c1, f1);
+  ay_ai_getframe(cv2, n2, stride2, c2, f2);
+
+  memset(m, 0, 16*sizeof(double));
+  for(r = 0; r < 3; r++)
+    {
+      for(k = 0; k < 3; k++)
+	{
+	  m[r+4*k] = f2[r]*f1[k] + f2[3+r]*f1[3+k] + f2[6+r]*f1[6+k];
+	}
+    }
+  for(r = 0; r < 3; r++)
+    {
+      m[12+r] = c2[r] - (m[r]*c1[0] + m[r+4]*c1[1] + m[r+8]*c1[2]);
+    }
+  m[15] = 1.0;
+
+  /* verify */
+  p1 = cv1;
+  p2 = cv2;
+  for(i = 0; i < n1; i++)
+    {
+      memcpy(t, p1, 3*sizeof(double));
+      ay_trafo_apply3(t, m);
+      AY_V3SUB(d, t, p2);
+      if(AY_V3LEN(d) > ay_ai_tolerance)
+	return AY_FALSE;
+
+      if(stride1 == 4)
+	{
+	  /* weight */
+	  if(fabs(p1[3]-p2[3]) > ay_ai_tolerance)
+	    return AY_FALSE;
+	}
+      else
+	if(stride1 == 6)
+	  {
+	    /* vertex normal */
+	    for(r = 0; r < 3; r++)
+	      t[r] = m[r]*p1[3] + m[r+4]*p1[4] + m[r+8]*p1[5];
+	    n = &(p2[3]);
+	    AY_V3SUB(d, t, n);
+	    if(AY_V3LEN(d) > ay_ai_tolerance)
+	      return AY_FALSE;
+	  }
+
+      p1 += stride1;
+      p2 += stride2;
+    } /* for */
+
+ return AY_TRUE;
+} /* ay_ai_comptol */
+
+
+/* ay_ai_settrafos:
+ *  set the transformation attributes of o (a moved and rotated copy
+ *  of ref according to m, see ay_ai_comptol()) so that it may
+ *  become an instance of ref; this fails, if the combined transformation
+ *  can not be expressed by transformation attributes (e.g. if o is
+ *  non-uniformly scaled)
+ */
+int
+ay_ai_settrafos(ay_object *ref, ay_object *o, double *m)
+{
+ ay_object save = {0};
+ double *cv1, *cv2, *p1, *p2, mo[16], mn[16], t1[3], t2[3], d[3], s;
+ unsigned int i, n1, n2;
+ int stride1, stride2;
+
+  (void)ay_ai_getpoints(ref, &cv1, &n1, &stride1);
+  (void)ay_ai_getpoints(o, &cv2, &n2, &stride2);
+
+  ay_trafo_copy(o, &save);
+
+  ay_trafo_identitymatrix(mo);
+  ay_trafo_getall(NULL, o, mo);
+
+  memcpy(mn, mo, 16*sizeof(double));
+  ay_trafo_multmatrix(mn, m);
+  ay_trafo_decomposematrix(mn, o);
+
+  ay_trafo_identitymatrix(mn);
+  ay_trafo_getall(NULL, o, mn);
+
+  s = fabs(save.scalx);
+  if(fabs(save.scaly) > s)
+    s = fabs(save.scaly);
+  if(fabs(save.scalz) > s)
+    s = fabs(save.scalz);
+
+  p1 = cv1;
+  p2 = cv2;
+  for(i = 0; i < n1; i++)
+    {
+      memcpy(t1, p1, 3*sizeof(double));
+      ay_trafo_apply3(t1, mn);
+      memcpy(t2, p2, 3*sizeof(double));
+      ay_trafo_apply3(t2, mo);
+      AY_V3SUB(d, t1, t2);
+      if(AY_V3LEN(d) > 2.0*s*ay_ai_tolerance)
+	{
+	  ay_trafo_copy(&save, o);
+	  return AY_FALSE;
+	}
+      p1 += stride1;
+      p2 += stride2;
+    }
+
+ return AY_TRUE;
+} /* ay_ai_settrafos */
+
+
+/* ay_ai_findref:
+ *  find a reference object for o in the hash table refs and
+ *  turn o into an instance of it, otherwise add o to the hash
+ *  table (if canref is AY_TRUE);
+ *  returns AY_TRUE if an instance was created
+ */
+int
+ay_ai_findref(Tcl_HashTable *refs, ay_object *o, int canref)
+{
+ int new_item = 0, tol = AY_FALSE, i, found = AY_FALSE;
+ unsigned int h, key, n;
+ int stride;
+ double q = 0.0, qi, m[16], *cv;
+ Tcl_HashEntry *entry;
+ ay_list_object *l, *ref = NULL;
+
+  if((ay_ai_tolerance > 0.0) && ay_ai_getpoints(o, &cv, &n, &stride))
+    tol = AY_TRUE;
+
+  if(tol)
+    h = ay_ai_hashtol(o, &q);
+  else
+    h = ay_ai_hash(o);
+
+  /* in tolerance mode, also check the adjacent cells */
+  for(i = (tol?-1:0); (i <= (tol?1:0)) && !found; i++)
+    {
+      key = h;
+      if(tol)
+	{
+	  qi = q+i;
+	  key = ay_comp_hashdata(h, &qi, sizeof(double));
 	}
 
-      /* easy/fast checks first */
-      if((ref->type == o->type) && (o->refcount == 0))
+      entry = Tcl_FindHashEntry(refs, (char*)(size_t)key);
+      if(!entry)
+	continue;
+
+      l = (ay_list_object *)Tcl_GetHashValue(entry);
+      while(l)
 	{
-	  /* could become an instance, check it out */
-	  if((ay_comp_objects(ref, o)) &&
-	     ((ay_ai_ignoretags) || (ay_comp_tags(ref, o))) &&
-	     ((ay_ai_ignoremat) || (ref->mat == o->mat)) &&
-	     (((ref->down == NULL) && (o->down == NULL)) ||
-	      (ay_ai_compchildren(ref, o))))
+	  /* exact matches first */
+	  if(ay_ai_compobjects(l->object, o))
 	    {
-	      /* create instance */
-	      ay_status = ay_ai_instanceobject(o, ref);
-	      if(ay_status)
-		return ret;
-	      ret++;
-	    } /* if */
+	      found = AY_TRUE;
+	      break;
+	    }
+	  if(tol && ay_ai_comptol(l->object, o, m) &&
+	     ay_ai_settrafos(l->object, o, m))
+	    {
+	      found = AY_TRUE;
+	      break;
+	    }
+	  l = l->next;
+	} /* while */
+
+      if(found)
+	ref = l;
+    } /* for */
 
-	} /* if */
+  if(found)
+    {
+      if(ay_ai_instanceobject(o, ref->object))
+	return AY_FALSE;
+      return AY_TRUE;
+    }
 
+  if(canref)
+    {
+      /* add o to the hash table, behind all previous
+	 reference objects with the same hash value */
+      if(!(l = calloc(1, sizeof(ay_list_object))))
+	return AY_FALSE;
+      l->object = o;
+
+      key = h;
+      if(tol)
+	key = ay_comp_hashdata(h, &q, sizeof(double));
+
+      entry = Tcl_CreateHashEntry(refs, (char*)(size_t)key, &new_item);
+      if(new_item)
+	{
+	  Tcl_SetHashValue(entry, (char*)l);
+	}
+      else
+	{
+	  ref = (ay_list_object *)Tcl_GetHashValue(entry);
+	  while(ref->next)
+	    ref = ref->next;
+	  ref->next = l;
+	}
     } /* if */
 
- return ret;
-} /* ay_ai_createinstances */
+ return AY_FALSE;
+} /* ay_ai_findref */
 
 
 /* ay_ai_makeinstances:
- * find identical objects and create instances
+ *  find identical objects and create instances;
+ *  the children are processed first, so that ay_ai_compchildren()
+ *  may work on instances; NPatch children (trim curves) may become
+ *  instances but not reference objects
  */
 int
-ay_ai_makeinstances(ay_object *o, ay_object *level, ay_list_object *sel)
+ay_ai_makeinstances(Tcl_HashTable *refs, ay_object *o, int canref)
 {
  int ret = 0;
  ay_object *d = NULL;
@@ -249,44 +834,49 @@ ay_ai_makeinstances(ay_object *o, ay_object *level, ay_list_object *sel)
       d = o->down;
       while(d->next)
 	{
-	  if(d->type != AY_IDNPATCH)
-	    {
-	      ret += ay_ai_makeinstances(d, level, sel);
-	    }
+	  ret += ay_ai_makeinstances(refs, d,
+				     canref && (o->type != AY_IDNPATCH));
 	  d = d->next;
 	}
     } /* if */
 
-  /* now create instances of "o", if "o" isnt an instance itself */
-  if(ay_ai_instanceabletype(o->type))
+  /* now create an instance of "o", if "o" is not an instance itself */
+  if(ay_ai_instanceabletype(o->type) && o->refine)
     {
-      /* avoid working on the root */
-      if(sel && (sel->object == ay_root))
-	{
-	  sel = sel->next;
-	}
+      ret += ay_ai_findref(refs, o, canref);
+    }
+
+ return ret;
+} /* ay_ai_makeinstances */
 
-      if(sel)
+
+/* ay_ai_clearrefs:
+ *  free the hash table of reference objects
+ */
+void
+ay_ai_clearrefs(Tcl_HashTable *refs)
+{
+ Tcl_HashEntry *entry;
+ Tcl_HashSearch search;
+ ay_list_object *l, *next;
+
+  entry = Tcl_FirstHashEntry(refs, &search);
+  while(entry)
+    {
+      l = (ay_list_object *)Tcl_GetHashValue(entry);
+      while(l)
 	{
-	  while(sel)
-	    {
-	      ret += ay_ai_createinstances(o, sel->object);
-	      sel = sel->next;
-	    }
+	  next = l->next;
+	  free(l);
+	  l = next;
 	}
-      else
-	{
-	  d = level;
-	  while(d->next)
-	    {
-	      ret += ay_ai_createinstances(o, d);
-	      d = d->next;
-	    }
-	} /* if */
-    } /* if */
+      entry = Tcl_NextHashEntry(&search);
+    }
 
- return ret;
-} /* ay_ai_makeinstances */
+  Tcl_DeleteHashTable(refs);
+
+ return;
+} /* ay_ai_clearrefs */
 
 
 /* ay_ai_resolveinstances:
@@ -334,6 +924,7 @@ ay_ai_tcmd(ClientData clientData, Tcl_Interp *interp,
  ay_list_object *sel = NULL, *cursel;
  ay_voidfp *arr;
  ay_convertcb *cb;
+ Tcl_HashTable refs;
 
   /* is the command "ai_resolveInstances"? */
   if(argv[0][3] == 'r')
@@ -356,6 +947,12 @@ ay_ai_tcmd(ClientData clientData, Tcl_Interp *interp,
   to = Tcl_ObjGetVar2(interp, toa, ton, TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
   Tcl_GetIntFromObj(interp, to, &ay_ai_scope);
 
+  ay_ai_tolerance = 0.0;
+  Tcl_SetStringObj(ton, "Tolerance", -1);
+  to = Tcl_ObjGetVar2(interp, toa, ton, TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+  if(to)
+    Tcl_GetDoubleFromObj(interp, to, &ay_ai_tolerance);
+
   scope = ay_ai_scope;
   cursel = ay_selection;
 
@@ -436,26 +1033,29 @@ ay_ai_tcmd(ClientData clientData, Tcl_Interp *interp,
   comp_false = 0;
   */
 
+  Tcl_InitHashTable(&refs, TCL_ONE_WORD_KEYS);
+
   if(cursel)
     {
       sel = cursel;
       while(sel)
 	{
-	  numinst += ay_ai_makeinstances(sel->object, ay_currentlevel->object,
-					 cursel);
+	  numinst += ay_ai_makeinstances(&refs, sel->object, AY_TRUE);
 	  sel = sel->next;
 	}
     }
   else
     {
       o = level;
-      while(o)
+      while(o->next)
 	{
-	  numinst += ay_ai_makeinstances(o, level, NULL);
+	  numinst += ay_ai_makeinstances(&refs, o, AY_TRUE);
 	  o = o->next;
 	}
     } /* if */
 
+  ay_ai_clearrefs(&refs);
+
   sprintf(str, "%d instances created", numinst);
 
   ay_error(AY_EOUTPUT, fname, str);
@@ -532,6 +532,9 @@ ay_objsel_processcb(struct Togl *togl, int argc, char *argv[])
 
   glGetIntegerv(GL_VIEWPORT, viewport);
 
+  /* the cached vertex buffers may also be drawn when picking */
+  ay_vbo_begin(togl);
+
   glSelectBuffer(1024, selectBuf);
   glRenderMode(GL_SELECT);
 
@@ -632,6 +635,8 @@ ay_objsel_processcb(struct Togl *togl, int argc, char *argv[])
 
   hits = glRenderMode(GL_RENDER);
 
+  ay_vbo_end();
+
   ay_prefs.glu_sampling_tolerance = tolerance;
 
   if(argv[2][0] == '-')
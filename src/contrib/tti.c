@@ -1318,6 +1318,7 @@ cleanup:
 
   if(ttfont->buffer)
     free(ttfont->buffer);
+  ttfont->buffer = NULL;
   if(ttfont->fontptr)
     fclose(ttfont->fontptr);
 
@@ -1377,33 +1378,64 @@ ay_tti_freeletter(ay_tti_letter *vert)
 } /* ay_tti_freeletter */
 
 
+/* get the outlines of a letter; fonts stay open (keyed by file name)
+   until ay_tti_getcurves() is called with <ttfname> NULL */
 int
 ay_tti_getcurves(char *ttfname, int letter, ay_tti_letter *cur)
 {
- static ay_tti_font *font = NULL;
- int error = 0;
+ static int fontsinitialized = AY_FALSE;
+ static Tcl_HashTable fonts;
+ Tcl_HashEntry *entry;
+ Tcl_HashSearch search;
+ ay_tti_font *font = NULL;
+ int error = 0, new_item = 0;
+
+  if(!fontsinitialized)
+    {
+      Tcl_InitHashTable(&fonts, TCL_STRING_KEYS);
+      fontsinitialized = AY_TRUE;
+    }
 
   if(!ttfname)
     {
-      if(font)
+      /* close all open fonts */
+      entry = Tcl_FirstHashEntry(&fonts, &search);
+      while(entry)
 	{
+	  font = (ay_tti_font *)Tcl_GetHashValue(entry);
 	  ay_tti_close(font);
 	  free(font);
+	  entry = Tcl_NextHashEntry(&search);
 	}
-      font = NULL;
+      Tcl_DeleteHashTable(&fonts);
+      Tcl_InitHashTable(&fonts, TCL_STRING_KEYS);
       return error;
     }
 
-  if(!font)
+  entry = Tcl_CreateHashEntry(&fonts, ttfname, &new_item);
+
+  if(new_item)
     {
       if(!(font = calloc(1, sizeof(ay_tti_font))))
-	return error;
+	{
+	  Tcl_DeleteHashEntry(entry);
+	  return AY_TTI_NOMEM;
+	}
 
       error = ay_tti_open(font, ttfname); /* open font */
       if(error != AY_TTI_OK)
 	{
+	  ay_tti_close(font);
+	  free(font);
+	  Tcl_DeleteHashEntry(entry);
 	  return error;
 	}
+
+      Tcl_SetHashValue(entry, (char*)font);
+    }
+  else
+    {
+      font = (ay_tti_font *)Tcl_GetHashValue(entry);
     }
 
   error = ay_tti_getchar(font, letter, cur); /* get curves for letter */
@@ -34,6 +34,23 @@ int ay_act_multmatrixmn(int m, int n, double *M1, double *M2, double *R);
  */
 int ay_act_solve(int m, int n, double *A, double *B, double *X);
 
+/** Evaluate the basis functions for a least squares approximation.
+ */
+int ay_act_basisfuns(int m, int n, int p, double *ub, double *U,
+		     int **spans, double **funs);
+
+/** Set up and decompose the normal equations of a least squares
+ *  approximation.
+ */
+int ay_act_normalmatrix(int m, int p, int *spans, double *funs,
+			int first, int nx, double **NN);
+
+/** Solve the normal equations of a least squares approximation.
+ */
+void ay_act_normalsolve(int m, int p, int *spans, double *funs,
+			int first, int nx, double *NN,
+			double *B, int Bstride, double *X);
+
 /** Resize a approximating curve.
  */
 int ay_act_resize(ay_acurve_object *curve, int new_length);
@@ -159,6 +176,10 @@ int ay_bevelt_findbevelcurve(int index, ay_object **c);
 int ay_bevelt_createconcat(int side, ay_object *o, ay_object *c,
 			   ay_object **bevel);
 
+/** Initialize the bevel tools module.
+ */
+void ay_bevelt_init();
+
 
 /* capt.c */
 
@@ -437,6 +458,30 @@ int ay_nb_LUDecompose(int n, double *A, int *pivot);
  */
 int ay_nb_LUInvert(int n, double *inv, int *pivot);
 
+/** Do a LU decomposition of the nxn band matrix AB.
+ */
+int ay_nb_BandLUDecompose(int n, int kl, int ku, double *AB, int *pivot);
+
+/** Solve a LU decomposed band equation system.
+ */
+void ay_nb_BandLUSolve(int n, int kl, int ku, double *AB, int *pivot,
+		       int nrhs, int stride, double *B);
+
+/** Do a Cholesky decomposition of the nxn band matrix AB.
+ */
+int ay_nb_BandCholeskyDecompose(int n, int kd, double *AB);
+
+/** Solve a Cholesky decomposed band equation system.
+ */
+void ay_nb_BandCholeskySolve(int n, int kd, double *AB,
+			     int nrhs, int stride, double *B);
+
+/** Set up and decompose the band matrix of a global interpolation.
+ */
+int ay_nb_GlobalInterpolationLU(int n, double *ub, double *Uc, int d,
+				int ders, int *kl, int *ku,
+				double **AB, int **pivot);
+
 /** Interpolate the n+1 4D points in Q.
  */
 int ay_nb_GlobalInterpolation4D(int n, double *Q, double *ub, double *Uc,
@@ -447,6 +492,13 @@ int ay_nb_GlobalInterpolation4D(int n, double *Q, double *ub, double *Uc,
 int ay_nb_GlobalInterpolation4DD(int n, double *Q, double *ub, double *Uc,
 				 int d, double *D1, double *D2);
 
+/** Interpolate the n+1 4D points in Q with end derivatives using
+ *  a decomposed band matrix.
+ */
+void ay_nb_GlobalInterpolation4DDSolve(int n, double *Q, double *D1,
+				       double *D2, int kl, int ku,
+				       double *AB, int *pivot);
+
 /** Remove a knot from a NURBS curve.
  */
 int ay_nb_RemoveKnotCurve4D(int n, int p, double *U, double *Pw, double tol,
@@ -529,6 +581,11 @@ int ay_nb_SurfacePoint3D(int n, int m, int p, int q, double *U, double *V,
 void ay_nb_DersBasisFuns(int i, double u, int p, int n, double *U,
 			 double *ders);
 
+/** Calculate derivatives of NURBS basis funs in provided memory.
+ */
+void ay_nb_DersBasisFunsM(int i, double u, int p, int n, double *U,
+			  double *ders);
+
 /** Calculate first derivative of non-rational NURBS curve.
  */
 void ay_nb_FirstDer3D(int n, int p, double *U, double *P, double u,
@@ -908,16 +965,22 @@ int ay_nct_curvplottcmd(ClientData clientData, Tcl_Interp *interp,
 int ay_nct_getcurvaturetcmd(ClientData clientData, Tcl_Interp *interp,
 			    int argc, char *argv[]);
 
-/** Unfinished.
+/** Calculate all intersections of two curves.
  */
 int ay_nct_intersect(ay_nurbcurve_object *cu, ay_nurbcurve_object *cv,
-		     double *intersection);
+		     double tolerance, double **intersections,
+		     int *nintersections);
 
 /** Calculate intersections of two sets of curves.
  */
 int ay_nct_intersectsets(int ncu, ay_object *cu, int ncv, ay_object *cv,
 			 double *intersections);
 
+/** Tcl command to intersect the two selected NURBS curves.
+ */
+int ay_nct_intersecttcmd(ClientData clientData, Tcl_Interp *interp,
+			 int argc, char *argv[]);
+
 /** Check a number of curves for compatibility.
  */
 int ay_nct_iscompatible(ay_object *curves, int level, int *result);
@@ -1711,12 +1774,37 @@ void ay_pmt_getbasis(int btype, double **result);
 void ay_pmt_init();
 
 
+/* rcast.c */
+
+/** Create bounding volume hierarchy for ray casting against a NURBS patch.
+ */
+int ay_rcast_create(ay_object *o, ay_rcast_bvh **result);
+
+/** Free bounding volume hierarchy.
+ */
+void ay_rcast_destroy(ay_rcast_bvh *bvh);
+
+/** Find nearest intersection of a ray with a NURBS patch.
+ */
+int ay_rcast_intersect(ay_rcast_bvh *bvh, double *ro, double *rd,
+		       double *t, double *uv, double *p, double *n);
+
+/** Find nearest intersection of a ray with a NURBS patch object.
+ */
+int ay_rcast_intersectobject(ay_object *o, double *ro, double *rd,
+			     double *uv, double *p);
+
+
 /* stess.c */
 
 /** Remove tesselation from NURBS patch.
  */
 void ay_stess_destroy(ay_stess_patch *stess);
 
+/** Remove all level of detail tesselations from NURBS patch.
+ */
+void ay_stess_destroylods(ay_stess_patch **lods);
+
 /** Calculate stess usable quality factor from GLU sampling tolerance.
  */
 int ay_stess_GetQF(double gst);
@@ -494,6 +494,157 @@ cleanup:
 } /* ay_act_solve */
 
 
+/* ay_act_basisfuns:
+ *  evaluate the <p>+1 non-zero basis functions of a curve with <n>
+ *  control points and knots <U> at all <m> parameter values in <ub>;
+ *  returns the spans in <spans[m]> and the basis functions in
+ *  <funs[m*(p+1)]> (both allocated here); since all other basis
+ *  functions are zero, this is all that is needed of the (banded)
+ *  basis function matrix N of a least squares approximation
+ */
+int
+ay_act_basisfuns(int m, int n, int p, double *ub, double *U,
+		 int **spans, double **funs)
+{
+ int ay_status = AY_OK;
+ int i, span;
+
+  if(!ub || !U || !spans || !funs)
+    return AY_ENULL;
+
+  if(!(*spans = malloc(m*sizeof(int))))
+    return AY_EOMEM;
+
+  if(!(*funs = calloc(m*(p+1), sizeof(double))))
+    {
+      free(*spans);
+      *spans = NULL;
+      return AY_EOMEM;
+    }
+
+  for(i = 0; i < m; i++)
+    {
+      span = ay_nb_FindSpan(n, p, ub[i], U);
+
+      /* protect BasisFuns() from bad spans */
+      if(span >= n)
+	span = n-1;
+
+      ay_status = ay_nb_BasisFuns(span, ub[i], p, U, &((*funs)[i*(p+1)]));
+      if(ay_status)
+	{
+	  free(*spans);
+	  *spans = NULL;
+	  free(*funs);
+	  *funs = NULL;
+	  return ay_status;
+	}
+      (*spans)[i] = span;
+    } /* for */
+
+ return AY_OK;
+} /* ay_act_basisfuns */
+
+
+/* ay_act_normalmatrix:
+ *  set up the matrix N^T*N of the normal equations of a least squares
+ *  approximation for the unknowns (control points) <first> to
+ *  <first+nx-1> from the basis functions <spans[m]>, <funs[m*(p+1)]>
+ *  created by ay_act_basisfuns() and Cholesky decompose it;
+ *  N^T*N is a symmetric band matrix with <p> sub-diagonals, its
+ *  lower triangle is stored as explained in
+ *  ay_nb_BandCholeskyDecompose() in <NN> (allocated here);
+ *  the decomposed matrix only depends on the parameter values and
+ *  knots and may be used to approximate many sets of data points
+ *  using ay_act_normalsolve() below
+ */
+int
+ay_act_normalmatrix(int m, int p, int *spans, double *funs,
+		    int first, int nx, double **NN)
+{
+ int ay_status = AY_OK;
+ int a, b, i, ca, cb, w;
+ double *f;
+
+  if(!spans || !funs || !NN)
+    return AY_ENULL;
+
+  w = p+1;
+
+  if(!(*NN = calloc(nx*w, sizeof(double))))
+    return AY_EOMEM;
+
+  /* do NN=N^T*N, visiting only the non-zero elements of N */
+  for(i = 0; i < m; i++)
+    {
+      f = &(funs[i*w]);
+      for(a = 0; a <= p; a++)
+	{
+	  ca = spans[i]-p+a-first;
+	  if(ca < 0 || ca >= nx)
+	    continue;
+	  for(b = 0; b <= a; b++)
+	    {
+	      cb = spans[i]-p+b-first;
+	      if(cb < 0)
+		continue;
+	      (*NN)[ca*w+cb-ca+p] += f[a]*f[b];
+	    }
+	}
+    } /* for */
+
+  ay_status = ay_nb_BandCholeskyDecompose(nx, p, *NN);
+
+  if(ay_status)
+    {
+      free(*NN);
+      *NN = NULL;
+    }
+
+ return ay_status;
+} /* ay_act_normalmatrix */
+
+
+/* ay_act_normalsolve:
+ *  solve the normal equations N^T*N*X = N^T*B of a least squares
+ *  approximation, where N^T*N was set up and decomposed by
+ *  ay_act_normalmatrix() above; the right hand sides (data points)
+ *  are read from <B[m*Bstride]>, the results are stored in <X[nx*3]>
+ */
+void
+ay_act_normalsolve(int m, int p, int *spans, double *funs,
+		   int first, int nx, double *NN,
+		   double *B, int Bstride, double *X)
+{
+ int a, i, c, w;
+ double f;
+
+  w = p+1;
+
+  memset(X, 0, nx*3*sizeof(double));
+
+  /* set up R=N^T*B in X */
+  for(i = 0; i < m; i++)
+    {
+      for(a = 0; a <= p; a++)
+	{
+	  c = spans[i]-p+a-first;
+	  if(c < 0 || c >= nx)
+	    continue;
+	  f = funs[i*w+a];
+	  X[c*3]   += f*B[i*Bstride];
+	  X[c*3+1] += f*B[i*Bstride+1];
+	  X[c*3+2] += f*B[i*Bstride+2];
+	}
+    } /* for */
+
+  /* solve the linear equation system NN*X=R */
+  ay_nb_BandCholeskySolve(nx, p, NN, 3, 3, X);
+
+ return;
+} /* ay_act_normalsolve */
+
+
 /* ay_act_leastSquares:
  *  approximate the data points in <Q[m>] with a NURBS curve of degree <p>
  *  with <n> control points, return results in <U> and <P>
@@ -503,11 +654,10 @@ ay_act_leastSquares(double *Q, int m, int n, int p, int kt,
 		    double **U, double **P)
 {
  int ay_status = AY_OK;
- int a, i, i2, j, k, istride = 3, ostride = 4, span;
- double da, d, *ub = NULL;
- double *Ns = NULL, *Nt = NULL, *NN = NULL;
- double *R = NULL, *rk = NULL, *N = NULL, *X = NULL;
- double *funs = NULL;
+ int a, i, i2, j, k, istride = 3, ostride = 4, *spans = NULL;
+ double da, d, *ub = NULL, N0, Nn;
+ double *NN = NULL, *rk = NULL, *X = NULL;
+ double *funs = NULL, *f;
 
   if(!Q || !U || !P)
     return AY_ENULL;
@@ -564,105 +714,17 @@ ay_act_leastSquares(double *Q, int m, int n, int p, int kt,
       (*U)[i] = 1.0;
     }
 
-  if(!(R = calloc(n*istride, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  if(!(rk = calloc(m*istride, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  /* Note well: N is nxm! (not mxn, as suggested by the NURBS book) */
-  if(!(N = calloc(n*m, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  if(!(funs = calloc(p+1, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  /* set up N and rk */
-  for(i = 0; i < m; i++)
-    {
-      span = ay_nb_FindSpan(n, p, ub[i], *U);
-
-      /* protect BasisFuns() from bad spans */
-      if(span >= n)
-	span = n-1;
-
-      memset(funs, 0, (p+1)*sizeof(double));
-      ay_nb_BasisFuns(span, ub[i], p, *U, funs);
-
-      for(j = 0; j <= p; j++)
-	{
-	  a = (span-p+j)*m+i;
-	  N[a] = funs[j];
-	  /*
-	  if(isnan(N[a]))
-	  {
-	    ay_status = AY_ERROR; goto cleanup;
-	  }
-	  */
-	}
-
-      /*rk[i] = Q[i]-N(0,i)*Q[0]-N(n-1,i)*Q[m-1];*/
-      rk[i*istride]   = Q[i*istride]   - N[i] * Q[0] -
-	N[(n-1)*m+i] * Q[(m-1)*istride];
-
-      rk[i*istride+1] = Q[i*istride+1] - N[i] * Q[1] -
-	N[(n-1)*m+i] * Q[(m-1)*istride+1];
-
-      rk[i*istride+2] = Q[i*istride+2] - N[i] * Q[2] -
-	N[(n-1)*m+i] * Q[(m-1)*istride+2];
-    } /* for */
-
-  /* set up R */
-  for(i = 0; i < n; i++)
-    {
-      /*R[i*istride] = 0.0;*/
-      memset(&(R[i*istride]), 0, istride*sizeof(double));
+  /* set up N */
+  ay_status = ay_act_basisfuns(m, n, p, ub, *U, &spans, &funs);
 
-      for(j = 0; j < m; j++)
-	{
-	  /*R[i] += N(i,j)*rk[j] ;*/
-	  R[i*istride]   += N[i*m+j]*rk[j*istride];
-	  R[i*istride+1] += N[i*m+j]*rk[j*istride+1];
-	  R[i*istride+2] += N[i*m+j]*rk[j*istride+2];
-	}
-      /*
-      if(R[i*istride]   * R[i*istride]   < AY_EPSILON &&
-	 R[i*istride+1] * R[i*istride+1] < AY_EPSILON &&
-	 R[i*istride+2] * R[i*istride+2] < AY_EPSILON)
-	{
-	  ay_status = AY_ERROR;
-	  goto cleanup;
-	}
-      */
-    } /* for */
+  if(ay_status)
+    { goto cleanup; }
 
   /* solve N^T*N*P = R */
 
   if(n > 2)
     {
-      if(!(Ns = calloc((n-2)*(m-2), sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-      if(!(Nt = calloc((m-2)*(n-2), sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-      if(!(NN = calloc((n-2)*(n-2), sizeof(double))))
+      if(!(rk = calloc(m*istride, sizeof(double))))
 	{
 	  ay_status = AY_EOMEM;
 	  goto cleanup;
@@ -673,35 +735,30 @@ ay_act_leastSquares(double *Q, int m, int n, int p, int kt,
 	  goto cleanup;
 	}
 
-      /* fill Ns & Nt */
-      a = 0;
-      for(i = 1; i < n-1; i++)
+      /* set up rk */
+      for(i = 0; i < m; i++)
 	{
-	  for(j = 1; j < m-1; j++)
-	    {
-	      Ns[a] = N[i*m+j];
-	      a++;
-	    }
-	}
-      a = 0;
-      for(i = 1; i < m-1; i++)
-	{
-	  for(j = 1; j < n-1; j++)
+	  f = &(funs[i*(p+1)]);
+	  N0 = (spans[i] == p)?f[0]:0.0;
+	  Nn = (spans[i] == n-1)?f[p]:0.0;
+
+	  /*rk[i] = Q[i]-N(0,i)*Q[0]-N(n-1,i)*Q[m-1];*/
+	  for(j = 0; j < istride; j++)
 	    {
-	      Nt[a] = N[j*m+i];
-	      a++;
+	      rk[i*istride+j] = Q[i*istride+j] - N0 * Q[j] -
+		Nn * Q[(m-1)*istride+j];
 	    }
-	}
-
-      /* do NN=N^T*N */
-      ay_act_multmatrixmn(m-2, n-2, Nt, Ns, NN);
+	} /* for */
 
-      /* solve the linear equation system NN*X=R */
-      ay_status = ay_act_solve(n-2, n-2, NN, &(R[istride]), X);
+      /* do NN=N^T*N for the inner control points (N^T*N is banded) */
+      ay_status = ay_act_normalmatrix(m, p, spans, funs, 1, n-2, &NN);
 
       if(ay_status)
 	{ goto cleanup; }
 
+      /* solve the linear equation system NN*X=R */
+      ay_act_normalsolve(m, p, spans, funs, 1, n-2, NN, rk, istride, X);
+
       /* save results from X */
       j = 0;
       for(i = 1; i < n-1; i++)
@@ -742,24 +799,15 @@ cleanup:
   if(ub)
     free(ub);
 
-  if(R)
-    free(R);
-
   if(rk)
     free(rk);
 
-  if(N)
-    free(N);
+  if(spans)
+    free(spans);
 
   if(funs)
     free(funs);
 
-  if(Ns)
-    free(Ns);
-
-  if(Nt)
-    free(Nt);
-
   if(NN)
     free(NN);
 
@@ -779,10 +827,9 @@ ay_act_leastSquaresClosed(double *Q, int m, int n, int p, int kt,
 			  double **U, double **P)
 {
  int ay_status = AY_OK;
- int a, i, j, istride = 3, ostride = 4, span;
+ int a, i, j, istride = 3, ostride = 4, *spans = NULL;
  double d, *ub = NULL;
- double *Nt = NULL, *NN = NULL;
- double *R = NULL, *N = NULL, *X = NULL;
+ double *NN = NULL, *X = NULL;
  double *funs = NULL, alpha;
 
   if(!Q || !U || !P)
@@ -843,101 +890,20 @@ ay_act_leastSquaresClosed(double *Q, int m, int n, int p, int kt,
      points anyway */
   n -= p;
 
-  if(!(R = calloc(n*istride, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  /* Note well: N is nxm! (not mxn, as suggested by the NURBS book) */
-  if(!(N = calloc(n*m, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  if(!(funs = calloc(p+1, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
   /* set up N */
-  for(i = 0; i < m; i++)
-    {
-      span = ay_nb_FindSpan(n, p, ub[i], &((*U)[p-1])/**U*/);
+  ay_status = ay_act_basisfuns(m, n, p, ub, &((*U)[p-1])/**U*/,
+			       &spans, &funs);
 
-      /* protect BasisFuns() from bad spans */
-      if(span >= n)
-	span = n-1;
-
-      memset(funs, 0, (p+1)*sizeof(double));
-      ay_nb_BasisFuns(span, ub[i], p, &((*U)[p-1])/**U*/, funs);
-
-      for(j = 0; j <= p; j++)
-	{
-	  a = (span-p+j)*m+i;
-	  N[a] = funs[j];
-	  /*
-	  if(isnan(N[a]))
-	  {
-	    ay_status = AY_ERROR; goto cleanup;
-	  }
-	  */
-	}
-    } /* for */
-
-  /* set up R */
-  for(i = 0; i < n; i++)
-    {
-      /*R[i*istride] = 0.0;*/
-      memset(&(R[i*istride]), 0, istride*sizeof(double));
-
-      for(j = 0; j < m; j++)
-	{
-	  /*R[i] += N(i,j)*Q[j] ;*/
-	  R[i*istride]   += N[i*m+j]*Q[j*istride];
-	  R[i*istride+1] += N[i*m+j]*Q[j*istride+1];
-	  R[i*istride+2] += N[i*m+j]*Q[j*istride+2];
-	}
-      /*
-      if(R[i*istride]   * R[i*istride]   < AY_EPSILON &&
-	 R[i*istride+1] * R[i*istride+1] < AY_EPSILON &&
-	 R[i*istride+2] * R[i*istride+2] < AY_EPSILON)
-	{
-	  ay_status = AY_ERROR;
-	  goto cleanup;
-	}
-      */
-    } /* for */
+  if(ay_status)
+    { goto cleanup; }
 
   /* solve N^T*N*P = R */
 
-  if(!(Nt = calloc(m*n, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  if(!(NN = calloc(n*n, sizeof(double))))
-    {
-      ay_status = AY_EOMEM;
-      goto cleanup;
-    }
-
-  /* fill Nt */
-  a = 0;
-  for(i = 0; i < m; i++)
-    {
-      for(j = 0; j < n; j++)
-	{
-	  Nt[a] = N[j*m+i];
-	  a++;
-	}
-    }
+  /* do NN=N^T*N (N^T*N is banded) */
+  ay_status = ay_act_normalmatrix(m, p, spans, funs, 0, n, &NN);
 
-  /* do NN=N^T*N */
-  ay_act_multmatrixmn(m, n, Nt, N, NN);
+  if(ay_status)
+    { goto cleanup; }
 
   if(!(X = calloc(n*istride, sizeof(double))))
     {
@@ -946,10 +912,7 @@ ay_act_leastSquaresClosed(double *Q, int m, int n, int p, int kt,
     }
 
   /* solve the linear equation system NN*X=R */
-  ay_status = ay_act_solve(n, n, NN, R, X);
-
-  if(ay_status)
-    { goto cleanup; }
+  ay_act_normalsolve(m, p, spans, funs, 0, n, NN, Q, istride, X);
 
   /* save results from X */
   j = 0;
@@ -989,18 +952,12 @@ cleanup:
   if(ub)
     free(ub);
 
-  if(R)
-    free(R);
-
-  if(N)
-    free(N);
+  if(spans)
+    free(spans);
 
   if(funs)
     free(funs);
 
-  if(Nt)
-    free(Nt);
-
   if(NN)
     free(NN);
 
@@ -296,14 +296,47 @@ cleanup:
 } /* ay_apt_createknots */
 
 
+/** cached least squares approximation data; all rows/columns of
+    an approximating surface share the parameters and knots, so that
+    the basis functions and the decomposed normal equations need to
+    be calculated only once per direction */
 typedef struct ay_lsarrays {
- double *ub;
- double *Ns, *Nt, *NN;
- double *R, *rk, *N, *X;
- double *funs;
+ double *ub; /**< parameters the cached data was calculated for */
+ double *U; /**< knots the cached data was calculated for */
+ int m; /**< number of data points */
+ int n; /**< number of resulting points */
+ int p; /**< degree */
+ int closed; /**< closed approximation? */
+ int *spans; /**< spans of all data points [m] */
+ double *funs; /**< basis functions of all data points [m*(p+1)] */
+ double *NN; /**< decomposed normal equations (band matrix) */
 } ay_lsarrays;
 
 
+/** ay_apt_freelsarrays:
+ *  free the cached data of a least squares approximation
+ *
+ * \param[in,out] lsa  cached data to free
+ */
+void
+ay_apt_freelsarrays(ay_lsarrays *lsa)
+{
+
+  if(lsa->spans)
+    free(lsa->spans);
+
+  if(lsa->funs)
+    free(lsa->funs);
+
+  if(lsa->NN)
+    free(lsa->NN);
+
+  memset(lsa, 0, sizeof(ay_lsarrays));
+
+ return;
+} /* ay_apt_freelsarrays */
+
+
 /** ay_apt_leastSquares:
  *  approximate the data points in Q[m] with a NURBS curve of degree p
  *  with <n> control points, return results in P
@@ -315,7 +348,8 @@ typedef struct ay_lsarrays {
  * \param[in] n  desired number of resulting points
  * \param[in] p  desired order
  * \param[in] closed  whether to create a closed curve
- * \param[in] lsa  unused
+ * \param[in,out] lsa  cached data from the approximation of the
+ *  previous row/column (to be freed via \a ay_apt_freelsarrays())
  * \param[in] ub  parameter vector (created by \a ay_apt_createknots())
  * \param[in] U  knot vector (created by \a ay_apt_createknots())
  *
@@ -329,12 +363,10 @@ ay_apt_leastSquares(double *Q, int Qstride, int Pstride,
 		    ay_lsarrays *lsa, double *ub, double *U, double **P)
 {
  int ay_status = AY_OK;
- int a, i, j, span;
- double *Ns = NULL, *Nt = NULL, *NN = NULL;
- double *R = NULL, *rk = NULL, *N = NULL, *X = NULL;
- double *funs = NULL;
+ int a, i, j, *spans;
+ double *rk = NULL, *X = NULL, *funs, *f, N0, Nn;
 
-  if(!Q || !U || !P)
+  if(!Q || !lsa || !U || !P)
     return AY_ENULL;
 
   if(closed)
@@ -357,111 +389,60 @@ ay_apt_leastSquares(double *Q, int Qstride, int Pstride,
 	}
     }
 
-  /* solve N^T*N*P = R */
-
-  if(closed)
+  /* set up N and N^T*N, unless they are cached already */
+  if(!lsa->spans || lsa->ub != ub || lsa->U != U || lsa->m != m ||
+     lsa->n != n || lsa->p != p || lsa->closed != closed)
     {
-      /* closed */
-      /* the following section operates on a reduced number of output points
-	 since the last p output points will be equal to the first p output
-	 points anyway */
-      n -= p;
+      ay_apt_freelsarrays(lsa);
 
-      if(!(R = calloc(n*3, sizeof(double))))
+      if(closed)
 	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-
-      /* Note well: N is nxm! (not mxn, as suggested by the NURBS book) */
-      if(!(N = calloc(n*m, sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
+	  ay_status = ay_act_basisfuns(m, n-p, p, ub, &(U[p-1])/**U*/,
+				       &lsa->spans, &lsa->funs);
+	  if(ay_status)
+	    goto cleanup;
 
-      if(!(funs = calloc(p+1, sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
+	  ay_status = ay_act_normalmatrix(m, p, lsa->spans, lsa->funs,
+					  0, n-p, &lsa->NN);
 	}
-
-      /* set up N */
-      for(i = 0; i < m; i++)
-	{
-	  span = ay_nb_FindSpan(n, p, ub[i], &(U[p-1])/**U*/);
-
-	  /* protect BasisFuns() from bad spans */
-	  if(span >= n)
-	    span = n-1;
-
-	  memset(funs, 0, (p+1)*sizeof(double));
-	  ay_nb_BasisFuns(span, ub[i], p, &(U[p-1])/**U*/, funs);
-
-	  for(j = 0; j <= p; j++)
-	    {
-	      a = (span-p+j)*m+i;
-	      N[a] = funs[j];
-	      /*
-		if(isnan(N[a]))
-		{
-		ay_status = AY_ERROR; goto cleanup;
-		}
-	      */
-	    }
-	} /* for */
-
-      /* set up R */
-      for(i = 0; i < n; i++)
+      else
 	{
-	  /*R[i*Qstride] = 0.0;*/
-	  memset(&(R[i*3]), 0, 3*sizeof(double));
-
-	  for(j = 0; j < m; j++)
-	    {
-	      /*R[i] += N(i,j)*Q[j] ;*/
-	      R[i*3]   += N[i*m+j]*Q[j*Qstride];
-	      R[i*3+1] += N[i*m+j]*Q[j*Qstride+1];
-	      R[i*3+2] += N[i*m+j]*Q[j*Qstride+2];
-	    }
-	  /*
-	    if(R[i*3]   * R[i*3]   < AY_EPSILON &&
-	    R[i*3+1] * R[i*3+1] < AY_EPSILON &&
-	    R[i*3+2] * R[i*3+2] < AY_EPSILON)
-	    {
-	    ay_status = AY_ERROR;
+	  ay_status = ay_act_basisfuns(m, n, p, ub, U,
+				       &lsa->spans, &lsa->funs);
+	  if(ay_status)
 	    goto cleanup;
-	    }
-	  */
-	} /* for */
-
-      /* solve N^T*N*P = R */
 
-      if(!(Nt = calloc(m*n, sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
+	  if(n > 2)
+	    ay_status = ay_act_normalmatrix(m, p, lsa->spans, lsa->funs,
+					    1, n-2, &lsa->NN);
 	}
 
-      if(!(NN = calloc(n*n, sizeof(double))))
+      if(ay_status)
 	{
-	  ay_status = AY_EOMEM;
+	  ay_apt_freelsarrays(lsa);
 	  goto cleanup;
 	}
 
-      /* fill Nt */
-      a = 0;
-      for(i = 0; i < m; i++)
-	{
-	  for(j = 0; j < n; j++)
-	    {
-	      Nt[a] = N[j*m+i];
-	      a++;
-	    }
-	}
+      lsa->ub = ub;
+      lsa->U = U;
+      lsa->m = m;
+      lsa->n = n;
+      lsa->p = p;
+      lsa->closed = closed;
+    }
+
+  spans = lsa->spans;
+  funs = lsa->funs;
 
-      /* do NN=N^T*N */
-      ay_act_multmatrixmn(m, n, Nt, N, NN);
+  /* solve N^T*N*P = R */
+
+  if(closed)
+    {
+      /* closed */
+      /* the following section operates on a reduced number of output points
+	 since the last p output points will be equal to the first p output
+	 points anyway */
+      n -= p;
 
       if(!(X = calloc(n*3, sizeof(double))))
 	{
@@ -470,10 +451,7 @@ ay_apt_leastSquares(double *Q, int Qstride, int Pstride,
 	}
 
       /* solve the linear equation system NN*X=R */
-      ay_status = ay_act_solve(n, n, NN, R, X);
-
-      if(ay_status)
-	{ goto cleanup; }
+      ay_act_normalsolve(m, p, spans, funs, 0, n, lsa->NN, Q, Qstride, X);
 
       /* save results from X */
       j = 0;
@@ -493,103 +471,9 @@ ay_apt_leastSquares(double *Q, int Qstride, int Pstride,
     {
       /* open */
 
-      if(!(R = calloc(n*3, sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-
-      if(!(rk = calloc(m*3, sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-
-      /* Note well: N is nxm! (not mxn, as suggested by the NURBS book) */
-      if(!(N = calloc(n*m, sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-
-      if(!(funs = calloc(p+1, sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-
-      /* set up N and rk */
-      for(i = 0; i < m; i++)
-	{
-	  span = ay_nb_FindSpan(n, p, ub[i], U);
-
-	  /* protect BasisFuns() from bad spans */
-	  if(span >= n)
-	    span = n-1;
-
-	  memset(funs, 0, (p+1)*sizeof(double));
-	  ay_nb_BasisFuns(span, ub[i], p, U, funs);
-
-	  for(j = 0; j <= p; j++)
-	    {
-	      a = (span-p+j)*m+i;
-	      N[a] = funs[j];
-	      /*
-		if(isnan(N[a]))
-		{
-		ay_status = AY_ERROR; goto cleanup;
-		}
-	      */
-	    }
-
-	  /*rk[i] = Q[i]-N(0,i)*Q[0]-N(n-1,i)*Q[m-1];*/
-	  rk[i*3]   = Q[i*Qstride]   - N[i] * Q[0] -
-	    N[(n-1)*m+i] * Q[(m-1)*Qstride];
-
-	  rk[i*3+1] = Q[i*Qstride+1] - N[i] * Q[1] -
-	    N[(n-1)*m+i] * Q[(m-1)*Qstride+1];
-
-	  rk[i*3+2] = Q[i*Qstride+2] - N[i] * Q[2] -
-	    N[(n-1)*m+i] * Q[(m-1)*Qstride+2];
-	} /* for */
-
-      /* set up R */
-      for(i = 0; i < n; i++)
-	{
-	  /*R[i*3] = 0.0;*/
-	  memset(&(R[i*3]), 0, 3*sizeof(double));
-
-	  for(j = 0; j < m; j++)
-	    {
-	      /*R[i] += N(i,j)*rk[j] ;*/
-	      R[i*3]   += N[i*m+j]*rk[j*3];
-	      R[i*3+1] += N[i*m+j]*rk[j*3+1];
-	      R[i*3+2] += N[i*m+j]*rk[j*3+2];
-	    }
-	  /*
-	    if(R[i*3]   * R[i*3]   < AY_EPSILON &&
-	    R[i*3+1] * R[i*3+1] < AY_EPSILON &&
-	    R[i*3+2] * R[i*3+2] < AY_EPSILON)
-	    {
-	    ay_status = AY_ERROR;
-	    goto cleanup;
-	    }
-	  */
-	} /* for */
-
       if(n > 2)
 	{
-	  if(!(Ns = calloc((n-2)*(m-2), sizeof(double))))
-	    {
-	      ay_status = AY_EOMEM;
-	      goto cleanup;
-	    }
-	  if(!(Nt = calloc((m-2)*(n-2), sizeof(double))))
-	    {
-	      ay_status = AY_EOMEM;
-	      goto cleanup;
-	    }
-	  if(!(NN = calloc((n-2)*(n-2), sizeof(double))))
+	  if(!(rk = calloc(m*3, sizeof(double))))
 	    {
 	      ay_status = AY_EOMEM;
 	      goto cleanup;
@@ -600,34 +484,23 @@ ay_apt_leastSquares(double *Q, int Qstride, int Pstride,
 	      goto cleanup;
 	    }
 
-	  /* fill Ns & Nt */
-	  a = 0;
-	  for(i = 1; i < n-1; i++)
+	  /* set up rk */
+	  for(i = 0; i < m; i++)
 	    {
-	      for(j = 1; j < m-1; j++)
-		{
-		  Ns[a] = N[i*m+j];
-		  a++;
-		}
-	    }
-	  a = 0;
-	  for(i = 1; i < m-1; i++)
-	    {
-	      for(j = 1; j < n-1; j++)
+	      f = &(funs[i*(p+1)]);
+	      N0 = (spans[i] == p)?f[0]:0.0;
+	      Nn = (spans[i] == n-1)?f[p]:0.0;
+
+	      /*rk[i] = Q[i]-N(0,i)*Q[0]-N(n-1,i)*Q[m-1];*/
+	      for(j = 0; j < 3; j++)
 		{
-		  Nt[a] = N[j*m+i];
-		  a++;
+		  rk[i*3+j] = Q[i*Qstride+j] - N0 * Q[j] -
+		    Nn * Q[(m-1)*Qstride+j];
 		}
-	    }
-
-	  /* do NN=N^T*N */
-	  ay_act_multmatrixmn(m-2, n-2, Nt, Ns, NN);
+	    } /* for */
 
 	  /* solve the linear equation system NN*X=R */
-	  ay_status = ay_act_solve(n-2, n-2, NN, &(R[3]), X);
-
-	  if(ay_status)
-	    { goto cleanup; }
+	  ay_act_normalsolve(m, p, spans, funs, 1, n-2, lsa->NN, rk, 3, X);
 
 	  /* save results from X */
 	  j = 0;
@@ -665,27 +538,9 @@ cleanup:
       *P = NULL;
     }
 
-  if(R)
-    free(R);
-
   if(rk)
     free(rk);
 
-  if(N)
-    free(N);
-
-  if(funs)
-    free(funs);
-
-  if(Ns)
-    free(Ns);
-
-  if(Nt)
-    free(Nt);
-
-  if(NN)
-    free(NN);
-
   if(X)
     free(X);
 
@@ -835,6 +690,8 @@ ay_apt_approximateuv(double *cv, int width, int height,
 
 cleanup:
 
+  ay_apt_freelsarrays(&lsa);
+
   if(ay_status)
     {
       if(P)
@@ -996,6 +853,8 @@ ay_apt_approximatevu(double *cv, int width, int height,
 
 cleanup:
 
+  ay_apt_freelsarrays(&lsa);
+
   if(ay_status)
     {
       if(P)
@@ -1117,6 +976,8 @@ ay_apt_approximateu(double *cv, int width, int height,
 
 cleanup:
 
+  ay_apt_freelsarrays(&lsa);
+
   if(ay_status)
     {
       if(P)
@@ -1226,6 +1087,8 @@ ay_apt_approximatev(double *cv, int width, int height,
 
 cleanup:
 
+  ay_apt_freelsarrays(&lsa);
+
   if(ay_status)
     {
       if(P)
@@ -31,7 +31,9 @@ int ay_bevelt_getwinding(ay_nurbcurve_object *nc, double *normals,
 
 /* global variables: */
 
-/** standard bevel curves */
+/** standard bevel curves (created by ay_bevelt_init(), read only
+    afterwards, as bevels may be created in parallel notification
+    callbacks) */
 static ay_object *ay_bevelt_curves[3] = {0};
 
 
@@ -1631,11 +1633,9 @@ ay_bevelt_findbevelcurve(int index, ay_object **c)
 
   if(index <= 0)
     {
-      if(ay_bevelt_curves[abs(index)] == NULL)
-	{
-	  ay_bevelt_createbevelcurve(abs(index));
-	}
-      *c = ay_bevelt_curves[abs(index)];
+      if(index < -2)
+	return AY_ERROR;
+      *c = ay_bevelt_curves[-index];
       if(!*c)
 	ay_status = AY_ERROR;
       else
@@ -1839,3 +1839,19 @@ ay_bevelt_getwinding(ay_nurbcurve_object *nc, double *normals,
 
  return 0;
 } /* ay_bevelt_getwinding */
+
+
+/** ay_bevelt_init:
+ * Initialize the bevel tools module by creating the standard
+ * bevel cross section curves.
+ */
+void
+ay_bevelt_init()
+{
+ int i;
+
+  for(i = 0; i < 3; i++)
+    ay_bevelt_createbevelcurve(i);
+
+ return;
+} /* ay_bevelt_init */
@@ -235,6 +235,8 @@ ay_ipt_interpolateu(ay_nurbpatch_object *np, int order, int ktype)
 {
  int ay_status = AY_OK;
  char fname[] = "ipt_interpolateu";
+ int kl = 0, ku = 0, *pivot = NULL;
+ double *AB = NULL;
  int i, k, N, K, stride, ind1, ind2, pu, num;
  double *uk = NULL, *cds = NULL, *Pw = NULL, v[3] = {0};
  double *U = NULL, *Q = NULL, total, d;
@@ -356,6 +358,14 @@ ay_ipt_interpolateu(ay_nurbpatch_object *np, int order, int ktype)
   for(i = (K/*-pu-1*/); i < (K+pu+1); i++)
     U[i] = 1.0;
 
+  /* the interpolation matrix is the same for all rows,
+     so it is set up and decomposed only once */
+  ay_status = ay_nb_GlobalInterpolationLU(K-1, uk, U, pu, AY_FALSE,
+					  &kl, &ku, &AB, &pivot);
+
+  if(ay_status)
+    { free(cds); free(uk); free(U); free(Q); return ay_status; }
+
   /* interpolate */
   for(i = 0; i < N; i++)
     {
@@ -368,10 +378,7 @@ ay_ipt_interpolateu(ay_nurbpatch_object *np, int order, int ktype)
 	  ind1 += N*stride;
 	} /* for */
 
-      ay_status = ay_nb_GlobalInterpolation4D(K-1, Q, uk, U, pu);
-
-      if(ay_status)
-	{ free(cds); free(uk); free(U); free(Q); return ay_status; }
+      ay_nb_BandLUSolve(K, kl, ku, AB, pivot, 4, 4, Q);
 
       ind1 = i*stride;
       for(k = 0; k < K; k++)
@@ -390,6 +397,8 @@ ay_ipt_interpolateu(ay_nurbpatch_object *np, int order, int ktype)
   free(uk);
   free(cds);
   free(Q);
+  free(AB);
+  free(pivot);
 
  return AY_OK;
 } /* ay_ipt_interpolateu */
@@ -417,6 +426,8 @@ ay_ipt_interpolateud(ay_nurbpatch_object *np, int order, int ktype,
 {
  int ay_status = AY_OK;
  char fname[] = "ipt_interpolateud";
+ int kl = 0, ku = 0, *pivot = NULL;
+ double *AB = NULL;
  int i, k, N, K, stride, ind1, ind2, pu, num;
  double *uk = NULL, *cds = NULL, *Pw = NULL, v[3] = {0};
  double *U = NULL, *Qt = NULL, *Q = NULL, total, d;
@@ -543,6 +554,14 @@ ay_ipt_interpolateud(ay_nurbpatch_object *np, int order, int ktype,
   for(i = K; i < (K+pu+1); i++)
     U[i] = 1.0;
 
+  /* the interpolation matrix is the same for all rows,
+     so it is set up and decomposed only once */
+  ay_status = ay_nb_GlobalInterpolationLU(np->width-1, uk, U, pu, AY_TRUE,
+					  &kl, &ku, &AB, &pivot);
+
+  if(ay_status)
+    goto cleanup;
+
   /* interpolate */
   for(i = 0; i < N; i++)
     {
@@ -600,11 +619,8 @@ ay_ipt_interpolateud(ay_nurbpatch_object *np, int order, int ktype,
 	}
 
       /* interpolate */
-      ay_status = ay_nb_GlobalInterpolation4DD(np->width-1, Qt, uk, U, pu,
-					       ds, de);
-
-      if(ay_status)
-	{ goto cleanup; }
+      ay_nb_GlobalInterpolation4DDSolve(np->width-1, Qt, ds, de,
+					kl, ku, AB, pivot);
 
       /* copy results back */
       ind1 = i*stride;
@@ -631,6 +647,10 @@ ay_ipt_interpolateud(ay_nurbpatch_object *np, int order, int ktype,
 
 cleanup:
 
+  if(AB)
+    free(AB);
+  if(pivot)
+    free(pivot);
   if(uk)
     free(uk);
   if(cds)
@@ -669,6 +689,8 @@ ay_ipt_interpolateudc(ay_nurbpatch_object *np, int order, int ktype,
 {
  int ay_status = AY_OK;
  char fname[] = "ipt_interpolateudc";
+ int kl = 0, ku = 0, *pivot = NULL;
+ double *AB = NULL;
  int i, k, N, K, stride, ind1, ind2, pu, num;
  double *uk = NULL, *cds = NULL, *Pw = NULL, v[3] = {0};
  double *U = NULL, *Qt = NULL, *Q = NULL, total, d;
@@ -825,6 +847,14 @@ ay_ipt_interpolateudc(ay_nurbpatch_object *np, int order, int ktype,
   for(i = K; i < (K+pu+1); i++)
     U[i] = 1.0;
 
+  /* the interpolation matrix is the same for all rows,
+     so it is set up and decomposed only once */
+  ay_status = ay_nb_GlobalInterpolationLU(np->width, uk, U, pu, AY_TRUE,
+					  &kl, &ku, &AB, &pivot);
+
+  if(ay_status)
+    goto cleanup;
+
   /* interpolate */
   for(i = 0; i < N; i++)
     {
@@ -881,11 +911,8 @@ ay_ipt_interpolateudc(ay_nurbpatch_object *np, int order, int ktype,
 	}
 
       /* interpolate */
-      ay_status = ay_nb_GlobalInterpolation4DD(np->width, Qt, uk, U, pu,
-					       ds, de);
-
-      if(ay_status)
-	{ goto cleanup; }
+      ay_nb_GlobalInterpolation4DDSolve(np->width, Qt, ds, de,
+					kl, ku, AB, pivot);
 
       /* copy results back */
       ind1 = i*stride;
@@ -912,6 +939,10 @@ ay_ipt_interpolateudc(ay_nurbpatch_object *np, int order, int ktype,
 
 cleanup:
 
+  if(AB)
+    free(AB);
+  if(pivot)
+    free(pivot);
   if(uk)
     free(uk);
   if(cds)
@@ -942,6 +973,8 @@ ay_ipt_interpolatev(ay_nurbpatch_object *np, int order, int ktype)
 {
  int ay_status = AY_OK;
  char fname[] = "ipt_interpolatev";
+ int kl = 0, ku = 0, *pivot = NULL;
+ double *AB = NULL;
  int i, k, N, K, stride, ind1, ind2, pv, num;
  double *vk = NULL, *cds = NULL, *Pw = NULL, v[3] = {0};
  double *V = NULL, total, d;
@@ -1055,17 +1088,21 @@ ay_ipt_interpolatev(ay_nurbpatch_object *np, int order, int ktype)
   for(i = (N/*-pu-1*/); i < (N+pv+1); i++)
     V[i] = 1.0;
 
+  /* the interpolation matrix is the same for all columns,
+     so it is set up and decomposed only once */
+  ay_status = ay_nb_GlobalInterpolationLU(N-1, vk, V, pv, AY_FALSE,
+					  &kl, &ku, &AB, &pivot);
+
+  if(ay_status)
+    { free(cds); free(vk); free(V); return ay_status; }
+
   /* interpolate */
   for(i = 0; i < K; i++)
     {
       ind1 = i*N*stride;
 
-      ay_status = ay_nb_GlobalInterpolation4D(N-1,
-			&(np->controlv[ind1]), vk, V, pv);
-
-      if(ay_status)
-	{ free(cds); free(vk); free(V); return ay_status; }
-
+      ay_nb_BandLUSolve(N, kl, ku, AB, pivot, 4, 4,
+			&(np->controlv[ind1]));
     } /* for */
 
   if(np->vknotv)
@@ -1076,6 +1113,8 @@ ay_ipt_interpolatev(ay_nurbpatch_object *np, int order, int ktype)
 
   free(vk);
   free(cds);
+  free(AB);
+  free(pivot);
 
  return AY_OK;
 } /* ay_ipt_interpolatev */
@@ -1103,6 +1142,8 @@ ay_ipt_interpolatevd(ay_nurbpatch_object *np, int order, int ktype,
 {
  int ay_status = AY_OK;
  char fname[] = "ipt_interpolatevd";
+ int kl = 0, ku = 0, *pivot = NULL;
+ double *AB = NULL;
  int i, k, N, K, stride, ind, pv, num;
  double *vk = NULL, *cds = NULL, *Pw = NULL, v[3] = {0};
  double *V = NULL, *Qt = NULL, *Q = NULL, total, d;
@@ -1226,6 +1267,14 @@ ay_ipt_interpolatevd(ay_nurbpatch_object *np, int order, int ktype,
   for(i = K; i < (K+pv+1); i++)
     V[i] = 1.0;
 
+  /* the interpolation matrix is the same for all columns,
+     so it is set up and decomposed only once */
+  ay_status = ay_nb_GlobalInterpolationLU(np->height-1, vk, V, pv, AY_TRUE,
+					  &kl, &ku, &AB, &pivot);
+
+  if(ay_status)
+    goto cleanup;
+
   /* interpolate */
   for(i = 0; i < N; i++)
     {
@@ -1272,11 +1321,8 @@ ay_ipt_interpolatevd(ay_nurbpatch_object *np, int order, int ktype,
 	}
 
       /* interpolate */
-      ay_status = ay_nb_GlobalInterpolation4DD(np->height-1, Qt, vk, V, pv,
-					       ds, de);
-
-      if(ay_status)
-	{ goto cleanup; }
+      ay_nb_GlobalInterpolation4DDSolve(np->height-1, Qt, ds, de,
+					kl, ku, AB, pivot);
 
       /* copy results back */
       memcpy(&(Q[i*K*stride]), Qt, K*stride*sizeof(double));
@@ -1298,6 +1344,10 @@ ay_ipt_interpolatevd(ay_nurbpatch_object *np, int order, int ktype,
 
 cleanup:
 
+  if(AB)
+    free(AB);
+  if(pivot)
+    free(pivot);
   if(vk)
     free(vk);
   if(cds)
@@ -1336,6 +1386,8 @@ ay_ipt_interpolatevdc(ay_nurbpatch_object *np, int order, int ktype,
 {
  int ay_status = AY_OK;
  char fname[] = "ipt_interpolatevdc";
+ int kl = 0, ku = 0, *pivot = NULL;
+ double *AB = NULL;
  int i, k, N, K, stride, ind1, ind2, pv, num;
  double *vk = NULL, *cds = NULL, *Pw = NULL, v[3] = {0};
  double *V = NULL, *Qt = NULL, *Q = NULL, total, d;
@@ -1486,6 +1538,14 @@ ay_ipt_interpolatevdc(ay_nurbpatch_object *np, int order, int ktype,
   for(i = K; i < (K+pv+1); i++)
     V[i] = 1.0;
 
+  /* the interpolation matrix is the same for all columns,
+     so it is set up and decomposed only once */
+  ay_status = ay_nb_GlobalInterpolationLU(np->height, vk, V, pv, AY_TRUE,
+					  &kl, &ku, &AB, &pivot);
+
+  if(ay_status)
+    goto cleanup;
+
   /* interpolate */
   for(i = 0; i < N; i++)
     {
@@ -1530,11 +1590,8 @@ ay_ipt_interpolatevdc(ay_nurbpatch_object *np, int order, int ktype,
 	}
 
       /* interpolate */
-      ay_status = ay_nb_GlobalInterpolation4DD(np->height, Qt, vk, V, pv,
-					       ds, de);
-
-      if(ay_status)
-	{ goto cleanup; }
+      ay_nb_GlobalInterpolation4DDSolve(np->height, Qt, ds, de,
+					kl, ku, AB, pivot);
 
       /* copy results back */
       memcpy(&(Q[i*K*stride]), Qt, K*stride*sizeof(double));
@@ -1556,6 +1613,10 @@ ay_ipt_interpolatevdc(ay_nurbpatch_object *np, int order, int ktype,
 
 cleanup:
 
+  if(AB)
+    free(AB);
+  if(pivot)
+    free(pivot);
   if(vk)
     free(vk);
   if(cds)
@@ -203,203 +203,399 @@ ay_nb_LUInvert(int n, double *inv, int *pivot)
 
 
 /*
- * ay_nb_GlobalInterpolation4D: (NURBS++)
- * interpolate the n+1 4D points in Q[] with
- * n+1 precalculated parametric values in ub[]
- * and n+d+1 knots in Uc[] with desired degree d (d <= n!)
+ * ay_nb_BandLUDecompose:
+ * do the LU decomposition (with partial pivoting) of the nxn band
+ * matrix AB with kl sub- and ku super-diagonals;
+ * row i of AB holds the columns i-kl to i+kl+ku (the additional kl
+ * columns take the fill-in caused by pivoting), i.e. element (i,j)
+ * is stored in AB[i*(2*kl+ku+1)+j-i+kl];
+ * pivot[n] has to be allocated outside! and fed into the
+ * solver below.
  */
 int
-ay_nb_GlobalInterpolation4D(int n, double *Q, double *ub, double *Uc, int d)
+ay_nb_BandLUDecompose(int n, int kl, int ku, double *AB, int *pivot)
 {
- int ay_status = AY_OK;
- int i, j, k, span, ind, *pivot = NULL;
- double t, *A = NULL, *U, *N = NULL;
- double *qq = NULL, *xx = NULL;
+ int i, j, k, l, w, last;
+ double t, den, ten, *rk;
 
-  if(!(A = calloc((n+1)*(n+1), sizeof(double))))
-    return AY_EOMEM;
+  w = 2*kl+ku+1;
 
-  if(!(N = calloc((d+1), sizeof(double))))
-    { ay_status = AY_EOMEM; goto cleanup; }
+  for(k = 0; k < n; k++)
+    {
+      /* partial pivoting: search the column below the diagonal */
+      last = (k+kl < n)?(k+kl):(n-1);
+      ten = fabs(AB[k*w+kl]);
+      l = k;
+      for(i = k+1; i <= last; i++)
+	{
+	  den = fabs(AB[i*w+k-i+kl]);
+	  if(den > ten)
+	    {
+	      ten = den;
+	      l = i;
+	    }
+	}
+      pivot[k] = l;
 
-  if(!(qq = calloc((n+1)*4, sizeof(double))))
-    { ay_status = AY_EOMEM; goto cleanup; }
+      if(ten == 0.0)
+	return AY_ERROR;
 
-  if(!(xx = calloc((n+1)*4, sizeof(double))))
-    { ay_status = AY_EOMEM; goto cleanup; }
+      /* the rows k..last have their non zero elements in the
+	 columns k..k+kl+ku */
+      j = (k+kl+ku < n)?(k+kl+ku):(n-1);
 
-  if(!(pivot = calloc(n+1, sizeof(int))))
-    { ay_status = AY_EOMEM; goto cleanup; }
+      if(l != k)
+	{
+	  for(i = k; i <= j; i++)
+	    {
+	      t = AB[l*w+i-l+kl];
+	      AB[l*w+i-l+kl] = AB[k*w+i-k+kl];
+	      AB[k*w+i-k+kl] = t;
+	    }
+	}
 
-  U = Uc;
+      rk = &(AB[k*w-k+kl]);
+      for(i = k+1; i <= last; i++)
+	{
+	  t = AB[i*w+k-i+kl]/rk[k];
+	  AB[i*w+k-i+kl] = t;
+	  if(t != 0.0)
+	    {
+	      for(l = k+1; l <= j; l++)
+		AB[i*w+l-i+kl] -= t*rk[l];
+	    }
+	}
+    } /* for */
 
-  /* Fill A */
-  for(i = 1; i < n; i++)
+ return AY_OK;
+} /* ay_nb_BandLUDecompose */
+
+
+/*
+ * ay_nb_BandLUSolve:
+ * solve the band equation system decomposed by ay_nb_BandLUDecompose()
+ * above for nrhs right hand sides in B, where element (i,j) is stored
+ * in B[i*stride+j]; the results are stored in B
+ */
+void
+ay_nb_BandLUSolve(int n, int kl, int ku, double *AB, int *pivot,
+		  int nrhs, int stride, double *B)
+{
+ int i, j, k, l, w, last;
+ double t;
+
+  w = 2*kl+ku+1;
+
+  /* forward substitution (L) */
+  for(k = 0; k < n; k++)
     {
-      span = ay_nb_FindSpan(n, d, ub[i], U);
-      ay_status = ay_nb_BasisFuns(span, ub[i], d, U, N);
-      if(ay_status)
-	{ free(A); free(N); free(qq); free(xx); free(pivot); return ay_status; }
-      for(j = 0; j <= d; j++)
+      l = pivot[k];
+      if(l != k)
 	{
-	  ind = (i*(n+1)) + (span-d+j);
-	  A[ind] = N[j];
+	  for(j = 0; j < nrhs; j++)
+	    {
+	      t = B[l*stride+j];
+	      B[l*stride+j] = B[k*stride+j];
+	      B[k*stride+j] = t;
+	    }
+	}
+      last = (k+kl < n)?(k+kl):(n-1);
+      for(i = k+1; i <= last; i++)
+	{
+	  t = AB[i*w+k-i+kl];
+	  if(t != 0.0)
+	    {
+	      for(j = 0; j < nrhs; j++)
+		B[i*stride+j] -= t*B[k*stride+j];
+	    }
 	}
     }
 
-  A[0] = 1.0;
-  A[n*(n+1)+n] = 1.0;
-
-  ay_status = ay_nb_LUDecompose(n+1, A, pivot);
+  /* back substitution (U) */
+  for(i = n-1; i >= 0; i--)
+    {
+      last = (i+kl+ku < n)?(i+kl+ku):(n-1);
+      for(j = 0; j < nrhs; j++)
+	{
+	  t = B[i*stride+j];
+	  for(k = i+1; k <= last; k++)
+	    t -= AB[i*w+k-i+kl]*B[k*stride+j];
+	  B[i*stride+j] = t/AB[i*w+kl];
+	}
+    }
 
-  if(ay_status)
-    { goto cleanup; }
+ return;
+} /* ay_nb_BandLUSolve */
 
-  ay_status = ay_nb_LUInvert(n+1, A, pivot);
 
-  if(ay_status)
-    { goto cleanup; }
+/*
+ * ay_nb_BandCholeskyDecompose:
+ * do the Cholesky decomposition A=L*L^T of the symmetric positive
+ * definite nxn band matrix AB with kd sub-diagonals;
+ * row i of AB holds the columns i-kd to i of the lower triangle,
+ * i.e. element (i,j) is stored in AB[i*(kd+1)+j-i+kd];
+ * AB is replaced by L;
+ * returns AY_ERROR if the matrix is not positive definite
+ */
+int
+ay_nb_BandCholeskyDecompose(int n, int kd, double *AB)
+{
+ int i, j, k, first, w;
+ double s;
 
-  /* Init matrix for LSE */
-  memcpy(qq, Q, (n+1)*4*sizeof(double));
+  w = kd+1;
 
-  /* Multiply through: xx = A(^-1)*qq */
-  for(i = 0; i < (n+1); i++)
+  for(i = 0; i < n; i++)
     {
-      for(j = 0; j < 4; j++)
+      first = (i-kd > 0)?(i-kd):0;
+      for(j = first; j <= i; j++)
 	{
-	  t = 0.0;
-	  for(k = 0; k < (n+1); k++)
+	  s = AB[i*w+j-i+kd];
+	  for(k = first; k < j; k++)
 	    {
-	      t += (A[i*(n+1)+k] * qq[k*4+j]);
+	      if(k >= j-kd)
+		s -= AB[i*w+k-i+kd]*AB[j*w+k-j+kd];
+	    }
+	  if(j == i)
+	    {
+	      if(s <= 0.0)
+		return AY_ERROR;
+	      AB[i*w+kd] = sqrt(s);
+	    }
+	  else
+	    {
+	      AB[i*w+j-i+kd] = s/AB[j*w+kd];
 	    }
-	  xx[i*4+j] = t;
 	}
     }
 
-  /* Store the results */
-  memcpy(Q, xx, (n+1)*4*sizeof(double));
+ return AY_OK;
+} /* ay_nb_BandCholeskyDecompose */
 
-cleanup:
 
-  if(A)
-    free(A);
-  if(N)
-    free(N);
-  if(qq)
-    free(qq);
-  if(xx)
-    free(xx);
-  if(pivot)
-    free(pivot);
+/*
+ * ay_nb_BandCholeskySolve:
+ * solve the band equation system decomposed by
+ * ay_nb_BandCholeskyDecompose() above for nrhs right hand sides
+ * in B, where element (i,j) is stored in B[i*stride+j];
+ * the results are stored in B
+ */
+void
+ay_nb_BandCholeskySolve(int n, int kd, double *AB,
+			int nrhs, int stride, double *B)
+{
+ int i, j, k, first, last, w;
+ double t;
 
- return ay_status;
-} /* ay_nb_GlobalInterpolation4D */
+  w = kd+1;
+
+  /* forward substitution (L) */
+  for(i = 0; i < n; i++)
+    {
+      first = (i-kd > 0)?(i-kd):0;
+      for(j = 0; j < nrhs; j++)
+	{
+	  t = B[i*stride+j];
+	  for(k = first; k < i; k++)
+	    t -= AB[i*w+k-i+kd]*B[k*stride+j];
+	  B[i*stride+j] = t/AB[i*w+kd];
+	}
+    }
+
+  /* back substitution (L^T) */
+  for(i = n-1; i >= 0; i--)
+    {
+      last = (i+kd < n)?(i+kd):(n-1);
+      for(j = 0; j < nrhs; j++)
+	{
+	  t = B[i*stride+j];
+	  for(k = i+1; k <= last; k++)
+	    t -= AB[k*w+i-k+kd]*B[k*stride+j];
+	  B[i*stride+j] = t/AB[i*w+kd];
+	}
+    }
+
+ return;
+} /* ay_nb_BandCholeskySolve */
 
 
 /*
- * ay_nb_GlobalInterpolation4DD:
- * interpolate the n+1 4D points in Q[] with
- * n+1 precalculated parametric values in ub[]
- * and n+d+3 knots in Uc[] with desired degree d (d <= n+2!)
- * and end derivatives D1 (start) and D2 (end)
- * Q has to be of size n+3 and filled sparsely:
- * P[0],,P[1],...,P[n-1],,P[n]!
+ * ay_nb_GlobalInterpolationLU:
+ * set up and LU decompose the band matrix for the interpolation of
+ * n+1 points with n+1 precalculated parametric values in ub[]
+ * and the knots in Uc[] with desired degree d;
+ * if ders is AY_TRUE, the matrix additionally has rows for end
+ * derivatives (see ay_nb_GlobalInterpolation4DD() below) and n+3
+ * instead of n+1 rows;
+ * the matrix only depends on ub[] and Uc[], so it may be used to
+ * interpolate many point sets with ay_nb_BandLUSolve() or
+ * ay_nb_GlobalInterpolation4DDSolve(); returns the decomposed
+ * band matrix in AB[], the pivots in pivot[] and the number of sub-
+ * and super-diagonals in kl and ku, AB and pivot are allocated here
  */
 int
-ay_nb_GlobalInterpolation4DD(int n, double *Q, double *ub, double *Uc, int d,
-			     double *D1, double *D2)
+ay_nb_GlobalInterpolationLU(int n, double *ub, double *Uc, int d, int ders,
+			    int *kl, int *ku, double **AB, int **pivot)
 {
  int ay_status = AY_OK;
- int i, j, k, span, ind, *pivot = NULL;
- double t, *A = NULL, *U, *N = NULL;
- double *qq = NULL, *xx = NULL;
+ int i, j, k, nr, w, first, last, *spans = NULL, *piv = NULL;
+ double *A = NULL, *N = NULL;
+
+  /* number of rows/columns; rows first..last interpolate points */
+  if(ders)
+    {
+      nr = n+3;
+      first = 2;
+      last = n;
+    }
+  else
+    {
+      nr = n+1;
+      first = 1;
+      last = n-1;
+    }
 
-  if(!(A = calloc((n+3)*(n+3), sizeof(double))))
+  if(!(spans = calloc(nr, sizeof(int))))
     return AY_EOMEM;
 
   if(!(N = calloc((d+1), sizeof(double))))
     { ay_status = AY_EOMEM; goto cleanup; }
 
-  if(!(qq = calloc((n+3)*4, sizeof(double))))
-    { ay_status = AY_EOMEM; goto cleanup; }
+  /* the end rows (and derivative rows) need one sub- and
+     super-diagonal at most */
+  *kl = ders?1:0;
+  *ku = ders?1:0;
+  k = 1;
+  for(i = first; i <= last; i++)
+    {
+      if(ders)
+	spans[i] = ay_nb_FindSpan(n+2, d, ub[k++], Uc);
+      else
+	spans[i] = ay_nb_FindSpan(n, d, ub[i], Uc);
+      if(i-(spans[i]-d) > *kl)
+	*kl = i-(spans[i]-d);
+      if(spans[i]-i > *ku)
+	*ku = spans[i]-i;
+    }
 
-  if(!(xx = calloc((n+3)*4, sizeof(double))))
-    { ay_status = AY_EOMEM; goto cleanup; }
+  w = 2*(*kl)+(*ku)+1;
 
-  if(!(pivot = calloc(n+3, sizeof(int))))
+  if(!(A = calloc(nr*w, sizeof(double))))
     { ay_status = AY_EOMEM; goto cleanup; }
 
-  U = Uc;
+  if(!(piv = calloc(nr, sizeof(int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
 
   /* Fill A */
   k = 1;
-  for(i = 2; i < n+1; i++)
+  for(i = first; i <= last; i++)
     {
-      span = ay_nb_FindSpan(n+2, d, ub[k], U);
-
-      ay_status = ay_nb_BasisFuns(span, ub[k], d, U, N);
-
+      ay_status = ay_nb_BasisFuns(spans[i], ders?ub[k++]:ub[i], d, Uc, N);
       if(ay_status)
-	{ goto cleanup; }
-
+	goto cleanup;
       for(j = 0; j <= d; j++)
 	{
-	  ind = (i*(n+3)) + (span-d+j);
-	  A[ind] = N[j];
+	  A[i*w+(spans[i]-d+j)-i+(*kl)] = N[j];
 	}
-      k++;
     }
 
-  A[0] = 1.0;
-  A[(n+3)] = -1.0;
-  A[(n+3)+1] = 1.0;
+  A[*kl] = 1.0;
+  A[(nr-1)*w+(*kl)] = 1.0;
 
-  A[((n+3)*(n+3))-1-(n+3)-1] = -1.0;
-  A[((n+3)*(n+3))-1-(n+3)] = 1.0;
-  A[((n+3)*(n+3))-1] = 1.0;
+  if(ders)
+    {
+      /* row 1: -P[0] + P[1] = D1 */
+      A[w+0-1+(*kl)] = -1.0;
+      A[w+(*kl)] = 1.0;
+      /* row n+1: -P[n+1] + P[n+2] = D2 */
+      A[(n+1)*w+(*kl)] = -1.0;
+      A[(n+1)*w+1+(*kl)] = 1.0;
+    }
 
-  ay_status = ay_nb_LUDecompose(n+3, A, pivot);
+  ay_status = ay_nb_BandLUDecompose(nr, *kl, *ku, A, piv);
 
   if(ay_status)
-    { goto cleanup; }
+    goto cleanup;
+
+  /* return results */
+  *AB = A;
+  *pivot = piv;
+
+  /* prevent cleanup code from doing something harmful */
+  A = NULL;
+  piv = NULL;
+
+cleanup:
+
+  if(A)
+    free(A);
+  if(piv)
+    free(piv);
+  if(N)
+    free(N);
+  if(spans)
+    free(spans);
+
+ return ay_status;
+} /* ay_nb_GlobalInterpolationLU */
+
+
+/*
+ * ay_nb_GlobalInterpolation4D: (NURBS++)
+ * interpolate the n+1 4D points in Q[] with
+ * n+1 precalculated parametric values in ub[]
+ * and n+d+1 knots in Uc[] with desired degree d (d <= n!)
+ */
+int
+ay_nb_GlobalInterpolation4D(int n, double *Q, double *ub, double *Uc, int d)
+{
+ int ay_status = AY_OK;
+ int kl, ku, *pivot = NULL;
+ double *A = NULL;
 
-  ay_status = ay_nb_LUInvert(n+3, A, pivot);
+  ay_status = ay_nb_GlobalInterpolationLU(n, ub, Uc, d, AY_FALSE,
+					  &kl, &ku, &A, &pivot);
 
   if(ay_status)
-    { goto cleanup; }
+    return ay_status;
 
-  /* Init matrix for LSE */
-  memcpy(qq,Q,(n+3)*4*sizeof(double));
+  /* solve the band equation system A*X = Q and store the results */
+  ay_nb_BandLUSolve(n+1, kl, ku, A, pivot, 4, 4, Q);
 
-  /* Insert Derivatives */
-  qq[4] = /*(U[d+1]/d)**/D1[0];
-  qq[5] = /*(U[d+1]/d)**/D1[1];
-  qq[6] = /*(U[d+1]/d)**/D1[2];
-  qq[7] = 1.0;
-  /*ind = n+2;*/
-  qq[(n+1)*4] = /*((1.0-U[ind])/d)**/D2[0];
-  qq[((n+1)*4)+1] = /*((1.0-U[ind])/d)**/D2[1];
-  qq[((n+1)*4)+2] = /*((1.0-U[ind])/d)**/D2[2];
-  qq[((n+1)*4)+3] = 1.0;
+  free(A);
+  free(pivot);
 
+ return ay_status;
+} /* ay_nb_GlobalInterpolation4D */
 
-  /* Multiply through: xx = A(^-1)*qq */
-  for(i = 0; i < (n+3); i++)
-    {
-      for(j = 0; j < 4; j++)
-	{
-	  t = 0.0;
-	  for(k = 0; k < (n+3); k++)
-	    {
-	      t += (A[i*(n+3)+k] * qq[k*4+j]);
-	    }
-	  xx[i*4+j] = t;
-	}
-    }
 
-  /* Store the results */
-  memcpy(Q,xx,(n+3)*4*sizeof(double));
+/*
+ * ay_nb_GlobalInterpolation4DDSolve:
+ * interpolate the n+1 4D points in Q[] with end derivatives
+ * D1 (start) and D2 (end) using the band matrix decomposed by
+ * ay_nb_GlobalInterpolationLU() (with ders set to AY_TRUE);
+ * Q has to be of size n+3 and filled sparsely:
+ * P[0],,P[1],...,P[n-1],,P[n]!
+ */
+void
+ay_nb_GlobalInterpolation4DDSolve(int n, double *Q, double *D1, double *D2,
+				  int kl, int ku, double *AB, int *pivot)
+{
+ int i, j;
+
+  /* Insert Derivatives */
+  Q[4] = /*(U[d+1]/d)**/D1[0];
+  Q[5] = /*(U[d+1]/d)**/D1[1];
+  Q[6] = /*(U[d+1]/d)**/D1[2];
+  Q[7] = 1.0;
+  /*ind = n+2;*/
+  Q[(n+1)*4] = /*((1.0-U[ind])/d)**/D2[0];
+  Q[((n+1)*4)+1] = /*((1.0-U[ind])/d)**/D2[1];
+  Q[((n+1)*4)+2] = /*((1.0-U[ind])/d)**/D2[2];
+  Q[((n+1)*4)+3] = 1.0;
+
+  /* solve the band equation system A*X = Q and store the results */
+  ay_nb_BandLUSolve(n+3, kl, ku, AB, pivot, 4, 4, Q);
 
   j = 3;
   for(i = 0; i < (n+3); i++)
@@ -408,18 +604,37 @@ ay_nb_GlobalInterpolation4DD(int n, double *Q, double *ub, double *Uc, int d,
       j += 4;
     }
 
-cleanup:
+ return;
+} /* ay_nb_GlobalInterpolation4DDSolve */
 
-  if(A)
-    free(A);
-  if(N)
-    free(N);
-  if(qq)
-    free(qq);
-  if(xx)
-    free(xx);
-  if(pivot)
-    free(pivot);
+
+/*
+ * ay_nb_GlobalInterpolation4DD:
+ * interpolate the n+1 4D points in Q[] with
+ * n+1 precalculated parametric values in ub[]
+ * and n+d+3 knots in Uc[] with desired degree d (d <= n+2!)
+ * and end derivatives D1 (start) and D2 (end)
+ * Q has to be of size n+3 and filled sparsely:
+ * P[0],,P[1],...,P[n-1],,P[n]!
+ */
+int
+ay_nb_GlobalInterpolation4DD(int n, double *Q, double *ub, double *Uc, int d,
+			     double *D1, double *D2)
+{
+ int ay_status = AY_OK;
+ int kl, ku, *pivot = NULL;
+ double *A = NULL;
+
+  ay_status = ay_nb_GlobalInterpolationLU(n, ub, Uc, d, AY_TRUE,
+					  &kl, &ku, &A, &pivot);
+
+  if(ay_status)
+    return ay_status;
+
+  ay_nb_GlobalInterpolation4DDSolve(n, Q, D1, D2, kl, ku, A, pivot);
+
+  free(A);
+  free(pivot);
 
  return ay_status;
 } /* ay_nb_GlobalInterpolation4DD */
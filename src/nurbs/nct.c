@@ -21,6 +21,39 @@
 typedef void (ay_nct_gndcb) (char dir, ay_nurbcurve_object *nc,
 			     double *p, double **dp);
 
+/** Bezier segment of a NURBS curve (for intersection computation) */
+typedef struct ay_nct_bezseg_s {
+  double *cv; /**< control points in homogeneous coordinates [order*4] */
+  int freecv; /**< free cv when freeing the segment? */
+  int order; /**< order of segment */
+  int set; /**< set of curve (0, 1) */
+  int curve; /**< index of curve in set */
+  double u0; /**< parameter of curve at start of segment */
+  double u1; /**< parameter of curve at end of segment */
+  double box[6]; /**< bounding box (minx, maxx, miny, maxy, minz, maxz) */
+} ay_nct_bezseg;
+
+/** intersection of two curves */
+typedef struct ay_nct_isect_s {
+  int cu; /**< index of curve in set 0 */
+  int cv; /**< index of curve in set 1 */
+  double u; /**< parameter on curve in set 0 */
+  double v; /**< parameter on curve in set 1 */
+  double p[3]; /**< intersection point */
+} ay_nct_isect;
+
+/** relative flatness of Bezier segments for intersection computation */
+#define AY_NCTISECTFLAT 1.0e-3
+
+/** maximum subdivision depth for intersection computation */
+#define AY_NCTISECTMAXDEPTH 32
+
+/** maximum number of Newton iterations for intersection computation */
+#define AY_NCTISECTMAXITER 32
+
+/** parametric tolerance of Newton iterations */
+#define AY_NCTISECTPTOL 1.0e-12
+
 /* prototypes of functions local to this module: */
 int ay_nct_offsetsection(ay_object *o, double offset,
 			 ay_nurbcurve_object **nc);
@@ -36,6 +69,38 @@ void ay_nct_gndc(char dir, ay_nurbcurve_object *nc, double *p,
 void ay_nct_gndp(char dir, ay_nurbcurve_object *nc, double *p,
 		 double **dp);
 
+void ay_nct_bezbox(double *cv, int order, double *box);
+
+void ay_nct_bezeval(double *cv, int order, double t, double *w,
+		    double *p, double *d);
+
+void ay_nct_bezsplit(double *cv, int order, double *left, double *right);
+
+int ay_nct_bezflat(double *cv, int order, double tol);
+
+void ay_nct_bezchords(double *acv, int aorder, double *bcv, int border,
+		      double *s, double *t);
+
+int ay_nct_isectnewton(ay_nct_bezseg *a, ay_nct_bezseg *b, double tol,
+		       double *w, double s, double t, ay_nct_isect *res);
+
+int ay_nct_isectbez(ay_nct_bezseg *a, double *acv, double s0, double s1,
+		    ay_nct_bezseg *b, double *bcv, double t0, double t1,
+		    int depth, double tol, double *w,
+		    ay_nct_isect **res, int *nres, int *ares);
+
+int ay_nct_tobezsegs(ay_nurbcurve_object *nc, int set, int curve,
+		     ay_nct_bezseg **segs, int *nsegs, int *asegs);
+
+void ay_nct_freebezsegs(ay_nct_bezseg *segs, int nsegs);
+
+int ay_nct_cmpbezseg(const void *p1, const void *p2);
+
+int ay_nct_cmpisect(const void *p1, const void *p2);
+
+int ay_nct_isectsegs(ay_nct_bezseg *segs, int nsegs, double tol,
+		     ay_nct_isect **res, int *nres);
+
 /* local variables: */
 char ay_nct_ncname[] = "NCurve";
 
@@ -6207,170 +6272,802 @@ ay_nct_getcurvaturetcmd(ClientData clientData, Tcl_Interp *interp,
 } /* ay_nct_getcurvaturetcmd */
 
 
-/* ay_nct_intersect:
- *
+/* ay_nct_bezbox:
+ *  calculate the bounding box of a Bezier segment
+ *  given in homogeneous coordinates
+ */
+void
+ay_nct_bezbox(double *cv, int order, double *box)
+{
+ double x, y, z;
+ int i, a = 0;
+
+  box[0] = box[2] = box[4] = DBL_MAX;
+  box[1] = box[3] = box[5] = -DBL_MAX;
+
+  for(i = 0; i < order; i++)
+    {
+      if(cv[a+3] != 0.0)
+	{
+	  x = cv[a]/cv[a+3];
+	  y = cv[a+1]/cv[a+3];
+	  z = cv[a+2]/cv[a+3];
+	}
+      else
+	{
+	  x = cv[a];
+	  y = cv[a+1];
+	  z = cv[a+2];
+	}
+
+      if(x < box[0])
+	box[0] = x;
+      if(x > box[1])
+	box[1] = x;
+      if(y < box[2])
+	box[2] = y;
+      if(y > box[3])
+	box[3] = y;
+      if(z < box[4])
+	box[4] = z;
+      if(z > box[5])
+	box[5] = z;
+
+      a += 4;
+    } /* for */
+
+ return;
+} /* ay_nct_bezbox */
+
+
+/* ay_nct_bezeval:
+ *  evaluate point and first derivative of a Bezier segment
+ *  given in homogeneous coordinates at parameter t (0-1);
+ *  \a w is a work area of size order*4
+ */
+void
+ay_nct_bezeval(double *cv, int order, double t, double *w,
+	       double *p, double *d)
+{
+ double t1 = 1.0-t, wp, wd;
+ int i, j, n = order-1;
+
+  memcpy(w, cv, order*4*sizeof(double));
+
+  for(i = 1; i < n; i++)
+    {
+      for(j = 0; j < (n-i+1)*4; j++)
+	{
+	  w[j] = t1*w[j] + t*w[j+4];
+	}
+    }
+
+  /* now w[0-3] and w[4-7] span the degree 1 segment */
+  wp = t1*w[3] + t*w[7];
+  wd = n*(w[7] - w[3]);
+  if(wp == 0.0)
+    wp = 1.0;
+
+  for(j = 0; j < 3; j++)
+    {
+      p[j] = (t1*w[j] + t*w[j+4])/wp;
+      d[j] = (n*(w[j+4] - w[j]) - wd*p[j])/wp;
+    }
+
+ return;
+} /* ay_nct_bezeval */
+
+
+/* ay_nct_bezsplit:
+ *  split a Bezier segment given in homogeneous coordinates
+ *  in the middle; \a left and \a right must be of size order*4
+ */
+void
+ay_nct_bezsplit(double *cv, int order, double *left, double *right)
+{
+ int i, j, n = order-1;
+
+  memcpy(right, cv, order*4*sizeof(double));
+  memcpy(left, cv, 4*sizeof(double));
+
+  for(i = 1; i <= n; i++)
+    {
+      for(j = 0; j < (n-i+1)*4; j++)
+	{
+	  right[j] = 0.5*(right[j] + right[j+4]);
+	}
+      memcpy(&(left[i*4]), right, 4*sizeof(double));
+    }
+
+ return;
+} /* ay_nct_bezsplit */
+
+
+/* ay_nct_bezflat:
+ *  check whether the control polygon of a Bezier segment given
+ *  in homogeneous coordinates deviates from the chord by less than
+ *  AY_NCTISECTFLAT times the chord length (or \a tol)
  */
 int
-ay_nct_intersect(ay_nurbcurve_object *cu, ay_nurbcurve_object *cv,
-		 double *intersection)
+ay_nct_bezflat(double *cv, int order, double tol)
+{
+ double p0[3], pn[3], c[3], v[3], x[3], l, d, ftol;
+ int i, a = (order-1)*4;
+
+  p0[0] = cv[0]/cv[3];
+  p0[1] = cv[1]/cv[3];
+  p0[2] = cv[2]/cv[3];
+
+  pn[0] = cv[a]/cv[a+3];
+  pn[1] = cv[a+1]/cv[a+3];
+  pn[2] = cv[a+2]/cv[a+3];
+
+  AY_V3SUB(c, pn, p0);
+  l = AY_V3LEN(c);
+
+  ftol = l*AY_NCTISECTFLAT;
+  if(ftol < tol)
+    ftol = tol;
+
+  a = 4;
+  for(i = 1; i < order-1; i++)
+    {
+      v[0] = cv[a]/cv[a+3] - p0[0];
+      v[1] = cv[a+1]/cv[a+3] - p0[1];
+      v[2] = cv[a+2]/cv[a+3] - p0[2];
+
+      if(l > AY_EPSILON)
+	{
+	  AY_V3CROSS(x, v, c);
+	  d = AY_V3LEN(x)/l;
+	}
+      else
+	{
+	  d = AY_V3LEN(v);
+	}
+
+      if(d > ftol)
+	return AY_FALSE;
+
+      a += 4;
+    } /* for */
+
+ return AY_TRUE;
+} /* ay_nct_bezflat */
+
+
+/* ay_nct_bezchords:
+ *  compute the parameters of the closest points of the chords
+ *  of two Bezier segments given in homogeneous coordinates
+ */
+void
+ay_nct_bezchords(double *acv, int aorder, double *bcv, int border,
+		 double *s, double *t)
+{
+ double p1[3], q1[3], p2[3], q2[3], d1[3], d2[3], r[3];
+ double a, b, c, e, f, denom;
+ int i, j;
+
+  i = (aorder-1)*4;
+  for(j = 0; j < 3; j++)
+    {
+      p1[j] = acv[j]/acv[3];
+      q1[j] = acv[i+j]/acv[i+3];
+    }
+  i = (border-1)*4;
+  for(j = 0; j < 3; j++)
+    {
+      p2[j] = bcv[j]/bcv[3];
+      q2[j] = bcv[i+j]/bcv[i+3];
+    }
+
+  AY_V3SUB(d1, q1, p1);
+  AY_V3SUB(d2, q2, p2);
+  AY_V3SUB(r, p1, p2);
+
+  a = AY_V3DOT(d1, d1);
+  e = AY_V3DOT(d2, d2);
+  f = AY_V3DOT(d2, r);
+
+  *s = 0.5;
+  *t = 0.5;
+
+  if(a <= AY_EPSILON && e <= AY_EPSILON)
+    return;
+
+  if(a <= AY_EPSILON)
+    {
+      *s = 0.0;
+      *t = f/e;
+    }
+  else
+    {
+      c = AY_V3DOT(d1, r);
+      if(e <= AY_EPSILON)
+	{
+	  *t = 0.0;
+	  *s = -c/a;
+	}
+      else
+	{
+	  b = AY_V3DOT(d1, d2);
+	  denom = a*e - b*b;
+	  if(denom > AY_EPSILON*a*e)
+	    *s = (b*f - c*e)/denom;
+	  if(*s < 0.0)
+	    *s = 0.0;
+	  if(*s > 1.0)
+	    *s = 1.0;
+	  *t = (b*(*s) + f)/e;
+	  if(*t < 0.0)
+	    {
+	      *t = 0.0;
+	      *s = -c/a;
+	    }
+	  else
+	    if(*t > 1.0)
+	      {
+		*t = 1.0;
+		*s = (b - c)/a;
+	      }
+	}
+    }
+
+  if(*s < 0.0)
+    *s = 0.0;
+  if(*s > 1.0)
+    *s = 1.0;
+  if(*t < 0.0)
+    *t = 0.0;
+  if(*t > 1.0)
+    *t = 1.0;
+
+ return;
+} /* ay_nct_bezchords */
+
+
+/* ay_nct_isectnewton:
+ *  refine an intersection of two Bezier segments from the start
+ *  parameters \a s and \a t (0-1) by Newton iteration of the
+ *  (least squares) system C(s) - D(t) = 0;
+ *  returns AY_TRUE if the segments are closer than \a tol
+ *  at the final parameters
+ */
+int
+ay_nct_isectnewton(ay_nct_bezseg *a, ay_nct_bezseg *b, double tol,
+		   double *w, double s, double t, ay_nct_isect *res)
+{
+ double cp[3], cd[3], dp[3], dd[3], F[3];
+ double a11, a12, a22, r1, r2, det, ds, dt, dist;
+ int i;
+
+  for(i = 0; i < AY_NCTISECTMAXITER; i++)
+    {
+      ay_nct_bezeval(a->cv, a->order, s, w, cp, cd);
+      ay_nct_bezeval(b->cv, b->order, t, w, dp, dd);
+      AY_V3SUB(F, cp, dp);
+
+      if(AY_V3DOT(F, F) < tol*tol*1.0e-6)
+	break;
+
+      a11 = AY_V3DOT(cd, cd);
+      a12 = -AY_V3DOT(cd, dd);
+      a22 = AY_V3DOT(dd, dd);
+      r1 = -AY_V3DOT(cd, F);
+      r2 = AY_V3DOT(dd, F);
+
+      det = a11*a22 - a12*a12;
+      if(fabs(det) <= AY_EPSILON*a11*a22 || det == 0.0)
+	break;
+
+      ds = (r1*a22 - a12*r2)/det;
+      dt = (a11*r2 - a12*r1)/det;
+
+      s += ds;
+      t += dt;
+
+      if(s < 0.0)
+	s = 0.0;
+      if(s > 1.0)
+	s = 1.0;
+      if(t < 0.0)
+	t = 0.0;
+      if(t > 1.0)
+	t = 1.0;
+
+      if(fabs(ds) < AY_NCTISECTPTOL && fabs(dt) < AY_NCTISECTPTOL)
+	break;
+    } /* for */
+
+  ay_nct_bezeval(a->cv, a->order, s, w, cp, cd);
+  ay_nct_bezeval(b->cv, b->order, t, w, dp, dd);
+  AY_V3SUB(F, cp, dp);
+  dist = AY_V3LEN(F);
+
+  if(dist > tol)
+    return AY_FALSE;
+
+  res->cu = a->curve;
+  res->cv = b->curve;
+  res->u = a->u0 + s*(a->u1 - a->u0);
+  res->v = b->u0 + t*(b->u1 - b->u0);
+  res->p[0] = (cp[0] + dp[0])*0.5;
+  res->p[1] = (cp[1] + dp[1])*0.5;
+  res->p[2] = (cp[2] + dp[2])*0.5;
+
+ return AY_TRUE;
+} /* ay_nct_isectnewton */
+
+
+/* ay_nct_isectbez:
+ *  find the intersections of the parts [s0, s1] of Bezier segment \a a
+ *  (with control points \a acv) and [t0, t1] of Bezier segment \a b
+ *  (with control points \a bcv) by recursive subdivision and Newton
+ *  iteration; results are appended to \a res
+ */
+int
+ay_nct_isectbez(ay_nct_bezseg *a, double *acv, double s0, double s1,
+		ay_nct_bezseg *b, double *bcv, double t0, double t1,
+		int depth, double tol, double *w,
+		ay_nct_isect **res, int *nres, int *ares)
 {
  int ay_status = AY_OK;
-#if 0
- double *bu = NULL, *bv = NULL; /* Bezier segment arrays */
- double *su, *sv;
- double cuminx, cumaxx, cvminx, cvmaxx;
- double cuminy, cumaxy, cvminy, cvmaxy;
- double cuminz, cumaxz, cvminz, cvmaxz;
- int nbu = 0, nbv = 0;
- int stride = 4, i, j, k, overlap;
-
-  if(!cu || !cv || !intersection)
+ double abox[6], bbox[6], s, t, sm, tm;
+ double *split = NULL, *al, *ar, *bl, *br;
+ int aflat, bflat, asize, bsize;
+ ay_nct_isect *t_res;
+
+  ay_nct_bezbox(acv, a->order, abox);
+  ay_nct_bezbox(bcv, b->order, bbox);
+
+  if(abox[1]+tol < bbox[0] || bbox[1]+tol < abox[0] ||
+     abox[3]+tol < bbox[2] || bbox[3]+tol < abox[2] ||
+     abox[5]+tol < bbox[4] || bbox[5]+tol < abox[4])
+    return AY_OK;
+
+  aflat = ay_nct_bezflat(acv, a->order, tol);
+  bflat = ay_nct_bezflat(bcv, b->order, tol);
+
+  if((aflat && bflat) || depth >= AY_NCTISECTMAXDEPTH)
+    {
+      if(*nres >= *ares)
+	{
+	  if(!(t_res = realloc(*res, (*ares+64)*2*sizeof(ay_nct_isect))))
+	    return AY_EOMEM;
+	  *res = t_res;
+	  *ares = (*ares+64)*2;
+	}
+
+      ay_nct_bezchords(acv, a->order, bcv, b->order, &s, &t);
+
+      if(ay_nct_isectnewton(a, b, tol, w, s0 + s*(s1-s0), t0 + t*(t1-t0),
+			    &((*res)[*nres])))
+	(*nres)++;
+
+      return AY_OK;
+    } /* if */
+
+  asize = a->order*4;
+  bsize = b->order*4;
+
+  if(!(split = malloc(2*(asize+bsize)*sizeof(double))))
+    return AY_EOMEM;
+
+  al = split;
+  ar = al+asize;
+  bl = ar+asize;
+  br = bl+bsize;
+
+  sm = (s0+s1)*0.5;
+  tm = (t0+t1)*0.5;
+
+  if(!aflat && !bflat)
+    {
+      ay_nct_bezsplit(acv, a->order, al, ar);
+      ay_nct_bezsplit(bcv, b->order, bl, br);
+      ay_status = ay_nct_isectbez(a, al, s0, sm, b, bl, t0, tm, depth+1,
+				  tol, w, res, nres, ares);
+      if(!ay_status)
+	ay_status = ay_nct_isectbez(a, al, s0, sm, b, br, tm, t1, depth+1,
+				    tol, w, res, nres, ares);
+      if(!ay_status)
+	ay_status = ay_nct_isectbez(a, ar, sm, s1, b, bl, t0, tm, depth+1,
+				    tol, w, res, nres, ares);
+      if(!ay_status)
+	ay_status = ay_nct_isectbez(a, ar, sm, s1, b, br, tm, t1, depth+1,
+				    tol, w, res, nres, ares);
+    }
+  else
+    {
+      if(!aflat)
+	{
+	  ay_nct_bezsplit(acv, a->order, al, ar);
+	  ay_status = ay_nct_isectbez(a, al, s0, sm, b, bcv, t0, t1, depth+1,
+				      tol, w, res, nres, ares);
+	  if(!ay_status)
+	    ay_status = ay_nct_isectbez(a, ar, sm, s1, b, bcv, t0, t1,
+					depth+1, tol, w, res, nres, ares);
+	}
+      else
+	{
+	  ay_nct_bezsplit(bcv, b->order, bl, br);
+	  ay_status = ay_nct_isectbez(a, acv, s0, s1, b, bl, t0, tm, depth+1,
+				      tol, w, res, nres, ares);
+	  if(!ay_status)
+	    ay_status = ay_nct_isectbez(a, acv, s0, s1, b, br, tm, t1,
+					depth+1, tol, w, res, nres, ares);
+	}
+    } /* if */
+
+  free(split);
+
+ return ay_status;
+} /* ay_nct_isectbez */
+
+
+/* ay_nct_tobezsegs:
+ *  decompose NURBS curve \a nc into Bezier segments (in homogeneous
+ *  coordinates) and append them to the array \a segs
+ */
+int
+ay_nct_tobezsegs(ay_nurbcurve_object *nc, int set, int curve,
+		 ay_nct_bezseg **segs, int *nsegs, int *asegs)
+{
+ int ay_status = AY_OK;
+ ay_nurbcurve_object tnc;
+ ay_nct_bezseg *s, *t_segs;
+ double *Qw = NULL, *U, u;
+ int stride = 4, i, a, k, nb = 0;
+
+  if(!nc || !segs || !nsegs || !asegs)
     return AY_ENULL;
 
-  /* decompose both curves into Bezier segments */
-  if(!(bu = calloc(cu->order*stride, sizeof(double))))
+  memcpy(&tnc, nc, sizeof(ay_nurbcurve_object));
+
+  if(!(tnc.controlv = malloc(nc->length*stride*sizeof(double))))
     return AY_EOMEM;
+  memcpy(tnc.controlv, nc->controlv, nc->length*stride*sizeof(double));
+
+  if(!(tnc.knotv = malloc((nc->length+nc->order)*sizeof(double))))
+    { free(tnc.controlv); return AY_EOMEM; }
+  memcpy(tnc.knotv, nc->knotv, (nc->length+nc->order)*sizeof(double));
+
+  if(!ay_knots_isclamped(/*side=*/0, tnc.order, tnc.knotv,
+			 tnc.length+tnc.order, AY_EPSILON))
+    {
+      ay_status = ay_nct_clamp(&tnc, /*side=*/0);
+      if(ay_status)
+	goto cleanup;
+    }
+
+  /* convert to homogeneous coordinates */
+  if(tnc.is_rat)
+    {
+      a = 0;
+      for(i = 0; i < tnc.length; i++)
+	{
+	  tnc.controlv[a]   *= tnc.controlv[a+3];
+	  tnc.controlv[a+1] *= tnc.controlv[a+3];
+	  tnc.controlv[a+2] *= tnc.controlv[a+3];
+	  a += stride;
+	}
+    }
+
+  if(tnc.length == tnc.order)
+    {
+      nb = 1;
+      Qw = tnc.controlv;
+      tnc.controlv = NULL;
+    }
+  else
+    {
+      if(!(Qw = malloc(tnc.order*stride*sizeof(double))))
+	{ ay_status = AY_EOMEM; goto cleanup; }
+
+      ay_status = ay_nb_DecomposeCurve(stride, tnc.length-1, tnc.order-1,
+				       tnc.knotv, tnc.controlv, &nb, &Qw);
+      if(ay_status || nb < 1)
+	{ free(Qw); goto cleanup; }
+    }
 
-  ay_status = ay_nb_DecomposeCurve(4, cu->length, cu->order-1, cu->knotv,
-				   cu->controlv, &nbu, &bu);
+  if(*nsegs+nb > *asegs)
+    {
+      if(!(t_segs = realloc(*segs, (*nsegs+nb)*2*sizeof(ay_nct_bezseg))))
+	{ free(Qw); ay_status = AY_EOMEM; goto cleanup; }
+      *segs = t_segs;
+      *asegs = (*nsegs+nb)*2;
+    }
 
-  if(!(bv = calloc(cv->order*stride, sizeof(double))))
+  /* fill in the segments with their parameter ranges */
+  U = tnc.knotv;
+  u = U[tnc.order-1];
+  k = tnc.order;
+  for(i = 0; i < nb; i++)
+    {
+      s = &((*segs)[*nsegs]);
+      s->cv = &(Qw[i*tnc.order*stride]);
+      s->freecv = (i == 0);
+      s->order = tnc.order;
+      s->set = set;
+      s->curve = curve;
+      s->u0 = u;
+      while(k < tnc.length && U[k] <= u)
+	k++;
+      s->u1 = U[k];
+      u = s->u1;
+      ay_nct_bezbox(s->cv, s->order, s->box);
+      (*nsegs)++;
+    } /* for */
+
+cleanup:
+
+  if(tnc.controlv)
+    free(tnc.controlv);
+
+  if(tnc.knotv)
+    free(tnc.knotv);
+
+ return ay_status;
+} /* ay_nct_tobezsegs */
+
+
+/* ay_nct_freebezsegs:
+ *  free an array of Bezier segments created by ay_nct_tobezsegs()
+ */
+void
+ay_nct_freebezsegs(ay_nct_bezseg *segs, int nsegs)
+{
+ int i;
+
+  if(!segs)
+    return;
+
+  for(i = 0; i < nsegs; i++)
+    {
+      if(segs[i].freecv)
+	free(segs[i].cv);
+    }
+
+  free(segs);
+
+ return;
+} /* ay_nct_freebezsegs */
+
+
+/* ay_nct_cmpbezseg:
+ *  compare two Bezier segments by the minimum x of their bounding
+ *  boxes (helper for qsort)
+ */
+int
+ay_nct_cmpbezseg(const void *p1, const void *p2)
+{
+ const ay_nct_bezseg *s1 = p1, *s2 = p2;
+
+  if(s1->box[0] < s2->box[0])
+    return -1;
+  if(s1->box[0] > s2->box[0])
+    return 1;
+
+ return 0;
+} /* ay_nct_cmpbezseg */
+
+
+/* ay_nct_cmpisect:
+ *  compare two intersections by curve indices and parameter
+ *  (helper for qsort)
+ */
+int
+ay_nct_cmpisect(const void *p1, const void *p2)
+{
+ const ay_nct_isect *i1 = p1, *i2 = p2;
+
+  if(i1->cu != i2->cu)
+    return (i1->cu < i2->cu)?-1:1;
+  if(i1->cv != i2->cv)
+    return (i1->cv < i2->cv)?-1:1;
+  if(i1->u < i2->u)
+    return -1;
+  if(i1->u > i2->u)
+    return 1;
+
+ return 0;
+} /* ay_nct_cmpisect */
+
+
+/* ay_nct_isectsegs:
+ *  intersect all Bezier segments of set 0 with all Bezier segments
+ *  of set 1; candidate pairs are found by sweep and prune along
+ *  the x axis (this sorts \a segs), then refined by ay_nct_isectbez();
+ *  the results are sorted by curve indices and parameter, and
+ *  duplicates (e.g. at segment borders) are removed
+ */
+int
+ay_nct_isectsegs(ay_nct_bezseg *segs, int nsegs, double tol,
+		 ay_nct_isect **res, int *nres)
+{
+ int ay_status = AY_OK;
+ ay_nct_bezseg *si, *sj;
+ ay_nct_isect *r, *q;
+ double *w = NULL, d[3];
+ int *active = NULL, nactive = 0, ares = 0, maxorder = 2;
+ int i, j, k, dup;
+
+  if(!segs || !res || !nres)
+    return AY_ENULL;
+
+  *res = NULL;
+  *nres = 0;
+
+  if(nsegs < 2)
+    return AY_OK;
+
+  for(i = 0; i < nsegs; i++)
+    if(segs[i].order > maxorder)
+      maxorder = segs[i].order;
+
+  if(!(w = malloc(maxorder*4*sizeof(double))))
     return AY_EOMEM;
 
-  ay_status = ay_nb_DecomposeCurve(4, cv->length, cv->order-1, cv->knotv,
-				   cv->controlv, &nbv, &bv);
-
-  /* find intersecting Bezier segments (use convex hull property to
-     exclude all pairs that cannot intersect) */
-  for(i = 0; i < nbu; i++)
-    {
-      /* get min/max of segment i in bu (X) */
-      su = &bu[i*stride];
-      cuminx = DBL_MAX;
-      cumaxx = DBL_MIN;
-      for(k = 0; k < cu->order; k++)
-	{
-	  if(*su < cuminx)
-	    cuminx = *su;
-	  if(*su > cumaxx)
-	    cumaxx = *su;
-	  su += stride;
-	}
-      /* get min/max of segment i in bu (Y) */
-      su = &bu[i*stride+1];
-      cuminy = DBL_MAX;
-      cumaxy = DBL_MIN;
-      for(k = 0; k < cu->order; k++)
-	{
-	  if(*su < cuminy)
-	    cuminy = *su;
-	  if(*su > cumaxy)
-	    cumaxy = *su;
-	  su += stride;
-	}
-      /* get min/max of segment i in bu (Z) */
-      su = &bu[i*stride+2];
-      cuminz = DBL_MAX;
-      cumaxz = DBL_MIN;
-      for(k = 0; k < cu->order; k++)
-	{
-	  if(*su < cuminz)
-	    cuminz = *su;
-	  if(*su > cumaxz)
-	    cumaxz = *su;
-	  su += stride;
-	}
-
-      /* now check against all segments in nbv */
-      for(j = 0; j < nbv; j++)
-	{
-	  overlap = AY_TRUE;
-	  /* get min/max of segment j in bv (Z) */
-	  sv = &bv[j*stride];
-	  cvminx = DBL_MAX;
-	  cvmaxx = DBL_MIN;
-	  for(k = 0; k < cv->order; k++)
-	    {
-	      if(*sv < cvminx)
-		cvminx = *su;
-	      if(*sv > cvmaxx)
-		cvmaxx = *sv;
-	      sv += stride;
-	    }
-	  if(!((cumaxx < cvminx)||(cvmaxx < cuminx)))
-	    {
-	      /* overlap in X => need to check Y */
-	      sv = &bv[j*stride+1];
-	      cvminy = DBL_MAX;
-	      cvmaxy = DBL_MIN;
-	      for(k = 0; k < cv->order; k++)
-		{
-		  if(*sv < cvminy)
-		    cvminy = *su;
-		  if(*sv > cvmaxy)
-		    cvmaxy = *sv;
-		  sv += stride;
-		}
-	      if(!((cumaxy < cvminy)||(cvmaxy < cuminy)))
-		{
-		  /* overlap in Y => need to check Z */
-		  sv = &bv[j*stride+2];
-		  cvminz = DBL_MAX;
-		  cvmaxz = DBL_MIN;
-		  for(k = 0; k < cv->order; k++)
-		    {
-		      if(*sv < cvminz)
-			cvminz = *su;
-		      if(*sv > cvmaxz)
-			cvmaxz = *sv;
-		      sv += stride;
-		    }
-		  if((cumaxz < cvminz)||(cvmaxz < cuminz))
-		    {
-		      /* no overlap in Z */
-		      overlap = AY_FALSE;
-		    }
-		}
-	      else
+  if(!(active = malloc(nsegs*sizeof(int))))
+    { free(w); return AY_EOMEM; }
+
+  qsort(segs, nsegs, sizeof(ay_nct_bezseg), ay_nct_cmpbezseg);
+
+  for(i = 0; i < nsegs; i++)
+    {
+      si = &(segs[i]);
+
+      /* remove segments that end before si starts from the active list */
+      k = 0;
+      for(j = 0; j < nactive; j++)
+	{
+	  if(segs[active[j]].box[1]+tol >= si->box[0])
+	    active[k++] = active[j];
+	}
+      nactive = k;
+
+      for(j = 0; j < nactive; j++)
+	{
+	  sj = &(segs[active[j]]);
+
+	  if(sj->set == si->set)
+	    continue;
+
+	  if(si->box[3]+tol < sj->box[2] || sj->box[3]+tol < si->box[2] ||
+	     si->box[5]+tol < sj->box[4] || sj->box[5]+tol < si->box[4])
+	    continue;
+
+	  if(si->set == 0)
+	    ay_status = ay_nct_isectbez(si, si->cv, 0.0, 1.0,
+					sj, sj->cv, 0.0, 1.0,
+					0, tol, w, res, nres, &ares);
+	  else
+	    ay_status = ay_nct_isectbez(sj, sj->cv, 0.0, 1.0,
+					si, si->cv, 0.0, 1.0,
+					0, tol, w, res, nres, &ares);
+	  if(ay_status)
+	    goto cleanup;
+	} /* for */
+
+      active[nactive++] = i;
+    } /* for */
+
+  if(*nres > 1)
+    {
+      qsort(*res, *nres, sizeof(ay_nct_isect), ay_nct_cmpisect);
+
+      /* remove duplicates */
+      k = 0;
+      j = 0;
+      for(i = 0; i < *nres; i++)
+	{
+	  r = &((*res)[i]);
+	  if(i > 0 && (r->cu != (*res)[i-1].cu || r->cv != (*res)[i-1].cv))
+	    j = k;
+	  dup = AY_FALSE;
+	  for(q = &((*res)[j]); q < &((*res)[k]); q++)
+	    {
+	      AY_V3SUB(d, q->p, r->p);
+	      if(AY_V3LEN(d) <= tol)
 		{
-		  overlap = AY_FALSE;
+		  dup = AY_TRUE;
+		  break;
 		}
 	    }
-	  else
+	  if(!dup)
 	    {
-	      overlap = AY_FALSE;
+	      if(k != i)
+		memcpy(&((*res)[k]), r, sizeof(ay_nct_isect));
+	      k++;
 	    }
+	} /* for */
+      *nres = k;
+    } /* if */
 
-	  if(overlap)
-	    {
-	      /* segments bu[i] and bv[j] overlap at least in one
-		 dimension => calculate smallest distance */
+cleanup:
 
+  if(ay_status)
+    {
+      if(*res)
+	free(*res);
+      *res = NULL;
+      *nres = 0;
+    }
 
-	    }
+  free(w);
+  free(active);
 
-	} /* for */
-    } /* for */
+ return ay_status;
+} /* ay_nct_isectsegs */
+
+
+/** ay_nct_intersect:
+ * Calculate all intersections of two NURBS curves.
+ * The curves are decomposed into Bezier segments, candidate segment
+ * pairs are found via their bounding boxes, and the intersections
+ * are then located by subdivision and refined by Newton iteration.
+ *
+ * \param[in] cu  first NURBS curve
+ * \param[in] cv  second NURBS curve
+ * \param[in] tolerance  maximum distance of the curves at an
+ *  intersection, if <= 0.0, AY_EPSILON is used
+ * \param[in,out] intersections  where to store the intersection
+ *  parameters, as pairs (u, v) sorted by u, u is the parameter
+ *  on \a cu, v the parameter on \a cv
+ * \param[in,out] nintersections  where to store the number of
+ *  intersections
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_nct_intersect(ay_nurbcurve_object *cu, ay_nurbcurve_object *cv,
+		 double tolerance, double **intersections,
+		 int *nintersections)
+{
+ int ay_status = AY_OK;
+ ay_nct_bezseg *segs = NULL;
+ ay_nct_isect *res = NULL;
+ int nsegs = 0, asegs = 0, nres = 0, i;
+
+  if(!cu || !cv || !intersections || !nintersections)
+    return AY_ENULL;
+
+  *intersections = NULL;
+  *nintersections = 0;
 
+  if(tolerance <= 0.0)
+    tolerance = AY_EPSILON;
 
-  /* first, calc middle point of control hull */
-  su = &(bu[i*stride]);
-  for(i = 0; i < nbu; i++)
+  ay_status = ay_nct_tobezsegs(cu, 0, 0, &segs, &nsegs, &asegs);
+  if(ay_status)
+    goto cleanup;
+
+  ay_status = ay_nct_tobezsegs(cv, 1, 0, &segs, &nsegs, &asegs);
+  if(ay_status)
+    goto cleanup;
+
+  ay_status = ay_nct_isectsegs(segs, nsegs, tolerance, &res, &nres);
+  if(ay_status || !nres)
+    goto cleanup;
+
+  if(!(*intersections = malloc(nres*2*sizeof(double))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  for(i = 0; i < nres; i++)
     {
-      k = 0;
-      for(j = 0; j < cu->order; j++)
-	{
+      (*intersections)[i*2]   = res[i].u;
+      (*intersections)[i*2+1] = res[i].v;
+    }
 
+  *nintersections = nres;
 
-	}
-      k+=stride;
-    } /* for */
+cleanup:
 
-  sv = &(bv[j*stride]);
+  ay_nct_freebezsegs(segs, nsegs);
 
-  /* compare x component */
+  if(res)
+    free(res);
 
-#endif
  return ay_status;
 } /* ay_nct_intersect */
 
@@ -6379,6 +7076,11 @@ ay_nct_intersect(ay_nurbcurve_object *cu, ay_nurbcurve_object *cv,
  * Calculate the intersections of two sets of ordered intersecting
  * and isoparametric curves.
  * This is needed for the Gordon surface creation.
+ * The intersections are computed with the same engine as used by
+ * ay_nct_intersect() for all curves at once; if two curves do not
+ * intersect (within a tolerance relative to the size of the curve
+ * network), the intersection point is estimated by sampling the
+ * curves instead.
  *
  * XXXX Todo: this could be made more robust by also computing
  * intersection points from the u curves and then calculating
@@ -6402,7 +7104,10 @@ ay_nct_intersectsets(int ncu, ay_object *cu, int ncv, ay_object *cv,
  double *us = NULL, *vs = NULL, u, v, pnt[3];
  ay_object *cuo, *cvo;
  ay_nurbcurve_object *nc;
- double *a;
+ ay_nct_bezseg *segs = NULL;
+ ay_nct_isect *res = NULL, *r;
+ int nsegs = 0, asegs = 0, nres = 0, *best = NULL;
+ double *a, box[6], tol;
  int i, j;
 
   if(!(us = calloc(ncv, sizeof(double))))
@@ -6468,7 +7173,67 @@ ay_nct_intersectsets(int ncu, ay_object *cu, int ncv, ay_object *cv,
     }
 #endif
 
-  /* compute intersections */
+  /* compute exact intersections */
+  cuo = cu;
+  for(j = 0; j < ncu; j++)
+    {
+      ay_status = ay_nct_tobezsegs((ay_nurbcurve_object *)cuo->refine, 0, j,
+				   &segs, &nsegs, &asegs);
+      if(ay_status)
+	goto cleanup;
+      cuo = cuo->next;
+    }
+
+  cvo = cv;
+  for(i = 0; i < ncv; i++)
+    {
+      ay_status = ay_nct_tobezsegs((ay_nurbcurve_object *)cvo->refine, 1, i,
+				   &segs, &nsegs, &asegs);
+      if(ay_status)
+	goto cleanup;
+      cvo = cvo->next;
+    }
+
+  memcpy(box, segs[0].box, 6*sizeof(double));
+  for(i = 1; i < nsegs; i++)
+    {
+      for(j = 0; j < 6; j += 2)
+	{
+	  if(segs[i].box[j] < box[j])
+	    box[j] = segs[i].box[j];
+	  if(segs[i].box[j+1] > box[j+1])
+	    box[j+1] = segs[i].box[j+1];
+	}
+    }
+  pnt[0] = box[1]-box[0];
+  pnt[1] = box[3]-box[2];
+  pnt[2] = box[5]-box[4];
+  tol = AY_V3LEN(pnt)*AY_EPSILON;
+  if(tol < AY_EPSILON)
+    tol = AY_EPSILON;
+
+  ay_status = ay_nct_isectsegs(segs, nsegs, tol, &res, &nres);
+  if(ay_status)
+    goto cleanup;
+
+  /* for each pair of curves, pick the intersection closest
+     to the sampled parameter */
+  if(!(best = malloc(ncu*ncv*sizeof(int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  for(i = 0; i < ncu*ncv; i++)
+    best[i] = -1;
+
+  for(i = 0; i < nres; i++)
+    {
+      r = &(res[i]);
+      j = r->cv*ncu + r->cu;
+      if(best[j] == -1 ||
+	 fabs(r->v - vs[r->cu]) < fabs(res[best[j]].v - vs[r->cu]))
+	best[j] = i;
+    }
+
+  /* fill result */
   a = intersections;
   cvo = cv;
   for(i = 0; i < ncv; i++)
@@ -6476,8 +7241,11 @@ ay_nct_intersectsets(int ncu, ay_object *cu, int ncv, ay_object *cv,
       nc = (ay_nurbcurve_object *)cvo->refine;
       for(j = 0; j < ncu; j++)
 	{
-	  ay_status = ay_nb_CurvePoint4D(nc->length-1, nc->order-1, nc->knotv,
-					 nc->controlv, vs[j], a);
+	  if(best[i*ncu+j] != -1)
+	    memcpy(a, res[best[i*ncu+j]].p, 3*sizeof(double));
+	  else
+	    ay_status = ay_nb_CurvePoint4D(nc->length-1, nc->order-1,
+					   nc->knotv, nc->controlv, vs[j], a);
 	  a[3] = 1.0;
 	  /*
 	  printf("(%d,%d)=(%lg %lg %lg)\n",i,j,a[0],a[1],a[2]);
@@ -6495,10 +7263,147 @@ cleanup:
   if(vs)
     free(vs);
 
+  ay_nct_freebezsegs(segs, nsegs);
+
+  if(res)
+    free(res);
+
+  if(best)
+    free(best);
+
  return ay_status;
 } /* ay_nct_intersectsets */
 
 
+/** ay_nct_intersecttcmd:
+ *  Calculate all intersections of the two selected NURBS curves.
+ *  Implements the \a intersectNC scripting interface command.
+ *  See also the corresponding section in the \ayd{scintersectnc}.
+ *
+ *  \returns TCL_OK in any case.
+ */
+int
+ay_nct_intersecttcmd(ClientData clientData, Tcl_Interp *interp,
+		     int argc, char *argv[])
+{
+ int ay_status = AY_OK, tcl_status = TCL_OK;
+ ay_list_object *sel = ay_selection;
+ ay_object *o, *c[2] = {NULL}, *po[2] = {NULL};
+ double tolerance = 0.0, *isects = NULL;
+ int apply_trafo = AY_FALSE, nisects = 0, i = 1, j = 0;
+ Tcl_Obj *to = NULL, *res = NULL;
+ char *vname = NULL;
+
+  /* parse args */
+  while(i < argc)
+    {
+      if((argv[i][0] == '-') && (argv[i][1] == 't') && (argv[i][2] == 'o'))
+	{
+	  /* -tolerance */
+	  if(argc < i+2)
+	    {
+	      ay_error(AY_EARGS, argv[0], "[-trafo] [-tolerance t] [vname]");
+	      return TCL_OK;
+	    }
+	  tcl_status = Tcl_GetDouble(interp, argv[i+1], &tolerance);
+	  AY_CHTCLERRRET(tcl_status, argv[0], interp);
+	  i++;
+	}
+      else
+	if((argv[i][0] == '-') && (argv[i][1] == 't'))
+	  {
+	    /* -trafo */
+	    apply_trafo = AY_TRUE;
+	  }
+	else
+	  {
+	    vname = argv[i];
+	  }
+      i++;
+    } /* while */
+
+  /* get the two curves to work on */
+  while(sel && j < 2)
+    {
+      o = sel->object;
+      if(o->type != AY_IDNCURVE)
+	{
+	  ay_status = ay_provide_object(o, AY_IDNCURVE, &(po[j]));
+	  if(ay_status || !po[j])
+	    {
+	      ay_error(AY_ERROR, argv[0], "Provide failed.");
+	      goto cleanup;
+	    }
+	}
+      else
+	{
+	  if(apply_trafo)
+	    {
+	      ay_status = ay_object_copy(o, &(po[j]));
+	      if(ay_status)
+		{
+		  ay_error(ay_status, argv[0], NULL);
+		  goto cleanup;
+		}
+	    }
+	}
+
+      if(po[j])
+	{
+	  c[j] = po[j];
+	  if(apply_trafo)
+	    ay_nct_applytrafo(c[j]);
+	}
+      else
+	{
+	  c[j] = o;
+	}
+      j++;
+      sel = sel->next;
+    } /* while */
+
+  if(j < 2)
+    {
+      ay_error(AY_ERROR, argv[0], "Select two NURBS curves.");
+      goto cleanup;
+    }
+
+  ay_status = ay_nct_intersect((ay_nurbcurve_object *)c[0]->refine,
+			       (ay_nurbcurve_object *)c[1]->refine,
+			       tolerance, &isects, &nisects);
+  if(ay_status)
+    {
+      ay_error(ay_status, argv[0], "Intersection failed.");
+      goto cleanup;
+    }
+
+  res = Tcl_NewListObj(0, NULL);
+  for(i = 0; i < nisects*2; i++)
+    {
+      to = Tcl_NewDoubleObj(isects[i]);
+      Tcl_ListObjAppendElement(interp, res, to);
+    }
+
+  if(vname)
+    Tcl_SetVar2Ex(interp, vname, NULL, res, TCL_LEAVE_ERR_MSG);
+  else
+    Tcl_SetObjResult(interp, res);
+
+cleanup:
+
+  if(isects)
+    free(isects);
+
+  for(j = 0; j < 2; j++)
+    {
+      if(po[j])
+	(void)ay_object_deletemulti(po[j], AY_FALSE);
+    }
+
+ return TCL_OK;
+} /* ay_nct_intersecttcmd */
+
+
 /** ay_nct_iscompatible:
  * Checks the curve objects for compatibility (whether or not they
  * are of the same order, length, and defined on the same knot vector).
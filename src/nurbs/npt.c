@@ -214,6 +214,7 @@ ay_npt_destroy(ay_nurbpatch_object *patch)
   /* free tesselations */
   ay_stess_destroy(&(patch->stess[0]));
   ay_stess_destroy(&(patch->stess[1]));
+  ay_stess_destroylods(&(patch->lods));
 
   /* free breakpoints */
   if(patch->breakv)
@@ -14125,38 +14126,23 @@ ay_npt_getnormal(ay_nurbpatch_object *np, int i, int j,
 /* ay_npt_finduv:
  *  transforms the window coordinates (winX, winY)
  *  to the corresponding parametric values u, v
- *  on the NURBS surface o
- *  This function needs a valid OpenGL rendering context!
- *
- *  XXXX ToDo: use gluPickMatrix() to speed this up
- *
+ *  on the NURBS surface o by casting rays through the
+ *  picked pixel (and, if this misses, its neighbours)
+ *  against the surface
+ *  This function needs the OpenGL rendering context of the view
+ *  (for the projection), but it does not draw or read back pixels.
  */
 int
 ay_npt_finduv(struct Togl *togl, ay_object *o,
 	      double *winXY, double *worldXYZ, double *u, double *v)
 {
  int ay_status = AY_OK;
- /*  int width = Togl_Width(togl);*/
  int height = Togl_Height(togl);
- GLint viewport[4];
- GLdouble modelMatrix[16], projMatrix[16], winx, winy;
- GLfloat winz = 0.0f;
- double m[16];
- GLfloat pixel1[3] = {0.9f,0.9f,0.9f}, pixel[3] = {0.0f,0.0f,0.0f};
- ay_nurbpatch_object *np = NULL;
  int dx[25] = {0,1,1,0,-1,-1,-1,0,1, 2,2,2,1,0,-1,-2,-2,-2,-2,-2,-1,0,1,2,2};
  int dy[25] = {0,0,-1,-1,-1,0,1,1,1, 0,-1,-2,-2,-2,-2,-2,-1,0,1,2,2,2,2,2,1};
- int found, i = 0, j = 0, k = 0, /*maxtry = 1000,*/ stride;
- int usamples = 10, vsamples = 10;
- int starti = 0, endi = 0;
- int startj = 0, endj = 0;
- double point[4] = {0}/*, guess = 0.0, e1 = 0.05, e2 = 0.05*/;
- double distance = 0.0, min_distance = 0.0;
- double *cp = NULL, *p = NULL;
- double U[10/* XXXX usamples! */] = {0}, startu, endu;
- double V[10/* XXXX vsamples! */] = {0}, startv, endv;
- ay_voidfp *arr = NULL;
- ay_drawcb *cb = NULL;
+ int i, found = AY_FALSE;
+ double m[16], ro[3], rd[3], uv[2], point[3], winx = 0.0, winy = 0.0;
+ ay_rcast_bvh *bvh = NULL;
 
   if(!o)
     return AY_ENULL;
@@ -14164,206 +14150,44 @@ ay_npt_finduv(struct Togl *togl, ay_object *o,
   if(o->type != AY_IDNPATCH)
     return AY_EWTYPE;
 
-  np = (ay_nurbpatch_object *)o->refine;
-
-  /* shade the selected object without lighting as we are mostly
-     interested in the corresponding Z-Buffer values */
-  arr = ay_shadecbt.arr;
-  cb = (ay_drawcb *)(arr[o->type]);
-
-  glClear(GL_DEPTH_BUFFER_BIT);
-  glDisable(GL_LIGHTING);
-  /* set color for selected objects */
-  glColor3f((GLfloat)ay_prefs.ser, (GLfloat)ay_prefs.seg,
-	    (GLfloat)ay_prefs.seb);
-
-  glMatrixMode(GL_MODELVIEW);
-  glPushMatrix();
-   if(ay_currentlevel->object != ay_root)
-     ay_trafo_concatparent(ay_currentlevel->next);
-
-   glTranslated(o->movx, o->movy, o->movz);
-   ay_quat_torotmatrix(o->quat, m);
-   glMultMatrixd(m);
-   glScaled(o->scalx, o->scaly, o->scalz);
-
-   if(cb)
-     ay_status = cb(togl, o);
-
-   glGetDoublev(GL_MODELVIEW_MATRIX, modelMatrix);
-  glPopMatrix();
-
-  glEnable(GL_LIGHTING);
-
-  pixel1[0] = (float)ay_prefs.ser;
-  pixel1[1] = (float)ay_prefs.seg;
-  pixel1[2] = (float)ay_prefs.seb;
-
-  /*
-  winx = winX;
-  winy = height - winY;
-  */
+  ay_status = ay_rcast_create(o, &bvh);
+  if(ay_status)
+    return ay_status;
 
-  /*
-   * first, we try to find a point on the surface in window coordinates;
-   * we do this by comparing colors of rendered pixels
-   */
-  found = AY_FALSE;
-  while(!found)
+  for(i = 0; i < 25; i++)
     {
       winx = winXY[0] + dx[i];
-      winy = height - winXY[1] - dy[i];
-      i++;
+      winy = winXY[1] + dy[i];
 
-      if(i > 24)
-	{
-	  return AY_ERROR;
-	}
+      ay_viewt_wintoray(togl, o, winx, winy, ro, rd);
 
-      glReadPixels((GLint)winx, (GLint)winy, 1, 1,
-		   GL_RGB, GL_FLOAT, &pixel);
-
-      if((pixel1[0] <= pixel[0]) &&
-	 (pixel1[1] <= pixel[1]) &&
-	 (pixel1[2] <= pixel[2]))
+      if(ay_rcast_intersect(bvh, ro, rd, NULL, uv, point, NULL))
 	{
 	  found = AY_TRUE;
+	  break;
 	}
     }
 
-  /* get object coordinates of point on surface */
-  glGetIntegerv(GL_VIEWPORT, viewport);
-
-  glGetDoublev(GL_PROJECTION_MATRIX, projMatrix);
-
-  /* get Z-Buffer value of picked point (winz) */
-  glReadPixels((GLint)winx, (GLint)winy, 1, 1,
-	       GL_DEPTH_COMPONENT, GL_FLOAT, &winz);
+  ay_rcast_destroy(bvh);
 
-  gluUnProject(winx, winy, (GLdouble)winz, modelMatrix, projMatrix, viewport,
-	       &(point[0]), &(point[1]), &(point[2]));
-
-  /* in 7 iterations, search for matching parametric values of <point> */
-  stride = 4;
-  if(!(cp = malloc(usamples*vsamples*stride*sizeof(double))))
-    return AY_EOMEM;
-
-  startu = np->uknotv[np->uorder-1];
-  endu = np->uknotv[np->width];
-
-  startv = np->vknotv[np->vorder-1];
-  endv = np->vknotv[np->height];
-
-  for(k = 0; k < 7; k++)
-    {
-      U[0] = startu;
-      for(i = 1; i < usamples-1; i++)
-	{
-	  U[i] = U[i-1] + (endu - startu) / (usamples-1);
-	}
-      U[usamples-1] = endu;
-
-      V[0] = startv;
-      for(i = 1; i < vsamples-1; i++)
-	{
-	  V[i] = V[i-1] + (endv - startv) / (vsamples-1);
-	}
-      V[vsamples-1] = endv;
-      p = cp;
-      for(i = 0; i < usamples-1; i++)
-       {
-	 for(j = 0; j < vsamples-1; j++)
-	   {
-	     (void)ay_nb_SurfacePoint4D(np->width-1, np->height-1,
-					np->uorder-1, np->vorder-1,
-					np->uknotv, np->vknotv,
-					np->controlv,
-					U[i]+((U[i+1]-U[i])/2.0),
-					V[j]+((V[j+1]-V[j])/2.0),
-					p);
-	     p += stride;
-	   } /* for */
-       } /* for */
-
-      min_distance = DBL_MAX;
-      p = cp;
-      for(i = 0; i < (usamples-1); i++)
-	{
-	 for(j = 0; j < (vsamples-1); j++)
-	   {
-	     distance = AY_VLEN((point[0] - p[0]),
-				(point[1] - p[1]),
-				(point[2] - p[2]));
-
-	     if(distance < min_distance)
-	       {
-		 *u = U[i]+((U[i+1]-U[i])/2.0);
-		 starti = i-1;
-		 endi = i+1;
-		 *v = V[i]+((V[i+1]-V[i])/2.0);
-		 startj = j-1;
-		 endj = j+1;
-		 min_distance = distance;
-	       }
-
-	     p += stride;
-	   } /* for */
-	} /* for */
-
-      if(starti < 0)
-	{
-	  startu = U[0];
-	}
-      else
-	{
-	  startu = U[starti];
-	}
-
-      if(endi >= usamples)
-	{
-	  endu = U[usamples-1];
-	}
-      else
-	{
-	  endu = U[endi];
-	}
-
-      if(startj < 0)
-	{
-	  startv = V[0];
-	}
-      else
-	{
-	  startv = V[startj];
-	}
-
-      if(endj >= vsamples)
-	{
-	  endv = V[vsamples-1];
-	}
-      else
-	{
-	  endv = V[endj];
-	}
-    } /* for */
+  if(!found)
+    return AY_ERROR;
 
   /* compile/return results */
-  winXY[0] = winx;
-  winXY[1] = winy;
+  *u = uv[0];
+  *v = uv[1];
 
-  (void)ay_nb_SurfacePoint4D(np->width-1, np->height-1,
-			     np->uorder-1, np->vorder-1,
-			     np->uknotv, np->vknotv,
-			     np->controlv, *u, *v, point);
+  winXY[0] = winx;
+  winXY[1] = height - winy;
 
-  ay_trafo_apply3(point, modelMatrix);
+  ay_trafo_identitymatrix(m);
+  ay_trafo_getall(ay_currentlevel, o, m);
+  ay_trafo_apply3(point, m);
 
   worldXYZ[0] = point[0];
   worldXYZ[1] = point[1];
   worldXYZ[2] = point[2];
 
-  free(cp);
-
  return ay_status;
 } /* ay_npt_finduv */
 
@@ -14616,11 +14440,7 @@ ay_npt_finduvcb(struct Togl *togl, int argc, char *argv[])
 	{
 	  /* knot picking failed, infer parametric values from surface point */
 	  if(!(ay_status = ay_npt_finduv(togl, o, winXY, worldXYZ, &u, &v)))
-	    {
-	      if(fabs(worldXYZ[0] - obj[0]) < 3.0 &&
-		 fabs(worldXYZ[1] - obj[1]) < 3.0)
-		success = AY_TRUE;
-	    }
+	    success = AY_TRUE;
 	}
 
       if(success)
@@ -14641,11 +14461,6 @@ ay_npt_finduvcb(struct Togl *togl, int argc, char *argv[])
 	  if(!silence)
 	    Tcl_Eval(interp, cmd);
 	}
-      else
-	{
-	  /* need to repair the "damage" done by ay_npt_finduv() above */
-	  ay_toglcb_display(togl);
-	}
 
       ay_pact_clearpointedit(&pe);
 
@@ -17556,6 +17371,16 @@ ay_npt_fair(ay_nurbpatch_object *np, ay_point *selp, double tol,
  int a, b, i, j, stride = 4;
  ay_nurbcurve_object nc = {0};
  ay_point *nselp = NULL, *p = NULL;
+ ay_selpset set = {0};
+
+  /* map the selected points to control point positions once */
+  if(selp && (mode == 0 || mode == 1))
+    {
+      ay_status = ay_selp_setfromarr(selp, np->controlv,
+				     np->width*np->height, stride, &set);
+      if(ay_status)
+	return ay_status;
+    }
 
   switch(mode)
     {
@@ -17566,7 +17391,10 @@ ay_npt_fair(ay_nurbpatch_object *np, ay_point *selp, double tol,
       nc.knot_type = np->uknot_type;
       cv = malloc(nc.length*stride*sizeof(double));
       if(!cv)
-	return AY_EOMEM;
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
       nc.controlv = cv;
       for(j = 0; j < np->height; j++)
 	{
@@ -17576,7 +17404,7 @@ ay_npt_fair(ay_nurbpatch_object *np, ay_point *selp, double tol,
 	    {
 	      memcpy(&(cv[a]), &(np->controlv[b]), stride*sizeof(double));
 
-	      if(ay_selp_find(selp, &(np->controlv[b])))
+	      if(AY_SELPSETHAS(&set, (unsigned int)(b/stride)))
 		{
 		  p = calloc(1, sizeof(ay_point));
 		  if(!p)
@@ -17635,7 +17463,10 @@ clearnselp0:
       nc.knot_type = np->vknot_type;
       cv = malloc(nc.length*stride*sizeof(double));
       if(!cv)
-	return AY_EOMEM;
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
       nc.controlv = cv;
       for(j = 0; j < np->width; j++)
 	{
@@ -17645,7 +17476,7 @@ clearnselp0:
 	    {
 	      memcpy(&(cv[a]), &(np->controlv[b]), stride*sizeof(double));
 
-	      if(ay_selp_find(selp, &(np->controlv[b])))
+	      if(AY_SELPSETHAS(&set, (unsigned int)(b/stride)))
 		{
 		  p = calloc(1, sizeof(ay_point));
 		  if(!p)
@@ -17722,6 +17553,8 @@ cleanup:
   if(nc.controlv)
     free(nc.controlv);
 
+  ay_selp_setfree(&set);
+
  return ay_status;
 } /* ay_npt_fair */
 
@@ -0,0 +1,1000 @@
+/*
+ * Ayam, a free 3D modeler for the RenderMan interface.
+ *
+ * Ayam is copyrighted 1998-2024 by Randolf Schultz
+ * (randolf.schultz@gmail.com) and others.
+ *
+ * All rights reserved.
+ *
+ * See the file License for details.
+ *
+ */
+
+#include "ayam.h"
+
+/* rcast.c - ray casting against NURBS patches */
+
+/* local preprocessor definitions: */
+
+/** minimum number of leaf nodes in each parametric dimension */
+#define AY_RCASTMINSPANS 8
+
+/** maximum number of Newton iterations per leaf node */
+#define AY_RCASTMAXITER 16
+
+/** maximum depth of the hierarchy traversal stack */
+#define AY_RCASTMAXDEPTH 64
+
+/* prototypes of functions local to this module: */
+
+int ay_rcast_getspans(double *knotv, int len, int order, int *nspans,
+		      double **spans);
+
+int ay_rcast_getinsert(double *knotv, int len, int order, int nspans,
+		       double *spans, int *nins, double **ins);
+
+void ay_rcast_getbounds(ay_nurbpatch_object *np, double *uv, double *bb);
+
+int ay_rcast_build(ay_rcast_bvh *bvh, int *n, int i0, int i1, int j0, int j1,
+		   int nv, ay_rcast_node *leaves);
+
+int ay_rcast_hitbox(double *bb, double *ro, double *rd, double tmax);
+
+int ay_rcast_hittri(double *p0, double *p1, double *p2, double *ro,
+		    double *rd, double *b);
+
+void ay_rcast_evaluate(ay_nurbpatch_object *np, double u, double v,
+		       double *C);
+
+int ay_rcast_newton(ay_rcast_bvh *bvh, ay_rcast_node *leaf, double *pl,
+		    double *uv, double *C);
+
+int ay_rcast_hitleaf(ay_rcast_bvh *bvh, ay_rcast_node *leaf, double *ro,
+		     double *rd, double *pl, double *t, double *uv, double *C);
+
+int ay_rcast_istrimmed(ay_rcast_bvh *bvh, double u, double v);
+
+
+/* functions: */
+
+/** ay_rcast_getspans:
+ *  get the parametric values delimiting the leaf nodes in one
+ *  dimension; knot spans are split evenly until there are at
+ *  least AY_RCASTMINSPANS spans
+ *
+ * \param[in] knotv  knot vector
+ * \param[in] len  number of control points
+ * \param[in] order  order
+ * \param[in,out] nspans  where to store the number of spans
+ * \param[in,out] spans  where to store the span delimiters [nspans+1]
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_rcast_getspans(double *knotv, int len, int order, int *nspans,
+		  double **spans)
+{
+ double *s;
+ int i, j, k, n = 0, split;
+
+  for(i = order-1; i < len; i++)
+    {
+      if(knotv[i] < knotv[i+1])
+	n++;
+    }
+
+  if(n <= 0)
+    return AY_ERROR;
+
+  split = (AY_RCASTMINSPANS+n-1)/n;
+
+  if(!(s = malloc((n*split+1)*sizeof(double))))
+    return AY_EOMEM;
+
+  k = 0;
+  for(i = order-1; i < len; i++)
+    {
+      if(knotv[i] < knotv[i+1])
+	{
+	  for(j = 0; j < split; j++)
+	    {
+	      s[k] = knotv[i]+(knotv[i+1]-knotv[i])*j/split;
+	      k++;
+	    }
+	}
+    }
+  s[k] = knotv[len];
+
+  *nspans = k;
+  *spans = s;
+
+ return AY_OK;
+} /* ay_rcast_getspans */
+
+
+/** ay_rcast_getinsert:
+ *  get the knots to insert so that all interior span delimiters
+ *  reach full multiplicity, which turns every span into a Bezier
+ *  segment with tight bounds
+ *
+ * \param[in] knotv  knot vector
+ * \param[in] len  number of control points
+ * \param[in] order  order
+ * \param[in] nspans  number of spans
+ * \param[in] spans  span delimiters [nspans+1]
+ * \param[in,out] nins  where to store the number of knots to insert
+ * \param[in,out] ins  where to store the knots to insert [nins]
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_rcast_getinsert(double *knotv, int len, int order, int nspans,
+		   double *spans, int *nins, double **ins)
+{
+ double *X;
+ int i, j, k, s, p = order-1;
+
+  *nins = 0;
+  *ins = NULL;
+
+  if(nspans < 2 || p < 1)
+    return AY_OK;
+
+  if(!(X = malloc((nspans-1)*p*sizeof(double))))
+    return AY_EOMEM;
+
+  k = 0;
+  for(i = 1; i < nspans; i++)
+    {
+      s = 0;
+      for(j = 0; j < len+order; j++)
+	{
+	  if(knotv[j] == spans[i])
+	    s++;
+	}
+      for(j = s; j < p; j++)
+	{
+	  X[k] = spans[i];
+	  k++;
+	}
+    }
+
+  if(k > 0)
+    {
+      *nins = k;
+      *ins = X;
+    }
+  else
+    {
+      free(X);
+    }
+
+ return AY_OK;
+} /* ay_rcast_getinsert */
+
+
+/** ay_rcast_getbounds:
+ *  calculate the bounding box of a span of a NURBS patch from the
+ *  control points that influence it (convex hull property)
+ *
+ * \param[in] np  (refined) NURBS patch
+ * \param[in] uv  parametric range of the span (umin, umax, vmin, vmax)
+ * \param[in,out] bb  where to store the bounds [6]
+ */
+void
+ay_rcast_getbounds(ay_nurbpatch_object *np, double *uv, double *bb)
+{
+ int i, j, a, uspan, vspan, p = np->uorder-1, q = np->vorder-1;
+ double *cv;
+
+  uspan = ay_nb_FindSpan(np->width-1, p, (uv[0]+uv[1])*0.5, np->uknotv);
+  vspan = ay_nb_FindSpan(np->height-1, q, (uv[2]+uv[3])*0.5, np->vknotv);
+
+  bb[0] = bb[1] = bb[2] = DBL_MAX;
+  bb[3] = bb[4] = bb[5] = -DBL_MAX;
+
+  for(i = uspan-p; i <= uspan; i++)
+    {
+      for(j = vspan-q; j <= vspan; j++)
+	{
+	  cv = &(np->controlv[(i*np->height+j)*4]);
+	  for(a = 0; a < 3; a++)
+	    {
+	      if(cv[a] < bb[a])
+		bb[a] = cv[a];
+	      if(cv[a] > bb[a+3])
+		bb[a+3] = cv[a];
+	    }
+	}
+    }
+
+ return;
+} /* ay_rcast_getbounds */
+
+
+/** ay_rcast_build:
+ *  recursively build the hierarchy over the leaf nodes in the
+ *  index range [i0, i1[ x [j0, j1[ by splitting the longer side
+ *
+ * \param[in,out] bvh  hierarchy to fill
+ * \param[in,out] n  number of nodes used so far
+ * \param[in] i0  first leaf index in U direction
+ * \param[in] i1  last leaf index + 1 in U direction
+ * \param[in] j0  first leaf index in V direction
+ * \param[in] j1  last leaf index + 1 in V direction
+ * \param[in] nv  number of leaf nodes in V direction
+ * \param[in] leaves  all leaf nodes
+ *
+ * \returns index of the new node
+ */
+int
+ay_rcast_build(ay_rcast_bvh *bvh, int *n, int i0, int i1, int j0, int j1,
+	       int nv, ay_rcast_node *leaves)
+{
+ ay_rcast_node *node, *l, *r;
+ int a, index = *n;
+
+  node = &(bvh->nodes[index]);
+  (*n)++;
+
+  if(i1-i0 == 1 && j1-j0 == 1)
+    {
+      memcpy(node, &(leaves[i0*nv+j0]), sizeof(ay_rcast_node));
+      node->left = -1;
+      node->right = -1;
+      return index;
+    }
+
+  if(i1-i0 >= j1-j0)
+    {
+      node->left = ay_rcast_build(bvh, n, i0, (i0+i1)/2, j0, j1, nv, leaves);
+      node->right = ay_rcast_build(bvh, n, (i0+i1)/2, i1, j0, j1, nv, leaves);
+    }
+  else
+    {
+      node->left = ay_rcast_build(bvh, n, i0, i1, j0, (j0+j1)/2, nv, leaves);
+      node->right = ay_rcast_build(bvh, n, i0, i1, (j0+j1)/2, j1, nv, leaves);
+    }
+
+  node = &(bvh->nodes[index]);
+  l = &(bvh->nodes[node->left]);
+  r = &(bvh->nodes[node->right]);
+
+  for(a = 0; a < 3; a++)
+    {
+      node->bb[a] = (l->bb[a] < r->bb[a])?l->bb[a]:r->bb[a];
+      node->bb[a+3] = (l->bb[a+3] > r->bb[a+3])?l->bb[a+3]:r->bb[a+3];
+    }
+
+  node->uv[0] = (l->uv[0] < r->uv[0])?l->uv[0]:r->uv[0];
+  node->uv[1] = (l->uv[1] > r->uv[1])?l->uv[1]:r->uv[1];
+  node->uv[2] = (l->uv[2] < r->uv[2])?l->uv[2]:r->uv[2];
+  node->uv[3] = (l->uv[3] > r->uv[3])?l->uv[3]:r->uv[3];
+
+ return index;
+} /* ay_rcast_build */
+
+
+/** ay_rcast_create:
+ *  create a bounding volume hierarchy for ray casting against a
+ *  NURBS patch; the patch is refined to Bezier segments (which are
+ *  split further if there are just a few of them) whose control
+ *  points deliver the bounds of the leaf nodes;
+ *  trim curves of the patch object are tesselated, so that hits
+ *  in trimmed regions can be rejected
+ *
+ * \param[in] o  NURBS patch object (may have trim curves)
+ * \param[in,out] result  where to store the new hierarchy
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_rcast_create(ay_object *o, ay_rcast_bvh **result)
+{
+ int ay_status = AY_OK;
+ ay_nurbpatch_object *np, *rp = NULL;
+ ay_rcast_bvh *bvh = NULL;
+ ay_rcast_node *leaves = NULL, *leaf;
+ double *us = NULL, *vs = NULL, *X = NULL, *grid = NULL, *pt, *tp;
+ double diag, area, maxarea = 0.0, bb[4], d[3], gst;
+ int i, j, k, nu = 0, nv = 0, nx = 0, n = 0, qf, maxloop = -1;
+
+  if(!o || !result)
+    return AY_ENULL;
+
+  if(o->type != AY_IDNPATCH)
+    return AY_EWTYPE;
+
+  np = (ay_nurbpatch_object *)o->refine;
+
+  if(!(bvh = calloc(1, sizeof(ay_rcast_bvh))))
+    return AY_EOMEM;
+
+  bvh->np = np;
+
+  ay_status = ay_rcast_getspans(np->uknotv, np->width, np->uorder, &nu, &us);
+  if(ay_status)
+    goto cleanup;
+  ay_status = ay_rcast_getspans(np->vknotv, np->height, np->vorder, &nv, &vs);
+  if(ay_status)
+    goto cleanup;
+
+  /* refine a copy of the patch to Bezier segments */
+  if(!(rp = calloc(1, sizeof(ay_nurbpatch_object))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  rp->width = np->width;
+  rp->height = np->height;
+  rp->uorder = np->uorder;
+  rp->vorder = np->vorder;
+  rp->uknot_type = AY_KTCUSTOM;
+  rp->vknot_type = AY_KTCUSTOM;
+  rp->is_rat = np->is_rat;
+
+  if(!(rp->controlv = malloc(np->width*np->height*4*sizeof(double))) ||
+     !(rp->uknotv = malloc((np->width+np->uorder)*sizeof(double))) ||
+     !(rp->vknotv = malloc((np->height+np->vorder)*sizeof(double))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  memcpy(rp->controlv, np->controlv, np->width*np->height*4*sizeof(double));
+  memcpy(rp->uknotv, np->uknotv, (np->width+np->uorder)*sizeof(double));
+  memcpy(rp->vknotv, np->vknotv, (np->height+np->vorder)*sizeof(double));
+
+  ay_status = ay_rcast_getinsert(rp->uknotv, rp->width, rp->uorder, nu, us,
+				 &nx, &X);
+  if(ay_status)
+    goto cleanup;
+  if(X)
+    {
+      ay_status = ay_npt_refineu(rp, X, nx);
+      free(X);
+      X = NULL;
+      if(ay_status)
+	goto cleanup;
+    }
+
+  ay_status = ay_rcast_getinsert(rp->vknotv, rp->height, rp->vorder, nv, vs,
+				 &nx, &X);
+  if(ay_status)
+    goto cleanup;
+  if(X)
+    {
+      ay_status = ay_npt_refinev(rp, X, nx);
+      free(X);
+      X = NULL;
+      if(ay_status)
+	goto cleanup;
+    }
+
+  /* evaluate the patch at the corners of all spans */
+  if(!(grid = malloc((nu+1)*(nv+1)*3*sizeof(double))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  pt = grid;
+  for(i = 0; i <= nu; i++)
+    {
+      for(j = 0; j <= nv; j++)
+	{
+	  ay_status = ay_nb_SurfacePoint4D(np->width-1, np->height-1,
+					   np->uorder-1, np->vorder-1,
+					   np->uknotv, np->vknotv,
+					   np->controlv, us[i], vs[j], pt);
+	  if(ay_status)
+	    goto cleanup;
+	  pt += 3;
+	}
+    }
+
+  /* create the leaf nodes */
+  if(!(leaves = calloc(nu*nv, sizeof(ay_rcast_node))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  for(i = 0; i < nu; i++)
+    {
+      for(j = 0; j < nv; j++)
+	{
+	  leaf = &(leaves[i*nv+j]);
+	  leaf->uv[0] = us[i];
+	  leaf->uv[1] = us[i+1];
+	  leaf->uv[2] = vs[j];
+	  leaf->uv[3] = vs[j+1];
+	  ay_rcast_getbounds(rp, leaf->uv, leaf->bb);
+	  memcpy(&(leaf->guess[0]), &(grid[(i*(nv+1)+j)*3]),
+		 3*sizeof(double));
+	  memcpy(&(leaf->guess[3]), &(grid[((i+1)*(nv+1)+j)*3]),
+		 3*sizeof(double));
+	  memcpy(&(leaf->guess[6]), &(grid[((i+1)*(nv+1)+j+1)*3]),
+		 3*sizeof(double));
+	  memcpy(&(leaf->guess[9]), &(grid[(i*(nv+1)+j+1)*3]),
+		 3*sizeof(double));
+	}
+    }
+
+  /* build the hierarchy */
+  if(!(bvh->nodes = calloc(2*nu*nv-1, sizeof(ay_rcast_node))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  (void)ay_rcast_build(bvh, &n, 0, nu, 0, nv, nv, leaves);
+  bvh->nnodes = n;
+
+  /* derive the tolerance from the size of the patch and pad the
+     bounds, so that planar patches still have some volume */
+  for(k = 0; k < 3; k++)
+    d[k] = bvh->nodes[0].bb[k+3] - bvh->nodes[0].bb[k];
+  diag = AY_V3LEN(d);
+  if(diag < AY_EPSILON)
+    diag = AY_EPSILON;
+  bvh->tol = diag*1.0e-09;
+
+  for(i = 0; i < n; i++)
+    {
+      for(k = 0; k < 3; k++)
+	{
+	  bvh->nodes[i].bb[k] -= diag*1.0e-06;
+	  bvh->nodes[i].bb[k+3] += diag*1.0e-06;
+	}
+    }
+
+  /* tesselate the trim curves */
+  if(o->down && o->down->next)
+    {
+      gst = np->glu_sampling_tolerance;
+      if(gst <= 0.0)
+	gst = ay_prefs.glu_sampling_tolerance;
+      qf = ay_stess_GetQF(gst);
+
+      ay_status = ay_stess_TessTrimCurves(o, qf, &bvh->tcslen, &bvh->tcs,
+					  &bvh->tcslens, NULL);
+      if(ay_status)
+	goto cleanup;
+
+      /* if the outermost loop is a hole (oriented clockwise),
+	 the patch boundary acts as outer loop */
+      for(i = 0; i < bvh->tcslen; i++)
+	{
+	  if(!bvh->tcs[i] || bvh->tcslens[i] < 3)
+	    continue;
+	  tp = bvh->tcs[i];
+	  bb[0] = bb[2] = DBL_MAX;
+	  bb[1] = bb[3] = -DBL_MAX;
+	  for(j = 0; j < bvh->tcslens[i]; j++)
+	    {
+	      if(tp[j*2] < bb[0])
+		bb[0] = tp[j*2];
+	      if(tp[j*2] > bb[1])
+		bb[1] = tp[j*2];
+	      if(tp[j*2+1] < bb[2])
+		bb[2] = tp[j*2+1];
+	      if(tp[j*2+1] > bb[3])
+		bb[3] = tp[j*2+1];
+	    }
+	  area = (bb[1]-bb[0])*(bb[3]-bb[2]);
+	  if(area > maxarea)
+	    {
+	      maxarea = area;
+	      maxloop = i;
+	    }
+	}
+
+      if(maxloop >= 0)
+	{
+	  tp = bvh->tcs[maxloop];
+	  area = 0.0;
+	  for(j = 0; j < bvh->tcslens[maxloop]; j++)
+	    {
+	      k = (j+1)%bvh->tcslens[maxloop];
+	      area += tp[j*2]*tp[k*2+1] - tp[k*2]*tp[j*2+1];
+	    }
+	  if(area < 0.0)
+	    bvh->outer = 1;
+	}
+    } /* if trimmed */
+
+  /* return result */
+  *result = bvh;
+  bvh = NULL;
+
+cleanup:
+
+  if(bvh)
+    ay_rcast_destroy(bvh);
+  if(rp)
+    ay_npt_destroy(rp);
+  if(us)
+    free(us);
+  if(vs)
+    free(vs);
+  if(grid)
+    free(grid);
+  if(leaves)
+    free(leaves);
+
+ return ay_status;
+} /* ay_rcast_create */
+
+
+/** ay_rcast_destroy:
+ *  free a bounding volume hierarchy
+ *
+ * \param[in,out] bvh  hierarchy to free
+ */
+void
+ay_rcast_destroy(ay_rcast_bvh *bvh)
+{
+ int i;
+
+  if(!bvh)
+    return;
+
+  if(bvh->nodes)
+    free(bvh->nodes);
+
+  if(bvh->tcs)
+    {
+      for(i = 0; i < bvh->tcslen; i++)
+	{
+	  if(bvh->tcs[i])
+	    free(bvh->tcs[i]);
+	}
+      free(bvh->tcs);
+    }
+
+  if(bvh->tcslens)
+    free(bvh->tcslens);
+
+  free(bvh);
+
+ return;
+} /* ay_rcast_destroy */
+
+
+/** ay_rcast_hitbox:
+ *  check whether a ray hits a bounding box (slab test)
+ *
+ * \param[in] bb  bounds (xmin, ymin, zmin, xmax, ymax, zmax)
+ * \param[in] ro  ray origin
+ * \param[in] rd  ray direction
+ * \param[in] tmax  maximum ray parameter of interest
+ *
+ * \returns AY_TRUE if the box is hit
+ */
+int
+ay_rcast_hitbox(double *bb, double *ro, double *rd, double tmax)
+{
+ double t0 = 0.0, t1 = tmax, ta, tb, tt;
+ int a;
+
+  for(a = 0; a < 3; a++)
+    {
+      if(fabs(rd[a]) < DBL_MIN)
+	{
+	  if(ro[a] < bb[a] || ro[a] > bb[a+3])
+	    return AY_FALSE;
+	}
+      else
+	{
+	  ta = (bb[a]-ro[a])/rd[a];
+	  tb = (bb[a+3]-ro[a])/rd[a];
+	  if(ta > tb)
+	    {
+	      tt = ta;
+	      ta = tb;
+	      tb = tt;
+	    }
+	  if(ta > t0)
+	    t0 = ta;
+	  if(tb < t1)
+	    t1 = tb;
+	  if(t0 > t1)
+	    return AY_FALSE;
+	}
+    }
+
+ return AY_TRUE;
+} /* ay_rcast_hitbox */
+
+
+/** ay_rcast_hittri:
+ *  intersect a ray with a triangle
+ *
+ * \param[in] p0  first corner
+ * \param[in] p1  second corner
+ * \param[in] p2  third corner
+ * \param[in] ro  ray origin
+ * \param[in] rd  ray direction
+ * \param[in,out] b  where to store the barycentric coordinates
+ *  of the hit relative to p1 and p2 [2]
+ *
+ * \returns AY_TRUE if the triangle is hit
+ */
+int
+ay_rcast_hittri(double *p0, double *p1, double *p2, double *ro,
+		double *rd, double *b)
+{
+ double e1[3], e2[3], s[3], pv[3], qv[3], det;
+
+  AY_V3SUB(e1, p1, p0);
+  AY_V3SUB(e2, p2, p0);
+  AY_V3CROSS(pv, rd, e2);
+  det = AY_V3DOT(e1, pv);
+
+  if(fabs(det) < DBL_MIN)
+    return AY_FALSE;
+
+  AY_V3SUB(s, ro, p0);
+  b[0] = AY_V3DOT(s, pv)/det;
+  if(b[0] < 0.0 || b[0] > 1.0)
+    return AY_FALSE;
+
+  AY_V3CROSS(qv, s, e1);
+  b[1] = AY_V3DOT(rd, qv)/det;
+  if(b[1] < 0.0 || b[0]+b[1] > 1.0)
+    return AY_FALSE;
+
+ return AY_TRUE;
+} /* ay_rcast_hittri */
+
+
+/** ay_rcast_evaluate:
+ *  evaluate a NURBS patch and its first derivatives
+ *
+ * \param[in] np  NURBS patch
+ * \param[in] u  parametric value in U direction
+ * \param[in] v  parametric value in V direction
+ * \param[in,out] C  where to store point, derivative along V and
+ *  derivative along U [12]
+ */
+void
+ay_rcast_evaluate(ay_nurbpatch_object *np, double u, double v, double *C)
+{
+
+  if(np->is_rat)
+    ay_nb_FirstDerSurf4D(np->width-1, np->height-1,
+			 np->uorder-1, np->vorder-1,
+			 np->uknotv, np->vknotv, np->controlv,
+			 u, v, C);
+  else
+    ay_nb_FirstDerSurf3D(np->width-1, np->height-1,
+			 np->uorder-1, np->vorder-1,
+			 np->uknotv, np->vknotv, np->controlv,
+			 u, v, C);
+
+ return;
+} /* ay_rcast_evaluate */
+
+
+/** ay_rcast_newton:
+ *  find the intersection of a ray with the part of a NURBS patch
+ *  covered by a leaf node using Newton iteration; the ray is
+ *  represented as intersection of two planes
+ *
+ * \param[in] bvh  hierarchy
+ * \param[in] leaf  leaf node
+ * \param[in] pl  the two planes (normal and distance each) [8]
+ * \param[in,out] uv  starting values, where to store the parametric
+ *  values of the hit [2]
+ * \param[in,out] C  where to store the hit point and derivatives [12]
+ *
+ * \returns AY_TRUE if the iteration converged inside the leaf node
+ */
+int
+ay_rcast_newton(ay_rcast_bvh *bvh, ay_rcast_node *leaf, double *pl,
+		double *uv, double *C)
+{
+ ay_nurbpatch_object *np = bvh->np;
+ double f1, f2, j11, j12, j21, j22, det;
+ double du, dv, umin, umax, vmin, vmax;
+ double u = uv[0], v = uv[1], *su = &(C[6]), *sv = &(C[3]);
+ double *n1 = pl, *n2 = &(pl[4]);
+ int i;
+
+  du = leaf->uv[1]-leaf->uv[0];
+  dv = leaf->uv[3]-leaf->uv[2];
+
+  /* the iteration may leave the leaf a bit */
+  umin = leaf->uv[0] - du*0.5;
+  if(umin < np->uknotv[np->uorder-1])
+    umin = np->uknotv[np->uorder-1];
+  umax = leaf->uv[1] + du*0.5;
+  if(umax > np->uknotv[np->width])
+    umax = np->uknotv[np->width];
+  vmin = leaf->uv[2] - dv*0.5;
+  if(vmin < np->vknotv[np->vorder-1])
+    vmin = np->vknotv[np->vorder-1];
+  vmax = leaf->uv[3] + dv*0.5;
+  if(vmax > np->vknotv[np->height])
+    vmax = np->vknotv[np->height];
+
+  for(i = 0; i < AY_RCASTMAXITER; i++)
+    {
+      ay_rcast_evaluate(np, u, v, C);
+
+      f1 = AY_V3DOT(n1, C) + pl[3];
+      f2 = AY_V3DOT(n2, C) + pl[7];
+
+      if(fabs(f1) < bvh->tol && fabs(f2) < bvh->tol)
+	{
+	  /* converged, check the leaf range */
+	  if(u < leaf->uv[0] - du*AY_EPSILON ||
+	     u > leaf->uv[1] + du*AY_EPSILON ||
+	     v < leaf->uv[2] - dv*AY_EPSILON ||
+	     v > leaf->uv[3] + dv*AY_EPSILON)
+	    return AY_FALSE;
+
+	  uv[0] = u;
+	  uv[1] = v;
+	  return AY_TRUE;
+	}
+
+      j11 = AY_V3DOT(n1, su);
+      j12 = AY_V3DOT(n1, sv);
+      j21 = AY_V3DOT(n2, su);
+      j22 = AY_V3DOT(n2, sv);
+
+      det = j11*j22 - j12*j21;
+      if(fabs(det) < DBL_MIN)
+	return AY_FALSE;
+
+      u -= (j22*f1 - j12*f2)/det;
+      v -= (j11*f2 - j21*f1)/det;
+
+      if(u < umin)
+	u = umin;
+      if(u > umax)
+	u = umax;
+      if(v < vmin)
+	v = vmin;
+      if(v > vmax)
+	v = vmax;
+    } /* for */
+
+ return AY_FALSE;
+} /* ay_rcast_newton */
+
+
+/** ay_rcast_hitleaf:
+ *  find the nearest intersection of a ray with the part of a NURBS
+ *  patch covered by a leaf node; the Newton iteration is started
+ *  from the hits of the ray with the two triangles spanned by the
+ *  corner points and from the center of the leaf, because a ray
+ *  may cross a curved leaf twice
+ *
+ * \param[in] bvh  hierarchy
+ * \param[in] leaf  leaf node
+ * \param[in] ro  ray origin
+ * \param[in] rd  ray direction
+ * \param[in] pl  the ray as intersection of two planes [8]
+ * \param[in,out] t  ray parameter of the nearest hit so far,
+ *  updated if a nearer hit is found
+ * \param[in,out] uv  where to store the parametric values of the hit [2]
+ * \param[in,out] C  where to store the hit point and derivatives [12]
+ *
+ * \returns AY_TRUE if a nearer hit was found
+ */
+int
+ay_rcast_hitleaf(ay_rcast_bvh *bvh, ay_rcast_node *leaf, double *ro,
+		 double *rd, double *pl, double *t, double *uv, double *C)
+{
+ double b[2], *g = leaf->guess, du, dv, st[22], uvc[2], Cc[12], d[3], tc;
+ int i, j, nst = 0, hit = AY_FALSE;
+
+  du = leaf->uv[1]-leaf->uv[0];
+  dv = leaf->uv[3]-leaf->uv[2];
+
+  /* gather starting values */
+  if(ay_rcast_hittri(g, g+3, g+6, ro, rd, b))
+    {
+      st[nst*2] = leaf->uv[0] + (b[0]+b[1])*du;
+      st[nst*2+1] = leaf->uv[2] + b[1]*dv;
+      nst++;
+    }
+  if(ay_rcast_hittri(g, g+6, g+9, ro, rd, b))
+    {
+      st[nst*2] = leaf->uv[0] + b[0]*du;
+      st[nst*2+1] = leaf->uv[2] + (b[0]+b[1])*dv;
+      nst++;
+    }
+  for(i = 0; i < 3; i++)
+    {
+      for(j = 0; j < 3; j++)
+	{
+	  st[nst*2] = leaf->uv[0] + du*(i*2+1)/6.0;
+	  st[nst*2+1] = leaf->uv[2] + dv*(j*2+1)/6.0;
+	  nst++;
+	}
+    }
+
+  for(i = 0; i < nst; i++)
+    {
+      uvc[0] = st[i*2];
+      uvc[1] = st[i*2+1];
+      if(!ay_rcast_newton(bvh, leaf, pl, uvc, Cc))
+	continue;
+
+      AY_V3SUB(d, Cc, ro);
+      tc = AY_V3DOT(d, rd)/AY_V3DOT(rd, rd);
+      if(tc >= 0.0 && tc < *t &&
+	 !ay_rcast_istrimmed(bvh, uvc[0], uvc[1]))
+	{
+	  *t = tc;
+	  memcpy(uv, uvc, 2*sizeof(double));
+	  memcpy(C, Cc, 12*sizeof(double));
+	  hit = AY_TRUE;
+	}
+    }
+
+ return hit;
+} /* ay_rcast_hitleaf */
+
+
+/** ay_rcast_istrimmed:
+ *  check whether a point in parametric space is trimmed away,
+ *  using the winding numbers of all trim loops
+ *
+ * \param[in] bvh  hierarchy with tesselated trim loops
+ * \param[in] u  parametric value in U direction
+ * \param[in] v  parametric value in V direction
+ *
+ * \returns AY_TRUE if the point is trimmed away
+ */
+int
+ay_rcast_istrimmed(ay_rcast_bvh *bvh, double u, double v)
+{
+ int i, j, wn = bvh->outer;
+ double *p0, *p1, side;
+
+  if(!bvh->tcs)
+    return AY_FALSE;
+
+  for(i = 0; i < bvh->tcslen; i++)
+    {
+      if(!bvh->tcs[i] || bvh->tcslens[i] < 3)
+	continue;
+      for(j = 0; j < bvh->tcslens[i]; j++)
+	{
+	  p0 = &(bvh->tcs[i][j*2]);
+	  p1 = &(bvh->tcs[i][((j+1)%bvh->tcslens[i])*2]);
+	  side = (p1[0]-p0[0])*(v-p0[1]) - (u-p0[0])*(p1[1]-p0[1]);
+	  if(p0[1] <= v)
+	    {
+	      if(p1[1] > v && side > 0.0)
+		wn++;
+	    }
+	  else
+	    {
+	      if(p1[1] <= v && side < 0.0)
+		wn--;
+	    }
+	}
+    }
+
+ return (wn > 0)?AY_FALSE:AY_TRUE;
+} /* ay_rcast_istrimmed */
+
+
+/** ay_rcast_intersect:
+ *  find the nearest intersection of a ray with a NURBS patch;
+ *  the ray has to be specified in the object space of the patch
+ *
+ * \param[in] bvh  hierarchy of the patch (from ay_rcast_create())
+ * \param[in] ro  ray origin [3]
+ * \param[in] rd  ray direction [3]
+ * \param[in,out] t  where to store the ray parameter of the hit (may be NULL)
+ * \param[in,out] uv  where to store the parametric values of the hit [2]
+ *  (may be NULL)
+ * \param[in,out] p  where to store the hit point [3] (may be NULL)
+ * \param[in,out] n  where to store the normalized surface normal
+ *  at the hit point [3] (may be NULL)
+ *
+ * \returns AY_TRUE if the ray hits the patch
+ */
+int
+ay_rcast_intersect(ay_rcast_bvh *bvh, double *ro, double *rd,
+		   double *t, double *uv, double *p, double *n)
+{
+ int stack[AY_RCASTMAXDEPTH], sp = 0, hit = AY_FALSE;
+ double tbest = DBL_MAX, Cbest[12], uvbest[2], pl[8], len;
+ double *su = &(Cbest[6]), *sv = &(Cbest[3]), *n2 = &(pl[4]);
+ ay_rcast_node *node;
+
+  if(!bvh || !bvh->nodes || !ro || !rd)
+    return AY_FALSE;
+
+  if(AY_V3DOT(rd, rd) < DBL_MIN)
+    return AY_FALSE;
+
+  /* represent the ray as intersection of two planes */
+  if(fabs(rd[0]) > fabs(rd[1]) && fabs(rd[0]) > fabs(rd[2]))
+    {
+      pl[0] = rd[1];
+      pl[1] = -rd[0];
+      pl[2] = 0.0;
+    }
+  else
+    {
+      pl[0] = 0.0;
+      pl[1] = rd[2];
+      pl[2] = -rd[1];
+    }
+  len = AY_V3LEN(pl);
+  AY_V3SCAL(pl, 1.0/len);
+  AY_V3CROSS(n2, pl, rd);
+  len = AY_V3LEN(n2);
+  AY_V3SCAL(n2, 1.0/len);
+  pl[3] = -AY_V3DOT(pl, ro);
+  pl[7] = -AY_V3DOT(n2, ro);
+
+  stack[sp++] = 0;
+  while(sp > 0)
+    {
+      node = &(bvh->nodes[stack[--sp]]);
+
+      if(!ay_rcast_hitbox(node->bb, ro, rd, tbest))
+	continue;
+
+      if(node->left < 0)
+	{
+	  if(ay_rcast_hitleaf(bvh, node, ro, rd, pl, &tbest, uvbest, Cbest))
+	    hit = AY_TRUE;
+	}
+      else
+	{
+	  if(sp+2 > AY_RCASTMAXDEPTH)
+	    break;
+	  stack[sp++] = node->right;
+	  stack[sp++] = node->left;
+	}
+    } /* while */
+
+  if(!hit)
+    return AY_FALSE;
+
+  if(t)
+    *t = tbest;
+  if(uv)
+    memcpy(uv, uvbest, 2*sizeof(double));
+  if(p)
+    memcpy(p, Cbest, 3*sizeof(double));
+  if(n)
+    {
+      AY_V3CROSS(n, su, sv);
+      len = AY_V3LEN(n);
+      if(len > DBL_MIN)
+	AY_V3SCAL(n, 1.0/len);
+    }
+
+ return AY_TRUE;
+} /* ay_rcast_intersect */
+
+
+/** ay_rcast_intersectobject:
+ *  find the nearest intersection of a ray with a NURBS patch
+ *  object; convenience wrapper that creates and destroys the
+ *  hierarchy, use ay_rcast_create() and ay_rcast_intersect()
+ *  to cast many rays
+ *
+ * \param[in] o  NURBS patch object
+ * \param[in] ro  ray origin in object space [3]
+ * \param[in] rd  ray direction in object space [3]
+ * \param[in,out] uv  where to store the parametric values of the hit [2]
+ * \param[in,out] p  where to store the hit point [3] (may be NULL)
+ *
+ * \returns AY_OK if the ray hits the patch, AY_ERROR if it does not,
+ *  error code otherwise.
+ */
+int
+ay_rcast_intersectobject(ay_object *o, double *ro, double *rd,
+			 double *uv, double *p)
+{
+ int ay_status = AY_OK;
+ ay_rcast_bvh *bvh = NULL;
+
+  ay_status = ay_rcast_create(o, &bvh);
+  if(ay_status)
+    return ay_status;
+
+  if(!ay_rcast_intersect(bvh, ro, rd, NULL, uv, p, NULL))
+    ay_status = AY_ERROR;
+
+  ay_rcast_destroy(bvh);
+
+ return ay_status;
+} /* ay_rcast_intersectobject */
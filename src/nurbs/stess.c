@@ -12,18 +12,54 @@
 
 #include "ayam.h"
 
+#ifndef WIN32
+#include <pthread.h>
+#endif /* !WIN32 */
+
 /* stess.c simple NURB tesselators */
 
 /* local preprocessor definitions: */
 
 /*#define AY_STESSDBG 1*/
 
+/** minimum number of grid points to evaluate in parallel */
+#define AY_STESSMINPARGRID 8192
+
+
+/* local types: */
+
+/** a band of columns of a surface grid to evaluate */
+typedef struct ay_stess_grid_s {
+  int m; /**< number of control points in V direction */
+  int p; /**< degree in U direction */
+  int q; /**< degree in V direction */
+  double *P; /**< control points (homogeneous if rational) [n*m*4] */
+  int is_rat; /**< is the surface rational? */
+  int Cm; /**< number of grid points in V direction */
+  double *Nus; /**< basis functions and derivatives of all columns */
+  double *Nvs; /**< basis functions and derivatives of all rows */
+  int *spanus; /**< spans of all columns */
+  int *spanvs; /**< spans of all rows */
+  double *Q; /**< scratch space for one column [m*4*2] */
+  double *Ct; /**< resulting points and normals [Cn*Cm*6] */
+  int a0; /**< first column of the band */
+  int a1; /**< last column of the band + 1 */
+} ay_stess_grid;
+
+
 
 /* prototypes of functions local to this module: */
 void ay_stess_FindMultiplePoints(int n, int p, double *U, double *P,
 				 int dim, int is_rat, int stride,
 				 int *m, double **V);
 
+void *ay_stess_EvalGridBand(void *data);
+
+int ay_stess_EvalGrid(int n, int m, int p, int q, double *U, double *V,
+		      double *P, int is_rat, int Cn, int Cm,
+		      double ud, double vd, int *spanus, int *spanvs,
+		      double *Ct);
+
 int ay_stess_IntersectLines2D(double *p1, double *p2, double *p3, double *p4,
 			      double *ip);
 
@@ -33,11 +69,27 @@ void ay_stess_TessTrimCurve(ay_object *o, double **tts, int *tls, int *tds,
 void ay_stess_TessLinearTrimCurve(ay_object *o, double **tts, int *tls,
 				  int *tds, int *i);
 
-int ay_stess_MergeUVectors(ay_stess_uvp *a, ay_stess_uvp *b);
+int ay_stess_cmpuvpu(const void *p1, const void *p2);
 
-int ay_stess_MergeVVectors(ay_stess_uvp *a, ay_stess_uvp *b);
+int ay_stess_cmpuvpv(const void *p1, const void *p2);
 
-void ay_stess_SortIntersections(ay_stess_uvp *list, int u);
+void ay_stess_SortIntersections(ay_stess_uvp *isects, int n, int u);
+
+int ay_stess_BuildTrimGrid(int numtrims, double **tcs, int *tcslens,
+			   int dim, double min, double d, int n,
+			   int **offs, int **segs);
+
+void ay_stess_GetGridRange(double t1, double t2, double min, double d, int n,
+			   int *a, int *b);
+
+int ay_stess_AddIntersection(ay_stess_uvp **isects, int *isectslen, int *n,
+			     int dir, double *ipoint);
+
+int ay_stess_EvalLines(ay_nurbpatch_object *p, int n, ay_stess_uvp **uvps);
+
+int ay_stess_MergeLine(ay_stess_uvp *isects, int nisects, int u,
+		       double min, double d, int maxreg, double uv,
+		       ay_stess_uvp **result);
 
 int ay_stess_TessTrimmedNPU(ay_object *o, int qf, int numtrims,
 			    double **tcs, int *tcslens, int *tcsdirs,
@@ -49,9 +101,12 @@ int ay_stess_TessTrimmedNPV(ay_object *o, int qf, int numtrims,
 
 int ay_stess_AddBoundaryTrim(ay_object *o, int *added);
 
+void ay_stess_RemoveBoundaryTrim(ay_object *o);
+
 
 /* local variables: */
-ay_object *ay_stess_boundarytrim = NULL;
+/** generation counter of tesselations */
+static unsigned int ay_stess_gen = 0;
 
 
 /* functions: */
@@ -64,7 +119,6 @@ ay_stess_destroy(ay_stess_patch *stess)
 {
  ay_voidfp *arr = NULL;
  ay_deletecb *cb = NULL;
- ay_stess_uvp *p = NULL;
  int i;
 
   if(!stess)
@@ -73,16 +127,13 @@ ay_stess_destroy(ay_stess_patch *stess)
   if(stess->tessv)
     free(stess->tessv);
 
+  /* the points of each line are stored in one contiguous array */
   if(stess->ups)
     {
       for(i = 0; i < stess->upslen; i++)
 	{
-	  while(stess->ups[i])
-	    {
-	      p = stess->ups[i]->next;
-	      free(stess->ups[i]);
-	      stess->ups[i] = p;
-	    }
+	  if(stess->ups[i])
+	    free(stess->ups[i]);
 	}
       free(stess->ups);
     }
@@ -91,12 +142,8 @@ ay_stess_destroy(ay_stess_patch *stess)
     {
       for(i = 0; i < stess->vpslen; i++)
 	{
-	  while(stess->vps[i])
-	    {
-	      p = stess->vps[i]->next;
-	      free(stess->vps[i]);
-	      stess->vps[i] = p;
-	    }
+	  if(stess->vps[i])
+	    free(stess->vps[i]);
 	}
       free(stess->vps);
     }
@@ -121,6 +168,28 @@ ay_stess_destroy(ay_stess_patch *stess)
 } /* ay_stess_destroy */
 
 
+/* ay_stess_destroylods:
+ *  properly destroy all level of detail tesselations of a patch
+ *  (see ay_nurbpatch_object.lods) and free the array
+ */
+void
+ay_stess_destroylods(ay_stess_patch **lods)
+{
+ int i;
+
+  if(!lods || !*lods)
+    return;
+
+  for(i = 0; i < AY_STESSLODS; i++)
+    ay_stess_destroy(&((*lods)[i]));
+
+  free(*lods);
+  *lods = NULL;
+
+ return;
+} /* ay_stess_destroylods */
+
+
 /* ay_stess_GetQF:
  *  calculate stess quality factor (QF) from GLU sampling tolerance (GST)
  *
@@ -128,31 +197,20 @@ ay_stess_destroy(ay_stess_patch *stess)
 int
 ay_stess_GetQF(double gst)
 {
- static double oldgst = 0.0;
- static int oldqf;
  int qf = 1;
  double base = 50.0;
 
   if(gst == 0.0)
     {
-      oldgst = 0.0;
       return 0;
     }
 
-  if(gst == oldgst)
-    {
-      return oldqf;
-    }
-
   while(gst < base)
     {
       base /= 2.0;
       qf *= 2;
     }
 
-  oldqf = qf;
-  oldgst = gst;
-
  return qf;
 } /* ay_stess_GetQF */
 
@@ -593,6 +651,241 @@ ay_stess_CurvePoints3D(int n, int p, double *U, double *Pw, int is_rat, int qf,
 } /* ay_stess_CurvePoints3D */
 
 
+/* ay_stess_EvalGridBand:
+ *  evaluate the columns <a0> to <a1>-1 of a surface grid
+ *  (see ay_stess_EvalGrid()); for each column, the control points are
+ *  first contracted with the u basis functions (and derivatives) into
+ *  a row of intermediate points, which then only need to be contracted
+ *  with the v basis functions of each grid point; the inner loops run
+ *  over contiguous memory so that the compiler may vectorize them
+ */
+void *
+ay_stess_EvalGridBand(void *data)
+{
+ ay_stess_grid *g = (ay_stess_grid *)data;
+ double *Q0 = g->Q, *Q1 = g->Q + g->m*4, *row, *q0, *q1;
+ double *Nu, *Nv, N0, N1, S[4], Su[4], Sv[4], w, temp[3];
+ double *Ct;
+ int a, b, c, j, r, s, m4 = g->m*4, p = g->p, q = g->q, spanu, spanv;
+
+  for(a = g->a0; a < g->a1; a++)
+    {
+      spanu = g->spanus[a];
+      Nu = &(g->Nus[a*2*(p+1)]);
+
+      memset(g->Q, 0, 2*m4*sizeof(double));
+
+      for(r = 0; r <= p; r++)
+	{
+	  N0 = Nu[r];
+	  N1 = Nu[p+1+r];
+	  row = &(g->P[(spanu-p+r)*m4]);
+	  for(j = 0; j < m4; j++)
+	    {
+	      Q0[j] += N0*row[j];
+	      Q1[j] += N1*row[j];
+	    }
+	}
+
+      Ct = &(g->Ct[a*g->Cm*6]);
+
+      for(b = 0; b < g->Cm; b++)
+	{
+	  spanv = g->spanvs[b];
+	  Nv = &(g->Nvs[b*2*(q+1)]);
+
+	  memset(S, 0, 4*sizeof(double));
+	  memset(Su, 0, 4*sizeof(double));
+	  memset(Sv, 0, 4*sizeof(double));
+
+	  for(s = 0; s <= q; s++)
+	    {
+	      q0 = &(Q0[(spanv-q+s)*4]);
+	      q1 = &(Q1[(spanv-q+s)*4]);
+	      for(c = 0; c < 4; c++)
+		{
+		  S[c] += Nv[s]*q0[c];
+		  Su[c] += Nv[s]*q1[c];
+		  Sv[c] += Nv[q+1+s]*q0[c];
+		}
+	    }
+
+	  if(g->is_rat)
+	    {
+	      w = S[3];
+	      for(c = 0; c < 3; c++)
+		{
+		  S[c] /= w;
+		  Su[c] = (Su[c] - Su[3]*S[c])/w;
+		  Sv[c] = (Sv[c] - Sv[3]*S[c])/w;
+		}
+	    }
+
+	  memcpy(Ct, S, 3*sizeof(double));
+
+	  AY_V3CROSS(temp, Su, Sv);
+	  memcpy(&(Ct[3]), temp, 3*sizeof(double));
+
+	  Ct += 6;
+	} /* for */
+    } /* for */
+
+ return NULL;
+} /* ay_stess_EvalGridBand */
+
+
+/* ay_stess_EvalGrid:
+ *  calculate points and normals of a (rational) NURBS surface
+ *  (n, m, p, q, U, V, P) at the <Cn>x<Cm> parametric values
+ *  U[p] + a*ud, V[q] + b*vd with the precomputed spans <spanus>
+ *  and <spanvs> into <Ct> [Cn*Cm*6];
+ *  the basis functions are computed only once per column and row,
+ *  large grids are split into bands of columns that are evaluated
+ *  in parallel
+ */
+int
+ay_stess_EvalGrid(int n, int m, int p, int q, double *U, double *V,
+		  double *P, int is_rat, int Cn, int Cm, double ud, double vd,
+		  int *spanus, int *spanvs, double *Ct)
+{
+ int ay_status = AY_OK;
+ ay_stess_grid *grids = NULL;
+ double *Nus = NULL, *Nvs = NULL, *Ph = NULL, *Q = NULL, *N = NULL;
+ double u, v;
+ int a, i, nthreads = 1;
+#ifndef WIN32
+ pthread_t *threads = NULL;
+ int created = 0;
+#endif /* !WIN32 */
+
+  if(!(Nus = malloc((Cn*2*(p+1) + Cm*2*(q+1))*sizeof(double))))
+    return AY_EOMEM;
+  Nvs = Nus + Cn*2*(p+1);
+
+  a = (p > q)?p:q;
+  if(!(N = malloc(((a+1)+((a+1)+(a+1)+((a+1)*(a+1))+2*(a+1)))*
+		  sizeof(double))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  /* basis functions and first derivatives of all columns and rows */
+  u = U[p];
+  for(a = 0; a < Cn; a++)
+    {
+      ay_nb_DersBasisFunsM(spanus[a], u, p, 1, U, N);
+      memcpy(&(Nus[a*2*(p+1)]), N, 2*(p+1)*sizeof(double));
+      u += ud;
+    }
+
+  v = V[q];
+  for(a = 0; a < Cm; a++)
+    {
+      ay_nb_DersBasisFunsM(spanvs[a], v, q, 1, V, N);
+      memcpy(&(Nvs[a*2*(q+1)]), N, 2*(q+1)*sizeof(double));
+      v += vd;
+    }
+
+  /* rational surfaces are evaluated in homogeneous space */
+  if(is_rat)
+    {
+      if(!(Ph = malloc(n*m*4*sizeof(double))))
+	{ ay_status = AY_EOMEM; goto cleanup; }
+      for(i = 0; i < n*m*4; i += 4)
+	{
+	  Ph[i]   = P[i]*P[i+3];
+	  Ph[i+1] = P[i+1]*P[i+3];
+	  Ph[i+2] = P[i+2]*P[i+3];
+	  Ph[i+3] = P[i+3];
+	}
+      P = Ph;
+    }
+
+#ifndef WIN32
+  if(Cn*Cm >= AY_STESSMINPARGRID)
+    {
+      nthreads = ay_notify_getnthreads();
+      if(nthreads > Cn)
+	nthreads = Cn;
+    }
+#endif /* !WIN32 */
+
+  if(!(grids = calloc(nthreads, sizeof(ay_stess_grid))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  if(!(Q = malloc(nthreads*m*4*2*sizeof(double))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  for(i = 0; i < nthreads; i++)
+    {
+      grids[i].m = m;
+      grids[i].p = p;
+      grids[i].q = q;
+      grids[i].P = P;
+      grids[i].is_rat = is_rat;
+      grids[i].Cm = Cm;
+      grids[i].Nus = Nus;
+      grids[i].Nvs = Nvs;
+      grids[i].spanus = spanus;
+      grids[i].spanvs = spanvs;
+      grids[i].Q = &(Q[i*m*4*2]);
+      grids[i].Ct = Ct;
+      grids[i].a0 = (i*Cn)/nthreads;
+      grids[i].a1 = ((i+1)*Cn)/nthreads;
+    }
+
+#ifndef WIN32
+  if(nthreads > 1)
+    {
+      if(!(threads = malloc((nthreads-1)*sizeof(pthread_t))))
+	{ ay_status = AY_EOMEM; goto cleanup; }
+
+      /* the main thread is one of the workers */
+      for(i = 1; i < nthreads; i++)
+	{
+	  if(pthread_create(&(threads[created]), NULL, ay_stess_EvalGridBand,
+			    &(grids[i])))
+	    break;
+	  created++;
+	}
+
+      /* bands that got no thread of their own */
+      for(i = created+1; i < nthreads; i++)
+	(void)ay_stess_EvalGridBand(&(grids[i]));
+    }
+#endif /* !WIN32 */
+
+  (void)ay_stess_EvalGridBand(&(grids[0]));
+
+#ifndef WIN32
+  for(i = 0; i < created; i++)
+    (void)pthread_join(threads[i], NULL);
+#endif /* !WIN32 */
+
+cleanup:
+
+  if(Nus)
+    free(Nus);
+
+  if(N)
+    free(N);
+
+  if(Ph)
+    free(Ph);
+
+  if(Q)
+    free(Q);
+
+  if(grids)
+    free(grids);
+
+#ifndef WIN32
+  if(threads)
+    free(threads);
+#endif /* !WIN32 */
+
+ return ay_status;
+} /* ay_stess_EvalGrid */
+
+
 /* ay_stess_SurfacePoints3D:
  *   calculate all points of an untrimmed NURBS surface
  */
@@ -602,10 +895,10 @@ ay_stess_SurfacePoints3D(int n, int m, int p, int q, double *U, double *V,
 			 int *Cn, int *Cm, double **C)
 {
  int ay_status = AY_OK;
- int spanu = 0, spanv = 0, j = 0;
- int a, b;
+ int spanu = 0, spanv = 0;
+ int a;
  double u, v, ud, vd;
- double temp[3] = {0}, *Ct = NULL, *fder = NULL, *fd1, *fd2;
+ double *Ct = NULL;
  int *spanus = NULL, *spanvs = NULL;
 
   if(qfu == 0)
@@ -627,12 +920,6 @@ ay_stess_SurfacePoints3D(int n, int m, int p, int q, double *U, double *V,
     { ay_status = AY_EOMEM; goto cleanup; }
   spanvs = spanus + (*Cn);
 
-  if(!(fder = malloc(ay_nb_FirstDerSurf3DMSize(p, q)*sizeof(double))))
-    { ay_status = AY_EOMEM; goto cleanup; }
-
-  fd1 = &(fder[3]);
-  fd2 = &(fder[6]);
-
   /* employ linear variants of FindSpan() as they are much faster
      than a binary search; especially, since we calculate
      spans for all parameters in order */
@@ -700,32 +987,11 @@ ay_stess_SurfacePoints3D(int n, int m, int p, int q, double *U, double *V,
     }
   spanvs[a] = spanvs[a-1];
 
-  u = U[p];
-  for(a = 0; a < (*Cn); a++)
-    {
-      spanu = spanus[a];
-      v = V[q];
-      for(b = 0; b < (*Cm); b++)
-	{
-	  spanv = spanvs[b];
-
-	  /* calculate point and normal */
-	  fder[0] = (double)spanu;
-	  fder[1] = (double)spanv;
-	  fder[2] = 0.0;
-	  fder[3] = 0.0;
-	  ay_nb_FirstDerSurf3DM(n-1, m-1, p, q, U, V, P, u, v, fder);
-	  memcpy(&(Ct[j]), fder, 3*sizeof(double));
-
-	  AY_V3CROSS(temp, fd2, fd1);
-	  memcpy(&(Ct[j+3]), temp, 3*sizeof(double));
-
-	  j += 6;
-	  v += vd;
-	} /* for */
-
-      u += ud;
-    } /* for */
+  /* calculate points and normals */
+  ay_status = ay_stess_EvalGrid(n, m, p, q, U, V, P, AY_FALSE, *Cn, *Cm,
+				ud, vd, spanus, spanvs, Ct);
+  if(ay_status)
+    goto cleanup;
 
   *C = Ct;
   Ct = NULL;
@@ -735,9 +1001,6 @@ cleanup:
   if(Ct)
     free(Ct);
 
-  if(fder)
-    free(fder);
-
   if(spanus)
     free(spanus);
 
@@ -896,10 +1159,10 @@ ay_stess_SurfacePoints4D(int n, int m, int p, int q, double *U, double *V,
 			 int *Cn, int *Cm, double **C)
 {
  int ay_status = AY_OK;
- int spanu = 0, spanv = 0, j = 0;
- int a, b;
+ int spanu = 0, spanv = 0;
+ int a;
  double u, v, ud, vd;
- double *Ct = NULL, temp[3] = {0}, *fder = NULL, *fd1, *fd2;
+ double *Ct = NULL;
  int *spanus = NULL, *spanvs = NULL;
 
   if(qfu == 0)
@@ -918,15 +1181,9 @@ ay_stess_SurfacePoints4D(int n, int m, int p, int q, double *U, double *V,
     { ay_status = AY_EOMEM; goto cleanup; }
   spanvs = spanus + (*Cn);
 
-  if(!(fder = malloc(ay_nb_FirstDerSurf4DMSize(p, q)*sizeof(double))))
-    { ay_status = AY_EOMEM; goto cleanup; }
-
   if(!(Ct = calloc((*Cn)*(*Cm)*6, sizeof(double))))
     { ay_status = AY_EOMEM; goto cleanup; }
 
-  fd1 = &(fder[3]);
-  fd2 = &(fder[6]);
-
   /* employ linear variants of FindSpan() as they are much faster
      than a binary search; especially, since we calculate
      spans for all parameters in order */
@@ -994,33 +1251,11 @@ ay_stess_SurfacePoints4D(int n, int m, int p, int q, double *U, double *V,
     }
   spanvs[a] = spanvs[a-1];
 
-  u = U[p];
-  for(a = 0; a < (*Cn); a++)
-    {
-      spanu = spanus[a];
-      v = V[q];
-
-      for(b = 0; b < (*Cm); b++)
-	{
-	  spanv = spanvs[b];
-
-	  /* calculate point and normal */
-	  fder[0] = (double)spanu;
-	  fder[1] = (double)spanv;
-	  fder[2] = 0.0;
-	  fder[3] = 0.0;
-	  ay_nb_FirstDerSurf4DM(n-1, m-1, p, q, U, V, Pw, u, v, fder);
-	  memcpy(&(Ct[j]), fder, 3*sizeof(double));
-
-	  AY_V3CROSS(temp, fd2, fd1);
-	  memcpy(&(Ct[j+3]), temp, 3*sizeof(double));
-
-	  j += 6;
-	  v += vd;
-	} /* for */
-
-      u += ud;
-    } /* for */
+  /* calculate points and normals */
+  ay_status = ay_stess_EvalGrid(n, m, p, q, U, V, Pw, AY_TRUE, *Cn, *Cm,
+				ud, vd, spanus, spanvs, Ct);
+  if(ay_status)
+    goto cleanup;
 
   /* return result */
   *C = Ct;
@@ -1031,9 +1266,6 @@ cleanup:
   if(Ct)
     free(Ct);
 
-  if(fder)
-    free(fder);
-
   if(spanus)
     free(spanus);
 
@@ -1528,247 +1760,250 @@ ay_stess_ReTessTrimCurves(ay_object *o, int qf, int numtrims, double **tt,
 } /* ay_stess_ReTessTrimCurves */
 
 
+/* ay_stess_cmpuvpu:
+ *  compare two tesselated points by their u parameter
+ *  (helper for qsort)
+ */
+int
+ay_stess_cmpuvpu(const void *p1, const void *p2)
+{
+ const ay_stess_uvp *uvp1 = p1, *uvp2 = p2;
+
+  if(uvp1->u < uvp2->u)
+    return -1;
+  if(uvp1->u > uvp2->u)
+    return 1;
+
+ return 0;
+} /* ay_stess_cmpuvpu */
+
+
+/* ay_stess_cmpuvpv:
+ *  compare two tesselated points by their v parameter
+ *  (helper for qsort)
+ */
+int
+ay_stess_cmpuvpv(const void *p1, const void *p2)
+{
+ const ay_stess_uvp *uvp1 = p1, *uvp2 = p2;
+
+  if(uvp1->v < uvp2->v)
+    return -1;
+  if(uvp1->v > uvp2->v)
+    return 1;
+
+ return 0;
+} /* ay_stess_cmpuvpv */
+
+
 /* ay_stess_SortIntersections:
- *  sort a list of intersections for faster merging
+ *  sort an array of <n> intersections by u (if <u> is AY_TRUE)
+ *  or v for faster merging
  */
 void
-ay_stess_SortIntersections(ay_stess_uvp *list, int u)
+ay_stess_SortIntersections(ay_stess_uvp *isects, int n, int u)
 {
- int done = AY_FALSE;
- ay_stess_uvp *p1, *p2;
- double t;
 
-  if(!list || !list->next)
+  if(!isects || n < 2)
     return;
 
-  while(!done)
-    {
-      done = AY_TRUE;
-
-      p1 = list;
-      p2 = p1->next;
-      while(p1 && p2)
-	{
-	  if(u)
-	    {
-	      if(p1->u > p2->u)
-		{
-		  t = p1->u;
-		  p1->u = p2->u;
-		  p2->u = t;
-		  done = AY_FALSE;
-		}
-	    }
-	  else
-	    {
-	      if(p1->v > p2->v)
-		{
-		  t = p1->v;
-		  p1->v = p2->v;
-		  p2->v = t;
-		  done = AY_FALSE;
-		}
-	    }
-
-	  p1 = p1->next;
-	  p2 = p2->next;
-	} /* while p1 && p2 */
-    } /* while !done */
+  if(u)
+    qsort(isects, n, sizeof(ay_stess_uvp), ay_stess_cmpuvpu);
+  else
+    qsort(isects, n, sizeof(ay_stess_uvp), ay_stess_cmpuvpv);
 
  return;
 } /* ay_stess_SortIntersections */
 
 
-/* ay_stess_TessTrimmedNPU:
- *  tesselate NURBS patch <o> into lines in parametric direction u
+/* ay_stess_BuildTrimGrid:
+ *  build a grid over the sections of the tesselated trim curves
+ *  <tcs> that records, for each of the <n> scanlines at
+ *  <min>, <min>+<d>, ..., which sections cross or touch it in
+ *  dimension <dim> (0 - u, 1 - v);
+ *  the sections of scanline i are stored as pairs of trim curve
+ *  index and section index in <segs>[<offs>[i]*2] to
+ *  <segs>[<offs>[i+1]*2-1] in the order in which an iteration over
+ *  all sections of all trim curves would visit them;
+ *  sections are registered with a safety margin of one scanline,
+ *  the exact test is left to the caller
  */
 int
-ay_stess_TessTrimmedNPU(ay_object *o, int qf, int numtrims,
-			double **tcs, int *tcslens, int *tcsdirs,
-			int *reslen, ay_stess_uvp ***result)
+ay_stess_BuildTrimGrid(int numtrims, double **tcs, int *tcslens,
+		       int dim, double min, double d, int n,
+		       int **offs, int **segs)
 {
  int ay_status = AY_OK;
- ay_nurbpatch_object *p = NULL;
- ay_stess_uvp **uvps = NULL, *uvpptr, *newuvp, **nextuvp, *trimuvp;
- ay_stess_uvp *nexttrimuvp, *olduvp;
- double *tt, ipoint[2] = {0};
- double p3[2], p4[2], *U, *V, u, v;
- double *fd1, *fd2, temp[3] = {0}, *ders = NULL;
- double umin, umax, vmin, vmax, ud, vd;
- int i, k, l, ind;
- int out = 0;
- int Cm, Cn;
+ int i, k, l, a, b, *o = NULL, *s = NULL, *fill = NULL;
+ double *tt;
 
-  p = (ay_nurbpatch_object *)o->refine;
+  if(!(o = calloc(n+1, sizeof(int))))
+    return AY_EOMEM;
 
-  Cn = (p->width + 4) * qf;
-  *reslen = Cn;
-  Cm = (p->height + 4) * qf;
-  if(!(uvps = calloc(Cn, sizeof(ay_stess_uvp *))))
+  if(!(fill = calloc(n, sizeof(int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  /* first pass: count the sections of each scanline */
+  for(k = 0; k < numtrims; k++)
     {
-      return AY_EOMEM;
+      tt = tcs[k];
+      for(l = 0; l < (tcslens[k]-1); l++)
+	{
+	  ay_stess_GetGridRange(tt[l*2+dim], tt[l*2+2+dim], min, d, n,
+				&a, &b);
+	  for(i = a; i <= b; i++)
+	    o[i+1]++;
+	}
     }
 
-  U = p->uknotv;
-  umin = U[p->uorder-1];
-  umax = U[p->width];
-  ud = (umax-umin)/((Cn)-1);
-
-  V = p->vknotv;
-  vmin = V[p->vorder-1];
-  vmax = V[p->height];
-  vd = (vmax-vmin)/((Cm)-1);
-
-  u = umin;
-  p3[1] = vmin - AY_EPSILON;
-  p4[1] = vmax + AY_EPSILON;
-
-  for(i = 0; i < Cn; i++)
+  for(i = 0; i < n; i++)
     {
-      nextuvp = &trimuvp;
-      olduvp = NULL;
-      trimuvp = NULL;
+      o[i+1] += o[i];
+      fill[i] = o[i];
+    }
 
-      if(i == Cn-1)
-	u = umax;
-      p3[0] = u;
-      p4[0] = u;
+  if(o[n] > 0)
+    {
+      if(!(s = malloc(o[n]*2*sizeof(int))))
+	{ ay_status = AY_EOMEM; goto cleanup; }
+    }
 
-      /* calc all intersections of all trimloops with current u */
-      for(k = 0; k < numtrims; k++)
+  /* second pass: register the sections */
+  for(k = 0; k < numtrims; k++)
+    {
+      tt = tcs[k];
+      for(l = 0; l < (tcslens[k]-1); l++)
 	{
-	  tt = tcs[k];
-
-	  for(l = 0; l < (tcslens[k]-1); l++)
+	  ay_stess_GetGridRange(tt[l*2+dim], tt[l*2+2+dim], min, d, n,
+				&a, &b);
+	  for(i = a; i <= b; i++)
 	    {
-	      ind = l*2;
+	      s[fill[i]*2] = k;
+	      s[fill[i]*2+1] = l;
+	      fill[i]++;
+	    }
+	}
+    }
 
-	      /* is section crossing or touching u? */
-	      if(((tt[ind] <= (u + AY_EPSILON))
-		  && (tt[ind+2] >= (u - AY_EPSILON))) ||
-		 ((tt[ind] >= (u - AY_EPSILON)) &&
-		  (tt[ind+2] <= (u + AY_EPSILON))))
-		{
-		  /* weed out all sections that run (more or less)
-		     exactly along the current u-line, nothing good
-		     comes of them */
-		  if((fabs(tt[ind] - u) < AY_EPSILON) &&
-		     (fabs(tt[ind+2] - u) < AY_EPSILON))
-		    {
-#ifdef AY_STESSDBG
-		      printf("Discarding parallel section.\n");
-#endif
-		      continue;
-		    }
-		  ipoint[0] = 0.0;
-		  ipoint[1] = 0.0;
+  /* return result */
+  *offs = o;
+  *segs = s;
 
-		  if((ay_stess_IntersectLines2D(&(tt[ind]),
-						&(tt[ind+2]),
-						p3, p4, ipoint)))
-		    {
-		      /* u-line intersects with trimcurve */
-		      /* => add new point (but avoid consecutive
-			 equal points; those appear if a loop touches
-			 start or end of the current u-line) */
-		      if(!olduvp ||
-			 fabs(olduvp->v - ipoint[1]) > AY_EPSILON)
-			{
-			  if(!(newuvp = calloc(1, sizeof(ay_stess_uvp))))
-			    {
-			      ay_status = AY_EOMEM;
-			      goto cleanup;
-			    }
-			  newuvp->type = 1;
-			  newuvp->dir = tcsdirs[k];
-			  newuvp->u = ipoint[0];
-			  newuvp->v = ipoint[1];
-			  olduvp = newuvp;
-			  *nextuvp = newuvp;
-			  nextuvp = &(newuvp->next);
-			}
-		    } /* if have intersection */
-		} /* if is not parallel */
-	    } /* for */
-	} /* for */
+  /* prevent cleanup code from doing something harmful */
+  o = NULL;
+  s = NULL;
 
-      nextuvp = &(uvps[i]);
+cleanup:
 
-      if(trimuvp && trimuvp->next)
-	{
-	  /* we had trimloop points */
-	  ay_stess_SortIntersections(trimuvp, AY_FALSE);
+  if(o)
+    free(o);
 
-	  *nextuvp = trimuvp;
-	  nextuvp = &(trimuvp->next);
-	  nexttrimuvp = trimuvp->next;
+  if(s)
+    free(s);
 
-	  v = vmin;
-	  while(v < trimuvp->v)
-	    v += vd;
+  if(fill)
+    free(fill);
 
-	  out = 0;
+ return ay_status;
+} /* ay_stess_BuildTrimGrid */
 
-	  while(nexttrimuvp)
-	    {
-	      while(v < (nexttrimuvp->v-4*AY_EPSILON))
-		{
-		  if(!out)
-		    {
-		      if(!(newuvp = calloc(1, sizeof(ay_stess_uvp))))
-			{
-			  ay_status = AY_EOMEM;
-			  goto cleanup;
-			}
-		      newuvp->u = u;
-		      newuvp->v = v;
-		      *nextuvp = newuvp;
-		      nextuvp = &(newuvp->next);
-		    }
-		  v += vd;
-		} /* while */
 
-	      out = !out;
+/* ay_stess_GetGridRange:
+ *  get the range of scanlines [<a>, <b>] a section from <t1> to <t2>
+ *  crosses or touches (helper for ay_stess_BuildTrimGrid())
+ */
+void
+ay_stess_GetGridRange(double t1, double t2, double min, double d, int n,
+		      int *a, int *b)
+{
+ double lo, hi;
 
-	      *nextuvp = nexttrimuvp;
-	      nextuvp = &(nexttrimuvp->next);
+  if(t1 < t2)
+    {
+      lo = t1;
+      hi = t2;
+    }
+  else
+    {
+      lo = t2;
+      hi = t1;
+    }
 
-	      nexttrimuvp = nexttrimuvp->next;
-	    } /* while */
-	}
-      else
-	{
-	  if(trimuvp)
-	    free(trimuvp);
-	} /* if have multiple intersections */
+  if(d <= 0.0)
+    {
+      *a = 0;
+      *b = n-1;
+      return;
+    }
 
-      u += ud;
-    } /* for */
+  lo = floor((lo - AY_EPSILON - min)/d) - 1.0;
+  hi = ceil((hi + AY_EPSILON - min)/d) + 1.0;
+
+  *a = (lo < 0.0)?0:((lo > n-1)?n:(int)lo);
+  *b = (hi > n-1)?(n-1):((hi < 0.0)?-1:(int)hi);
+
+ return;
+} /* ay_stess_GetGridRange */
+
+
+/* ay_stess_AddIntersection:
+ *  append an intersection to the growable array <isects>
+ *  (of <isectslen> elements, <n> in use)
+ */
+int
+ay_stess_AddIntersection(ay_stess_uvp **isects, int *isectslen, int *n,
+			 int dir, double *ipoint)
+{
+ ay_stess_uvp *t;
+
+  if(*n >= *isectslen)
+    {
+      if(!(t = realloc(*isects, (*isectslen*2+16)*sizeof(ay_stess_uvp))))
+	return AY_EOMEM;
+      *isects = t;
+      *isectslen = *isectslen*2+16;
+    }
+
+  t = &((*isects)[*n]);
+  memset(t, 0, sizeof(ay_stess_uvp));
+  t->type = 1;
+  t->dir = dir;
+  t->u = ipoint[0];
+  t->v = ipoint[1];
+  (*n)++;
+
+ return AY_OK;
+} /* ay_stess_AddIntersection */
+
+
+/* ay_stess_EvalLines:
+ *  link the tesselated points of the <n> lines <uvps> and
+ *  calculate their surface points and normals
+ */
+int
+ay_stess_EvalLines(ay_nurbpatch_object *p, int n, ay_stess_uvp **uvps)
+{
+ ay_stess_uvp *uvpptr;
+ double *fd1, *fd2, temp[3] = {0}, *ders = NULL;
+ int i;
 
-  /* finally, calculate surfacepoints */
   if(p->is_rat)
     {
       if(!(ders = malloc(
 	 ay_nb_FirstDerSurf4DMSize(p->uorder-1, p->vorder-1)*sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
+	return AY_EOMEM;
     }
   else
     {
       if(!(ders = malloc(
 	 ay_nb_FirstDerSurf3DMSize(p->uorder-1, p->vorder-1)*sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
+	return AY_EOMEM;
     }
 
   fd1 = &(ders[3]);
   fd2 = &(ders[6]);
 
-  for(i = 0; i < Cn; i++)
+  for(i = 0; i < n; i++)
     {
       uvpptr = uvps[i];
 
@@ -1799,6 +2034,217 @@ ay_stess_TessTrimmedNPU(ay_object *o, int qf, int numtrims,
 
   free(ders);
 
+ return AY_OK;
+} /* ay_stess_EvalLines */
+
+
+/* ay_stess_MergeLine:
+ *  merge the <nisects> sorted intersections <isects> of a line
+ *  with the regularly spaced points inside the trim loops into a
+ *  new contiguous and linked array <result>;
+ *  if <u> is AY_TRUE the points are spaced in u along a line at
+ *  v=<uv>, otherwise in v along a line at u=<uv>; the regular points
+ *  start at <min> and are <d> apart, there are at most <maxreg> of them
+ */
+int
+ay_stess_MergeLine(ay_stess_uvp *isects, int nisects, int u,
+		   double min, double d, int maxreg, double uv,
+		   ay_stess_uvp **result)
+{
+ ay_stess_uvp *uvps = NULL, *t;
+ double r, next;
+ int i, j = 0, n, out = 0;
+
+  n = nisects + maxreg;
+  if(!(uvps = malloc(n*sizeof(ay_stess_uvp))))
+    return AY_EOMEM;
+
+  memcpy(&(uvps[j++]), &(isects[0]), sizeof(ay_stess_uvp));
+
+  r = min;
+  if(u)
+    while(r < isects[0].u)
+      r += d;
+  else
+    while(r < isects[0].v)
+      r += d;
+
+  for(i = 1; i < nisects; i++)
+    {
+      next = u?isects[i].u:isects[i].v;
+
+      while(r < (next-4*AY_EPSILON))
+	{
+	  if(!out && j < n-(nisects-i))
+	    {
+	      t = &(uvps[j++]);
+	      memset(t, 0, sizeof(ay_stess_uvp));
+	      if(u)
+		{
+		  t->u = r;
+		  t->v = uv;
+		}
+	      else
+		{
+		  t->u = uv;
+		  t->v = r;
+		}
+	    }
+	  r += d;
+	} /* while */
+
+      out = !out;
+
+      memcpy(&(uvps[j++]), &(isects[i]), sizeof(ay_stess_uvp));
+    } /* for */
+
+  /* shrink to fit, the links are set up only now */
+  if(j < n)
+    {
+      if((t = realloc(uvps, j*sizeof(ay_stess_uvp))))
+	uvps = t;
+    }
+
+  for(i = 0; i < j; i++)
+    {
+      uvps[i].prev = NULL;
+      uvps[i].next = (i < j-1)?&(uvps[i+1]):NULL;
+    }
+
+  *result = uvps;
+
+ return AY_OK;
+} /* ay_stess_MergeLine */
+
+
+/* ay_stess_TessTrimmedNPU:
+ *  tesselate NURBS patch <o> into lines in parametric direction u;
+ *  the points of each line are stored in a contiguous array
+ *  (linked via next/prev), only the trim curve sections found
+ *  via a grid over u are intersected with a line
+ */
+int
+ay_stess_TessTrimmedNPU(ay_object *o, int qf, int numtrims,
+			double **tcs, int *tcslens, int *tcsdirs,
+			int *reslen, ay_stess_uvp ***result)
+{
+ int ay_status = AY_OK;
+ ay_nurbpatch_object *p = NULL;
+ ay_stess_uvp **uvps = NULL, *isects = NULL;
+ double *tt, ipoint[2] = {0}, oldv = 0.0;
+ double p3[2], p4[2], *U, *V, u;
+ double umin, umax, vmin, vmax, ud, vd;
+ int i, k, l, s, ind, isectslen = 0, nisects, *offs = NULL, *segs = NULL;
+ int Cm, Cn;
+
+  p = (ay_nurbpatch_object *)o->refine;
+
+  Cn = (p->width + 4) * qf;
+  *reslen = Cn;
+  Cm = (p->height + 4) * qf;
+  if(!(uvps = calloc(Cn, sizeof(ay_stess_uvp *))))
+    {
+      return AY_EOMEM;
+    }
+
+  U = p->uknotv;
+  umin = U[p->uorder-1];
+  umax = U[p->width];
+  ud = (umax-umin)/((Cn)-1);
+
+  V = p->vknotv;
+  vmin = V[p->vorder-1];
+  vmax = V[p->height];
+  vd = (vmax-vmin)/((Cm)-1);
+
+  ay_status = ay_stess_BuildTrimGrid(numtrims, tcs, tcslens, 0, umin, ud, Cn,
+				     &offs, &segs);
+  if(ay_status)
+    goto cleanup;
+
+  u = umin;
+  p3[1] = vmin - AY_EPSILON;
+  p4[1] = vmax + AY_EPSILON;
+
+  for(i = 0; i < Cn; i++)
+    {
+      nisects = 0;
+
+      if(i == Cn-1)
+	u = umax;
+      p3[0] = u;
+      p4[0] = u;
+
+      /* calc all intersections of the trimloops with current u */
+      for(s = offs[i]; s < offs[i+1]; s++)
+	{
+	  k = segs[s*2];
+	  l = segs[s*2+1];
+	  tt = tcs[k];
+	  ind = l*2;
+
+	  /* is section crossing or touching u? */
+	  if(((tt[ind] <= (u + AY_EPSILON))
+	      && (tt[ind+2] >= (u - AY_EPSILON))) ||
+	     ((tt[ind] >= (u - AY_EPSILON)) &&
+	      (tt[ind+2] <= (u + AY_EPSILON))))
+	    {
+	      /* weed out all sections that run (more or less)
+		 exactly along the current u-line, nothing good
+		 comes of them */
+	      if((fabs(tt[ind] - u) < AY_EPSILON) &&
+		 (fabs(tt[ind+2] - u) < AY_EPSILON))
+		{
+#ifdef AY_STESSDBG
+		  printf("Discarding parallel section.\n");
+#endif
+		  continue;
+		}
+	      ipoint[0] = 0.0;
+	      ipoint[1] = 0.0;
+
+	      if((ay_stess_IntersectLines2D(&(tt[ind]),
+					    &(tt[ind+2]),
+					    p3, p4, ipoint)))
+		{
+		  /* u-line intersects with trimcurve */
+		  /* => add new point (but avoid consecutive
+		     equal points; those appear if a loop touches
+		     start or end of the current u-line) */
+		  if(!nisects || fabs(oldv - ipoint[1]) > AY_EPSILON)
+		    {
+		      ay_status = ay_stess_AddIntersection(&isects,
+							   &isectslen,
+							   &nisects,
+							   tcsdirs[k],
+							   ipoint);
+		      if(ay_status)
+			goto cleanup;
+		      oldv = ipoint[1];
+		    }
+		} /* if have intersection */
+	    } /* if is not parallel */
+	} /* for */
+
+      if(nisects > 1)
+	{
+	  /* we had trimloop points */
+	  ay_stess_SortIntersections(isects, nisects, AY_FALSE);
+
+	  ay_status = ay_stess_MergeLine(isects, nisects, AY_FALSE,
+					 vmin, vd, Cm+2, u, &(uvps[i]));
+	  if(ay_status)
+	    goto cleanup;
+	} /* if have multiple intersections */
+
+      u += ud;
+    } /* for */
+
+  /* finally, calculate surfacepoints */
+  ay_status = ay_stess_EvalLines(p, Cn, uvps);
+  if(ay_status)
+    goto cleanup;
+
   /* return result */
   *result = uvps;
 
@@ -1811,22 +2257,28 @@ cleanup:
     {
       for(i = 0; i < Cn; i++)
 	{
-	  while(uvps[i])
-	    {
-	      uvpptr = uvps[i]->next;
-	      free(uvps[i]);
-	      uvps[i] = uvpptr;
-	    }
+	  if(uvps[i])
+	    free(uvps[i]);
 	}
       free(uvps);
     }
 
+  if(isects)
+    free(isects);
+
+  if(offs)
+    free(offs);
+
+  if(segs)
+    free(segs);
+
  return ay_status;
 } /* ay_stess_TessTrimmedNPU */
 
 
 /* ay_stess_TessTrimmedNPV:
- *  tesselate NURBS patch <o> into lines in parametric direction v
+ *  tesselate NURBS patch <o> into lines in parametric direction v;
+ *  see also ay_stess_TessTrimmedNPU()
  */
 int
 ay_stess_TessTrimmedNPV(ay_object *o, int qf, int numtrims,
@@ -1835,14 +2287,11 @@ ay_stess_TessTrimmedNPV(ay_object *o, int qf, int numtrims,
 {
  int ay_status = AY_OK;
  ay_nurbpatch_object *p = NULL;
- ay_stess_uvp **uvps = NULL, *uvpptr, *newuvp, **nextuvp, *trimuvp;
- ay_stess_uvp *olduvp, *nexttrimuvp;
- double *tt, ipoint[2] = {0};
- double p3[2], p4[2], *U, *V, u, v;
- double *fd1, *fd2, temp[3] = {0}, *ders = NULL;
+ ay_stess_uvp **uvps = NULL, *isects = NULL;
+ double *tt, ipoint[2] = {0}, oldu = 0.0;
+ double p3[2], p4[2], *U, *V, v;
  double umin, umax, vmin, vmax, ud, vd;
- int i, k, l, ind;
- int out = 0;
+ int i, k, l, s, ind, isectslen = 0, nisects, *offs = NULL, *segs = NULL;
  int Cm, Cn;
 
   p = (ay_nurbpatch_object *)o->refine;
@@ -1865,183 +2314,89 @@ ay_stess_TessTrimmedNPV(ay_object *o, int qf, int numtrims,
   vmax = V[p->height];
   vd = (vmax-vmin)/((Cm)-1);
 
+  ay_status = ay_stess_BuildTrimGrid(numtrims, tcs, tcslens, 1, vmin, vd, Cm,
+				     &offs, &segs);
+  if(ay_status)
+    goto cleanup;
+
   v = vmin;
   p3[0] = umin - AY_EPSILON;
   p4[0] = umax + AY_EPSILON;
 
   for(i = 0; i < Cm; i++)
     {
-      nextuvp = &trimuvp;
-      olduvp = NULL;
-      trimuvp = NULL;
+      nisects = 0;
 
       if(i == Cm-1)
 	v = vmax;
       p3[1] = v;
       p4[1] = v;
 
-      /* calc all intersections of all trimloops with current v */
-      for(k = 0; k < numtrims; k++)
+      /* calc all intersections of the trimloops with current v */
+      for(s = offs[i]; s < offs[i+1]; s++)
 	{
+	  k = segs[s*2];
+	  l = segs[s*2+1];
 	  tt = tcs[k];
-
-	  for(l = 0; l < (tcslens[k]-1); l++)
-	    {
-	      ind = l*2;
-
-	      /* is section crossing or touching v? */
-	      if(((tt[ind+1] <= (v + AY_EPSILON)) &&
-		  (tt[ind+2+1] >= (v - AY_EPSILON))) ||
-		 ((tt[ind+1] >= (v - AY_EPSILON)) &&
-		  (tt[ind+2+1] <= (v + AY_EPSILON))))
+	  ind = l*2;
+
+	  /* is section crossing or touching v? */
+	  if(((tt[ind+1] <= (v + AY_EPSILON)) &&
+	      (tt[ind+2+1] >= (v - AY_EPSILON))) ||
+	     ((tt[ind+1] >= (v - AY_EPSILON)) &&
+	      (tt[ind+2+1] <= (v + AY_EPSILON))))
+	    {
+	      /* weed out all sections that run (more or less)
+		 exactly along the current v-line, nothing good
+		 comes of them */
+	      if((fabs(tt[ind+1] - v) < AY_EPSILON) &&
+		 (fabs(tt[ind+2+1] - v) < AY_EPSILON))
+		continue;
+
+	      ipoint[0] = 0.0;
+	      ipoint[1] = 0.0;
+
+	      if((ay_stess_IntersectLines2D(&(tt[ind]),
+					    &(tt[ind+2]),
+					    p3, p4, ipoint)))
 		{
-		  /* weed out all sections that run (more or less)
-		     exactly along the current v-line, nothing good
-		     comes of them */
-		  if((fabs(tt[ind+1] - v) < AY_EPSILON) &&
-		     (fabs(tt[ind+2+1] - v) < AY_EPSILON))
-		    continue;
-
-		  ipoint[0] = 0.0;
-		  ipoint[1] = 0.0;
-
-		  if((ay_stess_IntersectLines2D(&(tt[ind]),
-						&(tt[ind+2]),
-						p3, p4, ipoint)))
+		  /* v-line intersects with trimcurve */
+		  /* => add new point (but avoid consecutive
+		     equal points; those appear if a loop touches
+		     start or end of the current v-line) */
+		  if(!nisects || fabs(oldu - ipoint[0]) > AY_EPSILON)
 		    {
-		      /* v-line intersects with trimcurve */
-		      /* => add new point (but avoid consecutive
-			 equal points; those appear if a loop touches
-			 start or end of the current v-line) */
-		      if(!olduvp ||
-			 fabs(olduvp->u - ipoint[0]) > AY_EPSILON)
-			{
-			  if(!(newuvp = calloc(1, sizeof(ay_stess_uvp))))
-			    {
-			      ay_status = AY_EOMEM;
-			      goto cleanup;
-			    }
-			  newuvp->type = 1;
-			  newuvp->dir = tcsdirs[k];
-			  newuvp->u = ipoint[0];
-			  newuvp->v = ipoint[1];
-
-			  olduvp = newuvp;
-			  *nextuvp = newuvp;
-			  nextuvp = &(newuvp->next);
-			}
-		    } /* if have intersection */
-		} /* if is not parallel */
-	    } /* for */
+		      ay_status = ay_stess_AddIntersection(&isects,
+							   &isectslen,
+							   &nisects,
+							   tcsdirs[k],
+							   ipoint);
+		      if(ay_status)
+			goto cleanup;
+		      oldu = ipoint[0];
+		    }
+		} /* if have intersection */
+	    } /* if is not parallel */
 	} /* for */
 
-      u = umin;
-      nextuvp = &(uvps[i]);
-
-      if(trimuvp && trimuvp->next)
+      if(nisects > 1)
 	{
 	  /* we had trimloop points */
-	  ay_stess_SortIntersections(trimuvp, AY_TRUE);
-
-	  *nextuvp = trimuvp;
-	  nextuvp = &(trimuvp->next);
-	  nexttrimuvp = trimuvp->next;
-
-	  u = umin;
-	  while(u < trimuvp->u)
-	    u += ud;
-
-	  out = 0;
+	  ay_stess_SortIntersections(isects, nisects, AY_TRUE);
 
-	  while(nexttrimuvp)
-	    {
-	      while(u < (nexttrimuvp->u-4*AY_EPSILON))
-		{
-		  if(!out)
-		    {
-		      if(!(newuvp = calloc(1, sizeof(ay_stess_uvp))))
-			{
-			  ay_status = AY_EOMEM;
-			  goto cleanup;
-			}
-		      newuvp->u = u;
-		      newuvp->v = v;
-		      *nextuvp = newuvp;
-		      nextuvp = &(newuvp->next);
-		    }
-		  u += ud;
-		} /* while */
-
-	      out = !out;
-
-	      *nextuvp = nexttrimuvp;
-	      nextuvp = &(nexttrimuvp->next);
-
-	      nexttrimuvp = nexttrimuvp->next;
-	    } /* while */
-	}
-      else
-	{
-	  if(trimuvp)
-	    free(trimuvp);
+	  ay_status = ay_stess_MergeLine(isects, nisects, AY_TRUE,
+					 umin, ud, Cn+2, v, &(uvps[i]));
+	  if(ay_status)
+	    goto cleanup;
 	} /* if have multiple intersections */
 
       v += vd;
     } /* for */
 
   /* finally, calculate surfacepoints */
-  if(p->is_rat)
-    {
-      if(!(ders = malloc(
-	 ay_nb_FirstDerSurf4DMSize(p->uorder-1, p->vorder-1)*sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-    }
-  else
-    {
-      if(!(ders = malloc(
-	 ay_nb_FirstDerSurf3DMSize(p->uorder-1, p->vorder-1)*sizeof(double))))
-	{
-	  ay_status = AY_EOMEM;
-	  goto cleanup;
-	}
-    }
-
-  fd1 = &(ders[3]);
-  fd2 = &(ders[6]);
-
-  for(i = 0; i < Cm; i++)
-    {
-      uvpptr = uvps[i];
-
-      while(uvpptr)
-	{
-	  memset(ders, 0, 4*sizeof(double));
-
-	  if(p->is_rat)
-	    ay_nb_FirstDerSurf4DM(p->width-1, p->height-1,
-			       p->uorder-1, p->vorder-1, p->uknotv, p->vknotv,
-				  p->controlv, uvpptr->u, uvpptr->v, ders);
-	  else
-	    ay_nb_FirstDerSurf3DM(p->width-1, p->height-1,
-			       p->uorder-1, p->vorder-1, p->uknotv, p->vknotv,
-				  p->controlv, uvpptr->u, uvpptr->v, ders);
-
-	  memcpy(uvpptr->C, ders, 3*sizeof(double));
-
-	  AY_V3CROSS(temp, fd2, fd1);
-	  memcpy(&(uvpptr->C[3]), temp, 3*sizeof(double));
-	  if(uvpptr->next)
-	    {
-	      uvpptr->next->prev = uvpptr;
-	    }
-	  uvpptr = uvpptr->next;
-	} /* while */
-    } /* for */
-
-  free(ders);
+  ay_status = ay_stess_EvalLines(p, Cm, uvps);
+  if(ay_status)
+    goto cleanup;
 
   /* return result */
   *result = uvps;
@@ -2055,16 +2410,21 @@ cleanup:
     {
       for(i = 0; i < Cm; i++)
 	{
-	  while(uvps[i])
-	    {
-	      uvpptr = uvps[i]->next;
-	      free(uvps[i]);
-	      uvps[i] = uvpptr;
-	    }
+	  if(uvps[i])
+	    free(uvps[i]);
 	}
       free(uvps);
     }
 
+  if(isects)
+    free(isects);
+
+  if(offs)
+    free(offs);
+
+  if(segs)
+    free(segs);
+
  return ay_status;
 } /* ay_stess_TessTrimmedNPV */
 
@@ -2196,6 +2556,10 @@ ay_stess_ShadeTrimmedSurface(ay_stess_patch *stess)
 
   if(stess->pomesh)
     {
+      /* try the vertex buffer cache of the current view first */
+      if(!ay_vbo_shadestess(stess))
+	return;
+
       /* assume the pomesh is a triangle soup (from the tesselation) */
       po = stess->pomesh;
       glBegin(GL_TRIANGLES);
@@ -2582,6 +2946,9 @@ ay_stess_ShadeTrimmedSurface(ay_stess_patch *stess)
  * to a hole in the surface.
  * This way TessTrimmedNPU()/TessTrimmedNPV() can rely on the fact
  * that the first trim always designates the start of the surface.
+ * The boundary trim is created for each call (instead of being shared)
+ * so that patches may be tesselated in multiple threads; the caller
+ * has to remove it again using ay_stess_RemoveBoundaryTrim().
  *
  * \param[in,out] o  NURBS patch to process
  * \param[in,out] added  will be set to AY_TRUE if the boundary trim was added
@@ -2592,7 +2959,7 @@ int
 ay_stess_AddBoundaryTrim(ay_object *o, int *added)
 {
  int ay_status = AY_OK;
- ay_object *c = NULL;
+ ay_object *c = NULL, *b = NULL;
  ay_nurbpatch_object *np = NULL;
  ay_nurbcurve_object *nc = NULL;
  double umin, umax, vmin, vmax, *cv, a;
@@ -2634,9 +3001,17 @@ ay_stess_AddBoundaryTrim(ay_object *o, int *added)
       ay_nct_getorientation(nc, 4, 0, 0, &a);
       if(a < 0.0)
 	{
-	  ay_stess_boundarytrim->next = o->down;
-	  o->down = ay_stess_boundarytrim;
-	  nc = (ay_nurbcurve_object *)o->down->refine;
+	  if(!(b = calloc(1, sizeof(ay_object))))
+	    return AY_EOMEM;
+	  ay_status = ay_nct_create(2, 5, AY_KTNURB, NULL, NULL,
+				    (ay_nurbcurve_object **)&(b->refine));
+	  if(ay_status)
+	    { free(b); return ay_status; }
+	  ay_object_defaults(b);
+	  b->type = AY_IDNCURVE;
+	  b->next = o->down;
+	  o->down = b;
+	  nc = (ay_nurbcurve_object *)b->refine;
 	  cv = nc->controlv;
 	  cv[0] = umin;
 	  cv[1] = vmin;
@@ -2660,6 +3035,26 @@ ay_stess_AddBoundaryTrim(ay_object *o, int *added)
 } /* ay_stess_AddBoundaryTrim */
 
 
+/** ay_stess_RemoveBoundaryTrim:
+ * Remove and free the boundary trim curve added by
+ * ay_stess_AddBoundaryTrim().
+ *
+ * \param[in,out] o  NURBS patch to process
+ */
+void
+ay_stess_RemoveBoundaryTrim(ay_object *o)
+{
+ ay_object *b = o->down;
+
+  o->down = b->next;
+
+  ay_nct_destroy((ay_nurbcurve_object *)b->refine);
+  free(b);
+
+ return;
+} /* ay_stess_RemoveBoundaryTrim */
+
+
 /* ay_stess_TessTrimmedNP:
  *
  */
@@ -2736,7 +3131,7 @@ cleanup:
 
   if(boundadded)
     {
-      o->down = o->down->next;
+      ay_stess_RemoveBoundaryTrim(o);
     }
 
   if(ay_status)
@@ -2924,7 +3319,6 @@ ay_stess_TessNP(ay_object *o, int qf, ay_stess_patch *stess)
  int ay_status = AY_ERROR;
  char fname[] = "stess_TessNP";
  ay_nurbpatch_object *npatch;
- ay_object *p;
 
   if(!o)
     return AY_ENULL;
@@ -2934,19 +3328,6 @@ ay_stess_TessNP(ay_object *o, int qf, ay_stess_patch *stess)
   if(!npatch)
     return AY_ENULL;
 
-  if(!ay_stess_boundarytrim)
-    {
-      p = calloc(1, sizeof(ay_object));
-      ay_status = ay_nct_create(2, 5, AY_KTNURB, NULL, NULL,
-				(ay_nurbcurve_object **)&(p->refine));
-      if(ay_status)
-	{ free(p); return ay_status; }
-      ay_object_defaults(p);
-      p->type = AY_IDNCURVE;
-      ay_stess_boundarytrim = p;
-      ay_status = AY_ERROR;
-    }
-
   if(ay_npt_istrimmed(o, 0))
     {
       /* this is a nontrivially trimmed NURBS patch */
@@ -2998,6 +3379,14 @@ ay_stess_TessNP(ay_object *o, int qf, ay_stess_patch *stess)
     {
       ay_error(ay_status, fname, NULL);
     }
+  else
+    {
+      /* mark the new tesselation for caches (e.g. vbo.c) */
+      ay_stess_gen++;
+      if(!ay_stess_gen)
+	ay_stess_gen++;
+      stess->gen = ay_stess_gen;
+    }
 
  return ay_status;
 } /* ay_stess_TessNP */
@@ -12,8 +12,15 @@
 
 #include "ayam.h"
 
+#ifndef WIN32
+#include <pthread.h>
+#endif /* !WIN32 */
+
 /* tess.c NURBS (and PolyMesh) tesselation tools */
 
+/** maximum recursion depth of the adaptive native sampling */
+#define AY_TESSMAXDEPTH 10
+
 /* types local to this module */
 
 typedef struct ay_tess_listobject_s
@@ -91,6 +98,59 @@ typedef struct ay_curvetess_s {
   int vindex;
 } ay_curvetess;
 
+/** a vertex of a native tesselation */
+typedef struct ay_tess_nvert_s {
+  double uv[2]; /**< parametric coordinates */
+  double pn[6]; /**< point and normal */
+  double c[4]; /**< vertex color */
+  double t[2]; /**< texture coordinates */
+} ay_tess_nvert;
+
+/** a growing list of parametric values */
+typedef struct ay_tess_nlist_s {
+  double *v;
+  int n;
+  int a;
+} ay_tess_nlist;
+
+/** state of the native tesselation of a single NURBS patch */
+typedef struct ay_tess_native_s {
+  ay_nurbpatch_object *np;
+  double chord; /**< max. chordal deviation, <= 0.0: not checked */
+  double cosangle; /**< cosine of max. tangent angle, < -1.0: not checked */
+  double umin, umax, vmin, vmax; /**< parametric domain */
+  double *t; /**< scratch space for ay_tess_surfacepoint() */
+  double *N; /**< basis functions for PV data interpolation */
+  double *tc; /**< texture coordinates (from PV tag or synthesized) */
+  int tcvmajor; /**< are the texture coordinates in v-major order? */
+  double *vc; /**< vertex colors (from PV tag) */
+  int vcstride; /**< number of components per vertex color (3 or 4) */
+  double *vn; /**< vertex normals (from PV tag) */
+  ay_tess_nvert *verts; /**< all vertices */
+  unsigned int nverts, averts;
+  ay_tess_tri *tris; /**< resulting triangles */
+  ay_tess_tri **nexttri;
+  double *uv; /**< parametric coordinates of all triangle corners */
+  unsigned int ntris, atris;
+  int want_uv; /**< collect the parametric coordinates? */
+} ay_tess_native;
+
+#ifndef WIN32
+/** a number of NURBS patches to be tesselated natively in parallel */
+typedef struct ay_tess_batch_s {
+  int count; /**< number of objects */
+  int next; /**< next object to tesselate */
+  ay_object **objects; /**< objects, may contain NULL entries */
+  ay_object **results; /**< resulting PolyMesh objects */
+  int *status; /**< status of all tesselations */
+  pthread_mutex_t lock; /**< protects next */
+  double sparamu, sparamv;
+  int use_tc, use_vc, use_vn;
+  int primitives;
+  double quad_eps;
+} ay_tess_batch;
+#endif /* !WIN32 */
+
 /* prototypes of functions local to this module */
 
 
@@ -138,6 +198,56 @@ int ay_tess_tristopomesh(ay_tess_tri *tris,
 
 int ay_tess_isdegenatv1(ay_nurbpatch_object *np);
 
+int ay_tess_npatchglu(ay_object *o,
+		      int smethod, double sparamu, double sparamv,
+		      int use_tc, char *myst,
+		      int use_vc, char *mycs,
+		      int use_vn, char *myn,
+		      int refine_trims, int primitives, double quad_eps,
+		      ay_object **pm);
+
+int ay_tess_nlistadd(ay_tess_nlist *l, double v);
+
+void ay_tess_npoint(ay_tess_native *nt, double u, double v, double *pn,
+		    double *du, double *dv);
+
+int ay_tess_nisflat(ay_tess_native *nt, int dir, double a, double b,
+		    double w);
+
+int ay_tess_nrefine(ay_tess_native *nt, int dir, double a, double b,
+		    double *w, int nw, int depth, ay_tess_nlist *l);
+
+int ay_tess_nsample(ay_tess_native *nt, int dir, double *w, int nw,
+		    ay_tess_nlist *l);
+
+int ay_tess_ninit(ay_tess_native *nt, int dir, ay_tess_nlist *l);
+
+int ay_tess_npvdata(ay_tess_native *nt, ay_tess_nvert *vert);
+
+int ay_tess_naddvert(ay_tess_native *nt, double u, double v,
+		     unsigned int *index);
+
+int ay_tess_naddtri(ay_tess_native *nt, unsigned int i1, unsigned int i2,
+		    unsigned int i3);
+
+int ay_tess_nzip(ay_tess_native *nt, int dir,
+		 unsigned int *e, int ne, unsigned int *r, int nr);
+
+int ay_tess_npatchnative(ay_object *o, double sparamu, double sparamv,
+			 int use_tc, char *myst,
+			 int use_vc, char *mycs,
+			 int use_vn, char *myn,
+			 int primitives, double quad_eps,
+			 ay_object **pm);
+
+#ifndef WIN32
+void *ay_tess_npatchworker(void *data);
+
+int ay_tess_npatchbatch(ay_tess_batch *batch);
+
+void ay_tess_freebatch(ay_tess_batch *batch);
+#endif /* !WIN32 */
+
 
 void ay_tess_surfacepoint(ay_nurbpatch_object *np, double u, double v,
 			  double *t, double *p);
@@ -1019,6 +1129,9 @@ ay_tess_addtag(ay_object *o, char *val)
 
   tag->val = val;
 
+  /* store the data in binary form right away */
+  (void)ay_pv_tobinary(tag);
+
   tag->next = o->tags;
   o->tags = tag;
 
@@ -2764,211 +2877,1277 @@ cleanup:
 } /* ay_tess_tristopomesh */
 
 
-/* ay_tess_npatch:
- *  tesselate the NURBS patch object o into a PolyMesh object
- *  using the GLU (V1.3+) tesselation facility
- *  smethod - sampling method:
- *   1: GLU_OBJECT_PARAMETRIC_ERROR
- *   2: GLU_OBJECT_PATH_LENGTH
- *   3: GLU_DOMAIN_DISTANCE
- *   4: AY_NORMALIZED_DOMAIN_DISTANCE
- *   5: AY_ADAPTIVE_DOMAIN_DISTANCE
- *   6: AY_ADAPTIVE_KNOT_DISTANCE
- *  sparamu/sparamv - sampling parameters (sparamv only used by
- *  smethod 3 - 6)
- *  use_tc - use texture coordinates delivered by a PV tag
- *  myst - name of PV tag used for the texture coordinates
- *  use_vc - use vertex colors delivered by a PV tag
- *  mycs - name of PV tag used for the vertex colors
- *  use_vn - use vertex normals delivered by a PV tag
- *  myn - name of PV tag used for the vertex normals
- *  refine_trims - how many times shall the trim curves be refined
- *  primitives - what primitives to emit:
- *   0: Triangles
- *   1: Triangles&Quads
- *   2: Quads
- *   3: QuadrangulatedTriangles
- *  quad_eps: maximum deviation of triangle normals to be combined to a quad
- *  pm - resulting PolyMesh object
+/** ay_tess_nlistadd:
+ *  append a value to a list of parametric values
+ *
+ * \param[in,out] l  list to extend
+ * \param[in] v  value to append
+ *
+ * \returns AY_OK on success, error code otherwise.
  */
 int
-ay_tess_npatch(ay_object *o,
-	       int smethod, double sparamu, double sparamv,
-	       int use_tc, char *myst,
-	       int use_vc, char *mycs,
-	       int use_vn, char *myn,
-	       int refine_trims, int primitives, double quad_eps,
-	       ay_object **pm)
+ay_tess_nlistadd(ay_tess_nlist *l, double v)
 {
-#ifndef GLU_VERSION_1_3
- char fname[] = "tess_npatch";
- ay_error(AY_ERROR, fname, "This function is just available on GLU V1.3+ !");
- return AY_ERROR;
-#else
- int ay_status = AY_OK;
- ay_object *new = NULL, *newq = NULL;
- ay_nurbpatch_object *npatch = NULL;
- int uorder = 0, vorder = 0, width = 0, height = 0;
- int j, uknot_scount = 0, vknot_scount = 0;
- unsigned int uknot_count = 0, vknot_count = 0, i = 0, a = 0;
- GLfloat *uknots = NULL, *vknots = NULL, *controls = NULL;
- GLfloat *texcoords = NULL, *vcolors = NULL, *vnormals = NULL;
- GLfloat *vcolors4 = NULL, *tmp = NULL;
- unsigned int texcoordlen, vcolorlen, vnormallen;
- char have_tc = AY_FALSE, have_vc = AY_FALSE, have_vn = AY_FALSE;
- ay_tag *tag = NULL;
- ay_tess_object to = {0};
- double p1[3], p2[3], p3[3], p4[3], n1[3], n2[3], n3[3], n4[3];
- double t1[2], t2[2], t3[2], t4[2];
- double c1[4], c2[4], c3[4], c4[4];
- double knotlen, w, *tc = NULL, *uv = NULL;
- ay_tess_tri *tr1 = NULL, *tr2;
+ double *t;
+ int a;
 
-  if(!o || !pm)
-    return AY_ENULL;
+  if(l->n == l->a)
+    {
+      a = l->a?(l->a*2):64;
+      if(!(t = realloc(l->v, a*sizeof(double))))
+	return AY_EOMEM;
+      l->v = t;
+      l->a = a;
+    }
 
-  if(use_tc && !myst)
-    myst = ay_prefs.texcoordname;
+  l->v[l->n] = v;
+  l->n++;
 
-  if(use_vc && !mycs)
-    mycs = ay_prefs.colorname;
+ return AY_OK;
+} /* ay_tess_nlistadd */
 
-  if(use_vn && !myn)
-    myn = ay_prefs.normalname;
 
-  if(o->type != AY_IDNPATCH)
-    return AY_ERROR;
+/** ay_tess_npoint:
+ *  calculate a surface point, normal, and the first derivatives
+ *  for the native tesselation; if the normal is degenerate (e.g. at
+ *  a pole) it is taken from a point slightly moved towards the center
+ *  of the parametric domain
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in] u  parametric value in U (width)
+ * \param[in] v  parametric value in V (height)
+ * \param[in,out] pn  where to store the point and normal
+ * \param[in,out] du  where to store the derivative in U, may be NULL
+ * \param[in,out] dv  where to store the derivative in V, may be NULL
+ */
+void
+ay_tess_npoint(ay_tess_native *nt, double u, double v, double *pn,
+	       double *du, double *dv)
+{
+ double pd[6], *N, *Nd, uc, vc, f = 1.0e-4;
+ int i;
 
-  npatch = (ay_nurbpatch_object *)(o->refine);
+  memset(nt->t, 0, 4*sizeof(double));
+  ay_tess_surfacepoint(nt->np, u, v, nt->t, pn);
 
-  /* properly initialize tesselation object */
-  to.has_vn = AY_TRUE;
-  to.has_tc = use_tc;
-  to.p1 = p1;
-  to.p2 = p2;
-  to.p3 = p3;
-  to.p4 = p4;
-  to.n1 = n1;
-  to.n2 = n2;
-  to.n3 = n3;
-  to.n4 = n4;
+  if(du)
+    memcpy(du, &(nt->t[6]), 3*sizeof(double));
 
-  to.t1 = t1;
-  to.t2 = t2;
-  to.t3 = t3;
-  to.t4 = t4;
+  if(dv)
+    memcpy(dv, &(nt->t[3]), 3*sizeof(double));
 
-  to.c1 = c1;
-  to.c2 = c2;
-  to.c3 = c3;
-  to.c4 = c4;
+  N = &(pn[3]);
+  if(AY_V3LEN(N) > 0.5)
+    return;
 
-  to.nextpd = &(to.p1);
-  to.nextnd = &(to.n1);
-  to.nextcd = &(to.c1);
-  to.nexttd = &(to.t1);
+  Nd = &(pd[3]);
+  uc = (nt->umin+nt->umax)*0.5;
+  vc = (nt->vmin+nt->vmax)*0.5;
+  for(i = 0; i < 3; i++)
+    {
+      memset(nt->t, 0, 4*sizeof(double));
+      ay_tess_surfacepoint(nt->np, u+(uc-u)*f, v+(vc-v)*f, nt->t, pd);
+      if(AY_V3LEN(Nd) > 0.5)
+	{
+	  memcpy(N, Nd, 3*sizeof(double));
+	  break;
+	}
+      f *= 10.0;
+    }
 
-  /* convert npatch data from double to float */
-  uorder = npatch->uorder;
-  vorder = npatch->vorder;
-  width = npatch->width;
-  height = npatch->height;
+ return;
+} /* ay_tess_npoint */
 
-  uknot_count = width + uorder;
-  vknot_count = height + vorder;
 
-  if(!(uknots = calloc(uknot_count, sizeof(GLfloat))))
-    { ay_status = AY_EOMEM; goto cleanup; }
-  if(!(vknots = calloc(vknot_count, sizeof(GLfloat))))
-    { ay_status = AY_EOMEM; goto cleanup; }
-  if(!(controls = calloc(width*height*4, sizeof(GLfloat))))
-    { ay_status = AY_EOMEM; goto cleanup; }
+/** ay_tess_nisflat:
+ *  check, whether a section of an iso curve of the surface is
+ *  sufficiently represented by a single line segment
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in] dir  direction of the iso curve (0 - U, 1 - V)
+ * \param[in] a  start of the section
+ * \param[in] b  end of the section
+ * \param[in] w  parametric value of the iso curve in the other direction
+ *
+ * \returns AY_TRUE if the section is flat enough, AY_FALSE else
+ */
+int
+ay_tess_nisflat(ay_tess_native *nt, int dir, double a, double b, double w)
+{
+ double pa[6], pm[6], pb[6], ta[3], tm[3], tb[3], e[3], d[3];
+ double l, s, la, lm, lb, m = (a+b)*0.5;
 
-  a = 0;
-  for(i = 0; i < uknot_count; i++)
+  if(dir == 0)
     {
-      uknots[a] = (GLfloat)npatch->uknotv[a];
-      a++;
+      ay_tess_npoint(nt, a, w, pa, ta, NULL);
+      ay_tess_npoint(nt, m, w, pm, tm, NULL);
+      ay_tess_npoint(nt, b, w, pb, tb, NULL);
     }
-  a = 0;
-  for(i = 0; i < vknot_count; i++)
+  else
     {
-      vknots[a] = (GLfloat)npatch->vknotv[a];
-      a++;
+      ay_tess_npoint(nt, w, a, pa, NULL, ta);
+      ay_tess_npoint(nt, w, m, pm, NULL, tm);
+      ay_tess_npoint(nt, w, b, pb, NULL, tb);
     }
-  a = 0;
-  for(i = 0; i < (unsigned int)width*height; i++)
+
+  /* check chordal deviation of the midpoint */
+  if(nt->chord > 0.0)
     {
-      w = npatch->controlv[a+3];
-      controls[a] = (GLfloat)(npatch->controlv[a]*w);
-      a++;
-      controls[a] = (GLfloat)(npatch->controlv[a]*w);
-      a++;
-      controls[a] = (GLfloat)(npatch->controlv[a]*w);
-      a++;
-      controls[a] = (GLfloat)npatch->controlv[a];
-      a++;
+      AY_V3SUB(e, pb, pa);
+      AY_V3SUB(d, pm, pa);
+      l = AY_V3DOT(e, e);
+      if(l > AY_EPSILON*AY_EPSILON)
+	{
+	  s = AY_V3DOT(d, e)/l;
+	  d[0] -= s*e[0];
+	  d[1] -= s*e[1];
+	  d[2] -= s*e[2];
+	}
+      if(AY_V3LEN(d) > nt->chord)
+	return AY_FALSE;
     }
 
-#ifdef AYGLUATTRIBBUG
-  glPushAttrib((GLbitfield) GL_EVAL_BIT);
-#endif
+  /* check angles between the tangents */
+  if(nt->cosangle >= -1.0)
+    {
+      la = AY_V3LEN(ta);
+      lm = AY_V3LEN(tm);
+      lb = AY_V3LEN(tb);
 
-  if(npatch->no)
+      if(la > AY_EPSILON && lb > AY_EPSILON &&
+	 AY_V3DOT(ta, tb) < nt->cosangle*la*lb)
+	return AY_FALSE;
+
+      if(la > AY_EPSILON && lm > AY_EPSILON &&
+	 AY_V3DOT(ta, tm) < nt->cosangle*la*lm)
+	return AY_FALSE;
+
+      if(lm > AY_EPSILON && lb > AY_EPSILON &&
+	 AY_V3DOT(tm, tb) < nt->cosangle*lm*lb)
+	return AY_FALSE;
+    }
+
+ return AY_TRUE;
+} /* ay_tess_nisflat */
+
+
+/** ay_tess_nrefine:
+ *  recursively bisect a section of the parametric range until it
+ *  is flat on all given iso curves, appending the new parametric
+ *  values (but not \a a and \a b) to a list
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in] dir  direction to refine (0 - U, 1 - V)
+ * \param[in] a  start of the section
+ * \param[in] b  end of the section
+ * \param[in] w  parametric values of the iso curves to check
+ * \param[in] nw  number of elements in \a w
+ * \param[in] depth  current recursion depth
+ * \param[in,out] l  list to extend
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_nrefine(ay_tess_native *nt, int dir, double a, double b,
+		double *w, int nw, int depth, ay_tess_nlist *l)
+{
+ int ay_status = AY_OK;
+ int i;
+ double m;
+
+  if(depth >= AY_TESSMAXDEPTH)
+    return AY_OK;
+
+  for(i = 0; i < nw; i++)
     {
-      gluDeleteNurbsRenderer(npatch->no);
-      npatch->no = NULL;
+      if(!ay_tess_nisflat(nt, dir, a, b, w[i]))
+	break;
     }
 
-  npatch->no = gluNewNurbsRenderer();
-  if(npatch->no == NULL)
-    { ay_status = AY_EOMEM; goto cleanup; }
+  if(i == nw)
+    return AY_OK;
 
-  /* register error handling callback */
-  gluNurbsCallback(npatch->no, GLU_ERROR, AYGLUCBTYPE ay_error_glucb);
+  m = (a+b)*0.5;
 
-  /* set properties */
-  gluNurbsProperty(npatch->no, GLU_NURBS_MODE, GLU_NURBS_TESSELLATOR);
+  ay_status = ay_tess_nrefine(nt, dir, a, m, w, nw, depth+1, l);
+  if(ay_status)
+    return ay_status;
 
-  gluNurbsProperty(npatch->no, GLU_DISPLAY_MODE, GLU_FILL);
+  ay_status = ay_tess_nlistadd(l, m);
+  if(ay_status)
+    return ay_status;
 
-  /* set sampling method and parameter(s) */
-  switch(smethod)
+  ay_status = ay_tess_nrefine(nt, dir, m, b, w, nw, depth+1, l);
+
+ return ay_status;
+} /* ay_tess_nrefine */
+
+
+/** ay_tess_ninit:
+ *  create the initial sampling of one dimension of the surface:
+ *  all distinct knots in the parametric domain, spans of surfaces
+ *  of higher degree are additionally split into degree-1 pieces
+ *
+ * \param[in] nt  native tesselation state
+ * \param[in] dir  dimension to sample (0 - U, 1 - V)
+ * \param[in,out] l  list to fill
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_ninit(ay_tess_native *nt, int dir, ay_tess_nlist *l)
+{
+ int ay_status = AY_OK;
+ ay_nurbpatch_object *np = nt->np;
+ double *knots, k0, k1;
+ int i, j, n, order, pieces;
+
+  if(dir == 0)
     {
-    case 1:
-      gluNurbsProperty(npatch->no, GLU_SAMPLING_METHOD,
-		       GLU_OBJECT_PARAMETRIC_ERROR);
-      gluNurbsProperty(npatch->no, GLU_PARAMETRIC_TOLERANCE,
-		       (GLfloat)sparamu);
-      break;
-    case 2:
-      gluNurbsProperty(npatch->no, GLU_SAMPLING_METHOD,
-		       GLU_OBJECT_PATH_LENGTH);
-      gluNurbsProperty(npatch->no, GLU_SAMPLING_TOLERANCE,
-		       (GLfloat)sparamu);
-      break;
-    case 3:
-      /* use sparamu/sparamv unchanged */
-      break;
-    case 4:
-      /* U */
-      knotlen = npatch->uknotv[npatch->width] -
-	npatch->uknotv[npatch->uorder - 1];
-      sparamu = sparamu / knotlen;
-      /* V */
-      knotlen = npatch->vknotv[npatch->height] -
-	npatch->vknotv[npatch->vorder - 1];
-      sparamv = sparamv / knotlen;
-      break;
-    case 5:
-      /* U */
-      knotlen = npatch->uknotv[npatch->width] -
-	npatch->uknotv[npatch->uorder - 1];
-      sparamu = ((4 + npatch->width) * sparamu) / knotlen;
-      /* V */
-      knotlen = npatch->vknotv[npatch->height] -
-	npatch->vknotv[npatch->vorder -  1];
-      sparamv = ((4 + npatch->height) * sparamv) / knotlen;
+      knots = np->uknotv;
+      n = np->width;
+      order = np->uorder;
+    }
+  else
+    {
+      knots = np->vknotv;
+      n = np->height;
+      order = np->vorder;
+    }
+
+  pieces = order-2;
+  if(pieces < 1)
+    pieces = 1;
+
+  for(i = order-1; i < n; i++)
+    {
+      k0 = knots[i];
+      k1 = knots[i+1];
+      if(k1-k0 > AY_EPSILON)
+	{
+	  for(j = 0; j < pieces; j++)
+	    {
+	      ay_status = ay_tess_nlistadd(l, k0+(k1-k0)*j/(double)pieces);
+	      if(ay_status)
+		return ay_status;
+	    }
+	}
+    }
+
+  if(l->n == 0)
+    {
+      ay_status = ay_tess_nlistadd(l, knots[order-1]);
+      if(ay_status)
+	return ay_status;
+    }
+
+ return ay_tess_nlistadd(l, knots[n]);
+} /* ay_tess_ninit */
+
+
+/** ay_tess_nsample:
+ *  adaptively sample one dimension of the surface
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in] dir  dimension to sample (0 - U, 1 - V)
+ * \param[in] w  parametric values of the iso curves to check
+ * \param[in] nw  number of elements in \a w
+ * \param[in,out] l  list to fill
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_nsample(ay_tess_native *nt, int dir, double *w, int nw,
+		ay_tess_nlist *l)
+{
+ int ay_status = AY_OK;
+ ay_tess_nlist init = {0};
+ int i;
+
+  ay_status = ay_tess_ninit(nt, dir, &init);
+  if(ay_status)
+    goto cleanup;
+
+  for(i = 0; i < init.n-1; i++)
+    {
+      ay_status = ay_tess_nlistadd(l, init.v[i]);
+      if(ay_status)
+	goto cleanup;
+
+      ay_status = ay_tess_nrefine(nt, dir, init.v[i], init.v[i+1], w, nw,
+				  0, l);
+      if(ay_status)
+	goto cleanup;
+    }
+
+  ay_status = ay_tess_nlistadd(l, init.v[init.n-1]);
+
+cleanup:
+
+  if(init.v)
+    free(init.v);
+
+ return ay_status;
+} /* ay_tess_nsample */
+
+
+/** ay_tess_npvdata:
+ *  interpolate texture coordinates, vertex colors, and vertex normals
+ *  delivered by PV tags for a vertex of the native tesselation
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in,out] vert  vertex to process
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_npvdata(ay_tess_native *nt, ay_tess_nvert *vert)
+{
+ int ay_status = AY_OK;
+ ay_nurbpatch_object *np = nt->np;
+ double *Nu = nt->N, *Nv, *N, w, len;
+ int p = np->uorder-1, q = np->vorder-1;
+ int uspan, vspan, i, j, k, r, s;
+
+  Nv = Nu + np->uorder;
+
+  uspan = ay_nb_FindSpan(np->width-1, p, vert->uv[0], np->uknotv);
+  vspan = ay_nb_FindSpan(np->height-1, q, vert->uv[1], np->vknotv);
+
+  ay_status = ay_nb_BasisFuns(uspan, vert->uv[0], p, np->uknotv, Nu);
+  if(ay_status)
+    return ay_status;
+
+  ay_status = ay_nb_BasisFuns(vspan, vert->uv[1], q, np->vknotv, Nv);
+  if(ay_status)
+    return ay_status;
+
+  memset(vert->c, 0, 4*sizeof(double));
+  memset(vert->t, 0, 2*sizeof(double));
+
+  N = &(vert->pn[3]);
+  if(nt->vn)
+    {
+      AY_V3ZERO(N);
+    }
+
+  for(r = 0; r <= p; r++)
+    {
+      i = uspan-p+r;
+      for(s = 0; s <= q; s++)
+	{
+	  j = vspan-q+s;
+	  w = Nu[r]*Nv[s];
+
+	  if(nt->tc)
+	    {
+	      /* PV tag data is stored in u-major order */
+	      if(nt->tcvmajor)
+		k = (i*np->height+j)*2;
+	      else
+		k = (j*np->width+i)*2;
+	      vert->t[0] += w*nt->tc[k];
+	      vert->t[1] += w*nt->tc[k+1];
+	    }
+
+	  if(nt->vc)
+	    {
+	      k = (j*np->width+i)*nt->vcstride;
+	      vert->c[0] += w*nt->vc[k];
+	      vert->c[1] += w*nt->vc[k+1];
+	      vert->c[2] += w*nt->vc[k+2];
+	      if(nt->vcstride > 3)
+		vert->c[3] += w*nt->vc[k+3];
+	    }
+
+	  if(nt->vn)
+	    {
+	      k = (j*np->width+i)*3;
+	      N[0] += w*nt->vn[k];
+	      N[1] += w*nt->vn[k+1];
+	      N[2] += w*nt->vn[k+2];
+	    }
+	} /* for */
+    } /* for */
+
+  if(nt->vn)
+    {
+      len = AY_V3LEN(N);
+      if(len > AY_EPSILON)
+	AY_V3SCAL(N, 1.0/len);
+    }
+
+ return AY_OK;
+} /* ay_tess_npvdata */
+
+
+/** ay_tess_naddvert:
+ *  add a vertex to the native tesselation
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in] u  parametric value in U (width)
+ * \param[in] v  parametric value in V (height)
+ * \param[in,out] index  where to store the index of the new vertex
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_naddvert(ay_tess_native *nt, double u, double v,
+		 unsigned int *index)
+{
+ int ay_status = AY_OK;
+ ay_tess_nvert *t, *vert;
+ unsigned int a;
+
+  if(nt->nverts == nt->averts)
+    {
+      a = nt->averts?(nt->averts*2):256;
+      if(!(t = realloc(nt->verts, a*sizeof(ay_tess_nvert))))
+	return AY_EOMEM;
+      nt->verts = t;
+      nt->averts = a;
+    }
+
+  vert = &(nt->verts[nt->nverts]);
+  vert->uv[0] = u;
+  vert->uv[1] = v;
+
+  ay_tess_npoint(nt, u, v, vert->pn, NULL, NULL);
+
+  if(nt->tc || nt->vc || nt->vn)
+    {
+      ay_status = ay_tess_npvdata(nt, vert);
+      if(ay_status)
+	return ay_status;
+    }
+
+  *index = nt->nverts;
+  nt->nverts++;
+
+ return AY_OK;
+} /* ay_tess_naddvert */
+
+
+/** ay_tess_naddtri:
+ *  add a triangle to the native tesselation, the orientation
+ *  of the triangle is corrected as needed and degenerate triangles
+ *  are silently omitted
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in] i1  index of first vertex
+ * \param[in] i2  index of second vertex
+ * \param[in] i3  index of third vertex
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_naddtri(ay_tess_native *nt, unsigned int i1, unsigned int i2,
+		unsigned int i3)
+{
+ ay_tess_nvert *v1, *v2, *v3, *vt;
+ ay_tess_tri *tri;
+ double area, minarea, *t;
+ unsigned int a;
+
+  v1 = &(nt->verts[i1]);
+  v2 = &(nt->verts[i2]);
+  v3 = &(nt->verts[i3]);
+
+  area = (v2->uv[0]-v1->uv[0])*(v3->uv[1]-v1->uv[1]) -
+    (v2->uv[1]-v1->uv[1])*(v3->uv[0]-v1->uv[0]);
+
+  minarea = (nt->umax-nt->umin)*(nt->vmax-nt->vmin)*AY_EPSILON*AY_EPSILON;
+
+  if(fabs(area) < minarea)
+    return AY_OK;
+
+  /* omit triangles that collapse in space (e.g. at poles) */
+  if(AY_V3COMP(v1->pn, v2->pn) || AY_V3COMP(v2->pn, v3->pn) ||
+     AY_V3COMP(v3->pn, v1->pn))
+    return AY_OK;
+
+  /* the triangle must be counterclockwise in the parametric domain
+     to be counterclockwise around the surface normal */
+  if(area < 0.0)
+    {
+      vt = v2;
+      v2 = v3;
+      v3 = vt;
+    }
+
+  if(nt->want_uv && (nt->ntris == nt->atris))
+    {
+      a = nt->atris?(nt->atris*2):256;
+      if(!(t = realloc(nt->uv, a*6*sizeof(double))))
+	return AY_EOMEM;
+      nt->uv = t;
+      nt->atris = a;
+    }
+
+  if(!(tri = calloc(1, sizeof(ay_tess_tri))))
+    return AY_EOMEM;
+
+  memcpy(tri->p1, v1->pn, 3*sizeof(double));
+  memcpy(tri->p2, v2->pn, 3*sizeof(double));
+  memcpy(tri->p3, v3->pn, 3*sizeof(double));
+
+  memcpy(tri->n1, &(v1->pn[3]), 3*sizeof(double));
+  memcpy(tri->n2, &(v2->pn[3]), 3*sizeof(double));
+  memcpy(tri->n3, &(v3->pn[3]), 3*sizeof(double));
+
+  memcpy(tri->c1, v1->c, 4*sizeof(double));
+  memcpy(tri->c2, v2->c, 4*sizeof(double));
+  memcpy(tri->c3, v3->c, 4*sizeof(double));
+
+  memcpy(tri->t1, v1->t, 2*sizeof(double));
+  memcpy(tri->t2, v2->t, 2*sizeof(double));
+  memcpy(tri->t3, v3->t, 2*sizeof(double));
+
+  *(nt->nexttri) = tri;
+  nt->nexttri = &(tri->next);
+
+  if(nt->want_uv)
+    {
+      t = &(nt->uv[nt->ntris*6]);
+      memcpy(t, v1->uv, 2*sizeof(double));
+      memcpy(&(t[2]), v2->uv, 2*sizeof(double));
+      memcpy(&(t[4]), v3->uv, 2*sizeof(double));
+    }
+
+  nt->ntris++;
+
+ return AY_OK;
+} /* ay_tess_naddtri */
+
+
+/** ay_tess_nzip:
+ *  connect the samples of a boundary of the surface with the
+ *  adjacent row (or column) of the interior grid by a strip
+ *  of triangles
+ *
+ * \param[in,out] nt  native tesselation state
+ * \param[in] dir  direction of boundary and row (0 - U, 1 - V)
+ * \param[in] e  vertex indices of the boundary samples
+ * \param[in] ne  number of elements in \a e
+ * \param[in] r  vertex indices of the row
+ * \param[in] nr  number of elements in \a r
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_nzip(ay_tess_native *nt, int dir,
+	     unsigned int *e, int ne, unsigned int *r, int nr)
+{
+ int ay_status = AY_OK;
+ int i = 0, j = 0, advance_e;
+ double e0, ed, r0, rd, se, sr;
+
+  e0 = nt->verts[e[0]].uv[dir];
+  ed = nt->verts[e[ne-1]].uv[dir] - e0;
+  r0 = nt->verts[r[0]].uv[dir];
+  rd = nt->verts[r[nr-1]].uv[dir] - r0;
+
+  while(i < ne-1 || j < nr-1)
+    {
+      if(j == nr-1)
+	{
+	  advance_e = AY_TRUE;
+	}
+      else
+	{
+	  if(i == ne-1)
+	    {
+	      advance_e = AY_FALSE;
+	    }
+	  else
+	    {
+	      /* compare normalized parameters */
+	      se = (nt->verts[e[i+1]].uv[dir] - e0)/ed;
+	      sr = (nt->verts[r[j+1]].uv[dir] - r0)/rd;
+	      advance_e = (se <= sr);
+	    }
+	}
+
+      if(advance_e)
+	{
+	  ay_status = ay_tess_naddtri(nt, e[i], e[i+1], r[j]);
+	  i++;
+	}
+      else
+	{
+	  ay_status = ay_tess_naddtri(nt, e[i], r[j+1], r[j]);
+	  j++;
+	}
+
+      if(ay_status)
+	return ay_status;
+    } /* while */
+
+ return AY_OK;
+} /* ay_tess_nzip */
+
+
+/** ay_tess_npatchnative:
+ *  tesselate an untrimmed NURBS patch object into a PolyMesh object
+ *  natively (without GLU) in double precision;
+ *  the interior of the patch is sampled on a grid, adaptively refined
+ *  until the chordal deviation and the angle between the tangents of
+ *  adjacent samples on the iso curves of the initial sampling fall below
+ *  the given tolerances; the boundaries are sampled independently of
+ *  the interior, so that patches sharing a boundary curve get identical
+ *  boundary samples (no cracks) and are connected to the grid by strips
+ *  of triangles;
+ *  this function does not report errors and does not access the
+ *  Tcl interpreter, it may be called from multiple threads
+ *
+ * \param[in] o  NURBS patch object to tesselate
+ * \param[in] sparamu  maximum chordal deviation (in object space),
+ *  0.0 disables this check
+ * \param[in] sparamv  maximum angle between tangents (in degrees),
+ *  0.0 disables this check
+ * \param[in] use_tc  use texture coordinates delivered by a PV tag
+ * \param[in] myst  name of PV tag used for the texture coordinates
+ * \param[in] use_vc  use vertex colors delivered by a PV tag
+ * \param[in] mycs  name of PV tag used for the vertex colors
+ * \param[in] use_vn  use vertex normals delivered by a PV tag
+ * \param[in] myn  name of PV tag used for the vertex normals
+ * \param[in] primitives  what primitives to emit (see ay_tess_npatch())
+ * \param[in] quad_eps  maximum deviation of triangle normals to be
+ *  combined to a quad
+ * \param[in,out] pm  where to store the resulting PolyMesh object
+ *
+ * \returns AY_OK on success, error code otherwise.
+ */
+int
+ay_tess_npatchnative(ay_object *o, double sparamu, double sparamv,
+		     int use_tc, char *myst,
+		     int use_vc, char *mycs,
+		     int use_vn, char *myn,
+		     int primitives, double quad_eps,
+		     ay_object **pm)
+{
+ int ay_status = AY_OK;
+ ay_object *new = NULL, *newq = NULL;
+ ay_nurbpatch_object *np = NULL;
+ ay_tess_native nt = {0};
+ ay_tess_nlist uinit = {0}, vinit = {0}, ui = {0}, vi = {0};
+ ay_tess_nlist eb = {0}, et = {0}, el = {0}, er = {0};
+ ay_tess_tri *tr1, *tr2;
+ ay_tag *tag;
+ unsigned int *grid = NULL, *rowb = NULL, *rowt = NULL;
+ unsigned int *ib = NULL, *it = NULL, *il = NULL, *ir = NULL;
+ unsigned int c[4], len, k;
+ double *tmp;
+ int have_tc = AY_FALSE, have_vc = AY_FALSE, have_vn = AY_FALSE;
+ int i, j, nu, nv;
+
+  if(!o || !pm)
+    return AY_ENULL;
+
+  if(o->type != AY_IDNPATCH)
+    return AY_ERROR;
+
+  if(use_tc && !myst)
+    myst = ay_prefs.texcoordname;
+
+  if(use_vc && !mycs)
+    mycs = ay_prefs.colorname;
+
+  if(use_vn && !myn)
+    myn = ay_prefs.normalname;
+
+  np = (ay_nurbpatch_object *)(o->refine);
+
+  nt.np = np;
+  nt.chord = sparamu;
+  if(sparamv > 0.0 && sparamv < 180.0)
+    nt.cosangle = cos(AY_D2R(sparamv));
+  else
+    nt.cosangle = -2.0;
+  nt.umin = np->uknotv[np->uorder-1];
+  nt.umax = np->uknotv[np->width];
+  nt.vmin = np->vknotv[np->vorder-1];
+  nt.vmax = np->vknotv[np->height];
+  nt.nexttri = &(nt.tris);
+  nt.want_uv = (primitives == 3);
+
+  if((nt.umax - nt.umin <= AY_EPSILON) || (nt.vmax - nt.vmin <= AY_EPSILON))
+    return AY_ERROR;
+
+  if(!(nt.t = malloc(ay_nb_FirstDerSurf4DMSize(np->uorder-1, np->vorder-1) *
+		     sizeof(double))))
+    return AY_EOMEM;
+
+  /* get texture coordinates, vertex colors, and vertex normals */
+  tag = o->tags;
+  while(tag && (use_tc || use_vc || use_vn))
+    {
+      if(use_tc && !have_tc &&
+	 ay_pv_checkndt(tag, myst, "varying", "g"))
+	{
+	  have_tc = AY_TRUE;
+	  if(!ay_pv_convert(tag, 0, &len, (void**)(void*)&nt.tc) && nt.tc &&
+	     (len != (unsigned int)(np->width*np->height)))
+	    {
+	      free(nt.tc);
+	      nt.tc = NULL;
+	    }
+	}
+      else
+      if(use_vc && !have_vc &&
+	 (ay_pv_checkndt(tag, mycs, "varying", "c") ||
+	  ay_pv_checkndt(tag, mycs, "varying", "d")))
+	{
+	  have_vc = AY_TRUE;
+	  if(ay_pv_checkndt(tag, mycs, "varying", "c"))
+	    nt.vcstride = 3;
+	  else
+	    nt.vcstride = 4;
+	  if(!ay_pv_convert(tag, 0, &len, (void**)(void*)&nt.vc) && nt.vc &&
+	     (len != (unsigned int)(np->width*np->height)))
+	    {
+	      free(nt.vc);
+	      nt.vc = NULL;
+	    }
+	}
+      else
+      if(use_vn && !have_vn &&
+	 ay_pv_checkndt(tag, myn, "varying", "n"))
+	{
+	  have_vn = AY_TRUE;
+	  if(!ay_pv_convert(tag, 0, &len, (void**)(void*)&nt.vn) && nt.vn &&
+	     (len < (unsigned int)(np->width*np->height)))
+	    {
+	      if((tmp = realloc(nt.vn, np->width*np->height*3*
+				sizeof(double))))
+		{
+		  nt.vn = tmp;
+		  for(k = len; k < (unsigned int)(np->width*np->height); k++)
+		    {
+		      memcpy(&(nt.vn[k*3]), &(nt.vn[(len-1)*3]),
+			     3*sizeof(double));
+		    }
+		}
+	      else
+		{
+		  free(nt.vn);
+		  nt.vn = NULL;
+		}
+	    }
+	}
+
+      tag = tag->next;
+    } /* while */
+
+  /* synthesize texture coordinates? */
+  if(use_tc && !nt.tc)
+    {
+      ay_npt_gentexcoords(np, o->tags, &nt.tc);
+      nt.tcvmajor = AY_TRUE;
+    }
+
+  have_tc = (nt.tc != NULL);
+  have_vc = (nt.vc != NULL);
+
+  if(nt.tc || nt.vc || nt.vn)
+    {
+      if(!(nt.N = malloc((np->uorder+np->vorder)*sizeof(double))))
+	{ ay_status = AY_EOMEM; goto cleanup; }
+    }
+
+  /* the initial samplings also deliver the iso curves
+     against which the interior samplings are refined */
+  if((ay_status = ay_tess_ninit(&nt, 0, &uinit)))
+    goto cleanup;
+  if((ay_status = ay_tess_ninit(&nt, 1, &vinit)))
+    goto cleanup;
+
+  if((ay_status = ay_tess_nsample(&nt, 0, vinit.v, vinit.n, &ui)))
+    goto cleanup;
+  if((ay_status = ay_tess_nsample(&nt, 1, uinit.v, uinit.n, &vi)))
+    goto cleanup;
+
+  /* the boundaries are sampled on their own, only depending on
+     the boundary curves, to get crack free shared edges */
+  if((ay_status = ay_tess_nsample(&nt, 0, &nt.vmin, 1, &eb)))
+    goto cleanup;
+  if((ay_status = ay_tess_nsample(&nt, 0, &nt.vmax, 1, &et)))
+    goto cleanup;
+  if((ay_status = ay_tess_nsample(&nt, 1, &nt.umin, 1, &el)))
+    goto cleanup;
+  if((ay_status = ay_tess_nsample(&nt, 1, &nt.umax, 1, &er)))
+    goto cleanup;
+
+  /* make sure, the interior grid is not empty */
+  if(ui.n < 3)
+    {
+      ui.n = 0;
+      if((ay_status = ay_tess_nlistadd(&ui, nt.umin)))
+	goto cleanup;
+      if((ay_status = ay_tess_nlistadd(&ui, (nt.umin+nt.umax)*0.5)))
+	goto cleanup;
+      if((ay_status = ay_tess_nlistadd(&ui, nt.umax)))
+	goto cleanup;
+    }
+  if(vi.n < 3)
+    {
+      vi.n = 0;
+      if((ay_status = ay_tess_nlistadd(&vi, nt.vmin)))
+	goto cleanup;
+      if((ay_status = ay_tess_nlistadd(&vi, (nt.vmin+nt.vmax)*0.5)))
+	goto cleanup;
+      if((ay_status = ay_tess_nlistadd(&vi, nt.vmax)))
+	goto cleanup;
+    }
+
+  nu = ui.n-2;
+  nv = vi.n-2;
+
+  if(!(grid = malloc(nu*nv*sizeof(unsigned int))) ||
+     !(rowb = malloc(nu*sizeof(unsigned int))) ||
+     !(rowt = malloc(nu*sizeof(unsigned int))) ||
+     !(ib = malloc(eb.n*sizeof(unsigned int))) ||
+     !(it = malloc(et.n*sizeof(unsigned int))) ||
+     !(il = malloc(el.n*sizeof(unsigned int))) ||
+     !(ir = malloc(er.n*sizeof(unsigned int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  /* create the vertices of the interior grid */
+  for(i = 0; i < nu; i++)
+    {
+      for(j = 0; j < nv; j++)
+	{
+	  ay_status = ay_tess_naddvert(&nt, ui.v[i+1], vi.v[j+1],
+				       &(grid[i*nv+j]));
+	  if(ay_status)
+	    goto cleanup;
+	}
+      rowb[i] = grid[i*nv];
+      rowt[i] = grid[i*nv+nv-1];
+    }
+
+  /* create the vertices of the boundaries, sharing the corners */
+  if((ay_status = ay_tess_naddvert(&nt, nt.umin, nt.vmin, &(c[0]))))
+    goto cleanup;
+  if((ay_status = ay_tess_naddvert(&nt, nt.umax, nt.vmin, &(c[1]))))
+    goto cleanup;
+  if((ay_status = ay_tess_naddvert(&nt, nt.umax, nt.vmax, &(c[2]))))
+    goto cleanup;
+  if((ay_status = ay_tess_naddvert(&nt, nt.umin, nt.vmax, &(c[3]))))
+    goto cleanup;
+
+  ib[0] = c[0];
+  ib[eb.n-1] = c[1];
+  for(i = 1; i < eb.n-1; i++)
+    if((ay_status = ay_tess_naddvert(&nt, eb.v[i], nt.vmin, &(ib[i]))))
+      goto cleanup;
+
+  it[0] = c[3];
+  it[et.n-1] = c[2];
+  for(i = 1; i < et.n-1; i++)
+    if((ay_status = ay_tess_naddvert(&nt, et.v[i], nt.vmax, &(it[i]))))
+      goto cleanup;
+
+  il[0] = c[0];
+  il[el.n-1] = c[3];
+  for(i = 1; i < el.n-1; i++)
+    if((ay_status = ay_tess_naddvert(&nt, nt.umin, el.v[i], &(il[i]))))
+      goto cleanup;
+
+  ir[0] = c[1];
+  ir[er.n-1] = c[2];
+  for(i = 1; i < er.n-1; i++)
+    if((ay_status = ay_tess_naddvert(&nt, nt.umax, er.v[i], &(ir[i]))))
+      goto cleanup;
+
+  /* create the triangles of the interior grid */
+  for(i = 0; i < nu-1; i++)
+    {
+      for(j = 0; j < nv-1; j++)
+	{
+	  k = i*nv+j;
+	  ay_status = ay_tess_naddtri(&nt, grid[k], grid[k+nv],
+				      grid[k+nv+1]);
+	  if(ay_status)
+	    goto cleanup;
+	  ay_status = ay_tess_naddtri(&nt, grid[k+nv+1], grid[k+1],
+				      grid[k]);
+	  if(ay_status)
+	    goto cleanup;
+	}
+    }
+
+  /* connect the boundaries to the interior grid */
+  if((ay_status = ay_tess_nzip(&nt, 0, ib, eb.n, rowb, nu)))
+    goto cleanup;
+  if((ay_status = ay_tess_nzip(&nt, 0, it, et.n, rowt, nu)))
+    goto cleanup;
+  if((ay_status = ay_tess_nzip(&nt, 1, il, el.n, grid, nv)))
+    goto cleanup;
+  if((ay_status = ay_tess_nzip(&nt, 1, ir, er.n, &(grid[(nu-1)*nv]), nv)))
+    goto cleanup;
+
+  if(!nt.tris)
+    { ay_status = AY_ERROR; goto cleanup; }
+
+  /* convert the triangles to a PolyMesh object */
+  switch(primitives)
+    {
+    case 1:
+      /* Triangles and Quads */
+      ay_status = ay_tess_tristomixedpomesh(nt.tris, AY_TRUE, have_vc,
+					    have_tc, myst, mycs, quad_eps,
+					    &new);
+      break;
+    case 2:
+      /* Quads */
+      ay_status = ay_tess_tristoquadpomesh(nt.tris, AY_TRUE, have_vc,
+					   have_tc, myst, mycs, quad_eps,
+					   &new);
+      break;
+    case 3:
+      /* Quadrangulated Triangles */
+      ay_status = ay_tess_tristopomesh(nt.tris, AY_TRUE, have_vc, have_tc,
+				       myst, mycs, &new);
+      if(!ay_status && new)
+	{
+	  ay_status = ay_tess_quadrangulate(new, np, nt.uv, myst, &newq);
+
+	  ay_tags_delall(new);
+	  (void)ay_pomesht_destroy((ay_pomesh_object*)new->refine);
+	  free(new);
+	  new = newq;
+	}
+      break;
+    default:
+      /* Triangles */
+      ay_status = ay_tess_tristopomesh(nt.tris, AY_TRUE, have_vc, have_tc,
+				       myst, mycs, &new);
+      break;
+    } /* switch primitives */
+
+  if(ay_status || !new)
+    goto cleanup;
+
+  /* immediately optimize the polymesh (remove multiply used vertices) */
+  if(!primitives && !have_tc && !have_vc)
+    {
+      ay_status = ay_pomesht_optimizecoords((ay_pomesh_object*)new->refine,
+					    0.0, NULL, NULL, NULL);
+      if(ay_status)
+	goto cleanup;
+    }
+
+  /* return result */
+  *pm = new;
+  new = NULL;
+
+cleanup:
+
+  if(new)
+    {
+      ay_tags_delall(new);
+      (void)ay_pomesht_destroy((ay_pomesh_object*)new->refine);
+      free(new);
+    }
+
+  if(nt.t)
+    free(nt.t);
+  if(nt.N)
+    free(nt.N);
+  if(nt.tc)
+    free(nt.tc);
+  if(nt.vc)
+    free(nt.vc);
+  if(nt.vn)
+    free(nt.vn);
+  if(nt.verts)
+    free(nt.verts);
+  if(nt.uv)
+    free(nt.uv);
+
+  tr1 = nt.tris;
+  while(tr1)
+    {
+      tr2 = tr1;
+      tr1 = tr1->next;
+      free(tr2);
+    }
+
+  if(uinit.v)
+    free(uinit.v);
+  if(vinit.v)
+    free(vinit.v);
+  if(ui.v)
+    free(ui.v);
+  if(vi.v)
+    free(vi.v);
+  if(eb.v)
+    free(eb.v);
+  if(et.v)
+    free(et.v);
+  if(el.v)
+    free(el.v);
+  if(er.v)
+    free(er.v);
+
+  if(grid)
+    free(grid);
+  if(rowb)
+    free(rowb);
+  if(rowt)
+    free(rowt);
+  if(ib)
+    free(ib);
+  if(it)
+    free(it);
+  if(il)
+    free(il);
+  if(ir)
+    free(ir);
+
+ return ay_status;
+} /* ay_tess_npatchnative */
+
+
+/* ay_tess_npatch:
+ *  tesselate the NURBS patch object o into a PolyMesh object
+ *  using the GLU (V1.3+) tesselation facility or natively
+ *  smethod - sampling method:
+ *   1: GLU_OBJECT_PARAMETRIC_ERROR
+ *   2: GLU_OBJECT_PATH_LENGTH
+ *   3: GLU_DOMAIN_DISTANCE
+ *   4: AY_NORMALIZED_DOMAIN_DISTANCE
+ *   5: AY_ADAPTIVE_DOMAIN_DISTANCE
+ *   6: AY_ADAPTIVE_KNOT_DISTANCE
+ *   7: AY_ADAPTIVE_NATIVE (no GLU, see ay_tess_npatchnative();
+ *      trimmed patches are tesselated by GLU using
+ *      GLU_OBJECT_PARAMETRIC_ERROR and sparamu)
+ *  sparamu/sparamv - sampling parameters (sparamv only used by
+ *  smethod 3 - 7)
+ *  use_tc - use texture coordinates delivered by a PV tag
+ *  myst - name of PV tag used for the texture coordinates
+ *  use_vc - use vertex colors delivered by a PV tag
+ *  mycs - name of PV tag used for the vertex colors
+ *  use_vn - use vertex normals delivered by a PV tag
+ *  myn - name of PV tag used for the vertex normals
+ *  refine_trims - how many times shall the trim curves be refined
+ *  primitives - what primitives to emit:
+ *   0: Triangles
+ *   1: Triangles&Quads
+ *   2: Quads
+ *   3: QuadrangulatedTriangles
+ *  quad_eps: maximum deviation of triangle normals to be combined to a quad
+ *  pm - resulting PolyMesh object
+ */
+int
+ay_tess_npatch(ay_object *o,
+	       int smethod, double sparamu, double sparamv,
+	       int use_tc, char *myst,
+	       int use_vc, char *mycs,
+	       int use_vn, char *myn,
+	       int refine_trims, int primitives, double quad_eps,
+	       ay_object **pm)
+{
+
+  if(smethod == 7)
+    {
+      if(o && !(o->down && o->down->next))
+	return ay_tess_npatchnative(o, sparamu, sparamv,
+				    use_tc, myst, use_vc, mycs, use_vn, myn,
+				    primitives, quad_eps, pm);
+      smethod = 1;
+    }
+
+ return ay_tess_npatchglu(o, smethod, sparamu, sparamv,
+			  use_tc, myst, use_vc, mycs, use_vn, myn,
+			  refine_trims, primitives, quad_eps, pm);
+} /* ay_tess_npatch */
+
+
+/* ay_tess_npatchglu:
+ *  tesselate the NURBS patch object o into a PolyMesh object
+ *  using the GLU (V1.3+) tesselation facility
+ *  (see ay_tess_npatch() above for a description of the parameters)
+ */
+int
+ay_tess_npatchglu(ay_object *o,
+		  int smethod, double sparamu, double sparamv,
+		  int use_tc, char *myst,
+		  int use_vc, char *mycs,
+		  int use_vn, char *myn,
+		  int refine_trims, int primitives, double quad_eps,
+		  ay_object **pm)
+{
+#ifndef GLU_VERSION_1_3
+ char fname[] = "tess_npatch";
+ ay_error(AY_ERROR, fname, "This function is just available on GLU V1.3+ !");
+ return AY_ERROR;
+#else
+ int ay_status = AY_OK;
+ ay_object *new = NULL, *newq = NULL;
+ ay_nurbpatch_object *npatch = NULL;
+ int uorder = 0, vorder = 0, width = 0, height = 0;
+ int j, uknot_scount = 0, vknot_scount = 0;
+ unsigned int uknot_count = 0, vknot_count = 0, i = 0, a = 0;
+ GLfloat *uknots = NULL, *vknots = NULL, *controls = NULL;
+ GLfloat *texcoords = NULL, *vcolors = NULL, *vnormals = NULL;
+ GLfloat *vcolors4 = NULL, *tmp = NULL;
+ unsigned int texcoordlen, vcolorlen, vnormallen;
+ char have_tc = AY_FALSE, have_vc = AY_FALSE, have_vn = AY_FALSE;
+ ay_tag *tag = NULL;
+ ay_tess_object to = {0};
+ double p1[3], p2[3], p3[3], p4[3], n1[3], n2[3], n3[3], n4[3];
+ double t1[2], t2[2], t3[2], t4[2];
+ double c1[4], c2[4], c3[4], c4[4];
+ double knotlen, w, *tc = NULL, *uv = NULL;
+ ay_tess_tri *tr1 = NULL, *tr2;
+
+  if(!o || !pm)
+    return AY_ENULL;
+
+  if(use_tc && !myst)
+    myst = ay_prefs.texcoordname;
+
+  if(use_vc && !mycs)
+    mycs = ay_prefs.colorname;
+
+  if(use_vn && !myn)
+    myn = ay_prefs.normalname;
+
+  if(o->type != AY_IDNPATCH)
+    return AY_ERROR;
+
+  npatch = (ay_nurbpatch_object *)(o->refine);
+
+  /* properly initialize tesselation object */
+  to.has_vn = AY_TRUE;
+  to.has_tc = use_tc;
+  to.p1 = p1;
+  to.p2 = p2;
+  to.p3 = p3;
+  to.p4 = p4;
+  to.n1 = n1;
+  to.n2 = n2;
+  to.n3 = n3;
+  to.n4 = n4;
+
+  to.t1 = t1;
+  to.t2 = t2;
+  to.t3 = t3;
+  to.t4 = t4;
+
+  to.c1 = c1;
+  to.c2 = c2;
+  to.c3 = c3;
+  to.c4 = c4;
+
+  to.nextpd = &(to.p1);
+  to.nextnd = &(to.n1);
+  to.nextcd = &(to.c1);
+  to.nexttd = &(to.t1);
+
+  /* convert npatch data from double to float */
+  uorder = npatch->uorder;
+  vorder = npatch->vorder;
+  width = npatch->width;
+  height = npatch->height;
+
+  uknot_count = width + uorder;
+  vknot_count = height + vorder;
+
+  if(!(uknots = calloc(uknot_count, sizeof(GLfloat))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  if(!(vknots = calloc(vknot_count, sizeof(GLfloat))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  if(!(controls = calloc(width*height*4, sizeof(GLfloat))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  a = 0;
+  for(i = 0; i < uknot_count; i++)
+    {
+      uknots[a] = (GLfloat)npatch->uknotv[a];
+      a++;
+    }
+  a = 0;
+  for(i = 0; i < vknot_count; i++)
+    {
+      vknots[a] = (GLfloat)npatch->vknotv[a];
+      a++;
+    }
+  a = 0;
+  for(i = 0; i < (unsigned int)width*height; i++)
+    {
+      w = npatch->controlv[a+3];
+      controls[a] = (GLfloat)(npatch->controlv[a]*w);
+      a++;
+      controls[a] = (GLfloat)(npatch->controlv[a]*w);
+      a++;
+      controls[a] = (GLfloat)(npatch->controlv[a]*w);
+      a++;
+      controls[a] = (GLfloat)npatch->controlv[a];
+      a++;
+    }
+
+#ifdef AYGLUATTRIBBUG
+  glPushAttrib((GLbitfield) GL_EVAL_BIT);
+#endif
+
+  if(npatch->no)
+    {
+      gluDeleteNurbsRenderer(npatch->no);
+      npatch->no = NULL;
+    }
+
+  npatch->no = gluNewNurbsRenderer();
+  if(npatch->no == NULL)
+    { ay_status = AY_EOMEM; goto cleanup; }
+
+  /* register error handling callback */
+  gluNurbsCallback(npatch->no, GLU_ERROR, AYGLUCBTYPE ay_error_glucb);
+
+  /* set properties */
+  gluNurbsProperty(npatch->no, GLU_NURBS_MODE, GLU_NURBS_TESSELLATOR);
+
+  gluNurbsProperty(npatch->no, GLU_DISPLAY_MODE, GLU_FILL);
+
+  /* set sampling method and parameter(s) */
+  switch(smethod)
+    {
+    case 1:
+      gluNurbsProperty(npatch->no, GLU_SAMPLING_METHOD,
+		       GLU_OBJECT_PARAMETRIC_ERROR);
+      gluNurbsProperty(npatch->no, GLU_PARAMETRIC_TOLERANCE,
+		       (GLfloat)sparamu);
+      break;
+    case 2:
+      gluNurbsProperty(npatch->no, GLU_SAMPLING_METHOD,
+		       GLU_OBJECT_PATH_LENGTH);
+      gluNurbsProperty(npatch->no, GLU_SAMPLING_TOLERANCE,
+		       (GLfloat)sparamu);
+      break;
+    case 3:
+      /* use sparamu/sparamv unchanged */
+      break;
+    case 4:
+      /* U */
+      knotlen = npatch->uknotv[npatch->width] -
+	npatch->uknotv[npatch->uorder - 1];
+      sparamu = sparamu / knotlen;
+      /* V */
+      knotlen = npatch->vknotv[npatch->height] -
+	npatch->vknotv[npatch->vorder - 1];
+      sparamv = sparamv / knotlen;
+      break;
+    case 5:
+      /* U */
+      knotlen = npatch->uknotv[npatch->width] -
+	npatch->uknotv[npatch->uorder - 1];
+      sparamu = ((4 + npatch->width) * sparamu) / knotlen;
+      /* V */
+      knotlen = npatch->vknotv[npatch->height] -
+	npatch->vknotv[npatch->vorder -  1];
+      sparamv = ((4 + npatch->height) * sparamv) / knotlen;
       break;
     case 6:
       /* U */
@@ -3372,7 +4551,7 @@ cleanup:
 
  return ay_status;
 #endif
-} /* ay_tess_npatch */
+} /* ay_tess_npatchglu */
 
 
 /** ay_tess_isdegenatv1
@@ -3406,8 +4585,145 @@ ay_tess_isdegenatv1(ay_nurbpatch_object *np)
 } /* ay_tess_isdegenatv1 */
 
 
+#ifndef WIN32
+/** ay_tess_npatchworker:
+ *  tesselate NURBS patches from a batch until the batch is exhausted
+ *
+ * \param[in,out] data  the batch (ay_tess_batch)
+ *
+ * \returns NULL
+ */
+void *
+ay_tess_npatchworker(void *data)
+{
+ ay_tess_batch *batch = (ay_tess_batch *)data;
+ int i;
+
+  while(1)
+    {
+      pthread_mutex_lock(&batch->lock);
+      i = batch->next;
+      batch->next++;
+      pthread_mutex_unlock(&batch->lock);
+
+      if(i >= batch->count)
+	break;
+
+      if(!batch->objects[i])
+	continue;
+
+      batch->status[i] = ay_tess_npatchnative(batch->objects[i],
+					      batch->sparamu, batch->sparamv,
+					      batch->use_tc, NULL,
+					      batch->use_vc, NULL,
+					      batch->use_vn, NULL,
+					      batch->primitives,
+					      batch->quad_eps,
+					      &(batch->results[i]));
+    } /* while */
+
+ return NULL;
+} /* ay_tess_npatchworker */
+
+
+/** ay_tess_npatchbatch:
+ *  natively tesselate all NURBS patches of a batch in parallel,
+ *  using as many threads as configured for parallel notification
+ *
+ * \param[in,out] batch  the batch to process
+ *
+ * \returns AY_OK on success, error code otherwise.
+ *  (status of the individual tesselations is in batch->status)
+ */
+int
+ay_tess_npatchbatch(ay_tess_batch *batch)
+{
+ pthread_t *threads = NULL;
+ int i, nthreads;
+
+  nthreads = ay_notify_getnthreads();
+  if(nthreads > batch->count)
+    nthreads = batch->count;
+
+  if(nthreads > 1)
+    {
+      if(!(threads = malloc((nthreads-1)*sizeof(pthread_t))))
+	return AY_EOMEM;
+    }
+
+  if(pthread_mutex_init(&batch->lock, NULL))
+    {
+      if(threads)
+	free(threads);
+      return AY_ERROR;
+    }
+
+  batch->next = 0;
+
+  /* the main thread is one of the workers */
+  for(i = 0; i < nthreads-1; i++)
+    {
+      if(pthread_create(&(threads[i]), NULL, ay_tess_npatchworker, batch))
+	break;
+    }
+  nthreads = i;
+
+  (void)ay_tess_npatchworker(batch);
+
+  for(i = 0; i < nthreads; i++)
+    {
+      (void)pthread_join(threads[i], NULL);
+    }
+
+  pthread_mutex_destroy(&batch->lock);
+
+  if(threads)
+    free(threads);
+
+ return AY_OK;
+} /* ay_tess_npatchbatch */
+
+
+/** ay_tess_freebatch:
+ *  free a batch including all results not taken over yet
+ *
+ * \param[in,out] batch  the batch to free
+ */
+void
+ay_tess_freebatch(ay_tess_batch *batch)
+{
+ int i;
+
+  if(batch->results)
+    {
+      for(i = 0; i < batch->count; i++)
+	{
+	  if(batch->results[i])
+	    (void)ay_object_delete(batch->results[i]);
+	}
+      free(batch->results);
+    }
+
+  if(batch->objects)
+    free(batch->objects);
+
+  if(batch->status)
+    free(batch->status);
+
+  batch->objects = NULL;
+  batch->results = NULL;
+  batch->status = NULL;
+  batch->count = 0;
+
+ return;
+} /* ay_tess_freebatch */
+#endif /* !WIN32 */
+
+
 /* ay_tess_npatchtcmd:
- *  Tesselate selected NURBS patches (convert to PolyMesh) with GLU.
+ *  Tesselate selected NURBS patches (convert to PolyMesh) with GLU
+ *  or natively; with sampling method 7 all untrimmed patches are
+ *  tesselated in parallel.
  *  Implements the \a tessNP scripting interface command.
  *  Also implements the \a rtessNP scripting interface command.
  *  Also implements the \a stessNP scripting interface command.
@@ -3430,6 +4746,11 @@ ay_tess_npatchtcmd(ClientData clientData, Tcl_Interp *interp,
  int mode = 0;
  int degen = AY_FALSE, notify_parent = AY_FALSE;
  double et = 25.0;
+#ifndef WIN32
+ ay_tess_batch batch = {0};
+ int n = 0;
+#endif /* !WIN32 */
+ int i = 0;
 
   /* distinguish between
      tessNP and rtessNP */
@@ -3451,8 +4772,8 @@ ay_tess_npatchtcmd(ClientData clientData, Tcl_Interp *interp,
 	  if(smethod < 0)
 	    smethod = 0;
 	  else
-	    if(smethod > 6)
-	      smethod = 6;
+	    if(smethod > 7)
+	      smethod = 7;
 
 	  switch(smethod)
 	    {
@@ -3472,6 +4793,10 @@ ay_tess_npatchtcmd(ClientData clientData, Tcl_Interp *interp,
 	      sparamu = 3.0;
 	      sparamv = 3.0;
 	      break;
+	    case 7:
+	      sparamu = 0.01;
+	      sparamv = 15.0;
+	      break;
 	    default:
 	      break;
 	    } /* switch smethod */
@@ -3546,6 +4871,57 @@ ay_tess_npatchtcmd(ClientData clientData, Tcl_Interp *interp,
 	} /* switch mode */
     } /* if have args */
 
+#ifndef WIN32
+  /* natively tesselate all untrimmed patches in parallel upfront */
+  if(mode == 0 && smethod == 7)
+    {
+      while(sel)
+	{
+	  o = sel->object;
+	  if(o->type == AY_IDNPATCH && !(o->down && o->down->next))
+	    n++;
+	  i++;
+	  sel = sel->next;
+	}
+      sel = ay_selection;
+
+      if(n > 1)
+	{
+	  if(!(batch.objects = calloc(i, sizeof(ay_object*))) ||
+	     !(batch.results = calloc(i, sizeof(ay_object*))) ||
+	     !(batch.status = calloc(i, sizeof(int))))
+	    {
+	      ay_tess_freebatch(&batch);
+	      ay_error(AY_EOMEM, argv[0], NULL);
+	      return TCL_OK;
+	    }
+	  batch.count = i;
+	  batch.sparamu = sparamu;
+	  batch.sparamv = sparamv;
+	  batch.use_tc = use_tc;
+	  batch.use_vc = use_vc;
+	  batch.use_vn = use_vn;
+	  batch.primitives = primitives;
+	  batch.quad_eps = quad_eps;
+
+	  i = 0;
+	  while(sel)
+	    {
+	      o = sel->object;
+	      if(o->type == AY_IDNPATCH && !(o->down && o->down->next))
+		batch.objects[i] = o;
+	      i++;
+	      sel = sel->next;
+	    }
+	  sel = ay_selection;
+
+	  if(ay_tess_npatchbatch(&batch))
+	    ay_tess_freebatch(&batch);
+	}
+      i = 0;
+    }
+#endif /* !WIN32 */
+
   while(sel)
     {
       o = sel->object;
@@ -3556,6 +4932,15 @@ ay_tess_npatchtcmd(ClientData clientData, Tcl_Interp *interp,
 	  switch(mode)
 	    {
 	    case 0:
+#ifndef WIN32
+	      if(batch.count && batch.objects[i])
+		{
+		  ay_status = batch.status[i];
+		  new = batch.results[i];
+		  batch.results[i] = NULL;
+		  break;
+		}
+#endif /* !WIN32 */
 	      ay_status = ay_tess_npatch(o, smethod, sparamu, sparamv,
 					 use_tc, NULL,
 					 use_vc, NULL,
@@ -3597,6 +4982,9 @@ ay_tess_npatchtcmd(ClientData clientData, Tcl_Interp *interp,
 	  else
 	    {
 	      ay_error(AY_ERROR, argv[0], "Could not tesselate object!");
+#ifndef WIN32
+	      ay_tess_freebatch(&batch);
+#endif /* !WIN32 */
 	      return TCL_OK;
 	    }
 	}
@@ -3605,9 +4993,14 @@ ay_tess_npatchtcmd(ClientData clientData, Tcl_Interp *interp,
 	  ay_error(AY_EWTYPE, argv[0], "NPatch");
 	} /* if is NPatch */
 
+      i++;
       sel = sel->next;
     } /* while */
 
+#ifndef WIN32
+  ay_tess_freebatch(&batch);
+#endif /* !WIN32 */
+
   if(notify_parent)
     (void)ay_notify_parent();
 
@@ -108,6 +108,9 @@ void ay_ncurve_cacheflt(ay_nurbcurve_object *ncurve);
 /* npatch.c */
 void ay_npatch_drawboundary(ay_object *o, ay_tag *sbtag, unsigned int bound);
 
+int ay_npatch_drawinstances(struct Togl *togl, ay_object *o, int shade,
+			    unsigned int n, double *m);
+
 int ay_npatch_init(Tcl_Interp *interp);
 
 /* offnc.c */
@@ -159,6 +162,8 @@ int ay_sweep_init(Tcl_Interp *interp);
 int ay_swing_init(Tcl_Interp *interp);
 
 /* text.c */
+void ay_text_clearcache(void);
+
 int ay_text_init(Tcl_Interp *interp);
 
 /* torus.c */
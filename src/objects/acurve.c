@@ -370,14 +370,19 @@ ay_acurve_copycb(void *src, void **dst)
 
   memcpy(acurve, src, sizeof(ay_acurve_object));
 
-  /* copy controlv */
-  if(!(acurve->controlv = malloc(3 * acurve->length * sizeof(double))))
+  acurve->controlv = NULL;
+
+  /* copy controlv (undo copies are made without) */
+  if(acurvesrc->controlv)
     {
-      free(acurve);
-      return AY_EOMEM;
+      if(!(acurve->controlv = malloc(3 * acurve->length * sizeof(double))))
+	{
+	  free(acurve);
+	  return AY_EOMEM;
+	}
+      memcpy(acurve->controlv, acurvesrc->controlv,
+	     3 * acurve->length * sizeof(double));
     }
-  memcpy(acurve->controlv, acurvesrc->controlv,
-	 3 * acurve->length * sizeof(double));
 
   acurve->ncurve = NULL;
 
@@ -492,15 +492,18 @@ ay_apatch_copycb(void *src, void **dst)
 
   apatch->controlv = NULL;
 
-  /* copy controlv */
-  if(!(apatch->controlv = malloc(3 * apatch->width * apatch->height *
-				 sizeof(double))))
+  /* copy controlv (undo copies are made without) */
+  if(apatchsrc->controlv)
     {
-      ay_status = AY_EOMEM;
-      goto cleanup;
+      if(!(apatch->controlv = malloc(3 * apatch->width * apatch->height *
+				     sizeof(double))))
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
+      memcpy(apatch->controlv, apatchsrc->controlv,
+	     3 * apatch->width * apatch->height * sizeof(double));
     }
-  memcpy(apatch->controlv, apatchsrc->controlv,
-	 3 * apatch->width * apatch->height * sizeof(double));
 
   apatch->npatch = NULL;
   apatch->caps_and_bevels = NULL;
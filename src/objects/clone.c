@@ -25,6 +25,8 @@ int ay_clone_getpntcb(int mode, ay_object *o, double *p, ay_pointedit *pe);
 
 int ay_clone_notifycb(ay_object *o);
 
+int ay_clone_drawinstances(struct Togl *togl, ay_object *o, int shade);
+
 
 /* functions: */
 
@@ -136,6 +138,91 @@ ay_clone_copycb(void *src, void **dst)
 } /* ay_clone_copycb */
 
 
+/* ay_clone_drawinstances:
+ *  draw or shade all clones of clone object <o> with one call of the
+ *  draw/shade function for multiple instances of the master;
+ *  this is only possible if all clones are instances of the same
+ *  NURBS patch without visible children;
+ *  returns AY_OK if the clones were drawn, error code otherwise
+ *  (in this case nothing was drawn)
+ */
+int
+ay_clone_drawinstances(struct Togl *togl, ay_object *o, int shade)
+{
+ int ay_status = AY_OK, reset_color = AY_FALSE;
+ ay_clone_object *clone = (ay_clone_object *)o->refine;
+ ay_view_object *view = (ay_view_object *)Togl_GetClientData(togl);
+ ay_object *c = NULL, *m = NULL;
+ double *mats = NULL;
+ unsigned int i = 0, n = 0;
+ GLfloat oldcolor[4] = {0.0f,0.0f,0.0f,0.0f}, color[4] = {0.0f,0.0f,0.0f,0.0f};
+
+  c = clone->clones;
+  if(!c || c->type != AY_IDINSTANCE)
+    return AY_ERROR;
+
+  m = (ay_object *)c->refine;
+  if(!m || m->type != AY_IDNPATCH)
+    return AY_ERROR;
+
+  /* children of the master (e.g. trim curves) would need extra calls */
+  if(m->down && m->down->next && !m->hide_children)
+    return AY_ERROR;
+
+  if(!shade && view->drawobjectcs)
+    return AY_ERROR;
+
+  while(c)
+    {
+      if(c->type != AY_IDINSTANCE || c->refine != m ||
+	 (c->tags && ay_instance_hasrptrafo(c)))
+	return AY_ERROR;
+      if(!c->hide)
+	n++;
+      c = c->next;
+    }
+
+  if(!n)
+    return AY_OK;
+
+  if(!(mats = malloc(n*16*sizeof(double))))
+    return AY_EOMEM;
+
+  c = clone->clones;
+  while(c)
+    {
+      if(!c->hide)
+	{
+	  ay_trafo_creatematrix(c, &(mats[i*16]));
+	  i++;
+	}
+      c = c->next;
+    }
+
+  /* see ay_shade_object() */
+  if(shade && ay_prefs.use_materialcolor && m->mat && m->mat->colr != -1)
+    {
+      reset_color = AY_TRUE;
+      glGetMaterialfv(GL_FRONT, GL_AMBIENT, oldcolor);
+
+      color[0] = (GLfloat)(m->mat->colr/255.0);
+      color[1] = (GLfloat)(m->mat->colg/255.0);
+      color[2] = (GLfloat)(m->mat->colb/255.0);
+      color[3] = (GLfloat)1.0;
+      glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, color);
+    }
+
+  ay_status = ay_npatch_drawinstances(togl, m, shade, n, mats);
+
+  if(reset_color)
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, oldcolor);
+
+  free(mats);
+
+ return ay_status;
+} /* ay_clone_drawinstances */
+
+
 /* ay_clone_drawcb:
  *  draw (display in an Ayam view window) callback function of clone object
  */
@@ -153,6 +240,9 @@ ay_clone_drawcb(struct Togl *togl, ay_object *o)
   if(!clone)
     return AY_ENULL;
 
+  if(!ay_clone_drawinstances(togl, o, AY_FALSE))
+    return AY_OK;
+
   c = clone->clones;
   while(c)
     {
@@ -181,6 +271,9 @@ ay_clone_shadecb(struct Togl *togl, ay_object *o)
   if(!clone)
     return AY_ENULL;
 
+  if(!ay_clone_drawinstances(togl, o, AY_TRUE))
+    return AY_OK;
+
   c = clone->clones;
   while(c)
     {
@@ -482,14 +482,19 @@ ay_icurve_copycb(void *src, void **dst)
 
   memcpy(icurve, src, sizeof(ay_icurve_object));
 
-  /* copy controlv */
-  if(!(icurve->controlv = malloc(3 * icurve->length * sizeof(double))))
+  icurve->controlv = NULL;
+
+  /* copy controlv (undo copies are made without) */
+  if(icurvesrc->controlv)
     {
-      free(icurve);
-      return AY_EOMEM;
+      if(!(icurve->controlv = malloc(3 * icurve->length * sizeof(double))))
+	{
+	  free(icurve);
+	  return AY_EOMEM;
+	}
+      memcpy(icurve->controlv, icurvesrc->controlv,
+	     3 * icurve->length * sizeof(double));
     }
-  memcpy(icurve->controlv, icurvesrc->controlv,
-	 3 * icurve->length * sizeof(double));
 
   icurve->ncurve = NULL;
 
@@ -652,15 +652,18 @@ ay_ipatch_copycb(void *src, void **dst)
 
   ipatch->controlv = NULL;
 
-  /* copy controlv */
-  if(!(ipatch->controlv = malloc(3 * ipatch->width * ipatch->height *
-				 sizeof(double))))
+  /* copy controlv (undo copies are made without) */
+  if(ipatchsrc->controlv)
     {
-      ay_status = AY_EOMEM;
-      goto cleanup;
+      if(!(ipatch->controlv = malloc(3 * ipatch->width * ipatch->height *
+				     sizeof(double))))
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
+      memcpy(ipatch->controlv, ipatchsrc->controlv,
+	     3 * ipatch->width * ipatch->height * sizeof(double));
     }
-  memcpy(ipatch->controlv, ipatchsrc->controlv,
-	 3 * ipatch->width * ipatch->height * sizeof(double));
 
   /* copy derivatives */
   if(ipatch->derivs_u)
@@ -442,18 +442,21 @@ ay_ncurve_copycb(void *src, void **dst)
     }
   memcpy(ncurve->knotv, ncurvesrc->knotv, knot_count * sizeof(double));
 
-  /* copy controlv */
-  if(!(ncurve->controlv = malloc(4 * ncurve->length * sizeof(double))))
+  /* copy controlv (undo copies are made without) */
+  if(ncurvesrc->controlv)
     {
-      ay_status = AY_EOMEM;
-      goto cleanup;
+      if(!(ncurve->controlv = malloc(4 * ncurve->length * sizeof(double))))
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
+      memcpy(ncurve->controlv, ncurvesrc->controlv,
+	     4 * ncurve->length * sizeof(double));
     }
-  memcpy(ncurve->controlv, ncurvesrc->controlv,
-	 4 * ncurve->length * sizeof(double));
 
   /* copy mpoints */
   ncurve->mpoints = NULL;
-  if(ncurvesrc->mpoints)
+  if(ncurvesrc->mpoints && ncurve->controlv)
     {
       ay_nct_recreatemp(ncurve);
     }
@@ -1919,6 +1922,130 @@ ay_ncurve_writecb(FILE *fileptr, ay_object *o)
 } /* ay_ncurve_writecb */
 
 
+/* ay_ncurve_breadcb:
+ *  read (from binary scene file) callback function of ncurve object
+ */
+int
+ay_ncurve_breadcb(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_nurbcurve_object *ncurve = NULL;
+ int iv[3];
+
+  if(!fileptr || !o)
+    return AY_ENULL;
+
+  if(!(ncurve = calloc(1, sizeof(ay_nurbcurve_object))))
+    return AY_EOMEM;
+
+  /* length, order, knot_type */
+  if((ay_status = ay_bio_readuints(fileptr, 3, (unsigned int*)iv)))
+    { free(ncurve); return ay_status; }
+
+  ncurve->length = iv[0];
+  ncurve->order = iv[1];
+  ncurve->knot_type = iv[2];
+
+  if(ncurve->length < 2 || ncurve->order < 1)
+    { free(ncurve); return AY_ERROR; }
+
+  if(ncurve->knot_type == AY_KTCUSTOM)
+    {
+      if(!(ncurve->knotv = malloc((ncurve->length + ncurve->order)*
+				  sizeof(double))))
+	{ free(ncurve); return AY_EOMEM; }
+
+      ay_status = ay_bio_readdoubles(fileptr, ncurve->length + ncurve->order,
+				     ncurve->knotv);
+      if(ay_status)
+	{ free(ncurve->knotv); free(ncurve); return ay_status; }
+    }
+
+  if(!(ncurve->controlv = malloc(ncurve->length*4*sizeof(double))))
+    {
+      if(ncurve->knotv)
+	{ free(ncurve->knotv); }
+      free(ncurve);
+      return AY_EOMEM;
+    }
+
+  ay_status = ay_bio_readdoubles(fileptr, ncurve->length*4,
+				 ncurve->controlv);
+  ay_status += ay_bio_readint(fileptr, &(ncurve->type));
+  ay_status += ay_bio_readdoubles(fileptr, 1,
+				  &(ncurve->glu_sampling_tolerance));
+  ay_status += ay_bio_readint(fileptr, &(ncurve->display_mode));
+  ay_status += ay_bio_readint(fileptr, &(ncurve->createmp));
+  if(ay_status)
+    {
+      if(ncurve->knotv)
+	{ free(ncurve->knotv); }
+      free(ncurve->controlv);
+      free(ncurve);
+      return AY_EUEOF;
+    }
+
+  if(ncurve->createmp)
+    ay_nct_recreatemp(ncurve);
+
+  ncurve->is_rat = ay_nct_israt(ncurve);
+
+  if(ncurve->knot_type != AY_KTCUSTOM)
+    {
+      ay_status = ay_knots_createnc(ncurve);
+      if(ay_status)
+	{ free(ncurve->controlv); free(ncurve); return ay_status; }
+    }
+
+  o->refine = ncurve;
+
+ return AY_OK;
+} /* ay_ncurve_breadcb */
+
+
+/* ay_ncurve_bwritecb:
+ *  write (to binary scene file) callback function of ncurve object
+ */
+int
+ay_ncurve_bwritecb(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_nurbcurve_object *ncurve = NULL;
+ int iv[3];
+
+  if(!fileptr || !o)
+    return AY_ENULL;
+
+  ncurve = (ay_nurbcurve_object *)(o->refine);
+
+  if(!ncurve)
+    return AY_ENULL;
+
+  iv[0] = ncurve->length;
+  iv[1] = ncurve->order;
+  iv[2] = ncurve->knot_type;
+
+  ay_status = ay_bio_writeuints(fileptr, 3, (unsigned int*)iv);
+
+  if(ncurve->knot_type == AY_KTCUSTOM)
+    ay_status += ay_bio_writedoubles(fileptr, ncurve->length+ncurve->order,
+				     ncurve->knotv);
+
+  ay_status += ay_bio_writedoubles(fileptr, ncurve->length*4,
+				   ncurve->controlv);
+  ay_status += ay_bio_writeint(fileptr, ncurve->type);
+  ay_status += ay_bio_writedoubles(fileptr, 1,
+				   &(ncurve->glu_sampling_tolerance));
+  ay_status += ay_bio_writeint(fileptr, ncurve->display_mode);
+  ay_status += ay_bio_writeint(fileptr, ncurve->createmp);
+
+  if(ay_status)
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_ncurve_bwritecb */
+
+
 /* ay_ncurve_wribcb:
  *  RIB export callback function of ncurve object
  */
@@ -2128,6 +2255,9 @@ ay_ncurve_init(Tcl_Interp *interp)
 
   ay_status += ay_notify_register(ay_ncurve_notifycb, AY_IDNCURVE);
 
+  ay_status += ay_bio_register(ay_ncurve_breadcb, ay_ncurve_bwritecb,
+			       AY_IDNCURVE);
+
   /* ncurve objects may not be associated with materials */
   ay_matt_nomaterial(AY_IDNCURVE);
 
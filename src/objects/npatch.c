@@ -32,6 +32,9 @@ void ay_npatch_cacheflt(ay_nurbpatch_object *npatch);
 
 void ay_npatch_drawboundarych(ay_object *o, unsigned int bound);
 
+int ay_npatch_getstess(ay_view_object *view, ay_object *o, int lod,
+		       ay_stess_patch **result);
+
 int ay_npatch_drawstess(ay_view_object *view, ay_object *o);
 
 int ay_npatch_drawglu(ay_view_object *view, ay_object *o);
@@ -607,6 +610,10 @@ ay_npatch_copycb(void *src, void **dst)
   npatch->fltcv = NULL;
   npatch->breakv = NULL;
   memset(npatch->stess, 0, 2*sizeof(ay_stess_patch));
+  npatch->lods = NULL;
+  npatch->controlv = NULL;
+  npatch->uknotv = NULL;
+  npatch->vknotv = NULL;
 
   /* copy knots */
   kl = npatch->uorder + npatch->width;
@@ -625,19 +632,22 @@ ay_npatch_copycb(void *src, void **dst)
     }
   memcpy(npatch->vknotv, npatchsrc->vknotv, kl * sizeof(double));
 
-  /* copy controlv */
-  if(!(npatch->controlv = malloc(4 * npatch->width * npatch->height *
-				 sizeof(double))))
+  /* copy controlv (undo copies are made without) */
+  if(npatchsrc->controlv)
     {
-      ay_status = AY_EOMEM;
-      goto cleanup;
+      if(!(npatch->controlv = malloc(4 * npatch->width * npatch->height *
+				     sizeof(double))))
+	{
+	  ay_status = AY_EOMEM;
+	  goto cleanup;
+	}
+      memcpy(npatch->controlv, npatchsrc->controlv,
+	     4 * npatch->width * npatch->height * sizeof(double));
     }
-  memcpy(npatch->controlv, npatchsrc->controlv,
-	 4 * npatch->width * npatch->height * sizeof(double));
 
   /* copy mpoints */
   npatch->mpoints = NULL;
-  if(npatchsrc->mpoints)
+  if(npatchsrc->mpoints && npatch->controlv)
     {
       ay_npt_recreatemp(npatch);
     }
@@ -1499,18 +1509,21 @@ ay_npatch_drawboundary(ay_object *o, ay_tag *sbtag, unsigned int bound)
 } /* ay_npatch_drawboundary */
 
 
-/* ay_npatch_drawstess:
+/* ay_npatch_getstess:
  *  internal helper function
- *  draw the patch using STESS
+ *  get the (cached) STESS tesselation to draw or shade the patch with;
+ *  if <lod> is AY_TRUE and the LODTolerance preference setting is not 0,
+ *  patches that appear small in the view use a coarser level of detail
+ *  tesselation, whose edges are about LODTolerance pixels long
  */
 int
-ay_npatch_drawstess(ay_view_object *view, ay_object *o)
+ay_npatch_getstess(ay_view_object *view, ay_object *o, int lod,
+		   ay_stess_patch **result)
 {
  int ay_status = AY_OK;
- /*char fname[] = "npatch_drawstesscb";*/
- int a, i, j, tessw, tessh;
- double *tessv = NULL;
+ int i, n, level = 0, lqf = 1;
  int qf = ay_prefs.stess_qf;
+ double size = 0.0;
  ay_nurbpatch_object *npatch = (ay_nurbpatch_object *)o->refine;
  ay_stess_patch *stess;
 
@@ -1519,6 +1532,67 @@ ay_npatch_drawstess(ay_view_object *view, ay_object *o)
       qf = ay_stess_GetQF(npatch->glu_sampling_tolerance);
     }
 
+  if(lod && (ay_prefs.lod_tolerance > 0.0) && (qf > 1) &&
+     !ay_draw_getpixelsize(o, &size))
+    {
+      /* find the smallest quality factor where the tesselation edges
+	 are not longer than the tolerance (stess uses (4+n)*qf samples) */
+      n = 4 + AY_MAX(npatch->width, npatch->height);
+      while((lqf < qf) && (size/(n*lqf) > ay_prefs.lod_tolerance))
+	{
+	  lqf *= 2;
+	  level++;
+	}
+    }
+
+  if((lqf < qf) && (level < AY_STESSLODS))
+    {
+      if(!npatch->lods)
+	{
+	  if(!(npatch->lods = calloc(AY_STESSLODS, sizeof(ay_stess_patch))))
+	    return AY_EOMEM;
+	}
+
+      stess = &(npatch->lods[level]);
+
+      if(!stess->gen && !ay_draw_lodgenerate())
+	{
+	  /* use the nearest available tesselation until the
+	     missing level is created in a later redraw */
+	  for(i = 1; i < AY_STESSLODS; i++)
+	    {
+	      if((level-i >= 0) && npatch->lods[level-i].gen)
+		{
+		  *result = &(npatch->lods[level-i]);
+		  return AY_OK;
+		}
+	      if((level+i < AY_STESSLODS) && npatch->lods[level+i].gen)
+		{
+		  *result = &(npatch->lods[level+i]);
+		  return AY_OK;
+		}
+	    } /* for */
+
+	  if(npatch->stess[0].gen)
+	    {
+	      *result = &(npatch->stess[0]);
+	      return AY_OK;
+	    }
+	} /* if */
+
+      if(!stess->gen)
+	{
+	  ay_stess_destroy(stess);
+	  ay_status = ay_stess_TessNP(o, lqf, stess);
+	  if(ay_status)
+	    return ay_status;
+	}
+
+      *result = stess;
+
+      return AY_OK;
+    } /* if */
+
   /* select correct ay_stess_patch struct */
   stess = &(npatch->stess[0]);
 
@@ -1541,8 +1615,35 @@ ay_npatch_drawstess(ay_view_object *view, ay_object *o)
 	return ay_status;
     }
 
+  *result = stess;
+
+ return AY_OK;
+} /* ay_npatch_getstess */
+
+
+/* ay_npatch_drawstess:
+ *  internal helper function
+ *  draw the patch using STESS
+ */
+int
+ay_npatch_drawstess(ay_view_object *view, ay_object *o)
+{
+ int ay_status = AY_OK;
+ /*char fname[] = "npatch_drawstesscb";*/
+ int a, i, j, tessw, tessh;
+ double *tessv = NULL;
+ ay_stess_patch *stess;
+
+  ay_status = ay_npatch_getstess(view, o, AY_TRUE, &stess);
+  if(ay_status)
+    return ay_status;
+
   if(stess->tessv)
     {
+      /* try the vertex buffer cache of the current view first */
+      if(!ay_vbo_drawinstances(stess, AY_FALSE, 1, NULL))
+	return AY_OK;
+
       tessv = stess->tessv;
       tessw = stess->tessw;
       tessh = stess->tessh;
@@ -1580,6 +1681,58 @@ ay_npatch_drawstess(ay_view_object *view, ay_object *o)
 } /* ay_npatch_drawstess */
 
 
+/** ay_npatch_drawinstances:
+ *  draw or shade multiple instances of a NURBS patch at once from the
+ *  vertex buffer cache of the current view (see ay_vbo_drawinstances());
+ *  this is only possible if the patch is displayed using STESS and has
+ *  no caps or bevels; the level of detail tesselations are not used,
+ *  as the instances may be of different size in the view
+ *
+ * \param[in] togl  view to draw into
+ * \param[in] o  NURBS patch object to draw
+ * \param[in] shade  if AY_TRUE, shade the patch, else draw it
+ * \param[in] n  number of instances
+ * \param[in] m  transformation matrices of the instances [n*16]
+ *
+ * \returns AY_OK if all instances were drawn, error code otherwise
+ *  (in this case nothing was drawn)
+ */
+int
+ay_npatch_drawinstances(struct Togl *togl, ay_object *o, int shade,
+			unsigned int n, double *m)
+{
+ int ay_status = AY_OK;
+ int display_mode = ay_prefs.np_display_mode;
+ ay_nurbpatch_object *npatch;
+ ay_view_object *view = (ay_view_object *)Togl_GetClientData(togl);
+ ay_stess_patch *stess = NULL;
+
+  if(!o || !m)
+    return AY_ENULL;
+
+  npatch = (ay_nurbpatch_object *)o->refine;
+
+  if(!npatch)
+    return AY_ENULL;
+
+  if((npatch->display_mode != 0) && !view->action_state)
+    {
+      display_mode = npatch->display_mode-1;
+    }
+
+  if(display_mode != 3 || npatch->caps_and_bevels)
+    return AY_ERROR;
+
+  ay_status = ay_npatch_getstess(view, o, AY_FALSE, &stess);
+  if(ay_status)
+    return ay_status;
+
+  ay_status = ay_vbo_drawinstances(stess, shade, n, m);
+
+ return ay_status;
+} /* ay_npatch_drawinstances */
+
+
 /* ay_npatch_cacheflt
  *  internal helper function
  *  cache knots and control vertices as floats (for GLU)
@@ -2050,41 +2203,20 @@ int
 ay_npatch_shadestess(ay_view_object *view, ay_object *o)
 {
  int ay_status = AY_OK;
- int qf = ay_prefs.stess_qf;
  int a, b, i, j, tessw, tessh;
  double *tessv = NULL;
- ay_nurbpatch_object *npatch = (ay_nurbpatch_object *)o->refine;
  ay_stess_patch *stess;
 
-  if((npatch->glu_sampling_tolerance != 0.0) && !view->action_state)
-    {
-      qf = ay_stess_GetQF(npatch->glu_sampling_tolerance);
-    }
-
-  /* select correct ay_stess_patch struct */
-  stess = &(npatch->stess[0]);
-
-  /* in an action, we pick the second struct (unless the first
-     is already of the right qf) */
-  if(view->action_state && stess->qf != qf)
-    {
-      stess = &(npatch->stess[1]);
-    }
-
-  if(stess->qf != qf)
-    {
-      ay_stess_destroy(stess);
-    } /* if */
-
-  if(stess->qf != qf || stess->tessw == -1)
-    {
-      ay_status = ay_stess_TessNP(o, qf, stess);
-      if(ay_status)
-	return ay_status;
-    }
+  ay_status = ay_npatch_getstess(view, o, AY_TRUE, &stess);
+  if(ay_status)
+    return ay_status;
 
   if(stess->tessv)
     {
+      /* try the vertex buffer cache of the current view first */
+      if(!ay_vbo_shadestess(stess))
+	return AY_OK;
+
       tessv = stess->tessv;
       tessw = stess->tessw;
       tessh = stess->tessh;
@@ -3415,6 +3547,141 @@ ay_npatch_writecb(FILE *fileptr, ay_object *o)
 } /* ay_npatch_writecb */
 
 
+/* ay_npatch_breadcb:
+ *  read (from binary scene file) callback function of npatch object
+ */
+int
+ay_npatch_breadcb(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_nurbpatch_object *npatch = NULL;
+ int iv[6];
+
+  if(!fileptr || !o)
+    return AY_ENULL;
+
+  if(!(npatch = calloc(1, sizeof(ay_nurbpatch_object))))
+    return AY_EOMEM;
+
+  /* width, height, uorder, vorder, uknot_type, vknot_type */
+  if((ay_status = ay_bio_readuints(fileptr, 6, (unsigned int*)iv)))
+    { free(npatch); return ay_status; }
+
+  npatch->width = iv[0];
+  npatch->height = iv[1];
+  npatch->uorder = iv[2];
+  npatch->vorder = iv[3];
+  npatch->uknot_type = iv[4];
+  npatch->vknot_type = iv[5];
+
+  if(npatch->width < 2 || npatch->height < 2 ||
+     npatch->uorder < 1 || npatch->vorder < 1)
+    { free(npatch); return AY_ERROR; }
+
+  ay_status = ay_knots_createnp(npatch);
+  if(ay_status)
+    { free(npatch); return ay_status; }
+
+  if(npatch->uknot_type == AY_KTCUSTOM)
+    {
+      if(!(npatch->uknotv = malloc((npatch->width + npatch->uorder)*
+				   sizeof(double))))
+	{ ay_npt_destroy(npatch); return AY_EOMEM; }
+      ay_status = ay_bio_readdoubles(fileptr,
+				     npatch->width + npatch->uorder,
+				     npatch->uknotv);
+      if(ay_status)
+	{ ay_npt_destroy(npatch); return ay_status; }
+    }
+
+  if(npatch->vknot_type == AY_KTCUSTOM)
+    {
+      if(!(npatch->vknotv = malloc((npatch->height + npatch->vorder)*
+				   sizeof(double))))
+	{ ay_npt_destroy(npatch); return AY_EOMEM; }
+      ay_status = ay_bio_readdoubles(fileptr,
+				     npatch->height + npatch->vorder,
+				     npatch->vknotv);
+      if(ay_status)
+	{ ay_npt_destroy(npatch); return ay_status; }
+    }
+
+  if(!(npatch->controlv = malloc(npatch->width*npatch->height*4*
+				 sizeof(double))))
+    { ay_npt_destroy(npatch); return AY_EOMEM; }
+
+  ay_status = ay_bio_readdoubles(fileptr, npatch->width*npatch->height*4,
+				 npatch->controlv);
+  ay_status += ay_bio_readdoubles(fileptr, 1,
+				  &(npatch->glu_sampling_tolerance));
+  ay_status += ay_bio_readint(fileptr, &(npatch->display_mode));
+  ay_status += ay_bio_readint(fileptr, &(npatch->createmp));
+  if(ay_status)
+    { ay_npt_destroy(npatch); return AY_EUEOF; }
+
+  ay_npt_recreatemp(npatch);
+
+  npatch->is_rat = ay_npt_israt(npatch);
+
+  o->refine = npatch;
+
+  /* trigger attribute computation in notify callback */
+  o->modified = AY_TRUE;
+
+ return AY_OK;
+} /* ay_npatch_breadcb */
+
+
+/* ay_npatch_bwritecb:
+ *  write (to binary scene file) callback function of npatch object
+ */
+int
+ay_npatch_bwritecb(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_nurbpatch_object *npatch = NULL;
+ int iv[6];
+
+  if(!fileptr || !o)
+    return AY_ENULL;
+
+  npatch = (ay_nurbpatch_object *)(o->refine);
+
+  if(!npatch)
+    return AY_ENULL;
+
+  iv[0] = npatch->width;
+  iv[1] = npatch->height;
+  iv[2] = npatch->uorder;
+  iv[3] = npatch->vorder;
+  iv[4] = npatch->uknot_type;
+  iv[5] = npatch->vknot_type;
+
+  ay_status = ay_bio_writeuints(fileptr, 6, (unsigned int*)iv);
+
+  if(npatch->uknot_type == AY_KTCUSTOM)
+    ay_status += ay_bio_writedoubles(fileptr, npatch->width+npatch->uorder,
+				     npatch->uknotv);
+
+  if(npatch->vknot_type == AY_KTCUSTOM)
+    ay_status += ay_bio_writedoubles(fileptr, npatch->height+npatch->vorder,
+				     npatch->vknotv);
+
+  ay_status += ay_bio_writedoubles(fileptr, npatch->width*npatch->height*4,
+				   npatch->controlv);
+
+  ay_status += ay_bio_writedoubles(fileptr, 1,
+				   &(npatch->glu_sampling_tolerance));
+  ay_status += ay_bio_writeint(fileptr, npatch->display_mode);
+  ay_status += ay_bio_writeint(fileptr, npatch->createmp);
+
+  if(ay_status)
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_npatch_bwritecb */
+
+
 /* ay_npatch_wribtrimcurves
  *  internal helper function
  *  for ay_npatch_wribtrimcurves() below
@@ -4315,6 +4582,7 @@ ay_npatch_notifycb(ay_object *o)
   ay_stess_destroy(&(npatch->stess[0]));
   ay_stess_destroy(&(npatch->stess[1]));
   memset(npatch->stess, 0, 2*sizeof(ay_stess_patch));
+  ay_stess_destroylods(&(npatch->lods));
 
   if(npatch->display_mode != 0)
     {
@@ -4368,6 +4636,9 @@ ay_npatch_init(Tcl_Interp *interp)
 
   ay_status += ay_draw_registerdacb(ay_npatch_drawacb, AY_IDNPATCH);
 
+  ay_status += ay_bio_register(ay_npatch_breadcb, ay_npatch_bwritecb,
+			       AY_IDNPATCH);
+
   ay_status += ay_provide_register(ay_npatch_providecb, AY_IDNPATCH);
 
   ay_status += ay_convert_register(ay_npatch_convertcb, AY_IDNPATCH);
@@ -608,15 +608,18 @@ ay_pamesh_copycb(void *src, void **dst)
   pamesh->ubasis = NULL;
   pamesh->vbasis = NULL;
 
-  /* copy controlv */
-  if(!(pamesh->controlv = malloc(4 * pamesh->width * pamesh->height *
-				 sizeof(double))))
+  /* copy controlv (undo copies are made without) */
+  if(pameshsrc->controlv)
     {
-      free(pamesh);
-      return AY_EOMEM;
+      if(!(pamesh->controlv = malloc(4 * pamesh->width * pamesh->height *
+				     sizeof(double))))
+	{
+	  free(pamesh);
+	  return AY_EOMEM;
+	}
+      memcpy(pamesh->controlv, pameshsrc->controlv,
+	     4 * pamesh->width * pamesh->height * sizeof(double));
     }
-  memcpy(pamesh->controlv, pameshsrc->controlv,
-	 4 * pamesh->width * pamesh->height * sizeof(double));
 
   /* copy ubasis */
   if(pameshsrc->ubasis)
@@ -691,6 +691,10 @@ ay_pomesh_shadecb(struct Togl *togl, ay_object *o)
   if(!pomesh)
     return AY_ENULL;
 
+  /* notified meshes are cached in vertex buffer objects */
+  if(!ay_vbo_shadepomesh(pomesh, o->version))
+    return AY_OK;
+
   if(1/*o->modified*/)
     {
       ay_status = ay_pomesht_tesselate(pomesh);
@@ -1134,6 +1138,132 @@ ay_pomesh_writecb(FILE *fileptr, ay_object *o)
 } /* ay_pomesh_writecb */
 
 
+/* ay_pomesh_breadcb:
+ *  read (from binary scene file) callback function of pomesh object
+ */
+int
+ay_pomesh_breadcb(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_pomesh_object *pomesh = NULL;
+ unsigned int total_loops = 0, total_verts = 0, nc;
+
+  if(!fileptr || !o)
+   return AY_ENULL;
+
+  if(!(pomesh = calloc(1, sizeof(ay_pomesh_object))))
+    return AY_EOMEM;
+
+  if((ay_status = ay_bio_readint(fileptr, &pomesh->type)))
+    goto cleanup;
+  if((ay_status = ay_bio_readuint(fileptr, &pomesh->npolys)))
+    goto cleanup;
+  if(!(pomesh->nloops = calloc(pomesh->npolys+1, sizeof(unsigned int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  if((ay_status = ay_bio_readuints(fileptr, pomesh->npolys, pomesh->nloops)))
+    goto cleanup;
+
+  if((ay_status = ay_bio_readuint(fileptr, &total_loops)))
+    goto cleanup;
+  if(!(pomesh->nverts = calloc(total_loops+1, sizeof(unsigned int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  if((ay_status = ay_bio_readuints(fileptr, total_loops, pomesh->nverts)))
+    goto cleanup;
+
+  if((ay_status = ay_bio_readuint(fileptr, &total_verts)))
+    goto cleanup;
+  if(!(pomesh->verts = calloc(total_verts+1, sizeof(unsigned int))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  if((ay_status = ay_bio_readuints(fileptr, total_verts, pomesh->verts)))
+    goto cleanup;
+
+  /* read controlv */
+  if((ay_status = ay_bio_readuint(fileptr, &pomesh->ncontrols)))
+    goto cleanup;
+  if((ay_status = ay_bio_readint(fileptr, &pomesh->has_normals)))
+    goto cleanup;
+
+  nc = pomesh->ncontrols * 3 * (pomesh->has_normals?2:1);
+  if(!(pomesh->controlv = calloc(nc+1, sizeof(double))))
+    { ay_status = AY_EOMEM; goto cleanup; }
+  if((ay_status = ay_bio_readdoubles(fileptr, nc, pomesh->controlv)))
+    goto cleanup;
+
+  /* return result */
+  o->refine = pomesh;
+
+  /* prevent cleanup code from doing something harmful */
+  pomesh = NULL;
+
+cleanup:
+
+  if(pomesh)
+    {
+      if(pomesh->nloops)
+	free(pomesh->nloops);
+
+      if(pomesh->nverts)
+	free(pomesh->nverts);
+
+      if(pomesh->verts)
+	free(pomesh->verts);
+
+      if(pomesh->controlv)
+	free(pomesh->controlv);
+
+      free(pomesh);
+    }
+
+ return ay_status;
+} /* ay_pomesh_breadcb */
+
+
+/* ay_pomesh_bwritecb:
+ *  write (to binary scene file) callback function of pomesh object
+ */
+int
+ay_pomesh_bwritecb(FILE *fileptr, ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_pomesh_object *pomesh = NULL;
+ unsigned int total_loops = 0, total_verts = 0;
+ unsigned int i = 0;
+
+  if(!fileptr || !o)
+    return AY_ENULL;
+
+  pomesh = (ay_pomesh_object *)(o->refine);
+
+  if(!pomesh)
+    return AY_ENULL;
+
+  for(i = 0; i < pomesh->npolys; i++)
+    total_loops += pomesh->nloops[i];
+
+  for(i = 0; i < total_loops; i++)
+    total_verts += pomesh->nverts[i];
+
+  ay_status = ay_bio_writeint(fileptr, pomesh->type);
+  ay_status += ay_bio_writeuint(fileptr, pomesh->npolys);
+  ay_status += ay_bio_writeuints(fileptr, pomesh->npolys, pomesh->nloops);
+  ay_status += ay_bio_writeuint(fileptr, total_loops);
+  ay_status += ay_bio_writeuints(fileptr, total_loops, pomesh->nverts);
+  ay_status += ay_bio_writeuint(fileptr, total_verts);
+  ay_status += ay_bio_writeuints(fileptr, total_verts, pomesh->verts);
+
+  ay_status += ay_bio_writeuint(fileptr, pomesh->ncontrols);
+  ay_status += ay_bio_writeint(fileptr, pomesh->has_normals);
+  ay_status += ay_bio_writedoubles(fileptr, pomesh->ncontrols * 3 *
+				   (pomesh->has_normals?2:1),
+				   pomesh->controlv);
+
+  if(ay_status)
+    return AY_ERROR;
+
+ return AY_OK;
+} /* ay_pomesh_bwritecb */
+
+
 /* ay_pomesh_wribcb:
  *  RIB export callback function of pomesh object
  */
@@ -1427,6 +1557,9 @@ ay_pomesh_init(Tcl_Interp *interp)
 
   ay_status += ay_convert_register(ay_pomesh_convertcb, AY_IDPOMESH);
 
+  ay_status += ay_bio_register(ay_pomesh_breadcb, ay_pomesh_bwritecb,
+			       AY_IDPOMESH);
+
  return ay_status;
 } /* ay_pomesh_init */
 
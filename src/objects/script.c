@@ -25,6 +25,7 @@ static char *ay_script_array = "ScriptAttrData";
 static char *ay_script_sp = "SP"; /* Save (Individual) Parameters */
 static char *ay_script_sa = "array:"; /* Save Array */
 static char *ay_script_ul = "use:"; /* Use (Language) */
+static char *ay_script_uc = "cache:"; /* Use Cache */
 
 static Tcl_Obj *arrobj = NULL;
 static Tcl_Obj *actobj = NULL;
@@ -38,6 +39,16 @@ int ay_script_getsp(Tcl_Interp *interp, ay_object *o);
 
 int ay_script_getpntcb(int mode, ay_object *o, double *p, ay_pointedit *pe);
 
+int ay_script_getcache(ay_script_object *sc);
+
+void ay_script_getcachekey(ay_object *o, Tcl_DString *ds);
+
+int ay_script_compinputs(ay_object *o1, ay_object *o2);
+
+void ay_script_clearcache(ay_script_object *sc);
+
+void ay_script_savecache(ay_object *o, Tcl_DString *ds);
+
 int ay_script_notifycb(ay_object *o);
 
 int ay_script_hasnptrafo(ay_object *o);
@@ -255,6 +266,8 @@ ay_script_deletecb(void *c)
   if(sc->cm_objects)
     (void)ay_object_deletemulti(sc->cm_objects, AY_FALSE);
 
+  ay_script_clearcache(sc);
+
   /* free saved parameters */
   if(sc->params)
     {
@@ -297,6 +310,14 @@ ay_script_copycb(void *src, void **dst)
   scdst->pnts = NULL;
   scdst->pntslen = 0;
 
+  /* the copy starts with an empty cache */
+  scdst->cachekey = NULL;
+  scdst->cachekeylen = 0;
+  scdst->cacheinputs = NULL;
+  scdst->evaluations = 0;
+  scdst->cachehits = 0;
+  scdst->evaltime = 0.0;
+
   /* copy saved parameters */
   scdst->params = NULL;
   if(scdst->paramslen)
@@ -769,7 +790,7 @@ ay_script_setpropcb(Tcl_Interp *interp, int argc, char *argv[], ay_object *o)
 int
 ay_script_getpropcb(Tcl_Interp *interp, int argc, char *argv[], ay_object *o)
 {
- char *empty = "";
+ char *empty = "", buf[128];
  Tcl_Obj *to = NULL, *toa = NULL, *ton = NULL;
  ay_object *po;
  ay_script_object *sc = NULL;
@@ -799,6 +820,12 @@ ay_script_getpropcb(Tcl_Interp *interp, int argc, char *argv[], ay_object *o)
   Tcl_ObjSetVar2(interp, arrobj, scriptobj, to, TCL_LEAVE_ERR_MSG |
 		 TCL_GLOBAL_ONLY);
 
+  sprintf(buf, "%u runs (%.2f ms avg.), %u hits", sc->evaluations,
+	  sc->evaluations?sc->evaltime*1000.0/sc->evaluations:0.0,
+	  sc->cachehits);
+  Tcl_SetVar2Ex(interp, ay_script_array, "Statistics",
+		Tcl_NewStringObj(buf, -1), TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+
   /* handle script parameters */
   if(sc->params && sc->script &&
      (toa = ay_script_getdaname(sc->script, o)))
@@ -1238,6 +1265,209 @@ ay_script_getlanguage(ay_script_object *sc, char **lang)
 } /* ay_script_getlanguage */
 
 
+/* ay_script_getcache:
+ *  helper for notifycb; is caching enabled (process cache:)?
+ */
+int
+ay_script_getcache(ay_script_object *sc)
+{
+ char *lineend = NULL, *val = NULL;
+ int result = AY_FALSE;
+
+  if(!sc->script)
+    return AY_FALSE;
+
+  lineend = strchr(sc->script, '\n');
+  if(lineend)
+    *lineend = '\0';
+
+  if((val = strstr(sc->script, ay_script_uc)))
+    {
+      val = strchr(val, ':');
+      val++;
+      while(val[0] == ' ' || val[0] == '\t')
+	val++;
+
+      if(val[0] == 'y' || val[0] == 'Y' || val[0] == '1' ||
+	 ((val[0] == 'o' || val[0] == 'O') && (val[1] == 'n' || val[1] == 'N')))
+	result = AY_TRUE;
+    }
+
+  if(lineend)
+    *lineend = '\n';
+
+ return result;
+} /* ay_script_getcache */
+
+
+/* ay_script_getcachekey:
+ *  helper for notifycb; collect all inputs of the script that are
+ *  not child objects (type, script text, saved parameters, tags)
+ */
+void
+ay_script_getcachekey(ay_object *o, Tcl_DString *ds)
+{
+ ay_script_object *sc = (ay_script_object *)o->refine;
+ ay_tag *tag;
+ ay_btval *bv;
+ char buf[64];
+ int i, len;
+ char *str;
+
+  sprintf(buf, "%d", sc->type);
+  Tcl_DStringAppend(ds, buf, (int)strlen(buf)+1);
+  Tcl_DStringAppend(ds, sc->script, (int)strlen(sc->script)+1);
+
+  for(i = 0; i < sc->paramslen; i++)
+    {
+      str = Tcl_GetStringFromObj(sc->params[i], &len);
+      Tcl_DStringAppend(ds, str, len+1);
+    }
+
+  /* e.g. DA, BP, CP, or tags queried by the script
+     (binary values are prefixed by their size to keep the key
+     unambiguous; the tags of the children are compared completely
+     in ay_script_compinputs()) */
+  tag = o->tags;
+  while(tag)
+    {
+      if(tag->name)
+	Tcl_DStringAppend(ds, tag->name, (int)strlen(tag->name)+1);
+      if(tag->val)
+	{
+	  if(!tag->is_binary)
+	    {
+	      Tcl_DStringAppend(ds, tag->val, (int)strlen(tag->val)+1);
+	    }
+	  else
+	    {
+	      bv = (ay_btval *)tag->val;
+	      sprintf(buf, "%lu", (unsigned long)bv->size);
+	      Tcl_DStringAppend(ds, buf, (int)strlen(buf)+1);
+	      if(bv->size)
+		Tcl_DStringAppend(ds, (char *)bv->payload, (int)bv->size);
+	      else
+		Tcl_DStringAppend(ds, (char *)&(bv->payload), sizeof(void*));
+	    }
+	}
+      tag = tag->next;
+    } /* while */
+
+ return;
+} /* ay_script_getcachekey */
+
+
+/* ay_script_compinputs:
+ *  helper for notifycb; compare two lists of objects including all
+ *  children and all data the scripts may access; objects without
+ *  compare callback never compare equal
+ */
+int
+ay_script_compinputs(ay_object *o1, ay_object *o2)
+{
+ ay_script_object *sc1, *sc2;
+
+  while(o1 && o1->next && o2 && o2->next)
+    {
+      if((o1->type != o2->type) || (o1->hide != o2->hide) ||
+	 !ay_comp_trafos(o1, o2) || !ay_comp_tags(o1, o2) ||
+	 !ay_comp_objects(o1, o2))
+	return AY_FALSE;
+
+      if(o1->name && o2->name)
+	{
+	  if(strcmp(o1->name, o2->name))
+	    return AY_FALSE;
+	}
+      else
+	{
+	  if(o1->name != o2->name)
+	    return AY_FALSE;
+	}
+
+      if(!ay_script_compinputs(o1->down, o2->down))
+	return AY_FALSE;
+
+      /* script objects as children provide their created/modified objects */
+      if(o1->type == AY_IDSCRIPT)
+	{
+	  sc1 = (ay_script_object *)o1->refine;
+	  sc2 = (ay_script_object *)o2->refine;
+	  if(!ay_script_compinputs(sc1->cm_objects, sc2->cm_objects))
+	    return AY_FALSE;
+	}
+
+      o1 = o1->next;
+      o2 = o2->next;
+    } /* while */
+
+  /* both lists must end at the same time */
+  if((o1 && o1->next) || (o2 && o2->next))
+    return AY_FALSE;
+
+ return AY_TRUE;
+} /* ay_script_compinputs */
+
+
+/* ay_script_clearcache:
+ *  helper for notifycb; forget about the last evaluation
+ */
+void
+ay_script_clearcache(ay_script_object *sc)
+{
+
+  if(sc->cachekey)
+    free(sc->cachekey);
+  sc->cachekey = NULL;
+  sc->cachekeylen = 0;
+
+  if(sc->cacheinputs)
+    {
+      ay_instt_removeinstances(&sc->cacheinputs, NULL);
+      ay_matt_removeallrefs(sc->cacheinputs);
+      (void)ay_object_deletemulti(sc->cacheinputs, AY_FALSE);
+      sc->cacheinputs = NULL;
+    }
+
+ return;
+} /* ay_script_clearcache */
+
+
+/* ay_script_savecache:
+ *  helper for notifycb; remember the inputs of a successful evaluation
+ *  (key <ds> as created by ay_script_getcachekey() and the children)
+ */
+void
+ay_script_savecache(ay_object *o, Tcl_DString *ds)
+{
+ ay_script_object *sc = (ay_script_object *)o->refine;
+
+  ay_script_clearcache(sc);
+
+  if(sc->type == 2 && o->down && o->down->next)
+    {
+      if(ay_object_copymulti(o->down, &sc->cacheinputs) ||
+	 !ay_script_compinputs(o->down, sc->cacheinputs))
+	{
+	  /* the children can not be copied or compared,
+	     caching is impossible */
+	  ay_script_clearcache(sc);
+	  return;
+	}
+    }
+
+  if(!(sc->cachekey = malloc(Tcl_DStringLength(ds))))
+    {
+      ay_script_clearcache(sc);
+      return;
+    }
+  memcpy(sc->cachekey, Tcl_DStringValue(ds), Tcl_DStringLength(ds));
+  sc->cachekeylen = Tcl_DStringLength(ds);
+
+ return;
+} /* ay_script_savecache */
+
+
 /* ay_script_notifycb:
  *  notification callback function of script object
  */
@@ -1268,6 +1498,9 @@ ay_script_notifycb(ay_object *o)
  Tcl_Interp *interp = NULL;
  Tcl_HashTable *ht = &ay_languagesht;
  Tcl_HashEntry *entry = NULL;
+ Tcl_DString cds;
+ Tcl_Time t0, t1;
+ int cache = AY_FALSE;
 
   /* this lock protects ourselves from running in an endless
      recursive loop should the script modify our child objects
@@ -1312,6 +1545,27 @@ ay_script_notifycb(ay_object *o)
       goto cleanup;
     } /* if */
 
+  /* if caching is enabled and no input changed since the last
+     evaluation, just keep the created/modified objects */
+  if(sc->type > 0 && ay_script_getcache(sc))
+    {
+      cache = AY_TRUE;
+      Tcl_DStringInit(&cds);
+      ay_script_getcachekey(o, &cds);
+      if(sc->cachekey && (sc->cachekeylen == Tcl_DStringLength(&cds)) &&
+	 !memcmp(sc->cachekey, Tcl_DStringValue(&cds), sc->cachekeylen) &&
+	 ay_script_compinputs(o->down, sc->cacheinputs))
+	{
+	  sc->cachehits++;
+	  Tcl_DStringFree(&cds);
+	  cache = AY_FALSE;
+	  goto rdpnts;
+	}
+    }
+  ay_script_clearcache(sc);
+
+  Tcl_GetTime(&t0);
+
 #ifdef AYNOSAFEINTERP
   interp = ay_interp;
 #else
@@ -1684,6 +1938,11 @@ ay_script_notifycb(ay_object *o)
 
 resenv:
 
+  Tcl_GetTime(&t1);
+  sc->evaluations++;
+  sc->evaltime += (double)(t1.sec - t0.sec) +
+    (double)(t1.usec - t0.usec)/1000000.0;
+
   ay_notify_block(1, 0);
 
   if(ay_currentview)
@@ -1781,6 +2040,15 @@ resenv:
 	}
     } /* if */
 
+  if(cache)
+    {
+      if(result != TCL_ERROR && !ay_status && sc->active)
+	ay_script_savecache(o, &cds);
+      Tcl_DStringFree(&cds);
+    }
+
+rdpnts:
+
   /* manage read only points */
   if(sc->pntslen)
     {
@@ -763,7 +763,11 @@ ay_sdmesh_shadecb(struct Togl *togl, ay_object *o)
 
   if(sdmesh->pomesh)
     {
-      ay_shade_object(togl, sdmesh->pomesh, AY_FALSE);
+      /* the subdivided mesh is rebuilt on every notification
+	 of the SDMesh, so its version also identifies the mesh */
+      if(ay_vbo_shadepomesh((ay_pomesh_object *)sdmesh->pomesh->refine,
+			    o->version))
+	ay_shade_object(togl, sdmesh->pomesh, AY_FALSE);
     }
   else
     {
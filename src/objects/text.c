@@ -17,11 +17,33 @@
 
 static char *ay_text_name = "Text";
 
+/* maximum number of glyphs in the glyph cache */
+#define AY_TEXTMAXGLYPHS 1024
+
+/* an extruded letter in the glyph cache */
+typedef struct ay_text_glyph_s {
+  ay_object *npatch; /* extruded outlines */
+  ay_object *caps_and_bevels; /* caps and bevels */
+  double advance; /* horizontal advance to the next letter */
+} ay_text_glyph;
+
+/* the glyph cache, shared by all text objects, keyed by
+   font, letter, and extrusion parameters (see ay_text_glyphkey()) */
+static Tcl_HashTable ay_text_glyphs;
+
 
 /* prototypes of functions local to this module: */
 
 int ay_text_getpntcb(int mode, ay_object *o, double *p, ay_pointedit *pe);
 
+int ay_text_createglyph(ay_object *o, Tcl_UniChar c, ay_text_glyph *glyph);
+
+void ay_text_freeglyph(ay_text_glyph *glyph);
+
+int ay_text_glyphkey(ay_object *o, Tcl_UniChar c, Tcl_DString *key);
+
+int ay_text_copyglyph(ay_object *src, double xoffset, ay_object ***next);
+
 int ay_text_notifycb(ay_object *o);
 
 
@@ -797,14 +819,15 @@ ay_text_bbccb(ay_object *o, double *bbox, int *flags)
 } /* ay_text_bbccb */
 
 
-/* ay_text_notifycb:
- *  notification callback function of text object
+/* ay_text_createglyph:
+ *  get the outlines of letter <c> from the font of text object <o>
+ *  and extrude them (at the origin) to <glyph>
  */
 int
-ay_text_notifycb(ay_object *o)
+ay_text_createglyph(ay_object *o, Tcl_UniChar c, ay_text_glyph *glyph)
 {
  int ay_status = AY_OK;
- char fname[] = "text_notifycb";
+ char fname[] = "text_createglyph";
  int tti_status = 0;
  ay_text_object *text = NULL;
  ay_tti_letter letter = {0};
@@ -814,38 +837,12 @@ ay_text_notifycb(ay_object *o)
  ay_object *patch, **nextnpatch, **nextcb;
  ay_object ext = {0}, endlevel = {0};
  ay_extrude_object extrude = {0};
- Tcl_UniChar *uc;
  int i;
- double xoffset = 0.0, yoffset = 0.0;
-
-  if(!o)
-    return AY_ENULL;
 
   text = (ay_text_object *)o->refine;
 
-  if(!text)
-    return AY_ENULL;
-
-  if(text->npatch)
-    ay_status = ay_object_deletemulti(text->npatch, AY_FALSE);
-  text->npatch = NULL;
-  nextnpatch = &(text->npatch);
-
-  if(text->caps_and_bevels)
-    ay_status = ay_object_deletemulti(text->caps_and_bevels, AY_FALSE);
-  text->caps_and_bevels = NULL;
-  nextcb = &(text->caps_and_bevels);
-
-  /* always clear the old read only points */
-  if(text->pnts)
-    {
-      free(text->pnts);
-      text->pnts = NULL;
-    }
-
-  if(!text->fontname || (text->fontname[0] == '\0') ||
-     !text->unistring || (text->unistring[0] == 0))
-    goto cleanup;
+  nextnpatch = &(glyph->npatch);
+  nextcb = &(glyph->caps_and_bevels);
 
   ext.type = AY_IDEXTRUDE;
 
@@ -860,128 +857,56 @@ ay_text_notifycb(ay_object *o)
   extrude.display_mode = text->display_mode;
   extrude.glu_sampling_tolerance = text->glu_sampling_tolerance;
 
-  uc = text->unistring;
-  while(*uc != 0)
-    {
-      /*0x3071*/
-      tti_status = ay_tti_getcurves(text->fontname, *uc, &letter);
+  /*0x3071*/
+  tti_status = ay_tti_getcurves(text->fontname, c, &letter);
 
-      if(tti_status)
+  if(tti_status)
+    {
+      ay_error(AY_ERROR, fname, "could not get curves from font:");
+      switch(tti_status)
 	{
-	  ay_error(AY_ERROR, fname, "could not get curves from font:");
-	  switch(tti_status)
-	    {
-	    case AY_TTI_NOMEM:
-	      ay_error(AY_EOMEM, fname, NULL);
-	      break;
-	    case AY_TTI_NOTFOUND:
-	      ay_error(AY_EOPENFILE, fname, text->fontname);
-	      break;
-	    case AY_TTI_BADFONT:
-	      ay_error(AY_ERROR, fname, "bad font file, need TTF");
-	      break;
-	    default:
-	      break;
-	    } /* switch */
-	  ay_status = AY_ERROR;
-	  goto cleanup;
-	} /* if */
+	case AY_TTI_NOMEM:
+	  ay_error(AY_EOMEM, fname, NULL);
+	  break;
+	case AY_TTI_NOTFOUND:
+	  ay_error(AY_EOPENFILE, fname, text->fontname);
+	  break;
+	case AY_TTI_BADFONT:
+	  ay_error(AY_ERROR, fname, "bad font file, need TTF");
+	  break;
+	default:
+	  break;
+	} /* switch */
+      return AY_ERROR;
+    } /* if */
 
-      if(letter.numoutlines > 0)
+  if(letter.numoutlines > 0)
+    {
+      nexthole = &holes;
+      curve = NULL;
+      holes = NULL;
+      for(i = 0; i < letter.numoutlines; i++)
 	{
-	  nexthole = &holes;
-	  curve = NULL;
-	  holes = NULL;
-	  for(i = 0; i < letter.numoutlines; i++)
-	    {
-	      outline = &((letter.outlines)[i]);
-
-	      newcurve = NULL;
-	      ay_status = ay_tti_outlinetoncurve(outline, &newcurve);
-	      if(ay_status || !newcurve)
-		{
-		  ay_error(AY_ERROR, fname, "failed to convert outline:");
-		  ay_error(ay_status, fname, NULL);
-		  continue;
-		}
-
-	      newcurve->movx = xoffset;
-	      newcurve->movy = yoffset;
+	  outline = &((letter.outlines)[i]);
 
-	      if((text->revert?(outline->filled):(!outline->filled)))
-		{
-		  /* this outline is a true outline */
+	  newcurve = NULL;
+	  ay_status = ay_tti_outlinetoncurve(outline, &newcurve);
+	  if(ay_status || !newcurve)
+	    {
+	      ay_error(AY_ERROR, fname, "failed to convert outline:");
+	      ay_error(ay_status, fname, NULL);
+	      continue;
+	    }
 
-		  /* if there is already an outline in <curve>
-		     and possibly holes in <holes>
-		     we need to create patches from them now */
-		  if(curve)
-		    {
-		      if(holes)
-			{
-			  /* link the holes to the curve */
-			  curve->next = holes;
-			  /* terminate hierarchy */
-			  *nexthole = &endlevel;
-			}
-		      else
-			{
-			  /* terminate hierarchy */
-			  curve->next = &endlevel;
-			}
-		      ext.down = curve;
-		      extrude.npatch = NULL;
-		      extrude.caps_and_bevels = NULL;
-		      ay_notify_object(&ext);
-
-		      if(extrude.npatch)
-			{
-			  *nextnpatch = extrude.npatch;
-			  patch = extrude.npatch;
-			  while(patch)
-			    {
-			      nextnpatch = &(patch->next);
-			      patch = patch->next;
-			    } /* while */
-			} /* if */
-
-		      if(extrude.caps_and_bevels)
-			{
-			  *nextcb = extrude.caps_and_bevels;
-			  patch = extrude.caps_and_bevels;
-			  while(patch)
-			    {
-			      nextcb = &(patch->next);
-			      patch = patch->next;
-			    } /* while */
-			} /* if */
-
-		      /* free curve objects */
-		      if(holes)
-			{
-			  curve->next = NULL;
-			  *nexthole = NULL;
-			  (void)ay_object_deletemulti(holes, AY_FALSE);
-			  holes = NULL;
-			  nexthole = &(holes);
-			}
-		      (void)ay_object_delete(curve);
-		    } /* if(curve */
-
-		  curve = newcurve;
-		}
-	      else
-		{
-		  /* this "outline" is a hole, which we just append to the
-		     list of holes in <holes> */
-		  *nexthole = newcurve;
-		  nexthole = &(newcurve->next);
-		} /* if */
+	  if((text->revert?(outline->filled):(!outline->filled)))
+	    {
+	      /* this outline is a true outline */
 
-	      if((i == letter.numoutlines-1) && (curve))
+	      /* if there is already an outline in <curve>
+		 and possibly holes in <holes>
+		 we need to create patches from them now */
+	      if(curve)
 		{
-		  /* end of loop reached, but there is still an unconverted
-		     outline in <curve> => convert it to patches now */
 		  if(holes)
 		    {
 		      /* link the holes to the curve */
@@ -1030,39 +955,329 @@ ay_text_notifycb(ay_object *o)
 		      holes = NULL;
 		      nexthole = &(holes);
 		    }
-
 		  (void)ay_object_delete(curve);
-		  curve = NULL;
+		} /* if(curve */
+
+	      curve = newcurve;
+	    }
+	  else
+	    {
+	      /* this "outline" is a hole, which we just append to the
+		 list of holes in <holes> */
+	      *nexthole = newcurve;
+	      nexthole = &(newcurve->next);
+	    } /* if */
+
+	  if((i == letter.numoutlines-1) && (curve))
+	    {
+	      /* end of loop reached, but there is still an unconverted
+		 outline in <curve> => convert it to patches now */
+	      if(holes)
+		{
+		  /* link the holes to the curve */
+		  curve->next = holes;
+		  /* terminate hierarchy */
+		  *nexthole = &endlevel;
+		}
+	      else
+		{
+		  /* terminate hierarchy */
+		  curve->next = &endlevel;
+		}
+	      ext.down = curve;
+	      extrude.npatch = NULL;
+	      extrude.caps_and_bevels = NULL;
+	      ay_notify_object(&ext);
+
+	      if(extrude.npatch)
+		{
+		  *nextnpatch = extrude.npatch;
+		  patch = extrude.npatch;
+		  while(patch)
+		    {
+		      nextnpatch = &(patch->next);
+		      patch = patch->next;
+		    } /* while */
+		} /* if */
+
+	      if(extrude.caps_and_bevels)
+		{
+		  *nextcb = extrude.caps_and_bevels;
+		  patch = extrude.caps_and_bevels;
+		  while(patch)
+		    {
+		      nextcb = &(patch->next);
+		      patch = patch->next;
+		    } /* while */
 		} /* if */
 
-	      if((i == letter.numoutlines-1) && (holes))
+	      /* free curve objects */
+	      if(holes)
 		{
-		  /* end of loop reached, but there are unconverted holes;
-		     this is probably caused by broken orientation detection;
-		     we need to free all the curves in <holes> (and inform the
-		     user?) */
-		  ay_error(AY_EWARN, fname,
-		     "Could not convert all outlines, please try Revert.");
+		  curve->next = NULL;
+		  *nexthole = NULL;
 		  (void)ay_object_deletemulti(holes, AY_FALSE);
 		  holes = NULL;
 		  nexthole = &(holes);
 		}
 
-	    } /* for */
-	} /* if */
+	      (void)ay_object_delete(curve);
+	      curve = NULL;
+	    } /* if */
 
-      xoffset = letter.xoffset;
-      /*yoffset = letter.yoffset;*/
+	  if((i == letter.numoutlines-1) && (holes))
+	    {
+	      /* end of loop reached, but there are unconverted holes;
+		 this is probably caused by broken orientation detection;
+		 we need to free all the curves in <holes> (and inform the
+		 user?) */
+	      ay_error(AY_EWARN, fname,
+		 "Could not convert all outlines, please try Revert.");
+	      (void)ay_object_deletemulti(holes, AY_FALSE);
+	      holes = NULL;
+	      nexthole = &(holes);
+	    }
 
-      for(i = 0; i < letter.numoutlines; i++)
+	} /* for */
+    } /* if */
+
+  glyph->advance = letter.xoffset;
+
+  for(i = 0; i < letter.numoutlines; i++)
+    {
+      outline = &((letter.outlines)[i]);
+      if(outline->points)
+	free(outline->points);
+    }
+  if(letter.outlines)
+    free(letter.outlines);
+
+ return AY_OK;
+} /* ay_text_createglyph */
+
+
+/* ay_text_freeglyph:
+ *  free the extrusions, caps, and bevels of a glyph and the glyph itself
+ */
+void
+ay_text_freeglyph(ay_text_glyph *glyph)
+{
+
+  if(!glyph)
+    return;
+
+  if(glyph->npatch)
+    (void)ay_object_deletemulti(glyph->npatch, AY_FALSE);
+
+  if(glyph->caps_and_bevels)
+    (void)ay_object_deletemulti(glyph->caps_and_bevels, AY_FALSE);
+
+  free(glyph);
+
+ return;
+} /* ay_text_freeglyph */
+
+
+/* ay_text_glyphkey:
+ *  compile the key of letter <c> of text object <o> in the glyph cache
+ *  to <key>; the key covers the font and all parameters that influence
+ *  the extrusion of the glyph (including BP tags)
+ *  returns AY_FALSE if the glyph may not be cached, because a bevel
+ *  uses a custom cross section curve from the scene
+ */
+int
+ay_text_glyphkey(ay_object *o, Tcl_UniChar c, Tcl_DString *key)
+{
+ ay_text_object *text = NULL;
+ ay_bparam bparams = {0};
+ ay_tag *tag;
+ char buf[256];
+ int i;
+
+  text = (ay_text_object *)o->refine;
+
+  ay_bevelt_parsetags(o->tags, &bparams);
+  for(i = 0; i < 4; i++)
+    {
+      if(bparams.states[i] && bparams.types[i] < 0)
+	return AY_FALSE;
+    }
+
+  sprintf(buf, "%d,%d,%d,%d,%d,%.17g,%.17g,", (int)c, text->revert,
+	  text->has_upper_cap, text->has_lower_cap, text->display_mode,
+	  text->height, text->glu_sampling_tolerance);
+  Tcl_DStringAppend(key, buf, -1);
+  Tcl_DStringAppend(key, text->fontname, -1);
+
+  tag = o->tags;
+  while(tag)
+    {
+      if(tag->type == ay_bp_tagtype && tag->val)
 	{
-	  outline = &((letter.outlines)[i]);
-	  if(outline->points)
-	    free(outline->points);
+	  Tcl_DStringAppend(key, "\n", -1);
+	  Tcl_DStringAppend(key, tag->val, -1);
+	}
+      tag = tag->next;
+    }
+
+ return AY_TRUE;
+} /* ay_text_glyphkey */
+
+
+/* ay_text_copyglyph:
+ *  append copies of the objects in <src>, moved by <xoffset>, to <next>
+ */
+int
+ay_text_copyglyph(ay_object *src, double xoffset, ay_object ***next)
+{
+ int ay_status = AY_OK;
+ ay_object *o = NULL;
+
+  while(src)
+    {
+      o = NULL;
+      ay_status = ay_object_copy(src, &o);
+      if(ay_status || !o)
+	return AY_ERROR;
+
+      o->movx += xoffset;
+
+      **next = o;
+      *next = &(o->next);
+
+      src = src->next;
+    }
+
+ return AY_OK;
+} /* ay_text_copyglyph */
+
+
+/* ay_text_clearcache:
+ *  clear the glyph cache and close all fonts
+ */
+void
+ay_text_clearcache(void)
+{
+ Tcl_HashEntry *entry;
+ Tcl_HashSearch search;
+
+  entry = Tcl_FirstHashEntry(&ay_text_glyphs, &search);
+  while(entry)
+    {
+      ay_text_freeglyph((ay_text_glyph *)Tcl_GetHashValue(entry));
+      entry = Tcl_NextHashEntry(&search);
+    }
+  Tcl_DeleteHashTable(&ay_text_glyphs);
+  Tcl_InitHashTable(&ay_text_glyphs, TCL_STRING_KEYS);
+
+  (void)ay_tti_getcurves(NULL, 0, NULL);
+
+ return;
+} /* ay_text_clearcache */
+
+
+/* ay_text_notifycb:
+ *  notification callback function of text object;
+ *  the extruded letters are taken from the glyph cache
+ *  (and created and added to the cache if not present there)
+ */
+int
+ay_text_notifycb(ay_object *o)
+{
+ int ay_status = AY_OK;
+ ay_text_object *text = NULL;
+ ay_text_glyph *glyph = NULL;
+ ay_object **nextnpatch, **nextcb;
+ Tcl_HashEntry *entry;
+ Tcl_DString key;
+ Tcl_UniChar *uc;
+ int cacheable, new_item = 0;
+ double xoffset = 0.0;
+
+  if(!o)
+    return AY_ENULL;
+
+  text = (ay_text_object *)o->refine;
+
+  if(!text)
+    return AY_ENULL;
+
+  if(text->npatch)
+    ay_status = ay_object_deletemulti(text->npatch, AY_FALSE);
+  text->npatch = NULL;
+  nextnpatch = &(text->npatch);
+
+  if(text->caps_and_bevels)
+    ay_status = ay_object_deletemulti(text->caps_and_bevels, AY_FALSE);
+  text->caps_and_bevels = NULL;
+  nextcb = &(text->caps_and_bevels);
+
+  /* always clear the old read only points */
+  if(text->pnts)
+    {
+      free(text->pnts);
+      text->pnts = NULL;
+    }
+
+  if(!text->fontname || (text->fontname[0] == '\0') ||
+     !text->unistring || (text->unistring[0] == 0))
+    goto cleanup;
+
+  uc = text->unistring;
+  while(*uc != 0)
+    {
+      Tcl_DStringInit(&key);
+      cacheable = ay_text_glyphkey(o, *uc, &key);
+
+      glyph = NULL;
+      if(cacheable)
+	{
+	  entry = Tcl_FindHashEntry(&ay_text_glyphs, Tcl_DStringValue(&key));
+	  if(entry)
+	    glyph = (ay_text_glyph *)Tcl_GetHashValue(entry);
 	}
-      if(letter.outlines)
-	free(letter.outlines);
-      letter.outlines = NULL;
+
+      if(!glyph)
+	{
+	  if(!(glyph = calloc(1, sizeof(ay_text_glyph))))
+	    {
+	      Tcl_DStringFree(&key);
+	      ay_status = AY_EOMEM;
+	      goto cleanup;
+	    }
+
+	  ay_status = ay_text_createglyph(o, *uc, glyph);
+	  if(ay_status)
+	    {
+	      ay_text_freeglyph(glyph);
+	      Tcl_DStringFree(&key);
+	      goto cleanup;
+	    }
+
+	  if(cacheable)
+	    {
+	      if(ay_text_glyphs.numEntries >= AY_TEXTMAXGLYPHS)
+		ay_text_clearcache();
+	      entry = Tcl_CreateHashEntry(&ay_text_glyphs,
+					  Tcl_DStringValue(&key), &new_item);
+	      Tcl_SetHashValue(entry, (char*)glyph);
+	    }
+	} /* if */
+
+      Tcl_DStringFree(&key);
+
+      ay_status = ay_text_copyglyph(glyph->npatch, xoffset, &nextnpatch);
+      if(!ay_status)
+	ay_status = ay_text_copyglyph(glyph->caps_and_bevels, xoffset,
+				      &nextcb);
+
+      xoffset += glyph->advance;
+
+      if(!cacheable)
+	ay_text_freeglyph(glyph);
+
+      if(ay_status)
+	goto cleanup;
 
       uc++;
     } /* while */
@@ -1074,9 +1289,6 @@ ay_text_notifycb(ay_object *o)
 
 cleanup:
 
-  /* free (temporary) font structure */
-  (void)ay_tti_getcurves(NULL, 0, NULL);
-
   /* correct any inconsistent values of pnts and pntslen */
   if(text->pntslen && !text->pnts)
     {
@@ -1207,6 +1419,8 @@ ay_text_init(Tcl_Interp *interp)
 {
  int ay_status = AY_OK;
 
+  Tcl_InitHashTable(&ay_text_glyphs, TCL_STRING_KEYS);
+
   ay_status = ay_otype_registercore(ay_text_name,
 				    ay_text_createcb,
 				    ay_text_deletecb,
@@ -15,6 +15,15 @@
 #include "ayam.h"
 #include <ctype.h>
 
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif /* !WIN32 */
+
 
 /* types local to this module */
 
@@ -1613,27 +1622,23 @@ static double objio_rescaleknots;
 
 static int objio_checkdegen;
 
-typedef struct objio_vertex_s {
-  struct objio_vertex_s *next;
-  struct objio_vertex_s *prev;
-
-  unsigned int index;
-
-  double v[4];
+/* vertex buffer (growable array of 4D vertices) */
+typedef struct objio_vbuf_s {
+  double *v; /* vertex data [alloc*4] */
+  unsigned int len; /* number of vertices in buffer */
+  unsigned int alloc; /* number of vertices allocated */
+} objio_vbuf;
 
-} objio_vertex;
+/* initial size (in vertices) of a vertex buffer */
+#define OBJIO_VBUFINITSIZE 1024
 
-static objio_vertex *objio_gverts_head = NULL;
-static objio_vertex *objio_gverts_tail = NULL;
+static objio_vbuf objio_gverts = {NULL, 0, 0};
 
-static objio_vertex *objio_nverts_head = NULL;
-static objio_vertex *objio_nverts_tail = NULL;
+static objio_vbuf objio_nverts = {NULL, 0, 0};
 
-static objio_vertex *objio_pverts_head = NULL;
-static objio_vertex *objio_pverts_tail = NULL;
+static objio_vbuf objio_pverts = {NULL, 0, 0};
 
-static objio_vertex *objio_tverts_head = NULL;
-static objio_vertex *objio_tverts_tail = NULL;
+static objio_vbuf objio_tverts = {NULL, 0, 0};
 
 static int objio_cstype; /* -1 - unset, 0 - bmatrix, 1 - bezier, 2 - bspline,
 			    3 - cardinal, 4 - taylor */
@@ -1677,13 +1682,51 @@ static ay_object **objio_nexttrim;
 
 static ay_object *objio_lastface;
 
+static int objio_lastlinewasface = AY_FALSE;
+
+static int objio_threads = 0; /* 0 - auto */
+
+/* pre-parsed vertex (see objio_tokenizechunk()) */
+typedef struct objio_vrec_s {
+  int type; /* vertex type (1 - 4), see objio_getvbuf() */
+  double v[4]; /* vertex data */
+} objio_vrec;
+
+/* line aligned chunk of a mapped file that is tokenized by a thread */
+typedef struct objio_chunk_s {
+  const char *start; /* first character of chunk */
+  const char *end; /* first character after chunk */
+  objio_vrec *recs; /* pre-parsed vertices [numrecs] */
+  unsigned int numrecs; /* number of pre-parsed vertices */
+  unsigned int allocrecs; /* number of allocated vertex records */
+  int status; /* result of tokenization */
+#ifndef WIN32
+  pthread_t thread; /* thread working on this chunk */
+  int running; /* is the thread running? */
+#endif /* !WIN32 */
+} objio_chunk;
+
+/* size of a chunk in bytes (before alignment to line ends) */
+#define OBJIO_CHUNKSIZE (4*1024*1024)
+
+/* maximum number of threads used to tokenize a file */
+#define OBJIO_MAXTHREADS 64
+
 
 int objio_addvertex(int type, double *v);
 
-int objio_getvertex(int type, unsigned int index, double **v);
+objio_vbuf *objio_getvbuf(int type);
+
+int objio_getvertex(int type, int index, double **v);
 
 int objio_freevertices(void);
 
+const char *objio_strtod(const char *s, const char *e, double *d);
+
+int objio_scanvertex(const char *s, const char *e, double *v);
+
+int objio_storevertex(int type, double *v);
+
 int objio_readvertex(char *str);
 
 int objio_readvindex(char *c, int *gvindex, int *tvindex, int *nvindex);
@@ -1718,7 +1761,23 @@ int objio_fixncurve(ay_nurbcurve_object *nc);
 
 int objio_readend(void);
 
-int objio_readline(FILE *fileptr);
+int objio_readline(char *str, objio_vrec *vr);
+
+const char *objio_nextline(const char *s, const char *e, const char **le);
+
+int objio_isvertexline(const char *s, const char *e);
+
+int objio_tokenizechunk(objio_chunk *chunk);
+
+int objio_startchunks(objio_chunk *chunks, int numchunks, int threads);
+
+int objio_finishchunks(objio_chunk *chunks, int numchunks);
+
+int objio_getnumthreads(void);
+
+int objio_mapfile(char *filename, char **buf, size_t *size, int *mapped);
+
+void objio_unmapfile(char *buf, size_t size, int mapped);
 
 void objio_readscene(char *filenam);
 
@@ -1726,288 +1785,346 @@ int objio_readscenetcmd(ClientData clientData, Tcl_Interp *interp,
 			   int argc, char *argv[]);
 
 
-/* objio_addvertex:
- *  add a vertex to a vertex buffer
+/* objio_getvbuf:
+ *  get the vertex buffer for a vertex type
  */
-int
-objio_addvertex(int type, double *v)
+objio_vbuf *
+objio_getvbuf(int type)
 {
- objio_vertex *nv = NULL;
-
-  if(!v)
-    return AY_ENULL;
-
-  if(!(nv = calloc(1, sizeof(objio_vertex))))
-    return AY_EOMEM;
-  nv->index = 1;
+ objio_vbuf *vb = NULL;
 
   switch(type)
     {
     case 1:
       /* geometric vertex */
-      memcpy(nv->v, v, 4*sizeof(double));
-      if(objio_gverts_tail)
-	{
-	  nv->index = objio_gverts_tail->index + 1;
-	  nv->prev = objio_gverts_tail;
-	  objio_gverts_tail->next = nv;
-	}
-      objio_gverts_tail = nv;
-      if(!objio_gverts_head)
-	{
-	  objio_gverts_head = nv;
-	}
+      vb = &objio_gverts;
       break;
     case 2:
       /* normal vertex */
-      memcpy(nv->v, v, 3*sizeof(double));
-      if(objio_nverts_tail)
-	{
-	  nv->index = objio_nverts_tail->index + 1;
-	  nv->prev = objio_nverts_tail;
-	  objio_nverts_tail->next = nv;
-	}
-      objio_nverts_tail = nv;
-      if(!objio_nverts_head)
-	{
-	  objio_nverts_head = nv;
-	}
+      vb = &objio_nverts;
       break;
     case 3:
       /* parametric vertex */
-      memcpy(nv->v, v, 4*sizeof(double));
-      if(objio_pverts_tail)
-	{
-	  nv->index = objio_pverts_tail->index + 1;
-	  nv->prev = objio_pverts_tail;
-	  objio_pverts_tail->next = nv;
-	}
-      objio_pverts_tail = nv;
-      if(!objio_pverts_head)
-	{
-	  objio_pverts_head = nv;
-	}
+      vb = &objio_pverts;
       break;
     case 4:
       /* texture vertex */
-      memcpy(nv->v, v, 3*sizeof(double));
-      if(objio_tverts_tail)
-	{
-	  nv->index = objio_tverts_tail->index + 1;
-	  nv->prev = objio_tverts_tail;
-	  objio_tverts_tail->next = nv;
-	}
-      objio_tverts_tail = nv;
-      if(!objio_tverts_head)
-	{
-	  objio_tverts_head = nv;
-	}
+      vb = &objio_tverts;
       break;
     default:
-      free(nv);
       break;
     } /* switch */
 
+ return vb;
+} /* objio_getvbuf */
+
+
+/* objio_addvertex:
+ *  add a vertex to a vertex buffer
+ */
+int
+objio_addvertex(int type, double *v)
+{
+ objio_vbuf *vb = NULL;
+ double *t = NULL;
+ unsigned int newalloc;
+
+  if(!v)
+    return AY_ENULL;
+
+  if(!(vb = objio_getvbuf(type)))
+    return AY_OK;
+
+  if(vb->len == vb->alloc)
+    {
+      /* grow buffer geometrically, to keep the amortized cost constant */
+      if(vb->alloc)
+	newalloc = vb->alloc * 2;
+      else
+	newalloc = OBJIO_VBUFINITSIZE;
+
+      if(newalloc <= vb->alloc)
+	return AY_EOMEM;
+
+      if(!(t = realloc(vb->v, newalloc * 4 * sizeof(double))))
+	return AY_EOMEM;
+
+      vb->v = t;
+      vb->alloc = newalloc;
+    } /* if */
+
+  memcpy(&(vb->v[vb->len*4]), v, 4*sizeof(double));
+  vb->len++;
+
  return AY_OK;
 } /* objio_addvertex */
 
 
 /* objio_getvertex:
- *  get a vertex from a vertex buffer
+ *  get a vertex from a vertex buffer;
+ *  positive indices are absolute (1 is the first vertex read),
+ *  negative indices are relative to the end of the buffer
+ *  (-1 is the last vertex read);
+ *  the returned pointer is only valid until the next objio_addvertex();
+ *  returns AY_ENULL if a relative index is used on an empty buffer
  */
 int
-objio_getvertex(int type, unsigned int index, double **v)
+objio_getvertex(int type, int index, double **v)
 {
- static objio_vertex *objio_gverts_cur = NULL;
- static objio_vertex *objio_nverts_cur = NULL;
- static objio_vertex *objio_pverts_cur = NULL;
- static objio_vertex *objio_tverts_cur = NULL;
- objio_vertex *l = NULL, **pl;
+ objio_vbuf *vb = NULL;
  unsigned int i;
 
   if(!v)
-    {
-      objio_gverts_cur = NULL;
-      objio_nverts_cur = NULL;
-      objio_pverts_cur = NULL;
-      objio_tverts_cur = NULL;
-      return AY_ENULL;
-    } /* if */
+    return AY_ENULL;
 
   if(index == 0)
     return AY_ERROR;
 
-  switch(type)
+  if(!(vb = objio_getvbuf(type)))
+    return AY_ERROR;
+
+  if(index < 0)
     {
-    case 1:
       /* vertex buffer empty? */
-      if(!objio_gverts_tail)
-	return AY_ERROR;
+      if(vb->len == 0)
+	return AY_ENULL;
 
       /* index out of range? */
-      if(index > objio_gverts_tail->index)
-	return AY_ERROR;
-
-      if(objio_gverts_cur)
-	l = objio_gverts_cur;
-      else
-	l = objio_gverts_tail;
-
-      pl = &objio_gverts_cur;
-      break;
-    case 2:
-      /* vertex buffer empty? */
-      if(!objio_nverts_tail)
+      if((unsigned int)(-index) > vb->len)
 	return AY_ERROR;
 
+      i = vb->len - (unsigned int)(-index);
+    }
+  else
+    {
       /* index out of range? */
-      if(index > objio_nverts_tail->index)
+      if((unsigned int)index > vb->len)
 	return AY_ERROR;
 
-      if(objio_nverts_cur)
-	l = objio_nverts_cur;
-      else
-	l = objio_nverts_tail;
+      i = (unsigned int)index - 1;
+    } /* if */
 
-      pl = &objio_nverts_cur;
-      break;
-    case 3:
-      /* vertex buffer empty? */
-      if(!objio_pverts_tail)
-	return AY_ERROR;
+  /* return result */
+  *v = &(vb->v[i*4]);
 
-      /* index out of range? */
-      if(index > objio_pverts_tail->index)
-	return AY_ERROR;
+ return AY_OK;
+} /* objio_getvertex */
 
-      if(objio_pverts_cur)
-	l = objio_pverts_cur;
-      else
-	l = objio_pverts_tail;
 
-      pl = &objio_pverts_cur;
-      break;
-    case 4:
-      /* vertex buffer empty? */
-      if(!objio_tverts_tail)
-	return AY_ERROR;
+/* objio_freevertices:
+ *  free all vertex buffers
+ */
+int
+objio_freevertices(void)
+{
+ int i;
+ objio_vbuf *vb = NULL;
 
-      /* index out of range? */
-      if(index > objio_tverts_tail->index)
-	return AY_ERROR;
+  for(i = 1; i < 5; i++)
+    {
+      vb = objio_getvbuf(i);
+      if(vb->v)
+	free(vb->v);
+      vb->v = NULL;
+      vb->len = 0;
+      vb->alloc = 0;
+    } /* for */
 
-      if(objio_tverts_cur)
-	l = objio_tverts_cur;
-      else
-	l = objio_tverts_tail;
+ return AY_OK;
+} /* objio_freevertices */
 
-      pl = &objio_tverts_cur;
-      break;
-    default:
-      return AY_ERROR;
-      break;
+
+/* objio_strtod:
+ *  fast conversion of a (decimal) floating point number in the
+ *  character range [<s>, <e>) to a double;
+ *  leading white space is skipped;
+ *  numbers with at most 15 significant digits and a small decimal
+ *  exponent are converted directly (with the same result as strtod()),
+ *  all others are handed over to strtod()
+ *  returns pointer to first character after the number or NULL if
+ *  no number could be read
+ */
+const char *
+objio_strtod(const char *s, const char *e, double *d)
+{
+ static const double p10[] = {1.0e0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5,
+			       1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11,
+			       1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16,
+			       1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21,
+			       1.0e22};
+ const char *c, *t;
+ char buf[64], *be;
+ double m = 0.0;
+ int neg = AY_FALSE, eneg = AY_FALSE, fallback = AY_FALSE;
+ int sigdigits = 0, digits = 0, exp = 0, en = 0;
+ size_t len;
+
+  while(s < e && isspace((unsigned char)*s))
+    s++;
+
+  c = s;
+
+  if(c < e && (*c == '-' || *c == '+'))
+    {
+      if(*c == '-')
+	neg = AY_TRUE;
+      c++;
     }
 
-  /* check, whether the same vertex was requested last time */
-  if(index == l->index)
+  /* mantissa, integer part */
+  while(c < e && isdigit((unsigned char)*c))
     {
-      /* Yes, we may immediately return the result. */
-      *v = &(l->v[0]);
-      return AY_OK;
+      if(sigdigits || *c != '0')
+	sigdigits++;
+      m = m*10.0 + (*c - '0');
+      digits++;
+      c++;
     }
 
-  if(index < l->index)
+  /* mantissa, fractional part */
+  if(c < e && *c == '.')
     {
-      /* rewind... */
-      for(i = l->index; i > index; i--)
+      c++;
+      while(c < e && isdigit((unsigned char)*c))
 	{
-	  l = l->prev;
+	  if(sigdigits || *c != '0')
+	    sigdigits++;
+	  m = m*10.0 + (*c - '0');
+	  exp--;
+	  digits++;
+	  c++;
 	}
     }
-  else
+
+  if(!digits || sigdigits > 15)
+    fallback = AY_TRUE;
+
+  /* exponent (only, if followed by at least one digit) */
+  if(!fallback && c < e && (*c == 'e' || *c == 'E'))
     {
-      /* forward... */
-      for(i = l->index; i < index; i++)
+      t = c+1;
+      if(t < e && (*t == '-' || *t == '+'))
 	{
-	  l = l->next;
+	  if(*t == '-')
+	    eneg = AY_TRUE;
+	  t++;
+	}
+      if(t < e && isdigit((unsigned char)*t))
+	{
+	  while(t < e && isdigit((unsigned char)*t))
+	    {
+	      if(en < 10000)
+		en = en*10 + (*t - '0');
+	      t++;
+	    }
+	  if(eneg)
+	    exp -= en;
+	  else
+	    exp += en;
+	  c = t;
 	}
     } /* if */
 
-  /* remember pointer to vertex in static variable */
-  *pl = l;
+  if(!fallback && (exp < -22 || exp > 22))
+    fallback = AY_TRUE;
 
-  /* return result */
-  *v = &(l->v[0]);
+  if(!fallback)
+    {
+      if(exp < 0)
+	*d = m / p10[-exp];
+      else
+	*d = m * p10[exp];
 
- return AY_OK;
-} /* objio_getvertex */
+      if(neg)
+	*d = -*d;
 
+      return c;
+    } /* if */
 
-/* objio_freevertices:
- *  free all vertex buffers
+  /* slow path: let strtod() handle the number (as sscanf() would) */
+  len = 0;
+  t = s;
+  while(t < e && len < sizeof(buf)-1 && !isspace((unsigned char)*t))
+    {
+      buf[len] = *t;
+      len++;
+      t++;
+    }
+  buf[len] = '\0';
+
+  *d = strtod(buf, &be);
+
+  if(be == buf)
+    return NULL;
+
+ return s + (be - buf);
+} /* objio_strtod */
+
+
+/* objio_scanvertex:
+ *  parse the vertex statement in the character range [<s>, <e>)
+ *  to <v> (which must be initialized to zero by the caller)
+ *  returns the vertex type (see objio_getvbuf())
  */
 int
-objio_freevertices(void)
+objio_scanvertex(const char *s, const char *e, double *v)
 {
- objio_vertex *v = NULL, *vt = NULL;
+ int type = 1, i, n = 4, map[4] = {0, 1, 2, 3};
+ const char *c;
 
-  if(objio_gverts_tail)
+  if(e - s >= 2)
     {
-      objio_gverts_head = NULL;
-      vt = objio_gverts_tail;
-      while(vt)
+      switch(s[1])
 	{
-	  v = vt->prev;
-	  free(vt);
-	  vt = v;
-	} /* while */
-      objio_gverts_tail = NULL;
+	case 'n':
+	  type = 2;
+	  n = 3;
+	  break;
+	case 'p':
+	  type = 3;
+	  n = 3;
+	  map[2] = 3;
+	  break;
+	case 't':
+	  type = 4;
+	  n = 3;
+	  break;
+	default:
+	  break;
+	} /* switch */
     } /* if */
 
-  if(objio_nverts_tail)
-    {
-      objio_nverts_head = NULL;
-      vt = objio_nverts_tail;
-      while(vt)
-	{
-	  v = vt->prev;
-	  free(vt);
-	  vt = v;
-	} /* while */
-      objio_nverts_tail = NULL;
-    } /* if */
+  if(type == 1)
+    c = s+1;
+  else
+    c = s+2;
 
-  if(objio_pverts_tail)
+  for(i = 0; i < n; i++)
     {
-      objio_pverts_head = NULL;
-      vt = objio_pverts_tail;
-      while(vt)
-	{
-	  v = vt->prev;
-	  free(vt);
-	  vt = v;
-	} /* while */
-      objio_pverts_tail = NULL;
-    } /* if */
+      if(!(c = objio_strtod(c, e, &(v[map[i]]))))
+	break;
+    }
 
-  if(objio_tverts_tail)
-    {
-      objio_tverts_head = NULL;
-      vt = objio_tverts_tail;
-      while(vt)
-	{
-	  v = vt->prev;
-	  free(vt);
-	  vt = v;
-	} /* while */
-      objio_tverts_tail = NULL;
-    } /* if */
+  /* set default weight for incomplete (4D) vertices */
+  if((type == 1 && i < 4) || (type == 3 && i < 3))
+    v[3] = 1.0;
 
-  /* clear cached "current" pointers in objio_getvertex() */
-  (void)objio_getvertex(0, 0, NULL);
+ return type;
+} /* objio_scanvertex */
 
- return AY_OK;
-} /* objio_freevertices */
+
+/* objio_storevertex:
+ *  put a parsed vertex to the appropriate vertex buffer
+ */
+int
+objio_storevertex(int type, double *v)
+{
+
+  if(type == 1 && objio_scalefactor != 1.0)
+    AY_V3SCAL(v, objio_scalefactor)
+
+ return objio_addvertex(type, v);
+} /* objio_storevertex */
 
 
 /* objio_readvertex:
@@ -2016,45 +2133,15 @@ objio_freevertices(void)
 int
 objio_readvertex(char *str)
 {
- int ay_status = AY_OK;
+ int type;
  double v[4] = {0};
 
   if(strlen(str) < 2)
     return AY_ERROR;
 
-  if(str[1] == 'n')
-    {
-      sscanf(&(str[2])," %lg %lg %lg", &(v[0]), &(v[1]), &(v[2]));
-      ay_status = objio_addvertex(2, v);
-    }
-  else
-  if(str[1] == 'p')
-    {
-      if(sscanf(&(str[2])," %lg %lg %lg", &(v[0]), &(v[1]), &(v[3])) < 3)
-	{
-	  v[3] = 1.0;
-	}
-      ay_status = objio_addvertex(3, v);
-    }
-  else
-  if(str[1] == 't')
-    {
-      sscanf(&(str[2])," %lg %lg %lg", &(v[0]), &(v[1]), &(v[2]));
-      ay_status = objio_addvertex(4, v);
-    }
-  else
-    {
-      if(sscanf(&(str[1])," %lg %lg %lg %lg",
-		&(v[0]), &(v[1]), &(v[2]), &(v[3])) < 4)
-	{
-	  v[3] = 1.0;
-	}
-      if(objio_scalefactor != 1.0)
-	AY_V3SCAL(v, objio_scalefactor)
-      ay_status = objio_addvertex(1, v);
-    } /* if */
+  type = objio_scanvertex(str, str + strlen(str), v);
 
- return ay_status;
+ return objio_storevertex(type, v);
 } /* objio_readvertex */
 
 
@@ -2072,7 +2159,7 @@ objio_readvindex(char *c, int *gvindex, int *tvindex, int *nvindex)
     return AY_ENULL;
 
   /* parse geometric vertex index */
-  sscanf(c, "%d", gvindex);
+  *gvindex = (int)strtol(c, NULL, 10);
   /* forward to next index, /, or end */
   while((isspace((unsigned char)*c)))
     c++;
@@ -2094,7 +2181,7 @@ objio_readvindex(char *c, int *gvindex, int *tvindex, int *nvindex)
 	  c++;
 	  if(*c == '\0')
 	    return AY_OK;
-	  sscanf(c, "%d", tvindex);
+	  *tvindex = (int)strtol(c, NULL, 10);
 
 	  /* forward to next index or / */
 	  while((isdigit(*c) || (*c == '-')) && (*c != '\0'))
@@ -2117,7 +2204,7 @@ objio_readvindex(char *c, int *gvindex, int *tvindex, int *nvindex)
       /* parse normal vertex index */
       if(isdigit(*c) || (*c == '-'))
 	{
-	  sscanf(c, "%d", nvindex);
+	  *nvindex = (int)strtol(c, NULL, 10);
 	} /* if */
     } /* if */
 
@@ -2271,48 +2358,14 @@ objio_readface(char *str, int lastlinewasface)
       tv = NULL;
 
       /* get geometric vertex data and add it to the pomesh */
-      if(gvindex < 0)
-	{
-	  if(objio_gverts_tail)
-	    {
-	      ay_status = objio_getvertex(1,
-					objio_gverts_tail->index + gvindex + 1,
-					     &gv);
-	    }
-	  else
-	    {
-	      ay_status = AY_ENULL;
-	      goto cleanup;
-	    } /* if */
-	}
-      else
-	{
-	  ay_status = objio_getvertex(1, gvindex, &gv);
-	} /* if */
+      ay_status = objio_getvertex(1, gvindex, &gv);
       if(ay_status)
 	goto cleanup;
 
       if(nvindex != 0)
 	{
 	  /* get normal vertex data and add it to the pomesh */
-	  if(nvindex < 0)
-	    {
-	      if(objio_nverts_tail)
-		{
-		  ay_status = objio_getvertex(2,
-				        objio_nverts_tail->index + nvindex + 1,
-					     &nv);
-		}
-	      else
-		{
-		  ay_status = AY_ENULL;
-		  goto cleanup;
-		} /* if */
-	    }
-	  else
-	    {
-	      ay_status = objio_getvertex(2, nvindex, &nv);
-	    } /* if */
+	  ay_status = objio_getvertex(2, nvindex, &nv);
 	  if(ay_status)
 	    goto cleanup;
 	} /* if */
@@ -2322,24 +2375,9 @@ objio_readface(char *str, int lastlinewasface)
 	  /* get texture vertex data and cache it in texv */
 
 	  tv = NULL;
-	  if(tvindex < 0)
-	    {
-	      if(objio_tverts_tail)
-		{
-		  ay_status = objio_getvertex(4,
-					objio_tverts_tail->index + tvindex + 1,
-						 &tv);
-		}
-	      else
-		{
-		  ay_status = AY_ENULL;
-		  goto cleanup;
-		} /* if */
-	    }
-	  else
-	    {
-	      ay_status = objio_getvertex(4, tvindex, &tv);
-	    } /* if */
+	  ay_status = objio_getvertex(4, tvindex, &tv);
+	  if(ay_status == AY_ENULL)
+	    goto cleanup;
 
 	  if(tv)
 	    {
@@ -2572,24 +2610,7 @@ objio_readpolyline(char *str)
       tv = NULL;
 
       /* get geometric vertex data and add it to the curve */
-      if(gvindex < 0)
-	{
-	  if(objio_gverts_tail)
-	    {
-	      ay_status = objio_getvertex(1,
-					objio_gverts_tail->index + gvindex + 1,
-					  &gv);
-	    }
-	  else
-	    {
-	      ay_status = AY_ENULL;
-	      goto cleanup;
-	    } /* if */
-	}
-      else
-	{
-	  ay_status = objio_getvertex(1, gvindex, &gv);
-	} /* if */
+      ay_status = objio_getvertex(1, gvindex, &gv);
       if(ay_status)
 	goto cleanup;
 
@@ -2608,24 +2629,9 @@ objio_readpolyline(char *str)
 	  /* get texture vertex data and cache it in texv */
 
 	  tv = NULL;
-	  if(tvindex < 0)
-	    {
-	      if(objio_tverts_tail)
-		{
-		  ay_status = objio_getvertex(4,
-					objio_tverts_tail->index + tvindex + 1,
-					      &tv);
-		}
-	      else
-		{
-		  ay_status = AY_ENULL;
-		  goto cleanup;
-		} /* if */
-	    }
-	  else
-	    {
-	      ay_status = objio_getvertex(4, tvindex, &tv);
-	    } /* if */
+	  ay_status = objio_getvertex(4, tvindex, &tv);
+	  if(ay_status == AY_ENULL)
+	    goto cleanup;
 
 	  if(tv)
 	    {
@@ -2782,42 +2788,9 @@ objio_readcurv(char *str)
       ay_status = objio_readvindex(c, &gvindex, &tvindex, &nvindex);
       gv = NULL;
 
-      if(gvindex < 0)
-	{
-	  if(vtype == 1)
-	    {
-	      if(objio_gverts_tail)
-		{
-		  ay_status = objio_getvertex(vtype,
-					objio_gverts_tail->index + gvindex + 1,
-						 &gv);
-		}
-	      else
-		{
-		  ay_status = AY_ENULL;
-		  goto cleanup;
-		} /* if */
-	    }
-	  else
-	    {
-	      /* vtype == 3, get parametric vertex... */
-	      if(objio_pverts_tail)
-		{
-		  ay_status = objio_getvertex(vtype,
-					objio_pverts_tail->index + gvindex + 1,
-						 &gv);
-		}
-	      else
-		{
-		  ay_status = AY_ENULL;
-		  goto cleanup;
-		} /* if */
-	    } /* if */
-	}
-      else
-	{
-	  ay_status = objio_getvertex(vtype, gvindex, &gv);
-	} /* if */
+      ay_status = objio_getvertex(vtype, gvindex, &gv);
+      if(ay_status == AY_ENULL)
+	goto cleanup;
 
       if(gv)
 	{
@@ -2875,24 +2848,9 @@ objio_readsurf(char *str)
       ay_status = objio_readvindex(c, &gvindex, &tvindex, &nvindex);
 
       gv = NULL;
-      if(gvindex < 0)
-	{
-	  if(objio_gverts_tail)
-	    {
-	      ay_status = objio_getvertex(1,
-					objio_gverts_tail->index + gvindex + 1,
-					     &gv);
-	    }
-	  else
-	    {
-	      ay_status = AY_ENULL;
-	      goto cleanup;
-	    } /* if */
-	}
-      else
-	{
-	  ay_status = objio_getvertex(1, gvindex, &gv);
-	} /* if */
+      ay_status = objio_getvertex(1, gvindex, &gv);
+      if(ay_status == AY_ENULL)
+	goto cleanup;
 
       if(gv)
 	{
@@ -2908,24 +2866,9 @@ objio_readsurf(char *str)
       if(tvindex != 0)
 	{
 	  tv = NULL;
-	  if(tvindex < 0)
-	    {
-	      if(objio_tverts_tail)
-		{
-		  ay_status = objio_getvertex(4,
-					objio_tverts_tail->index + tvindex + 1,
-						 &tv);
-		}
-	      else
-		{
-		  ay_status = AY_ENULL;
-		  goto cleanup;
-		} /* if */
-	    }
-	  else
-	    {
-	      ay_status = objio_getvertex(4, tvindex, &tv);
-	    } /* if */
+	  ay_status = objio_getvertex(4, tvindex, &tv);
+	  if(ay_status == AY_ENULL)
+	    goto cleanup;
 
 	  if(tv)
 	    {
@@ -3590,186 +3533,437 @@ cleanup:
 
 
 /* objio_readline:
- *  read a single line from a Wavefront OBJ file
+ *  process a single line from a Wavefront OBJ file;
+ *  <str> must be a NULL terminated copy of the line (without line
+ *  end and continuation characters), except for vertex statements
+ *  that have already been parsed (by objio_tokenizechunk()) to <vr>,
+ *  where <str> just needs to point to the line start;
+ *  call with <str> NULL to finish a pending face and reset the
+ *  internal state
  */
 int
-objio_readline(FILE *fileptr)
+objio_readline(char *str, objio_vrec *vr)
 {
  int ay_status = AY_OK;
- int read, peek, continuation = AY_FALSE;
- static int lastlinewasface = AY_FALSE;
- char readchar, *str;
- Tcl_DString ds;
 
-  if(!fileptr)
+  if(!str)
     {
-      if(lastlinewasface)
+      if(objio_lastlinewasface)
 	ay_status = objio_readface(NULL, -1);
-      lastlinewasface = AY_FALSE;
+      objio_lastlinewasface = AY_FALSE;
       return AY_ENULL;
     }
 
-  Tcl_DStringInit(&ds);
+  if(vr)
+    {
+      ay_status = objio_storevertex(vr->type, vr->v);
+    }
+  else
+    {
+      switch(str[0])
+	{
+	case '#':
+	  break;
+	case 'c':
+	  if(str[1] == 's')
+	    ay_status = objio_readcstype(str);
+	  if(str[1] == 'u')
+	    ay_status = objio_readcurv(str);
+	  break;
+	case 'd':
+	  ay_status = objio_readdeg(str);
+	  break;
+	case 'e':
+	  ay_status = objio_readend();
+	  break;
+	case 'f':
+	  ay_status = objio_readface(str, objio_lastlinewasface);
+	  break;
+	case 'h':
+	  ay_status = objio_readtrim(str, AY_TRUE);
+	  break;
+	case 'l':
+	  ay_status = objio_readpolyline(str);
+	  break;
+	case 'p':
+	  ay_status = objio_readparm(str);
+	  break;
+	case 's':
+	  if(str[1] == 'u')
+	    ay_status = objio_readsurf(str);
+	  /* XXXX TODO else read smoothing group */
+	  break;
+	case 't':
+	  ay_status = objio_readtrim(str, AY_FALSE);
+	  break;
+	case 'v':
+	  ay_status = objio_readvertex(str);
+	  break;
+	default:
+	  break;
+	} /* switch */
+    } /* if */
+
+  if(str[0] == 'f')
+    {
+      if(ay_status == AY_OK)
+	{
+	  objio_lastlinewasface = AY_TRUE;
+	}
+      else
+	{
+	  if(ay_status == AY_ERROR)
+	    {
+	      ay_status = AY_OK;
+	    }
+	}
+    }
+  else
+    {
+      if(str[0] == 'u' || (str[0] == 's' && str[1] == ' '))
+	{
+	  /* handle ignored usemtl/smoothing group statements */
+	  if(objio_lastlinewasface)
+	    objio_lastlinewasface = AY_TRUE;
+	}
+      else
+	{
+	  if(objio_lastlinewasface)
+	    ay_status = objio_readface(NULL, -1);
+	  objio_lastlinewasface = AY_FALSE;
+	}
+    }
 
-  read = getc(fileptr);
+ return ay_status;
+} /* objio_readline */
 
-  if(read == EOF)
-    {Tcl_DStringFree(&ds); return AY_EUEOF;}
 
-  if((char)read == '\n' || (char)read == '\r')
-    {Tcl_DStringFree(&ds); return AY_OK;}
+/* objio_nextline:
+ *  find the end of the line starting at <s> in the character range
+ *  [<s>, <e>); lines end with '\n' or '\r', unless the line end
+ *  character is preceded by a line continuation character ('\\')
+ *  returns the start of the next line and the end of the current line
+ *  (the position of the line end character) in <le>
+ */
+const char *
+objio_nextline(const char *s, const char *e, const char **le)
+{
+ const char *c;
 
-  /* read characters from the file until a line end is hit
-     (and no line continuation hint ('\') was encountered before
-      on that line) */
-  while(1)
+  for(c = s; c < e; c++)
     {
-      /* put read character to the buffer string
-	 (but omit line end and continuation characters) */
-      if((char)read != '\n' && (char)read != '\r' && (char)read != '\\')
+      if((*c == '\n' || *c == '\r') && (c == s || *(c-1) != '\\'))
 	{
-	  readchar = (char)read;
-	  Tcl_DStringAppend(&ds, &readchar, 1);
+	  *le = c;
+	  return c+1;
 	}
+    } /* for */
 
-      read = getc(fileptr);
+  *le = e;
 
-      if(read == EOF)
-	{
-	  break;
-	}
+ return e;
+} /* objio_nextline */
 
-      if((char)read == '\\')
-	{
-	  peek = getc(fileptr);
 
-	  if(peek == EOF)
-	    {
-	      break;
-	    }
+/* objio_isvertexline:
+ *  check, whether the line in the character range [<s>, <e>) is a
+ *  vertex statement that may be pre-parsed by objio_tokenizechunk()
+ *  (vertex statements with continued lines are not pre-parsed)
+ */
+int
+objio_isvertexline(const char *s, const char *e)
+{
 
-	  if((char)peek == '\n' || (char)peek == '\r')
-	    {
-	      continuation = AY_TRUE;
-	    }
+  if(s < e && *s == 'v' && !memchr(s, '\\', e - s))
+    return AY_TRUE;
+
+ return AY_FALSE;
+} /* objio_isvertexline */
 
-	  ungetc(peek, fileptr);
-	}
 
-      if((char)read == '\n' || (char)read == '\r')
+/* objio_tokenizechunk:
+ *  pre-parse all vertex statements in a chunk of a mapped file
+ *  (this function may run in a thread of its own and, thus, must not
+ *  use any global state)
+ */
+int
+objio_tokenizechunk(objio_chunk *chunk)
+{
+ const char *s, *ls, *le;
+ objio_vrec *t, *r;
+ unsigned int newalloc;
+
+  chunk->status = AY_OK;
+
+  s = chunk->start;
+  while(s < chunk->end)
+    {
+      /* the chunk ends on a line end (or the end of the file), thus,
+	 all lines are completely contained in the chunk */
+      ls = s;
+      s = objio_nextline(ls, chunk->end, &le);
+
+      if(!objio_isvertexline(ls, le))
+	continue;
+
+      if(chunk->numrecs == chunk->allocrecs)
 	{
-	  if(continuation)
-	    {
-	      continuation = AY_FALSE;
-	    }
+	  if(chunk->allocrecs)
+	    newalloc = chunk->allocrecs * 2;
 	  else
+	    newalloc = 4096;
+	  if(!(t = realloc(chunk->recs, newalloc * sizeof(objio_vrec))))
 	    {
-	      break;
+	      chunk->status = AY_EOMEM;
+	      return AY_EOMEM;
 	    }
-	}
+	  chunk->recs = t;
+	  chunk->allocrecs = newalloc;
+	} /* if */
+
+      r = &(chunk->recs[chunk->numrecs]);
+      memset(r->v, 0, 4*sizeof(double));
+      r->type = objio_scanvertex(ls, le, r->v);
+      chunk->numrecs++;
     } /* while */
 
-  /* add some white space to the string, just in case we
-     left the loop prematurely and the string is still empty */
-  Tcl_DStringAppend(&ds, " ", -1);
+ return AY_OK;
+} /* objio_tokenizechunk */
 
-  str = Tcl_DStringValue(&ds);
 
-  switch(str[0])
-    {
-    case '#':
-      break;
-    case 'c':
-      if(str[1] == 's')
-	ay_status = objio_readcstype(str);
-      if(str[1] == 'u')
-	ay_status = objio_readcurv(str);
-      break;
-    case 'd':
-      ay_status = objio_readdeg(str);
-      break;
-    case 'e':
-      ay_status = objio_readend();
-      break;
-    case 'f':
-      ay_status = objio_readface(str, lastlinewasface);
-      break;
-    case 'h':
-      ay_status = objio_readtrim(str, AY_TRUE);
-      break;
-    case 'l':
-      ay_status = objio_readpolyline(str);
-      break;
-    case 'p':
-      ay_status = objio_readparm(str);
-      break;
-    case 's':
-      if(str[1] == 'u')
-	ay_status = objio_readsurf(str);
-      /* XXXX TODO else read smoothing group */
-      break;
-    case 't':
-      ay_status = objio_readtrim(str, AY_FALSE);
-      break;
-    case 'v':
-      ay_status = objio_readvertex(str);
-      break;
-    default:
-      break;
-    } /* switch */
+#ifndef WIN32
+/* objio_chunkthread:
+ *  thread main function, tokenize a chunk
+ */
+static void *
+objio_chunkthread(void *arg)
+{
 
-  if(str[0] == 'f')
+  (void)objio_tokenizechunk((objio_chunk *)arg);
+
+ return NULL;
+} /* objio_chunkthread */
+#endif /* !WIN32 */
+
+
+/* objio_startchunks:
+ *  start tokenization of <numchunks> chunks, using one thread per chunk
+ *  if <threads> is larger than 1 (otherwise, or if no thread can be
+ *  created, the chunks are tokenized immediately)
+ */
+int
+objio_startchunks(objio_chunk *chunks, int numchunks, int threads)
+{
+ int i;
+
+  for(i = 0; i < numchunks; i++)
     {
-      if(ay_status == AY_OK)
-	{
-	  lastlinewasface = AY_TRUE;
-	}
-      else
+#ifndef WIN32
+      chunks[i].running = AY_FALSE;
+      if(threads > 1)
 	{
-	  if(ay_status == AY_ERROR)
+	  if(!pthread_create(&(chunks[i].thread), NULL, objio_chunkthread,
+			     (void *)&(chunks[i])))
 	    {
-	      ay_status = AY_OK;
+	      chunks[i].running = AY_TRUE;
+	      continue;
 	    }
+	} /* if */
+#endif /* !WIN32 */
+      (void)objio_tokenizechunk(&(chunks[i]));
+    } /* for */
+
+ return AY_OK;
+} /* objio_startchunks */
+
+
+/* objio_finishchunks:
+ *  wait for the tokenization of <numchunks> chunks to complete
+ *  returns AY_OK if all chunks could be tokenized
+ */
+int
+objio_finishchunks(objio_chunk *chunks, int numchunks)
+{
+ int ay_status = AY_OK, i;
+
+  for(i = 0; i < numchunks; i++)
+    {
+#ifndef WIN32
+      if(chunks[i].running)
+	{
+	  (void)pthread_join(chunks[i].thread, NULL);
+	  chunks[i].running = AY_FALSE;
 	}
+#endif /* !WIN32 */
+      if(chunks[i].status && !ay_status)
+	ay_status = chunks[i].status;
+    } /* for */
+
+ return ay_status;
+} /* objio_finishchunks */
+
+
+/* objio_getnumthreads:
+ *  get the number of threads to use for tokenization
+ *  (as set by the -t option or the number of online processors)
+ */
+int
+objio_getnumthreads(void)
+{
+ long n = 1;
+
+  if(objio_threads > 0)
+    {
+      n = objio_threads;
     }
   else
     {
-      if(str[0] == 'u' || (str[0] == 's' && str[1] == ' '))
-	{
-	  /* handle ignored usemtl/smoothing group statements */
-	  if(lastlinewasface)
-	    lastlinewasface = AY_TRUE;
-	}
-      else
+#ifndef WIN32
+#ifdef _SC_NPROCESSORS_ONLN
+      n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif /* _SC_NPROCESSORS_ONLN */
+#endif /* !WIN32 */
+    } /* if */
+
+  if(n < 1)
+    n = 1;
+
+  if(n > OBJIO_MAXTHREADS)
+    n = OBJIO_MAXTHREADS;
+
+ return (int)n;
+} /* objio_getnumthreads */
+
+
+/* objio_mapfile:
+ *  make the complete file <filename> available in memory;
+ *  the file is mapped (if possible) or read into a buffer
+ *  returns buffer and size, mapped is set to AY_TRUE if the
+ *  file was mapped (see also objio_unmapfile())
+ */
+int
+objio_mapfile(char *filename, char **buf, size_t *size, int *mapped)
+{
+ FILE *fileptr = NULL;
+ long fsize;
+#ifndef WIN32
+ int fd;
+ struct stat st;
+ void *p;
+#endif /* !WIN32 */
+
+  *buf = NULL;
+  *size = 0;
+  *mapped = AY_FALSE;
+
+#ifndef WIN32
+  if((fd = open(filename, O_RDONLY)) == -1)
+    return AY_EOPENFILE;
+
+  if(!fstat(fd, &st) && st.st_size > 0)
+    {
+      p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(p != MAP_FAILED)
 	{
-	  if(lastlinewasface)
-	    ay_status = objio_readface(NULL, -1);
-	  lastlinewasface = AY_FALSE;
+#ifdef MADV_SEQUENTIAL
+	  (void)madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif /* MADV_SEQUENTIAL */
+	  close(fd);
+	  *buf = (char *)p;
+	  *size = (size_t)st.st_size;
+	  *mapped = AY_TRUE;
+	  return AY_OK;
 	}
+    } /* if */
+
+  close(fd);
+#endif /* !WIN32 */
+
+  /* fall back to reading the file */
+  if(!(fileptr = fopen(filename, "rb")))
+    return AY_EOPENFILE;
+
+  fseek(fileptr, 0L, SEEK_END);
+  fsize = ftell(fileptr);
+  rewind(fileptr);
+
+  if(fsize < 0)
+    {
+      fclose(fileptr);
+      return AY_ERROR;
     }
 
-  Tcl_DStringFree(&ds);
+  if(!(*buf = malloc((size_t)fsize + 1)))
+    {
+      fclose(fileptr);
+      return AY_EOMEM;
+    }
 
- return ay_status;
-} /* objio_readline */
+  if(fread(*buf, 1, (size_t)fsize, fileptr) != (size_t)fsize)
+    {
+      fclose(fileptr);
+      free(*buf);
+      *buf = NULL;
+      return AY_ERROR;
+    }
+
+  (*buf)[fsize] = '\0';
+  *size = (size_t)fsize;
+
+  fclose(fileptr);
+
+ return AY_OK;
+} /* objio_mapfile */
+
+
+/* objio_unmapfile:
+ *  release a buffer obtained by objio_mapfile()
+ */
+void
+objio_unmapfile(char *buf, size_t size, int mapped)
+{
+
+  if(!buf)
+    return;
+
+#ifndef WIN32
+  if(mapped)
+    {
+      (void)munmap((void *)buf, size);
+      return;
+    }
+#endif /* !WIN32 */
+
+  free(buf);
+
+ return;
+} /* objio_unmapfile */
 
 
 /* objio_readscene:
- *
+ *  read the Wavefront OBJ file <filename>;
+ *  the file is mapped to memory and split into line aligned chunks;
+ *  the vertex statements in a wave of chunks (one chunk per thread)
+ *  are pre-parsed in parallel while the previous wave is assembled
+ *  (in file order) to objects in the main thread
  */
 void
 objio_readscene(char *filename)
 {
  int ay_status = AY_OK;
  ay_object *o = ay_root->next;
- FILE *fileptr = NULL;
  char fname[] = "objio_readscene";
  char aname[] = "objio_options", vname1[] = "Progress";
  char vname2[] = "Cancel", *val = NULL;
  char pbuffer[64];
  int lastprog = 0, curprog = 0;
- long fsize;
- unsigned int lineno = 0, lines = 0;
+ unsigned int lineno = 0, r;
+ char *buf = NULL;
+ const char *pos, *end, *ce, *s, *ls, *le, *c, *rs;
+ size_t size = 0;
+ int mapped = AY_FALSE, threads, cur = 0, numchunks[2] = {0}, i, j;
+ objio_chunk *chunks = NULL, *chunk;
+ Tcl_DString ds;
 
   if(!o || !filename)
     {
@@ -3777,13 +3971,25 @@ objio_readscene(char *filename)
       return;
     }
 
-  if(!(fileptr = fopen(filename, "rb")))
+  if((ay_status = objio_mapfile(filename, &buf, &size, &mapped)))
     {
-      ay_error(AY_EOPENFILE, fname, filename);
+      if(ay_status == AY_EOPENFILE)
+	ay_error(AY_EOPENFILE, fname, filename);
+      else
+	ay_error(ay_status, fname, strerror(errno));
       return;
     }
 
-  clearerr(fileptr);
+  threads = objio_getnumthreads();
+
+  if(!(chunks = calloc(2*threads, sizeof(objio_chunk))))
+    {
+      objio_unmapfile(buf, size, mapped);
+      ay_error(AY_EOMEM, fname, NULL);
+      return;
+    }
+
+  Tcl_DStringInit(&ds);
 
   /* prepare a bunch of global variables */
 
@@ -3804,60 +4010,161 @@ objio_readscene(char *filename)
   objio_trims = NULL;
   objio_nexttrim = &(objio_trims);
 
-  fseek(fileptr, 0L, SEEK_END);
-  fsize = ftell(fileptr);
-  if(fsize < 0)
-    fsize = LONG_MAX;
-  rewind(fileptr);
+  pos = buf;
+  end = buf + size;
 
-  /* estimate number of lines (the average Wavefront OBJ line has 28 bytes) */
-  lines = fsize/28;
-
-  while(!feof(fileptr))
+  while(1)
     {
-      if((ay_status = objio_readline(fileptr)))
-	break;
-
-      lineno++;
-
-      /* calculate new progress value in percent */
-      curprog = (int)(lineno*100.0/lines);
+      /* split the next part of the file into line aligned chunks
+	 and start to tokenize them */
+      j = 0;
+      while(j < threads && pos < end)
+	{
+	  chunk = &(chunks[(1-cur)*threads + j]);
+	  chunk->start = pos;
+	  ce = pos + OBJIO_CHUNKSIZE;
+	  if(ce >= end || ce < pos)
+	    {
+	      ce = end;
+	    }
+	  else
+	    {
+	      while(ce < end && !((*ce == '\n' || *ce == '\r') &&
+				  *(ce-1) != '\\'))
+		ce++;
+	      if(ce < end)
+		ce++;
+	    }
+	  chunk->end = ce;
+	  pos = ce;
+	  j++;
+	} /* while */
+      numchunks[1-cur] = j;
+      (void)objio_startchunks(&(chunks[(1-cur)*threads]), j, threads);
 
-      if(curprog > lastprog)
+      /* assemble the objects from the current wave of chunks */
+      if(numchunks[cur] == 0)
 	{
-	  sprintf(pbuffer, "%d", curprog);
-	  Tcl_SetVar2(ay_interp, aname, vname1, pbuffer,
-		     TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
-	  lastprog = curprog;
+	  cur = 1-cur;
+	  if(numchunks[cur] == 0)
+	    break;
+	  continue;
 	}
 
-      /* process all events (update the GUI) every 500 lines */
-      if(!fmod(lineno, 500.0))
+      if((ay_status = objio_finishchunks(&(chunks[cur*threads]),
+					 numchunks[cur])))
 	{
-	  while(Tcl_DoOneEvent(TCL_DONT_WAIT)){};
+	  ay_error(ay_status, fname, NULL);
+	  break;
+	}
 
-	  /* also, check for cancel button */
-	  val = Tcl_GetVar2(ay_interp, aname, vname2,
-			    TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
-	  if(val && val[0] == '1')
+      for(i = 0; i < numchunks[cur]; i++)
+	{
+	  chunk = &(chunks[cur*threads + i]);
+	  r = 0;
+	  s = chunk->start;
+	  while(s < chunk->end)
 	    {
-	      ay_error(AY_EOUTPUT, fname,
-	             "Import cancelled! Not all objects may have been read!");
-	      break;
-	    }
-	}
+	      ls = s;
+	      s = objio_nextline(ls, chunk->end, &le);
 
+	      /* skip empty lines */
+	      if(ls == le)
+		continue;
+
+	      if(objio_isvertexline(ls, le))
+		{
+		  /* use pre-parsed vertex */
+		  ay_status = objio_readline((char *)ls, &(chunk->recs[r]));
+		  r++;
+		}
+	      else
+		{
+		  /* copy the line (omit line end and continuation
+		     characters) */
+		  Tcl_DStringSetLength(&ds, 0);
+		  rs = ls;
+		  for(c = ls; c < le; c++)
+		    {
+		      if(*c == '\n' || *c == '\r' || *c == '\\')
+			{
+			  if(c > rs)
+			    Tcl_DStringAppend(&ds, rs, (int)(c - rs));
+			  rs = c+1;
+			}
+		    }
+		  if(le > rs)
+		    Tcl_DStringAppend(&ds, rs, (int)(le - rs));
+
+		  /* add some white space to the string, the readers
+		     expect it */
+		  Tcl_DStringAppend(&ds, " ", -1);
+
+		  ay_status = objio_readline(Tcl_DStringValue(&ds), NULL);
+		} /* if */
+
+	      if(ay_status)
+		goto cleanup;
+
+	      lineno++;
+
+	      /* calculate new progress value in percent */
+	      curprog = (int)((ls - buf)*100.0/size);
+
+	      if(curprog > lastprog)
+		{
+		  sprintf(pbuffer, "%d", curprog);
+		  Tcl_SetVar2(ay_interp, aname, vname1, pbuffer,
+			      TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+		  lastprog = curprog;
+		}
+
+	      /* process all events (update the GUI) every 500 lines */
+	      if(!(lineno % 500))
+		{
+		  while(Tcl_DoOneEvent(TCL_DONT_WAIT)){};
+
+		  /* also, check for cancel button */
+		  val = Tcl_GetVar2(ay_interp, aname, vname2,
+				    TCL_LEAVE_ERR_MSG | TCL_GLOBAL_ONLY);
+		  if(val && val[0] == '1')
+		    {
+		      ay_error(AY_EOUTPUT, fname,
+		     "Import cancelled! Not all objects may have been read!");
+		      goto cleanup;
+		    }
+		}
+	    } /* while */
+
+	  /* the pre-parsed vertices of this chunk are no longer needed */
+	  if(chunk->recs)
+	    free(chunk->recs);
+	  chunk->recs = NULL;
+	  chunk->numrecs = 0;
+	  chunk->allocrecs = 0;
+	} /* for */
+
+      numchunks[cur] = 0;
+      cur = 1-cur;
     } /* while */
 
-  if(ferror(fileptr) || (errno != 0))
+cleanup:
+
+  /* wait for running threads and free all pre-parsed vertices */
+  for(i = 0; i < 2; i++)
     {
-      ay_error(AY_ERROR, fname, strerror(errno));
+      (void)objio_finishchunks(&(chunks[i*threads]), numchunks[i]);
     }
-
-  if(fclose(fileptr))
+  for(i = 0; i < 2*threads; i++)
     {
-      ay_error(AY_ERROR, fname, strerror(errno));
+      if(chunks[i].recs)
+	free(chunks[i].recs);
     }
+  free(chunks);
+
+  Tcl_DStringFree(&ds);
+
+  objio_unmapfile(buf, size, mapped);
 
   /* clean up all vertex buffers */
   ay_status = objio_freevertices();
@@ -3888,8 +4195,8 @@ objio_readscene(char *filename)
   /* clean up trims buffer */
   objio_freetrims();
 
-  /* reset lastlinewasface state in objio_readline() */
-  objio_readline(NULL);
+  /* finish pending face and reset the lastlinewasface state */
+  objio_readline(NULL, NULL);
 
  return;
 } /* objio_readscene */
@@ -3918,6 +4225,7 @@ objio_readscenetcmd(ClientData clientData, Tcl_Interp *interp,
   objio_checkdegen = AY_TRUE;
   objio_readstrim = AY_TRUE;
   objio_rationalstyle = 0;
+  objio_threads = 0;
 
   while(i+1 < argc)
     {
@@ -3960,6 +4268,11 @@ objio_readscenetcmd(ClientData clientData, Tcl_Interp *interp,
 	{
 	  sscanf(argv[i+1], "%d", &objio_rationalstyle);
 	}
+      else
+      if(!strcmp(argv[i], "-t"))
+	{
+	  sscanf(argv[i+1], "%d", &objio_threads);
+	}
       i += 2;
     } /* while */
 
@@ -9247,31 +9247,56 @@ x3dio_writeconeobj(scew_element *element, ay_object *o)
 int
 x3dio_copypv(ay_tag *src, char **dst)
 {
- char *tmp = NULL, *srcptr, *dstptr;
+ int ay_status = AY_OK;
+ char *tmp = NULL, *srcptr, *dstptr, *val = NULL;
  unsigned int len = 0, i = 0;
 
   if(!src || !dst)
     return AY_ENULL;
 
+  /* get the string form of (binary) PV tags */
+  if(src->is_binary)
+    {
+      ay_status = ay_pv_tostring(src, &val);
+      if(ay_status)
+	return ay_status;
+      srcptr = val;
+    }
+  else
+    {
+      srcptr = src->val;
+    }
+
   /* find the data portion of the PV tags value string */
-  srcptr = src->val;
   for(i = 0; i < 4; i++)
     {
       if(!srcptr)
 	{
 	  /* probably PV format error */
+	  if(val)
+	    free(val);
 	  return AY_ERROR;
 	}
       else
 	{
 	  srcptr = strchr(srcptr, ',');
-	  srcptr++;
+	  if(srcptr)
+	    srcptr++;
 	}
     }
 
+  if(!srcptr)
+    {
+      if(val)
+	free(val);
+      return AY_ERROR;
+    }
+
   len = strlen(srcptr);
   if(!(tmp = calloc(len+1, sizeof(char))))
     {
+      if(val)
+	free(val);
       return AY_EOMEM;
     }
 
@@ -9292,6 +9317,9 @@ x3dio_copypv(ay_tag *src, char **dst)
     free(*dst);
   *dst = tmp;
 
+  if(val)
+    free(val);
+
  return AY_OK;
 } /* x3dio_copypv */
 
@@ -0,0 +1,154 @@
+#
+# Ayam, a free 3D modeler for the RenderMan interface.
+#
+# Ayam is copyrighted 1998-2024 by Randolf Schultz
+# (randolf.schultz@gmail.com) and others.
+#
+# All rights reserved.
+#
+# See the file License for details.
+
+# biotest.tcl - check the binary scene file format by writing sample
+# objects in binary and text form, reading them back, and comparing
+# the objects with the originals (compOb); run it in the console via:
+#  source scripts/biotest.tcl; biotest
+# the sample objects and all read objects are removed again
+
+# biotest_jitter:
+#  randomly move all points of the selected object
+proc biotest_jitter { } {
+    set cv ""
+    foreach c [getGeom points] {
+	lappend cv [expr {$c + rand()*0.1}]
+    }
+    setGeom points $cv
+ return;
+}
+# biotest_jitter
+
+
+# biotest_crt:
+#  create the sample objects in the current level, return their number
+proc biotest_crt { } {
+
+    # NURBS patch with odd values, name, tags, and transformations
+    crtOb NPatch -width 6 -height 5
+    hSL
+    biotest_jitter
+    nameOb "Patch 1"
+    addTag MyTag "some value"
+    addTag NoExport ""
+    movOb 0.1 0.2 0.3
+    rotOb 10 20 33.3
+    scalOb 1.5 0.7 1.1
+
+    # NURBS curve
+    crtOb NCurve -length 7 -order 3
+    hSL
+    biotest_jitter
+    movOb -1.1 0 0
+
+    # PolyMesh (created by tesselating a NURBS patch)
+    crtOb NPatch -width 4 -height 4
+    hSL
+    biotest_jitter
+    stessNP 2
+    set c 0
+    getLevel -l c
+    selOb [expr {$c-2}]
+    delOb
+
+    # trimmed NURBS patch (children)
+    crtOb NPatch -width 5 -height 5
+    hSL
+    goDown -1
+    crtOb NCircle -radius 0.2
+    hSL
+    movOb 0.5 0.5 0.0
+    goUp
+
+    # Level with objects that use the text object format
+    crtOb Level
+    hSL
+    goDown -1
+    crtOb Sphere
+    crtOb Box
+    hSL
+    movOb 0.3 0.3 0.3
+    crtOb Revolve
+    hSL
+    goDown -1
+    crtOb NCurve -length 5
+    goUp
+    goUp
+
+ return 5;
+}
+# biotest_crt
+
+
+# biotest_cmp:
+#  compare <n> objects starting at index <a> with <n> objects starting
+#  at index <b> in the current level, return number of differences
+proc biotest_cmp { a b n what } {
+    set errs 0
+    for {set i 0} {$i < $n} {incr i} {
+	selOb [expr {$a+$i}] [expr {$b+$i}]
+	if { ![compOb -d] } {
+	    puts "biotest: $what round trip of object $i\
+		  ([lindex [getType] 0]) failed!"
+	    incr errs
+	}
+    }
+ return $errs;
+}
+# biotest_cmp
+
+
+# biotest:
+#  save the sample objects in binary form, read them back, and compare;
+#  then save them in text form, read them back, save the result
+#  in binary form, read it back, and compare again (the text format
+#  is not lossless, hence the indirection)
+proc biotest { {filename ""} } {
+
+    if { $filename == "" } {
+	set filename [file join [pwd] biotest.ayb]
+    }
+
+    set n [biotest_crt]
+    set c 0
+    getLevel -l c
+    set o [expr {$c-$n}]
+
+    # binary round trip
+    hSL $n
+    saveScene $filename 1 1
+    insertScene $filename
+    set errs [biotest_cmp $o $c $n binary]
+
+    # text round trip
+    hSL $n
+    saveScene $filename 1 0
+    insertScene $filename
+    hSL $n
+    saveScene $filename 1 1
+    insertScene $filename
+    incr errs [biotest_cmp [expr {$c+$n}] [expr {$c+2*$n}] $n text/binary]
+
+    catch {file delete $filename}
+
+    # remove all sample objects
+    hSL [expr {4*$n}]
+    delOb
+    uS
+
+    if { $errs == 0 } {
+	puts "biotest: all $n objects passed"
+    } else {
+	puts "biotest: $errs errors"
+    }
+
+ return $errs;
+}
+# biotest
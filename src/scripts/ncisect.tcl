@@ -0,0 +1,178 @@
+#
+# Ayam, a free 3D modeler for the RenderMan interface.
+#
+# Ayam is copyrighted 1998-2024 by Randolf Schultz
+# (randolf.schultz@gmail.com) and others.
+#
+# All rights reserved.
+#
+# See the file License for details.
+
+# ncisect.tcl - check and benchmark the NURBS curve intersection
+# (intersectNC); run it in the console via:
+#  source scripts/ncisect.tcl; ncisect
+# the sample curves are created in the current level and removed again
+
+# ncisect_crt:
+#  create a NURBS curve of order <order> from the (x y) coordinates
+#  in <pnts>
+proc ncisect_crt { order pnts } {
+    set cv ""
+    foreach {x y} $pnts {
+	lappend cv $x $y 0.0 1.0
+    }
+    crtOb NCurve -length [expr {[llength $pnts]/2}] -order $order
+    hSL
+    setGeom points $cv
+ return;
+}
+# ncisect_crt
+
+
+# ncisect_check:
+#  intersect the last two curves in the current level, compare the
+#  intersection parameters with the expected (u v) pairs in <expected>
+#  (parameters given as "-" are not compared), check that the curves
+#  meet at the found parameters, remove the curves, and return the
+#  number of errors
+proc ncisect_check { name expected } {
+    set errs 0
+    set c 0
+    getLevel -l c
+    selOb [expr {$c-2}] [expr {$c-1}]
+    set res [intersectNC]
+
+    if { [llength $res] != [llength $expected] } {
+	puts "ncisect: $name: expected [expr {[llength $expected]/2}],\
+	      got [expr {[llength $res]/2}] intersection(s) ($res)!"
+	incr errs
+    } else {
+	foreach {u v} $res {eu ev} $expected {
+	    if { ($eu != "-" && abs($u-$eu) > 1e-6) ||
+		 ($ev != "-" && abs($v-$ev) > 1e-6) } {
+		puts "ncisect: $name: expected $eu $ev, got $u $v!"
+		incr errs
+	    }
+	    selOb [expr {$c-2}]
+	    getPnt -eval $u x1 y1 z1
+	    selOb [expr {$c-1}]
+	    getPnt -eval $v x2 y2 z2
+	    if { abs($x1-$x2) > 1e-6 || abs($y1-$y2) > 1e-6 } {
+		puts "ncisect: $name: curves do not meet at $u $v!"
+		incr errs
+	    }
+	}
+    }
+
+    selOb [expr {$c-2}] [expr {$c-1}]
+    delOb
+
+ return $errs;
+}
+# ncisect_check
+
+
+# ncisect_bench:
+#  intersect <n> x <n> wavy curves of <len> control points each that
+#  form a grid (so that each pair intersects exactly once), check the
+#  number of intersections, and report the time per curve pair
+proc ncisect_bench { n len } {
+    set errs 0
+    set c 0
+    getLevel -l c
+
+    for {set dir 0} {$dir < 2} {incr dir} {
+	for {set i 0} {$i < $n} {incr i} {
+	    set pnts ""
+	    for {set j 0} {$j < $len} {incr j} {
+		set s [expr {double($j)*$n/($len-1)}]
+		set t [expr {$i + 0.5 + 0.2*sin($s*2.7 + $i)}]
+		if { $dir == 0 } {
+		    lappend pnts $s $t
+		} else {
+		    lappend pnts $t $s
+		}
+	    }
+	    ncisect_crt 4 $pnts
+	}
+    }
+
+    set t [lindex [time {
+	for {set i 0} {$i < $n} {incr i} {
+	    for {set j 0} {$j < $n} {incr j} {
+		selOb [expr {$c+$i}] [expr {$c+$n+$j}]
+		if { [llength [intersectNC]] != 2 } {
+		    incr errs
+		}
+	    }
+	}
+    }] 0]
+
+    if { $errs } {
+	puts "ncisect: bench: $errs curve pairs with wrong number of\
+	      intersections!"
+    }
+
+    puts "ncisect: bench: $n x $n curves with $len points each:\
+	  [expr {$t/1000.0/($n*$n)}] ms per curve pair"
+
+    hSL [expr {2*$n}]
+    delOb
+
+ return $errs;
+}
+# ncisect_bench
+
+
+# ncisect:
+#  intersect known curve pairs and check the results; then run
+#  ncisect_bench with <n> x <n> curves of <len> control points
+proc ncisect { {n 20} {len 30} } {
+    set errs 0
+
+    # crossing lines
+    ncisect_crt 2 {-1.0 0.0 1.0 0.0}
+    ncisect_crt 2 {-0.5 -1.0 -0.5 1.0}
+    incr errs [ncisect_check "lines" {0.25 0.5}]
+
+    # parallel lines
+    ncisect_crt 2 {-1.0 0.0 1.0 0.0}
+    ncisect_crt 2 {-1.0 0.5 1.0 0.5}
+    incr errs [ncisect_check "parallel lines" {}]
+
+    # line and parabola (y = (2t-1)^2, x = 2t-1)
+    ncisect_crt 2 {-2.0 0.25 2.0 0.25}
+    ncisect_crt 3 {-1.0 1.0 0.0 -1.0 1.0 1.0}
+    incr errs [ncisect_check "line/parabola" {0.375 0.25 0.625 0.75}]
+
+    # intersection at a knot (of the polyline)
+    ncisect_crt 2 {-1.0 -1.0 0.0 0.0 1.0 -1.0}
+    ncisect_crt 2 {0.0 -2.0 0.0 2.0}
+    incr errs [ncisect_check "knot" {0.5 0.5}]
+
+    # multiple intersections with a B-Spline curve of three segments
+    # (symmetric, so that the middle intersection is known)
+    ncisect_crt 4 {-2.0 -1.0 -1.0 1.0 0.0 -1.0 1.0 1.0 2.0 -1.0 3.0 1.0}
+    ncisect_crt 2 {-3.0 0.0 4.0 0.0}
+    incr errs [ncisect_check "B-Spline/line" {- - - - 0.5 0.5 - - - -}]
+
+    # rational curve (circle) and line
+    crtOb NCircle -radius 1.0
+    hSL
+    convOb -inplace
+    ncisect_crt 2 {-2.0 0.0 2.0 0.0}
+    incr errs [ncisect_check "circle/line" {- 0.75 - 0.25}]
+
+    if { $errs == 0 } {
+	puts "ncisect: all checks passed"
+    } else {
+	puts "ncisect: $errs errors"
+    }
+
+    incr errs [ncisect_bench $n $len]
+
+    uS
+
+ return $errs;
+}
+# ncisect
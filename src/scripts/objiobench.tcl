@@ -0,0 +1,95 @@
+#
+# Ayam, a free 3D modeler for the RenderMan interface.
+#
+# Ayam is copyrighted 1998-2024 by Randolf Schultz
+# (randolf.schultz@gmail.com) and others.
+#
+# All rights reserved.
+#
+# See the file License for details.
+
+# objiobench.tcl - benchmark the Wavefront OBJ importer (objioRead)
+# on a large synthetic mesh; run it in the console via:
+#  source scripts/objiobench.tcl; objiobench
+# the imported objects are removed again
+
+# objiobench:
+#  write a synthetic OBJ file with (about) <verts> vertices arranged
+#  in a regular grid and quadrilateral faces in scrambled order (so
+#  that vertex lookups are scattered over the whole vertex buffer),
+#  import it <runs> times using <threads> parser threads and report
+#  the average time per run; the file is removed afterwards unless
+#  <keep> is 1
+proc objiobench { {verts 5000000} {runs 1} {threads 0} {keep 0}\
+		      {filename ""} } {
+
+    if { [info commands objioRead] == "" } {
+	loadPlugin objio
+    }
+    if { [info commands objioRead] == "" } {
+	puts "objiobench: objio plugin not available"
+	return;
+    }
+
+    if { $filename == "" } {
+	set filename [file join [pwd] objiobench.obj]
+    }
+
+    set s [expr {int(ceil(sqrt($verts)))}]
+    if { $s < 2 } { set s 2 }
+    set nv [expr {$s*$s}]
+    set nq [expr {$s-1}]
+    set nf [expr {$nq*$nq}]
+
+    # create the OBJ file
+    set t [lindex [time {
+	set f [open $filename w]
+	fconfigure $f -buffering full -buffersize 1048576
+	puts $f "# objiobench: $nv vertices, $nf faces"
+	for {set j 0} {$j < $s} {incr j} {
+	    for {set i 0} {$i < $s} {incr i} {
+		puts $f "v $i $j [expr {($i*$j)%7}]"
+	    }
+	}
+	# visit all faces in scrambled order by stepping through
+	# them with a stride that is coprime to the number of faces
+	set p 1000003
+	while { ($nf % $p) == 0 } { incr p 2 }
+	set k 0
+	for {set n 0} {$n < $nf} {incr n} {
+	    set a [expr {($k/$nq)*$s + ($k%$nq) + 1}]
+	    puts $f "f $a [expr {$a+1}] [expr {$a+$s+1}] [expr {$a+$s}]"
+	    set k [expr {($k+$p)%$nf}]
+	}
+	close $f
+    }] 0]
+
+    puts "objiobench: wrote $nv vertices and $nf faces in\
+	  [expr {$t/1000000.0}] s"
+
+    # import it (and remove the resulting objects again)
+    set old ""
+    getLevel old
+    set t [lindex [time {
+	objioRead $filename -m 1 -t $threads
+	set new ""
+	getLevel new
+	set n [expr {[llength $new]-[llength $old]}]
+	if { $n > 0 } {
+	    hSL $n
+	    delOb
+	}
+    } $runs] 0]
+
+    puts "objiobench: $nv vertices, $threads threads:\
+	  [expr {$t/1000.0}] ms per run"
+
+    if { $keep != 1 } {
+	catch {file delete $filename}
+    }
+
+    uS
+
+ return;
+}
+# objiobench
@@ -0,0 +1,59 @@
+#
+# Ayam, a free 3D modeler for the RenderMan interface.
+#
+# Ayam is copyrighted 1998-2024 by Randolf Schultz
+# (randolf.schultz@gmail.com) and others.
+#
+# All rights reserved.
+#
+# See the file License for details.
+
+# stessbench.tcl - benchmark the trimmed NURBS patch tesselator (stessNP)
+# on a set of heavily trimmed sample patches; run it in the console via:
+#  source scripts/stessbench.tcl; stessbench
+# the sample patches are created in the current level and removed again
+
+# stessbench:
+#  create <patches> NURBS patches, each trimmed by <holes>x<holes>
+#  circular holes, tesselate them <runs> times with stessNP using
+#  quality factor <qf> and report the average time per run
+proc stessbench { {patches 4} {holes 10} {qf 4} {runs 5} } {
+
+    set r [expr {0.35/$holes}]
+
+    # create the sample patches
+    for {set i 0} {$i < $patches} {incr i} {
+	crtOb NPatch -width 6 -height 6
+	hSL
+	movOb [expr {$i*1.5}] 0.0 0.0
+	goDown -1
+	for {set a 0} {$a < $holes} {incr a} {
+	    for {set b 0} {$b < $holes} {incr b} {
+		crtOb NCircle -radius $r
+		hSL
+		movOb [expr {($a+0.5)/$holes}] [expr {($b+0.5)/$holes}] 0.0
+		revertC
+	    }
+	}
+	goUp
+    }
+
+    # tesselate them (and remove the resulting PolyMesh objects again)
+    hSL $patches
+    set t [lindex [time {
+	stessNP $qf
+	hSL $patches
+	delOb
+	hSL $patches
+    } $runs] 0]
+
+    puts "stessbench: $patches patches with [expr {$holes*$holes}] holes\
+	  each, qf $qf: [expr {$t/1000.0}] ms per run"
+
+    # remove the sample patches
+    delOb
+    uS
+
+ return;
+}
+# stessbench
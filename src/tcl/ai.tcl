@@ -13,6 +13,7 @@ array set aiprefs {
     IgnoreTags 0
     IgnoreMat 1
     Scope 0
+    Tolerance 0.0
 }
 
 # ai_open:
@@ -49,6 +50,7 @@ proc ai_open { resolve } {
     if { $resolve != 1 } {
 	addCheck $f aiprefs IgnoreTags
 	addCheck $f aiprefs IgnoreMat
+	addParam $f aiprefs Tolerance { 0.0 1e-06 0.0001 0.01 }
     }
     pack $f -in $w -side top -fill x
     set f [frame $w.fl]
@@ -29,6 +29,7 @@ array set ayprefs {
  HandleSize 6
  LazyNotify 0
  CompleteNotify 1
+ NotifyThreads 0
  EditSnaps 1
  RationalPoints 0
  GlobalMark 1
@@ -45,6 +46,7 @@ array set ayprefs {
  ToleranceA 80.0
  NPDisplayModeA 0
  NCDisplayModeA 0
+ LODTolerance 5.0
 
  AvoidPwlCurve 1
 
@@ -126,6 +128,7 @@ array set ayprefs {
  SMChangeShaders 1
 
  PPRender "rgl"
+ PPRetained 1
  QRenderMode 0
  RenderMode 0
 
@@ -154,6 +157,7 @@ array set ayprefs {
  LogFile "/tmp/ay.log"
 
  UndoLevels 10
+ UndoMemory 0
 
  mainGeom ""
  mainState "normal"
@@ -810,7 +814,7 @@ array set ay {
  undoo None
  redoo None
  repo None
- smethods { ParametricError PathLength DomainDistance NormalizedDomainDistance AdaptiveDomainDistance AdaptiveKnotDistance }
+ smethods { ParametricError PathLength DomainDistance NormalizedDomainDistance AdaptiveDomainDistance AdaptiveKnotDistance AdaptiveNative }
  prefsgeom ""
  defactions { None Pick Edit }
  curvatp 100
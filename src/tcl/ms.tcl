@@ -186,6 +186,8 @@ ms_set en ayprefse_LazyNotify "Notify parent objects about changes just on\
 mouse up?"
 ms_set en ayprefse_CompleteNotify "When shall a complete notification be\
 carried out?"
+ms_set en ayprefse_NotifyThreads "Number of threads for the parallel\
+notification of tool objects\n(0 - one per processor, 1 - no threads)."
 ms_set en ayprefse_EditSnaps "Snap coordinates of edited points to grid\
 coordinates?"
 ms_set en ayprefse_Snap3D "Snap coordinate values in all three dimensions?"
@@ -200,6 +202,9 @@ ms_set en ayprefse_DefaultAction "Modelling action invoked, when <Esc> key\
 is pressed."
 ms_set en ayprefse_UndoLevels "Number of undoable modelling steps;\
 \n0 means Undo/Redo is disabled."
+ms_set en ayprefse_UndoMemory "Maximum memory (in MB) for saved control\
+points in the undo buffer;\nthe oldest steps are dropped if exceeded,\
+0 means unlimited."
 
 # Drawing
 ms_set en ayprefse_UseGUIScale\
@@ -217,6 +222,8 @@ ms_set en ayprefse_NPDisplayModeA "Determine how surfaces should be drawn\
 \nwhen an action is active."
 ms_set en ayprefse_NCDisplayModeA "Determine how curves should be drawn\
 \nwhen an action is active."
+ms_set en ayprefse_LODTolerance "Edge length in pixels of the coarser\
+tesselations\nused for surfaces that appear small in a view\n(0 - off)."
 ms_set en ayprefse_UseMatColor "Use color of material for shaded views?"
 ms_set en ayprefse_Background "Color to use for the background."
 ms_set en ayprefse_Object "Color to use for unselected objects."
@@ -302,6 +309,8 @@ ms_set en ayprefse_QDisplayDriver "Display driver to use for quick previews."
 ms_set en ayprefse_FDisplay "Display to use for rendering to files."
 
 ms_set en ayprefse_PPRender "Renderer to use for the permanent preview feature."
+ms_set en ayprefse_PPRetained "Send the geometry of unchanged objects only\
+once to the\npermanent preview renderer and instantiate it in every frame?"
 
 ms_set en ayprefse_SetRenderer "Select renderer to edit."
 
@@ -444,6 +453,8 @@ ms_set de ayprefse_LazyNotify "Sollen Elternobjekte 
 \nKindobjekten nur am Ende einer Modellieraktion\nbenachrichtigt werden?"
 ms_set de ayprefse_CompleteNotify "Wann sollen alle Objekte ber nderungen\
 \nan Kindobjekten (inkl. Referenzen) benachrichtigt werden?"
+ms_set de ayprefse_NotifyThreads "Anzahl der Threads fr die parallele\
+Benachrichtigung von Werkzeugobjekten\n(0 - einer pro Prozessor, 1 - keine Threads)."
 ms_set de ayprefse_EditSnaps "Sollen editierte Punkte zunchst zu den\
 \nGitter-Koordinaten bewegt werden?"
 ms_set de ayprefse_Snap3D "Soll das Bewegen von Punkten zu Gitter-Koordinaten\
@@ -462,6 +473,9 @@ ms_set de ayprefse_PickCycle "Mit weiteren Klicks durch Auswahlkandidaten\
 wechseln?"
 ms_set de ayprefse_UndoLevels "Anzahl zurcknehmbarer Modellierschritte;\
 \n0 schaltet das Undo-System aus."
+ms_set de ayprefse_UndoMemory "Maximaler Speicher (in MB) fr gesicherte\
+Kontrollpunkte im Undo-Puffer;\nlteste Schritte werden bei berschreitung\
+verworfen, 0 bedeutet unbegrenzt."
 
 # Drawing
 ms_set de ayprefse_UseGUIScale\
@@ -479,6 +493,8 @@ ms_set de ayprefse_NPDisplayModeA "Darstellungsmodus von Fl
 \nwhrend Modellieraktionen."
 ms_set de ayprefse_NCDisplayModeA "Darstellungsmodus von Kurven\
 \nwhrend Modellieraktionen."
+ms_set de ayprefse_LODTolerance "Kantenlnge in Pixeln der grberen\
+Tesselierungen\nvon Flchen, die in einer Ansicht klein erscheinen\n(0 - aus)."
 
 ms_set de ayprefse_UseMatColor "Soll die Materialfarbe fr schattierte\
 \nObjekte benutzt werden?"
@@ -563,6 +579,9 @@ ms_set de ayprefse_FDisplay "Display f
 
 ms_set de ayprefse_PPRender "Renderer, der fr die permanente Vorschau\
 verwendet werden soll."
+ms_set de ayprefse_PPRetained "Geometrie unvernderter Objekte nur einmal\
+an den\nRenderer der permanenten Vorschau senden und in jedem Bild\
+instanziieren?"
 
 ms_set de ayprefse_SetRenderer "Renderer zum Editieren auswhlen."
 
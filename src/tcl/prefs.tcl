@@ -209,6 +209,8 @@ proc prefs_open {} {
     addCheckB $fw ayprefse LazyNotify [ms ayprefse_LazyNotify]
     addMenuB $fw ayprefse CompleteNotify [ms ayprefse_CompleteNotify]\
 	{"Never" "Always" "Lazy"}
+    addParamB $fw ayprefse NotifyThreads [ms ayprefse_NotifyThreads]\
+	{ 0 1 2 4 8 }
     addCheckB $fw ayprefse EditSnaps [ms ayprefse_EditSnaps]
     addCheckB $fw ayprefse Snap3D [ms ayprefse_Snap3D]
     addCheckB $fw ayprefse FlashPoints [ms ayprefse_FlashPoints]
@@ -224,6 +226,8 @@ proc prefs_open {} {
     addMenuB $fw ayprefse DefaultAction [ms ayprefse_DefaultAction] $l
     addCheckB $fw ayprefse PickCycle [ms ayprefse_PickCycle]
     addParamB $fw ayprefse UndoLevels [ms ayprefse_UndoLevels] { 0 1 10 20 }
+    addParamB $fw ayprefse UndoMemory [ms ayprefse_UndoMemory]\
+	{ 0 64 256 1024 }
 
     uie_setLabelWidth $fw 16
 
@@ -247,6 +251,9 @@ proc prefs_open {} {
     foreach m [lrange $ay(ncdisplaymodes) 1 end] { lappend l $m }
     addMenuB $fw ayprefse NCDisplayModeA [ms ayprefse_NCDisplayModeA] $l
 
+    addParamB $fw ayprefse LODTolerance [ms ayprefse_LODTolerance]\
+	    { 0 2 5 10 20 }
+
     addCheckB $fw ayprefse UseGUIScale [ms ayprefse_UseGUIScale]
 
     addCheckB $fw ayprefse UseMatColor [ms ayprefse_UseMatColor]
@@ -519,6 +526,7 @@ proc prefs_addRIBExport { nb fw } {
     global AYENABLEPPREV
     if { $AYENABLEPPREV == 1 } {
 	addStringB $fw ayprefse PPRender [ms ayprefse_PPRender] [list "rgl"]
+	addCheckB $fw ayprefse PPRetained [ms ayprefse_PPRetained]
     }
 
  return;
@@ -223,6 +223,8 @@ proc _remTags { {i -1} } {
 	undo save RemTags
 	delTags all
     }
+    # tags may change the geometry (e.g. primitive variables)
+    notifyOb
     plb_update
     set i [lsearch -exact [$ay(plb) get 0 end] Tags]
     incr i 1
@@ -381,6 +383,9 @@ proc _commitTag { index } {
     focus .
     destroy .addTag
 
+    # tags may change the geometry (e.g. primitive variables)
+    notifyOb
+
     plb_update
 
  return;
@@ -29,6 +29,7 @@ proc init_Script { } {
 	BoundaryNames { "U0" "U1" "V0" "V1" }
 	BevelsChanged 0
 	CapsChanged 0
+	Statistics ""
     }
     # array ScriptAttrData
 
@@ -37,6 +38,7 @@ proc init_Script { } {
     addVSpace $w s1 2
     addCheck $w ScriptAttrData Active
     addMenu $w ScriptAttrData Type [list Run Create Modify]
+    addInfo $w ScriptAttrData Statistics
     pack [text $w.tScript -undo 1 -width 45 -height 15] -expand yes -fill x
     set t $w.tScript
     eval [subst "bindtags $t \{$t Text all\}"]
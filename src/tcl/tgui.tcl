@@ -32,6 +32,9 @@ uplevel #0 { array set tgui_tessparam {
     SamplingParamU6 3
     SamplingParamV6 3
 
+    SamplingParamU7 0.01
+    SamplingParamV7 15
+
     UseTexCoords 0
     UseVertColors 0
     UseVertNormals 0
@@ -259,6 +262,16 @@ proc tgui_update args {
 	    .tguiw.f1.fSamplingParamV.s conf -state normal
 	    .tguiw.f1.fSamplingParamV.e conf -state normal
 	}
+	if { $tgui_tessparam(SamplingMethod) == 6 } {
+	    .tguiw.f1.fSamplingParamU.ll conf -text "0"
+	    .tguiw.f1.fSamplingParamU.lr conf -text "0.5"
+	    .tguiw.f1.fSamplingParamU.s conf -from 0 -to 0.5
+	    .tguiw.f1.fSamplingParamU.s conf -resolution 0.005
+	    .tguiw.f1.fSamplingParamV.ll conf -text "0"
+	    .tguiw.f1.fSamplingParamV.lr conf -text "90"
+	    .tguiw.f1.fSamplingParamV.s conf -from 0 -to 90
+	    .tguiw.f1.fSamplingParamV.s conf -resolution 1
+	}
 	eval "set tgui_tessparam(SamplingParamU)\
                    \$tgui_tessparam(SamplingParamU$i)"
 	eval "set tgui_tessparam(SamplingParamV)\